@@ -53,6 +53,9 @@
 /* Key provisioning includes. */
 #include "aws_dev_mode_key_provisioning.h"
 
+/* TLS includes. */
+#include "aws_tls.h"
+
 /* mbedTLS includes. */
 #include "mbedtls/base64.h"
 /*-----------------------------------------------------------*/
@@ -400,6 +403,9 @@ void vAlternateKeyProvisioning( ProvisioningParams_t * xParams )
     }
 
     xFunctionList->C_CloseSession( xSession );
+
+    /* Make the next TLS connection pick up the new credentials. */
+    TLS_FlushCredentialCache();
 }
 /*-----------------------------------------------------------*/
 
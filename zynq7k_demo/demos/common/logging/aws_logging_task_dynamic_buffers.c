@@ -30,7 +30,8 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
+#include "ring_queue.h"
+#include "heap_trace.h"
 
 /* Logging includes. */
 #include "aws_logging_task.h"
@@ -53,8 +54,22 @@
     #error configLOGGING_INCLUDE_TIME_AND_TASK_NAME must be defined in FreeRTOSConfig.h to use this logging file.  Set configLOGGING_INCLUDE_TIME_AND_TASK_NAME to 1 to prepend a time stamp, message number and the name of the calling task to each logged message.  Otherwise set to 0.
 #endif
 
-/* A block time of 0 just means don't block. */
-#define loggingDONT_BLOCK 0
+/* Set configLOGGING_INCLUDE_HEAP_TRACE to 1 in FreeRTOSConfig.h to have the
+ * logging task write the heap trace, see heap_trace.h, to the log output. */
+#ifndef configLOGGING_INCLUDE_HEAP_TRACE
+    #define configLOGGING_INCLUDE_HEAP_TRACE    0
+#endif
+
+#if ( configLOGGING_INCLUDE_HEAP_TRACE == 1 )
+    #if ( configUSE_HEAP_TRACE != 1 )
+        #error configUSE_HEAP_TRACE must be set to 1 in FreeRTOSConfig.h for the logging task to write the heap trace.
+    #endif
+
+    /* How long the log must be quiet before the logging task writes out all
+     * of the heap trace.  Otherwise it writes one buffer after each message. */
+    #define loggingHEAP_TRACE_PERIOD         pdMS_TO_TICKS( 100 )
+    #define loggingHEAP_TRACE_BUFFER_LENGTH  256
+#endif
 
 /*-----------------------------------------------------------*/
 
@@ -64,7 +79,7 @@
  * outputting the log message having to wait for the message to be completely
  * written.  Using a separate task also serialises access to the output port.
  *
- * The structure of this task is very simple; it blocks on a queue to wait for
+ * The structure of this task is very simple; it blocks on a ring queue to wait for
  * a pointer to a string, sending any received strings to a macro that performs
  * the actual output.  The macro is port specific, so implemented outside of
  * this file.  This version uses dynamic memory, so the buffer that contained
@@ -75,10 +90,12 @@ static void prvLoggingTask( void * pvParameters );
 /*-----------------------------------------------------------*/
 
 /*
- * The queue used to pass pointers to log messages from the task that created
- * the message to the task that will performs the output.
+ * The ring queue used to pass pointers to log messages from the task that
+ * created the message to the task that will performs the output.  Any task can
+ * log, so it has multiple producers.  Unlike a queue, sending to it does not
+ * enter a critical section, and only wakes the logging task if it is waiting.
  */
-static QueueHandle_t xQueue = NULL;
+static RingQueueHandle_t xQueue = NULL;
 
 /*-----------------------------------------------------------*/
 
@@ -89,8 +106,8 @@ BaseType_t xLoggingTaskInitialize( uint16_t usStackSize, UBaseType_t uxPriority,
     /* Ensure the logging task has not been created already. */
     if( xQueue == NULL )
     {
-        /* Create the queue used to pass pointers to strings to the logging task. */
-        xQueue = xQueueCreate( uxQueueLength, sizeof( char ** ) );
+        /* Create the ring queue used to pass pointers to strings to the logging task. */
+        xQueue = xRingQueueCreateMultipleProducers( uxQueueLength, sizeof( char ** ) );
 
         if( xQueue != NULL )
         {
@@ -100,8 +117,9 @@ BaseType_t xLoggingTaskInitialize( uint16_t usStackSize, UBaseType_t uxPriority,
             }
             else
             {
-                /* Could not create the task, so delete the queue again. */
-                vQueueDelete( xQueue );
+                /* Could not create the task, so delete the ring queue again. */
+                vRingQueueDelete( xQueue );
+                xQueue = NULL;
             }
         }
     }
@@ -114,14 +132,40 @@ static void prvLoggingTask( void *pvParameters )
 {
     char *pcReceivedString = NULL;
 
+    #if ( configLOGGING_INCLUDE_HEAP_TRACE == 1 )
+        static char cHeapTrace[ loggingHEAP_TRACE_BUFFER_LENGTH ];
+        const TickType_t xBlockTime = loggingHEAP_TRACE_PERIOD;
+    #else
+        const TickType_t xBlockTime = portMAX_DELAY;
+    #endif
+
     for( ;; )
     {
         /* Block to wait for the next string to print. */
-        if( xQueueReceive( xQueue, &pcReceivedString, portMAX_DELAY ) == pdPASS )
+        if( xRingQueueReceive( xQueue, &pcReceivedString, xBlockTime ) == pdPASS )
         {
             configPRINT_STRING( pcReceivedString );
             vPortFree( ( void * ) pcReceivedString );
+
+            #if ( configLOGGING_INCLUDE_HEAP_TRACE == 1 )
+                if( xHeapTraceFormat( cHeapTrace, sizeof( cHeapTrace ) ) > 0 )
+                {
+                    configPRINT_STRING( cHeapTrace );
+                }
+            #endif
         }
+
+        #if ( configLOGGING_INCLUDE_HEAP_TRACE == 1 )
+            else
+            {
+                /* Writing the trace does not allocate, so it does not add to
+                 * the trace. */
+                while( xHeapTraceFormat( cHeapTrace, sizeof( cHeapTrace ) ) > 0 )
+                {
+                    configPRINT_STRING( cHeapTrace );
+                }
+            }
+        #endif
     }
 }
 /*-----------------------------------------------------------*/
@@ -208,7 +252,7 @@ void vLoggingPrintf( const char *pcFormat, ... )
         if( xLength > 0 )
         {
             /* Send the string to the logging task for IO. */
-            if( xQueueSend( xQueue, &pcPrintString, loggingDONT_BLOCK ) != pdPASS )
+            if( xRingQueueSend( xQueue, &pcPrintString ) != pdPASS )
             {
                 /* The buffer was not sent so must be freed again. */
                 vPortFree( ( void * ) pcPrintString );
@@ -241,7 +285,7 @@ void vLoggingPrint( const char * pcMessage )
         strncpy( pcPrintString, pcMessage, xLength );
 
         /* Send the string to the logging task for IO. */
-        if( xQueueSend( xQueue, &pcPrintString, loggingDONT_BLOCK ) != pdPASS )
+        if( xRingQueueSend( xQueue, &pcPrintString ) != pdPASS )
         {
             /* The buffer was not sent so must be freed again. */
             vPortFree( ( void * ) pcPrintString );
@@ -39,6 +39,8 @@
 #include "FreeRTOS_IP.h"
 #include "FreeRTOS_Sockets.h"
 #include "FreeRTOS_DHCP.h"
+#include "FreeRTOS_DNS.h"
+#include "arena.h"
 
 /* Demo includes */
 #include "aws_demo_runner.h"
@@ -60,6 +62,11 @@
 /* The name of the devices for xApplicationDNSQueryHook. */
 #define mainDEVICE_NICK_NAME				"XilinxDemo"
 
+/* The memory for the TCP stream buffers and window segments, see
+ * FreeRTOSIPConfig.h.  Each socket takes two 20 KB blocks for its 16 KB
+ * buffers. */
+#define mainNETWORK_ARENA_SIZE              ( 256 * 1024 )
+
 
 /* Static arrays for FreeRTOS-Plus-TCP stack initialization for Ethernet network
  * connections are declared below. If you are using an Ethernet connection on your MCU
@@ -143,6 +150,16 @@ static void prvMiscInitialization( void );
 /* Use by the pseudo random number generator. */
 static UBaseType_t ulNextRand;
 
+/* The arena the TCP stack allocates its buffers from. */
+static uint8_t ucNetworkArenaStorage[ mainNETWORK_ARENA_SIZE ];
+static ArenaHandle_t xNetworkArena = NULL;
+
+#if ( configUSE_TRACE_RECORDER == 1 )
+    /* The trace recorder's user event channel for the IP task, see
+     * FreeRTOSIPConfig.h. */
+    traceString xIPTraceChannel = NULL;
+#endif
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -154,11 +171,23 @@ int main( void )
      * running.  */
     prvMiscInitialization();
 
+    #if ( configUSE_TRACE_RECORDER == 1 )
+        /* Before any kernel object is created, so the trace names all of them.
+         * The trace is streamed once the network is up and a host has connected
+         * and started it, see trcStreamingPort.c. */
+        vTraceEnable( TRC_INIT );
+        xIPTraceChannel = xTraceRegisterString( "IP" );
+    #endif
+
     /* Create tasks that are not dependent on the Wi-Fi being initialized. */
     xLoggingTaskInitialize( mainLOGGING_TASK_STACK_SIZE,
                             tskIDLE_PRIORITY,
                             mainLOGGING_MESSAGE_QUEUE_LENGTH );
 
+    /* The TCP stack's buffers come from their own arena. */
+    xNetworkArena = xArenaCreateStatic( "TCP", ucNetworkArenaStorage, sizeof( ucNetworkArenaStorage ) );
+    configASSERT( xNetworkArena != NULL );
+
     /* FreeRTOS TCP IP initialization function */
     FreeRTOS_IPInit( ucIPAddress,
                      ucNetMask,
@@ -185,6 +214,18 @@ const uint32_t ulMultiplier = 0x015a4e35UL, ulIncrement = 1UL;
 	ulNextRand = ( ulMultiplier * ulNextRand ) + ulIncrement;
 	return( ( int ) ( ulNextRand >> 16UL ) & 0x7fffUL );
 }
+/*-----------------------------------------------------------*/
+
+void * pvNetworkArenaMalloc( size_t xWantedSize )
+{
+    return pvArenaMalloc( xNetworkArena, xWantedSize );
+}
+/*-----------------------------------------------------------*/
+
+void vNetworkArenaFree( void * pv )
+{
+    vArenaFree( xNetworkArena, pv );
+}
 
 /*-----------------------------------------------------------*/
 
@@ -227,6 +268,13 @@ void vApplicationIPNetworkEventHook( eIPCallbackEvent_t eNetworkEvent )
     if( eNetworkEvent == eNetworkUp )
     {
     	configPRINTF( ("Network connection successful.\n\r") );
+
+        #if ( ipconfigDNS_USE_CALLBACKS != 0 ) && ( ipconfigUSE_DNS_CACHE != 0 )
+            /* Keep the address of the broker in the DNS cache, so that
+             * (re)connecting does not have to wait for a DNS lookup. */
+            FreeRTOS_dnsprefetch( clientcredentialMQTT_BROKER_ENDPOINT );
+        #endif
+
         if( ( xTasksAlreadyCreated == pdFALSE ) && ( SYSTEM_Init() == pdPASS ) )
         {
             /* This is not needed for the workshop as key are already provisioned. */
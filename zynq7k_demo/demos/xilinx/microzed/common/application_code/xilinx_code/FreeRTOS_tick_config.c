@@ -74,11 +74,32 @@
 /* Xilinx includes. */
 #include "xscutimer.h"
 #include "xscugic.h"
+#include "xtime_l.h"
+#include "xil_io.h"
 
 #define XSCUTIMER_CLOCK_HZ ( XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2UL )
 
+/* The run time stats counter is the global timer, which counts at half the
+CPU clock, divided by 1 << RUN_TIME_COUNTER_SHIFT.  At a 666MHz CPU clock that
+is a 1.3MHz counter, which takes 54 minutes to wrap. */
+#define RUN_TIME_COUNTER_SHIFT	8
+
 static XScuTimer xTimer;
 
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+	/* Global timer counts spent in each interrupt handler. */
+	static uint64_t ullInterruptRunTime[ XSCUGIC_MAX_NUM_INTR_INPUTS ];
+#endif
+
+#if( configUSE_TRACE_RECORDER == 1 )
+	/* The trace recorder's handle of each interrupt whose handler is shown in
+	the trace, NULL for the others. */
+	static traceHandle xInterruptTraceHandle[ XSCUGIC_MAX_NUM_INTR_INPUTS ];
+
+	/* Names an interrupt in the trace, with its priority in the GIC. */
+	static void prvTraceInterrupt( XScuGic *pxGIC, uint32_t ulInterruptID, const char *pcName );
+#endif
+
 /*
  * The application must provide a function that configures a peripheral to
  * create the FreeRTOS tick interrupt, then define configSETUP_TICK_INTERRUPT()
@@ -138,6 +159,15 @@ const uint8_t ucRisingEdge = 3;
 	/* Enable the interrupt in the xTimer itself. */
 	vClearTickInterrupt();
 	XScuTimer_EnableInterrupt( &xTimer );
+
+	#if( configUSE_TRACE_RECORDER == 1 )
+	{
+		/* The tick, and the Ethernet MAC that wakes the IP task.  Their
+		priorities are set by now, the MAC's being the GIC default. */
+		prvTraceInterrupt( &xInterruptController, XPAR_SCUTIMER_INTR, "Tick" );
+		prvTraceInterrupt( &xInterruptController, XPAR_XEMACPS_0_INTR, "GEM0" );
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -147,12 +177,94 @@ void vClearTickInterrupt( void )
 }
 /*-----------------------------------------------------------*/
 
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+
+	/*
+	 * Starts the global timer if nothing has started it yet.  The BSP's sleep
+	 * functions and XTime_GetTime() use the same timer, so its count and
+	 * prescaler are left as they are.
+	 */
+	void vConfigureRunTimeCounter( void )
+	{
+	uint32_t ulControl;
+
+		ulControl = Xil_In32( GLOBAL_TMR_BASEADDR + GTIMER_CONTROL_OFFSET );
+		if( ( ulControl & 0x1UL ) == 0 )
+		{
+			Xil_Out32( GLOBAL_TMR_BASEADDR + GTIMER_CONTROL_OFFSET, ulControl | 0x1UL );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	/*
+	 * The run time stats counter.  Both cores see the same global timer, so the
+	 * counts of tasks that run on different cores can be compared.
+	 */
+	uint32_t ulGetRunTimeCounterValue( void )
+	{
+	XTime xTime;
+
+		XTime_GetTime( &xTime );
+		return ( uint32_t ) ( xTime >> RUN_TIME_COUNTER_SHIFT );
+	}
+	/*-----------------------------------------------------------*/
+
+	/*
+	 * The time spent in the handler of an interrupt since the scheduler started,
+	 * in run time stats counts.  The time includes any interrupt that nested in
+	 * the handler, and it is also counted in the run time of the task that was
+	 * interrupted.
+	 */
+	uint32_t ulGetInterruptRunTimeCounter( uint32_t ulInterruptID )
+	{
+	uint32_t ulRunTime = 0;
+
+		if( ulInterruptID < XSCUGIC_MAX_NUM_INTR_INPUTS )
+		{
+			ulRunTime = ( uint32_t ) ( __atomic_load_n( &( ullInterruptRunTime[ ulInterruptID ] ), __ATOMIC_RELAXED ) >> RUN_TIME_COUNTER_SHIFT );
+		}
+
+		return ulRunTime;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+
+#if( configUSE_TRACE_RECORDER == 1 )
+
+	static void prvTraceInterrupt( XScuGic *pxGIC, uint32_t ulInterruptID, const char *pcName )
+	{
+	uint8_t ucPriority, ucTrigger;
+
+		/* Interrupts that cannot call the FreeRTOS API are not masked by the
+		recorder's critical sections, so cannot be traced. */
+		XScuGic_GetPriorityTriggerType( pxGIC, ulInterruptID, &ucPriority, &ucTrigger );
+		configASSERT( ( ucPriority >> portPRIORITY_SHIFT ) >= configMAX_API_CALL_INTERRUPT_PRIORITY );
+
+		xInterruptTraceHandle[ ulInterruptID ] = xTraceSetISRProperties( pcName, ucPriority >> portPRIORITY_SHIFT );
+
+		/* xTraceSetISRProperties() only records the name if a trace is being
+		recorded, and this runs before the host connects, so also put it in the
+		symbol table sent at the start of every trace. */
+		vTraceStoreKernelObjectName( ( void * ) xInterruptTraceHandle[ ulInterruptID ], pcName );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configUSE_TRACE_RECORDER */
+
 void vApplicationIRQHandler( uint32_t ulICCIAR )
 {
 extern const XScuGic_Config XScuGic_ConfigTable[];
 static const XScuGic_VectorTableEntry *pxVectorTable = XScuGic_ConfigTable[ XPAR_SCUGIC_SINGLE_DEVICE_ID ].HandlerTable;
 uint32_t ulInterruptID;
 const XScuGic_VectorTableEntry *pxVectorEntry;
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+	uint32_t ulStart;
+#endif
+#if( configUSE_TRACE_RECORDER == 1 )
+	extern volatile uint32_t ulPortYieldRequired[];
+	traceHandle xTraceHandle;
+#endif
 
 	/* The ID of the interrupt is obtained by bitwise anding the ICCIAR value
 	with 0x3FF. */
@@ -161,7 +273,43 @@ const XScuGic_VectorTableEntry *pxVectorEntry;
 	{
 		/* Call the function installed in the array of installed handler functions. */
 		pxVectorEntry = &( pxVectorTable[ ulInterruptID ] );
-		pxVectorEntry->Handler( pxVectorEntry->CallBackRef );
+
+		#if( configUSE_TRACE_RECORDER == 1 )
+		{
+			xTraceHandle = xInterruptTraceHandle[ ulInterruptID ];
+			if( xTraceHandle != NULL )
+			{
+				vTraceStoreISRBegin( xTraceHandle );
+			}
+		}
+		#endif
+
+		#if( configGENERATE_RUN_TIME_STATS == 1 )
+		{
+			/* The low word of the global timer is enough for one handler, and
+			is cheaper to read than the whole count.  Both cores can take the
+			same interrupt, so the total is added atomically. */
+			ulStart = Xil_In32( GLOBAL_TMR_BASEADDR + GTIMER_COUNTER_LOWER_OFFSET );
+			pxVectorEntry->Handler( pxVectorEntry->CallBackRef );
+			( void ) __atomic_fetch_add( &( ullInterruptRunTime[ ulInterruptID ] ), ( uint64_t ) ( Xil_In32( GLOBAL_TMR_BASEADDR + GTIMER_COUNTER_LOWER_OFFSET ) - ulStart ), __ATOMIC_RELAXED );
+		}
+		#else
+		{
+			pxVectorEntry->Handler( pxVectorEntry->CallBackRef );
+		}
+		#endif
+
+		#if( configUSE_TRACE_RECORDER == 1 )
+		{
+			/* The handler calls portYIELD_FROM_ISR() if it woke a task, in
+			which case the trace shows the switch to it rather than a return
+			to the interrupted task. */
+			if( xTraceHandle != NULL )
+			{
+				vTraceStoreISREnd( ( int ) ulPortYieldRequired[ portGET_CORE_ID() ] );
+			}
+		}
+		#endif
 	}
 }
 
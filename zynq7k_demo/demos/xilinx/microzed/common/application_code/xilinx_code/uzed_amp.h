@@ -0,0 +1,117 @@
+/*
+ * Amazon FreeRTOS MQTT UZed Demo V1.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file uzed_amp.h
+ * @brief The contract between the two cores when the MicroZed IOT demo runs
+ * as AMP: CPU1 runs its own image that samples the sensors, and CPU0 runs
+ * the network stack and publishes what CPU1 sampled.
+ *
+ * The samples travel through an AMP ring (aws_amp_ring.h) in the high on-chip
+ * memory, which neither image links anything into. CPU0 formats the ring and
+ * then releases CPU1, which attaches and writes one sample per period. CPU0
+ * reads without being interrupted, once per period, so nothing but the ring
+ * is shared between the cores.
+ *
+ * Both images must be built from the same copy of this file. The CPU1 image
+ * is a second XSDK application with its own BSP built with -DUSE_AMP=1, so
+ * that it leaves the L2 cache, the SCU and the GIC distributor to CPU0, and
+ * with its linker script placed at uzedAMP_CPU1_START_ADDRESS. CPU0's linker
+ * script must end its DDR region below that address.
+ */
+
+#ifndef _UZED_AMP_H_
+#define _UZED_AMP_H_
+
+#include "FreeRTOS.h"
+#include "xil_mmu.h"
+
+/**
+ * @brief 1 to sample the sensors on CPU1, 0 to sample them on CPU0
+ */
+#ifndef UZED_USE_AMP
+#define UZED_USE_AMP	0
+#endif
+
+/**
+ * @brief The ring, in the high on-chip memory (ps7_ram_1 in the linker scripts)
+ */
+#define uzedAMP_RING_ADDRESS		0xFFFF0000UL
+#define uzedAMP_RING_SIZE			0x4000UL
+
+/**
+ * @brief Where CPU1's image is linked to start
+ */
+#define uzedAMP_CPU1_START_ADDRESS	0x18000000UL
+
+/**
+ * @brief CPU1 waits in the boot ROM for an address to be written here, then an event
+ */
+#define uzedAMP_CPU1_WAKE_ADDRESS	0xFFFFFFF0UL
+
+/**
+ * @brief CPU1 sampling period
+ *
+ * CPU0 reads the ring every SAMPLING_PERIOD_MS, which must not be shorter or
+ * it will find periods without a new sample and report them as errors.
+ */
+#define uzedAMP_SAMPLING_PERIOD_MS	100
+
+/**
+ * @brief Maps the ring normal non-cacheable, on each core, before it is used
+ *
+ * CPU1 is outside the SCU coherency of CPU0's caches in this configuration,
+ * so the ring must not be cached by either core. Normal rather than strongly
+ * ordered memory, so that memcpy() may access it unaligned. This maps the
+ * whole 1 MB section, which holds nothing else either image uses.
+ */
+#define uzedAMP_MAP_RING()		Xil_SetTlbAttributes( uzedAMP_RING_ADDRESS, NORM_NONCACHE )
+
+/**
+ * @brief One record in the ring, written by CPU1 each sampling period
+ */
+typedef struct UZedSensorSample {
+    uint32_t ulSequence;		// Counts samples, so the reader can tell what it missed
+    uint32_t ulTimestamp;		// CPU1's tick count when sampled
+
+    uint8_t bError;				// Any sensor failed to sample
+    uint8_t bBarometerOk;
+    uint8_t bHygrometerOk;
+    uint8_t bThermocoupleOk;
+
+    float fBarometerPressure;
+    float fBarometerTemperature;
+    float fHygrometerHumidity;
+    float fHygrometerTemperature;
+    float fThermocoupleTemperature;
+    float fThermocoupleBoardTemperature;
+} UZedSensorSample;
+
+/**
+ * @brief Starts the task that samples the sensors into the ring, on CPU1
+ */
+void vStartUZedSensorNode( void );
+
+#endif
@@ -72,6 +72,21 @@
 #define UZedCLIENT_ID          ( ( const uint8_t * ) "MQTTUZed" )
 #endif
 
+/**
+ * @brief If set to 1, publish the heap trace (see heap_trace.h) every sampling
+ * period. Needs configUSE_HEAP_TRACE, and the logging task must not also write
+ * the trace out.
+ */
+#define UZED_PUBLISH_HEAP_TRACE 0
+
+/**
+ * @brief If set to 1, measure how late the sampling loop wakes, and print the
+ * maximum every UZED_WAKE_LATENCY_REPORT_SAMPLES periods. Useful to check the
+ * tick is not losing time while it is suppressed.
+ */
+#define UZED_MEASURE_WAKE_LATENCY 0
+#define UZED_WAKE_LATENCY_REPORT_SAMPLES 60
+
 //////////////////// END USER PARAMETERS ////////////////////
 
 #if SAMPLING_PERIOD_MS < 100
@@ -98,21 +113,33 @@
 #include "aws_system_init.h"
 #include "aws_pkcs11_config.h"
 
+/* AMP includes. */
+#include "aws_amp_ring.h"
+
 /* Demo includes. */
 #include "aws_demo_config.h"
 #include "xil_types.h"
 #include "xparameters.h"
 #include "xstatus.h"
-#include "xiic.h"
 #include "xgpiops.h"
-#include "xspi_l.h"
 #include "xemacps.h"
+#include "xil_io.h"
+#include "xpseudo_asm.h"
 #include "uzed_iot.h"
+#include "uzed_sensors.h"
+#include "uzed_amp.h"
+#include "xtime_l.h"
 #if UZED_USE_GG
 #include "aws_ggd_config.h"
 #include "aws_ggd_config_defaults.h"
 #include "aws_greengrass_discovery.h"
 #endif
+#if UZED_PUBLISH_HEAP_TRACE
+#include "heap_trace.h"
+#if ( configUSE_HEAP_TRACE != 1 ) || ( configLOGGING_INCLUDE_HEAP_TRACE == 1 )
+#error UZED_PUBLISH_HEAP_TRACE needs configUSE_HEAP_TRACE set to 1, and configLOGGING_INCLUDE_HEAP_TRACE set to 0
+#endif
+#endif
 
 /*-----------------------------------------------------------*/
 // System parameters for the MicroZed IOT kit
@@ -121,139 +148,11 @@
 #define GG_DISCOVERY_FILE_SIZE    4096
 #endif
 
-/**
- * @brief This is the LPS25HB on the Arduino shield board
- */
-#define BAROMETER_SLAVE_ADDRESS		0x5D
-/**
- * @brief This is the HTS221 on the Arduino shield board
- */
-#define HYGROMETER_SLAVE_ADDRESS	0x5F
-
 /**
  * @brief LED pin represents connection state
  */
 #define LED_PIN	47
 
-/**
- * @brief Barometer register defines
- */
-#define BAROMETER_REG_REF_P_XL			0x15
-#define BAROMETER_REG_REF_P_L			0x16
-#define BAROMETER_REG_REF_P_H			0x17
-#define BAROMETER_REG_WHO_AM_I			0x0F
-#define BAROMETER_REG_RES_CONF			0x1A
-
-#define BAROMETER_REG_CTRL_REG1			0x10
-#define BAROMETER_BFLD_PD				(0<<7)
-#define BAROMETER_ODR_2					(0<<6)
-#define BAROMETER_ODR_1					(0<<5)
-#define BAROMETER_ODR_0					(0<<4)
-#define BAROMETER_ENABLE_LPFP				(0<<3)
-#define BAROMETER_LPFP_CFG				(0<<2)
-#define BAROMETER_BDU					(0<<1)
-#define BAROMETER_SIM					(0<<0)
-
-
-#define BAROMETER_REG_CTRL_REG2			0x11
-#define BAROMETER_BFLD_BOOT				(1<<7)
-#define BAROMETER_FIFO_ENABLE				(0<<6)
-#define BAROMETER_STOP_ON_FTH				(0<<5)
-#define BAROMETER_IF_ADD_INC				(1<<4)
-#define BAROMETER_I2C_DIS				(0<<3)
-#define BAROMETER_BFLD_SWRESET				(1<<2)
-#define BAROMETER_BFLD_ZEROBIT                          (0<<1)
-#define BAROMETER_BFLD_ONE_SHOT				(1<<0)
-
-#define BAROMETER_REG_CTRL_REG3			0x12
-#define BAROMETER_REG_INTERRUPT_CFG		0x0B
-#define BAROMETER_REG_INT_SOURCE		0x25
-
-#define BAROMETER_REG_STATUS_REG		0x27
-#define BAROMETER_BFLD_P_DA				(1<<0)
-#define BAROMETER_BFLD_T_DA				(1<<1)
-
-#define BAROMETER_REG_PRESS_OUT_XL		0x28
-#define BAROMETER_REG_PRESS_OUT_L		0x29
-#define BAROMETER_REG_PRESS_OUT_H		0x2A
-#define BAROMETER_REG_TEMP_OUT_L		0x2B
-#define BAROMETER_REG_TEMP_OUT_H		0x2C
-#define BAROMETER_REG_FIFO_CTRL			0x14
-#define BAROMETER_REG_FIFO_STATUS		0x26
-#define BAROMETER_REG_THS_P_L			0x0C
-#define BAROMETER_REG_THS_P_H			0x0D
-#define BAROMETER_REG_RPDS_L			0x18
-#define BAROMETER_REG_RPDS_H			0x19
-
-/**
- * @brief Hygrometer register defines
- */
-#define HYGROMETER_REG_WHO_AM_I			0x0F
-#define HYGROMETER_REG_AV_CONF			0x10
-
-#define HYGROMETER_REG_CTRL_REG1		0x20
-#define HYGROMETER_BFLD_PD				(1<<7)
-
-#define HYGROMETER_REG_CTRL_REG2		0x21
-#define HYGROMETER_BFLD_BOOT			(1<<7)
-#define HYGROMETER_BFLD_ONE_SHOT		(1<<0)
-
-#define HYGROMETER_REG_CTRL_REG3		0x22
-
-#define HYGROMETER_REG_STATUS_REG		0x27
-#define HYGROMETER_BFLD_H_DA			(1<<1)
-#define HYGROMETER_BFLD_T_DA			(1<<0)
-
-#define HYGROMETER_REG_HUMIDITY_OUT_L	0x28
-#define HYGROMETER_REG_HUMIDITY_OUT_H	0x29
-#define HYGROMETER_REG_TEMP_OUT_L		0x2A
-#define HYGROMETER_REG_TEMP_OUT_H		0x2B
-
-#define HYGROMETER_REG_CALIB_0			0x30	// Convenience define for beginning of calibration registers
-#define HYGROMETER_REG_H0_rH_x2			0x30
-#define HYGROMETER_REG_H1_rH_x2			0x31
-#define HYGROMETER_REG_T0_degC_x8		0x32
-#define HYGROMETER_REG_T1_degC_x8		0x33
-#define HYGROMETER_REG_T1_T0_MSB		0x35
-#define HYGROMETER_REG_H0_T0_OUT_LSB	0x36
-#define HYGROMETER_REG_H0_T0_OUT_MSB	0x37
-#define HYGROMETER_REG_H1_T0_OUT_LSB	0x3A
-#define HYGROMETER_REG_H1_T0_OUT_MSB	0x3B
-#define HYGROMETER_REG_T0_OUT_LSB		0x3C
-#define HYGROMETER_REG_T0_OUT_MSB		0x3D
-#define HYGROMETER_REG_T1_OUT_LSB		0x3E
-#define HYGROMETER_REG_T1_OUT_MSB		0x3F
-
-/**
- * @brief AXI QSPI Temperature sensor defines
- */
-#define PL_SPI_BASEADDR			XPAR_AXI_QUAD_SPI_0_BASEADDR  // Base address for AXI SPI controller
-
-#define PL_SPI_CHANNEL_SEL_0		0xFFFFFFFE					// Select spi channel 0
-#define PL_SPI_CHANNEL_SEL_1		0xFFFFFFFD					// Select spi channel 1
-#define PL_SPI_CHANNEL_SEL_NONE		0xFFFFFFFF					// Deselect all SPI channels
-
-// Initialization settings for the AXI SPI controller's Control Register when addressing the MAX31855
-// 0x186 = b1_1000_0110
-//			1	Inhibited to hold off transactions starting
-//			1	Manually select the slave
-//			0	Do not reset the receive FIFO at this time
-//			0	Do not reset the transmit FIFO at this time
-//			0	Clock phase of 0
-//			0	Clock polarity of low
-//			1	Enable master mode
-//			1	Enable the SPI Controller
-//			0	Do not put in loopback mode
-
-#define MAX31855_CLOCK_PHASE_CPHA		0
-#define MAX31855_CLOCK_POLARITY_CPOL	0
-
-#define MAX31855_CR_INIT_MODE		XSP_CR_TRANS_INHIBIT_MASK | XSP_CR_MANUAL_SS_MASK   | \
-									XSP_CR_MASTER_MODE_MASK   | XSP_CR_ENABLE_MASK
-#define MAX31855_CR_UNINHIBIT_MODE	                            XSP_CR_MANUAL_SS_MASK   | \
-									XSP_CR_MASTER_MODE_MASK   | XSP_CR_ENABLE_MASK
-#define AXI_SPI_RESET_VALUE			0x0A  //!< Reset value for the AXI SPI Controller
-
 /**
  * @brief Utility macro to uniformly process errors
  */
@@ -268,16 +167,6 @@
 		} \
 	}
 
-static inline BaseType_t MS_TO_TICKS(BaseType_t xMs)
-{
-	TickType_t xTicks = pdMS_TO_TICKS( xMs );
-
-	if(xTicks < 1) {
-		xTicks = 1;
-	}
-	return xTicks;
-}
-
 /*-----------------------------------------------------------*/
 
 /**
@@ -285,8 +174,10 @@ static inline BaseType_t MS_TO_TICKS(BaseType_t xMs)
  */
 #define SYSTEM_SENSOR_TOPIC_LENGTH    64
 #define SYSTEM_SHADOW_TOPIC_LENGTH    128
+#define SYSTEM_HEAP_TRACE_TOPIC_LENGTH    64
+#define SYSTEM_HEAP_TRACE_DATA_LENGTH    1024
+#define SYSTEM_HEAP_TRACE_PUBLISHES    8
 typedef struct System {
-	XIic 	iic;
 	XGpioPs gpio;
 
 	MQTTAgentHandle_t xMQTTHandle;
@@ -295,31 +186,39 @@ typedef struct System {
     char pcJSONFile[ GG_DISCOVERY_FILE_SIZE ];
 #endif
 
-	u8 pbHygrometerCalibration[16];
-
 	int rc;
     const char* pcErr;
     uint8_t bError;
     uint8_t bLastReportedError;
 
-    // Sensor start ok
-    uint8_t bBarometerOk;
-    uint8_t bHygrometerOk;
-    uint8_t bThermocoupleOk;
+    // Sensor values, sampled here or, with UZED_USE_AMP, received from CPU1
+    UZedSensors tSensors;
+#if UZED_USE_AMP
+    AmpRing_t xRing;
+    uint32_t ulLastSequence;
+    uint32_t ulLastDropped;
+#endif
 
-    // Sensor values
-    float fBarometerPressure;
-    float fBarometerTemperature;
-    float fHygrometerHumidity;
-    float fHygrometerTemperature;
-    float fThermocoupleTemperature;
-    float fThermocoupleBoardTemperature;
+#if UZED_MEASURE_WAKE_LATENCY
+    // Wake latency of the sampling loop, measured with the global timer
+    XTime xWakeBaseTime;
+    TickType_t xWakeBaseTick;
+    uint32_t ulMaxWakeLatency;
+    uint32_t ulWakeSamples;
+#endif
 
     uint16_t usSensorTopicLength;
     uint8_t pbSensorTopic[SYSTEM_SENSOR_TOPIC_LENGTH + 1];
 
     uint16_t usShadowTopicLength;
     uint8_t pbShadowTopic[SYSTEM_SHADOW_TOPIC_LENGTH + 1];
+
+#if UZED_PUBLISH_HEAP_TRACE
+    // Heap trace lines, published in up to SYSTEM_HEAP_TRACE_PUBLISHES messages a period
+    uint16_t usHeapTraceTopicLength;
+    uint8_t pbHeapTraceTopic[SYSTEM_HEAP_TRACE_TOPIC_LENGTH + 1];
+    char pcHeapTrace[SYSTEM_HEAP_TRACE_DATA_LENGTH];
+#endif
 } System;
 System g_tSystem;
 
@@ -353,6 +252,15 @@ static void prvPublishShadow(System* pSystem);
  */
 static void prvPublishSensors(System* pSystem);
 
+#if UZED_PUBLISH_HEAP_TRACE
+/**
+ * @brief Publishes the heap trace recorded since the last period
+ *
+ * @param[in] pSystem	System info
+ */
+static void prvPublishHeapTrace(System* pSystem);
+#endif
+
 /**
  * @brief Creates an MQTT client and then connects to the MQTT broker.
  *
@@ -362,6 +270,26 @@ static void prvPublishSensors(System* pSystem);
  */
 static void prvCreateClientAndConnectToBroker( System* pSystem );
 
+#if UZED_USE_AMP
+/**
+ * @brief Receives the samples CPU1 wrote since the last period, keeping the latest
+ *
+ * @param[in] pSystem	System info
+ */
+static void prvReceiveSensors(System* pSystem);
+#endif
+
+#if UZED_MEASURE_WAKE_LATENCY
+/**
+ * @brief Measures how late the task woke for a period, and reports the maximum
+ * every UZED_WAKE_LATENCY_REPORT_SAMPLES periods
+ *
+ * @param[in] pSystem	        System info
+ * @param[in] xWakeTime	        The tick the task was due to wake at
+ */
+static void prvMeasureWakeLatency(System* pSystem, TickType_t xWakeTime);
+#endif
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -400,132 +328,6 @@ static void prvUZedIotTask( void * pvParameters );
  */
 static void BlinkLed(System* pSystem,BaseType_t xCount, BaseType_t xFinalOn);
 
-/*-----------------------------------------------------------*/
-
-/**
- * @brief Read multiple IIC registers
- *
- * @param[in] pSystem			System handle
- * @param[in] bSlaveAddress		Slave address on bus
- * @param[in] xCount			Number of registers to read
- * @param[in] bFirstSlaveReg	First register number on device
- * @param[in] pbBuf				Byte buffer to deposit data read from device
- */
-static int ReadIicRegs(System* pSystem,u8 bSlaveAddress,BaseType_t xCount,u8 bFirstSlaveReg,u8* pbBuf);
-
-/**
- * @brief Read single IIC register
- *
- * @param[in] pSystem		System handle
- * @param[in] bSlaveAddress	Slave address on bus
- * @param[in] bSlaveReg		Register number on slave device
- * @param[in] pbBuf			Byte buffer to deposit data read from device
- */
-static int ReadIicReg(System* pSystem,u8 bSlaveAddress,u8 bSlaveReg,u8* pbBuf);
-
-/**
- * @brief Write multiple IIC registers
- *
- * @param[in] pSystem		System handle
- * @param[in] bSlaveAddress	Slave address on bus
- * @param[in] xCount		Number of registers to write
- * @param[in] pbBuf			Byte buffer with data to write - >= 2 bytes - first byte is always register number on slave device
- */
-static int WriteIicRegs(System* pSystem,u8 bSlaveAddress,BaseType_t xCount,u8* pbBuf);
-
-/**
- * @brief Write single IIC register
- *
- * @param[in] pSystem	System handle
- * @param[in] bSlaveAddress	Slave address on bus
- * @param[in] bSlaveReg	Register number on slave device
- * @param[in] pbBuf		Byte buffer with data to write - 2 bytes - first byte is always register number on slave device
- */
-static int WriteIicReg(System* pSystem,u8 bSlaveAddress,u8 bSlaveReg,u8 bVal);
-
-/*-----------------------------------------------------------*/
-
-/**
- * @brief Start Barometer
- *
- * @param[in] pSystem	System handle
- */
-static void StartBarometer(System* pSystem);
-
-/**
- * @brief Stop Barometer
- *
- * @param[in] pSystem	System handle
- */
-static void StopBarometer(System* pSystem);
-
-
-/**
- * @brief Sample Barometer and publish values
- *
- * @param[in] pSystem			System handle
- */
-static void SampleBarometer(System* pSystem);
-
-/*-----------------------------------------------------------*/
-
-/**
- * @brief Start Hygrometer
- *
- * @param[in] pSystem	System handle
- */
-static void StartHygrometer(System* pSystem);
-
-/**
- * @brief Stop Hygrometer
- *
- * @param[in] pSystem	System handle
- */
-static void StopHygrometer(System* pSystem);
-
-
-/**
- * @brief Sample Hygrometer and publish values
- *
- * @param[in] pSystem			System handle
- */
-static void SampleHygrometer(System* pSystem);
-
-/*-----------------------------------------------------------*/
-
-/**
- * @brief Start PL Temperature Sensor
- *
- * @param[in] pSystem	System handle
- */
-static void StartPLTempSensor(System* pSystem);
-
-/**
- * @brief Stop PL Temperature Sensor
- *
- * @param[in] pSystem	System handle
- */
-static void StopPLTempSensor(System* pSystem);
-
-/**
- * @brief PL Temperature Sensor: utility function to do SPI transaction
- *
- * @param[in] 	pSystem			System handle
- * @param[in] 	qBaseAddress	AXI SPI Controller Base Address
- * @param[in] 	xSPI_Channel	SPI Channel to use
- * @param[in] 	xByteCount		Number of bytes to transfer
- * @param[in] 	pqTxBuffer		Data to send
- * @param[out] 	pqRxBuffer		Data to receive
- */
-static void XSpi_LowLevelExecute(System* pSystem, u32 qBaseAddress, BaseType_t xSPI_Channel, BaseType_t xByteCount, const u32* pqTxBuffer, u32* pqRxBuffer);
-
-/**
- * @brief Sample Barometer and publish values
- *
- * @param[in] pSystem			System handle
- */
-static void SamplePLTempSensor(System* pSystem);
-
 
 /*--------------------------------------------------------------------------------*/
 static void StopHere(void)
@@ -659,12 +461,12 @@ static void prvPublishSensors(System* pSystem)
         "\"%s\": %.2f\n"
         "}"
         ,
-		"Pressure",             pSystem->fBarometerPressure,
-		"Pressure_Sensor_Temp", pSystem->fBarometerTemperature,
-		"Thermocouple_Temp",    pSystem->fThermocoupleTemperature,
-		"Board_Temp_1",         pSystem->fThermocoupleBoardTemperature,
-		"Relative_Humidity",    pSystem->fHygrometerHumidity,
-		"Humidity_Sensor_Temp", pSystem->fHygrometerTemperature
+		"Pressure",             pSystem->tSensors.fBarometerPressure,
+		"Pressure_Sensor_Temp", pSystem->tSensors.fBarometerTemperature,
+		"Thermocouple_Temp",    pSystem->tSensors.fThermocoupleTemperature,
+		"Board_Temp_1",         pSystem->tSensors.fThermocoupleBoardTemperature,
+		"Relative_Humidity",    pSystem->tSensors.fHygrometerHumidity,
+		"Humidity_Sensor_Temp", pSystem->tSensors.fHygrometerTemperature
         );
     pcDataBuffer[UZedMAX_DATA_LENGTH - 1] = 0;	// safety
     if((iDataLength < 0) || (iDataLength >= UZedMAX_DATA_LENGTH)) {
@@ -683,6 +485,39 @@ static void prvPublishSensors(System* pSystem)
     prvPublish(pSystem,&xPublishParameters);
 }
 
+#if UZED_PUBLISH_HEAP_TRACE
+static void prvPublishHeapTrace(System* pSystem)
+{
+    MQTTAgentPublishParams_t xPublishParameters;
+    size_t xDataLength;
+    BaseType_t xPublishes;
+
+    if(pSystem->xMQTTHandle == NULL) {
+    	return;
+    }
+
+    /*
+     * Publishing allocates too, so the trace never quite empties; leave the
+     * rest for the next period
+     */
+    for(xPublishes = 0; xPublishes < SYSTEM_HEAP_TRACE_PUBLISHES; xPublishes++) {
+        xDataLength = xHeapTraceFormat(pSystem->pcHeapTrace, SYSTEM_HEAP_TRACE_DATA_LENGTH);
+        if(xDataLength == 0) {
+            break;
+        }
+
+        memset( &( xPublishParameters ), 0, sizeof( xPublishParameters ) );
+        xPublishParameters.pucTopic = pSystem->pbHeapTraceTopic;
+        xPublishParameters.usTopicLength = pSystem->usHeapTraceTopicLength;
+        xPublishParameters.xQoS = eMQTTQoS0;
+        xPublishParameters.pvData = (void*)pSystem->pcHeapTrace;
+        xPublishParameters.ulDataLength = ( uint32_t ) xDataLength;
+
+        prvPublish(pSystem,&xPublishParameters);
+    }
+}
+#endif
+
 /*--------------------------------------------------------------------------------*/
 
 static void prvCreateClientAndConnectToBroker( System* pSystem )
@@ -766,814 +601,103 @@ static void prvCreateClientAndConnectToBroker( System* pSystem )
 
 /*--------------------------------------------------------------------------------*/
 
-static int ReadIicRegs(System* pSystem,u8 bSlaveAddress,BaseType_t xCount,u8 bFirstSlaveReg,u8* pbBuf)
-{
-	BaseType_t xReceived;
-
-	if(xCount > 1) {
-		bFirstSlaveReg |= 0x80;
-	}
-
-	MAY_DIE({
-		if(1 != XIic_Send(pSystem->iic.BaseAddress,bSlaveAddress,&bFirstSlaveReg,1,XIIC_REPEATED_START)) {
-			pSystem->rc = 1;
-			pSystem->pcErr = "ReadIicRegs::XIic_Send(Addr) -> 0x%08x\r\n";
-		}
-	});
-	MAY_DIE({
-		xReceived = XIic_Recv(pSystem->iic.BaseAddress,bSlaveAddress,pbBuf,xCount,XIIC_STOP);
-		if(xReceived != xCount) {
-			pSystem->rc = ((xReceived & 0xf) << 4) | (xCount & 0xf);
-			pSystem->pcErr = "ReadIicRegs::XIic_Recv(Data) -> 0x%08x\r\n";
-		}
-	});
-
-L_DIE:
-	return pSystem->rc;
-}
-
-static int ReadIicReg(System* pSystem, u8 bSlaveAddress, u8 bFirstSlaveReg, u8* pbBuf)
-{
-	return ReadIicRegs(pSystem, bSlaveAddress, 1, bFirstSlaveReg, pbBuf);
-}
-
-static int WriteIicRegs(System* pSystem, u8 bSlaveAddress, BaseType_t xCount, u8* pbBuf)
-{
-	BaseType_t xSent;
-
-	if(xCount > 2) {
-		pbBuf[0] |= 0x80;
-	}
-
-	MAY_DIE({
-		xSent = XIic_Send(pSystem->iic.BaseAddress,bSlaveAddress,pbBuf,xCount,XIIC_STOP);
-		if(xCount != xSent) {
-			pSystem->rc = ((xSent & 0xf) << 4) | (xCount & 0xf);
-			pSystem->pcErr = "WriteIicRegs::XIic_Send(Buf) -> 0x%08x\r\n";
-		}
-	});
-
-L_DIE:
-	return pSystem->rc;
-}
-
-static int WriteIicReg(System* pSystem,u8 bSlaveAddress, u8 bFirstSlaveReg, u8 bVal)
-{
-	u8 pbBuf[2];
-
-	pbBuf[0] = bFirstSlaveReg;
-	pbBuf[1] = bVal;
-	return WriteIicRegs(pSystem, bSlaveAddress, 2, pbBuf);
-}
-
-/*--------------------------------------------------------------------------------*/
-
-static void StartBarometer(System* pSystem)
-{
-	u8 b;
-	int iTimeout;
-	TickType_t xOneMs = MS_TO_TICKS( 1 );
-
-    pSystem->bBarometerOk = pdFALSE;
-    pSystem->fBarometerPressure = 0;
-    pSystem->fBarometerTemperature = 0;
-
-	// Verify it is the right chip
-	MAY_DIE({
-		ReadIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_WHO_AM_I,&b);
-		pSystem->pcErr = "ReadIicReg(WHO_AM_I) -> 0x%08x\r\n";
-	});
-
-	MAY_DIE({
-		if(0xB1 != b) {
-			pSystem->rc = b?b:1;
-			pSystem->pcErr = "BAROMETER_WHO_AM_I = 0x%08x != 0xB1\r\n";
-		}
-	});
-
-	// Reset chip: first swreset, then boot
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_BFLD_SWRESET);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BFLD_SWRESET) -> 0x%08x\r\n";
-	});
-	for(iTimeout = 100; iTimeout-- > 0; ) {
-		MAY_DIE({
-			ReadIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,&b);
-			pSystem->pcErr = "ReadIicReg(BAROMETER_REG_CTRL_REG2) -> 0x%08x\r\n";
-		});
-		if(0 == (b & BAROMETER_BFLD_SWRESET)) {
-			break;
-		}
-		vTaskDelay(xOneMs);
-	}
-	if(iTimeout <= 0) {
-		MAY_DIE({
-			pSystem->rc = XST_FAILURE;
-			pSystem->pcErr = "Barometer swreset timeout\r\n";
-		});
-	}
-
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_BFLD_BOOT);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BAROMETER_BFLD_BOOT -> 0x%08x\r\n";
-	});
-	for(iTimeout = 100; iTimeout-- > 0; ) {
-		MAY_DIE({
-			ReadIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,&b);
-			pSystem->pcErr = "ReadIicReg(BAROMETER_REG_CTRL_REG2) -> 0x%08x\r\n";
-		});
-		if(0 == (b & BAROMETER_BFLD_BOOT)) {
-			break;
-		}
-		vTaskDelay(xOneMs);
-	}
-	if(iTimeout <= 0) {
-		MAY_DIE({
-			pSystem->rc = XST_FAILURE;
-			pSystem->pcErr = "Barometer boot timeout\r\n";
-		});
-	}
-
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_BFLD_ZEROBIT);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BAROMETER_BFLD_ZEROBIT -> 0x%08x\r\n";
-	});
-
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_FIFO_ENABLE);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BAROMETER_FIFO_ENABLE -> 0x%08x\r\n";
-	});
-
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_STOP_ON_FTH);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BAROMETER_STOP_ON_FTH -> 0x%08x\r\n";
-	});
-	
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_IF_ADD_INC);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BAROMETER_IF_ADD_INC -> 0x%08x\r\n";
-	});
-
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2, BAROMETER_I2C_DIS);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_I2C_DIS) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_ODR_2);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_ODR_2) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_ODR_1);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_ODR_1) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_ODR_0);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_ODR_0) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_ENABLE_LPFP);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_ENABLE_LPFP) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_LPFP_CFG);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_LPFP_CFG) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_BDU);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_BDU) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_SIM);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_SIM) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_BFLD_PD);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_BFLD_PD) -> 0x%08x\r\n";
-	});
-	vTaskDelay(xOneMs);
-
-    pSystem->bBarometerOk = pdTRUE;
-	configPRINTF( ( "Barometer started ok\r\n" ) );
-    return;
-
-L_DIE:
-	configPRINTF( ( "ERROR: Barometer started not ok\r\n" ) );
-	return;
-}
-
-static void StopBarometer(System* pSystem)
+#if UZED_USE_AMP
+static void prvReceiveSensors(System* pSystem)
 {
-    pSystem->bBarometerOk = pdFALSE;
-}
-
-static void SampleBarometer(System* pSystem)
-{
-	BaseType_t xTimeout;
-	u8 b;
-	u8 pbBuf[6];
-	s32 sqTmp;
-	float f;
- 	u8 count = 0;
-	TickType_t xOneMs = MS_TO_TICKS( 1 );
-
-    if(!pSystem->bBarometerOk) {
-        return;
+    UZedSensorSample tSample;
+    size_t xLength;
+    BaseType_t xReceived = pdFALSE;
+    uint32_t ulDropped;
+
+    while(pdPASS == AMP_RingRead(&pSystem->xRing, &tSample, sizeof(tSample), &xLength)) {
+        if(sizeof(tSample) != xLength) {
+            continue;
+        }
+        xReceived = pdTRUE;
+        pSystem->ulLastSequence = tSample.ulSequence;
+        pSystem->tSensors.bError = tSample.bError;
+        pSystem->tSensors.bBarometerOk = tSample.bBarometerOk;
+        pSystem->tSensors.bHygrometerOk = tSample.bHygrometerOk;
+        pSystem->tSensors.bThermocoupleOk = tSample.bThermocoupleOk;
+        pSystem->tSensors.fBarometerPressure = tSample.fBarometerPressure;
+        pSystem->tSensors.fBarometerTemperature = tSample.fBarometerTemperature;
+        pSystem->tSensors.fHygrometerHumidity = tSample.fHygrometerHumidity;
+        pSystem->tSensors.fHygrometerTemperature = tSample.fHygrometerTemperature;
+        pSystem->tSensors.fThermocoupleTemperature = tSample.fThermocoupleTemperature;
+        pSystem->tSensors.fThermocoupleBoardTemperature = tSample.fThermocoupleBoardTemperature;
     }
-    pSystem->rc = XST_SUCCESS;
-
-	/*
-	 * NOTE: The one shot auto clears but it seems to take 36ms
-	 * Our sampling period is >= 100ms so the one shot will auto clear by the next sample time
-	 */
-	MAY_DIE({
-		WriteIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_BFLD_ONE_SHOT);
-		pSystem->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BAROMETER_BFLD_ONE_SHOT) -> 0x%08x\r\n";
-	});
-	for(xTimeout = 50; xTimeout-- > 0; ) {
-		MAY_DIE({
-			ReadIicReg(pSystem,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,&b);
-			pSystem->pcErr = "ReadIicReg(BAROMETER_REG_CTRL_REG2) -> 0x%08x\r\n";
-		});
-		if(0 == (b & BAROMETER_BFLD_ONE_SHOT)) {
-			break;
-		}
-		vTaskDelay(xOneMs);
-	}
-	MAY_DIE({
-		if(xTimeout <= 0) {
-			pSystem->rc = XST_FAILURE;
-			pSystem->pcErr = "Timed out waiting for BAROMETER_BFLD_ONE_SHOT\r\n";
-		}
-	});
-
-	for(xTimeout = 50; xTimeout-- > 0; ) {
-		MAY_DIE({
-			ReadIicRegs(pSystem,BAROMETER_SLAVE_ADDRESS,6,BAROMETER_REG_STATUS_REG,pbBuf);
-			pSystem->pcErr = "ReadIicRegs(6@BAROMETER_REG_STATUS_REG) -> 0x%08x\r\n";
-		});
-		if((BAROMETER_BFLD_P_DA | BAROMETER_BFLD_T_DA) == (pbBuf[0] & (BAROMETER_BFLD_P_DA | BAROMETER_BFLD_T_DA))) {
-			break;
-		}
-		vTaskDelay(xOneMs);
-	}
-	MAY_DIE({
-		if(xTimeout <= 0) {
-			pSystem->rc = XST_FAILURE;
-			pSystem->pcErr = "Timed out waiting for P_DA and T_DA\r\n";
-		}
-	});
-
-	for(count=1; count<6;count++)
-		pbBuf[count] = 0;
-
-        MAY_DIE({
-            ReadIicRegs(pSystem,BAROMETER_SLAVE_ADDRESS,1,BAROMETER_REG_PRESS_OUT_XL,&pbBuf[1]);
-            pSystem->pcErr = "ReadIicRegs(BAROMETER_REG_PRESS_OUT_XL) -> 0x%08x\r\n";
-        });
-
-        MAY_DIE({
-            ReadIicRegs(pSystem,BAROMETER_SLAVE_ADDRESS,1,BAROMETER_REG_PRESS_OUT_L,&pbBuf[2]);
-            pSystem->pcErr = "ReadIicRegs(BAROMETER_REG_PRESS_OUT_L) -> 0x%08x\r\n";
-        });
-
-        MAY_DIE({
-            ReadIicRegs(pSystem,BAROMETER_SLAVE_ADDRESS,1,BAROMETER_REG_PRESS_OUT_H,&pbBuf[3]);
-            pSystem->pcErr = "ReadIicRegs(BAROMETER_REG_PRESS_OUT_H) -> 0x%08x\r\n";
-        });
-
-        MAY_DIE({
-            ReadIicRegs(pSystem,BAROMETER_SLAVE_ADDRESS,1,BAROMETER_REG_TEMP_OUT_L,&pbBuf[4]);
-            pSystem->pcErr = "ReadIicRegs(BAROMETER_REG_TEMP_OUT_L) -> 0x%08x\r\n";
-        });
-
-        MAY_DIE({
-            ReadIicRegs(pSystem,BAROMETER_SLAVE_ADDRESS,1,BAROMETER_REG_TEMP_OUT_H,&pbBuf[5]);
-            pSystem->pcErr = "ReadIicRegs(BAROMETER_REG_TEMP_OUT_H) -> 0x%08x\r\n";
-        });
-		
-
-	// See ST TN1228
-	sqTmp = 0
-			| ((u32)pbBuf[1] << 0)	// xl
-			| ((u32)pbBuf[2] << 8)	// l
-			| ((u32)pbBuf[3] << 16)	// h
-			;
-	if(sqTmp & 0x00800000) {
-		sqTmp |= 0xFF800000;
-	}
-	f = (float)sqTmp / 4096.0F;
-    pSystem->fBarometerPressure = f;
-
-	sqTmp = 0
-			| ((u32)pbBuf[4] << 0)	// l
-			| ((u32)pbBuf[5] << 8)	// h
-			;
-	if(sqTmp & 0x00008000) {
-		sqTmp |= 0xFFFF8000;
-	}
-	f = (float)sqTmp/100.0;
-
-    pSystem->fBarometerTemperature = f;
-
-L_DIE:
-	return;
-}
-
-/*--------------------------------------------------------------------------------*/
-
-static void StartHygrometer(System* pSystem)
-{
-	u8 b;
-	int iTimeout;
-	TickType_t xOneMs = MS_TO_TICKS( 1 );
-
-    pSystem->bHygrometerOk = pdFALSE;
-    pSystem->fHygrometerHumidity = 0;
-    pSystem->fHygrometerTemperature = 0;
-
-	// Verify it is the right chip
-	MAY_DIE({
-		ReadIicReg(pSystem,HYGROMETER_SLAVE_ADDRESS,HYGROMETER_REG_WHO_AM_I,&b);
-		pSystem->pcErr = "ReadIicReg(HYGROMETER_WHO_AM_I) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-		if(0xBC != b) {
-			pSystem->rc = b?b:1;
-			pSystem->pcErr = "HYGROMETER_WHO_AM_I = 0x%08x != BC\r\n";
-		}
-	});
-
-	// Reset chip: boot
-	MAY_DIE({
-		WriteIicReg(pSystem,HYGROMETER_SLAVE_ADDRESS,HYGROMETER_REG_CTRL_REG2,HYGROMETER_BFLD_BOOT);
-		pSystem->pcErr = "WriteIicReg(HYGROMETER_REG_CTRL_REG2::HYGROMETER_BFLD_BOOT -> 0x%08x\r\n";
-	});
-	for(iTimeout = 1000; iTimeout-- > 0; ) {
-		MAY_DIE({
-			ReadIicReg(pSystem,HYGROMETER_SLAVE_ADDRESS,HYGROMETER_REG_CTRL_REG2,&b);
-			pSystem->pcErr = "ReadIicReg(BAROMETER_REG_CTRL_REG2) -> 0x%08x\r\n";
-		});
-		if(0 == (b & HYGROMETER_BFLD_BOOT)) {
-			break;
-		}
-		vTaskDelay(xOneMs);
-	}
-	if(iTimeout <= 0) {
-		MAY_DIE({
-			pSystem->rc = XST_FAILURE;
-			pSystem->pcErr = "Hygrometer boot timeout\r\n";
-		});
-	}
-
-	/*
-	 * Read and store calibration values
-	 */
-	MAY_DIE({
-		ReadIicRegs(pSystem,HYGROMETER_SLAVE_ADDRESS,16,HYGROMETER_REG_CALIB_0,&pSystem->pbHygrometerCalibration[0]);
-		pSystem->pcErr = "ReadIicRegs(HYGROMETER_REG_CALIB_0) -> 0x%08x\r\n";
-	});
 
-
-	/*
-	 * Power up device
-	 */
-	MAY_DIE({
-		WriteIicReg(pSystem,HYGROMETER_SLAVE_ADDRESS,HYGROMETER_REG_CTRL_REG1,HYGROMETER_BFLD_PD);
-		pSystem->pcErr = "WriteIicReg(HYGROMETER_REG_CTRL_REG1::HYGROMETER_BFLD_PD) -> 0x%08x\r\n";
-	});
-	vTaskDelay(xOneMs);
-
-    pSystem->bHygrometerOk = pdTRUE;
-	configPRINTF( ( "Hygrometer started ok\r\n" ) );
-    return;
-
-L_DIE:
-	configPRINTF( ( "ERROR: Hygrometer started not ok\r\n" ) );
-	return;
-}
-
-static void StopHygrometer(System* pSystem)
-{
-    pSystem->bHygrometerOk = pdFALSE;
-}
-
-static void SampleHygrometer(System* pSystem)
-{
-	BaseType_t xTimeout;
-	u8 b;
-	u8 pbBuf[5];
-	int	H0_T0_out, H1_T0_out, H_T_out;
-	int H0_rh, H1_rh;
-	u8	buffer[2];
-	int tmp = 0;
-	u16 value = 0;
-	int T0_out, T1_out, T_out, T0_degC_x8_u16, T1_degC_x8_u16;
-	int T0_degC, T1_degC;
-	u8 buff2[4], tmp5 = 0;
-	int tmp32 = 0;
-	TickType_t xOneMs = MS_TO_TICKS( 1 );
-
-    if(!pSystem->bHygrometerOk) {
-        return;
+    /*
+     * Publish the last values again, but as an error, if CPU1 has stopped
+     */
+    if(!xReceived) {
+        pSystem->tSensors.bError = 1;
+        configPRINTF( ( "ERROR: No sample from CPU1 since #%u\r\n", pSystem->ulLastSequence ) );
     }
-    pSystem->rc = XST_SUCCESS;
-
-	/*
-	 * NOTE: The one shot auto clears but it seems to take FIXME ms
-	 * Our sampling period is >= 100ms so the one shot will auto clear by the next sample time??? FIXME
-	 */
-	MAY_DIE({
-		WriteIicReg(pSystem,HYGROMETER_SLAVE_ADDRESS,HYGROMETER_REG_CTRL_REG2,HYGROMETER_BFLD_ONE_SHOT);
-		pSystem->pcErr = "WriteIicReg(HYGROMETER_REG_CTRL_REG2::HYGROMETER_BFLD_ONE_SHOT) -> 0x%08x\r\n";
-	});
-	for(xTimeout = 10000; xTimeout-- > 0; ) {
-		MAY_DIE({
-			ReadIicReg(pSystem,HYGROMETER_SLAVE_ADDRESS,HYGROMETER_REG_CTRL_REG2,&b);
-			pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_CTRL_REG2) -> 0x%08x\r\n";
-		});
-		if(0 == (b & HYGROMETER_BFLD_ONE_SHOT)) {
-			break;
-		}
-		vTaskDelay(xOneMs);
-	}
-	MAY_DIE({
-		if(xTimeout <= 0) {
-			pSystem->rc = XST_FAILURE;
-			pSystem->pcErr = "Timed out waiting for HYGROMETER_BFLD_ONE_SHOT\r\n";
-		}
-	});
-
-	for(xTimeout = 50; xTimeout-- > 0; ) {
-		MAY_DIE({
-			ReadIicRegs(pSystem,HYGROMETER_SLAVE_ADDRESS,5,HYGROMETER_REG_STATUS_REG,pbBuf);
-			pSystem->pcErr = "ReadIicRegs(6@HYGROMETER_REG_STATUS_REG) -> 0x%08x\r\n";
-		});
-		if((HYGROMETER_BFLD_H_DA | HYGROMETER_BFLD_T_DA) == (pbBuf[0] & (HYGROMETER_BFLD_H_DA | HYGROMETER_BFLD_T_DA))) {
-			break;
-		}
-		vTaskDelay(xOneMs);
-	}
-	MAY_DIE({
-		if(xTimeout <= 0) {
-			pSystem->rc = XST_FAILURE;
-			pSystem->pcErr = "Timed out waiting for HYGROMETER P_DA and T_DA\r\n";
-		}
-	});
-
-	/*
-	 * REF: ST TN1218
-	 * Interpreting humidity and temperature readings in the HTS221 digital humidity sensor
-	 */
-
-	buffer[0] = 0;
-    buffer[1] = 0;
-
-	/* 1. Read H0_rH and H1_rH coefficients */
-	MAY_DIE({
-		ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_H0_rH_x2 , &buffer[0]);
-		pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_H0_rH_x2)  -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-		ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_H1_rH_x2, &buffer[1]);
-		pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_H1_rH_x2) -> 0x%08x\r\n";
-	});
-
-	H0_rh = buffer[0]>>1;
-	H1_rh = buffer[1]>>1;
-
-	buffer[0] = 0; buffer[1] = 0;
-	/*2. Read H0_T0_OUT */ 
-
-	MAY_DIE({
-		 ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_H0_T0_OUT_LSB, &buffer[0]);
-		 pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_H0_T0_OUT_LSB) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-		 ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_H0_T0_OUT_MSB, &buffer[1]);
-		 pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_H0_T0_OUT_MSB -> 0x%08x\r\n";
-	});
-
-	H0_T0_out = (((u16)buffer[1])<<8) | (u16)buffer[0];
-
-	buffer[0] = 0; buffer[1] = 0;
-	/*3. Read H1_T0_OUT  */
-
-	MAY_DIE({
-		ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_H1_T0_OUT_LSB, &buffer[0]);
-		pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_H1_T0_OUT_LSB)  -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-		ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_H1_T0_OUT_MSB, &buffer[1]);
-		pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_H1_T0_OUT_MSB) -> 0x%08x\r\n";
-	});
-
-	H1_T0_out = (((u16)buffer[1])<<8) | (u16)buffer[0];
-
-	buffer[0] = 0; buffer[1] = 0;
-	/*4. Read H_T_OUT  */
 
-	MAY_DIE({
-		ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_HUMIDITY_OUT_L, &buffer[0]);
-		pSystem->pcErr = "ReadIicReg( HYGROMETER_REG_HUMIDITY_OUT_L) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-		ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_HUMIDITY_OUT_H, &buffer[1]);
-		pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_HUMIDITY_OUT_H -> 0x%08x\r\n";
-	});
-
-	H_T_out = (((u16)buffer[1])<<8) | (u16)buffer[0];
-
-	/*5. Compute the RH [%] value by linear interpolation */
-	value = 0;
-	tmp = ((int)(H_T_out - H0_T0_out)) * ((int)(H1_rh - H0_rh));
-	value = (u16) ((tmp/(H1_T0_out - H0_T0_out))+ H0_rh) ;
-
-	/* Saturation condition*/
-	if(value>1000) value = 1000;
-
-    pSystem->fHygrometerHumidity = value;
-
-        /**
-	* @brief Read HTS221 temperature output registers, and calculate temperature.
-	* @param Pointer to the returned temperature value that must be divided by 10 to get the value in ['C].
-	* @retval Error code [HTS221_OK, HTS221_ERROR].
-	*/
-	tmp5 = 0; value = 0;
-	buff2[0] = 0; buff2[1] = 0; buff2[2] = 0; buff2[3] = 0;
-
-	/*1. Read from 0x32 & 0x33 registers the value of coefficients T0_degC_x8 and T1_degC_x8*/
-    MAY_DIE({
-        ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T0_degC_x8, &buff2[0]);
-        pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_T0_degC_x8) -> 0x%08x\r\n";
-	});
-    MAY_DIE({
-        ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T1_degC_x8, &buff2[1]);
-        pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_T1_degC_x8) -> 0x%08x\r\n";
-	});
-
-	/*2. Read from 0x35 register the value of the MSB bits of T1_degC and T0_degC */
-	MAY_DIE({
-        ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T1_T0_MSB, &tmp5);
-		pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_T1_T0_MSB) -> 0x%08x\r\n";
-	});
-
-	/*Calculate the T0_degC and T1_degC values*/
-	T0_degC_x8_u16 = (((u16)(tmp5 & 0x03)) << 8) | ((u16)buff2[0]);
-	T1_degC_x8_u16 = (((u16)(tmp5 & 0x0C)) << 6) | ((u16)buff2[1]);
-	T0_degC = T0_degC_x8_u16>>3;
-	T1_degC = T1_degC_x8_u16>>3;
-
-	/*3. Read from 0x3C & 0x3D registers the value of T0_OUT*/
-	/*4. Read from 0x3E & 0x3F registers the value of T1_OUT*/
-	buff2[0] = 0;
-    buff2[1] = 0;
-    buff2[2] = 0;
-    buff2[3] = 0;
-	MAY_DIE({
-        ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T0_OUT_LSB, &buff2[0]);
-        pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_T0_OUT_LSB) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-        ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T0_OUT_MSB, &buff2[1]);
-        pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_T0_OUT_LSB) -> 0x%08x\r\n";
-	});
-
-	MAY_DIE({
-        ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T1_OUT_LSB, &buff2[2]);
-        pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_T1_OUT_LSB) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-        ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T1_OUT_MSB, &buff2[3]);
-        pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_T1_OUT_MSB) -> 0x%08x\r\n";
-	});
-
-	T0_out = (((u16)buff2[1])<<8) | (u16)buff2[0];
-	T1_out = (((u16)buff2[3])<<8) | (u16)buff2[2];
-
-	/* 5.Read from 0x2A & 0x2B registers the value T_OUT (ADC_OUT).*/
-	buff2[0] = 0; buff2[1] = 0; buff2[2] = 0; buff2[3] = 0;
-	MAY_DIE({
-        ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_TEMP_OUT_L, &buff2[0]);
-        pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_TEMP_OUT_L) -> 0x%08x\r\n";
-	});
-	MAY_DIE({
-        ReadIicReg(pSystem, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_TEMP_OUT_H, &buff2[1]);
-        pSystem->pcErr = "ReadIicReg(HYGROMETER_REG_TEMP_OUT_H) -> 0x%08x\r\n";
-	});
-
-	T_out = (((u16)buff2[1])<<8) | (u16)buff2[0];
-
-	/* 6. Compute the Temperature value by linear interpolation*/
-	value = 0;
-
-	tmp32 = (( int)(T_out - T0_out)) * (( int)(T1_degC - T0_degC));
-	value = (tmp32 /(T1_out - T0_out)) + T0_degC;
-
-    pSystem->fHygrometerTemperature = value;
-
-L_DIE:
-	return;
+    ulDropped = AMP_RingDropped(&pSystem->xRing);
+    if(ulDropped != pSystem->ulLastDropped) {
+        configPRINTF( ( "WARNING: CPU1 dropped %u samples\r\n", ulDropped - pSystem->ulLastDropped ) );
+        pSystem->ulLastDropped = ulDropped;
+    }
 }
+#endif
 
 /*--------------------------------------------------------------------------------*/
 
-static void StartPLTempSensor(System* pSystem)
-{
-	const TickType_t xOneMs = MS_TO_TICKS(1);
-
-    pSystem->bThermocoupleOk = pdFALSE;
-    pSystem->fThermocoupleBoardTemperature = 0;
-    pSystem->fThermocoupleTemperature = 0;
-
-	//Reset the SPI Peripheral, which takes 4 cycles, so wait a bit after reset
-    XSpi_WriteReg(PL_SPI_BASEADDR, XSP_SRR_OFFSET, AXI_SPI_RESET_VALUE);
-	vTaskDelay(xOneMs); //usleep(100);
-
-	// Initialize the AXI SPI Controller with settings compatible with the MAX31855
-    XSpi_WriteReg(PL_SPI_BASEADDR, XSP_CR_OFFSET, MAX31855_CR_INIT_MODE);
-
-	// Deselect all slaves to start, then wait a bit for it to take affect
-    XSpi_WriteReg(PL_SPI_BASEADDR, XSP_SSR_OFFSET, PL_SPI_CHANNEL_SEL_NONE);
+#if UZED_MEASURE_WAKE_LATENCY
 
-	vTaskDelay(xOneMs); //usleep(100);
-
-    pSystem->bThermocoupleOk = pdTRUE;
-	configPRINTF( ("PL Thermocouple started - check state after first reading\r\n") );
-}
+/*
+ * The tick is the private timer, loaded with XSCUTIMER_CLOCK_HZ /
+ * configTICK_RATE_HZ in FreeRTOS_tick_config.c, and a period is one count more
+ * than the load.  The private and the global timer both count the peripheral
+ * clock, half the CPU clock, so a tick is due a whole number of these counts
+ * after the base.  ullGetHighResolutionTime() can't be used: it divides by a
+ * whole number of counts per microsecond, so it runs 0.1% fast.
+ */
+#define UZED_COUNTS_PER_TICK    ( ( XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2ULL ) / configTICK_RATE_HZ + 1ULL )
 
-static void StopPLTempSensor(System* pSystem)
+static void prvMeasureWakeLatency(System* pSystem, TickType_t xWakeTime)
 {
-    pSystem->bThermocoupleOk = pdFALSE;
-}
+    XTime xNow;
+    XTime xDue;
+    uint32_t ulLatency = 0;
 
-static void XSpi_LowLevelExecute(System* pSystem, u32 qBaseAddress, BaseType_t xSPI_Channel, BaseType_t xByteCount, const u32* pqTxBuffer, u32* pqRxBuffer)
-{
-	BaseType_t xNumBytesRcvd = 0;
-	BaseType_t xCount;
-	const TickType_t xOneMs = MS_TO_TICKS(1);
-
-	/*
-	 * Initialize the Tx FIFO in the AXI SPI Controller with the transmit
-	 * data contained in TxBuffer
-	 */
-	for (xCount = 0; xCount < xByteCount; pqTxBuffer++, xCount++)
-	{
-		XSpi_WriteReg(qBaseAddress, XSP_DTR_OFFSET, *pqTxBuffer);
-	}
+    XTime_GetTime(&xNow);
 
-	// Assert the Slave Select, then wait a bit so it takes affect
-	XSpi_WriteReg(qBaseAddress, XSP_SSR_OFFSET, xSPI_Channel);
-	vTaskDelay(xOneMs); //usleep(100);
-
-	/*
-	 * Disable the Inhibit bit in the AXI SPI Controller's controler register
-	 * This will release the AXI SPI Controller to release the transaction onto the bus
-	 */
-	XSpi_WriteReg(qBaseAddress, XSP_CR_OFFSET, MAX31855_CR_UNINHIBIT_MODE);
-
-	/*
-	 * Wait for the AXI SPI controller's transmit FIFO to transition to empty
-	 * to make sure all the transmit data gets sent
-	 */
-	while (!(XSpi_ReadReg(qBaseAddress, XSP_SR_OFFSET) & XSP_SR_TX_EMPTY_MASK));
-
-	/*
-	 * Wait for the AXI SPI controller's Receive FIFO Occupancy register to
-	 * show the expected number of receive bytes before attempting to read
-	 * the Rx FIFO. Note the Occupancy Register shows Rx Bytes - 1
-	 *
-	 * If xByteCount number of bytes is sent, then by design, there must be
-	 * xByteCount number of bytes received
-	 */
-	xByteCount--;
-	while(xByteCount != XSpi_ReadReg(qBaseAddress, XSP_RFO_OFFSET)) {
-		;
-	}
-	xByteCount++;
-
-	/*
-	 * The AXI SPI Controller's Rx FIFO has now received TxByteCount number
-	 * of bytes off the SPI bus and is ready to be read.
-	 *
-	 * Transfer the Rx bytes out of the Controller's Rx FIFO into our code
-	 * Keep reading one byte at a time until the Rx FIFO is empty
-	 */
-	xNumBytesRcvd = 0;
-	while ((XSpi_ReadReg(qBaseAddress, XSP_SR_OFFSET) & XSP_SR_RX_EMPTY_MASK) == 0)
-	{
-		*pqRxBuffer++ = XSpi_ReadReg(qBaseAddress, XSP_DRR_OFFSET);
-		xNumBytesRcvd++;
-	}
+    /* With the tick suppressed, a latency that keeps growing shows the tick
+     * losing time. */
+    xDue = pSystem->xWakeBaseTime +
+            (XTime)(xWakeTime - pSystem->xWakeBaseTick) * UZED_COUNTS_PER_TICK;
 
-	// Now that the Rx Data is retrieved, inhibit the AXI SPI Controller
-	XSpi_WriteReg(qBaseAddress, XSP_CR_OFFSET, MAX31855_CR_INIT_MODE);
-	// Deassert the Slave Select
-	XSpi_WriteReg(qBaseAddress, XSP_SSR_OFFSET, PL_SPI_CHANNEL_SEL_NONE);
-
-	/*
-	 * If no data was sent or if we didn't receive as many bytes as
-	 * were transmitted, then flag a failure
-	 */
-	if (xByteCount != xNumBytesRcvd) {
-		pSystem->rc = ((xByteCount & 0xf) << 4) | (xNumBytesRcvd & 0xf);
-        pSystem->pcErr = "XSpi_LowLevelExecute() -> 0x%08x\r\n";
-		return;
-	}
-
-	pSystem->rc = XST_SUCCESS;
-	return;
-}
-
-/**
- * @brief Sample Barometer and publish values
- *
- * @param[in] pSystem			System handle
- */
-static void SamplePLTempSensor(System* pSystem)
-{
-	// TxBuffer is not used to communicate with the MAX31855 but it is still necessary
-	//      for the XSPI utilities to function
-	u32 pqTxBuffer[4] = {0,0,0,0};
-	u32 pqRxBuffer[4] = {~0,~0,~0,~0};	// Initialize RxBuffer with all 1's
-	s32 sqTemporaryValue = 0;
-	s32 sqTemporaryValue2 = 0;
-	float fMAX31855_internal_temp = 0.0f;
-	float fMAX31855_thermocouple_temp = 0.0f;
-
-    if(!pSystem->bThermocoupleOk) {
-        return;
+    if(xNow > xDue) {
+        ulLatency = (uint32_t)(((xNow - xDue) * 2000000ULL) / XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ);
     }
-    pSystem->rc = XST_SUCCESS;
-
-	// Execute 4-byte read transaction.
-	MAY_DIE({
-        XSpi_LowLevelExecute(pSystem, (u32)PL_SPI_BASEADDR, (BaseType_t)PL_SPI_CHANNEL_SEL_0, (BaseType_t)4, pqTxBuffer, pqRxBuffer );
-        if(XST_SUCCESS == pSystem->rc) {
-            if(0) {
-                ;
-            } else if(pqRxBuffer[3] & 0x1) {
-                pSystem->rc = XST_FAILURE;
-                pSystem->pcErr = "Thermocouple: Open Circuit\r\n";
-            } else if(pqRxBuffer[3] & 0x2) {
-                pSystem->rc = XST_FAILURE;
-                pSystem->pcErr = "Thermocouple: Short to GND\r\n";
-            } else if(pqRxBuffer[3] & 0x4) {
-                pSystem->rc = XST_FAILURE;
-                pSystem->pcErr = "Thermocouple: Short to VCC\r\n";
-            } else if(pqRxBuffer[1] & 0x01) {
-                pSystem->rc = XST_FAILURE;
-                pSystem->pcErr = "Thermocouple: Fault\r\n";
-            }
-        }
-	});
 
-    // Internal Temp
-    {
-        sqTemporaryValue = pqRxBuffer[2];  			// bits 11..4
-        sqTemporaryValue = sqTemporaryValue << 4;		// shift left to make room for bits 3..0
-        sqTemporaryValue2 = pqRxBuffer[3];				// bits 3..0 in the most significant spots
-        sqTemporaryValue2 = sqTemporaryValue2 >> 4;	// shift right to get rid of extra bits and position
-        sqTemporaryValue |= sqTemporaryValue2;		// Combine to get bits 11..0
-        if((pqRxBuffer[2] & 0x80) == 0x80) {				// Check the sign bit and sign-extend if need be
-            sqTemporaryValue |= 0xFFFFF800;
-        }
-        fMAX31855_internal_temp = (float)sqTemporaryValue / 16.0f;
-        pSystem->fThermocoupleBoardTemperature = fMAX31855_internal_temp;
+    if(ulLatency > pSystem->ulMaxWakeLatency) {
+        pSystem->ulMaxWakeLatency = ulLatency;
     }
 
-    // Thermocouple Temp
-    {
-        sqTemporaryValue = pqRxBuffer[0];  			// bits 13..6
-        sqTemporaryValue = sqTemporaryValue << 6;		// shift left to make room for bits 5..0
-        sqTemporaryValue2 = pqRxBuffer[1];				// bits 5..0 in the most significant spots
-        sqTemporaryValue2 = sqTemporaryValue2 >> 2;	// shift right to get rid of extra bits and position
-        sqTemporaryValue |= sqTemporaryValue2;		// Combine to get bits 13..0
-        if((pqRxBuffer[0] & 0x80) == 0x80) {				// Check the sign bit and sign-extend if need be
-            sqTemporaryValue |= 0xFFFFE000;
-        }
-        fMAX31855_thermocouple_temp = (float)sqTemporaryValue / 4.0f;
-        pSystem->fThermocoupleTemperature = fMAX31855_thermocouple_temp;
+    if(++pSystem->ulWakeSamples == UZED_WAKE_LATENCY_REPORT_SAMPLES) {
+        configPRINTF( ( "Wake latency: maximum %u us over %u periods\r\n",
+                pSystem->ulMaxWakeLatency, pSystem->ulWakeSamples ) );
+        pSystem->ulMaxWakeLatency = 0;
+        pSystem->ulWakeSamples = 0;
     }
-    return;
-
-L_DIE:
-    return;
 }
 
+#endif
+
 /*--------------------------------------------------------------------------------*/
 
 static void StartSystem(System* pSystem)
 {
-	XIic_Config *pI2cConfig;
 	XGpioPs_Config* pGpioConfig;
     int iLen;
 
     /*-----------------------------------------------------------------*/
 
 	pSystem->bError = 0;
-    pSystem->bBarometerOk = 0;
-    pSystem->bHygrometerOk = 0;
-    pSystem->bThermocoupleOk = 0;
 
     pSystem->rc = XST_SUCCESS;
     pSystem->pcErr = "\r\n";
@@ -1616,6 +740,26 @@ static void StartSystem(System* pSystem)
         }
     });
 
+#if UZED_PUBLISH_HEAP_TRACE
+    MAY_DIE({
+        iLen = snprintf(
+            (char*)pSystem->pbHeapTraceTopic,
+            SYSTEM_HEAP_TRACE_TOPIC_LENGTH+1,
+            "compressor/%s-gateway-ultra96/heap_trace",
+            clientcredentialGG_GROUP
+            );
+        if((iLen < 0) || (iLen > SYSTEM_HEAP_TRACE_TOPIC_LENGTH)) {
+            pSystem->pbHeapTraceTopic[0] = 0;
+            pSystem->usHeapTraceTopicLength = 0;
+            pSystem->rc = XST_FAILURE;
+            pSystem->pcErr = "Cannot compose heap trace topic: GroupID too long\r\n";
+        } else {
+            pSystem->pbHeapTraceTopic[SYSTEM_HEAP_TRACE_TOPIC_LENGTH] = 0;
+            pSystem->usHeapTraceTopicLength = (uint16_t)strlen((const char*)pSystem->pbHeapTraceTopic);
+        }
+    });
+#endif
+
     /*-----------------------------------------------------------------*/
 
 	pGpioConfig = XGpioPs_LookupConfig(XPAR_PS7_GPIO_0_DEVICE_ID);
@@ -1631,19 +775,30 @@ static void StartSystem(System* pSystem)
 
     /*-----------------------------------------------------------------*/
 
-	pI2cConfig = XIic_LookupConfig(XPAR_IIC_0_DEVICE_ID);
-	configASSERT(pI2cConfig != NULL);
-
+#if UZED_USE_AMP
+    /*
+     * Format the ring, then release CPU1 from the boot ROM to sample into it
+     */
+	uzedAMP_MAP_RING();
 	MAY_DIE({
-		pSystem->rc = XIic_CfgInitialize(&pSystem->iic, pI2cConfig,	pI2cConfig->BaseAddress);
-		pSystem->pcErr = "XIic_CfgInitialize() -> 0x%08x\r\n";
+		if((pdPASS != AMP_RingFormat((void*)uzedAMP_RING_ADDRESS, uzedAMP_RING_SIZE, sizeof(UZedSensorSample))) ||
+		   (pdPASS != AMP_RingAttach(&pSystem->xRing, (void*)uzedAMP_RING_ADDRESS, uzedAMP_RING_SIZE))) {
+			pSystem->rc = XST_FAILURE;
+			pSystem->pcErr = "AMP_RingFormat() -> 0x%08x\r\n";
+		}
 	});
-	XIic_IntrGlobalDisable(pI2cConfig->BaseAddress);
+	pSystem->ulLastSequence = 0;
+	pSystem->ulLastDropped = 0;
 
+	Xil_Out32(uzedAMP_CPU1_WAKE_ADDRESS, uzedAMP_CPU1_START_ADDRESS);
+	dsb();
+	__asm__ __volatile__ ("sev");
+#else
 	MAY_DIE({
-		pSystem->rc = XIic_Start(&pSystem->iic);
-		pSystem->pcErr = "XIic_Start() -> 0x%08x\r\n";
+		pSystem->rc = UZedSensorsStart(&pSystem->tSensors);
+		pSystem->pcErr = "UZedSensorsStart() -> 0x%08x\r\n";
 	});
+#endif
 
 
     /*-----------------------------------------------------------------*/
@@ -1656,15 +811,6 @@ static void StartSystem(System* pSystem)
 		}
 	});
 
-	/*-----------------------------------------------------------------*/
-
-    /*
-     * Ignore system error, as each sensor has its own OK and will skip sampling
-     */
-    StartBarometer(pSystem);
-    StartPLTempSensor(pSystem);
-    StartHygrometer(pSystem);
-
     /*-----------------------------------------------------------------*/
 
 	configPRINTF( ( "System started\r\n" ) );
@@ -1685,13 +831,9 @@ static void StopSystem(System* pSystem)
 		( void ) MQTT_AGENT_Disconnect( pSystem->xMQTTHandle, democonfigMQTT_TIMEOUT );
 	}
 
-	StopHygrometer(pSystem);
-	StopPLTempSensor(pSystem);
-	StopBarometer(pSystem);
-
-	if(pSystem->iic.IsReady) {
-		XIic_Stop(&pSystem->iic);
-	}
+#if !UZED_USE_AMP
+	UZedSensorsStop(&pSystem->tSensors);
+#endif
 
 	BlinkLed(pSystem, 5, pdFALSE);
 
@@ -1717,6 +859,10 @@ static void prvUZedIotTask( void * pvParameters )
 	/* MQTT client is now connected to a broker.  Publish or perish! */
     /* Initialise the xLastWakeTime variable with the current time. */
     xPreviousWakeTime = xTaskGetTickCount();
+#if UZED_MEASURE_WAKE_LATENCY
+    pSystem->xWakeBaseTick = xPreviousWakeTime;
+    XTime_GetTime(&pSystem->xWakeBaseTime);
+#endif
 
     /*
      * Ignore errors in loop and continue forever
@@ -1725,14 +871,22 @@ static void prvUZedIotTask( void * pvParameters )
 	for(;;) {
 		// Line up with next period boundary
 		vTaskDelayUntil( &xPreviousWakeTime, xSamplingPeriod );
+#if UZED_MEASURE_WAKE_LATENCY
+		prvMeasureWakeLatency(pSystem, xPreviousWakeTime);
+#endif
 
 		// Publish all sensors
-        pSystem->bError = 0;
-		SampleBarometer(pSystem);
-		SamplePLTempSensor(pSystem);
-		SampleHygrometer(pSystem);
+#if UZED_USE_AMP
+        prvReceiveSensors(pSystem);
+#else
+		UZedSensorsSample(&pSystem->tSensors);
+#endif
+        pSystem->bError = pSystem->tSensors.bError;
 
         prvPublishSensors(pSystem);
+#if UZED_PUBLISH_HEAP_TRACE
+        prvPublishHeapTrace(pSystem);
+#endif
         if((pSystem->bLastReportedError != pSystem->bError) || bFirst) {
             pSystem->bLastReportedError = pSystem->bError;
             prvPublishShadow(pSystem);
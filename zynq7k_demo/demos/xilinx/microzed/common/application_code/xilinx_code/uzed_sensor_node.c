@@ -0,0 +1,135 @@
+/*
+ * Amazon FreeRTOS MQTT UZed Demo V1.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file uzed_sensor_node.c
+ * @brief The CPU1 side of the MicroZed IOT demo in AMP: samples the sensors
+ * at a fixed period and writes each sample to the ring read by CPU0.
+ *
+ * The sampling period does not depend on the network, as CPU1 runs nothing
+ * else. A sample that does not fit because CPU0 has fallen behind is dropped
+ * and counted by the ring, rather than delaying the next sample.
+ */
+#include "string.h"
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* AMP includes. */
+#include "aws_amp_ring.h"
+
+/* Demo includes. */
+#include "xil_types.h"
+#include "xstatus.h"
+#include "uzed_sensors.h"
+#include "uzed_amp.h"
+
+#if UZED_USE_AMP
+
+#define democonfigUZED_SENSOR_NODE_TASK_STACK_SIZE		( configMINIMAL_STACK_SIZE * 4 )
+#define democonfigUZED_SENSOR_NODE_TASK_PRIORITY		( tskIDLE_PRIORITY + 1 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Samples the sensors into the ring, forever
+ *
+ * @param[in] pvParameters Unused
+ */
+static void prvUZedSensorNodeTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static void prvUZedSensorNodeTask( void * pvParameters )
+{
+	TickType_t xPreviousWakeTime;
+    const TickType_t xSamplingPeriod = MS_TO_TICKS( uzedAMP_SAMPLING_PERIOD_MS );
+    static UZedSensors tSensors;
+    AmpRing_t xRing;
+    UZedSensorSample tSample;
+
+	/* Avoid compiler warnings about unused parameters. */
+    ( void ) pvParameters;
+
+    uzedAMP_MAP_RING();
+
+    /*
+     * CPU0 formats the ring before releasing this core, so this only waits
+     * if this image was started some other way, such as from the debugger
+     */
+    while(pdPASS != AMP_RingAttach(&xRing, (void*)uzedAMP_RING_ADDRESS, uzedAMP_RING_SIZE)) {
+        vTaskDelay(xSamplingPeriod);
+    }
+
+    if(XST_SUCCESS != UZedSensorsStart(&tSensors)) {
+        configPRINTF( ( "ERROR: Sensor node cannot start I2C\r\n" ) );
+        vTaskDelete( NULL );
+    }
+
+    memset(&tSample, 0, sizeof(tSample));
+    xPreviousWakeTime = xTaskGetTickCount();
+	for(;;) {
+		// Line up with next period boundary
+		vTaskDelayUntil( &xPreviousWakeTime, xSamplingPeriod );
+
+        UZedSensorsSample(&tSensors);
+
+        tSample.ulSequence++;
+        tSample.ulTimestamp = ( uint32_t ) xTaskGetTickCount();
+        tSample.bError = tSensors.bError;
+        tSample.bBarometerOk = tSensors.bBarometerOk;
+        tSample.bHygrometerOk = tSensors.bHygrometerOk;
+        tSample.bThermocoupleOk = tSensors.bThermocoupleOk;
+        tSample.fBarometerPressure = tSensors.fBarometerPressure;
+        tSample.fBarometerTemperature = tSensors.fBarometerTemperature;
+        tSample.fHygrometerHumidity = tSensors.fHygrometerHumidity;
+        tSample.fHygrometerTemperature = tSensors.fHygrometerTemperature;
+        tSample.fThermocoupleTemperature = tSensors.fThermocoupleTemperature;
+        tSample.fThermocoupleBoardTemperature = tSensors.fThermocoupleBoardTemperature;
+
+        // Never wait for CPU0: a full ring drops and counts the sample
+        ( void ) AMP_RingWrite(&xRing, &tSample, sizeof(tSample));
+	}
+}
+
+/*-----------------------------------------------------------*/
+
+void vStartUZedSensorNode( void )
+{
+    configPRINTF( ( "Creating UZedSensorNode Task...\r\n" ) );
+
+    ( void ) xTaskCreate( prvUZedSensorNodeTask,                     /* The function that implements the task. */
+                          "UZedSensorNode",                          /* The name to assign to the task being created. */
+                          democonfigUZED_SENSOR_NODE_TASK_STACK_SIZE,  /* The size, in WORDS (not bytes), of the stack to allocate for the task being created. */
+                          NULL,                                      /* The task parameter is not being used. */
+                          democonfigUZED_SENSOR_NODE_TASK_PRIORITY,    /* The priority at which the task being created will run. */
+                          NULL                                       /* Not storing the task's handle. */
+                        );
+}
+
+#endif /* UZED_USE_AMP */
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,1185 @@
+/*
+ * Amazon FreeRTOS MQTT UZed Demo V1.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file uzed_sensors.c
+ * @brief Drivers for the sensors of the MicroZed IOT Kit.
+ *
+ */
+#include "string.h"
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "xil_types.h"
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xiic.h"
+#include "xspi_l.h"
+#include "uzed_sensors.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief This is the LPS25HB on the Arduino shield board
+ */
+#define BAROMETER_SLAVE_ADDRESS		0x5D
+/**
+ * @brief This is the HTS221 on the Arduino shield board
+ */
+#define HYGROMETER_SLAVE_ADDRESS	0x5F
+
+
+/**
+ * @brief Barometer register defines
+ */
+#define BAROMETER_REG_REF_P_XL			0x15
+#define BAROMETER_REG_REF_P_L			0x16
+#define BAROMETER_REG_REF_P_H			0x17
+#define BAROMETER_REG_WHO_AM_I			0x0F
+#define BAROMETER_REG_RES_CONF			0x1A
+
+#define BAROMETER_REG_CTRL_REG1			0x10
+#define BAROMETER_BFLD_PD				(0<<7)
+#define BAROMETER_ODR_2					(0<<6)
+#define BAROMETER_ODR_1					(0<<5)
+#define BAROMETER_ODR_0					(0<<4)
+#define BAROMETER_ENABLE_LPFP				(0<<3)
+#define BAROMETER_LPFP_CFG				(0<<2)
+#define BAROMETER_BDU					(0<<1)
+#define BAROMETER_SIM					(0<<0)
+
+
+#define BAROMETER_REG_CTRL_REG2			0x11
+#define BAROMETER_BFLD_BOOT				(1<<7)
+#define BAROMETER_FIFO_ENABLE				(0<<6)
+#define BAROMETER_STOP_ON_FTH				(0<<5)
+#define BAROMETER_IF_ADD_INC				(1<<4)
+#define BAROMETER_I2C_DIS				(0<<3)
+#define BAROMETER_BFLD_SWRESET				(1<<2)
+#define BAROMETER_BFLD_ZEROBIT                          (0<<1)
+#define BAROMETER_BFLD_ONE_SHOT				(1<<0)
+
+#define BAROMETER_REG_CTRL_REG3			0x12
+#define BAROMETER_REG_INTERRUPT_CFG		0x0B
+#define BAROMETER_REG_INT_SOURCE		0x25
+
+#define BAROMETER_REG_STATUS_REG		0x27
+#define BAROMETER_BFLD_P_DA				(1<<0)
+#define BAROMETER_BFLD_T_DA				(1<<1)
+
+#define BAROMETER_REG_PRESS_OUT_XL		0x28
+#define BAROMETER_REG_PRESS_OUT_L		0x29
+#define BAROMETER_REG_PRESS_OUT_H		0x2A
+#define BAROMETER_REG_TEMP_OUT_L		0x2B
+#define BAROMETER_REG_TEMP_OUT_H		0x2C
+#define BAROMETER_REG_FIFO_CTRL			0x14
+#define BAROMETER_REG_FIFO_STATUS		0x26
+#define BAROMETER_REG_THS_P_L			0x0C
+#define BAROMETER_REG_THS_P_H			0x0D
+#define BAROMETER_REG_RPDS_L			0x18
+#define BAROMETER_REG_RPDS_H			0x19
+
+/**
+ * @brief Hygrometer register defines
+ */
+#define HYGROMETER_REG_WHO_AM_I			0x0F
+#define HYGROMETER_REG_AV_CONF			0x10
+
+#define HYGROMETER_REG_CTRL_REG1		0x20
+#define HYGROMETER_BFLD_PD				(1<<7)
+
+#define HYGROMETER_REG_CTRL_REG2		0x21
+#define HYGROMETER_BFLD_BOOT			(1<<7)
+#define HYGROMETER_BFLD_ONE_SHOT		(1<<0)
+
+#define HYGROMETER_REG_CTRL_REG3		0x22
+
+#define HYGROMETER_REG_STATUS_REG		0x27
+#define HYGROMETER_BFLD_H_DA			(1<<1)
+#define HYGROMETER_BFLD_T_DA			(1<<0)
+
+#define HYGROMETER_REG_HUMIDITY_OUT_L	0x28
+#define HYGROMETER_REG_HUMIDITY_OUT_H	0x29
+#define HYGROMETER_REG_TEMP_OUT_L		0x2A
+#define HYGROMETER_REG_TEMP_OUT_H		0x2B
+
+#define HYGROMETER_REG_CALIB_0			0x30	// Convenience define for beginning of calibration registers
+#define HYGROMETER_REG_H0_rH_x2			0x30
+#define HYGROMETER_REG_H1_rH_x2			0x31
+#define HYGROMETER_REG_T0_degC_x8		0x32
+#define HYGROMETER_REG_T1_degC_x8		0x33
+#define HYGROMETER_REG_T1_T0_MSB		0x35
+#define HYGROMETER_REG_H0_T0_OUT_LSB	0x36
+#define HYGROMETER_REG_H0_T0_OUT_MSB	0x37
+#define HYGROMETER_REG_H1_T0_OUT_LSB	0x3A
+#define HYGROMETER_REG_H1_T0_OUT_MSB	0x3B
+#define HYGROMETER_REG_T0_OUT_LSB		0x3C
+#define HYGROMETER_REG_T0_OUT_MSB		0x3D
+#define HYGROMETER_REG_T1_OUT_LSB		0x3E
+#define HYGROMETER_REG_T1_OUT_MSB		0x3F
+
+/**
+ * @brief AXI QSPI Temperature sensor defines
+ */
+#define PL_SPI_BASEADDR			XPAR_AXI_QUAD_SPI_0_BASEADDR  // Base address for AXI SPI controller
+
+#define PL_SPI_CHANNEL_SEL_0		0xFFFFFFFE					// Select spi channel 0
+#define PL_SPI_CHANNEL_SEL_1		0xFFFFFFFD					// Select spi channel 1
+#define PL_SPI_CHANNEL_SEL_NONE		0xFFFFFFFF					// Deselect all SPI channels
+
+// Initialization settings for the AXI SPI controller's Control Register when addressing the MAX31855
+// 0x186 = b1_1000_0110
+//			1	Inhibited to hold off transactions starting
+//			1	Manually select the slave
+//			0	Do not reset the receive FIFO at this time
+//			0	Do not reset the transmit FIFO at this time
+//			0	Clock phase of 0
+//			0	Clock polarity of low
+//			1	Enable master mode
+//			1	Enable the SPI Controller
+//			0	Do not put in loopback mode
+
+#define MAX31855_CLOCK_PHASE_CPHA		0
+#define MAX31855_CLOCK_POLARITY_CPOL	0
+
+#define MAX31855_CR_INIT_MODE		XSP_CR_TRANS_INHIBIT_MASK | XSP_CR_MANUAL_SS_MASK   | \
+									XSP_CR_MASTER_MODE_MASK   | XSP_CR_ENABLE_MASK
+#define MAX31855_CR_UNINHIBIT_MODE	                            XSP_CR_MANUAL_SS_MASK   | \
+									XSP_CR_MASTER_MODE_MASK   | XSP_CR_ENABLE_MASK
+#define AXI_SPI_RESET_VALUE			0x0A  //!< Reset value for the AXI SPI Controller
+
+/**
+ * @brief Utility macro to uniformly process errors
+ */
+#define MAY_DIE(code)	\
+	{ \
+	    code; \
+		if(pSensors->rc != XST_SUCCESS) { \
+            pSensors->bError = 1; \
+			configPRINTF( (pSensors->pcErr, pSensors->rc ) ); \
+			StopHere(); \
+			goto L_DIE; \
+		} \
+	}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Convenience function for breakpoints
+ */
+static void StopHere(void);
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Read multiple IIC registers
+ *
+ * @param[in] pSensors			Sensors handle
+ * @param[in] bSlaveAddress		Slave address on bus
+ * @param[in] xCount			Number of registers to read
+ * @param[in] bFirstSlaveReg	First register number on device
+ * @param[in] pbBuf				Byte buffer to deposit data read from device
+ */
+static int ReadIicRegs(UZedSensors* pSensors,u8 bSlaveAddress,BaseType_t xCount,u8 bFirstSlaveReg,u8* pbBuf);
+
+/**
+ * @brief Read single IIC register
+ *
+ * @param[in] pSensors		Sensors handle
+ * @param[in] bSlaveAddress	Slave address on bus
+ * @param[in] bSlaveReg		Register number on slave device
+ * @param[in] pbBuf			Byte buffer to deposit data read from device
+ */
+static int ReadIicReg(UZedSensors* pSensors,u8 bSlaveAddress,u8 bSlaveReg,u8* pbBuf);
+
+/**
+ * @brief Write multiple IIC registers
+ *
+ * @param[in] pSensors		Sensors handle
+ * @param[in] bSlaveAddress	Slave address on bus
+ * @param[in] xCount		Number of registers to write
+ * @param[in] pbBuf			Byte buffer with data to write - >= 2 bytes - first byte is always register number on slave device
+ */
+static int WriteIicRegs(UZedSensors* pSensors,u8 bSlaveAddress,BaseType_t xCount,u8* pbBuf);
+
+/**
+ * @brief Write single IIC register
+ *
+ * @param[in] pSensors	Sensors handle
+ * @param[in] bSlaveAddress	Slave address on bus
+ * @param[in] bSlaveReg	Register number on slave device
+ * @param[in] pbBuf		Byte buffer with data to write - 2 bytes - first byte is always register number on slave device
+ */
+static int WriteIicReg(UZedSensors* pSensors,u8 bSlaveAddress,u8 bSlaveReg,u8 bVal);
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Start Barometer
+ *
+ * @param[in] pSensors	Sensors handle
+ */
+static void StartBarometer(UZedSensors* pSensors);
+
+/**
+ * @brief Stop Barometer
+ *
+ * @param[in] pSensors	Sensors handle
+ */
+static void StopBarometer(UZedSensors* pSensors);
+
+
+/**
+ * @brief Sample Barometer and publish values
+ *
+ * @param[in] pSensors			Sensors handle
+ */
+static void SampleBarometer(UZedSensors* pSensors);
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Start Hygrometer
+ *
+ * @param[in] pSensors	Sensors handle
+ */
+static void StartHygrometer(UZedSensors* pSensors);
+
+/**
+ * @brief Stop Hygrometer
+ *
+ * @param[in] pSensors	Sensors handle
+ */
+static void StopHygrometer(UZedSensors* pSensors);
+
+
+/**
+ * @brief Sample Hygrometer and publish values
+ *
+ * @param[in] pSensors			Sensors handle
+ */
+static void SampleHygrometer(UZedSensors* pSensors);
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Start PL Temperature Sensor
+ *
+ * @param[in] pSensors	Sensors handle
+ */
+static void StartPLTempSensor(UZedSensors* pSensors);
+
+/**
+ * @brief Stop PL Temperature Sensor
+ *
+ * @param[in] pSensors	Sensors handle
+ */
+static void StopPLTempSensor(UZedSensors* pSensors);
+
+/**
+ * @brief PL Temperature Sensor: utility function to do SPI transaction
+ *
+ * @param[in] 	pSensors			Sensors handle
+ * @param[in] 	qBaseAddress	AXI SPI Controller Base Address
+ * @param[in] 	xSPI_Channel	SPI Channel to use
+ * @param[in] 	xByteCount		Number of bytes to transfer
+ * @param[in] 	pqTxBuffer		Data to send
+ * @param[out] 	pqRxBuffer		Data to receive
+ */
+static void XSpi_LowLevelExecute(UZedSensors* pSensors, u32 qBaseAddress, BaseType_t xSPI_Channel, BaseType_t xByteCount, const u32* pqTxBuffer, u32* pqRxBuffer);
+
+/**
+ * @brief Sample Barometer and publish values
+ *
+ * @param[in] pSensors			Sensors handle
+ */
+static void SamplePLTempSensor(UZedSensors* pSensors);
+
+/*--------------------------------------------------------------------------------*/
+static void StopHere(void)
+{
+	;
+}
+
+/*--------------------------------------------------------------------------------*/
+
+static int ReadIicRegs(UZedSensors* pSensors,u8 bSlaveAddress,BaseType_t xCount,u8 bFirstSlaveReg,u8* pbBuf)
+{
+	BaseType_t xReceived;
+
+	if(xCount > 1) {
+		bFirstSlaveReg |= 0x80;
+	}
+
+	MAY_DIE({
+		if(1 != XIic_Send(pSensors->iic.BaseAddress,bSlaveAddress,&bFirstSlaveReg,1,XIIC_REPEATED_START)) {
+			pSensors->rc = 1;
+			pSensors->pcErr = "ReadIicRegs::XIic_Send(Addr) -> 0x%08x\r\n";
+		}
+	});
+	MAY_DIE({
+		xReceived = XIic_Recv(pSensors->iic.BaseAddress,bSlaveAddress,pbBuf,xCount,XIIC_STOP);
+		if(xReceived != xCount) {
+			pSensors->rc = ((xReceived & 0xf) << 4) | (xCount & 0xf);
+			pSensors->pcErr = "ReadIicRegs::XIic_Recv(Data) -> 0x%08x\r\n";
+		}
+	});
+
+L_DIE:
+	return pSensors->rc;
+}
+
+static int ReadIicReg(UZedSensors* pSensors, u8 bSlaveAddress, u8 bFirstSlaveReg, u8* pbBuf)
+{
+	return ReadIicRegs(pSensors, bSlaveAddress, 1, bFirstSlaveReg, pbBuf);
+}
+
+static int WriteIicRegs(UZedSensors* pSensors, u8 bSlaveAddress, BaseType_t xCount, u8* pbBuf)
+{
+	BaseType_t xSent;
+
+	if(xCount > 2) {
+		pbBuf[0] |= 0x80;
+	}
+
+	MAY_DIE({
+		xSent = XIic_Send(pSensors->iic.BaseAddress,bSlaveAddress,pbBuf,xCount,XIIC_STOP);
+		if(xCount != xSent) {
+			pSensors->rc = ((xSent & 0xf) << 4) | (xCount & 0xf);
+			pSensors->pcErr = "WriteIicRegs::XIic_Send(Buf) -> 0x%08x\r\n";
+		}
+	});
+
+L_DIE:
+	return pSensors->rc;
+}
+
+static int WriteIicReg(UZedSensors* pSensors,u8 bSlaveAddress, u8 bFirstSlaveReg, u8 bVal)
+{
+	u8 pbBuf[2];
+
+	pbBuf[0] = bFirstSlaveReg;
+	pbBuf[1] = bVal;
+	return WriteIicRegs(pSensors, bSlaveAddress, 2, pbBuf);
+}
+
+/*--------------------------------------------------------------------------------*/
+
+static void StartBarometer(UZedSensors* pSensors)
+{
+	u8 b;
+	int iTimeout;
+	TickType_t xOneMs = MS_TO_TICKS( 1 );
+
+    pSensors->bBarometerOk = pdFALSE;
+    pSensors->fBarometerPressure = 0;
+    pSensors->fBarometerTemperature = 0;
+
+	// Verify it is the right chip
+	MAY_DIE({
+		ReadIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_WHO_AM_I,&b);
+		pSensors->pcErr = "ReadIicReg(WHO_AM_I) -> 0x%08x\r\n";
+	});
+
+	MAY_DIE({
+		if(0xB1 != b) {
+			pSensors->rc = b?b:1;
+			pSensors->pcErr = "BAROMETER_WHO_AM_I = 0x%08x != 0xB1\r\n";
+		}
+	});
+
+	// Reset chip: first swreset, then boot
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_BFLD_SWRESET);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BFLD_SWRESET) -> 0x%08x\r\n";
+	});
+	for(iTimeout = 100; iTimeout-- > 0; ) {
+		MAY_DIE({
+			ReadIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,&b);
+			pSensors->pcErr = "ReadIicReg(BAROMETER_REG_CTRL_REG2) -> 0x%08x\r\n";
+		});
+		if(0 == (b & BAROMETER_BFLD_SWRESET)) {
+			break;
+		}
+		vTaskDelay(xOneMs);
+	}
+	if(iTimeout <= 0) {
+		MAY_DIE({
+			pSensors->rc = XST_FAILURE;
+			pSensors->pcErr = "Barometer swreset timeout\r\n";
+		});
+	}
+
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_BFLD_BOOT);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BAROMETER_BFLD_BOOT -> 0x%08x\r\n";
+	});
+	for(iTimeout = 100; iTimeout-- > 0; ) {
+		MAY_DIE({
+			ReadIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,&b);
+			pSensors->pcErr = "ReadIicReg(BAROMETER_REG_CTRL_REG2) -> 0x%08x\r\n";
+		});
+		if(0 == (b & BAROMETER_BFLD_BOOT)) {
+			break;
+		}
+		vTaskDelay(xOneMs);
+	}
+	if(iTimeout <= 0) {
+		MAY_DIE({
+			pSensors->rc = XST_FAILURE;
+			pSensors->pcErr = "Barometer boot timeout\r\n";
+		});
+	}
+
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_BFLD_ZEROBIT);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BAROMETER_BFLD_ZEROBIT -> 0x%08x\r\n";
+	});
+
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_FIFO_ENABLE);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BAROMETER_FIFO_ENABLE -> 0x%08x\r\n";
+	});
+
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_STOP_ON_FTH);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BAROMETER_STOP_ON_FTH -> 0x%08x\r\n";
+	});
+	
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_IF_ADD_INC);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BAROMETER_IF_ADD_INC -> 0x%08x\r\n";
+	});
+
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2, BAROMETER_I2C_DIS);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_I2C_DIS) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_ODR_2);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_ODR_2) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_ODR_1);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_ODR_1) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_ODR_0);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_ODR_0) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_ENABLE_LPFP);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_ENABLE_LPFP) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_LPFP_CFG);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_LPFP_CFG) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_BDU);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_BDU) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_SIM);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_SIM) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG1,BAROMETER_BFLD_PD);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG1::BAROMETER_BFLD_PD) -> 0x%08x\r\n";
+	});
+	vTaskDelay(xOneMs);
+
+    pSensors->bBarometerOk = pdTRUE;
+	configPRINTF( ( "Barometer started ok\r\n" ) );
+    return;
+
+L_DIE:
+	configPRINTF( ( "ERROR: Barometer started not ok\r\n" ) );
+	return;
+}
+
+static void StopBarometer(UZedSensors* pSensors)
+{
+    pSensors->bBarometerOk = pdFALSE;
+}
+
+static void SampleBarometer(UZedSensors* pSensors)
+{
+	BaseType_t xTimeout;
+	u8 b;
+	u8 pbBuf[6];
+	s32 sqTmp;
+	float f;
+ 	u8 count = 0;
+	TickType_t xOneMs = MS_TO_TICKS( 1 );
+
+    if(!pSensors->bBarometerOk) {
+        return;
+    }
+    pSensors->rc = XST_SUCCESS;
+
+	/*
+	 * NOTE: The one shot auto clears but it seems to take 36ms
+	 * Our sampling period is >= 100ms so the one shot will auto clear by the next sample time
+	 */
+	MAY_DIE({
+		WriteIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,BAROMETER_BFLD_ONE_SHOT);
+		pSensors->pcErr = "WriteIicReg(BAROMETER_REG_CTRL_REG2::BAROMETER_BFLD_ONE_SHOT) -> 0x%08x\r\n";
+	});
+	for(xTimeout = 50; xTimeout-- > 0; ) {
+		MAY_DIE({
+			ReadIicReg(pSensors,BAROMETER_SLAVE_ADDRESS,BAROMETER_REG_CTRL_REG2,&b);
+			pSensors->pcErr = "ReadIicReg(BAROMETER_REG_CTRL_REG2) -> 0x%08x\r\n";
+		});
+		if(0 == (b & BAROMETER_BFLD_ONE_SHOT)) {
+			break;
+		}
+		vTaskDelay(xOneMs);
+	}
+	MAY_DIE({
+		if(xTimeout <= 0) {
+			pSensors->rc = XST_FAILURE;
+			pSensors->pcErr = "Timed out waiting for BAROMETER_BFLD_ONE_SHOT\r\n";
+		}
+	});
+
+	for(xTimeout = 50; xTimeout-- > 0; ) {
+		MAY_DIE({
+			ReadIicRegs(pSensors,BAROMETER_SLAVE_ADDRESS,6,BAROMETER_REG_STATUS_REG,pbBuf);
+			pSensors->pcErr = "ReadIicRegs(6@BAROMETER_REG_STATUS_REG) -> 0x%08x\r\n";
+		});
+		if((BAROMETER_BFLD_P_DA | BAROMETER_BFLD_T_DA) == (pbBuf[0] & (BAROMETER_BFLD_P_DA | BAROMETER_BFLD_T_DA))) {
+			break;
+		}
+		vTaskDelay(xOneMs);
+	}
+	MAY_DIE({
+		if(xTimeout <= 0) {
+			pSensors->rc = XST_FAILURE;
+			pSensors->pcErr = "Timed out waiting for P_DA and T_DA\r\n";
+		}
+	});
+
+	for(count=1; count<6;count++)
+		pbBuf[count] = 0;
+
+        MAY_DIE({
+            ReadIicRegs(pSensors,BAROMETER_SLAVE_ADDRESS,1,BAROMETER_REG_PRESS_OUT_XL,&pbBuf[1]);
+            pSensors->pcErr = "ReadIicRegs(BAROMETER_REG_PRESS_OUT_XL) -> 0x%08x\r\n";
+        });
+
+        MAY_DIE({
+            ReadIicRegs(pSensors,BAROMETER_SLAVE_ADDRESS,1,BAROMETER_REG_PRESS_OUT_L,&pbBuf[2]);
+            pSensors->pcErr = "ReadIicRegs(BAROMETER_REG_PRESS_OUT_L) -> 0x%08x\r\n";
+        });
+
+        MAY_DIE({
+            ReadIicRegs(pSensors,BAROMETER_SLAVE_ADDRESS,1,BAROMETER_REG_PRESS_OUT_H,&pbBuf[3]);
+            pSensors->pcErr = "ReadIicRegs(BAROMETER_REG_PRESS_OUT_H) -> 0x%08x\r\n";
+        });
+
+        MAY_DIE({
+            ReadIicRegs(pSensors,BAROMETER_SLAVE_ADDRESS,1,BAROMETER_REG_TEMP_OUT_L,&pbBuf[4]);
+            pSensors->pcErr = "ReadIicRegs(BAROMETER_REG_TEMP_OUT_L) -> 0x%08x\r\n";
+        });
+
+        MAY_DIE({
+            ReadIicRegs(pSensors,BAROMETER_SLAVE_ADDRESS,1,BAROMETER_REG_TEMP_OUT_H,&pbBuf[5]);
+            pSensors->pcErr = "ReadIicRegs(BAROMETER_REG_TEMP_OUT_H) -> 0x%08x\r\n";
+        });
+		
+
+	// See ST TN1228
+	sqTmp = 0
+			| ((u32)pbBuf[1] << 0)	// xl
+			| ((u32)pbBuf[2] << 8)	// l
+			| ((u32)pbBuf[3] << 16)	// h
+			;
+	if(sqTmp & 0x00800000) {
+		sqTmp |= 0xFF800000;
+	}
+	f = (float)sqTmp / 4096.0F;
+    pSensors->fBarometerPressure = f;
+
+	sqTmp = 0
+			| ((u32)pbBuf[4] << 0)	// l
+			| ((u32)pbBuf[5] << 8)	// h
+			;
+	if(sqTmp & 0x00008000) {
+		sqTmp |= 0xFFFF8000;
+	}
+	f = (float)sqTmp/100.0;
+
+    pSensors->fBarometerTemperature = f;
+
+L_DIE:
+	return;
+}
+
+/*--------------------------------------------------------------------------------*/
+
+static void StartHygrometer(UZedSensors* pSensors)
+{
+	u8 b;
+	int iTimeout;
+	TickType_t xOneMs = MS_TO_TICKS( 1 );
+
+    pSensors->bHygrometerOk = pdFALSE;
+    pSensors->fHygrometerHumidity = 0;
+    pSensors->fHygrometerTemperature = 0;
+
+	// Verify it is the right chip
+	MAY_DIE({
+		ReadIicReg(pSensors,HYGROMETER_SLAVE_ADDRESS,HYGROMETER_REG_WHO_AM_I,&b);
+		pSensors->pcErr = "ReadIicReg(HYGROMETER_WHO_AM_I) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+		if(0xBC != b) {
+			pSensors->rc = b?b:1;
+			pSensors->pcErr = "HYGROMETER_WHO_AM_I = 0x%08x != BC\r\n";
+		}
+	});
+
+	// Reset chip: boot
+	MAY_DIE({
+		WriteIicReg(pSensors,HYGROMETER_SLAVE_ADDRESS,HYGROMETER_REG_CTRL_REG2,HYGROMETER_BFLD_BOOT);
+		pSensors->pcErr = "WriteIicReg(HYGROMETER_REG_CTRL_REG2::HYGROMETER_BFLD_BOOT -> 0x%08x\r\n";
+	});
+	for(iTimeout = 1000; iTimeout-- > 0; ) {
+		MAY_DIE({
+			ReadIicReg(pSensors,HYGROMETER_SLAVE_ADDRESS,HYGROMETER_REG_CTRL_REG2,&b);
+			pSensors->pcErr = "ReadIicReg(BAROMETER_REG_CTRL_REG2) -> 0x%08x\r\n";
+		});
+		if(0 == (b & HYGROMETER_BFLD_BOOT)) {
+			break;
+		}
+		vTaskDelay(xOneMs);
+	}
+	if(iTimeout <= 0) {
+		MAY_DIE({
+			pSensors->rc = XST_FAILURE;
+			pSensors->pcErr = "Hygrometer boot timeout\r\n";
+		});
+	}
+
+	/*
+	 * Read and store calibration values
+	 */
+	MAY_DIE({
+		ReadIicRegs(pSensors,HYGROMETER_SLAVE_ADDRESS,16,HYGROMETER_REG_CALIB_0,&pSensors->pbHygrometerCalibration[0]);
+		pSensors->pcErr = "ReadIicRegs(HYGROMETER_REG_CALIB_0) -> 0x%08x\r\n";
+	});
+
+
+	/*
+	 * Power up device
+	 */
+	MAY_DIE({
+		WriteIicReg(pSensors,HYGROMETER_SLAVE_ADDRESS,HYGROMETER_REG_CTRL_REG1,HYGROMETER_BFLD_PD);
+		pSensors->pcErr = "WriteIicReg(HYGROMETER_REG_CTRL_REG1::HYGROMETER_BFLD_PD) -> 0x%08x\r\n";
+	});
+	vTaskDelay(xOneMs);
+
+    pSensors->bHygrometerOk = pdTRUE;
+	configPRINTF( ( "Hygrometer started ok\r\n" ) );
+    return;
+
+L_DIE:
+	configPRINTF( ( "ERROR: Hygrometer started not ok\r\n" ) );
+	return;
+}
+
+static void StopHygrometer(UZedSensors* pSensors)
+{
+    pSensors->bHygrometerOk = pdFALSE;
+}
+
+static void SampleHygrometer(UZedSensors* pSensors)
+{
+	BaseType_t xTimeout;
+	u8 b;
+	u8 pbBuf[5];
+	int	H0_T0_out, H1_T0_out, H_T_out;
+	int H0_rh, H1_rh;
+	u8	buffer[2];
+	int tmp = 0;
+	u16 value = 0;
+	int T0_out, T1_out, T_out, T0_degC_x8_u16, T1_degC_x8_u16;
+	int T0_degC, T1_degC;
+	u8 buff2[4], tmp5 = 0;
+	int tmp32 = 0;
+	TickType_t xOneMs = MS_TO_TICKS( 1 );
+
+    if(!pSensors->bHygrometerOk) {
+        return;
+    }
+    pSensors->rc = XST_SUCCESS;
+
+	/*
+	 * NOTE: The one shot auto clears but it seems to take FIXME ms
+	 * Our sampling period is >= 100ms so the one shot will auto clear by the next sample time??? FIXME
+	 */
+	MAY_DIE({
+		WriteIicReg(pSensors,HYGROMETER_SLAVE_ADDRESS,HYGROMETER_REG_CTRL_REG2,HYGROMETER_BFLD_ONE_SHOT);
+		pSensors->pcErr = "WriteIicReg(HYGROMETER_REG_CTRL_REG2::HYGROMETER_BFLD_ONE_SHOT) -> 0x%08x\r\n";
+	});
+	for(xTimeout = 10000; xTimeout-- > 0; ) {
+		MAY_DIE({
+			ReadIicReg(pSensors,HYGROMETER_SLAVE_ADDRESS,HYGROMETER_REG_CTRL_REG2,&b);
+			pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_CTRL_REG2) -> 0x%08x\r\n";
+		});
+		if(0 == (b & HYGROMETER_BFLD_ONE_SHOT)) {
+			break;
+		}
+		vTaskDelay(xOneMs);
+	}
+	MAY_DIE({
+		if(xTimeout <= 0) {
+			pSensors->rc = XST_FAILURE;
+			pSensors->pcErr = "Timed out waiting for HYGROMETER_BFLD_ONE_SHOT\r\n";
+		}
+	});
+
+	for(xTimeout = 50; xTimeout-- > 0; ) {
+		MAY_DIE({
+			ReadIicRegs(pSensors,HYGROMETER_SLAVE_ADDRESS,5,HYGROMETER_REG_STATUS_REG,pbBuf);
+			pSensors->pcErr = "ReadIicRegs(6@HYGROMETER_REG_STATUS_REG) -> 0x%08x\r\n";
+		});
+		if((HYGROMETER_BFLD_H_DA | HYGROMETER_BFLD_T_DA) == (pbBuf[0] & (HYGROMETER_BFLD_H_DA | HYGROMETER_BFLD_T_DA))) {
+			break;
+		}
+		vTaskDelay(xOneMs);
+	}
+	MAY_DIE({
+		if(xTimeout <= 0) {
+			pSensors->rc = XST_FAILURE;
+			pSensors->pcErr = "Timed out waiting for HYGROMETER P_DA and T_DA\r\n";
+		}
+	});
+
+	/*
+	 * REF: ST TN1218
+	 * Interpreting humidity and temperature readings in the HTS221 digital humidity sensor
+	 */
+
+	buffer[0] = 0;
+    buffer[1] = 0;
+
+	/* 1. Read H0_rH and H1_rH coefficients */
+	MAY_DIE({
+		ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_H0_rH_x2 , &buffer[0]);
+		pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_H0_rH_x2)  -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+		ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_H1_rH_x2, &buffer[1]);
+		pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_H1_rH_x2) -> 0x%08x\r\n";
+	});
+
+	H0_rh = buffer[0]>>1;
+	H1_rh = buffer[1]>>1;
+
+	buffer[0] = 0; buffer[1] = 0;
+	/*2. Read H0_T0_OUT */ 
+
+	MAY_DIE({
+		 ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_H0_T0_OUT_LSB, &buffer[0]);
+		 pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_H0_T0_OUT_LSB) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+		 ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_H0_T0_OUT_MSB, &buffer[1]);
+		 pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_H0_T0_OUT_MSB -> 0x%08x\r\n";
+	});
+
+	H0_T0_out = (((u16)buffer[1])<<8) | (u16)buffer[0];
+
+	buffer[0] = 0; buffer[1] = 0;
+	/*3. Read H1_T0_OUT  */
+
+	MAY_DIE({
+		ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_H1_T0_OUT_LSB, &buffer[0]);
+		pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_H1_T0_OUT_LSB)  -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+		ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_H1_T0_OUT_MSB, &buffer[1]);
+		pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_H1_T0_OUT_MSB) -> 0x%08x\r\n";
+	});
+
+	H1_T0_out = (((u16)buffer[1])<<8) | (u16)buffer[0];
+
+	buffer[0] = 0; buffer[1] = 0;
+	/*4. Read H_T_OUT  */
+
+	MAY_DIE({
+		ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_HUMIDITY_OUT_L, &buffer[0]);
+		pSensors->pcErr = "ReadIicReg( HYGROMETER_REG_HUMIDITY_OUT_L) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+		ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_HUMIDITY_OUT_H, &buffer[1]);
+		pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_HUMIDITY_OUT_H -> 0x%08x\r\n";
+	});
+
+	H_T_out = (((u16)buffer[1])<<8) | (u16)buffer[0];
+
+	/*5. Compute the RH [%] value by linear interpolation */
+	value = 0;
+	tmp = ((int)(H_T_out - H0_T0_out)) * ((int)(H1_rh - H0_rh));
+	value = (u16) ((tmp/(H1_T0_out - H0_T0_out))+ H0_rh) ;
+
+	/* Saturation condition*/
+	if(value>1000) value = 1000;
+
+    pSensors->fHygrometerHumidity = value;
+
+        /**
+	* @brief Read HTS221 temperature output registers, and calculate temperature.
+	* @param Pointer to the returned temperature value that must be divided by 10 to get the value in ['C].
+	* @retval Error code [HTS221_OK, HTS221_ERROR].
+	*/
+	tmp5 = 0; value = 0;
+	buff2[0] = 0; buff2[1] = 0; buff2[2] = 0; buff2[3] = 0;
+
+	/*1. Read from 0x32 & 0x33 registers the value of coefficients T0_degC_x8 and T1_degC_x8*/
+    MAY_DIE({
+        ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T0_degC_x8, &buff2[0]);
+        pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_T0_degC_x8) -> 0x%08x\r\n";
+	});
+    MAY_DIE({
+        ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T1_degC_x8, &buff2[1]);
+        pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_T1_degC_x8) -> 0x%08x\r\n";
+	});
+
+	/*2. Read from 0x35 register the value of the MSB bits of T1_degC and T0_degC */
+	MAY_DIE({
+        ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T1_T0_MSB, &tmp5);
+		pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_T1_T0_MSB) -> 0x%08x\r\n";
+	});
+
+	/*Calculate the T0_degC and T1_degC values*/
+	T0_degC_x8_u16 = (((u16)(tmp5 & 0x03)) << 8) | ((u16)buff2[0]);
+	T1_degC_x8_u16 = (((u16)(tmp5 & 0x0C)) << 6) | ((u16)buff2[1]);
+	T0_degC = T0_degC_x8_u16>>3;
+	T1_degC = T1_degC_x8_u16>>3;
+
+	/*3. Read from 0x3C & 0x3D registers the value of T0_OUT*/
+	/*4. Read from 0x3E & 0x3F registers the value of T1_OUT*/
+	buff2[0] = 0;
+    buff2[1] = 0;
+    buff2[2] = 0;
+    buff2[3] = 0;
+	MAY_DIE({
+        ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T0_OUT_LSB, &buff2[0]);
+        pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_T0_OUT_LSB) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+        ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T0_OUT_MSB, &buff2[1]);
+        pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_T0_OUT_LSB) -> 0x%08x\r\n";
+	});
+
+	MAY_DIE({
+        ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T1_OUT_LSB, &buff2[2]);
+        pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_T1_OUT_LSB) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+        ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_T1_OUT_MSB, &buff2[3]);
+        pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_T1_OUT_MSB) -> 0x%08x\r\n";
+	});
+
+	T0_out = (((u16)buff2[1])<<8) | (u16)buff2[0];
+	T1_out = (((u16)buff2[3])<<8) | (u16)buff2[2];
+
+	/* 5.Read from 0x2A & 0x2B registers the value T_OUT (ADC_OUT).*/
+	buff2[0] = 0; buff2[1] = 0; buff2[2] = 0; buff2[3] = 0;
+	MAY_DIE({
+        ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_TEMP_OUT_L, &buff2[0]);
+        pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_TEMP_OUT_L) -> 0x%08x\r\n";
+	});
+	MAY_DIE({
+        ReadIicReg(pSensors, HYGROMETER_SLAVE_ADDRESS, HYGROMETER_REG_TEMP_OUT_H, &buff2[1]);
+        pSensors->pcErr = "ReadIicReg(HYGROMETER_REG_TEMP_OUT_H) -> 0x%08x\r\n";
+	});
+
+	T_out = (((u16)buff2[1])<<8) | (u16)buff2[0];
+
+	/* 6. Compute the Temperature value by linear interpolation*/
+	value = 0;
+
+	tmp32 = (( int)(T_out - T0_out)) * (( int)(T1_degC - T0_degC));
+	value = (tmp32 /(T1_out - T0_out)) + T0_degC;
+
+    pSensors->fHygrometerTemperature = value;
+
+L_DIE:
+	return;
+}
+
+/*--------------------------------------------------------------------------------*/
+
+static void StartPLTempSensor(UZedSensors* pSensors)
+{
+	const TickType_t xOneMs = MS_TO_TICKS(1);
+
+    pSensors->bThermocoupleOk = pdFALSE;
+    pSensors->fThermocoupleBoardTemperature = 0;
+    pSensors->fThermocoupleTemperature = 0;
+
+	//Reset the SPI Peripheral, which takes 4 cycles, so wait a bit after reset
+    XSpi_WriteReg(PL_SPI_BASEADDR, XSP_SRR_OFFSET, AXI_SPI_RESET_VALUE);
+	vTaskDelay(xOneMs); //usleep(100);
+
+	// Initialize the AXI SPI Controller with settings compatible with the MAX31855
+    XSpi_WriteReg(PL_SPI_BASEADDR, XSP_CR_OFFSET, MAX31855_CR_INIT_MODE);
+
+	// Deselect all slaves to start, then wait a bit for it to take affect
+    XSpi_WriteReg(PL_SPI_BASEADDR, XSP_SSR_OFFSET, PL_SPI_CHANNEL_SEL_NONE);
+
+	vTaskDelay(xOneMs); //usleep(100);
+
+    pSensors->bThermocoupleOk = pdTRUE;
+	configPRINTF( ("PL Thermocouple started - check state after first reading\r\n") );
+}
+
+static void StopPLTempSensor(UZedSensors* pSensors)
+{
+    pSensors->bThermocoupleOk = pdFALSE;
+}
+
+static void XSpi_LowLevelExecute(UZedSensors* pSensors, u32 qBaseAddress, BaseType_t xSPI_Channel, BaseType_t xByteCount, const u32* pqTxBuffer, u32* pqRxBuffer)
+{
+	BaseType_t xNumBytesRcvd = 0;
+	BaseType_t xCount;
+	const TickType_t xOneMs = MS_TO_TICKS(1);
+
+	/*
+	 * Initialize the Tx FIFO in the AXI SPI Controller with the transmit
+	 * data contained in TxBuffer
+	 */
+	for (xCount = 0; xCount < xByteCount; pqTxBuffer++, xCount++)
+	{
+		XSpi_WriteReg(qBaseAddress, XSP_DTR_OFFSET, *pqTxBuffer);
+	}
+
+	// Assert the Slave Select, then wait a bit so it takes affect
+	XSpi_WriteReg(qBaseAddress, XSP_SSR_OFFSET, xSPI_Channel);
+	vTaskDelay(xOneMs); //usleep(100);
+
+	/*
+	 * Disable the Inhibit bit in the AXI SPI Controller's controler register
+	 * This will release the AXI SPI Controller to release the transaction onto the bus
+	 */
+	XSpi_WriteReg(qBaseAddress, XSP_CR_OFFSET, MAX31855_CR_UNINHIBIT_MODE);
+
+	/*
+	 * Wait for the AXI SPI controller's transmit FIFO to transition to empty
+	 * to make sure all the transmit data gets sent
+	 */
+	while (!(XSpi_ReadReg(qBaseAddress, XSP_SR_OFFSET) & XSP_SR_TX_EMPTY_MASK));
+
+	/*
+	 * Wait for the AXI SPI controller's Receive FIFO Occupancy register to
+	 * show the expected number of receive bytes before attempting to read
+	 * the Rx FIFO. Note the Occupancy Register shows Rx Bytes - 1
+	 *
+	 * If xByteCount number of bytes is sent, then by design, there must be
+	 * xByteCount number of bytes received
+	 */
+	xByteCount--;
+	while(xByteCount != XSpi_ReadReg(qBaseAddress, XSP_RFO_OFFSET)) {
+		;
+	}
+	xByteCount++;
+
+	/*
+	 * The AXI SPI Controller's Rx FIFO has now received TxByteCount number
+	 * of bytes off the SPI bus and is ready to be read.
+	 *
+	 * Transfer the Rx bytes out of the Controller's Rx FIFO into our code
+	 * Keep reading one byte at a time until the Rx FIFO is empty
+	 */
+	xNumBytesRcvd = 0;
+	while ((XSpi_ReadReg(qBaseAddress, XSP_SR_OFFSET) & XSP_SR_RX_EMPTY_MASK) == 0)
+	{
+		*pqRxBuffer++ = XSpi_ReadReg(qBaseAddress, XSP_DRR_OFFSET);
+		xNumBytesRcvd++;
+	}
+
+	// Now that the Rx Data is retrieved, inhibit the AXI SPI Controller
+	XSpi_WriteReg(qBaseAddress, XSP_CR_OFFSET, MAX31855_CR_INIT_MODE);
+	// Deassert the Slave Select
+	XSpi_WriteReg(qBaseAddress, XSP_SSR_OFFSET, PL_SPI_CHANNEL_SEL_NONE);
+
+	/*
+	 * If no data was sent or if we didn't receive as many bytes as
+	 * were transmitted, then flag a failure
+	 */
+	if (xByteCount != xNumBytesRcvd) {
+		pSensors->rc = ((xByteCount & 0xf) << 4) | (xNumBytesRcvd & 0xf);
+        pSensors->pcErr = "XSpi_LowLevelExecute() -> 0x%08x\r\n";
+		return;
+	}
+
+	pSensors->rc = XST_SUCCESS;
+	return;
+}
+
+/**
+ * @brief Sample Barometer and publish values
+ *
+ * @param[in] pSensors			Sensors handle
+ */
+static void SamplePLTempSensor(UZedSensors* pSensors)
+{
+	// TxBuffer is not used to communicate with the MAX31855 but it is still necessary
+	//      for the XSPI utilities to function
+	u32 pqTxBuffer[4] = {0,0,0,0};
+	u32 pqRxBuffer[4] = {~0,~0,~0,~0};	// Initialize RxBuffer with all 1's
+	s32 sqTemporaryValue = 0;
+	s32 sqTemporaryValue2 = 0;
+	float fMAX31855_internal_temp = 0.0f;
+	float fMAX31855_thermocouple_temp = 0.0f;
+
+    if(!pSensors->bThermocoupleOk) {
+        return;
+    }
+    pSensors->rc = XST_SUCCESS;
+
+	// Execute 4-byte read transaction.
+	MAY_DIE({
+        XSpi_LowLevelExecute(pSensors, (u32)PL_SPI_BASEADDR, (BaseType_t)PL_SPI_CHANNEL_SEL_0, (BaseType_t)4, pqTxBuffer, pqRxBuffer );
+        if(XST_SUCCESS == pSensors->rc) {
+            if(0) {
+                ;
+            } else if(pqRxBuffer[3] & 0x1) {
+                pSensors->rc = XST_FAILURE;
+                pSensors->pcErr = "Thermocouple: Open Circuit\r\n";
+            } else if(pqRxBuffer[3] & 0x2) {
+                pSensors->rc = XST_FAILURE;
+                pSensors->pcErr = "Thermocouple: Short to GND\r\n";
+            } else if(pqRxBuffer[3] & 0x4) {
+                pSensors->rc = XST_FAILURE;
+                pSensors->pcErr = "Thermocouple: Short to VCC\r\n";
+            } else if(pqRxBuffer[1] & 0x01) {
+                pSensors->rc = XST_FAILURE;
+                pSensors->pcErr = "Thermocouple: Fault\r\n";
+            }
+        }
+	});
+
+    // Internal Temp
+    {
+        sqTemporaryValue = pqRxBuffer[2];  			// bits 11..4
+        sqTemporaryValue = sqTemporaryValue << 4;		// shift left to make room for bits 3..0
+        sqTemporaryValue2 = pqRxBuffer[3];				// bits 3..0 in the most significant spots
+        sqTemporaryValue2 = sqTemporaryValue2 >> 4;	// shift right to get rid of extra bits and position
+        sqTemporaryValue |= sqTemporaryValue2;		// Combine to get bits 11..0
+        if((pqRxBuffer[2] & 0x80) == 0x80) {				// Check the sign bit and sign-extend if need be
+            sqTemporaryValue |= 0xFFFFF800;
+        }
+        fMAX31855_internal_temp = (float)sqTemporaryValue / 16.0f;
+        pSensors->fThermocoupleBoardTemperature = fMAX31855_internal_temp;
+    }
+
+    // Thermocouple Temp
+    {
+        sqTemporaryValue = pqRxBuffer[0];  			// bits 13..6
+        sqTemporaryValue = sqTemporaryValue << 6;		// shift left to make room for bits 5..0
+        sqTemporaryValue2 = pqRxBuffer[1];				// bits 5..0 in the most significant spots
+        sqTemporaryValue2 = sqTemporaryValue2 >> 2;	// shift right to get rid of extra bits and position
+        sqTemporaryValue |= sqTemporaryValue2;		// Combine to get bits 13..0
+        if((pqRxBuffer[0] & 0x80) == 0x80) {				// Check the sign bit and sign-extend if need be
+            sqTemporaryValue |= 0xFFFFE000;
+        }
+        fMAX31855_thermocouple_temp = (float)sqTemporaryValue / 4.0f;
+        pSensors->fThermocoupleTemperature = fMAX31855_thermocouple_temp;
+    }
+    return;
+
+L_DIE:
+    return;
+}
+
+/*--------------------------------------------------------------------------------*/
+
+int UZedSensorsStart(UZedSensors* pSensors)
+{
+	XIic_Config *pI2cConfig;
+
+	pSensors->bError = 0;
+    pSensors->bBarometerOk = 0;
+    pSensors->bHygrometerOk = 0;
+    pSensors->bThermocoupleOk = 0;
+
+    pSensors->rc = XST_SUCCESS;
+    pSensors->pcErr = "\r\n";
+
+	pI2cConfig = XIic_LookupConfig(XPAR_IIC_0_DEVICE_ID);
+	configASSERT(pI2cConfig != NULL);
+
+	MAY_DIE({
+		pSensors->rc = XIic_CfgInitialize(&pSensors->iic, pI2cConfig,	pI2cConfig->BaseAddress);
+		pSensors->pcErr = "XIic_CfgInitialize() -> 0x%08x\r\n";
+	});
+	XIic_IntrGlobalDisable(pI2cConfig->BaseAddress);
+
+	MAY_DIE({
+		pSensors->rc = XIic_Start(&pSensors->iic);
+		pSensors->pcErr = "XIic_Start() -> 0x%08x\r\n";
+	});
+
+    /*
+     * Ignore sensor errors, as each sensor has its own OK and will skip sampling
+     */
+    StartBarometer(pSensors);
+    StartPLTempSensor(pSensors);
+    StartHygrometer(pSensors);
+
+    pSensors->rc = XST_SUCCESS;
+
+L_DIE:
+	return pSensors->rc;
+}
+
+void UZedSensorsSample(UZedSensors* pSensors)
+{
+    pSensors->bError = 0;
+	SampleBarometer(pSensors);
+	SamplePLTempSensor(pSensors);
+	SampleHygrometer(pSensors);
+}
+
+void UZedSensorsStop(UZedSensors* pSensors)
+{
+	StopHygrometer(pSensors);
+	StopPLTempSensor(pSensors);
+	StopBarometer(pSensors);
+
+	if(pSensors->iic.IsReady) {
+		XIic_Stop(&pSensors->iic);
+	}
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,108 @@
+/*
+ * Amazon FreeRTOS MQTT UZed Demo V1.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file uzed_sensors.h
+ * @brief Drivers for the sensors of the MicroZed IOT Kit: the LPS25HB
+ * barometer and HTS221 hygrometer on I2C, and the MAX31855 thermocouple on
+ * the PL SPI controller.
+ *
+ * The drivers use no network services, so they can run on either core.
+ */
+
+#ifndef _UZED_SENSORS_H_
+#define _UZED_SENSORS_H_
+
+#include "FreeRTOS.h"
+#include "xil_types.h"
+#include "xiic.h"
+
+/**
+ * @brief Sensors handle contents
+ */
+typedef struct UZedSensors {
+	XIic 	iic;
+
+	u8 pbHygrometerCalibration[16];
+
+	int rc;
+    const char* pcErr;
+    uint8_t bError;
+
+    // Sensor start ok
+    uint8_t bBarometerOk;
+    uint8_t bHygrometerOk;
+    uint8_t bThermocoupleOk;
+
+    // Sensor values
+    float fBarometerPressure;
+    float fBarometerTemperature;
+    float fHygrometerHumidity;
+    float fHygrometerTemperature;
+    float fThermocoupleTemperature;
+    float fThermocoupleBoardTemperature;
+} UZedSensors;
+
+/**
+ * @brief Milliseconds to ticks, at least one tick
+ */
+static inline BaseType_t MS_TO_TICKS(BaseType_t xMs)
+{
+	TickType_t xTicks = pdMS_TO_TICKS( xMs );
+
+	if(xTicks < 1) {
+		xTicks = 1;
+	}
+	return xTicks;
+}
+
+/**
+ * @brief Starts the I2C controller, then each sensor
+ *
+ * A sensor that does not start is left not ok and is skipped when sampling.
+ *
+ * @param[in] pSensors	Sensors handle
+ *
+ * @return XST_SUCCESS, or the error of the I2C controller
+ */
+int UZedSensorsStart(UZedSensors* pSensors);
+
+/**
+ * @brief Samples each sensor that started ok
+ *
+ * pSensors->bError is set if any sensor failed to sample.
+ *
+ * @param[in] pSensors	Sensors handle
+ */
+void UZedSensorsSample(UZedSensors* pSensors);
+
+/**
+ * @brief Stops each sensor, then the I2C controller
+ *
+ * @param[in] pSensors	Sensors handle
+ */
+void UZedSensorsStop(UZedSensors* pSensors);
+
+#endif
@@ -53,7 +53,9 @@
 #define configENABLE_BACKWARD_COMPATIBILITY        0
 #define configUSE_PREEMPTION                       1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION    1
-#define configUSE_TICKLESS_IDLE					0
+/* The idle task stops the tick and sleeps in WFI until the next task is due,
+see vPortSuppressTicksAndSleep() in port.c. */
+#define configUSE_TICKLESS_IDLE					1
 #define configMAX_PRIORITIES                       ( 7 )
 #define configTICK_RATE_HZ                         ( 1000 )
 //#define configPERIPHERAL_CLOCK_HZ  				( 33333000UL )
@@ -80,24 +82,51 @@
 #define configUSE_MALLOC_FAILED_HOOK               1
 #define configCHECK_FOR_STACK_OVERFLOW             2
 
+/* Set configUSE_HEAP_TRACE to 1 to record each allocation and free, see
+heap_trace.h, and either configLOGGING_INCLUDE_HEAP_TRACE to 1 to have the
+logging task write them to the UART, or UZED_PUBLISH_HEAP_TRACE in uzed_iot.c
+to 1 to publish them to MQTT.  tools/heap_trace_report reads either. */
+#define configUSE_HEAP_TRACE                       0
+#define configLOGGING_INCLUDE_HEAP_TRACE           0
+
+/* Set configUSE_TRACE_RECORDER to 1 to stream task switches, queue operations,
+interrupts and user events from the MQTT, TLS and IP tasks to Tracealyzer or
+tools/trace_to_perfetto over TCP, see trcConfig.h and trcStreamingConfig.h.
+The sources in lib/third_party/tracealyzer_recorder and its
+streamports/FreeRTOS_TCP stream port must then be added to the project.  The
+recorder defines its own traceMALLOC() and traceFREE(), so cannot be used with
+configUSE_HEAP_TRACE. */
+#define configUSE_TRACE_RECORDER                   0
+
+/* mbedTLS allocates from an arena of this size rather than the heap, see
+aws_crypto.c, so a TLS session cannot fragment the heap or starve other
+tasks.  Its statistics are read with uxArenaGetSystemState(). */
+#define cryptoconfigARENA_SIZE                     ( 192 * 1024 )
+
 /* Software timer related definitions. */
 #define configUSE_TIMERS                           1
 #define configTIMER_TASK_PRIORITY                  ( configMAX_PRIORITIES - 1 )
 #define configTIMER_QUEUE_LENGTH                   5
 #define configTIMER_TASK_STACK_DEPTH               ( configMINIMAL_STACK_SIZE * 2 )
 
+/* Keep active timers in a timing wheel, so the per-request timeouts of the OTA
+agent, MQTT and TCP cost the same to start and stop however many are running.
+Timer commands are recorded on the timers rather than queued, so a short timer
+queue is enough. */
+#define configUSE_TIMER_WHEEL                      1
+
 /* Event group related definitions. */
 #define configUSE_EVENT_GROUPS                     1
 
-/* Run time stats gathering definitions. */
-/* FIX ME: Uncomment if you plan to use Tracealyzer.
-*/
+/* Run time stats gathering definitions.  The counter is the Cortex-A9 global
+timer, see FreeRTOS_tick_config.c. */
 #define configUSE_STATS_FORMATTING_FUNCTIONS	1
-/*
-#define configGENERATE_RUN_TIME_STATS 0
-#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
-#define portGET_RUN_TIME_COUNTER_VALUE()
-*/
+#define configGENERATE_RUN_TIME_STATS			1
+void vConfigureRunTimeCounter( void );
+uint32_t ulGetRunTimeCounterValue( void );
+uint32_t ulGetInterruptRunTimeCounter( uint32_t ulInterruptID );
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() vConfigureRunTimeCounter()
+#define portGET_RUN_TIME_COUNTER_VALUE()		ulGetRunTimeCounterValue()
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                   0
@@ -285,4 +314,17 @@ extern uint32_t uxRand();
 /* The platform FreeRTOS is running on. */
 #define configPLATFORM_NAME    "XilinxZynq7000"
 
+#if ( configUSE_TRACE_RECORDER == 1 )
+	#if ( configUSE_HEAP_TRACE == 1 )
+		#error configUSE_HEAP_TRACE and configUSE_TRACE_RECORDER cannot both be 1.
+	#endif
+
+	#if defined( configNUM_CORES ) && ( configNUM_CORES > 1 )
+		#error The trace recorder only records one core.
+	#endif
+
+	/* The recorder defines the trace macros, so is included last. */
+	#include "trcRecorder.h"
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
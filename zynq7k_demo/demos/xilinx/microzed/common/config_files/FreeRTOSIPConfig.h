@@ -240,6 +240,10 @@ extern uint32_t uxRand();
 /* USE_WIN: Let TCP use windowing mechanism. */
 #define ipconfigUSE_TCP_WIN                            ( 1 )
 
+/* Limit the outstanding TCP data with a congestion window.  The algorithm
+can be changed per socket with FREERTOS_SO_TCP_CONGESTION. */
+#define ipconfigUSE_TCP_CONGESTION_CONTROL             ( 1 )
+
 /* The MTU is the maximum number of bytes the payload of a network frame can
  * contain.  For normal Ethernet V2 frames the maximum MTU is 1500.  Setting a
  * lower value can save RAM, depending on the buffer management scheme used.  If
@@ -301,6 +305,14 @@ extern uint32_t uxRand();
 /* Define the size of Tx buffer for TCP sockets. */
 #define ipconfigTCP_TX_BUFFER_LENGTH                   ( 0x4000 )
 
+/* The TCP stream buffers and window segments are allocated from an arena of
+ * their own, created in main.c, so that the sockets have a fixed budget and do
+ * not fragment the heap that TLS and MQTT allocate from. */
+void * pvNetworkArenaMalloc( size_t xWantedSize );
+void vNetworkArenaFree( void * pv );
+#define pvPortMallocLarge( x )                         pvNetworkArenaMalloc( x )
+#define vPortFreeLarge( pv )                           vNetworkArenaFree( pv )
+
 /* When using call-back handlers, the driver may check if the handler points to
  * real program memory (RAM or flash) or just has a random non-zero value. */
 #define ipconfigIS_VALID_PROG_ADDRESS( x )    ( ( x ) != NULL )
@@ -339,6 +351,23 @@ extern uint32_t uxRand();
 
 #define portINLINE                               __inline
 
+/* With the trace recorder, see configUSE_TRACE_RECORDER in FreeRTOSConfig.h,
+ * the IP task records the events it processes, by their eIPEvent_t value, and
+ * the network's state changes on a user event channel registered in main.c. */
+#if ( configUSE_TRACE_RECORDER == 1 )
+    extern traceString xIPTraceChannel;
+
+    #define iptraceNETWORK_EVENT_RECEIVED( eEvent )                          \
+    if( ( eEvent ) != eNoEvent )                                             \
+    {                                                                        \
+        vTracePrintF( xIPTraceChannel, "Event %d", ( int ) ( eEvent ) );     \
+    }
+    #define iptraceNETWORK_DOWN()                      vTracePrint( xIPTraceChannel, "Network down" )
+    #define iptraceDHCP_SUCCEDEED( address )           vTracePrintF( xIPTraceChannel, "DHCP address %x", ( address ) )
+    #define iptraceETHERNET_RX_EVENT_LOST()            vTracePrint( xIPTraceChannel, "Rx event lost" )
+    #define iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER()   vTracePrint( xIPTraceChannel, "No network buffer" )
+#endif
+
 void vApplicationMQTTGetKeys( const char ** ppcRootCA,
                               const char ** ppcClientCert,
                               const char ** ppcClientPrivateKey );
@@ -82,6 +82,12 @@
  */
 #define mqttconfigTCP_SEND_TIMEOUT_MS          ( 2000 )
 
+/**
+ * @brief Time in milliseconds that small packets are held so that they share
+ * a TLS record.
+ */
+#define mqttconfigSEND_COALESCE_WINDOW_MS      ( 5 )
+
 /**
  * @brief Length of the buffer used to receive data.
  */
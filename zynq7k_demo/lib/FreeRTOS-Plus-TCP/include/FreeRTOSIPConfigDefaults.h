@@ -148,6 +148,48 @@ from the FreeRTOSIPConfig.h configuration header file. */
 		TCP packets which are unknown, or out-of-order. */
 		#define ipconfigIGNORE_UNKNOWN_PACKETS	( 0 )
 	#endif
+
+	/* When non-zero, every TCP socket maintains a congestion window (cwnd)
+	which limits the amount of outstanding data, on top of the peer's
+	advertised window.  Requires ipconfigUSE_TCP_WIN. */
+	#ifndef ipconfigUSE_TCP_CONGESTION_CONTROL
+		#define ipconfigUSE_TCP_CONGESTION_CONTROL	( 0 )
+	#endif
+
+	/* The congestion control algorithm used by new sockets, it can be changed
+	per socket with FREERTOS_SO_TCP_CONGESTION. */
+	#ifndef ipconfigTCP_CONGESTION_DEFAULT
+		#define ipconfigTCP_CONGESTION_DEFAULT	FREERTOS_TCP_CC_NEWRENO
+	#endif
+
+	/* When non-zero, new sockets spread the transmission of new segments over
+	the round-trip time in stead of sending them back-to-back.  It can be
+	changed per socket with FREERTOS_SO_TCP_PACING. */
+	#ifndef ipconfigTCP_PACING_DEFAULT
+		#define ipconfigTCP_PACING_DEFAULT		( 0 )
+	#endif
+
+	#if( ipconfigUSE_TCP_WIN == 0 ) && ( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+		#error ipconfigUSE_TCP_CONGESTION_CONTROL can only be used in combination with ipconfigUSE_TCP_WIN
+	#endif
+
+	/* When non-zero, consecutive TCP segments are passed to the network
+	interface as a single large packet, along with the MSS.  Either the driver
+	(see ipconfigDRIVER_INCLUDED_LARGE_SEND) or the IP-task will split it into
+	frames.  It only works with network buffers of a variable size, i.e. with
+	BufferAllocation_2.c. */
+	#ifndef ipconfigUSE_TCP_LARGE_SEND
+		#define ipconfigUSE_TCP_LARGE_SEND		( 0 )
+	#endif
+
+	/* The maximum number of TCP payload bytes in a single large packet. */
+	#ifndef ipconfigTCP_LARGE_SEND_SIZE
+		#define ipconfigTCP_LARGE_SEND_SIZE		( 44 * ipconfigTCP_MSS )
+	#endif
+
+	#if( ipconfigUSE_TCP_WIN == 0 ) && ( ipconfigUSE_TCP_LARGE_SEND != 0 )
+		#error ipconfigUSE_TCP_LARGE_SEND can only be used in combination with ipconfigUSE_TCP_WIN
+	#endif
 #endif
 
 /*
@@ -297,6 +339,34 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS		45
 #endif
 
+/* BufferAllocation_3.c takes the storage of network buffers from three size
+classes.  A request is served from the smallest class that can hold it, or from
+a bigger class when that one has run out.  The sizes exclude ipBUFFER_PADDING,
+the large class must be able to hold a complete Ethernet frame. */
+#ifndef ipconfigBUFFER_ALLOC_SMALL_SIZE
+	#define ipconfigBUFFER_ALLOC_SMALL_SIZE			128
+#endif
+
+#ifndef ipconfigBUFFER_ALLOC_SMALL_COUNT
+	#define ipconfigBUFFER_ALLOC_SMALL_COUNT		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 2 )
+#endif
+
+#ifndef ipconfigBUFFER_ALLOC_MEDIUM_SIZE
+	#define ipconfigBUFFER_ALLOC_MEDIUM_SIZE		640
+#endif
+
+#ifndef ipconfigBUFFER_ALLOC_MEDIUM_COUNT
+	#define ipconfigBUFFER_ALLOC_MEDIUM_COUNT		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 4 )
+#endif
+
+#ifndef ipconfigBUFFER_ALLOC_LARGE_SIZE
+	#define ipconfigBUFFER_ALLOC_LARGE_SIZE			( ipTOTAL_ETHERNET_FRAME_SIZE + 64 )
+#endif
+
+#ifndef ipconfigBUFFER_ALLOC_LARGE_COUNT
+	#define ipconfigBUFFER_ALLOC_LARGE_COUNT		ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS
+#endif
+
 #ifndef ipconfigEVENT_QUEUE_LENGTH
 	#define ipconfigEVENT_QUEUE_LENGTH		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS + 5 )
 #endif
@@ -397,6 +467,17 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#ifndef ipconfigDNS_CACHE_ENTRIES
 		#define ipconfigDNS_CACHE_ENTRIES			1
 	#endif
+
+	/* The TTL reported by a DNS server is limited to this value. */
+	#ifndef ipconfigDNS_CACHE_MAX_TTL_SECONDS
+		#define ipconfigDNS_CACHE_MAX_TTL_SECONDS	86400UL
+	#endif
+
+	/* Names registered with FreeRTOS_dnsprefetch() are looked up again this
+	many seconds before their TTL expires. */
+	#ifndef ipconfigDNS_CACHE_PREFETCH_SECONDS
+		#define ipconfigDNS_CACHE_PREFETCH_SECONDS	10UL
+	#endif
 #endif /* ipconfigUSE_DNS_CACHE != 0 */
 
 #ifndef ipconfigCHECK_IP_QUEUE_SPACE
@@ -491,6 +572,13 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM 0
 #endif
 
+#ifndef ipconfigDRIVER_INCLUDED_LARGE_SEND
+	/* When non-zero, the network interface splits large TCP packets (those with
+	a non-zero 'usLargeSendMSS') into frames itself, using
+	uxTCPLargeSendGetSegment(). */
+	#define ipconfigDRIVER_INCLUDED_LARGE_SEND 0
+#endif
+
 #ifndef ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM
 	#define ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM 0
 #endif
@@ -519,6 +607,14 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigDNS_USE_CALLBACKS 0
 #endif
 
+/* When ipconfigDNS_USE_CALLBACKS is defined, a DNS request that has not been
+answered is sent again after this time, up to ipconfigDNS_REQUEST_ATTEMPTS
+times.  The blocking FreeRTOS_gethostbyname() gives up after
+ipconfigDNS_REQUEST_ATTEMPTS * ipconfigDNS_REQUEST_RETRY_TIME_MS. */
+#ifndef ipconfigDNS_REQUEST_RETRY_TIME_MS
+	#define ipconfigDNS_REQUEST_RETRY_TIME_MS	1000
+#endif
+
 #ifndef ipconfigSUPPORT_SIGNALS
 	#define ipconfigSUPPORT_SIGNALS				0
 #endif
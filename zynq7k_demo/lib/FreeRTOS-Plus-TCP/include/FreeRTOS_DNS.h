@@ -103,6 +103,24 @@ uint32_t ulDNSHandlePacket( NetworkBufferDescriptor_t *pxNetworkBuffer );
 	uint32_t FreeRTOS_gethostbyname_a( const char *pcHostName, FOnDNSEvent pCallback, void *pvSearchID, TickType_t xTimeout );
 	void FreeRTOS_gethostbyname_cancel( void *pvSearchID );
 
+	/*
+	 * Returns pdTRUE when xSocket is the socket used for asynchronous DNS
+	 * requests.  Its replies are handled by the IP-task.
+	 */
+	BaseType_t xIsDNSSocket( Socket_t xSocket );
+
+	#if( ipconfigUSE_DNS_CACHE != 0 )
+
+		/*
+		 * Keep the address of pcHostName in the DNS cache: it will be looked up
+		 * again ipconfigDNS_CACHE_PREFETCH_SECONDS before its TTL expires, so
+		 * FreeRTOS_gethostbyname() can be answered from the cache.  If the name
+		 * is not in the cache yet, it will be looked up as soon as possible.
+		 */
+		BaseType_t FreeRTOS_dnsprefetch( const char *pcHostName );
+
+	#endif /* ipconfigUSE_DNS_CACHE != 0 */
+
 #endif
 
 /*
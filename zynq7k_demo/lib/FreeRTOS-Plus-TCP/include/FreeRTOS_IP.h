@@ -97,6 +97,9 @@ typedef struct xNETWORK_BUFFER
 	#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
 		struct xNETWORK_BUFFER *pxNextBuffer; /* Possible optimisation for expert users - requires network driver support. */
 	#endif
+	#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+		uint16_t usLargeSendMSS;	/* Non-zero for a TCP packet carrying more than one MSS of data, which must be sent in segments of this size. */
+	#endif
 } NetworkBufferDescriptor_t;
 
 #include "pack_struct_start.h"
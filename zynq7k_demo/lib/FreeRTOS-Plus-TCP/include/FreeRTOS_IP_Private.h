@@ -734,6 +734,14 @@ static portINLINE uint16_t usChar2u16 (const uint8_t *apChr)
 /* Check a single socket for retransmissions and timeouts */
 BaseType_t xTCPSocketCheck( FreeRTOS_Socket_t *pxSocket );
 
+#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+	/* Write frame 'uxIndex' of a large TCP packet (one with a non-zero
+	'usLargeSendMSS') to pucTarget, which must be able to hold a full Ethernet
+	frame.  Returns the length of the frame, or zero when there are no more
+	frames.  For network interfaces that set ipconfigDRIVER_INCLUDED_LARGE_SEND. */
+	size_t uxTCPLargeSendGetSegment( const NetworkBufferDescriptor_t *pxNetworkBuffer, UBaseType_t uxIndex, uint8_t *pucTarget );
+#endif
+
 BaseType_t xTCPCheckNewClient( FreeRTOS_Socket_t *pxSocket );
 
 /* Defined in FreeRTOS_Sockets.c
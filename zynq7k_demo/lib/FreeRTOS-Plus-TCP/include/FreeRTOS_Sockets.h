@@ -130,6 +130,15 @@ FreeRTOS_setsockopt(). */
 	#define FREERTOS_SO_WAKEUP_CALLBACK	( 17 )
 #endif
 
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	#define FREERTOS_SO_TCP_CONGESTION	( 18 )		/* Select the congestion control algorithm, supply a pointer to a BaseType_t holding one of the FREERTOS_TCP_CC_xxx values */
+	#define FREERTOS_SO_TCP_PACING		( 19 )		/* Spread new segments over the round-trip time, supply a pointer to a BaseType_t */
+#endif
+
+/* Values that can be passed with FREERTOS_SO_TCP_CONGESTION. */
+#define FREERTOS_TCP_CC_NEWRENO			( 0 )		/* Slow start, congestion avoidance and NewReno fast recovery (RFC 5681/6582) */
+#define FREERTOS_TCP_CC_CUBIC			( 1 )		/* CUBIC window growth (RFC 8312), better suited for links with a large bandwidth-delay product */
+
 
 #define FREERTOS_NOT_LAST_IN_FRAGMENTED_PACKET 	( 0x80 )  /* For internal use only, but also part of an 8-bit bitwise value. */
 #define FREERTOS_FRAGMENTED_PACKET				( 0x40 )  /* For internal use only, but also part of an 8-bit bitwise value. */
@@ -134,8 +134,43 @@ typedef struct xTCP_WINDOW
 	uint16_t usPeerPortNumber;			/* debugging/logging: the peer's TCP port number */
 	uint16_t usMSS;						/* Current accepted MSS */
 	uint16_t usMSSInit;					/* MSS as configured by the socket owner */
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	struct
+	{
+		uint8_t ucAlgorithm;			/* One of the FREERTOS_TCP_CC_xxx values, see FREERTOS_SO_TCP_CONGESTION */
+		uint8_t ucPacing;				/* Non-zero when new segments are paced at cwnd / SRTT, see FREERTOS_SO_TCP_PACING */
+		uint8_t ucInRecovery;			/* Fast recovery is in progress until ulRecoverSequenceNumber has been ACK'd */
+		uint32_t ulCongestionWindow;	/* cwnd: the number of bytes which may be outstanding */
+		uint32_t ulSlowStartThreshold;	/* ssthresh: cwnd grows exponentially while it is below this value */
+		uint32_t ulRecoverSequenceNumber;/* NewReno: tx.ulHighestSequenceNumber at the moment a loss was detected */
+		uint32_t ulWindowMax;			/* CUBIC: cwnd just before the last reduction (W_max) */
+		uint32_t ulRenoWindow;			/* CUBIC: the window that standard TCP would have reached (W_est) */
+		uint32_t ulPacingCredit;		/* Pacing: number of bytes which may be sent without waiting */
+		uint32_t ulEpochK;				/* CUBIC: time in ms after xEpochStart at which cwnd will reach ulWindowMax again */
+		TickType_t xEpochStart;			/* CUBIC: the time at which the current growth period started, 0 if none */
+		TCPTimer_t xPacingTimer;		/* Pacing: the last time that ulPacingCredit was refilled */
+	} xCongestion;
+#endif
 } TCPWindow_t;
 
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	/* A congestion control algorithm is a set of handlers which adjust
+	xCongestion.ulCongestionWindow and xCongestion.ulSlowStartThreshold.  They
+	are all called from the IP-task.  Which set is used by a socket is selected
+	with FREERTOS_SO_TCP_CONGESTION. */
+	typedef struct xTCP_CONGESTION_OPS
+	{
+		/* Called when the window is initialised, after the MSS is known. */
+		void ( *pxInit )( TCPWindow_t *pxWindow );
+		/* Called when 'ulBytesAcked' bytes have been acknowledged for the first
+		time, either by a normal ACK or by a SACK. */
+		void ( *pxOnAck )( TCPWindow_t *pxWindow, uint32_t ulBytesAcked );
+		/* Called when a segment is retransmitted, either because of duplicate
+		ACK's (xIsTimeout == pdFALSE) or because its RTO expired. */
+		void ( *pxOnLoss )( TCPWindow_t *pxWindow, BaseType_t xIsTimeout );
+	} TCPCongestionOps_t;
+#endif
+
 
 /*=============================================================================
  *
@@ -199,12 +234,26 @@ BaseType_t xTCPWindowTxDone( TCPWindow_t *pxWindow );
  * apPos will point to a location with the circular data buffer: txStream */
 uint32_t ulTCPWindowTxGet( TCPWindow_t *pxWindow, uint32_t ulWindowSize, int32_t *plPosition );
 
+#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+	/* After ulTCPWindowTxGet() returned a full segment of ulLength bytes, fetch
+	the new segments that directly follow it, up to a total of ulMaxLength
+	bytes.  Returns the number of bytes added, which are stored in the
+	txStream right after the first segment. */
+	uint32_t ulTCPWindowTxGetMore( TCPWindow_t *pxWindow, uint32_t ulWindowSize, uint32_t ulLength, uint32_t ulMaxLength );
+#endif
+
 /* Receive a normal ACK */
 uint32_t ulTCPWindowTxAck( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber );
 
 /* Receive a SACK option */
 uint32_t ulTCPWindowTxSack( TCPWindow_t *pxWindow, uint32_t ulFirst, uint32_t ulLast );
 
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	/* Select the congestion control algorithm (FREERTOS_TCP_CC_xxx) for a
+	window.  Returns pdFAIL if the algorithm is not known. */
+	BaseType_t xTCPWindowSetCongestionControl( TCPWindow_t *pxWindow, BaseType_t xAlgorithm );
+#endif
+
 
 #ifdef __cplusplus
 }	/* extern "C" */
@@ -54,6 +54,21 @@ In case BufferAllocation_2.c is used, the new space must be allocated. */
 NetworkBufferDescriptor_t *pxResizeNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * pxNetworkBuffer,
 	size_t xNewSizeBytes );
 
+/* Allocation counters of one size class of BufferAllocation_3.c. */
+typedef struct xNETWORK_BUFFER_POOL_STATS
+{
+	size_t uxBufferSize;		/* The usable size of the buffers in this class. */
+	UBaseType_t uxCount;		/* The number of buffers in this class. */
+	UBaseType_t uxFree;			/* The number of buffers currently free. */
+	UBaseType_t uxMinimumFree;	/* The lowest number of free buffers since boot. */
+	uint32_t ulObtained;		/* The number of buffers handed out. */
+	uint32_t ulFailed;			/* The number of times the class was found empty. */
+} NetworkBufferPoolStats_t;
+
+/* Get the counters of size class 'uxPool', counting from the smallest.  Returns
+pdFAIL when there is no such class.  Only implemented by BufferAllocation_3.c. */
+BaseType_t xGetNetworkBufferPoolStats( UBaseType_t uxPool, NetworkBufferPoolStats_t *pxStats );
+
 #if ipconfigTCP_IP_SANITY
 	/*
 	 * Check if an address is a valid pointer to a network descriptor
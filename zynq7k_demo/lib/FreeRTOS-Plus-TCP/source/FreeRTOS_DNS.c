@@ -100,11 +100,17 @@ the query will be responded to with these flags: */
 type. */
 #define dnsPARSE_ERROR					  0UL
 
-/*
- * Create a socket and bind it to the standard DNS port number.  Return the
- * the created socket - or NULL if the socket could not be created or bound.
- */
-static Socket_t prvCreateDNSSocket( void );
+/* The longest host name, including the terminator, that the DNS timer copies
+when sending a request again.  See https://tools.ietf.org/html/rfc1035. */
+#define dnsMAX_NAME_LENGTH				254
+
+#if( ipconfigDNS_USE_CALLBACKS == 0 )
+	/*
+	 * Create a socket and bind it to the standard DNS port number.  Return the
+	 * the created socket - or NULL if the socket could not be created or bound.
+	 */
+	static Socket_t prvCreateDNSSocket( void );
+#endif
 
 /*
  * Create the DNS message in the zero copy buffer passed in the first parameter.
@@ -122,10 +128,17 @@ static uint8_t *prvSkipNameField( uint8_t *pucByte, size_t xSourceLen );
 static uint32_t prvParseDNSReply( uint8_t *pucUDPPayloadBuffer, size_t xBufferLength, TickType_t xIdentifier );
 
 /*
- * Prepare and send a message to a DNS server.  'xReadTimeOut_ms' will be passed as
- * zero, in case the user has supplied a call-back function.
+ * Create a DNS request for pcHostName and send it from xSocket to the DNS
+ * server, or to the LLMNR group when the name does not contain a dot.
  */
-static uint32_t prvGetHostByName( const char *pcHostName, TickType_t xIdentifier, TickType_t xReadTimeOut_ms );
+static BaseType_t prvSendDNSRequest( Socket_t xSocket, const char *pcHostName, TickType_t xIdentifier, TickType_t xBlockTimeTicks );
+
+#if( ipconfigDNS_USE_CALLBACKS == 0 )
+	/*
+	 * Prepare and send a message to a DNS server, and wait for the reply.
+	 */
+	static uint32_t prvGetHostByName( const char *pcHostName, TickType_t xIdentifier, TickType_t xReadTimeOut_ms );
+#endif
 
 /*
  * The NBNS and the LLMNR protocol share this reply function.
@@ -146,8 +159,9 @@ static uint32_t prvGetHostByName( const char *pcHostName, TickType_t xIdentifier
 	{
 		uint32_t ulIPAddress;		/* The IP address of an ARP cache entry. */
 		char pcName[ ipconfigDNS_CACHE_NAME_LENGTH ];  /* The name of the host */
-		uint32_t ulTTL; /* Time-to-Live (in seconds) from the DNS server. */
+		uint32_t ulTTL; /* Time-to-Live (in seconds, host order) from the DNS server. */
 		uint32_t ulTimeWhenAddedInSeconds;
+		uint8_t ucPrefetch;	/* Non-zero when the name was registered with FreeRTOS_dnsprefetch(). */
 	} DNSCacheRow_t;
 
 	static DNSCacheRow_t xDNSCache[ ipconfigDNS_CACHE_ENTRIES ];
@@ -270,29 +284,221 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 		TimeOut_t xTimeoutState;
 		void *pvSearchID;
 		struct xLIST_ITEM xListItem;
+		TimeOut_t xRetryState;			/* Time-out state of the latest transmission of the request. */
+		TickType_t xRetryTime;			/* Clock ticks left before the request will be sent again. */
+		BaseType_t xAttempts;			/* Number of times the request has been sent, or zero if the entry waits for a request owned by another entry. */
 		char pcName[ 1 ];
 	} DNSCallback_t;
 
+	/* FreeRTOS_gethostbyname() waits on a semaphore for the asynchronous
+	request to complete. */
+	typedef struct xDNS_Waiter {
+		SemaphoreHandle_t xSemaphore;
+		uint32_t ulIPAddress;
+	} DNSWaiter_t;
+
 	static List_t xCallbackList;
 
-	/* Define FreeRTOS_gethostbyname() as a normal blocking call. */
+	/* All asynchronous requests use one UDP socket.  Its replies are parsed by
+	the IP-task as soon as they arrive, see xProcessReceivedUDPPacket(). */
+	static Socket_t xDNSClientSocket = NULL;
+
+	/*
+	 * Start a new request, or join a request for the same name that is already
+	 * pending.
+	 */
+	static BaseType_t prvDNSStartRequest( const char *pcHostName, void *pvSearchID, FOnDNSEvent pCallbackFunction, TickType_t xTimeout );
+
+	/*
+	 * Returns the entry that owns the pending request for a name, or NULL.
+	 * Must be called with the scheduler suspended.
+	 */
+	static DNSCallback_t *prvDNSFindRequest( const char *pcHostName );
+
+	/*
+	 * Remove an entry from the list and free it.  If the entry owns the request,
+	 * the retransmissions are handed over to another entry that waits for the
+	 * same reply.  Must be called with the scheduler suspended.
+	 */
+	static void prvDNSRemoveCallback( DNSCallback_t *pxCallback );
+
+	/*
+	 * Start, stop, or change the period of the DNS timer in the IP-task.
+	 */
+	static void prvDNSTimerUpdate( void );
+
+	/*
+	 * The callback used by the blocking FreeRTOS_gethostbyname().
+	 */
+	static void prvDNSWaiterCallback( const char *pcName, void *pvSearchID, uint32_t ulIPAddress );
+
+	#if( ipconfigUSE_DNS_CACHE == 1 )
+		/*
+		 * Check if one of the names registered with FreeRTOS_dnsprefetch() is
+		 * about to expire, and if so, copy it to pcName.
+		 */
+		static BaseType_t prvDNSCachePrefetchDue( char *pcName, size_t xLength );
+
+		/*
+		 * Returns pdTRUE when there is at least one name to be prefetched.
+		 */
+		static BaseType_t prvDNSCacheHasPrefetch( void );
+
+		static void prvDNSPrefetchCallback( const char *pcName, void *pvSearchID, uint32_t ulIPAddress );
+	#endif /* ipconfigUSE_DNS_CACHE == 1 */
+
+	/* Define FreeRTOS_gethostbyname() as a normal blocking call.  It uses the
+	asynchronous machinery, so it shares replies and the cache with any other
+	task that looks up the same name at the same time. */
 	uint32_t FreeRTOS_gethostbyname( const char *pcHostName )
 	{
 		return FreeRTOS_gethostbyname_a( pcHostName, ( FOnDNSEvent ) NULL, ( void* )NULL, 0 );
 	}
 	/*-----------------------------------------------------------*/
 
-	/* Initialise the list of call-back structures. */
+	/* Initialise the list of call-back structures and create the client socket.
+	This is called from the IP-task each time the network comes up. */
 	void vDNSInitialise( void );
 	void vDNSInitialise( void )
 	{
-		vListInitialise( &xCallbackList );
+		if( listLIST_IS_INITIALISED( &xCallbackList ) == pdFALSE )
+		{
+			vListInitialise( &xCallbackList );
+		}
+
+		if( xDNSClientSocket == NULL )
+		{
+		struct freertos_sockaddr xAddress;
+
+			xDNSClientSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+			if( xDNSClientSocket != FREERTOS_INVALID_SOCKET )
+			{
+				/* Auto bind the port.  FreeRTOS_bind() can not be used from
+				within the IP-task. */
+				xAddress.sin_port = 0u;
+				if( vSocketBind( xDNSClientSocket, &xAddress, sizeof( xAddress ), pdFALSE ) != 0 )
+				{
+					vSocketClose( xDNSClientSocket );
+					xDNSClientSocket = NULL;
+				}
+			}
+			else
+			{
+				/* Change to NULL for easier testing. */
+				xDNSClientSocket = NULL;
+			}
+		}
+
+		prvDNSTimerUpdate();
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t xIsDNSSocket( Socket_t xSocket )
+	{
+	BaseType_t xReturn;
+
+		if( ( xDNSClientSocket != NULL ) && ( xSocket == xDNSClientSocket ) )
+		{
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			xReturn = pdFALSE;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvDNSTimerUpdate( void )
+	{
+	TickType_t xPeriod = 0;
+
+		if( listLIST_IS_EMPTY( &xCallbackList ) == pdFALSE )
+		{
+			/* Check twice per retransmission period, so a request is never sent
+			much later than it should. */
+			xPeriod = FreeRTOS_max_uint32( pdMS_TO_TICKS( ipconfigDNS_REQUEST_RETRY_TIME_MS ) / 2u, 1u );
+		}
+		#if( ipconfigUSE_DNS_CACHE == 1 )
+		else if( prvDNSCacheHasPrefetch() != pdFALSE )
+		{
+			xPeriod = pdMS_TO_TICKS( 1000u );
+		}
+		#endif
+
+		if( xPeriod != 0u )
+		{
+			vIPReloadDNSTimer( xPeriod );
+		}
+		else
+		{
+			vIPSetDnsTimerEnableState( pdFALSE );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static DNSCallback_t *prvDNSFindRequest( const char *pcHostName )
+	{
+	const ListItem_t *pxIterator;
+	const MiniListItem_t* xEnd = ( const MiniListItem_t* )listGET_END_MARKER( &xCallbackList );
+	DNSCallback_t *pxResult = NULL;
+
+		for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( xEnd );
+			 pxIterator != ( const ListItem_t * ) xEnd;
+			 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+		{
+			DNSCallback_t *pxCallback = ( DNSCallback_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+			/* Entries with zero attempts wait for a request owned by another
+			entry. */
+			if( ( pxCallback->xAttempts != 0 ) && ( strcmp( pxCallback->pcName, pcHostName ) == 0 ) )
+			{
+				pxResult = pxCallback;
+				break;
+			}
+		}
+
+		return pxResult;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvDNSRemoveCallback( DNSCallback_t *pxCallback )
+	{
+	const ListItem_t *pxIterator;
+	const MiniListItem_t* xEnd = ( const MiniListItem_t* )listGET_END_MARKER( &xCallbackList );
+
+		uxListRemove( &pxCallback->xListItem );
+
+		if( pxCallback->xAttempts != 0 )
+		{
+			/* Let another entry that waits for the same reply take over. */
+			for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( xEnd );
+				 pxIterator != ( const ListItem_t * ) xEnd;
+				 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+			{
+				DNSCallback_t *pxOther = ( DNSCallback_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+				if( listGET_LIST_ITEM_VALUE( pxIterator ) == listGET_LIST_ITEM_VALUE( &( pxCallback->xListItem ) ) )
+				{
+					pxOther->xAttempts = pxCallback->xAttempts;
+					pxOther->xRetryState = pxCallback->xRetryState;
+					pxOther->xRetryTime = pxCallback->xRetryTime;
+					break;
+				}
+			}
+		}
+
+		vPortFree( ( void * ) pxCallback );
 	}
 	/*-----------------------------------------------------------*/
 
 	/* Iterate through the list of call-back structures and remove
 	old entries which have reached a timeout.
-	As soon as the list hase become empty, the DNS timer will be stopped
+	Requests that have not been answered yet are sent again, and
+	names that were registered with FreeRTOS_dnsprefetch() are
+	refreshed before they expire.
+	As soon as there is nothing left to do, the DNS timer will be stopped
 	In case pvSearchID is supplied, the user wants to cancel a DNS request
 	*/
 	void vDNSCheckCallBack( void *pvSearchID );
@@ -300,6 +506,9 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 	{
 	const ListItem_t *pxIterator;
 	const MiniListItem_t* xEnd = ( const MiniListItem_t* )listGET_END_MARKER( &xCallbackList );
+	char pcName[ dnsMAX_NAME_LENGTH ];
+	TickType_t xIdentifier;
+	BaseType_t xResend;
 
 		vTaskSuspendAll();
 		{
@@ -312,23 +521,69 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 				pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator );
 				if( ( pvSearchID != NULL ) && ( pvSearchID == pxCallback->pvSearchID ) )
 				{
-					uxListRemove( &pxCallback->xListItem );
-					vPortFree( pxCallback );
+					prvDNSRemoveCallback( pxCallback );
 				}
 				else if( xTaskCheckForTimeOut( &pxCallback->xTimeoutState, &pxCallback->xRemaningTime ) != pdFALSE )
 				{
 					pxCallback->pCallbackFunction( pxCallback->pcName, pxCallback->pvSearchID, 0 );
-					uxListRemove( &pxCallback->xListItem );
-					vPortFree( ( void * ) pxCallback );
+					prvDNSRemoveCallback( pxCallback );
 				}
 			}
 		}
 		xTaskResumeAll();
 
-		if( listLIST_IS_EMPTY( &xCallbackList ) )
+		if( pvSearchID == NULL )
 		{
-			vIPSetDnsTimerEnableState( pdFALSE );
+			/* Send the requests that have not been answered in time again.  The
+			name is copied while the scheduler is suspended, the message is sent
+			after it has been resumed. */
+			do
+			{
+				xResend = pdFALSE;
+				vTaskSuspendAll();
+				{
+					for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( xEnd );
+						 pxIterator != ( const ListItem_t * ) xEnd;
+						 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+					{
+						DNSCallback_t *pxCallback = ( DNSCallback_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+						if( ( pxCallback->xAttempts > 0 ) &&
+							( pxCallback->xAttempts < ( BaseType_t ) ipconfigDNS_REQUEST_ATTEMPTS ) &&
+							( xTaskCheckForTimeOut( &pxCallback->xRetryState, &pxCallback->xRetryTime ) != pdFALSE ) &&
+							( strlen( pxCallback->pcName ) < sizeof( pcName ) ) )
+						{
+							pxCallback->xAttempts++;
+							pxCallback->xRetryTime = pdMS_TO_TICKS( ipconfigDNS_REQUEST_RETRY_TIME_MS );
+							vTaskSetTimeOutState( &pxCallback->xRetryState );
+							strcpy( pcName, pxCallback->pcName );
+							xIdentifier = listGET_LIST_ITEM_VALUE( pxIterator );
+							xResend = pdTRUE;
+							break;
+						}
+					}
+				}
+				xTaskResumeAll();
+
+				if( xResend != pdFALSE )
+				{
+					prvSendDNSRequest( xDNSClientSocket, pcName, xIdentifier, 0u );
+				}
+			} while( xResend != pdFALSE );
+
+			#if( ipconfigUSE_DNS_CACHE == 1 )
+			{
+				if( prvDNSCachePrefetchDue( pcName, sizeof( pcName ) ) != pdFALSE )
+				{
+					FreeRTOS_debug_printf( ( "vDNSCheckCallBack: prefetch '%s'\n", pcName ) );
+					prvDNSStartRequest( pcName, ( void * ) xDNSCache, prvDNSPrefetchCallback,
+						( TickType_t ) ( ipconfigDNS_REQUEST_ATTEMPTS * ipconfigDNS_REQUEST_RETRY_TIME_MS ) );
+				}
+			}
+			#endif /* ipconfigUSE_DNS_CACHE == 1 */
 		}
+
+		prvDNSTimerUpdate();
 	}
 	/*-----------------------------------------------------------*/
 
@@ -340,42 +595,103 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 	/*-----------------------------------------------------------*/
 
 	/* FreeRTOS_gethostbyname_a() was called along with callback parameters.
-	Store them in a list for later reference. */
-	static void vDNSSetCallBack( const char *pcHostName, void *pvSearchID, FOnDNSEvent pCallbackFunction, TickType_t xTimeout, TickType_t xIdentifier );
-	static void vDNSSetCallBack( const char *pcHostName, void *pvSearchID, FOnDNSEvent pCallbackFunction, TickType_t xTimeout, TickType_t xIdentifier )
+	Store them in a list for later reference.  When a request for the same name
+	is already pending, the new entry waits for the same reply and
+	*pxNewRequest is set to pdFALSE.  Otherwise the identifier of a new request
+	is stored in pxIdentifier and *pxNewRequest is set to pdTRUE: the caller
+	must send it.  Returns pdFAIL if the entry could not be allocated. */
+	static BaseType_t vDNSSetCallBack( const char *pcHostName, void *pvSearchID, FOnDNSEvent pCallbackFunction, TickType_t xTimeout, TickType_t *pxIdentifier, BaseType_t *pxNewRequest );
+	static BaseType_t vDNSSetCallBack( const char *pcHostName, void *pvSearchID, FOnDNSEvent pCallbackFunction, TickType_t xTimeout, TickType_t *pxIdentifier, BaseType_t *pxNewRequest )
 	{
 		size_t lLength = strlen( pcHostName );
 		DNSCallback_t *pxCallback = ( DNSCallback_t * )pvPortMalloc( sizeof( *pxCallback ) + lLength );
+		DNSCallback_t *pxRequest;
+		BaseType_t xReturn = pdFAIL;
+
+		*pxNewRequest = pdFALSE;
 
 		/* Translate from ms to number of clock ticks. */
 		xTimeout /= portTICK_PERIOD_MS;
 		if( pxCallback != NULL )
 		{
-			if( listLIST_IS_EMPTY( &xCallbackList ) )
-			{
-				/* This is the first one, start the DNS timer to check for timeouts */
-				vIPReloadDNSTimer( FreeRTOS_min_uint32( 1000U, xTimeout ) );
-			}
 			strcpy( pxCallback->pcName, pcHostName );
 			pxCallback->pCallbackFunction = pCallbackFunction;
 			pxCallback->pvSearchID = pvSearchID;
 			pxCallback->xRemaningTime = xTimeout;
 			vTaskSetTimeOutState( &pxCallback->xTimeoutState );
+			pxCallback->xRetryTime = pdMS_TO_TICKS( ipconfigDNS_REQUEST_RETRY_TIME_MS );
+			vTaskSetTimeOutState( &pxCallback->xRetryState );
 			listSET_LIST_ITEM_OWNER( &( pxCallback->xListItem ), ( void* ) pxCallback );
-			listSET_LIST_ITEM_VALUE( &( pxCallback->xListItem ), xIdentifier );
 			vTaskSuspendAll();
 			{
+				pxRequest = prvDNSFindRequest( pcHostName );
+				if( pxRequest != NULL )
+				{
+					/* Coalesce with the pending request. */
+					pxCallback->xAttempts = 0;
+					listSET_LIST_ITEM_VALUE( &( pxCallback->xListItem ), listGET_LIST_ITEM_VALUE( &( pxRequest->xListItem ) ) );
+				}
+				else
+				{
+					pxCallback->xAttempts = 1;
+					listSET_LIST_ITEM_VALUE( &( pxCallback->xListItem ), *pxIdentifier );
+					*pxNewRequest = pdTRUE;
+				}
 				vListInsertEnd( &xCallbackList, &pxCallback->xListItem );
 			}
 			xTaskResumeAll();
+
+			prvDNSTimerUpdate();
+			xReturn = pdPASS;
 		}
+
+		return xReturn;
 	}
 	/*-----------------------------------------------------------*/
 
-	/* A DNS reply was received, see if there is any matching entry and
-	call the handler. */
-	static void vDNSDoCallback( TickType_t xIdentifier, const char *pcName, uint32_t ulIPAddress );
-	static void vDNSDoCallback( TickType_t xIdentifier, const char *pcName, uint32_t ulIPAddress )
+	static BaseType_t prvDNSStartRequest( const char *pcHostName, void *pvSearchID, FOnDNSEvent pCallbackFunction, TickType_t xTimeout )
+	{
+	TickType_t xIdentifier;
+	uint32_t ulRandom;
+	BaseType_t xReturn = pdFAIL;
+	BaseType_t xNewRequest;
+
+		/* Generate a unique identifier.  Only 16 bits are transmitted, so the
+		value stored in the list must fit in 16 bits as well. */
+		ulRandom = ipconfigRAND32();
+		xIdentifier = ( TickType_t ) ( ( uint16_t ) ( ulRandom ^ ( ulRandom >> 16 ) ) );
+
+		if( ( xIdentifier != 0u ) && ( xDNSClientSocket != NULL ) )
+		{
+			/* When the entry can not be stored, no callback will ever be
+			called, so the caller must not wait for one. */
+			xReturn = vDNSSetCallBack( pcHostName, pvSearchID, pCallbackFunction, xTimeout, &xIdentifier, &xNewRequest );
+			if( ( xReturn != pdFAIL ) && ( xNewRequest != pdFALSE ) )
+			{
+				/* If sending fails, the DNS timer will try again. */
+				prvSendDNSRequest( xDNSClientSocket, pcHostName, xIdentifier,
+					( xIsCallingFromIPTask() != pdFALSE ) ? 0u : ipconfigUDP_MAX_SEND_BLOCK_TIME_TICKS );
+			}
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvDNSWaiterCallback( const char *pcName, void *pvSearchID, uint32_t ulIPAddress )
+	{
+	DNSWaiter_t *pxWaiter = ( DNSWaiter_t * ) pvSearchID;
+
+		( void ) pcName;
+		pxWaiter->ulIPAddress = ulIPAddress;
+		xSemaphoreGive( pxWaiter->xSemaphore );
+	}
+	/*-----------------------------------------------------------*/
+
+	/* A DNS reply was received, call the handlers of all entries that were
+	waiting for it. */
+	static void vDNSDoCallback( TickType_t xIdentifier, uint32_t ulIPAddress );
+	static void vDNSDoCallback( TickType_t xIdentifier, uint32_t ulIPAddress )
 	{
 		const ListItem_t *pxIterator;
 		const MiniListItem_t* xEnd = ( const MiniListItem_t* )listGET_END_MARKER( &xCallbackList );
@@ -384,23 +700,22 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 		{
 			for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( xEnd );
 				 pxIterator != ( const ListItem_t * ) xEnd;
-				 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+				  )
 			{
-				if( listGET_LIST_ITEM_VALUE( pxIterator ) == xIdentifier )
+				DNSCallback_t *pxCallback = ( DNSCallback_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+				/* Move to the next item because we might remove this item */
+				pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator );
+				if( listGET_LIST_ITEM_VALUE( &( pxCallback->xListItem ) ) == xIdentifier )
 				{
-					DNSCallback_t *pxCallback = ( DNSCallback_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
-					pxCallback->pCallbackFunction( pcName, pxCallback->pvSearchID, ulIPAddress );
+					pxCallback->pCallbackFunction( pxCallback->pcName, pxCallback->pvSearchID, ulIPAddress );
 					uxListRemove( &pxCallback->xListItem );
 					vPortFree( pxCallback );
-					if( listLIST_IS_EMPTY( &xCallbackList ) )
-					{
-						vIPSetDnsTimerEnableState( pdFALSE );
-					}
-					break;
 				}
 			}
 		}
 		xTaskResumeAll();
+
+		prvDNSTimerUpdate();
 	}
 
 #endif	/* ipconfigDNS_USE_CALLBACKS != 0 */
@@ -413,8 +728,10 @@ uint32_t FreeRTOS_gethostbyname_a( const char *pcHostName, FOnDNSEvent pCallback
 #endif
 {
 uint32_t ulIPAddress = 0UL;
-TickType_t xReadTimeOut_ms = ipconfigSOCK_DEFAULT_RECEIVE_BLOCK_TIME;
-TickType_t xIdentifier = 0;
+#if( ipconfigDNS_USE_CALLBACKS == 0 )
+	TickType_t xReadTimeOut_ms = ipconfigSOCK_DEFAULT_RECEIVE_BLOCK_TIME;
+	TickType_t xIdentifier = 0;
+#endif
 
 	/* If the supplied hostname is IP address, convert it to uint32_t
 	and return. */
@@ -437,30 +754,22 @@ TickType_t xIdentifier = 0;
 			}
 			else
 			{
-				/* prvGetHostByName will be called to start a DNS lookup */
+				/* A DNS lookup will be started. */
 			}
 		}
 	}
 	#endif /* ipconfigUSE_DNS_CACHE == 1 */
 
-	/* Generate a unique identifier. */
-	if( 0 == ulIPAddress )
-	{
-		xIdentifier = ( TickType_t )ipconfigRAND32( );
-	}
-
 	#if( ipconfigDNS_USE_CALLBACKS != 0 )
 	{
 		if( pCallback != NULL )
 		{
 			if( ulIPAddress == 0UL )
 			{
-				/* The user has provided a callback function, so do not block on recvfrom() */
-				if( 0 != xIdentifier )
-				{
-					xReadTimeOut_ms = 0;
-					vDNSSetCallBack( pcHostName, pvSearchID, pCallback, xTimeout, ( TickType_t )xIdentifier );
-				}
+				/* The user has provided a callback function, it will be called
+				from the IP-task when the reply comes in or when the request
+				times out. */
+				prvDNSStartRequest( pcHostName, pvSearchID, pCallback, xTimeout );
 			}
 			else
 			{
@@ -468,29 +777,57 @@ TickType_t xIdentifier = 0;
 				pCallback( pcHostName, pvSearchID, ulIPAddress );
 			}
 		}
-	}
-	#endif
+		else if( ulIPAddress == 0UL )
+		{
+		DNSWaiter_t xWaiter;
+		TickType_t xWaitTime_ms = ( TickType_t ) ( ipconfigDNS_REQUEST_ATTEMPTS * ipconfigDNS_REQUEST_RETRY_TIME_MS );
 
-	if( ( ulIPAddress == 0UL ) && ( 0 != xIdentifier ) )
+			/* A blocking call: wait for the asynchronous request to complete. */
+			xWaiter.ulIPAddress = 0UL;
+			xWaiter.xSemaphore = xSemaphoreCreateBinary();
+			if( xWaiter.xSemaphore != NULL )
+			{
+				if( prvDNSStartRequest( pcHostName, ( void * ) &xWaiter, prvDNSWaiterCallback, xWaitTime_ms ) != pdFAIL )
+				{
+					/* The request times out after xWaitTime_ms, and the
+					callback will then give the semaphore.  Allow a margin
+					for the period of the DNS timer. */
+					if( xSemaphoreTake( xWaiter.xSemaphore, pdMS_TO_TICKS( xWaitTime_ms + ipconfigDNS_REQUEST_RETRY_TIME_MS ) ) == pdFALSE )
+					{
+						FreeRTOS_gethostbyname_cancel( ( void * ) &xWaiter );
+					}
+					ulIPAddress = xWaiter.ulIPAddress;
+				}
+				vSemaphoreDelete( xWaiter.xSemaphore );
+			}
+		}
+	}
+	#else
 	{
-		ulIPAddress = prvGetHostByName( pcHostName, xIdentifier, xReadTimeOut_ms );
+		/* Generate a unique identifier. */
+		if( 0 == ulIPAddress )
+		{
+			xIdentifier = ( TickType_t )ipconfigRAND32( );
+		}
+
+		if( ( ulIPAddress == 0UL ) && ( 0 != xIdentifier ) )
+		{
+			ulIPAddress = prvGetHostByName( pcHostName, xIdentifier, xReadTimeOut_ms );
+		}
 	}
+	#endif /* ipconfigDNS_USE_CALLBACKS != 0 */
 
 	return ulIPAddress;
 }
 /*-----------------------------------------------------------*/
 
-static uint32_t prvGetHostByName( const char *pcHostName, TickType_t xIdentifier, TickType_t xReadTimeOut_ms )
+static BaseType_t prvSendDNSRequest( Socket_t xSocket, const char *pcHostName, TickType_t xIdentifier, TickType_t xBlockTimeTicks )
 {
 struct freertos_sockaddr xAddress;
-Socket_t xDNSSocket;
 uint32_t ulIPAddress = 0UL;
 uint8_t *pucUDPPayloadBuffer;
-uint32_t ulAddressLength = sizeof( struct freertos_sockaddr );
-BaseType_t xAttempt;
-int32_t lBytes;
 size_t xPayloadLength, xExpectedPayloadLength;
-TickType_t xWriteTimeOut_ms = ipconfigSOCK_DEFAULT_SEND_BLOCK_TIME;
+BaseType_t xReturn = pdFAIL;
 
 #if( ipconfigUSE_LLMNR == 1 )
 	BaseType_t bHasDot = pdFALSE;
@@ -516,50 +853,77 @@ TickType_t xWriteTimeOut_ms = ipconfigSOCK_DEFAULT_SEND_BLOCK_TIME;
 	subdomain part and the string end byte. */
 	xExpectedPayloadLength = sizeof( DNSMessage_t ) + strlen( pcHostName ) + sizeof( uint16_t ) + sizeof( uint16_t ) + 2u;
 
-	xDNSSocket = prvCreateDNSSocket();
+	/* Get a buffer.  The delay will be capped to
+	ipconfigUDP_MAX_SEND_BLOCK_TIME_TICKS so the return value still needs to be
+	tested. */
+	pucUDPPayloadBuffer = ( uint8_t * ) FreeRTOS_GetUDPPayloadBuffer( xExpectedPayloadLength, xBlockTimeTicks );
 
-	if( xDNSSocket != NULL )
+	if( pucUDPPayloadBuffer != NULL )
 	{
-		FreeRTOS_setsockopt( xDNSSocket, 0, FREERTOS_SO_SNDTIMEO, ( void * ) &xWriteTimeOut_ms, sizeof( TickType_t ) );
-		FreeRTOS_setsockopt( xDNSSocket, 0, FREERTOS_SO_RCVTIMEO, ( void * ) &xReadTimeOut_ms,  sizeof( TickType_t ) );
+		/* Create the message in the obtained buffer. */
+		xPayloadLength = prvCreateDNSMessage( pucUDPPayloadBuffer, pcHostName, xIdentifier );
+
+		iptraceSENDING_DNS_REQUEST();
+
+		/* Obtain the DNS server address. */
+		FreeRTOS_GetAddressConfiguration( NULL, NULL, NULL, &ulIPAddress );
 
-		for( xAttempt = 0; xAttempt < ipconfigDNS_REQUEST_ATTEMPTS; xAttempt++ )
+		/* Send the DNS message. */
+#if( ipconfigUSE_LLMNR == 1 )
+		if( bHasDot == pdFALSE )
 		{
-			/* Get a buffer.  This uses a maximum delay, but the delay will be
-			capped to ipconfigUDP_MAX_SEND_BLOCK_TIME_TICKS so the return value
-			still needs to be tested. */
-			pucUDPPayloadBuffer = ( uint8_t * ) FreeRTOS_GetUDPPayloadBuffer( xExpectedPayloadLength, portMAX_DELAY );
+			/* Use LLMNR addressing. */
+			( ( DNSMessage_t * ) pucUDPPayloadBuffer) -> usFlags = 0;
+			xAddress.sin_addr = ipLLMNR_IP_ADDR;	/* Is in network byte order. */
+			xAddress.sin_port = FreeRTOS_ntohs( ipLLMNR_PORT );
+		}
+		else
+#endif
+		{
+			/* Use DNS server. */
+			xAddress.sin_addr = ulIPAddress;
+			xAddress.sin_port = dnsDNS_PORT;
+		}
 
-			if( pucUDPPayloadBuffer != NULL )
-			{
-				/* Create the message in the obtained buffer. */
-				xPayloadLength = prvCreateDNSMessage( pucUDPPayloadBuffer, pcHostName, xIdentifier );
+		if( FreeRTOS_sendto( xSocket, pucUDPPayloadBuffer, xPayloadLength, FREERTOS_ZERO_COPY, &xAddress, sizeof( xAddress ) ) != 0 )
+		{
+			xReturn = pdPASS;
+		}
+		else
+		{
+			/* The message was not sent so the stack will not be
+			releasing the zero copy - it must be released here. */
+			FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pucUDPPayloadBuffer );
+		}
+	}
 
-				iptraceSENDING_DNS_REQUEST();
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
 
-				/* Obtain the DNS server address. */
-				FreeRTOS_GetAddressConfiguration( NULL, NULL, NULL, &ulIPAddress );
+#if( ipconfigDNS_USE_CALLBACKS == 0 )
 
-				/* Send the DNS message. */
-#if( ipconfigUSE_LLMNR == 1 )
-				if( bHasDot == pdFALSE )
-				{
-					/* Use LLMNR addressing. */
-					( ( DNSMessage_t * ) pucUDPPayloadBuffer) -> usFlags = 0;
-					xAddress.sin_addr = ipLLMNR_IP_ADDR;	/* Is in network byte order. */
-					xAddress.sin_port = FreeRTOS_ntohs( ipLLMNR_PORT );
-				}
-				else
-#endif
-				{
-					/* Use DNS server. */
-					xAddress.sin_addr = ulIPAddress;
-					xAddress.sin_port = dnsDNS_PORT;
-				}
+	static uint32_t prvGetHostByName( const char *pcHostName, TickType_t xIdentifier, TickType_t xReadTimeOut_ms )
+	{
+	struct freertos_sockaddr xAddress;
+	Socket_t xDNSSocket;
+	uint32_t ulIPAddress = 0UL;
+	uint8_t *pucUDPPayloadBuffer;
+	uint32_t ulAddressLength = sizeof( struct freertos_sockaddr );
+	BaseType_t xAttempt;
+	int32_t lBytes;
+	TickType_t xWriteTimeOut_ms = ipconfigSOCK_DEFAULT_SEND_BLOCK_TIME;
 
-				ulIPAddress = 0UL;
+		xDNSSocket = prvCreateDNSSocket();
+
+		if( xDNSSocket != NULL )
+		{
+			FreeRTOS_setsockopt( xDNSSocket, 0, FREERTOS_SO_SNDTIMEO, ( void * ) &xWriteTimeOut_ms, sizeof( TickType_t ) );
+			FreeRTOS_setsockopt( xDNSSocket, 0, FREERTOS_SO_RCVTIMEO, ( void * ) &xReadTimeOut_ms,  sizeof( TickType_t ) );
 
-				if( FreeRTOS_sendto( xDNSSocket, pucUDPPayloadBuffer, xPayloadLength, FREERTOS_ZERO_COPY, &xAddress, sizeof( xAddress ) ) != 0 )
+			for( xAttempt = 0; xAttempt < ipconfigDNS_REQUEST_ATTEMPTS; xAttempt++ )
+			{
+				if( prvSendDNSRequest( xDNSSocket, pcHostName, xIdentifier, portMAX_DELAY ) != pdFAIL )
 				{
 					/* Wait for the reply. */
 					lBytes = FreeRTOS_recvfrom( xDNSSocket, &pucUDPPayloadBuffer, 0, FREERTOS_ZERO_COPY, &xAddress, &ulAddressLength );
@@ -581,21 +945,16 @@ TickType_t xWriteTimeOut_ms = ipconfigSOCK_DEFAULT_SEND_BLOCK_TIME;
 						}
 					}
 				}
-				else
-				{
-					/* The message was not sent so the stack will not be
-					releasing the zero copy - it must be released here. */
-					FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pucUDPPayloadBuffer );
-				}
 			}
+
+			/* Finished with the socket. */
+			FreeRTOS_closesocket( xDNSSocket );
 		}
 
-		/* Finished with the socket. */
-		FreeRTOS_closesocket( xDNSSocket );
+		return ulIPAddress;
 	}
 
-	return ulIPAddress;
-}
+#endif /* ipconfigDNS_USE_CALLBACKS == 0 */
 /*-----------------------------------------------------------*/
 
 static size_t prvCreateDNSMessage( uint8_t *pucUDPPayloadBuffer, const char *pcHostName, TickType_t xIdentifier )
@@ -813,7 +1172,9 @@ uint8_t *pucUDPPayloadBuffer;
 size_t xPlayloadBufferLength;
 DNSMessage_t *pxDNSMessageHeader;
 
-	xPlayloadBufferLength = pxNetworkBuffer->xDataLength - sizeof( UDPPacket_t );
+	/* prvProcessIPPacket() has set xDataLength to the length of the UDP
+	payload already. */
+	xPlayloadBufferLength = pxNetworkBuffer->xDataLength;
 	if ( xPlayloadBufferLength < sizeof( DNSMessage_t ) )
 	{
 		return pdFAIL;
@@ -822,12 +1183,9 @@ DNSMessage_t *pxDNSMessageHeader;
 	pucUDPPayloadBuffer = pxNetworkBuffer->pucEthernetBuffer + sizeof( UDPPacket_t );
 	pxDNSMessageHeader = ( DNSMessage_t * ) pucUDPPayloadBuffer;
 
-	if( pxNetworkBuffer->xDataLength > sizeof( UDPPacket_t ) )
-	{
-		prvParseDNSReply( pucUDPPayloadBuffer,
-			xPlayloadBufferLength,
-			( uint32_t )pxDNSMessageHeader->usIdentifier );
-	}
+	prvParseDNSReply( pucUDPPayloadBuffer,
+		xPlayloadBufferLength,
+		( uint32_t )pxDNSMessageHeader->usIdentifier );
 
 	/* The packet was not consumed. */
 	return pdFAIL;
@@ -1001,13 +1359,13 @@ uint16_t x, usDataLength, usQuestions;
 
 						#if( ipconfigUSE_DNS_CACHE == 1 )
 						{
-							prvProcessDNSCache( pcName, &ulIPAddress, pxDNSAnswerRecord->ulTTL, pdFALSE );
+							prvProcessDNSCache( pcName, &ulIPAddress, FreeRTOS_ntohl( pxDNSAnswerRecord->ulTTL ), pdFALSE );
 						}
 						#endif /* ipconfigUSE_DNS_CACHE */
 						#if( ipconfigDNS_USE_CALLBACKS != 0 )
 						{
 							/* See if any asynchronous call was made to FreeRTOS_gethostbyname_a() */
-							vDNSDoCallback( ( TickType_t ) pxDNSMessageHeader->usIdentifier, pcName, ulIPAddress );
+							vDNSDoCallback( ( TickType_t ) pxDNSMessageHeader->usIdentifier, ulIPAddress );
 						}
 						#endif	/* ipconfigDNS_USE_CALLBACKS != 0 */
 					}
@@ -1258,36 +1616,40 @@ uint16_t x, usDataLength, usQuestions;
 #endif	/* ipconfigUSE_NBNS */
 /*-----------------------------------------------------------*/
 
-static Socket_t prvCreateDNSSocket( void )
-{
-Socket_t xSocket = NULL;
-struct freertos_sockaddr xAddress;
-BaseType_t xReturn;
-TickType_t xTimeoutTime = pdMS_TO_TICKS( 200 );
+#if( ipconfigDNS_USE_CALLBACKS == 0 )
 
-	/* This must be the first time this function has been called.  Create
-	the socket. */
-	xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+	static Socket_t prvCreateDNSSocket( void )
+	{
+	Socket_t xSocket = NULL;
+	struct freertos_sockaddr xAddress;
+	BaseType_t xReturn;
+	TickType_t xTimeoutTime = pdMS_TO_TICKS( 200 );
 
-	/* Auto bind the port. */
-	xAddress.sin_port = 0u;
-	xReturn = FreeRTOS_bind( xSocket, &xAddress, sizeof( xAddress ) );
+		/* This must be the first time this function has been called.  Create
+		the socket. */
+		xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
 
-	/* Check the bind was successful, and clean up if not. */
-	if( xReturn != 0 )
-	{
-		FreeRTOS_closesocket( xSocket );
-		xSocket = NULL;
-	}
-	else
-	{
-		/* Set the send and receive timeouts. */
-		FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, ( void * ) &xTimeoutTime, sizeof( TickType_t ) );
-		FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_SNDTIMEO, ( void * ) &xTimeoutTime, sizeof( TickType_t ) );
+		/* Auto bind the port. */
+		xAddress.sin_port = 0u;
+		xReturn = FreeRTOS_bind( xSocket, &xAddress, sizeof( xAddress ) );
+
+		/* Check the bind was successful, and clean up if not. */
+		if( xReturn != 0 )
+		{
+			FreeRTOS_closesocket( xSocket );
+			xSocket = NULL;
+		}
+		else
+		{
+			/* Set the send and receive timeouts. */
+			FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, ( void * ) &xTimeoutTime, sizeof( TickType_t ) );
+			FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_SNDTIMEO, ( void * ) &xTimeoutTime, sizeof( TickType_t ) );
+		}
+
+		return xSocket;
 	}
 
-	return xSocket;
-}
+#endif /* ipconfigDNS_USE_CALLBACKS == 0 */
 /*-----------------------------------------------------------*/
 
 #if( ( ipconfigUSE_NBNS == 1 ) || ( ipconfigUSE_LLMNR == 1 ) )
@@ -1336,80 +1698,249 @@ TickType_t xTimeoutTime = pdMS_TO_TICKS( 200 );
 
 #if( ipconfigUSE_DNS_CACHE == 1 )
 
-	static void prvProcessDNSCache( const char *pcName, uint32_t *pulIP, uint32_t ulTTL, BaseType_t xLookUp )
+	static uint32_t prvDNSCacheTimeLeft( const DNSCacheRow_t *pxRow, uint32_t ulCurrentTimeSeconds )
+	{
+	uint32_t ulAge = ulCurrentTimeSeconds - pxRow->ulTimeWhenAddedInSeconds;
+	uint32_t ulTimeLeft = 0u;
+
+		if( ( pxRow->pcName[ 0 ] != 0 ) && ( ulAge < pxRow->ulTTL ) )
+		{
+			ulTimeLeft = pxRow->ulTTL - ulAge;
+		}
+
+		return ulTimeLeft;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvDNSCacheFind( const char *pcName, uint32_t ulCurrentTimeSeconds, BaseType_t *pxFound )
 	{
 	BaseType_t x;
-	BaseType_t xFound = pdFALSE;
-	uint32_t ulCurrentTimeSeconds = ( xTaskGetTickCount() / portTICK_PERIOD_MS ) / 1000;
-	static BaseType_t xFreeEntry = 0;
+	BaseType_t xIndex = 0;
+	uint32_t ulCost, ulLowestCost = 0xffffffffUL;
+
+		*pxFound = pdFALSE;
 
 		/* For each entry in the DNS cache table. */
 		for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
 		{
 			if( xDNSCache[ x ].pcName[ 0 ] == 0 )
 			{
+				ulCost = 0u;
+			}
+			else if( 0 == strcmp( xDNSCache[ x ].pcName, pcName ) )
+			{
+				xIndex = x;
+				*pxFound = pdTRUE;
 				break;
 			}
+			else
+			{
+				/* Replace the entry that will expire first, but keep the names
+				that are being prefetched as long as possible. */
+				ulCost = prvDNSCacheTimeLeft( &( xDNSCache[ x ] ), ulCurrentTimeSeconds );
+				if( xDNSCache[ x ].ucPrefetch != 0u )
+				{
+					ulCost |= 0x80000000UL;
+				}
+			}
+
+			if( ulCost < ulLowestCost )
+			{
+				ulLowestCost = ulCost;
+				xIndex = x;
+			}
+		}
+
+		return xIndex;
+	}
+	/*-----------------------------------------------------------*/
 
-			if( 0 == strcmp( xDNSCache[ x ].pcName, pcName ) )
+	static void prvProcessDNSCache( const char *pcName, uint32_t *pulIP, uint32_t ulTTL, BaseType_t xLookUp )
+	{
+	BaseType_t x;
+	BaseType_t xFound;
+	uint32_t ulCurrentTimeSeconds = xTaskGetTickCount() / configTICK_RATE_HZ;
+	DNSCacheRow_t *pxRow;
+
+		if( xLookUp != pdFALSE )
+		{
+			*pulIP = 0;
+		}
+		else
+		{
+			/* Do not keep an address longer than allowed, whatever the server
+			says. */
+			ulTTL = FreeRTOS_min_uint32( ulTTL, ipconfigDNS_CACHE_MAX_TTL_SECONDS );
+		}
+
+		/* The cache is used by the IP-task and by the tasks that call
+		FreeRTOS_gethostbyname(). */
+		vTaskSuspendAll();
+		{
+			x = prvDNSCacheFind( pcName, ulCurrentTimeSeconds, &xFound );
+			pxRow = &( xDNSCache[ x ] );
+
+			/* Is this function called for a lookup or to add/update an IP address? */
+			if( xLookUp != pdFALSE )
 			{
-				/* Is this function called for a lookup or to add/update an IP address? */
-				if( xLookUp != pdFALSE )
+				if( xFound != pdFALSE )
 				{
-					/* Confirm that the record is still fresh. */
-					if( ulCurrentTimeSeconds < ( xDNSCache[ x ].ulTimeWhenAddedInSeconds + FreeRTOS_ntohl( xDNSCache[ x ].ulTTL ) ) )
+					/* Confirm that the record is still fresh.  A name that is
+					being prefetched may not have an address yet. */
+					if( prvDNSCacheTimeLeft( pxRow, ulCurrentTimeSeconds ) != 0u )
 					{
-						*pulIP = xDNSCache[ x ].ulIPAddress;
+						*pulIP = pxRow->ulIPAddress;
 					}
-					else
+					else if( pxRow->ucPrefetch == 0u )
 					{
 						/* Age out the old cached record. */
-						xDNSCache[ x ].pcName[ 0 ] = 0;
+						pxRow->pcName[ 0 ] = 0;
 					}
 				}
-				else
+			}
+			else if( ( xFound != pdFALSE ) || ( strlen( pcName ) < ipconfigDNS_CACHE_NAME_LENGTH ) )
+			{
+				/* Add or update the item. */
+				if( xFound == pdFALSE )
 				{
-					xDNSCache[ x ].ulIPAddress = *pulIP;
-					xDNSCache[ x ].ulTTL = ulTTL;
-					xDNSCache[ x ].ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
+					strcpy( pxRow->pcName, pcName );
+					pxRow->ucPrefetch = 0u;
 				}
 
-				xFound = pdTRUE;
-				break;
+				pxRow->ulIPAddress = *pulIP;
+				pxRow->ulTTL = ulTTL;
+				pxRow->ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
 			}
 		}
+		xTaskResumeAll();
 
-		if( xFound == pdFALSE )
+		if( ( xLookUp == 0 ) || ( *pulIP != 0 ) )
 		{
-			if( xLookUp != pdFALSE )
+			FreeRTOS_debug_printf( ( "prvProcessDNSCache: %s: '%s' @ %lxip\n", xLookUp ? "look-up" : "add", pcName, FreeRTOS_ntohl( *pulIP ) ) );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	#if( ipconfigDNS_USE_CALLBACKS != 0 )
+
+		BaseType_t FreeRTOS_dnsprefetch( const char *pcHostName )
+		{
+		BaseType_t x;
+		BaseType_t xFound;
+		BaseType_t xReturn = pdFAIL;
+		uint32_t ulCurrentTimeSeconds = xTaskGetTickCount() / configTICK_RATE_HZ;
+
+			if( strlen( pcHostName ) < ipconfigDNS_CACHE_NAME_LENGTH )
 			{
-				*pulIP = 0;
+				vTaskSuspendAll();
+				{
+					x = prvDNSCacheFind( pcHostName, ulCurrentTimeSeconds, &xFound );
+					if( xFound == pdFALSE )
+					{
+						/* Reserve a row that has expired already, so the name
+						will be looked up by the next timer event. */
+						strcpy( xDNSCache[ x ].pcName, pcHostName );
+						xDNSCache[ x ].ulIPAddress = 0UL;
+						xDNSCache[ x ].ulTTL = 0UL;
+						xDNSCache[ x ].ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
+					}
+					xDNSCache[ x ].ucPrefetch = 1u;
+				}
+				xTaskResumeAll();
+
+				prvDNSTimerUpdate();
+
+				/* The IP task calculated its sleep time before the DNS timer
+				was reloaded, wake it up so the name is looked up in time. */
+				if( xIsCallingFromIPTask() == pdFALSE )
+				{
+					xSendEventToIPTask( eNoEvent );
+				}
+				xReturn = pdPASS;
 			}
-			else
+
+			return xReturn;
+		}
+		/*-----------------------------------------------------------*/
+
+		static BaseType_t prvDNSCachePrefetchDue( char *pcName, size_t xLength )
+		{
+		BaseType_t x;
+		BaseType_t xReturn = pdFALSE;
+		uint32_t ulCurrentTimeSeconds = xTaskGetTickCount() / configTICK_RATE_HZ;
+		uint32_t ulMargin;
+
+			vTaskSuspendAll();
 			{
-				/* Add or update the item. */
-				if( strlen( pcName ) < ipconfigDNS_CACHE_NAME_LENGTH )
+				for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
 				{
-					strcpy( xDNSCache[ xFreeEntry ].pcName, pcName );
+					if( ( xDNSCache[ x ].ucPrefetch == 0u ) || ( xDNSCache[ x ].pcName[ 0 ] == 0 ) )
+					{
+						continue;
+					}
 
-					xDNSCache[ xFreeEntry ].ulIPAddress = *pulIP;
-					xDNSCache[ xFreeEntry ].ulTTL = ulTTL;
-					xDNSCache[ xFreeEntry ].ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
+					/* Refresh ipconfigDNS_CACHE_PREFETCH_SECONDS before the TTL
+					ends, or half-way for short TTL's. */
+					ulMargin = FreeRTOS_min_uint32( ipconfigDNS_CACHE_PREFETCH_SECONDS, xDNSCache[ x ].ulTTL / 2u );
 
-					xFreeEntry++;
-					if( xFreeEntry == ipconfigDNS_CACHE_ENTRIES )
+					if( ( prvDNSCacheTimeLeft( &( xDNSCache[ x ] ), ulCurrentTimeSeconds ) <= ulMargin ) &&
+						( prvDNSFindRequest( xDNSCache[ x ].pcName ) == NULL ) &&
+						( strlen( xDNSCache[ x ].pcName ) < xLength ) )
 					{
-						xFreeEntry = 0;
+						strcpy( pcName, xDNSCache[ x ].pcName );
+						xReturn = pdTRUE;
+						break;
 					}
 				}
 			}
+			xTaskResumeAll();
+
+			return xReturn;
 		}
+		/*-----------------------------------------------------------*/
 
-		if( ( xLookUp == 0 ) || ( *pulIP != 0 ) )
+		static BaseType_t prvDNSCacheHasPrefetch( void )
 		{
-			FreeRTOS_debug_printf( ( "prvProcessDNSCache: %s: '%s' @ %lxip\n", xLookUp ? "look-up" : "add", pcName, FreeRTOS_ntohl( *pulIP ) ) );
+		BaseType_t x;
+		BaseType_t xReturn = pdFALSE;
+
+			for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+			{
+				if( ( xDNSCache[ x ].ucPrefetch != 0u ) && ( xDNSCache[ x ].pcName[ 0 ] != 0 ) )
+				{
+					xReturn = pdTRUE;
+					break;
+				}
+			}
+
+			return xReturn;
 		}
-	}
+		/*-----------------------------------------------------------*/
+
+		static void prvDNSPrefetchCallback( const char *pcName, void *pvSearchID, uint32_t ulIPAddress )
+		{
+		BaseType_t x;
+		BaseType_t xFound;
+		uint32_t ulCurrentTimeSeconds = xTaskGetTickCount() / configTICK_RATE_HZ;
+
+			/* A reply has been stored in the cache already.  When the request
+			timed out and the address has expired, wait a while before trying
+			again. */
+			( void ) pvSearchID;
+
+			if( ulIPAddress == 0UL )
+			{
+				x = prvDNSCacheFind( pcName, ulCurrentTimeSeconds, &xFound );
+				if( ( xFound != pdFALSE ) && ( prvDNSCacheTimeLeft( &( xDNSCache[ x ] ), ulCurrentTimeSeconds ) == 0u ) )
+				{
+					xDNSCache[ x ].ulIPAddress = 0UL;
+					xDNSCache[ x ].ulTTL = 2u * ipconfigDNS_CACHE_PREFETCH_SECONDS;
+					xDNSCache[ x ].ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
+				}
+			}
+		}
+
+	#endif /* ipconfigDNS_USE_CALLBACKS != 0 */
 
 #endif /* ipconfigUSE_DNS_CACHE */
 
@@ -839,6 +839,11 @@ NetworkBufferDescriptor_t * pxNewBuffer;
 		pxNewBuffer->ulIPAddress = pxNetworkBuffer->ulIPAddress;
 		pxNewBuffer->usPort = pxNetworkBuffer->usPort;
 		pxNewBuffer->usBoundPort = pxNetworkBuffer->usBoundPort;
+		#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+		{
+			pxNewBuffer->usLargeSendMSS = pxNetworkBuffer->usLargeSendMSS;
+		}
+		#endif /* ipconfigUSE_TCP_LARGE_SEND */
 		memcpy( pxNewBuffer->pucEthernetBuffer, pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength );
 	}
 
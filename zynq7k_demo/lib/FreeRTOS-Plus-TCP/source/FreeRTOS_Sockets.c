@@ -345,6 +345,13 @@ Socket_t xReturn;
 					/* The above values are just defaults, and can be overridden by
 					calling FreeRTOS_setsockopt().  No buffers will be allocated until a
 					socket is connected and data is exchanged. */
+
+					#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+					{
+						pxSocket->u.xTCP.xTCPWindow.xCongestion.ucAlgorithm = ( uint8_t ) ipconfigTCP_CONGESTION_DEFAULT;
+						pxSocket->u.xTCP.xTCPWindow.xCongestion.ucPacing = ( uint8_t ) ipconfigTCP_PACING_DEFAULT;
+					}
+					#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
 				}
 			}
 			#endif  /* ipconfigUSE_TCP == 1 */
@@ -1571,6 +1578,42 @@ FreeRTOS_Socket_t *pxSocket;
 				xReturn = 0;
 				break;
 
+			#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+				case FREERTOS_SO_TCP_CONGESTION:	/* Select the congestion control algorithm */
+					{
+						if( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP )
+						{
+							break;	/* will return -pdFREERTOS_ERRNO_EINVAL */
+						}
+
+						if( xTCPWindowSetCongestionControl( &( pxSocket->u.xTCP.xTCPWindow ), *( ( BaseType_t * ) pvOptionValue ) ) == pdFAIL )
+						{
+							break;	/* will return -pdFREERTOS_ERRNO_EINVAL */
+						}
+					}
+					xReturn = 0;
+					break;
+
+				case FREERTOS_SO_TCP_PACING:		/* Spread new segments over the RTT */
+					{
+						if( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP )
+						{
+							break;	/* will return -pdFREERTOS_ERRNO_EINVAL */
+						}
+
+						if( *( ( BaseType_t * ) pvOptionValue ) != 0 )
+						{
+							pxSocket->u.xTCP.xTCPWindow.xCongestion.ucPacing = pdTRUE_UNSIGNED;
+						}
+						else
+						{
+							pxSocket->u.xTCP.xTCPWindow.xCongestion.ucPacing = pdFALSE_UNSIGNED;
+						}
+					}
+					xReturn = 0;
+					break;
+			#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 			case FREERTOS_SO_STOP_RX:		/* Refuse to receive more packts */
 				{
 					if( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP )
@@ -2663,7 +2706,22 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 				}
 
 				memset( pxSocket->u.xTCP.xPacket.u.ucLastPacket, '\0', sizeof( pxSocket->u.xTCP.xPacket.u.ucLastPacket ) );
-				memset( &pxSocket->u.xTCP.xTCPWindow, '\0', sizeof( pxSocket->u.xTCP.xTCPWindow ) );
+				#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+				{
+				uint8_t ucAlgorithm = pxSocket->u.xTCP.xTCPWindow.xCongestion.ucAlgorithm;
+				uint8_t ucPacing = pxSocket->u.xTCP.xTCPWindow.xCongestion.ucPacing;
+
+					memset( &pxSocket->u.xTCP.xTCPWindow, '\0', sizeof( pxSocket->u.xTCP.xTCPWindow ) );
+
+					/* The congestion control options survive the cleaning. */
+					pxSocket->u.xTCP.xTCPWindow.xCongestion.ucAlgorithm = ucAlgorithm;
+					pxSocket->u.xTCP.xTCPWindow.xCongestion.ucPacing = ucPacing;
+				}
+				#else
+				{
+					memset( &pxSocket->u.xTCP.xTCPWindow, '\0', sizeof( pxSocket->u.xTCP.xTCPWindow ) );
+				}
+				#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
 				memset( &pxSocket->u.xTCP.bits, '\0', sizeof( pxSocket->u.xTCP.bits ) );
 
 				/* Now set the bReuseSocket flag again, because the bits have
@@ -341,6 +341,15 @@ static BaseType_t prvTCPSocketCopy( FreeRTOS_Socket_t *pxNewSocket, FreeRTOS_Soc
 static NetworkBufferDescriptor_t *prvTCPBufferResize( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer,
 	int32_t lDataLen, UBaseType_t uxOptionsLength );
 
+/*
+ * Split a large TCP packet into frames of at most MSS bytes of data, and pass
+ * them one by one to the network interface.  Used when the driver can not do
+ * this itself.
+ */
+#if( ipconfigUSE_TCP_LARGE_SEND != 0 ) && ( ipconfigDRIVER_INCLUDED_LARGE_SEND == 0 )
+	static void prvTCPLargeSendSplit( NetworkBufferDescriptor_t *pxNetworkBuffer );
+#endif
+
 #if( ( ipconfigHAS_DEBUG_PRINTF != 0 ) || ( ipconfigHAS_PRINTF != 0 ) )
 	const char *FreeRTOS_GetTCPStateName( UBaseType_t ulState );
 #endif
@@ -692,6 +701,12 @@ NetworkBufferDescriptor_t xTempBuffer;
 			xTempBuffer.pxNextBuffer = NULL;
 		}
 		#endif
+		#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+		{
+			/* The socket's packet field only ever holds a single segment. */
+			xTempBuffer.usLargeSendMSS = 0u;
+		}
+		#endif
 		xTempBuffer.pucEthernetBuffer = pxSocket->u.xTCP.xPacket.u.ucLastPacket;
 		xTempBuffer.xDataLength = sizeof( pxSocket->u.xTCP.xPacket.u.ucLastPacket );
 		xReleaseAfterSend = pdFALSE;
@@ -876,6 +891,17 @@ NetworkBufferDescriptor_t xTempBuffer;
 		usPacketIdentifier++;
 		pxIPHeader->usFragmentOffset = 0u;
 
+		#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+		{
+			if( pxNetworkBuffer->usLargeSendMSS != 0u )
+			{
+				/* Each frame of a large packet will get its own identification. */
+				usPacketIdentifier += ( uint16_t ) ( ( ( ulLen - ( ipSIZE_OF_IPv4_HEADER + ( ( pxTCPPacket->xTCPHeader.ucTCPOffset >> 4 ) << 2 ) ) ) - 1u ) /
+					pxNetworkBuffer->usLargeSendMSS );
+			}
+		}
+		#endif /* ipconfigUSE_TCP_LARGE_SEND */
+
 		#if( ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM == 0 )
 		{
 			/* calculate the IP header checksum, in case the driver won't do that. */
@@ -883,8 +909,14 @@ NetworkBufferDescriptor_t xTempBuffer;
 			pxIPHeader->usHeaderChecksum = usGenerateChecksum( 0UL, ( uint8_t * ) &( pxIPHeader->ucVersionHeaderLength ), ipSIZE_OF_IPv4_HEADER );
 			pxIPHeader->usHeaderChecksum = ~FreeRTOS_htons( pxIPHeader->usHeaderChecksum );
 
-			/* calculate the TCP checksum for an outgoing packet. */
-			usGenerateProtocolChecksum( (uint8_t*)pxTCPPacket, pxNetworkBuffer->xDataLength, pdTRUE );
+			/* calculate the TCP checksum for an outgoing packet.  The frames
+			of a large packet will get their checksum when they are split. */
+			#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+				if( pxNetworkBuffer->usLargeSendMSS == 0u )
+			#endif
+			{
+				usGenerateProtocolChecksum( (uint8_t*)pxTCPPacket, pxNetworkBuffer->xDataLength, pdTRUE );
+			}
 
 			/* A calculated checksum of 0 must be inverted as 0 means the checksum
 			is disabled. */
@@ -925,7 +957,22 @@ NetworkBufferDescriptor_t xTempBuffer;
 		#endif
 
 		/* Send! */
-		xNetworkInterfaceOutput( pxNetworkBuffer, xReleaseAfterSend );
+		#if( ipconfigUSE_TCP_LARGE_SEND != 0 ) && ( ipconfigDRIVER_INCLUDED_LARGE_SEND == 0 )
+			if( pxNetworkBuffer->usLargeSendMSS != 0u )
+			{
+				/* The driver can not handle large packets, split it here. */
+				prvTCPLargeSendSplit( pxNetworkBuffer );
+
+				if( xReleaseAfterSend != pdFALSE )
+				{
+					vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+				}
+			}
+			else
+		#endif /* ipconfigUSE_TCP_LARGE_SEND */
+		{
+			xNetworkInterfaceOutput( pxNetworkBuffer, xReleaseAfterSend );
+		}
 
 		if( xReleaseAfterSend == pdFALSE )
 		{
@@ -943,6 +990,109 @@ NetworkBufferDescriptor_t xTempBuffer;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+
+	size_t uxTCPLargeSendGetSegment( const NetworkBufferDescriptor_t *pxNetworkBuffer, UBaseType_t uxIndex, uint8_t *pucTarget )
+	{
+	const TCPPacket_t *pxLargePacket = ( const TCPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer;
+	TCPPacket_t *pxTCPPacket = ( TCPPacket_t * ) pucTarget;
+	size_t uxHeaderLength, uxDataLength, uxOffset, uxLength;
+	size_t uxReturn = 0u;
+
+		/* All frames get a copy of the Ethernet, IP and TCP headers, including
+		the TCP options. */
+		uxHeaderLength = ( size_t ) ( ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER ) + ( size_t ) ( ( pxLargePacket->xTCPHeader.ucTCPOffset >> 4 ) << 2 );
+		uxDataLength = ( ( size_t ) FreeRTOS_ntohs( pxLargePacket->xIPHeader.usLength ) + ipSIZE_OF_ETH_HEADER ) - uxHeaderLength;
+		uxOffset = ( size_t ) uxIndex * ( size_t ) pxNetworkBuffer->usLargeSendMSS;
+
+		if( uxOffset < uxDataLength )
+		{
+			uxLength = FreeRTOS_min_uint32( ( uint32_t ) ( uxDataLength - uxOffset ), ( uint32_t ) pxNetworkBuffer->usLargeSendMSS );
+
+			memcpy( pucTarget, pxNetworkBuffer->pucEthernetBuffer, uxHeaderLength );
+			memcpy( pucTarget + uxHeaderLength, pxNetworkBuffer->pucEthernetBuffer + uxHeaderLength + uxOffset, uxLength );
+
+			pxTCPPacket->xIPHeader.usLength = FreeRTOS_htons( ( uint16_t ) ( ( uxHeaderLength - ipSIZE_OF_ETH_HEADER ) + uxLength ) );
+			pxTCPPacket->xIPHeader.usIdentification = FreeRTOS_htons( ( uint16_t ) ( FreeRTOS_ntohs( pxLargePacket->xIPHeader.usIdentification ) + uxIndex ) );
+			pxTCPPacket->xTCPHeader.ulSequenceNumber = FreeRTOS_htonl( FreeRTOS_ntohl( pxLargePacket->xTCPHeader.ulSequenceNumber ) + ( uint32_t ) uxOffset );
+
+			if( ( uxOffset + uxLength ) < uxDataLength )
+			{
+				/* PSH and FIN belong to the last frame. */
+				pxTCPPacket->xTCPHeader.ucTCPFlags &= ( ( uint8_t ) ~( ipTCP_FLAG_PSH | ipTCP_FLAG_FIN ) );
+			}
+
+			#if( ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM == 0 )
+			{
+				pxTCPPacket->xIPHeader.usHeaderChecksum = 0x00u;
+				pxTCPPacket->xIPHeader.usHeaderChecksum = usGenerateChecksum( 0UL, ( uint8_t * ) &( pxTCPPacket->xIPHeader.ucVersionHeaderLength ), ipSIZE_OF_IPv4_HEADER );
+				pxTCPPacket->xIPHeader.usHeaderChecksum = ~FreeRTOS_htons( pxTCPPacket->xIPHeader.usHeaderChecksum );
+
+				usGenerateProtocolChecksum( pucTarget, uxHeaderLength + uxLength, pdTRUE );
+
+				if( pxTCPPacket->xTCPHeader.usChecksum == 0x00u )
+				{
+					pxTCPPacket->xTCPHeader.usChecksum = 0xffffU;
+				}
+			}
+			#endif /* ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM */
+
+			uxReturn = uxHeaderLength + uxLength;
+		}
+
+		return uxReturn;
+	}
+
+#endif /* ipconfigUSE_TCP_LARGE_SEND */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_LARGE_SEND != 0 ) && ( ipconfigDRIVER_INCLUDED_LARGE_SEND == 0 )
+
+	static void prvTCPLargeSendSplit( NetworkBufferDescriptor_t *pxNetworkBuffer )
+	{
+	NetworkBufferDescriptor_t *pxFrame;
+	UBaseType_t uxIndex;
+	size_t uxLength;
+
+		for( uxIndex = 0u; ; uxIndex++ )
+		{
+			pxFrame = pxGetNetworkBufferWithDescriptor( ( size_t ) ipTOTAL_ETHERNET_FRAME_SIZE, 0u );
+
+			if( pxFrame == NULL )
+			{
+				/* The frames that are not sent will be retransmitted. */
+				FreeRTOS_debug_printf( ( "prvTCPLargeSendSplit: no buffer for frame %lu\n", ( uint32_t ) uxIndex ) );
+				break;
+			}
+
+			uxLength = uxTCPLargeSendGetSegment( pxNetworkBuffer, uxIndex, pxFrame->pucEthernetBuffer );
+
+			if( uxLength == 0u )
+			{
+				/* All frames have been sent. */
+				vReleaseNetworkBufferAndDescriptor( pxFrame );
+				break;
+			}
+
+			pxFrame->xDataLength = uxLength;
+
+			#if defined( ipconfigETHERNET_MINIMUM_PACKET_BYTES )
+			{
+				if( pxFrame->xDataLength < ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES )
+				{
+					memset( pxFrame->pucEthernetBuffer + pxFrame->xDataLength, '\0', ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES - pxFrame->xDataLength );
+					pxFrame->xDataLength = ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES;
+				}
+			}
+			#endif
+
+			xNetworkInterfaceOutput( pxFrame, pdTRUE );
+		}
+	}
+
+#endif /* ( ipconfigUSE_TCP_LARGE_SEND != 0 ) && ( ipconfigDRIVER_INCLUDED_LARGE_SEND == 0 ) */
+/*-----------------------------------------------------------*/
+
 /*
  * The SYN event is very important: the sequence numbers, which have a kind of
  * random starting value, are being synchronised.  The sliding window manager
@@ -1693,6 +1843,16 @@ int32_t lStreamPos;
 		pucEthernetBuffer = pxSocket->u.xTCP.xPacket.u.ucLastPacket;
 	}
 
+	#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+	{
+		if( ( *ppxNetworkBuffer ) != NULL )
+		{
+			/* The buffer may have been used for a large packet before. */
+			( *ppxNetworkBuffer )->usLargeSendMSS = 0u;
+		}
+	}
+	#endif /* ipconfigUSE_TCP_LARGE_SEND */
+
 	pxTCPPacket = ( TCPPacket_t * ) ( pucEthernetBuffer );
 	pxTCPWindow = &pxSocket->u.xTCP.xTCPWindow;
 	lDataLen = 0;
@@ -1708,6 +1868,19 @@ int32_t lStreamPos;
 		if( pxSocket->u.xTCP.usCurMSS > 1u )
 		{
 			lDataLen = ( int32_t ) ulTCPWindowTxGet( pxTCPWindow, pxSocket->u.xTCP.ulWindowSize, &lStreamPos );
+
+			#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+			{
+				/* Large packets need network buffers of a variable size.  The
+				IP length field limits their size to 64 KB. */
+				if( ( lDataLen > 0 ) && ( xBufferAllocFixedSize == pdFALSE ) )
+				{
+					lDataLen += ( int32_t ) ulTCPWindowTxGetMore( pxTCPWindow, pxSocket->u.xTCP.ulWindowSize, ( uint32_t ) lDataLen,
+						FreeRTOS_min_uint32( ( uint32_t ) ipconfigTCP_LARGE_SEND_SIZE,
+							0xffffUL - ( uint32_t ) ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + uxOptionsLength ) ) );
+				}
+			}
+			#endif /* ipconfigUSE_TCP_LARGE_SEND */
 		}
 
 		if( lDataLen > 0 )
@@ -1722,6 +1895,20 @@ int32_t lStreamPos;
 				pucEthernetBuffer = pxNewBuffer->pucEthernetBuffer;
 				pxTCPPacket = ( TCPPacket_t * ) ( pucEthernetBuffer );
 
+				#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+				{
+					/* Tell the network interface how to split this packet. */
+					if( lDataLen > ( int32_t ) pxTCPWindow->usMSS )
+					{
+						pxNewBuffer->usLargeSendMSS = pxTCPWindow->usMSS;
+					}
+					else
+					{
+						pxNewBuffer->usLargeSendMSS = 0u;
+					}
+				}
+				#endif /* ipconfigUSE_TCP_LARGE_SEND */
+
 				pucSendData = pucEthernetBuffer + ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + uxOptionsLength;
 
 				/* Translate the position in txStream to an offset from the tail
@@ -3176,6 +3363,14 @@ struct freertos_sockaddr xAddress;
 	pxNewSocket->u.xTCP.uxRxWinSize  = pxSocket->u.xTCP.uxRxWinSize;
 	pxNewSocket->u.xTCP.uxTxWinSize  = pxSocket->u.xTCP.uxTxWinSize;
 
+	#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	{
+		/* The child uses the same congestion control as its parent. */
+		pxNewSocket->u.xTCP.xTCPWindow.xCongestion.ucAlgorithm = pxSocket->u.xTCP.xTCPWindow.xCongestion.ucAlgorithm;
+		pxNewSocket->u.xTCP.xTCPWindow.xCongestion.ucPacing = pxSocket->u.xTCP.xTCPWindow.xCongestion.ucPacing;
+	}
+	#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 	#if( ipconfigSOCKET_HAS_USER_SEMAPHORE == 1 )
 	{
 		pxNewSocket->pxUserSemaphore = pxSocket->pxUserSemaphore;
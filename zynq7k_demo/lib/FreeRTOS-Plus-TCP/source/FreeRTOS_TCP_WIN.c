@@ -88,6 +88,26 @@
 	#define MAX_TRANSMIT_COUNT_USING_LARGE_WINDOW		( 4u )
 
 #endif /* configUSE_TCP_WIN */
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+
+	/* CUBIC multiplicative decrease factor (beta = 0.7) and scaling constant
+	(C = 0.4), as recommended in RFC 8312, expressed as fractions. */
+	#define winCUBIC_BETA_NUMERATOR			( 7u )
+	#define winCUBIC_BETA_DENOMINATOR		( 10u )
+	#define winCUBIC_C_NUMERATOR			( 4u )
+	#define winCUBIC_C_DENOMINATOR			( 10u )
+
+	/* The CUBIC function is evaluated at most this many ms away from K, to
+	keep the 64-bit arithmetic away from overflowing. */
+	#define winCUBIC_MAX_DISTANCE_MS		( 60000 )
+
+	/* Paced sockets are allowed to send at 1.25 times cwnd / SRTT, so the
+	pacing itself will not become the bottleneck. */
+	#define winPACING_GAIN_NUMERATOR		( 5u )
+	#define winPACING_GAIN_DENOMINATOR		( 4u )
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
 /*-----------------------------------------------------------*/
 
 extern void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewListItem, MiniListItem_t * const pxWhere );
@@ -197,6 +217,24 @@ extern void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewL
 	static uint32_t prvTCPWindowFastRetransmit( TCPWindow_t *pxWindow, uint32_t ulFirst );
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 
+/*
+ * Congestion control: the generic part which keeps track of fast recovery and
+ * calls the handlers of the algorithm selected for the window.
+ */
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	static void prvTCPWindowCongestionInit( TCPWindow_t *pxWindow );
+	static void prvTCPWindowCongestionOnAck( TCPWindow_t *pxWindow, uint32_t ulBytesAcked );
+	static void prvTCPWindowCongestionOnLoss( TCPWindow_t *pxWindow, BaseType_t xIsTimeout );
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
+/*
+ * Pacing: returns pdTRUE if a new segment of 'ulLength' bytes must wait, and
+ * sets '*pulDelay' to the number of ms to wait.
+ */
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	static BaseType_t prvTCPWindowPacingWait( TCPWindow_t *pxWindow, uint32_t ulLength, TickType_t *pulDelay );
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 /*-----------------------------------------------------------*/
 
 /* TCP segment pool. */
@@ -670,6 +708,13 @@ const int32_t l500ms = 500;
 	/* The right-hand side of the transmit window. */
 	pxWindow->tx.ulHighestSequenceNumber = ulSequenceNumber;
 	pxWindow->ulOurSequenceNumber = ulSequenceNumber;
+
+	#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	{
+		/* Now that the MSS is known, the congestion window can be set. */
+		prvTCPWindowCongestionInit( pxWindow );
+	}
+	#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
 }
 /*-----------------------------------------------------------*/
 
@@ -1187,6 +1232,17 @@ const int32_t l500ms = 500;
 			{
 				xHasSpace = pdFALSE;
 			}
+
+			#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+			{
+				/* The congestion window limits the outstanding data in the same
+				way.  At least one segment may always be sent. */
+				if( ( ulTxOutstanding != 0UL ) && ( pxWindow->xCongestion.ulCongestionWindow < ulTxOutstanding + ( ( uint32_t ) pxSegment->lDataLength ) ) )
+				{
+					xHasSpace = pdFALSE;
+				}
+			}
+			#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
 		}
 
 		return xHasSpace;
@@ -1233,6 +1289,25 @@ const int32_t l500ms = 500;
 					*pulDelay = ulMaxAge - ulAge;
 				}
 
+				#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+				{
+				TickType_t ulPacingDelay = 1u;
+
+					/* A paced socket may have been holding back new data while
+					other data is outstanding.  Wake up in time to send it. */
+					pxSegment = xTCPWindowPeekHead( &pxWindow->xTxQueue );
+
+					if( ( *pulDelay != 0u ) &&
+						( pxWindow->xCongestion.ucPacing != 0u ) &&
+						( pxSegment != NULL ) &&
+						( prvTCPWindowTxHasSpace( pxWindow, ulWindowSize ) != pdFALSE ) )
+					{
+						( void ) prvTCPWindowPacingWait( pxWindow, ( uint32_t ) pxSegment->lDataLength, &ulPacingDelay );
+						*pulDelay = FreeRTOS_min_uint32( *pulDelay, FreeRTOS_max_uint32( ulPacingDelay, 1u ) );
+					}
+				}
+				#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 				xReturn = pdTRUE;
 			}
 			else
@@ -1260,6 +1335,13 @@ const int32_t l500ms = 500;
 				}
 				else
 				{
+					#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+					{
+						/* The segment may be sent, but when the socket is paced
+						it might have to wait a little. */
+						( void ) prvTCPWindowPacingWait( pxWindow, ( uint32_t ) pxSegment->lDataLength, pulDelay );
+					}
+					#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
 					xReturn = pdTRUE;
 				}
 			}
@@ -1278,6 +1360,9 @@ const int32_t l500ms = 500;
 	TCPSegment_t *pxSegment;
 	uint32_t ulMaxTime;
 	uint32_t ulReturn  = ~0UL;
+	#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+		TickType_t ulPacingDelay;
+	#endif
 
 
 		/* Fetches data to be sent-out now.
@@ -1306,6 +1391,17 @@ const int32_t l500ms = 500;
 					pxSegment = xTCPWindowGetHead( &( pxWindow->xWaitQueue ) );
 					pxSegment->u.bits.ucDupAckCount = pdFALSE_UNSIGNED;
 
+					#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+					{
+						/* The RTO of the oldest outstanding segment expired:
+						a strong indication of congestion. */
+						if( pxSegment->ulSequenceNumber == pxWindow->tx.ulCurrentSequenceNumber )
+						{
+							prvTCPWindowCongestionOnLoss( pxWindow, pdTRUE );
+						}
+					}
+					#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 					/* Some detailed logging. */
 					if( ( xTCPWindowLoggingLevel != 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != 0 ) )
 					{
@@ -1346,11 +1442,29 @@ const int32_t l500ms = 500;
 					/* Peer has no more space at this moment. */
 					ulReturn = 0;
 				}
+				#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+				else if( prvTCPWindowPacingWait( pxWindow, ( uint32_t ) pxSegment->lDataLength, &ulPacingDelay ) != pdFALSE )
+				{
+					/* The socket is paced and the segment is not due yet.  The
+					IP-task will come back after 'ulPacingDelay' ms. */
+					ulReturn = 0;
+				}
+				#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
 				else
 				{
 					/* Move it out of the Tx queue. */
 					pxSegment = xTCPWindowGetHead( &( pxWindow->xTxQueue ) );
 
+					#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+					{
+						/* Consume the pacing credit for this segment. */
+						if( pxWindow->xCongestion.ucPacing != 0u )
+						{
+							pxWindow->xCongestion.ulPacingCredit -= ( uint32_t ) pxSegment->lDataLength;
+						}
+					}
+					#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 					/* Don't let pxHeadSegment point to this segment any more,
 					so no more data will be added. */
 					if( pxWindow->pxHeadSegment == pxSegment )
@@ -1439,12 +1553,109 @@ const int32_t l500ms = 500;
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_WIN == 1 ) && ( ipconfigUSE_TCP_LARGE_SEND != 0 )
+
+	uint32_t ulTCPWindowTxGetMore( TCPWindow_t *pxWindow, uint32_t ulWindowSize, uint32_t ulLength, uint32_t ulMaxLength )
+	{
+	TCPSegment_t *pxSegment;
+	uint32_t ulReturn = 0UL;
+	#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+		TickType_t ulPacingDelay;
+	#endif
+
+		/* Only append to a full segment which is the last one sent, so the
+		data will be contiguous, both in the sequence space and in the txStream. */
+		if( ( ulLength == ( uint32_t ) pxWindow->usMSS ) &&
+			( ( pxWindow->ulOurSequenceNumber + ulLength ) == pxWindow->tx.ulHighestSequenceNumber ) )
+		{
+			for( ;; )
+			{
+				pxSegment = xTCPWindowPeekHead( &( pxWindow->xTxQueue ) );
+
+				if( ( pxSegment == NULL ) ||
+					( pxSegment->ulSequenceNumber != pxWindow->tx.ulHighestSequenceNumber ) ||
+					( ( ulLength + ulReturn + ( uint32_t ) pxSegment->lDataLength ) > ulMaxLength ) )
+				{
+					break;
+				}
+
+				if( ( pxWindow->u.bits.bSendFullSize != pdFALSE_UNSIGNED ) && ( pxSegment->lDataLength < pxSegment->lMaxLength ) )
+				{
+					break;
+				}
+
+				if( prvTCPWindowTxHasSpace( pxWindow, ulWindowSize ) == pdFALSE )
+				{
+					break;
+				}
+
+				#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+				{
+					if( prvTCPWindowPacingWait( pxWindow, ( uint32_t ) pxSegment->lDataLength, &ulPacingDelay ) != pdFALSE )
+					{
+						break;
+					}
+
+					if( pxWindow->xCongestion.ucPacing != 0u )
+					{
+						pxWindow->xCongestion.ulPacingCredit -= ( uint32_t ) pxSegment->lDataLength;
+					}
+				}
+				#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
+				/* The same administration as in ulTCPWindowTxGet(), except for
+				ulOurSequenceNumber, which must keep pointing to the first
+				segment. */
+				pxSegment = xTCPWindowGetHead( &( pxWindow->xTxQueue ) );
+
+				if( pxWindow->pxHeadSegment == pxSegment )
+				{
+					pxWindow->pxHeadSegment = NULL;
+				}
+
+				pxWindow->tx.ulHighestSequenceNumber = pxSegment->ulSequenceNumber + ( ( uint32_t ) pxSegment->lDataLength );
+
+				vListInsertFifo( &pxWindow->xWaitQueue, &pxSegment->xQueueItem );
+				pxSegment->u.bits.bOutstanding = pdTRUE_UNSIGNED;
+				( pxSegment->u.bits.ucTransmitCount )++;
+				vTCPTimerSet( &( pxSegment->xTransmitTimer ) );
+
+				ulReturn += ( uint32_t ) pxSegment->lDataLength;
+
+				if( pxSegment->lDataLength < pxSegment->lMaxLength )
+				{
+					/* Only the last segment of a large packet may be short. */
+					break;
+				}
+			}
+
+			if( ( ulReturn != 0UL ) && ( xTCPWindowLoggingLevel >= 2 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != pdFALSE ) )
+			{
+				FreeRTOS_debug_printf( ( "ulTCPWindowTxGetMore[%u,%u]: %lu + %lu bytes for sequence number %lu\n",
+					pxWindow->usPeerPortNumber,
+					pxWindow->usOurPortNumber,
+					ulLength,
+					ulReturn,
+					pxWindow->ulOurSequenceNumber - pxWindow->tx.ulFirstSequenceNumber ) );
+				FreeRTOS_flush_logging( );
+			}
+		}
+
+		return ulReturn;
+	}
+
+#endif /* ( ipconfigUSE_TCP_WIN == 1 ) && ( ipconfigUSE_TCP_LARGE_SEND != 0 ) */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigUSE_TCP_WIN == 1 )
 
 	static uint32_t prvTCPWindowTxCheckAck( TCPWindow_t *pxWindow, uint32_t ulFirst, uint32_t ulLast )
 	{
 	uint32_t ulBytesConfirmed = 0u;
 	uint32_t ulSequenceNumber = ulFirst, ulDataLength;
+	#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+		uint32_t ulBytesAcked = 0u;
+	#endif
 	const ListItem_t *pxIterator;
 	const MiniListItem_t *pxEnd = ( const MiniListItem_t* )listGET_END_MARKER( &pxWindow->xTxSegments );
 	BaseType_t xDoUnlink;
@@ -1522,6 +1733,13 @@ const int32_t l500ms = 500;
 				/* This segment is fully ACK'd, set the flag. */
 				pxSegment->u.bits.bAcked = pdTRUE_UNSIGNED;
 
+				#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+				{
+					/* Count it only once, for the congestion control. */
+					ulBytesAcked += ulDataLength;
+				}
+				#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 				/* Calculate the RTT only if the segment was sent-out for the
 				first time and if this is the last ACK'd segment in a range. */
 				if( ( pxSegment->u.bits.ucTransmitCount == 1 ) && ( ( pxSegment->ulSequenceNumber + ulDataLength ) == ulLast ) )
@@ -1585,6 +1803,15 @@ const int32_t l500ms = 500;
 			ulSequenceNumber += ulDataLength;
 		}
 
+		#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+		{
+			if( ulBytesAcked != 0u )
+			{
+				prvTCPWindowCongestionOnAck( pxWindow, ulBytesAcked );
+			}
+		}
+		#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 		return ulBytesConfirmed;
 	}
 #endif /* ipconfigUSE_TCP_WIN == 1 */
@@ -1682,7 +1909,16 @@ const int32_t l500ms = 500;
 
 		/* Receive a SACK option. */
 		ulAckCount = prvTCPWindowTxCheckAck( pxWindow, ulFirst, ulLast );
-		prvTCPWindowFastRetransmit( pxWindow, ulFirst );
+
+		if( prvTCPWindowFastRetransmit( pxWindow, ulFirst ) != 0UL )
+		{
+			#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+			{
+				/* At least one segment got lost: enter fast recovery. */
+				prvTCPWindowCongestionOnLoss( pxWindow, pdFALSE );
+			}
+			#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+		}
 
 		if( ( xTCPWindowLoggingLevel >= 1 ) && ( xSequenceGreaterThan( ulFirst, ulCurrentSequenceNumber ) != pdFALSE ) )
 		{
@@ -1701,6 +1937,389 @@ const int32_t l500ms = 500;
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+
+	/* NewReno (RFC 5681 / RFC 6582): slow start and congestion avoidance,
+	halving the window when a loss is detected. */
+
+	static void prvNewRenoInit( TCPWindow_t *pxWindow )
+	{
+		/* Nothing to do beyond the generic initialisation. */
+		( void ) pxWindow;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvNewRenoOnAck( TCPWindow_t *pxWindow, uint32_t ulBytesAcked )
+	{
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+	uint32_t ulCWnd = pxWindow->xCongestion.ulCongestionWindow;
+
+		if( ulCWnd < pxWindow->xCongestion.ulSlowStartThreshold )
+		{
+			/* Slow start: grow with the number of bytes ACK'd, but at most one
+			MSS per ACK (appropriate byte counting with L = 1). */
+			ulCWnd += FreeRTOS_min_uint32( ulBytesAcked, ulMSS );
+		}
+		else
+		{
+			/* Congestion avoidance: grow with about one MSS per RTT. */
+			ulCWnd += FreeRTOS_max_uint32( ( ulMSS * ulBytesAcked ) / ulCWnd, 1u );
+		}
+
+		pxWindow->xCongestion.ulCongestionWindow = ulCWnd;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvNewRenoOnLoss( TCPWindow_t *pxWindow, BaseType_t xIsTimeout )
+	{
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+
+		pxWindow->xCongestion.ulSlowStartThreshold =
+			FreeRTOS_max_uint32( pxWindow->xCongestion.ulCongestionWindow / 2u, 2u * ulMSS );
+
+		if( xIsTimeout != pdFALSE )
+		{
+			/* After an RTO, start all over with a loss window of one segment. */
+			pxWindow->xCongestion.ulCongestionWindow = ulMSS;
+		}
+		else
+		{
+			pxWindow->xCongestion.ulCongestionWindow = pxWindow->xCongestion.ulSlowStartThreshold;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	/* CUBIC (RFC 8312): after a loss, the window follows the cubic function
+	W(t) = C * ( t - K )^3 + W_max, which makes the growth independent of the
+	RTT.  t and K are expressed in ms, the windows in bytes. */
+
+	static uint32_t prvCubeRoot( uint64_t ullValue )
+	{
+	uint32_t ulResult = 0u;
+	uint32_t ulBit, ulCandidate;
+
+		/* 2^21 cubed does not fit in 64 bits, so start with bit 20. */
+		for( ulBit = ( 1u << 20 ); ulBit != 0u; ulBit >>= 1 )
+		{
+			ulCandidate = ulResult | ulBit;
+
+			if( ( ( uint64_t ) ulCandidate ) * ulCandidate * ulCandidate <= ullValue )
+			{
+				ulResult = ulCandidate;
+			}
+		}
+
+		return ulResult;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCubicInit( TCPWindow_t *pxWindow )
+	{
+		pxWindow->xCongestion.ulWindowMax = 0u;
+		pxWindow->xCongestion.ulRenoWindow = 0u;
+		pxWindow->xCongestion.ulEpochK = 0u;
+		pxWindow->xCongestion.xEpochStart = ( TickType_t ) 0u;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCubicOnAck( TCPWindow_t *pxWindow, uint32_t ulBytesAcked )
+	{
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+	uint32_t ulCWnd = pxWindow->xCongestion.ulCongestionWindow;
+	uint32_t ulTarget;
+	uint64_t ullDistance;
+	int64_t llDelta, llTime;
+	TickType_t xNow;
+
+		if( ulCWnd < pxWindow->xCongestion.ulSlowStartThreshold )
+		{
+			/* Slow start is the same as in NewReno. */
+			prvNewRenoOnAck( pxWindow, ulBytesAcked );
+		}
+		else
+		{
+			xNow = xTaskGetTickCount();
+
+			if( pxWindow->xCongestion.xEpochStart == ( TickType_t ) 0u )
+			{
+				/* A new growth period starts.  Zero is used to indicate that
+				there is no epoch, so avoid that value. */
+				pxWindow->xCongestion.xEpochStart = ( xNow != ( TickType_t ) 0u ) ? xNow : ( TickType_t ) 1u;
+
+				if( ulCWnd < pxWindow->xCongestion.ulWindowMax )
+				{
+					/* K = cubic_root( ( W_max - cwnd ) / C ), with the window
+					expressed in segments and K in ms. */
+					ullDistance = ( ( uint64_t ) ( pxWindow->xCongestion.ulWindowMax - ulCWnd ) * 1000000000ull ) / ulMSS;
+					ullDistance = ( ullDistance / winCUBIC_C_NUMERATOR ) * winCUBIC_C_DENOMINATOR;
+					pxWindow->xCongestion.ulEpochK = prvCubeRoot( ullDistance );
+				}
+				else
+				{
+					pxWindow->xCongestion.ulEpochK = 0u;
+					pxWindow->xCongestion.ulWindowMax = ulCWnd;
+				}
+
+				pxWindow->xCongestion.ulRenoWindow = ulCWnd;
+			}
+
+			/* Look one RTT ahead, at the moment that this data will be ACK'd. */
+			llTime = ( int64_t ) ( ( xNow - pxWindow->xCongestion.xEpochStart ) * portTICK_PERIOD_MS );
+			llTime += ( int64_t ) pxWindow->lSRTT;
+			llTime -= ( int64_t ) pxWindow->xCongestion.ulEpochK;
+
+			if( llTime > winCUBIC_MAX_DISTANCE_MS )
+			{
+				llTime = winCUBIC_MAX_DISTANCE_MS;
+			}
+			else if( llTime < -winCUBIC_MAX_DISTANCE_MS )
+			{
+				llTime = -winCUBIC_MAX_DISTANCE_MS;
+			}
+
+			/* C * ( t - K )^3, converted from segments / seconds^3 to bytes / ms^3. */
+			llDelta = ( llTime * llTime * llTime * ( int64_t ) ulMSS * ( int64_t ) winCUBIC_C_NUMERATOR ) /
+				( ( int64_t ) winCUBIC_C_DENOMINATOR * 1000000000ll );
+			llDelta += ( int64_t ) pxWindow->xCongestion.ulWindowMax;
+
+			/* Never grow by more than 50% per RTT. */
+			if( llDelta > ( int64_t ) ( ulCWnd + ( ulCWnd / 2u ) ) )
+			{
+				llDelta = ( int64_t ) ( ulCWnd + ( ulCWnd / 2u ) );
+			}
+			else if( llDelta < ( int64_t ) ulCWnd )
+			{
+				llDelta = ( int64_t ) ulCWnd;
+			}
+
+			ulTarget = ( uint32_t ) llDelta;
+
+			if( ulTarget > ulCWnd )
+			{
+				/* Approach the target within one RTT. */
+				ulCWnd += FreeRTOS_max_uint32( ( uint32_t ) ( ( ( uint64_t ) ( ulTarget - ulCWnd ) * ulBytesAcked ) / ulCWnd ), 1u );
+			}
+			else
+			{
+				/* Around W_max the window hardly grows. */
+				ulCWnd += FreeRTOS_max_uint32( ( ulMSS * ulBytesAcked ) / ( 100u * ulCWnd ), 1u );
+			}
+
+			/* TCP-friendly region: never be slower than NewReno would be.  With
+			beta = 0.7, the Reno window grows by 3 * ( 1 - beta ) / ( 1 + beta )
+			= 9 / 17 MSS per RTT. */
+			pxWindow->xCongestion.ulRenoWindow += FreeRTOS_max_uint32(
+				( 9u * ulMSS * ulBytesAcked ) / ( 17u * FreeRTOS_max_uint32( pxWindow->xCongestion.ulRenoWindow, ulMSS ) ), 1u );
+
+			if( pxWindow->xCongestion.ulRenoWindow > ulCWnd )
+			{
+				ulCWnd = pxWindow->xCongestion.ulRenoWindow;
+			}
+
+			pxWindow->xCongestion.ulCongestionWindow = ulCWnd;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCubicOnLoss( TCPWindow_t *pxWindow, BaseType_t xIsTimeout )
+	{
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+	uint32_t ulCWnd = pxWindow->xCongestion.ulCongestionWindow;
+
+		pxWindow->xCongestion.xEpochStart = ( TickType_t ) 0u;
+
+		if( ulCWnd < pxWindow->xCongestion.ulWindowMax )
+		{
+			/* Fast convergence: the window is shrinking, give up some bandwidth
+			for newer flows by lowering W_max to cwnd * ( 1 + beta ) / 2. */
+			pxWindow->xCongestion.ulWindowMax = ( uint32_t ) ( ( ( uint64_t ) ulCWnd *
+				( winCUBIC_BETA_DENOMINATOR + winCUBIC_BETA_NUMERATOR ) ) / ( 2u * winCUBIC_BETA_DENOMINATOR ) );
+		}
+		else
+		{
+			pxWindow->xCongestion.ulWindowMax = ulCWnd;
+		}
+
+		pxWindow->xCongestion.ulSlowStartThreshold = FreeRTOS_max_uint32(
+			( uint32_t ) ( ( ( uint64_t ) ulCWnd * winCUBIC_BETA_NUMERATOR ) / winCUBIC_BETA_DENOMINATOR ), 2u * ulMSS );
+
+		if( xIsTimeout != pdFALSE )
+		{
+			pxWindow->xCongestion.ulCongestionWindow = ulMSS;
+		}
+		else
+		{
+			pxWindow->xCongestion.ulCongestionWindow = pxWindow->xCongestion.ulSlowStartThreshold;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	/* The table is indexed with the FREERTOS_TCP_CC_xxx values. */
+	static const TCPCongestionOps_t xCongestionOps[] =
+	{
+		{ prvNewRenoInit, prvNewRenoOnAck, prvNewRenoOnLoss },	/* FREERTOS_TCP_CC_NEWRENO */
+		{ prvCubicInit, prvCubicOnAck, prvCubicOnLoss },		/* FREERTOS_TCP_CC_CUBIC */
+	};
+	/*-----------------------------------------------------------*/
+
+	BaseType_t xTCPWindowSetCongestionControl( TCPWindow_t *pxWindow, BaseType_t xAlgorithm )
+	{
+	BaseType_t xReturn;
+
+		if( ( xAlgorithm < 0 ) || ( xAlgorithm >= ( BaseType_t ) ( sizeof( xCongestionOps ) / sizeof( xCongestionOps[ 0 ] ) ) ) )
+		{
+			xReturn = pdFAIL;
+		}
+		else
+		{
+			pxWindow->xCongestion.ucAlgorithm = ( uint8_t ) xAlgorithm;
+
+			/* The new algorithm starts from the current cwnd and ssthresh. */
+			xCongestionOps[ xAlgorithm ].pxInit( pxWindow );
+			xReturn = pdPASS;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPWindowCongestionInit( TCPWindow_t *pxWindow )
+	{
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+
+		if( ulMSS == 0u )
+		{
+			ulMSS = ( uint32_t ) ipconfigTCP_MSS;
+		}
+
+		/* The initial window of RFC 3390: min( 4 * MSS, max( 2 * MSS, 4380 ) ). */
+		pxWindow->xCongestion.ulCongestionWindow = FreeRTOS_min_uint32( 4u * ulMSS, FreeRTOS_max_uint32( 2u * ulMSS, 4380u ) );
+		/* ssthresh starts as high as possible. */
+		pxWindow->xCongestion.ulSlowStartThreshold = FreeRTOS_max_uint32( pxWindow->xSize.ulTxWindowLength, 2u * ulMSS );
+		pxWindow->xCongestion.ucInRecovery = pdFALSE_UNSIGNED;
+		pxWindow->xCongestion.ulRecoverSequenceNumber = pxWindow->tx.ulCurrentSequenceNumber;
+
+		/* The initial window may be sent at once. */
+		pxWindow->xCongestion.ulPacingCredit = pxWindow->xCongestion.ulCongestionWindow;
+		vTCPTimerSet( &( pxWindow->xCongestion.xPacingTimer ) );
+
+		if( ( ( size_t ) pxWindow->xCongestion.ucAlgorithm ) >= ( sizeof( xCongestionOps ) / sizeof( xCongestionOps[ 0 ] ) ) )
+		{
+			pxWindow->xCongestion.ucAlgorithm = ( uint8_t ) FREERTOS_TCP_CC_NEWRENO;
+		}
+
+		xCongestionOps[ pxWindow->xCongestion.ucAlgorithm ].pxInit( pxWindow );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPWindowCongestionOnAck( TCPWindow_t *pxWindow, uint32_t ulBytesAcked )
+	{
+		if( pxWindow->xCongestion.ucInRecovery != pdFALSE_UNSIGNED )
+		{
+			/* The window does not grow during fast recovery.  Recovery ends
+			when all data that was outstanding at the moment of the loss has
+			been ACK'd. */
+			if( xSequenceGreaterThanOrEqual( pxWindow->tx.ulCurrentSequenceNumber, pxWindow->xCongestion.ulRecoverSequenceNumber ) != pdFALSE )
+			{
+				pxWindow->xCongestion.ucInRecovery = pdFALSE_UNSIGNED;
+				pxWindow->xCongestion.ulCongestionWindow = FreeRTOS_max_uint32( pxWindow->xCongestion.ulSlowStartThreshold,
+					( uint32_t ) pxWindow->usMSS );
+			}
+		}
+		else
+		{
+			xCongestionOps[ pxWindow->xCongestion.ucAlgorithm ].pxOnAck( pxWindow, ulBytesAcked );
+		}
+
+		/* Growing beyond the self-imposed transmission window has no use. */
+		pxWindow->xCongestion.ulCongestionWindow = FreeRTOS_min_uint32( pxWindow->xCongestion.ulCongestionWindow,
+			FreeRTOS_max_uint32( pxWindow->xSize.ulTxWindowLength, 2u * ( uint32_t ) pxWindow->usMSS ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPWindowCongestionOnLoss( TCPWindow_t *pxWindow, BaseType_t xIsTimeout )
+	{
+		if( ( xIsTimeout == pdFALSE ) && ( pxWindow->xCongestion.ucInRecovery != pdFALSE_UNSIGNED ) )
+		{
+			/* Already recovering from a loss in the same window of data: NewReno
+			reduces the window only once per window. */
+		}
+		else
+		{
+			xCongestionOps[ pxWindow->xCongestion.ucAlgorithm ].pxOnLoss( pxWindow, xIsTimeout );
+
+			if( xIsTimeout != pdFALSE )
+			{
+				/* After a time-out, the window restarts with slow start. */
+				pxWindow->xCongestion.ucInRecovery = pdFALSE_UNSIGNED;
+			}
+			else
+			{
+				pxWindow->xCongestion.ucInRecovery = pdTRUE_UNSIGNED;
+				pxWindow->xCongestion.ulRecoverSequenceNumber = pxWindow->tx.ulHighestSequenceNumber;
+			}
+
+			if( ( xTCPWindowLoggingLevel != 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != pdFALSE ) )
+			{
+				FreeRTOS_debug_printf( ( "CongestionOnLoss[%u]: %s cwnd %lu ssthresh %lu\n",
+					pxWindow->usOurPortNumber,
+					( xIsTimeout != pdFALSE ) ? "RTO" : "fast",
+					pxWindow->xCongestion.ulCongestionWindow,
+					pxWindow->xCongestion.ulSlowStartThreshold ) );
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvTCPWindowPacingWait( TCPWindow_t *pxWindow, uint32_t ulLength, TickType_t *pulDelay )
+	{
+	uint32_t ulRate, ulBurst, ulAge, ulCredit;
+	BaseType_t xMustWait = pdFALSE;
+
+		if( pxWindow->xCongestion.ucPacing != 0u )
+		{
+			/* The pacing rate in bytes per ms: 1.25 * cwnd / SRTT. */
+			ulRate = ( pxWindow->xCongestion.ulCongestionWindow * winPACING_GAIN_NUMERATOR ) /
+				( winPACING_GAIN_DENOMINATOR * FreeRTOS_max_uint32( ( uint32_t ) pxWindow->lSRTT, 1u ) );
+			ulRate = FreeRTOS_max_uint32( ulRate, 1u );
+
+			/* The IP-task can not wake up more often than once per tick, so
+			allow bursts of at least two ticks worth of data. */
+			ulBurst = FreeRTOS_max_uint32( 2u * ( uint32_t ) pxWindow->usMSS, 2u * ulRate * portTICK_PERIOD_MS );
+
+			/* Add the credit earned since the last refill. */
+			ulAge = ulTimerGetAge( &( pxWindow->xCongestion.xPacingTimer ) );
+
+			if( ulAge != 0u )
+			{
+				ulCredit = pxWindow->xCongestion.ulPacingCredit;
+
+				if( ulAge >= ( ulBurst / ulRate ) )
+				{
+					ulCredit = ulBurst;
+				}
+				else
+				{
+					ulCredit = FreeRTOS_min_uint32( ulCredit + ulAge * ulRate, ulBurst );
+				}
+
+				pxWindow->xCongestion.ulPacingCredit = ulCredit;
+				vTCPTimerSet( &( pxWindow->xCongestion.xPacingTimer ) );
+			}
+
+			if( pxWindow->xCongestion.ulPacingCredit < ulLength )
+			{
+				xMustWait = pdTRUE;
+				*pulDelay = FreeRTOS_max_uint32( ( ulLength - pxWindow->xCongestion.ulPacingCredit + ulRate - 1u ) / ulRate, 1u );
+			}
+		}
+
+		return xMustWait;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 /*
 #####   #                      #####   ####  ######
 # # #   #                      # # #  #    #  #    #
@@ -254,6 +254,17 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 		handling them, no use to fill the ARP cache with those IP addresses. */
 		vARPRefreshCacheEntry( &( pxUDPPacket->xEthernetHeader.xSourceAddress ), pxUDPPacket->xIPHeader.ulSourceIPAddress );
 
+		#if( ipconfigDNS_USE_CALLBACKS != 0 )
+		{
+			/* Replies to asynchronous DNS requests are handled right here, the
+			packet will be released by the caller. */
+			if( xIsDNSSocket( ( Socket_t ) pxSocket ) != pdFALSE )
+			{
+				xReturn = ( BaseType_t ) ulDNSHandlePacket( pxNetworkBuffer );
+			}
+		}
+		#endif /* ipconfigDNS_USE_CALLBACKS */
+
 		#if( ipconfigUSE_CALLBACKS == 1 )
 		{
 			/* Did the owner of this socket register a reception handler ? */
@@ -281,6 +281,13 @@ UBaseType_t uxCount;
 				}
 				#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
 
+				#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+				{
+					/* A normal packet, which can be sent as it is. */
+					pxReturn->usLargeSendMSS = 0u;
+				}
+				#endif /* ipconfigUSE_TCP_LARGE_SEND */
+
 				if( xTCPWindowLoggingLevel > 3 )
 				{
 					FreeRTOS_debug_printf( ( "BUF_GET[%ld]: %p (%p)\n",
@@ -279,6 +279,13 @@ size_t uxCount;
 					pxReturn->pxNextBuffer = NULL;
 				}
 				#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
+				#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+				{
+					/* A normal packet, which can be sent as it is. */
+					pxReturn->usLargeSendMSS = 0u;
+				}
+				#endif /* ipconfigUSE_TCP_LARGE_SEND */
 			}
 		}
 		else
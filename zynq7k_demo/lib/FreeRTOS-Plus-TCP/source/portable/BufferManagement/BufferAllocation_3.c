@@ -0,0 +1,730 @@
+/*
+ * FreeRTOS+TCP V2.0.8
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/******************************************************************************
+ *
+ * See the following web page for essential buffer allocation scheme usage and
+ * configuration details:
+ * http://www.FreeRTOS.org/FreeRTOS-Plus/FreeRTOS_Plus_TCP/Embedded_Ethernet_Buffer_Management.html
+ *
+ ******************************************************************************/
+
+/* BufferAllocation_3.c combines properties of the other two schemes: network
+buffers have a variable size, as in BufferAllocation_2.c, but the storage is
+statically allocated, as in BufferAllocation_1.c.  The storage is divided into
+three size classes (see ipconfigBUFFER_ALLOC_SMALL_SIZE and friends), so a TCP
+acknowledgement doesn't occupy a full-size frame.
+
+The descriptors and each size class are kept in lock-free stacks.  Neither a
+semaphore nor a critical section is used, so the functions are cheap and may be
+called from tasks and from interrupts alike.  A task that asks for a buffer
+with a block time will poll the pools once every clock tick. */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkInterface.h"
+#include "NetworkBufferManagement.h"
+
+/* The obtained network buffer must be large enough to hold a packet that might
+replace the packet that was requested to be sent. */
+#if ipconfigUSE_TCP == 1
+	#define baMINIMAL_BUFFER_SIZE		sizeof( TCPPacket_t )
+#else
+	#define baMINIMAL_BUFFER_SIZE		sizeof( ARPPacket_t )
+#endif /* ipconfigUSE_TCP == 1 */
+
+#if( ipconfigBUFFER_ALLOC_SMALL_SIZE < 64 )
+	#error ipconfigBUFFER_ALLOC_SMALL_SIZE is too small to hold an ARP or a TCP packet
+#endif
+
+#if( ipconfigUSE_TCP_LARGE_SEND != 0 )
+	#error ipconfigUSE_TCP_LARGE_SEND needs buffers bigger than a frame, use BufferAllocation_2.c
+#endif
+
+/* For an Ethernet interrupt to be able to obtain a network buffer there must
+be at least this number of descriptors available. */
+#define baINTERRUPT_BUFFER_GET_THRESHOLD	( 3 )
+
+/* The slots of each class start at a multiple of the cache line size, so that
+invalidating the cache for one DMA buffer can not touch its neighbours. */
+#define baSLOT_ALIGNMENT					( 32u )
+#define baSLOT_SIZE( xSize )				( ( ( ( size_t ) ( xSize ) + ipBUFFER_PADDING ) + ( baSLOT_ALIGNMENT - 1u ) ) & ~( baSLOT_ALIGNMENT - 1u ) )
+
+/* The head of a stack holds the index of the top-most free slot in its lower
+16 bits.  The upper 16 bits are incremented at every change, so that a stale
+head will never be mistaken for the current one (the ABA problem). */
+#define baNO_SLOT							( 0xffffu )
+#define baINDEX_MASK						( 0x0000ffffUL )
+#define baTAG_INCREMENT						( 0x00010000UL )
+
+#define baNUMBER_OF_POOLS					( 3 )
+
+/* A size class, or the set of descriptors. */
+typedef struct xBUFFER_POOL
+{
+	volatile uint32_t ulHead;		/* Tag and index of the first free slot. */
+	uint16_t *pusNext;				/* For each free slot, the index of the next free slot. */
+	uint8_t *pucStorage;			/* The first slot, NULL for the descriptors. */
+	size_t uxSlotSize;				/* Distance between two slots. */
+	size_t uxBufferSize;			/* Usable size of a slot. */
+	UBaseType_t uxCount;			/* Number of slots. */
+	volatile uint32_t ulFree;		/* Number of free slots. */
+	UBaseType_t uxMinimumFree;		/* Lowest value of 'ulFree' since boot. */
+	volatile uint32_t ulObtained;	/* Number of slots handed out. */
+	volatile uint32_t ulFailed;		/* Number of times the pool was found empty. */
+} BufferPool_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Lock-free helpers.  When not compiling with GCC, the compare-and-swap is
+ * emulated by masking interrupts.
+ */
+static BaseType_t prvCompareAndSwap( volatile uint32_t *pulTarget, uint32_t *pulExpected, uint32_t ulNew );
+static void prvAtomicAdd( volatile uint32_t *pulTarget, uint32_t ulValue );
+static void prvPoolInit( BufferPool_t *pxPool, uint16_t *pusNext, uint8_t *pucStorage, size_t uxBufferSize, UBaseType_t uxCount );
+static uint16_t prvPoolPop( BufferPool_t *pxPool );
+static void prvPoolPush( BufferPool_t *pxPool, uint16_t usIndex );
+
+/*
+ * Find a slot in the smallest pool that can hold 'xSize' bytes, or in a bigger
+ * one.  Returns a pointer to the start of the slot, or NULL.
+ */
+static uint8_t *prvStorageGet( size_t xSize );
+
+/*
+ * Return a slot obtained from prvStorageGet(), 'pucSlot' points to its start.
+ */
+static void prvStorageRelease( uint8_t *pucSlot );
+
+/*
+ * Returns the usable size of the slot that starts at 'pucSlot'.
+ */
+static size_t prvStorageSize( const uint8_t *pucSlot );
+
+/*
+ * Common part of the task and interrupt versions of the get functions.
+ */
+static NetworkBufferDescriptor_t *prvGetNetworkBuffer( size_t xRequestedSizeBytes );
+
+/*-----------------------------------------------------------*/
+
+/* Declares the pool of NetworkBufferDescriptor_t structures that are available
+to the system. */
+static NetworkBufferDescriptor_t xNetworkBufferDescriptors[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+static uint16_t usDescriptorNext[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+
+/* Set while a descriptor is handed out, to detect a double release.  The flag
+is tested and cleared in one compare-and-swap, so that of two releases racing
+each other only one pushes the descriptor. */
+static volatile uint32_t ulDescriptorInUse[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+
+static BufferPool_t xDescriptorPool;
+
+/* The storage of the three size classes.  The arrays are declared with some
+slack so the first slot can be aligned to baSLOT_ALIGNMENT. */
+static uint32_t ulSmallStorage[ ( ( baSLOT_SIZE( ipconfigBUFFER_ALLOC_SMALL_SIZE ) * ipconfigBUFFER_ALLOC_SMALL_COUNT ) + baSLOT_ALIGNMENT ) / sizeof( uint32_t ) ];
+static uint32_t ulMediumStorage[ ( ( baSLOT_SIZE( ipconfigBUFFER_ALLOC_MEDIUM_SIZE ) * ipconfigBUFFER_ALLOC_MEDIUM_COUNT ) + baSLOT_ALIGNMENT ) / sizeof( uint32_t ) ];
+static uint32_t ulLargeStorage[ ( ( baSLOT_SIZE( ipconfigBUFFER_ALLOC_LARGE_SIZE ) * ipconfigBUFFER_ALLOC_LARGE_COUNT ) + baSLOT_ALIGNMENT ) / sizeof( uint32_t ) ];
+static uint16_t usSmallNext[ ipconfigBUFFER_ALLOC_SMALL_COUNT + 1 ];
+static uint16_t usMediumNext[ ipconfigBUFFER_ALLOC_MEDIUM_COUNT + 1 ];
+static uint16_t usLargeNext[ ipconfigBUFFER_ALLOC_LARGE_COUNT + 1 ];
+
+static BufferPool_t xStoragePools[ baNUMBER_OF_POOLS ];
+
+/* This constant is defined as false to let FreeRTOS_TCP_IP.c know that the
+network buffers have a variable size: resizing may be necessary */
+const BaseType_t xBufferAllocFixedSize = pdFALSE;
+
+/* Becomes true once the pools have been filled. */
+static BaseType_t xBuffersInitialised = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCompareAndSwap( volatile uint32_t *pulTarget, uint32_t *pulExpected, uint32_t ulNew )
+{
+BaseType_t xReturn;
+
+	#if defined( __GNUC__ )
+	{
+		xReturn = ( BaseType_t ) __atomic_compare_exchange_n( pulTarget, pulExpected, ulNew, pdFALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE );
+	}
+	#else
+	{
+	UBaseType_t uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR();
+
+		if( *pulTarget == *pulExpected )
+		{
+			*pulTarget = ulNew;
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			*pulExpected = *pulTarget;
+			xReturn = pdFALSE;
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	}
+	#endif
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAtomicAdd( volatile uint32_t *pulTarget, uint32_t ulValue )
+{
+uint32_t ulOld = *pulTarget;
+
+	while( prvCompareAndSwap( pulTarget, &ulOld, ulOld + ulValue ) == pdFALSE )
+	{
+		/* 'ulOld' has been refreshed, try again. */
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvPoolInit( BufferPool_t *pxPool, uint16_t *pusNext, uint8_t *pucStorage, size_t uxBufferSize, UBaseType_t uxCount )
+{
+UBaseType_t uxIndex;
+
+	configASSERT( uxCount < ( UBaseType_t ) baNO_SLOT );
+
+	memset( pxPool, '\0', sizeof( *pxPool ) );
+	pxPool->pusNext = pusNext;
+	pxPool->uxBufferSize = uxBufferSize;
+	pxPool->uxSlotSize = baSLOT_SIZE( uxBufferSize );
+	pxPool->uxCount = uxCount;
+	pxPool->ulFree = ( uint32_t ) uxCount;
+	pxPool->uxMinimumFree = uxCount;
+
+	if( pucStorage != NULL )
+	{
+		/* Round up the start of the storage to baSLOT_ALIGNMENT. */
+		pucStorage += ( baSLOT_ALIGNMENT - ( ( ( size_t ) pucStorage ) & ( baSLOT_ALIGNMENT - 1u ) ) ) & ( baSLOT_ALIGNMENT - 1u );
+		pxPool->pucStorage = pucStorage;
+	}
+
+	/* Chain all slots, slot 0 at the top. */
+	for( uxIndex = 0u; uxIndex < uxCount; uxIndex++ )
+	{
+		pusNext[ uxIndex ] = ( uint16_t ) ( uxIndex + 1u );
+	}
+
+	if( uxCount == 0u )
+	{
+		pxPool->ulHead = baNO_SLOT;
+	}
+	else
+	{
+		pusNext[ uxCount - 1u ] = baNO_SLOT;
+		pxPool->ulHead = 0u;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t prvPoolPop( BufferPool_t *pxPool )
+{
+uint32_t ulOld = pxPool->ulHead;
+uint32_t ulNew;
+uint16_t usIndex;
+UBaseType_t uxFree;
+
+	for( ;; )
+	{
+		usIndex = ( uint16_t ) ( ulOld & baINDEX_MASK );
+
+		if( usIndex == baNO_SLOT )
+		{
+			prvAtomicAdd( &( pxPool->ulFailed ), 1u );
+			break;
+		}
+
+		/* 'pusNext[ usIndex ]' may be outdated if another task or interrupt
+		took the slot in the mean time, but then the tag has changed and the
+		swap will fail. */
+		ulNew = ( ( ulOld + baTAG_INCREMENT ) & ~baINDEX_MASK ) | pxPool->pusNext[ usIndex ];
+
+		if( prvCompareAndSwap( &( pxPool->ulHead ), &ulOld, ulNew ) != pdFALSE )
+		{
+			prvAtomicAdd( &( pxPool->ulFree ), ( uint32_t ) -1 );
+			prvAtomicAdd( &( pxPool->ulObtained ), 1u );
+
+			/* For stats, latch the lowest number of free slots since booting.
+			A race here can only make the figure slightly inaccurate. */
+			uxFree = ( UBaseType_t ) pxPool->ulFree;
+			if( pxPool->uxMinimumFree > uxFree )
+			{
+				pxPool->uxMinimumFree = uxFree;
+			}
+			break;
+		}
+	}
+
+	return usIndex;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPoolPush( BufferPool_t *pxPool, uint16_t usIndex )
+{
+uint32_t ulOld = pxPool->ulHead;
+uint32_t ulNew;
+
+	configASSERT( ( UBaseType_t ) usIndex < pxPool->uxCount );
+
+	do
+	{
+		pxPool->pusNext[ usIndex ] = ( uint16_t ) ( ulOld & baINDEX_MASK );
+		ulNew = ( ( ulOld + baTAG_INCREMENT ) & ~baINDEX_MASK ) | usIndex;
+	} while( prvCompareAndSwap( &( pxPool->ulHead ), &ulOld, ulNew ) == pdFALSE );
+
+	prvAtomicAdd( &( pxPool->ulFree ), 1u );
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t *prvStorageGet( size_t xSize )
+{
+uint8_t *pucReturn = NULL;
+BufferPool_t *pxPool;
+BaseType_t xPool;
+uint16_t usIndex;
+
+	for( xPool = 0; xPool < baNUMBER_OF_POOLS; xPool++ )
+	{
+		pxPool = &( xStoragePools[ xPool ] );
+
+		if( ( xSize <= pxPool->uxBufferSize ) && ( pxPool->uxCount != 0u ) )
+		{
+			usIndex = prvPoolPop( pxPool );
+
+			if( usIndex != baNO_SLOT )
+			{
+				pucReturn = pxPool->pucStorage + ( ( size_t ) usIndex * pxPool->uxSlotSize );
+				break;
+			}
+			/* This class has run out, try the next bigger one. */
+		}
+	}
+
+	return pucReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BufferPool_t *prvStoragePool( const uint8_t *pucSlot )
+{
+BufferPool_t *pxReturn = NULL;
+BaseType_t xPool;
+
+	for( xPool = 0; xPool < baNUMBER_OF_POOLS; xPool++ )
+	{
+		if( ( pucSlot >= xStoragePools[ xPool ].pucStorage ) &&
+			( pucSlot < xStoragePools[ xPool ].pucStorage + ( xStoragePools[ xPool ].uxCount * xStoragePools[ xPool ].uxSlotSize ) ) )
+		{
+			pxReturn = &( xStoragePools[ xPool ] );
+			break;
+		}
+	}
+
+	/* The slot must belong to one of the pools. */
+	configASSERT( pxReturn != NULL );
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStorageRelease( uint8_t *pucSlot )
+{
+BufferPool_t *pxPool = prvStoragePool( pucSlot );
+
+	if( pxPool != NULL )
+	{
+		prvPoolPush( pxPool, ( uint16_t ) ( ( size_t ) ( pucSlot - pxPool->pucStorage ) / pxPool->uxSlotSize ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvStorageSize( const uint8_t *pucSlot )
+{
+BufferPool_t *pxPool = prvStoragePool( pucSlot );
+size_t uxReturn = 0u;
+
+	if( pxPool != NULL )
+	{
+		uxReturn = pxPool->uxBufferSize;
+	}
+
+	return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkBuffersInitialise( void )
+{
+BaseType_t x;
+
+	/* Only initialise the buffers if they have not been initialised before. */
+	if( xBuffersInitialised == pdFALSE )
+	{
+		/* The size classes must be given in increasing order, and the biggest
+		one must be able to hold a complete frame. */
+		configASSERT( ( ipconfigBUFFER_ALLOC_SMALL_SIZE <= ipconfigBUFFER_ALLOC_MEDIUM_SIZE ) &&
+					  ( ipconfigBUFFER_ALLOC_MEDIUM_SIZE <= ipconfigBUFFER_ALLOC_LARGE_SIZE ) &&
+					  ( ipconfigBUFFER_ALLOC_LARGE_SIZE >= ipTOTAL_ETHERNET_FRAME_SIZE ) );
+
+		prvPoolInit( &xDescriptorPool, usDescriptorNext, NULL, 0u, ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS );
+		prvPoolInit( &( xStoragePools[ 0 ] ), usSmallNext, ( uint8_t * ) ulSmallStorage, ipconfigBUFFER_ALLOC_SMALL_SIZE, ipconfigBUFFER_ALLOC_SMALL_COUNT );
+		prvPoolInit( &( xStoragePools[ 1 ] ), usMediumNext, ( uint8_t * ) ulMediumStorage, ipconfigBUFFER_ALLOC_MEDIUM_SIZE, ipconfigBUFFER_ALLOC_MEDIUM_COUNT );
+		prvPoolInit( &( xStoragePools[ 2 ] ), usLargeNext, ( uint8_t * ) ulLargeStorage, ipconfigBUFFER_ALLOC_LARGE_SIZE, ipconfigBUFFER_ALLOC_LARGE_COUNT );
+
+		/* Initialise all the network buffers.  No storage is assigned to the
+		buffers yet. */
+		for( x = 0; x < ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS; x++ )
+		{
+			/* Initialise and set the owner of the buffer list items, they are
+			used by the stack to queue network buffers. */
+			xNetworkBufferDescriptors[ x ].pucEthernetBuffer = NULL;
+			vListInitialiseItem( &( xNetworkBufferDescriptors[ x ].xBufferListItem ) );
+			listSET_LIST_ITEM_OWNER( &( xNetworkBufferDescriptors[ x ].xBufferListItem ), &xNetworkBufferDescriptors[ x ] );
+			ulDescriptorInUse[ x ] = pdFALSE;
+		}
+
+		xBuffersInitialised = pdTRUE;
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+uint8_t *pucGetNetworkBuffer( size_t *pxRequestedSizeBytes )
+{
+uint8_t *pucEthernetBuffer;
+size_t xSize = *pxRequestedSizeBytes;
+
+	if( xSize < baMINIMAL_BUFFER_SIZE )
+	{
+		/* Buffers must be at least large enough to hold a TCP-packet with
+		headers, or an ARP packet, in case TCP is not included. */
+		xSize = baMINIMAL_BUFFER_SIZE;
+	}
+
+	/* Round up xSize to the nearest multiple of N bytes,
+	where N equals 'sizeof( size_t )'. */
+	if( ( xSize & ( sizeof( size_t ) - 1u ) ) != 0u )
+	{
+		xSize = ( xSize | ( sizeof( size_t ) - 1u ) ) + 1u;
+	}
+	*pxRequestedSizeBytes = xSize;
+
+	/* As in BufferAllocation_2.c, space is reserved in front of the Ethernet
+	buffer for a pointer to a network buffer structure. */
+	pucEthernetBuffer = prvStorageGet( xSize );
+
+	if( pucEthernetBuffer != NULL )
+	{
+		pucEthernetBuffer += ipBUFFER_PADDING;
+	}
+
+	return pucEthernetBuffer;
+}
+/*-----------------------------------------------------------*/
+
+void vReleaseNetworkBuffer( uint8_t *pucEthernetBuffer )
+{
+	if( pucEthernetBuffer != NULL )
+	{
+		prvStorageRelease( pucEthernetBuffer - ipBUFFER_PADDING );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static NetworkBufferDescriptor_t *prvGetNetworkBuffer( size_t xRequestedSizeBytes )
+{
+NetworkBufferDescriptor_t *pxReturn = NULL;
+uint8_t *pucSlot;
+uint16_t usIndex;
+
+	usIndex = prvPoolPop( &xDescriptorPool );
+
+	if( usIndex != baNO_SLOT )
+	{
+		pxReturn = &( xNetworkBufferDescriptors[ usIndex ] );
+		ulDescriptorInUse[ usIndex ] = pdTRUE;
+
+		if( xRequestedSizeBytes > 0u )
+		{
+			pucSlot = prvStorageGet( xRequestedSizeBytes );
+
+			if( pucSlot == NULL )
+			{
+				/* The storage of all suitable classes is in use, so the
+				descriptor can not be used either. */
+				ulDescriptorInUse[ usIndex ] = pdFALSE;
+				prvPoolPush( &xDescriptorPool, usIndex );
+				pxReturn = NULL;
+			}
+			else
+			{
+				/* Store a pointer to the network buffer structure in the
+				buffer storage area, then move the buffer pointer on past the
+				stored pointer so the pointer value is not overwritten by the
+				application when the buffer is used. */
+				*( ( NetworkBufferDescriptor_t ** ) pucSlot ) = pxReturn;
+				pxReturn->pucEthernetBuffer = pucSlot + ipBUFFER_PADDING;
+			}
+		}
+		else
+		{
+			/* A descriptor is being returned without an associated buffer. */
+			pxReturn->pucEthernetBuffer = NULL;
+		}
+
+		if( pxReturn != NULL )
+		{
+			pxReturn->xDataLength = xRequestedSizeBytes;
+
+			#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+			{
+				/* make sure the buffer is not linked */
+				pxReturn->pxNextBuffer = NULL;
+			}
+			#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+		}
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t *pxGetNetworkBufferWithDescriptor( size_t xRequestedSizeBytes, TickType_t xBlockTimeTicks )
+{
+NetworkBufferDescriptor_t *pxReturn;
+TimeOut_t xTimeOut;
+
+	if( ( xRequestedSizeBytes != 0u ) && ( xRequestedSizeBytes < ( size_t ) baMINIMAL_BUFFER_SIZE ) )
+	{
+		/* ARP packets can replace application packets, so the storage must be
+		at least large enough to hold an ARP. */
+		xRequestedSizeBytes = baMINIMAL_BUFFER_SIZE;
+	}
+
+	/* Add 2 bytes to xRequestedSizeBytes and round up xRequestedSizeBytes
+	to the nearest multiple of N bytes, where N equals 'sizeof( size_t )'. */
+	if( xRequestedSizeBytes != 0u )
+	{
+		xRequestedSizeBytes += 2u;
+		if( ( xRequestedSizeBytes & ( sizeof( size_t ) - 1u ) ) != 0u )
+		{
+			xRequestedSizeBytes = ( xRequestedSizeBytes | ( sizeof( size_t ) - 1u ) ) + 1u;
+		}
+	}
+
+	pxReturn = prvGetNetworkBuffer( xRequestedSizeBytes );
+
+	if( ( pxReturn == NULL ) && ( xBlockTimeTicks != ( TickType_t ) 0u ) && ( xRequestedSizeBytes <= ( size_t ) ipconfigBUFFER_ALLOC_LARGE_SIZE ) )
+	{
+		/* There is no semaphore to wait for, so poll until a buffer gets
+		released or until the block time has passed. */
+		vTaskSetTimeOutState( &xTimeOut );
+
+		while( xTaskCheckForTimeOut( &xTimeOut, &xBlockTimeTicks ) == pdFALSE )
+		{
+			vTaskDelay( 1u );
+			pxReturn = prvGetNetworkBuffer( xRequestedSizeBytes );
+
+			if( pxReturn != NULL )
+			{
+				break;
+			}
+		}
+	}
+
+	if( pxReturn == NULL )
+	{
+		iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER();
+	}
+	else
+	{
+		iptraceNETWORK_BUFFER_OBTAINED( pxReturn );
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t *pxNetworkBufferGetFromISR( size_t xRequestedSizeBytes )
+{
+NetworkBufferDescriptor_t *pxReturn = NULL;
+
+	/* Only take a buffer if there are at least baINTERRUPT_BUFFER_GET_THRESHOLD
+	descriptors remaining.  This prevents, to a certain degree at least, a
+	rapidly executing interrupt exhausting buffers and in so doing preventing
+	tasks from continuing.  The size is not rounded up, the caller knows what it
+	needs. */
+	if( xDescriptorPool.ulFree > ( uint32_t ) baINTERRUPT_BUFFER_GET_THRESHOLD )
+	{
+		pxReturn = prvGetNetworkBuffer( xRequestedSizeBytes );
+	}
+
+	if( pxReturn == NULL )
+	{
+		iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER_FROM_ISR();
+	}
+	else
+	{
+		iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR( pxReturn );
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t vNetworkBufferReleaseFromISR( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+{
+	/* The release doesn't use any kernel object, so it is the same as for a
+	task.  No task can have been woken up. */
+	vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vReleaseNetworkBufferAndDescriptor( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+{
+uint16_t usIndex = ( uint16_t ) ( pxNetworkBuffer - xNetworkBufferDescriptors );
+uint32_t ulInUse = pdTRUE;
+
+	configASSERT( ( usIndex < ( uint16_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ) &&
+				  ( pxNetworkBuffer == &( xNetworkBufferDescriptors[ usIndex ] ) ) );
+
+	if( prvCompareAndSwap( &( ulDescriptorInUse[ usIndex ] ), &ulInUse, pdFALSE ) == pdFALSE )
+	{
+		/* Pushing the descriptor a second time would corrupt the free list. */
+		FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: %p ALREADY RELEASED (now %lu)\n",
+			pxNetworkBuffer, uxGetNumberOfFreeNetworkBuffers( ) ) );
+	}
+	else
+	{
+		/* Release the storage before the descriptor, so that a task which
+		obtains the descriptor also finds storage. */
+		vReleaseNetworkBuffer( pxNetworkBuffer->pucEthernetBuffer );
+		pxNetworkBuffer->pucEthernetBuffer = NULL;
+
+		prvPoolPush( &xDescriptorPool, usIndex );
+	}
+
+	iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Returns the number of free network buffers
+ */
+UBaseType_t uxGetNumberOfFreeNetworkBuffers( void )
+{
+	return ( UBaseType_t ) xDescriptorPool.ulFree;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetMinimumFreeNetworkBuffers( void )
+{
+	return xDescriptorPool.uxMinimumFree;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xGetNetworkBufferPoolStats( UBaseType_t uxPool, NetworkBufferPoolStats_t *pxStats )
+{
+BaseType_t xReturn = pdFAIL;
+const BufferPool_t *pxPool;
+
+	if( uxPool < ( UBaseType_t ) baNUMBER_OF_POOLS )
+	{
+		pxPool = &( xStoragePools[ uxPool ] );
+		pxStats->uxBufferSize = pxPool->uxBufferSize;
+		pxStats->uxCount = pxPool->uxCount;
+		pxStats->uxFree = ( UBaseType_t ) pxPool->ulFree;
+		pxStats->uxMinimumFree = pxPool->uxMinimumFree;
+		pxStats->ulObtained = pxPool->ulObtained;
+		pxStats->ulFailed = pxPool->ulFailed;
+		xReturn = pdPASS;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t *pxResizeNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * pxNetworkBuffer, size_t xNewSizeBytes )
+{
+size_t xOriginalLength;
+uint8_t *pucBuffer;
+
+	xOriginalLength = pxNetworkBuffer->xDataLength + ipBUFFER_PADDING;
+
+	if( ( pxNetworkBuffer->pucEthernetBuffer != NULL ) &&
+		( xNewSizeBytes <= prvStorageSize( pxNetworkBuffer->pucEthernetBuffer - ipBUFFER_PADDING ) ) )
+	{
+		/* The current slot is big enough already. */
+		pxNetworkBuffer->xDataLength = xNewSizeBytes;
+	}
+	else
+	{
+		pucBuffer = pucGetNetworkBuffer( &( xNewSizeBytes ) );
+
+		if( pucBuffer == NULL )
+		{
+			/* In case the allocation fails, return NULL. */
+			pxNetworkBuffer = NULL;
+		}
+		else
+		{
+			pxNetworkBuffer->xDataLength = xNewSizeBytes;
+			xNewSizeBytes += ipBUFFER_PADDING;
+			if( xNewSizeBytes > xOriginalLength )
+			{
+				xNewSizeBytes = xOriginalLength;
+			}
+
+			if( pxNetworkBuffer->pucEthernetBuffer != NULL )
+			{
+				memcpy( pucBuffer - ipBUFFER_PADDING, pxNetworkBuffer->pucEthernetBuffer - ipBUFFER_PADDING, xNewSizeBytes );
+				vReleaseNetworkBuffer( pxNetworkBuffer->pucEthernetBuffer );
+			}
+			else
+			{
+				*( ( NetworkBufferDescriptor_t ** ) ( pucBuffer - ipBUFFER_PADDING ) ) = pxNetworkBuffer;
+			}
+			pxNetworkBuffer->pucEthernetBuffer = pucBuffer;
+		}
+	}
+
+	return pxNetworkBuffer;
+}
@@ -209,7 +209,17 @@ BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxBuffer,
 	if( ( ulPHYLinkStatus & BMSR_LINK_STATUS ) != 0 )
 	{
 		iptraceNETWORK_INTERFACE_TRANSMIT();
-		emacps_send_message( &xEMACpsif, pxBuffer, bReleaseAfterSend );
+		#if( ipconfigUSE_TCP_LARGE_SEND != 0 ) && ( ipconfigDRIVER_INCLUDED_LARGE_SEND != 0 )
+			if( pxBuffer->usLargeSendMSS != 0u )
+			{
+				/* A large TCP packet, which will be split into frames here. */
+				emacps_send_large_message( &xEMACpsif, pxBuffer, bReleaseAfterSend );
+			}
+			else
+		#endif
+		{
+			emacps_send_message( &xEMACpsif, pxBuffer, bReleaseAfterSend );
+		}
 	}
 	else if( bReleaseAfterSend != pdFALSE )
 	{
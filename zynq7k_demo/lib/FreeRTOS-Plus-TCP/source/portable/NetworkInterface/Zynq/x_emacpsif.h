@@ -117,6 +117,8 @@ int emacps_check_errors( xemacpsif_s *xemacps );
 void emacps_set_rx_buffers( xemacpsif_s *xemacpsif, u32 ulCount );
 
 extern XStatus emacps_send_message(xemacpsif_s *xemacpsif, struct xNETWORK_BUFFER *pxBuffer, int iReleaseAfterSend );
+/* Send a large TCP packet as a series of frames, see 'usLargeSendMSS'. */
+extern XStatus emacps_send_large_message(xemacpsif_s *xemacpsif, struct xNETWORK_BUFFER *pxBuffer, int iReleaseAfterSend );
 extern unsigned Phy_Setup( XEmacPs *xemacpsp );
 extern void setup_isr( xemacpsif_s *xemacpsif );
 extern XStatus init_dma( xemacpsif_s *xemacpsif );
@@ -56,6 +56,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #endif
 #define TX_OFFSET				ipconfigPACKET_FILLER_SIZE
 
+#if( ipconfigUSE_TCP_LARGE_SEND != 0 ) && ( ipconfigDRIVER_INCLUDED_LARGE_SEND != 0 ) && ( ipconfigZERO_COPY_TX_DRIVER != 0 )
+	#error Large packets are split into the uncached TX buffers, which can not be combined with ipconfigZERO_COPY_TX_DRIVER
+#endif
+
 #define RX_BUFFER_ALIGNMENT	14
 
 /* Defined in NetworkInterface.c */
@@ -298,6 +302,92 @@ TickType_t xBlockTimeTicks = pdMS_TO_TICKS( 5000u );
 	return 0;
 }
 
+#if( ipconfigUSE_TCP_LARGE_SEND != 0 ) && ( ipconfigDRIVER_INCLUDED_LARGE_SEND != 0 )
+
+XStatus emacps_send_large_message(xemacpsif_s *xemacpsif, NetworkBufferDescriptor_t *pxBuffer, int iReleaseAfterSend )
+{
+int head = xemacpsif->txHead;
+int iHasSent = 0;
+uint32_t ulBaseAddress = xemacpsif->emacps.Config.BaseAddress;
+TickType_t xBlockTimeTicks = pdMS_TO_TICKS( 5000u );
+UBaseType_t uxIndex;
+size_t uxLength;
+
+	/* Each frame is written straight into a TX buffer in uncached RAM, so the
+	large packet is copied only once.  The checksums will be calculated by the
+	GEM. */
+	for( uxIndex = 0u; ; uxIndex++ )
+	{
+	uint32_t ulFlags = 0;
+
+		if( xTXDescriptorSemaphore == NULL )
+		{
+			break;
+		}
+
+		if( xSemaphoreTake( xTXDescriptorSemaphore, xBlockTimeTicks ) != pdPASS )
+		{
+			FreeRTOS_printf( ( "emacps_send_large_message: Time-out waiting for TX buffer\n" ) );
+			break;
+		}
+
+		if( pxDMA_tx_buffers[ head ] == NULL )
+		{
+			FreeRTOS_printf( ( "emacps_send_large_message: pxDMA_tx_buffers[ %d ] == NULL\n", head ) );
+			xSemaphoreGive( xTXDescriptorSemaphore );
+			break;
+		}
+
+		uxLength = uxTCPLargeSendGetSegment( pxBuffer, uxIndex, pxDMA_tx_buffers[ head ] );
+
+		if( uxLength == 0u )
+		{
+			/* All frames have been queued, return the descriptor. */
+			xSemaphoreGive( xTXDescriptorSemaphore );
+			break;
+		}
+
+		ulFlags |= XEMACPS_TXBUF_LAST_MASK;
+		ulFlags |= ( uxLength & XEMACPS_TXBUF_LEN_MASK );
+		if( head == ( ipconfigNIC_N_TX_DESC - 1 ) )
+		{
+			ulFlags |= XEMACPS_TXBUF_WRAP_MASK;
+		}
+
+		xemacpsif->txSegments[ head ].address = ( uint32_t )pxDMA_tx_buffers[ head ];
+		xemacpsif->txSegments[ head ].flags = ulFlags;
+
+		iHasSent = pdTRUE;
+		if( ++head == ipconfigNIC_N_TX_DESC )
+		{
+			head = 0;
+		}
+		xemacpsif->txHead = head;
+	}
+
+	if( iReleaseAfterSend != pdFALSE )
+	{
+		vReleaseNetworkBufferAndDescriptor( pxBuffer );
+	}
+
+	/* Data Synchronization Barrier */
+	dsb();
+
+	if( iHasSent != pdFALSE )
+	{
+		/* Make STARTTX high */
+		uint32_t ulValue = XEmacPs_ReadReg( ulBaseAddress, XEMACPS_NWCTRL_OFFSET);
+		/* Start transmit */
+		xemacpsif->txBusy = pdTRUE;
+		XEmacPs_WriteReg( ulBaseAddress, XEMACPS_NWCTRL_OFFSET, ( ulValue | XEMACPS_NWCTRL_STARTTX_MASK ) );
+	}
+	dsb();
+
+	return 0;
+}
+
+#endif /* ipconfigUSE_TCP_LARGE_SEND && ipconfigDRIVER_INCLUDED_LARGE_SEND */
+
 void emacps_recv_handler(void *arg)
 {
 	xemacpsif_s *xemacpsif;
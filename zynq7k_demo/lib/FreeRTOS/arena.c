@@ -0,0 +1,642 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+
+/*
+ * An arena's memory starts with the Arena_t structure, followed by the heads
+ * of the free lists, one for each size class, followed by the blocks.  Blocks
+ * are carved in order from the start of the block region, and pucNextBlock
+ * marks the start of the memory not yet carved.
+ *
+ * Sizes are counted in units of portBYTE_ALIGNMENT bytes.  A block of up to
+ * arenaLINEAR_UNITS units has a class for each size.  Above that, each power
+ * of two range (2^p, 2^(p + 1)] is divided into arenaSUB_CLASS_COUNT classes,
+ * the largest of each being 2^p plus a multiple of 2^(p - arenaSUB_CLASS_BITS)
+ * units.  Each block has a header holding its class, and while the block is
+ * free its first bytes link it into the free list of that class.  A bitmap of
+ * the classes whose lists are not empty finds a larger free block when a
+ * class and the uncarved memory are both exhausted.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "arena.h"
+
+/* Lint e961 and e750 are suppressed as a MISRA exception justified because the
+MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined for the
+header files above, but not in this file, in order to generate the correct
+privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE /*lint !e961 !e750. */
+
+/* Four classes for each power of two, so rounding a block up to its class
+wastes less than a quarter of it. */
+#define arenaSUB_CLASS_BITS		( 2U )
+#define arenaSUB_CLASS_COUNT	( 1U << arenaSUB_CLASS_BITS )
+#define arenaLINEAR_UNITS		( 2U * arenaSUB_CLASS_COUNT )
+
+/* Enough classes for blocks of up to 2^32 units. */
+#define arenaMAX_CLASSES		( 128U )
+#define arenaBITMAP_WORDS		( arenaMAX_CLASSES / 32U )
+
+/* Round a size or an address up to a multiple of portBYTE_ALIGNMENT. */
+#define arenaALIGN_UP( x )		( ( ( x ) + ( size_t ) portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* Bit scans of a non-zero 32-bit value.  They can be defined to use an
+instruction the compiler has no builtin for. */
+#ifndef arenaFIND_FIRST_SET
+	#define arenaFIND_FIRST_SET( ulValue )	( ( UBaseType_t ) __builtin_ctz( ( uint32_t ) ( ulValue ) ) )
+#endif
+#ifndef arenaFIND_LAST_SET
+	#define arenaFIND_LAST_SET( ulValue )	( ( UBaseType_t ) ( 31 - __builtin_clz( ( uint32_t ) ( ulValue ) ) ) )
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* The header at the start of each block. */
+typedef struct xARENA_BLOCK_HEADER
+{
+	UBaseType_t uxClass;
+} ArenaBlockHeader_t;
+
+/* Structure that holds state information on the arena. */
+typedef struct xARENA /*lint !e9058 Style convention uses tag. */
+{
+	const char *pcName;
+	struct xARENA *pxNextArena;			/* The arena created before this one, for uxArenaGetSystemState(). */
+	uint8_t *pucStorage;				/* The memory to return to the heap when the arena is deleted, or NULL if it was provided by the application. */
+	void **ppvFreeBlocks;				/* The first free block of each class, or NULL. */
+	UBaseType_t uxClasses;				/* The number of classes, up to the largest that fits in the block region. */
+	uint8_t *pucFirstBlock;				/* The start of the block region. */
+	uint8_t *pucNextBlock;				/* The start of the memory not yet divided into blocks. */
+	uint8_t *pucEnd;					/* The end of the block region. */
+	uint32_t ulNonEmptyClasses[ arenaBITMAP_WORDS ];
+	size_t xBytesInUse;
+	size_t xMaximumBytesInUse;
+	UBaseType_t uxBlocksInUse;
+	uint32_t ulAllocations;
+	uint32_t ulFailures;
+} Arena_t;
+
+/* The header's size, rounded up to keep blocks aligned. */
+static const size_t xHeaderSize = arenaALIGN_UP( sizeof( ArenaBlockHeader_t ) );
+
+/* The arenas that exist, newest first. */
+static Arena_t *pxArenas = NULL;
+
+/*
+ * The smallest class whose blocks are at least xUnits units.
+ */
+static UBaseType_t prvClassOfUnits( size_t xUnits ) PRIVILEGED_FUNCTION;
+
+/*
+ * The size of the blocks of a class, in units.
+ */
+static size_t prvUnitsOfClass( UBaseType_t uxClass ) PRIVILEGED_FUNCTION;
+
+/*
+ * The first class at or above uxClass whose free list is not empty, or
+ * pxArena->uxClasses if there is none.  Called from a critical section.
+ */
+static UBaseType_t prvFindFreeClass( const Arena_t *pxArena, UBaseType_t uxClass ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	ArenaHandle_t xArenaCreate( const char *pcName, size_t xBudget )
+	{
+	uint8_t *pucStorage;
+	Arena_t *pxArena = NULL;
+
+		pucStorage = ( uint8_t * ) pvPortMalloc( xBudget ); /*lint !e9079 malloc() only returns void*. */
+
+		if( pucStorage != NULL )
+		{
+			pxArena = ( Arena_t * ) xArenaCreateStatic( pcName, pucStorage, xBudget );
+
+			if( pxArena != NULL )
+			{
+				/* Only read when the arena is deleted. */
+				pxArena->pucStorage = pucStorage;
+			}
+			else
+			{
+				vPortFree( pucStorage );
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return ( ArenaHandle_t ) pxArena;
+	}
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+ArenaHandle_t xArenaCreateStatic( const char *pcName, uint8_t *pucStorage, size_t xStorageSize )
+{
+Arena_t *pxArena;
+size_t xPadding, xHeadsOffset, xBlocksOffset, xRegionUnits;
+UBaseType_t uxClasses;
+
+	configASSERT( pucStorage != NULL );
+
+	/* The structure goes at the first aligned byte, followed by the list
+	heads. */
+	xPadding = arenaALIGN_UP( ( size_t ) pucStorage ) - ( size_t ) pucStorage;
+	xHeadsOffset = arenaALIGN_UP( sizeof( Arena_t ) );
+
+	if( xStorageSize <= ( xPadding + xHeadsOffset ) )
+	{
+		return NULL;
+	}
+	else
+	{
+		pucStorage = &( pucStorage[ xPadding ] );
+		xStorageSize -= xPadding;
+	}
+
+	/* The classes are counted before the list heads take their space, so
+	there may be one more than can be carved. */
+	xRegionUnits = ( xStorageSize - xHeadsOffset ) / portBYTE_ALIGNMENT;
+
+	if( xRegionUnits > ( size_t ) UINT32_MAX )
+	{
+		xRegionUnits = ( size_t ) UINT32_MAX;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	uxClasses = prvClassOfUnits( xRegionUnits );
+
+	if( prvUnitsOfClass( uxClasses ) <= xRegionUnits )
+	{
+		uxClasses++;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	xBlocksOffset = xHeadsOffset + arenaALIGN_UP( uxClasses * sizeof( void * ) );
+
+	/* Room for at least one of the smallest blocks. */
+	if( xStorageSize < ( xBlocksOffset + xHeaderSize + portBYTE_ALIGNMENT ) )
+	{
+		return NULL;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	pxArena = ( Arena_t * ) pucStorage; /*lint !e9087 !e826 The storage has been aligned for the structure. */
+	memset( ( void * ) pxArena, 0x00, sizeof( Arena_t ) );
+	pxArena->pcName = pcName;
+	pxArena->ppvFreeBlocks = ( void ** ) &( pucStorage[ xHeadsOffset ] ); /*lint !e9087 !e826 The heads are aligned. */
+	pxArena->uxClasses = uxClasses;
+	pxArena->pucFirstBlock = &( pucStorage[ xBlocksOffset ] );
+	pxArena->pucNextBlock = pxArena->pucFirstBlock;
+	pxArena->pucEnd = &( pucStorage[ xBlocksOffset + ( ( xStorageSize - xBlocksOffset ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) ) ] );
+	memset( ( void * ) pxArena->ppvFreeBlocks, 0x00, uxClasses * sizeof( void * ) );
+
+	taskENTER_CRITICAL();
+	{
+		pxArena->pxNextArena = pxArenas;
+		pxArenas = pxArena;
+	}
+	taskEXIT_CRITICAL();
+
+	return ( ArenaHandle_t ) pxArena;
+}
+/*-----------------------------------------------------------*/
+
+void vArenaDelete( ArenaHandle_t xArena )
+{
+Arena_t * const pxArena = ( Arena_t * ) xArena;
+Arena_t **ppxLink;
+
+	configASSERT( pxArena );
+
+	taskENTER_CRITICAL();
+	{
+		for( ppxLink = &pxArenas; *ppxLink != pxArena; ppxLink = &( ( *ppxLink )->pxNextArena ) )
+		{
+			configASSERT( *ppxLink != NULL );
+		}
+
+		*ppxLink = pxArena->pxNextArena;
+	}
+	taskEXIT_CRITICAL();
+
+	#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	{
+		if( pxArena->pucStorage != NULL )
+		{
+			vPortFree( pxArena->pucStorage );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+void *pvArenaMalloc( ArenaHandle_t xArena, size_t xWantedSize )
+{
+Arena_t * const pxArena = ( Arena_t * ) xArena;
+uint8_t *pucBlock = NULL;
+UBaseType_t uxClass, uxBlockClass;
+size_t xBlockSize;
+
+	configASSERT( pxArena );
+
+	/* Requests larger than the block region cannot be met, and are left out
+	so the size cannot overflow. */
+	if( ( xWantedSize > 0U ) && ( xWantedSize <= ( size_t ) ( pxArena->pucEnd - pxArena->pucFirstBlock ) ) )
+	{
+		/* A free block must hold the link to the next. */
+		if( xWantedSize < sizeof( void * ) )
+		{
+			xWantedSize = sizeof( void * );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		uxClass = prvClassOfUnits( ( xHeaderSize + xWantedSize + ( size_t ) portBYTE_ALIGNMENT_MASK ) / portBYTE_ALIGNMENT );
+	}
+	else
+	{
+		uxClass = pxArena->uxClasses;
+	}
+
+	taskENTER_CRITICAL();
+	{
+		uxBlockClass = uxClass;
+
+		if( ( uxClass < pxArena->uxClasses ) && ( pxArena->ppvFreeBlocks[ uxClass ] == NULL ) )
+		{
+			/* Carve a new block if there is room, otherwise use a free block
+			of a larger class. */
+			xBlockSize = prvUnitsOfClass( uxClass ) * portBYTE_ALIGNMENT;
+
+			if( ( size_t ) ( pxArena->pucEnd - pxArena->pucNextBlock ) >= xBlockSize )
+			{
+				pucBlock = pxArena->pucNextBlock;
+				pxArena->pucNextBlock = &( pucBlock[ xBlockSize ] );
+				( ( ArenaBlockHeader_t * ) pucBlock )->uxClass = uxClass; /*lint !e826 !e9087 Blocks are aligned. */
+				pucBlock = &( pucBlock[ xHeaderSize ] );
+			}
+			else
+			{
+				uxBlockClass = prvFindFreeClass( pxArena, uxClass + 1U );
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( ( pucBlock == NULL ) && ( uxBlockClass < pxArena->uxClasses ) )
+		{
+			/* Take the first block off the free list. */
+			pucBlock = ( uint8_t * ) pxArena->ppvFreeBlocks[ uxBlockClass ];
+			pxArena->ppvFreeBlocks[ uxBlockClass ] = *( ( void ** ) pucBlock ); /*lint !e826 !e9087 Blocks are aligned. */
+
+			if( pxArena->ppvFreeBlocks[ uxBlockClass ] == NULL )
+			{
+				pxArena->ulNonEmptyClasses[ uxBlockClass / 32U ] &= ~( 1UL << ( uxBlockClass % 32U ) );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( pucBlock != NULL )
+		{
+			pxArena->xBytesInUse += prvUnitsOfClass( uxBlockClass ) * portBYTE_ALIGNMENT;
+			pxArena->uxBlocksInUse++;
+			pxArena->ulAllocations++;
+
+			if( pxArena->xBytesInUse > pxArena->xMaximumBytesInUse )
+			{
+				pxArena->xMaximumBytesInUse = pxArena->xBytesInUse;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else if( xWantedSize > 0U )
+		{
+			pxArena->ulFailures++;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return ( void * ) pucBlock;
+}
+/*-----------------------------------------------------------*/
+
+void *pvArenaCalloc( ArenaHandle_t xArena, size_t xCount, size_t xSize )
+{
+void *pvReturn = NULL;
+
+	if( ( xCount == 0U ) || ( xSize <= ( ( ( size_t ) ~( size_t ) 0 ) / xCount ) ) )
+	{
+		pvReturn = pvArenaMalloc( xArena, xCount * xSize );
+
+		if( pvReturn != NULL )
+		{
+			memset( pvReturn, 0x00, xCount * xSize );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void *pvArenaRealloc( ArenaHandle_t xArena, void *pv, size_t xWantedSize )
+{
+void *pvReturn;
+size_t xAvailable;
+
+	if( pv == NULL )
+	{
+		pvReturn = pvArenaMalloc( xArena, xWantedSize );
+	}
+	else if( xWantedSize == 0U )
+	{
+		vArenaFree( xArena, pv );
+		pvReturn = NULL;
+	}
+	else
+	{
+		/* The block belongs to the caller, so its header can be read outside
+		a critical section. */
+		xAvailable = ( prvUnitsOfClass( ( ( ArenaBlockHeader_t * ) ( ( ( uint8_t * ) pv ) - xHeaderSize ) )->uxClass ) * portBYTE_ALIGNMENT ) - xHeaderSize; /*lint !e826 !e9087 Blocks are aligned. */
+
+		if( xWantedSize <= xAvailable )
+		{
+			pvReturn = pv;
+		}
+		else
+		{
+			pvReturn = pvArenaMalloc( xArena, xWantedSize );
+
+			if( pvReturn != NULL )
+			{
+				memcpy( pvReturn, pv, xAvailable );
+				vArenaFree( xArena, pv );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vArenaFree( ArenaHandle_t xArena, void *pv )
+{
+Arena_t * const pxArena = ( Arena_t * ) xArena;
+uint8_t *pucBlock = ( uint8_t * ) pv;
+UBaseType_t uxClass;
+
+	configASSERT( pxArena );
+
+	if( pucBlock != NULL )
+	{
+		/* The block must have been carved from this arena. */
+		configASSERT( ( pucBlock > pxArena->pucFirstBlock ) && ( pucBlock < pxArena->pucNextBlock ) );
+		uxClass = ( ( ArenaBlockHeader_t * ) ( pucBlock - xHeaderSize ) )->uxClass; /*lint !e826 !e9087 Blocks are aligned. */
+		configASSERT( uxClass < pxArena->uxClasses );
+
+		taskENTER_CRITICAL();
+		{
+			*( ( void ** ) pucBlock ) = pxArena->ppvFreeBlocks[ uxClass ]; /*lint !e826 !e9087 Blocks are aligned. */
+			pxArena->ppvFreeBlocks[ uxClass ] = ( void * ) pucBlock;
+			pxArena->ulNonEmptyClasses[ uxClass / 32U ] |= ( 1UL << ( uxClass % 32U ) );
+
+			pxArena->xBytesInUse -= prvUnitsOfClass( uxClass ) * portBYTE_ALIGNMENT;
+			pxArena->uxBlocksInUse--;
+		}
+		taskEXIT_CRITICAL();
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vArenaReset( ArenaHandle_t xArena )
+{
+Arena_t * const pxArena = ( Arena_t * ) xArena;
+
+	configASSERT( pxArena );
+
+	taskENTER_CRITICAL();
+	{
+		memset( ( void * ) pxArena->ppvFreeBlocks, 0x00, pxArena->uxClasses * sizeof( void * ) );
+		memset( ( void * ) pxArena->ulNonEmptyClasses, 0x00, sizeof( pxArena->ulNonEmptyClasses ) );
+		pxArena->pucNextBlock = pxArena->pucFirstBlock;
+		pxArena->xBytesInUse = 0U;
+		pxArena->uxBlocksInUse = 0U;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vArenaGetStats( ArenaHandle_t xArena, ArenaStats_t *pxStats )
+{
+Arena_t * const pxArena = ( Arena_t * ) xArena;
+
+	configASSERT( pxArena );
+	configASSERT( pxStats );
+
+	taskENTER_CRITICAL();
+	{
+		pxStats->pcName = pxArena->pcName;
+		pxStats->xBudget = ( size_t ) ( pxArena->pucEnd - pxArena->pucFirstBlock );
+		pxStats->xBytesInUse = pxArena->xBytesInUse;
+		pxStats->xMaximumBytesInUse = pxArena->xMaximumBytesInUse;
+		pxStats->xBytesCarved = ( size_t ) ( pxArena->pucNextBlock - pxArena->pucFirstBlock );
+		pxStats->uxBlocksInUse = pxArena->uxBlocksInUse;
+		pxStats->ulAllocations = pxArena->ulAllocations;
+		pxStats->ulFailures = pxArena->ulFailures;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxArenaGetSystemState( ArenaStats_t * const pxArenaStatsArray, const UBaseType_t uxArraySize )
+{
+Arena_t *pxArena;
+UBaseType_t uxArenas = 0U;
+
+	/* Critical sections nest, so each arena's statistics are read in the
+	same one as the list. */
+	taskENTER_CRITICAL();
+	{
+		for( pxArena = pxArenas; pxArena != NULL; pxArena = pxArena->pxNextArena )
+		{
+			uxArenas++;
+		}
+
+		if( uxArenas <= uxArraySize )
+		{
+			uxArenas = 0U;
+
+			for( pxArena = pxArenas; pxArena != NULL; pxArena = pxArena->pxNextArena )
+			{
+				vArenaGetStats( ( ArenaHandle_t ) pxArena, &( pxArenaStatsArray[ uxArenas ] ) );
+				uxArenas++;
+			}
+		}
+		else
+		{
+			uxArenas = 0U;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return uxArenas;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvClassOfUnits( size_t xUnits )
+{
+UBaseType_t uxClass, uxPower;
+
+	if( xUnits <= ( size_t ) arenaLINEAR_UNITS )
+	{
+		uxClass = ( UBaseType_t ) xUnits - 1U;
+	}
+	else
+	{
+		/* xUnits - 1 is in [2^p, 2^(p + 1)), and the class is the first of
+		that range's classes whose blocks are at least xUnits. */
+		uxPower = arenaFIND_LAST_SET( xUnits - 1U );
+		uxClass = ( UBaseType_t ) arenaLINEAR_UNITS + ( ( uxPower - ( arenaSUB_CLASS_BITS + 1U ) ) << arenaSUB_CLASS_BITS );
+		uxClass += ( UBaseType_t ) ( ( xUnits - 1U ) >> ( uxPower - arenaSUB_CLASS_BITS ) ) - arenaSUB_CLASS_COUNT;
+	}
+
+	return uxClass;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvUnitsOfClass( UBaseType_t uxClass )
+{
+size_t xUnits;
+UBaseType_t uxPower;
+
+	if( uxClass < ( UBaseType_t ) arenaLINEAR_UNITS )
+	{
+		xUnits = ( size_t ) uxClass + 1U;
+	}
+	else
+	{
+		uxClass -= ( UBaseType_t ) arenaLINEAR_UNITS;
+		uxPower = ( uxClass >> arenaSUB_CLASS_BITS ) + arenaSUB_CLASS_BITS + 1U;
+		xUnits = ( ( size_t ) 1U << uxPower ) + ( ( ( size_t ) ( uxClass & ( arenaSUB_CLASS_COUNT - 1U ) ) + 1U ) << ( uxPower - arenaSUB_CLASS_BITS ) );
+	}
+
+	return xUnits;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvFindFreeClass( const Arena_t *pxArena, UBaseType_t uxClass )
+{
+UBaseType_t uxWord;
+uint32_t ulBits;
+
+	for( uxWord = uxClass / 32U; uxWord < arenaBITMAP_WORDS; uxWord++ )
+	{
+		ulBits = pxArena->ulNonEmptyClasses[ uxWord ];
+
+		/* Only the classes at or above uxClass in its own word. */
+		if( uxWord == ( uxClass / 32U ) )
+		{
+			ulBits &= ~( ( 1UL << ( uxClass % 32U ) ) - 1UL );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( ulBits != 0UL )
+		{
+			return ( uxWord * 32U ) + arenaFIND_FIRST_SET( ulBits );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+	return pxArena->uxClasses;
+}
+/*-----------------------------------------------------------*/
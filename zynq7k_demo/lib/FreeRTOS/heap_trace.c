@@ -0,0 +1,374 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+
+/*
+ * The records are kept in an array used as a ring, from the oldest record not
+ * yet read.  The heap implementations call the traceMALLOC() and traceFREE()
+ * macros with the scheduler suspended, so the records are written one at a
+ * time, and the reader suspends the scheduler too while it takes records out.
+ * Neither needs a critical section, as the heap is not used from interrupts.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "heap_trace.h"
+
+/* Lint e961 and e750 are suppressed as a MISRA exception justified because the
+MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined for the
+header files above, but not in this file, in order to generate the correct
+privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE /*lint !e961 !e750. */
+
+#if ( configUSE_HEAP_TRACE == 1 )
+
+#if( INCLUDE_xTaskGetCurrentTaskHandle != 1 )
+	#error INCLUDE_xTaskGetCurrentTaskHandle must be set to 1 to build heap_trace.c
+#endif
+
+/* The longest line xHeapTraceFormat() writes, with its terminator. */
+#define heaptraceMAX_LINE_LENGTH	( 80 )
+
+/* How often the tick rate and the task names are written again, so that a
+capture started after them can still be read. */
+#define heaptraceDESCRIBE_PERIOD	( pdMS_TO_TICKS( 10000UL ) )
+
+/* The most tasks whose names xHeapTraceFormat() writes.  If there are more,
+no names are written. */
+#define heaptraceMAX_NAMED_TASKS	( 32 )
+
+/*
+ * Add a record to the buffer, or count it as dropped if the buffer is full.
+ */
+static void prvRecord( uint32_t ulEvent, void *pvAddress, size_t xSize, void *pvCaller );
+
+/*
+ * Append a line to the text in pcBuffer if there is room for it, returning
+ * pdFALSE if there is not.
+ */
+static BaseType_t prvAppendLine( char *pcBuffer, size_t xBufferLength, size_t *pxLength, const char *pcLine );
+
+/*-----------------------------------------------------------*/
+
+static HeapTraceRecord_t xRecords[ configHEAP_TRACE_LENGTH ];
+
+/* The oldest record not yet read, and the number of records not yet read. */
+static UBaseType_t uxFirstRecord = 0U;
+static UBaseType_t uxRecordsWaiting = 0U;
+
+/* The records dropped since the buffer was last read. */
+static uint32_t ulRecordsDropped = 0UL;
+
+/*-----------------------------------------------------------*/
+
+void vHeapTraceMalloc( void *pvAddress, size_t xSize, void *pvCaller )
+{
+	prvRecord( ( pvAddress != NULL ) ? heaptraceMALLOC : heaptraceMALLOC_FAILED, pvAddress, xSize, pvCaller );
+}
+/*-----------------------------------------------------------*/
+
+void vHeapTraceFree( void *pvAddress, size_t xSize, void *pvCaller )
+{
+	prvRecord( heaptraceFREE, pvAddress, xSize, pvCaller );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecord( uint32_t ulEvent, void *pvAddress, size_t xSize, void *pvCaller )
+{
+HeapTraceRecord_t *pxRecord;
+UBaseType_t uxRecord;
+
+	if( uxRecordsWaiting < ( UBaseType_t ) configHEAP_TRACE_LENGTH )
+	{
+		uxRecord = uxFirstRecord + uxRecordsWaiting;
+
+		if( uxRecord >= ( UBaseType_t ) configHEAP_TRACE_LENGTH )
+		{
+			uxRecord -= ( UBaseType_t ) configHEAP_TRACE_LENGTH;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* Sizes too large for the record cannot have been allocated. */
+		if( xSize > heaptraceSIZE_MASK )
+		{
+			xSize = heaptraceSIZE_MASK;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxRecord = &( xRecords[ uxRecord ] );
+		pxRecord->pvAddress = pvAddress;
+		pxRecord->pvCaller = pvCaller;
+		pxRecord->xTask = xTaskGetCurrentTaskHandle();
+		pxRecord->xTickCount = xTaskGetTickCount();
+		pxRecord->ulSizeAndEvent = ( ulEvent << heaptraceEVENT_SHIFT ) | ( uint32_t ) xSize;
+
+		uxRecordsWaiting++;
+	}
+	else
+	{
+		ulRecordsDropped++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxHeapTraceRead( HeapTraceRecord_t *pxRecords, UBaseType_t uxMaxRecords, uint32_t *pulDropped )
+{
+UBaseType_t uxRead = 0U;
+
+	configASSERT( ( pxRecords != NULL ) || ( uxMaxRecords == 0U ) );
+
+	vTaskSuspendAll();
+	{
+		while( ( uxRead < uxMaxRecords ) && ( uxRecordsWaiting > 0U ) )
+		{
+			pxRecords[ uxRead ] = xRecords[ uxFirstRecord ];
+			uxRead++;
+
+			uxFirstRecord++;
+			uxRecordsWaiting--;
+
+			if( uxFirstRecord == ( UBaseType_t ) configHEAP_TRACE_LENGTH )
+			{
+				uxFirstRecord = 0U;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		if( pulDropped != NULL )
+		{
+			*pulDropped = ulRecordsDropped;
+			ulRecordsDropped = 0UL;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	return uxRead;
+}
+/*-----------------------------------------------------------*/
+
+size_t xHeapTraceFormat( char *pcBuffer, size_t xBufferLength )
+{
+/* The record read that did not fit in the last call's buffer, and the records
+dropped that have not been written. */
+static HeapTraceRecord_t xRecord;
+static BaseType_t xHaveRecord = pdFALSE;
+static uint32_t ulLost = 0UL;
+static BaseType_t xDescribed = pdFALSE;
+static TickType_t xDescribedAt = 0U;
+#if ( configUSE_TRACE_FACILITY == 1 )
+	static TaskStatus_t xTasks[ heaptraceMAX_NAMED_TASKS ];
+	static UBaseType_t uxTasks = 0U, uxTasksNamed = 0U, uxNumberOfTasksNamed = 0U;
+#endif
+static const char cEvents[] = { 'm', 'f', 'x', '?' };
+char cLine[ heaptraceMAX_LINE_LENGTH ];
+size_t xLength = 0U;
+uint32_t ulDropped;
+
+	configASSERT( pcBuffer != NULL );
+	configASSERT( xBufferLength >= heaptraceMAX_LINE_LENGTH );
+
+	pcBuffer[ 0 ] = '\0';
+
+	if( xHaveRecord == pdFALSE )
+	{
+		xHaveRecord = ( uxHeapTraceRead( &xRecord, 1U, &ulDropped ) != 0U ) ? pdTRUE : pdFALSE;
+		ulLost += ulDropped;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( ( xHaveRecord == pdFALSE ) && ( ulLost == 0UL ) )
+	{
+		return 0U;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	#if ( configUSE_TRACE_FACILITY == 1 )
+	{
+		/* Name the tasks again if tasks have been created or deleted. */
+		if( uxTaskGetNumberOfTasks() != uxNumberOfTasksNamed )
+		{
+			xDescribed = pdFALSE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif /* configUSE_TRACE_FACILITY */
+
+	/* The tick rate, the task names and the heap's size come before the
+	records.  The names are written over as many calls as it takes. */
+	if( ( xDescribed == pdFALSE ) || ( ( xTaskGetTickCount() - xDescribedAt ) >= heaptraceDESCRIBE_PERIOD ) )
+	{
+		( void ) snprintf( cLine, sizeof( cLine ), "HT hz %lx\r\n", ( unsigned long ) configTICK_RATE_HZ );
+		( void ) prvAppendLine( pcBuffer, xBufferLength, &xLength, cLine );
+		xDescribed = pdTRUE;
+		xDescribedAt = xTaskGetTickCount();
+
+		#if ( configUSE_TRACE_FACILITY == 1 )
+		{
+			uxNumberOfTasksNamed = uxTaskGetNumberOfTasks();
+			uxTasks = uxTaskGetSystemState( xTasks, heaptraceMAX_NAMED_TASKS, NULL );
+			uxTasksNamed = 0U;
+		}
+		#endif
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	( void ) snprintf( cLine, sizeof( cLine ), "HT heap %lx %lx %lx\r\n",
+		( unsigned long ) configTOTAL_HEAP_SIZE,
+		( unsigned long ) xPortGetFreeHeapSize(),
+		( unsigned long ) xPortGetMinimumEverFreeHeapSize() );
+
+	if( prvAppendLine( pcBuffer, xBufferLength, &xLength, cLine ) == pdFALSE )
+	{
+		return xLength;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	#if ( configUSE_TRACE_FACILITY == 1 )
+	{
+		while( uxTasksNamed < uxTasks )
+		{
+			( void ) snprintf( cLine, sizeof( cLine ), "HT task %lx %s\r\n",
+				( unsigned long ) ( uintptr_t ) xTasks[ uxTasksNamed ].xHandle,
+				xTasks[ uxTasksNamed ].pcTaskName );
+
+			if( prvAppendLine( pcBuffer, xBufferLength, &xLength, cLine ) == pdFALSE )
+			{
+				return xLength;
+			}
+			else
+			{
+				uxTasksNamed++;
+			}
+		}
+	}
+	#endif /* configUSE_TRACE_FACILITY */
+
+	while( xHaveRecord != pdFALSE )
+	{
+		( void ) snprintf( cLine, sizeof( cLine ), "HT %c %lx %lx %lx %lx %lx\r\n",
+			cEvents[ heaptraceGET_EVENT( &xRecord ) ],
+			( unsigned long ) xRecord.xTickCount,
+			( unsigned long ) ( uintptr_t ) xRecord.xTask,
+			( unsigned long ) ( uintptr_t ) xRecord.pvCaller,
+			( unsigned long ) ( uintptr_t ) xRecord.pvAddress,
+			( unsigned long ) heaptraceGET_SIZE( &xRecord ) );
+
+		if( prvAppendLine( pcBuffer, xBufferLength, &xLength, cLine ) == pdFALSE )
+		{
+			break;
+		}
+		else
+		{
+			xHaveRecord = ( uxHeapTraceRead( &xRecord, 1U, &ulDropped ) != 0U ) ? pdTRUE : pdFALSE;
+			ulLost += ulDropped;
+		}
+	}
+
+	/* Records are only dropped when the buffer is full, so they were newer
+	than all those in it, and are counted once it has been emptied. */
+	if( ( ulLost != 0UL ) && ( xHaveRecord == pdFALSE ) )
+	{
+		( void ) snprintf( cLine, sizeof( cLine ), "HT lost %lx\r\n", ( unsigned long ) ulLost );
+
+		if( prvAppendLine( pcBuffer, xBufferLength, &xLength, cLine ) != pdFALSE )
+		{
+			ulLost = 0UL;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xLength;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvAppendLine( char *pcBuffer, size_t xBufferLength, size_t *pxLength, const char *pcLine )
+{
+size_t xLineLength = strlen( pcLine );
+BaseType_t xReturn = pdFALSE;
+
+	if( ( *pxLength + xLineLength ) < xBufferLength )
+	{
+		memcpy( &( pcBuffer[ *pxLength ] ), pcLine, xLineLength + 1U );
+		*pxLength += xLineLength;
+		xReturn = pdTRUE;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_HEAP_TRACE == 1 */
@@ -48,6 +48,12 @@
 	#error configSETUP_TICK_INTERRUPT() must be defined.  See http://www.freertos.org/Using-FreeRTOS-on-Cortex-A-Embedded-Processors.html
 #endif /* configSETUP_TICK_INTERRUPT */
 
+#if ( configNUM_CORES > 1 )
+	#ifndef configSTART_SECONDARY_CORES
+		#error configSTART_SECONDARY_CORES() must be defined when configNUM_CORES is greater than 1.  It must release the other cores, which then call vPortStartSecondaryCore().
+	#endif
+#endif /* configNUM_CORES */
+
 #ifndef configMAX_API_CALL_INTERRUPT_PRIORITY
 	#error configMAX_API_CALL_INTERRUPT_PRIORITY must be defined.  See http://www.freertos.org/Using-FreeRTOS-on-Cortex-A-Embedded-Processors.html
 #endif
@@ -151,6 +157,56 @@ debugger. */
 registers, plus a 32-bit status register. */
 #define portFPU_REGISTER_WORDS	( ( 32 * 2 ) + 1 )
 
+#if ( configNUM_CORES > 1 )
+
+	/* The size, in words, of the stack each core runs vTaskSwitchContext() on.
+	It has to be large enough for vTaskSwitchContext() and the trace and stack
+	overflow hooks it calls. */
+	#ifndef configPORT_SWITCH_STACK_SIZE
+		#define configPORT_SWITCH_STACK_SIZE	( 256 )
+	#endif
+
+	/* The GIC distributor registers used to set up the yield SGI. */
+	#define portICDISER_SET_ENABLE_OFFSET		( 0x100UL )
+	#define portICCICR_CPU_INTERFACE_CONTROL	( *( ( volatile uint32_t * ) ( portINTERRUPT_CONTROLLER_CPU_INTERFACE_ADDRESS + 0x00UL ) ) )
+	#define portICCICR_ENABLE					( 0x01UL )
+
+	/* The number of kernel locks, see portTASK_LOCK and portISR_LOCK. */
+	#define portNUM_LOCKS						( 2 )
+
+	/* Stored in a lock that no core holds. */
+	#define portLOCK_FREE						( ( uint32_t ) 0xFFFFFFFFUL )
+
+#endif /* configNUM_CORES */
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	/* Tickless idle reprograms the Cortex-A9 private timer, so
+	configSETUP_TICK_INTERRUPT() must use it to generate the tick, as
+	FreeRTOS_tick_config.c does on the Zynq.  The private timer is at offset
+	0x600 of the private memory region, in which the GIC distributor is at
+	offset 0x1000. */
+	#ifndef configPRIVATE_TIMER_BASE_ADDRESS
+		#define configPRIVATE_TIMER_BASE_ADDRESS	( configINTERRUPT_CONTROLLER_BASE_ADDRESS - 0xA00UL )
+	#endif
+
+	#define portPRIVATE_TIMER_LOAD_REGISTER		( *( ( volatile uint32_t * ) ( configPRIVATE_TIMER_BASE_ADDRESS + 0x00UL ) ) )
+	#define portPRIVATE_TIMER_COUNTER_REGISTER	( *( ( volatile uint32_t * ) ( configPRIVATE_TIMER_BASE_ADDRESS + 0x04UL ) ) )
+	#define portPRIVATE_TIMER_CONTROL_REGISTER	( *( ( volatile uint32_t * ) ( configPRIVATE_TIMER_BASE_ADDRESS + 0x08UL ) ) )
+	#define portPRIVATE_TIMER_STATUS_REGISTER	( *( ( volatile uint32_t * ) ( configPRIVATE_TIMER_BASE_ADDRESS + 0x0CUL ) ) )
+	#define portPRIVATE_TIMER_ENABLE_BIT		( 0x01UL )
+	#define portPRIVATE_TIMER_EVENT_BIT			( 0x01UL )
+
+	#define portMAX_32_BIT_NUMBER				( 0xffffffffUL )
+
+	/* An estimate of the timer counts lost while the timer is stopped to be
+	reprogrammed. */
+	#ifndef configSTOPPED_TIMER_COMPENSATION
+		#define configSTOPPED_TIMER_COMPENSATION	( 45UL )
+	#endif
+
+#endif /* configUSE_TICKLESS_IDLE */
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -185,25 +241,62 @@ static void prvTaskExitError( void );
  */
 void vApplicationFPUSafeIRQHandler( uint32_t ulICCIAR ) __attribute__((weak) );
 
+#if ( configNUM_CORES > 1 )
+
+	/*
+	 * Sets the priority of the yield SGI and enables it on the calling core.
+	 * SGIs are banked, so each core has to do this itself.
+	 */
+	static void prvSetupYieldInterrupt( void );
+
+#endif /* configNUM_CORES */
+
 /*-----------------------------------------------------------*/
 
-/* A variable is used to keep track of the critical section nesting.  This
+/* The variables below have one entry per core, indexed by portGET_CORE_ID()
+in C and by the MPIDR in portASM.S.
+
+A variable is used to keep track of the critical section nesting.  This
 variable has to be stored as part of the task context and must be initialised to
 a non zero value to ensure interrupts don't inadvertently become unmasked before
 the scheduler starts.  As it is stored as part of the task context it will
 automatically be set to 0 when the first task is started. */
-volatile uint32_t ulCriticalNesting = 9999UL;
+volatile uint32_t ulCriticalNesting[ configNUM_CORES ] = { [ 0 ... ( configNUM_CORES - 1 ) ] = 9999UL };
 
 /* Saved as part of the task context.  If ulPortTaskHasFPUContext is non-zero then
 a floating point context must be saved and restored for the task. */
-volatile uint32_t ulPortTaskHasFPUContext = pdFALSE;
+volatile uint32_t ulPortTaskHasFPUContext[ configNUM_CORES ] = { pdFALSE };
 
 /* Set to 1 to pend a context switch from an ISR. */
-volatile uint32_t ulPortYieldRequired = pdFALSE;
+volatile uint32_t ulPortYieldRequired[ configNUM_CORES ] = { pdFALSE };
 
 /* Counts the interrupt nesting depth.  A context switch is only performed if
 if the nesting depth is 0. */
-volatile uint32_t ulPortInterruptNesting = 0UL;
+volatile uint32_t ulPortInterruptNesting[ configNUM_CORES ] = { 0UL };
+
+/* The stack each core selects the next task on, or NULL to select it on the
+stack of the task being switched out.  With more than one core the task being
+switched out can be resumed by another core before vTaskSwitchContext() returns,
+so its stack cannot be used. */
+StackType_t * pxPortSwitchStacks[ configNUM_CORES ] = { NULL };
+
+#if ( configNUM_CORES > 1 )
+
+	static StackType_t uxSwitchStacks[ configNUM_CORES ][ configPORT_SWITCH_STACK_SIZE ] __attribute__(( aligned( 8 ) ));
+
+	/* The core that holds each kernel lock, and how many times it has taken
+	it. */
+	static volatile uint32_t ulLockOwners[ portNUM_LOCKS ] = { portLOCK_FREE, portLOCK_FREE };
+	static uint32_t ulLockCounts[ portNUM_LOCKS ] = { 0UL };
+
+	/* The current task of each core. */
+	extern void * volatile pxCurrentTCBs[];
+
+#else
+
+	extern void * volatile pxCurrentTCB;
+
+#endif /* configNUM_CORES */
 
 /* Used in the asm file. */
 __attribute__(( used )) const uint32_t ulICCIAR = portICCIAR_INTERRUPT_ACKNOWLEDGE_REGISTER_ADDRESS;
@@ -211,6 +304,28 @@ __attribute__(( used )) const uint32_t ulICCEOIR = portICCEOIR_END_OF_INTERRUPT_
 __attribute__(( used )) const uint32_t ulICCPMR	= portICCPMR_PRIORITY_MASK_REGISTER_ADDRESS;
 __attribute__(( used )) const uint32_t ulMaxAPIPriorityMask = ( configMAX_API_CALL_INTERRUPT_PRIORITY << portPRIORITY_SHIFT );
 
+/* Also used in the asm file, which does not see the kernel configuration.  The
+core ID mask is 0 with one core so the port also runs on CPU1 of an AMP system,
+and the yield interrupt ID does not match any interrupt. */
+#if ( configNUM_CORES > 1 )
+	__attribute__(( used )) const uint32_t ulPortCoreIDMask = portMPIDR_CPU_ID_MASK;
+	__attribute__(( used )) const uint32_t ulPortYieldCoreInterruptID = configYIELD_CORE_SGI_ID;
+	__attribute__(( used )) void * volatile * const pxPortCurrentTCBs = pxCurrentTCBs;
+#else
+	__attribute__(( used )) const uint32_t ulPortCoreIDMask = 0UL;
+	__attribute__(( used )) const uint32_t ulPortYieldCoreInterruptID = 0xFFFFFFFFUL;
+	__attribute__(( used )) void * volatile * const pxPortCurrentTCBs = &pxCurrentTCB;
+#endif /* configNUM_CORES */
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	/* The private timer counts in one tick period, as configured by
+	configSETUP_TICK_INTERRUPT(), and the most ticks the timer can count. */
+	static uint32_t ulTimerCountsForOneTick = 0;
+	static uint32_t ulMaximumPossibleSuppressedTicks = 0;
+
+#endif /* configUSE_TICKLESS_IDLE */
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -295,7 +410,7 @@ StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t px
 
 		pxTopOfStack--;
 		*pxTopOfStack = pdTRUE;
-		ulPortTaskHasFPUContext = pdTRUE;
+		ulPortTaskHasFPUContext[ portGET_CORE_ID() ] = pdTRUE;
 	}
 	#else
 	{
@@ -315,7 +430,7 @@ static void prvTaskExitError( void )
 
 	Artificially force an assert() to be triggered if configASSERT() is
 	defined, then stop here so application writers can catch the error. */
-	configASSERT( ulPortInterruptNesting == ~0UL );
+	configASSERT( ulPortInterruptNesting[ portGET_CORE_ID() ] == ~0UL );
 	portDISABLE_INTERRUPTS();
 	for( ;; );
 }
@@ -384,6 +499,33 @@ uint32_t ulAPSR;
 			/* Start the timer that generates the tick ISR. */
 			configSETUP_TICK_INTERRUPT();
 
+			#if ( configUSE_TICKLESS_IDLE == 1 )
+			{
+				/* The timer counts from the load value down to zero inclusive
+				in each tick period. */
+				ulTimerCountsForOneTick = portPRIVATE_TIMER_LOAD_REGISTER + 1UL;
+				ulMaximumPossibleSuppressedTicks = portMAX_32_BIT_NUMBER / ulTimerCountsForOneTick;
+			}
+			#endif /* configUSE_TICKLESS_IDLE */
+
+			#if ( configNUM_CORES > 1 )
+			{
+			BaseType_t xCoreID;
+
+				for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUM_CORES; xCoreID++ )
+				{
+					pxPortSwitchStacks[ xCoreID ] = &( uxSwitchStacks[ xCoreID ][ configPORT_SWITCH_STACK_SIZE ] );
+				}
+
+				prvSetupYieldInterrupt();
+
+				/* Release the other cores, which start their first tasks by
+				calling vPortStartSecondaryCore(). */
+				__asm volatile ( "DSB" ::: "memory" );
+				configSTART_SECONDARY_CORES();
+			}
+			#endif /* configNUM_CORES */
+
 			/* Start the first task executing. */
 			vPortRestoreTaskContext();
 		}
@@ -403,10 +545,87 @@ void vPortEndScheduler( void )
 {
 	/* Not implemented in ports where there is nothing to return to.
 	Artificially force an assert. */
-	configASSERT( ulCriticalNesting == 1000UL );
+	configASSERT( ulCriticalNesting[ portGET_CORE_ID() ] == 1000UL );
 }
 /*-----------------------------------------------------------*/
 
+#if ( configNUM_CORES > 1 )
+
+	void vPortStartSecondaryCore( void )
+	{
+		/* The GIC CPU interface is banked, so is set up by each core.  All
+		interrupts are masked until the first task is restored.  Peripheral
+		interrupts, including the tick, remain targeted at core 0. */
+		portCPU_IRQ_DISABLE();
+		portICCPMR_PRIORITY_MASK_REGISTER = ( uint32_t ) ( configMAX_API_CALL_INTERRUPT_PRIORITY << portPRIORITY_SHIFT );
+		portICCICR_CPU_INTERFACE_CONTROL = portICCICR_ENABLE;
+		prvSetupYieldInterrupt();
+
+		/* Start the task selected for this core by vTaskStartScheduler(). */
+		vPortRestoreTaskContext();
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSetupYieldInterrupt( void )
+	{
+	volatile uint8_t * const pucPriorityRegister = ( volatile uint8_t * const ) ( configINTERRUPT_CONTROLLER_BASE_ADDRESS + portINTERRUPT_PRIORITY_REGISTER_OFFSET + configYIELD_CORE_SGI_ID );
+	volatile uint32_t * const pulSetEnableRegister = ( volatile uint32_t * const ) ( configINTERRUPT_CONTROLLER_BASE_ADDRESS + portICDISER_SET_ENABLE_OFFSET );
+
+		/* A yield is only acted on when no other interrupt is nested, so the
+		SGI uses the same lowest priority as the tick. */
+		*pucPriorityRegister = ( uint8_t ) ( portLOWEST_USABLE_INTERRUPT_PRIORITY << portPRIORITY_SHIFT );
+		*pulSetEnableRegister = ( 1UL << configYIELD_CORE_SGI_ID );
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortRecursiveLock( uint32_t ulLockNum, BaseType_t xAcquire )
+	{
+	const uint32_t ulCoreID = ( uint32_t ) portGET_CORE_ID();
+	uint32_t ulExpected;
+
+		/* Only called with interrupts masked, so the core cannot change and an
+		interrupt cannot take a lock this core is part way through taking. */
+		if( xAcquire != pdFALSE )
+		{
+			if( ulLockOwners[ ulLockNum ] != ulCoreID )
+			{
+				for( ;; )
+				{
+					ulExpected = portLOCK_FREE;
+
+					if( __atomic_compare_exchange_n( &( ulLockOwners[ ulLockNum ] ), &ulExpected, ulCoreID, pdFALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) != pdFALSE )
+					{
+						break;
+					}
+
+					/* Sleep until the owner releases a lock. */
+					__asm volatile ( "WFE" );
+				}
+			}
+
+			ulLockCounts[ ulLockNum ]++;
+		}
+		else
+		{
+			configASSERT( ulLockOwners[ ulLockNum ] == ulCoreID );
+			configASSERT( ulLockCounts[ ulLockNum ] != 0UL );
+
+			ulLockCounts[ ulLockNum ]--;
+
+			if( ulLockCounts[ ulLockNum ] == 0UL )
+			{
+				__atomic_store_n( &( ulLockOwners[ ulLockNum ] ), portLOCK_FREE, __ATOMIC_RELEASE );
+
+				/* Wake any core waiting in WFE for the lock. */
+				__asm volatile ( "DSB	\n"
+								 "SEV	\n" ::: "memory" );
+			}
+		}
+	}
+
+#endif /* configNUM_CORES */
+/*-----------------------------------------------------------*/
+
 void vPortEnterCritical( void )
 {
 	/* Mask interrupts up to the max syscall interrupt priority. */
@@ -415,31 +634,31 @@ void vPortEnterCritical( void )
 	/* Now interrupts are disabled ulCriticalNesting can be accessed
 	directly.  Increment ulCriticalNesting to keep a count of how many times
 	portENTER_CRITICAL() has been called. */
-	ulCriticalNesting++;
+	ulCriticalNesting[ portGET_CORE_ID() ]++;
 
 	/* This is not the interrupt safe version of the enter critical function so
 	assert() if it is being called from an interrupt context.  Only API
 	functions that end in "FromISR" can be used in an interrupt.  Only assert if
 	the critical nesting count is 1 to protect against recursive calls if the
 	assert function also uses a critical section. */
-	if( ulCriticalNesting == 1 )
+	if( ulCriticalNesting[ portGET_CORE_ID() ] == 1 )
 	{
-		configASSERT( ulPortInterruptNesting == 0 );
+		configASSERT( ulPortInterruptNesting[ portGET_CORE_ID() ] == 0 );
 	}
 }
 /*-----------------------------------------------------------*/
 
 void vPortExitCritical( void )
 {
-	if( ulCriticalNesting > portNO_CRITICAL_NESTING )
+	if( ulCriticalNesting[ portGET_CORE_ID() ] > portNO_CRITICAL_NESTING )
 	{
 		/* Decrement the nesting count as the critical section is being
 		exited. */
-		ulCriticalNesting--;
+		ulCriticalNesting[ portGET_CORE_ID() ]--;
 
 		/* If the nesting level has reached zero then all interrupt
 		priorities must be re-enabled. */
-		if( ulCriticalNesting == portNO_CRITICAL_NESTING )
+		if( ulCriticalNesting[ portGET_CORE_ID() ] == portNO_CRITICAL_NESTING )
 		{
 			/* Critical nesting has reached zero so all interrupt priorities
 			should be unmasked. */
@@ -462,30 +681,159 @@ void FreeRTOS_Tick_Handler( void )
 						"isb		\n" ::: "memory" );
 	portCPU_IRQ_ENABLE();
 
-	/* Increment the RTOS tick. */
+	/* Increment the RTOS tick.  With more than one core the ISR lock stops the
+	other cores changing the kernel's lists at the same time. */
+	#if ( configNUM_CORES > 1 )
+	{
+		portGET_ISR_LOCK();
+	}
+	#endif /* configNUM_CORES */
+
 	if( xTaskIncrementTick() != pdFALSE )
 	{
-		ulPortYieldRequired = pdTRUE;
+		ulPortYieldRequired[ portGET_CORE_ID() ] = pdTRUE;
 	}
 
+	#if ( configNUM_CORES > 1 )
+	{
+		portRELEASE_ISR_LOCK();
+	}
+	#endif /* configNUM_CORES */
+
 	/* Ensure all interrupt priorities are active again. */
 	portCLEAR_INTERRUPT_MASK();
 	configCLEAR_TICK_INTERRUPT();
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+	{
+	uint32_t ulControl, ulCounter, ulReloadValue, ulCompleteTickPeriods, ulCompletedTimerDecrements;
+	TickType_t xModifiableIdleTime;
+
+		/* Called by the idle task with the scheduler suspended.  The timer
+		can only count so many ticks. */
+		if( xExpectedIdleTime > ulMaximumPossibleSuppressedTicks )
+		{
+			xExpectedIdleTime = ulMaximumPossibleSuppressedTicks;
+		}
+
+		/* Interrupts are disabled in the CPU rather than masked in the GIC, so
+		an interrupt still ends the WFI below but is not taken until the tick
+		count has been corrected. */
+		portCPU_IRQ_DISABLE();
+
+		/* Stop the timer while it is reprogrammed. */
+		ulControl = portPRIVATE_TIMER_CONTROL_REGISTER;
+		portPRIVATE_TIMER_CONTROL_REGISTER = ulControl & ~portPRIVATE_TIMER_ENABLE_BIT;
+		ulCounter = portPRIVATE_TIMER_COUNTER_REGISTER;
+
+		/* Do not sleep if a task became ready since the scheduler was
+		suspended, or if a tick is already pending, as its event flag would
+		be mistaken for the end of the sleep. */
+		if( ( eTaskConfirmSleepModeStatus() == eAbortSleep ) ||
+			( ( portPRIVATE_TIMER_STATUS_REGISTER & portPRIVATE_TIMER_EVENT_BIT ) != 0UL ) )
+		{
+			portPRIVATE_TIMER_CONTROL_REGISTER = ulControl;
+			portCPU_IRQ_ENABLE();
+		}
+		else
+		{
+			/* Count the rest of this tick period, then xExpectedIdleTime - 1
+			more.  Writing the load register also writes the counter, and the
+			timer reloads with the same value if it expires. */
+			ulReloadValue = ulCounter + ( ulTimerCountsForOneTick * ( xExpectedIdleTime - 1UL ) );
+
+			if( ulReloadValue > configSTOPPED_TIMER_COMPENSATION )
+			{
+				ulReloadValue -= configSTOPPED_TIMER_COMPENSATION;
+			}
+
+			portPRIVATE_TIMER_LOAD_REGISTER = ulReloadValue;
+			portPRIVATE_TIMER_CONTROL_REGISTER = ulControl;
+
+			/* The pre-sleep processing can set xModifiableIdleTime to 0 to
+			sleep in its own way instead. */
+			xModifiableIdleTime = xExpectedIdleTime;
+			configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+
+			if( xModifiableIdleTime > 0 )
+			{
+				__asm volatile (	"DSB		\n"
+									"WFI		\n"
+									"ISB		\n" ::: "memory" );
+			}
+
+			configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+			portPRIVATE_TIMER_CONTROL_REGISTER = ulControl & ~portPRIVATE_TIMER_ENABLE_BIT;
+			ulCounter = portPRIVATE_TIMER_COUNTER_REGISTER;
+
+			if( ( portPRIVATE_TIMER_STATUS_REGISTER & portPRIVATE_TIMER_EVENT_BIT ) != 0UL )
+			{
+				/* The timer expired and has reloaded, so the tick interrupt is
+				pending and will add the last tick when interrupts are enabled.
+				The rest of the next tick period is a period less the counts
+				since the timer expired. */
+				ulCounter = ( ulTimerCountsForOneTick - 1UL ) - ( ulReloadValue - ulCounter );
+
+				/* Don't allow a tiny value, or values that have somehow
+				underflowed because the post sleep hook did something that took
+				too long. */
+				if( ( ulCounter < configSTOPPED_TIMER_COMPENSATION ) || ( ulCounter > ulTimerCountsForOneTick ) )
+				{
+					ulCounter = ulTimerCountsForOneTick - 1UL;
+				}
+
+				ulCompleteTickPeriods = xExpectedIdleTime - 1UL;
+			}
+			else
+			{
+				/* Another interrupt ended the sleep.  Work out how many whole
+				tick periods passed, and how much of the current one is left. */
+				ulCompletedTimerDecrements = ( xExpectedIdleTime * ulTimerCountsForOneTick ) - ulCounter;
+				ulCompleteTickPeriods = ulCompletedTimerDecrements / ulTimerCountsForOneTick;
+				ulCounter = ( ( ulCompleteTickPeriods + 1UL ) * ulTimerCountsForOneTick ) - ulCompletedTimerDecrements;
+			}
+
+			/* Restart the periodic tick from the rest of the current period.
+			The counter is written after the load register, which also writes
+			it. */
+			portPRIVATE_TIMER_LOAD_REGISTER = ulTimerCountsForOneTick - 1UL;
+			portPRIVATE_TIMER_COUNTER_REGISTER = ulCounter;
+			portPRIVATE_TIMER_CONTROL_REGISTER = ulControl;
+
+			vTaskStepTick( ulCompleteTickPeriods );
+
+			/* Take the interrupt that ended the sleep. */
+			portCPU_IRQ_ENABLE();
+		}
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
 #if( configUSE_TASK_FPU_SUPPORT != 2 )
 
 	void vPortTaskUsesFPU( void )
 	{
 	uint32_t ulInitialFPSCR = 0;
+	uint32_t ulMask;
+
+		/* Interrupts are masked so the task cannot move to another core
+		between selecting the flag and initialising the FPU. */
+		ulMask = ulPortSetInterruptMask();
 
 		/* A task is registering the fact that it needs an FPU context.  Set the
 		FPU flag (which is saved as part of the task context). */
-		ulPortTaskHasFPUContext = pdTRUE;
+		ulPortTaskHasFPUContext[ portGET_CORE_ID() ] = pdTRUE;
 
 		/* Initialise the floating point status register. */
 		__asm volatile ( "FMXR 	FPSCR, %0" :: "r" (ulInitialFPSCR) : "memory" );
+
+		vPortClearInterruptMask( ulMask );
 	}
 
 #endif /* configUSE_TASK_FPU_SUPPORT */
@@ -76,17 +76,23 @@ not need to be guarded with a critical section. */
 /* Called at the end of an ISR that can cause a context switch. */
 #define portEND_SWITCHING_ISR( xSwitchRequired )\
 {												\
-extern uint32_t ulPortYieldRequired;			\
+extern volatile uint32_t ulPortYieldRequired[];	\
 												\
 	if( xSwitchRequired != pdFALSE )			\
 	{											\
-		ulPortYieldRequired = pdTRUE;			\
+		ulPortYieldRequired[ portGET_CORE_ID() ] = pdTRUE;	\
 	}											\
 }
 
 #define portYIELD_FROM_ISR( x ) portEND_SWITCHING_ISR( x )
 #define portYIELD() __asm volatile ( "SWI 0" ::: "memory" );
 
+/* Tickless idle, see vPortSuppressTicksAndSleep() in port.c. */
+#if( configUSE_TICKLESS_IDLE == 1 )
+	extern void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif /* configUSE_TICKLESS_IDLE */
+
 
 /*-----------------------------------------------------------
  * Critical section control
@@ -107,6 +113,78 @@ interrupts that have a priority below configMAX_API_CALL_INTERRUPT_PRIORITY. */
 #define portSET_INTERRUPT_MASK_FROM_ISR()		ulPortSetInterruptMask()
 #define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)	vPortClearInterruptMask(x)
 
+/*-----------------------------------------------------------
+ * Multi-core support
+ *----------------------------------------------------------*/
+
+/* The core executing, from the MPIDR.  Only stable while interrupts are
+masked, as a task can be moved to another core when they are not.  With a
+single core the kernel runs on CPU0, or on whichever CPU runs it in an AMP
+system, and the per-core variables of the port have one entry. */
+#if ( configNUM_CORES > 1 )
+
+	#define portMPIDR_CPU_ID_MASK	( 0x03UL )
+
+	__attribute__(( always_inline )) static inline BaseType_t xPortGetCoreID( void )
+	{
+	uint32_t ulMPIDR;
+
+		__asm volatile ( "MRC p15, 0, %0, c0, c0, 5" : "=r" ( ulMPIDR ) );
+		return ( BaseType_t ) ( ulMPIDR & portMPIDR_CPU_ID_MASK );
+	}
+
+	#define portGET_CORE_ID()	xPortGetCoreID()
+
+#else
+
+	#define portGET_CORE_ID()	0
+
+#endif /* configNUM_CORES */
+
+#if ( configNUM_CORES > 1 )
+
+	/* The software generated interrupt another core is sent to make it
+	select a new task.  It must not be used by the application. */
+	#ifndef configYIELD_CORE_SGI_ID
+		#define configYIELD_CORE_SGI_ID		( 0UL )
+	#endif
+
+	/* Interrupts the core xCoreID with the yield SGI.  The DSB makes the
+	kernel's writes visible to that core before the interrupt is taken. */
+	#define portYIELD_CORE( xCoreID )																				\
+	{																												\
+		__asm volatile ( "DSB" ::: "memory" );																		\
+		portICDSGIR_REGISTER = ( ( 1UL << ( uint32_t ) ( xCoreID ) ) << portICDSGIR_TARGET_LIST_SHIFT ) | configYIELD_CORE_SGI_ID;	\
+	}
+
+	/* The two kernel locks.  They are recursive, and owned by a core rather
+	than by a task. */
+	extern void vPortRecursiveLock( uint32_t ulLockNum, BaseType_t xAcquire );
+
+	#define portTASK_LOCK					( 0UL )
+	#define portISR_LOCK					( 1UL )
+	#define portGET_TASK_LOCK()				vPortRecursiveLock( portTASK_LOCK, pdTRUE )
+	#define portRELEASE_TASK_LOCK()			vPortRecursiveLock( portTASK_LOCK, pdFALSE )
+	#define portGET_ISR_LOCK()				vPortRecursiveLock( portISR_LOCK, pdTRUE )
+	#define portRELEASE_ISR_LOCK()			vPortRecursiveLock( portISR_LOCK, pdFALSE )
+
+	/* The critical nesting count is saved as part of the task context, so the
+	count of the running task is the count of the core. */
+	extern volatile uint32_t ulCriticalNesting[];
+	extern volatile uint32_t ulPortInterruptNesting[];
+
+	#define portGET_CRITICAL_NESTING_COUNT()		( ulCriticalNesting[ portGET_CORE_ID() ] )
+	#define portINCREMENT_CRITICAL_NESTING_COUNT()	( ulCriticalNesting[ portGET_CORE_ID() ]++ )
+	#define portDECREMENT_CRITICAL_NESTING_COUNT()	( ulCriticalNesting[ portGET_CORE_ID() ]-- )
+	#define portCHECK_IF_IN_ISR()					( ( ulPortInterruptNesting[ portGET_CORE_ID() ] != 0UL ) ? pdTRUE : pdFALSE )
+
+	/* Called by each core other than core 0, once configSTART_SECONDARY_CORES()
+	has released it and its stacks, vector table, MMU and caches are set up,
+	to start the first task selected for it. */
+	void vPortStartSecondaryCore( void );
+
+#endif /* configNUM_CORES */
+
 /*-----------------------------------------------------------*/
 
 /* Task function macros as described on the FreeRTOS.org WEB site.  These are
@@ -136,9 +214,14 @@ by default. */
 #define portLOWEST_INTERRUPT_PRIORITY ( ( ( uint32_t ) configUNIQUE_INTERRUPT_PRIORITIES ) - 1UL )
 #define portLOWEST_USABLE_INTERRUPT_PRIORITY ( portLOWEST_INTERRUPT_PRIORITY - 1UL )
 
-/* Architecture specific optimisations. */
+/* Architecture specific optimisations.  The generic task selection is
+required for more than one core. */
 #ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
-	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+	#if ( configNUM_CORES > 1 )
+		#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+	#else
+		#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+	#endif
 #endif
 
 #if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
@@ -202,5 +285,10 @@ number of bits implemented by the interrupt controller. */
 #define portICCBPR_BINARY_POINT_REGISTER 					( *( ( const volatile uint32_t * ) ( portINTERRUPT_CONTROLLER_CPU_INTERFACE_ADDRESS + portICCBPR_BINARY_POINT_OFFSET ) ) )
 #define portICCRPR_RUNNING_PRIORITY_REGISTER 				( *( ( const volatile uint32_t * ) ( portINTERRUPT_CONTROLLER_CPU_INTERFACE_ADDRESS + portICCRPR_RUNNING_PRIORITY_OFFSET ) ) )
 
+/* The distributor's software generated interrupt register. */
+#define portICDSGIR_SOFTWARE_INTERRUPT_OFFSET					( 0xF00 )
+#define portICDSGIR_TARGET_LIST_SHIFT						( 16UL )
+#define portICDSGIR_REGISTER								( *( ( volatile uint32_t * ) ( configINTERRUPT_CONTROLLER_BASE_ADDRESS + portICDSGIR_SOFTWARE_INTERRUPT_OFFSET ) ) )
+
 #endif /* PORTMACRO_H */
 
@@ -0,0 +1,957 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the Linux simulator.
+ *
+ * Every task runs in its own pthread, which waits on a semaphore whenever the
+ * task is not running.  A simulated core is the one task thread released to
+ * run on it, so the kernel's per-core state is exercised with real
+ * parallelism.  The interrupt mask and the critical nesting count are per
+ * thread, which is equivalent to saving them in each task's context as the
+ * Cortex-A9 port does.
+ *
+ * Simulated interrupts are pending bits per core.  Raising one sends SIGUSR1
+ * to the thread running on the core; the handler services the bits unless the
+ * thread has interrupts masked, in which case they are serviced when it
+ * unmasks them.  Context switches are performed by servicing the yield
+ * interrupt: the running thread calls vTaskSwitchContext(), releases the
+ * thread of the selected task and waits to be released again.
+ *
+ * The tick interrupt is raised by a virtual timer, a down counter clocked from
+ * the host's monotonic clock that reloads when it reaches zero, like the
+ * Cortex-A9 private timer.  Tickless idle reprograms it in the same way as the
+ * Cortex-A9 port, so its tick suppression and compensation can be tested on
+ * the host.
+ *
+ * Tasks should not call C library functions that take locks, such as printf()
+ * or malloc(), as they can be switched out part way through.
+ *----------------------------------------------------------*/
+
+/* Standard includes. */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifndef configTICK_RATE_HZ
+	#error configTICK_RATE_HZ must be defined.
+#endif
+
+/* The bit of an interrupt in ulPendingInterrupts[]. */
+#define portINTERRUPT_BIT( ulInterruptNumber )	( 1UL << ( ulInterruptNumber ) )
+
+/* The virtual timer counts in microseconds. */
+#define portTIMER_COUNTS_PER_SECOND	( 1000000UL )
+#define portTIMER_NS_PER_COUNT		( 1000000000UL / portTIMER_COUNTS_PER_SECOND )
+#define portTIMER_COUNTS_PER_TICK	( portTIMER_COUNTS_PER_SECOND / configTICK_RATE_HZ )
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	/* The most ticks the virtual timer can count. */
+	#define portMAX_SUPPRESSED_TICKS	( 0xffffffffUL / portTIMER_COUNTS_PER_TICK )
+
+	/* An estimate of the timer counts lost while the timer is stopped to be
+	reprogrammed.  The virtual timer loses none, see prvStartTimer(). */
+	#ifndef configSTOPPED_TIMER_COMPENSATION
+		#define configSTOPPED_TIMER_COMPENSATION	( 0UL )
+	#endif
+
+#endif /* configUSE_TICKLESS_IDLE */
+
+/* The signal used to deliver simulated interrupts. */
+#define portINTERRUPT_SIGNAL		SIGUSR1
+
+/* The number of kernel locks provided to the SMP kernel. */
+#define portNUM_LOCKS				( 2 )
+
+/* Owner of a lock that is not held. */
+#define portLOCK_NOT_HELD			( ( BaseType_t ) -1 )
+
+/*-----------------------------------------------------------*/
+
+/* The host side of a task.  It is stored at the top of the task's stack, and
+pxTopOfStack, the first member of the TCB, points to it. */
+typedef struct THREAD
+{
+	pthread_t xThread;					/* The pthread running the task. */
+	pid_t xThreadID;					/* The kernel thread ID signals are sent to, 0 until the thread has started. */
+	sem_t xWakeUp;						/* Posted to let the task run. */
+	TaskFunction_t pxCode;				/* The task function. */
+	void *pvParameters;					/* The task function parameter. */
+	volatile BaseType_t xCoreID;		/* The core the task runs on, set before xWakeUp is posted. */
+	volatile BaseType_t xDying;			/* Set when the task has been deleted and its thread must exit. */
+} Thread_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The function run by every task thread.
+ */
+static void *prvThreadEntry( void *pvParameters );
+
+/*
+ * Block the calling thread until it is next selected to run.
+ */
+static void prvWaitToRun( Thread_t *pxThread );
+
+/*
+ * Service the interrupts pending on the calling thread's core, switching to
+ * another task if the kernel requests it.  Called with interrupts masked and
+ * returns with them unmasked.
+ */
+static void prvServiceInterrupts( void );
+
+/*
+ * Select the next task to run on the calling thread's core and, if it is not
+ * the calling task, release its thread and wait.
+ */
+static void prvSwitchThread( void );
+
+/*
+ * Raise the simulated interrupts in ulInterrupts on core xCoreID.
+ */
+static void prvGenerateInterrupt( BaseType_t xCoreID, uint32_t ulInterrupts );
+
+/*
+ * The SIGUSR1 handler.
+ */
+static void prvInterruptSignalHandler( int lSignal );
+
+/*
+ * The thread that runs the virtual timer, which raises the tick interrupt on
+ * core 0.
+ */
+static void *prvTimerThread( void *pvParameters );
+
+/*
+ * Raise the tick interrupt for each time the virtual timer has reached zero,
+ * and reload it.  Called with xTimerMutex held.
+ */
+static void prvUpdateTimer( void );
+
+/*
+ * Start the virtual timer counting down from ulCounter, reloading ulLoad each
+ * time it reaches zero.  If the timer was stopped, it counts from the time it
+ * was stopped.
+ */
+static void prvStartTimer( uint32_t ulCounter, uint32_t ulLoad );
+
+/*
+ * The host's monotonic clock in nanoseconds.
+ */
+static uint64_t prvGetHostTime( void );
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	/*
+	 * Stop the virtual timer, and return its counter.
+	 */
+	static uint32_t prvStopTimer( void );
+
+	/*
+	 * The equivalent of WFI with interrupts disabled: wait until an interrupt
+	 * is pending on the calling thread's core, without servicing it.
+	 */
+	static void prvWaitForInterrupt( void );
+
+#endif /* configUSE_TICKLESS_IDLE */
+
+/*-----------------------------------------------------------*/
+
+/* The current TCB of each core.  The first member of a TCB is pxTopOfStack,
+which points to the task's Thread_t. */
+#if ( configNUM_CORES > 1 )
+	extern void * volatile pxCurrentTCBs[ configNUM_CORES ];
+	#define portCURRENT_TCB( xCoreID )	( pxCurrentTCBs[ ( xCoreID ) ] )
+#else
+	extern void * volatile pxCurrentTCB;
+	#define portCURRENT_TCB( xCoreID )	( pxCurrentTCB )
+#endif /* configNUM_CORES */
+
+#define portTHREAD_FROM_TCB( pvTCB )	( *( ( Thread_t ** ) ( pvTCB ) ) )
+
+/* The thread running on each core, and the interrupts pending on each core. */
+static Thread_t * volatile pxCoreThreads[ configNUM_CORES ];
+static volatile uint32_t ulPendingInterrupts[ configNUM_CORES ];
+
+/* Per thread state.  pxThisThread is NULL in threads that are not tasks. */
+static __thread Thread_t *pxThisThread = NULL;
+static __thread volatile UBaseType_t uxInterruptsMasked = pdFALSE;
+static __thread volatile BaseType_t xInISR = pdFALSE;
+static __thread UBaseType_t uxCriticalNesting = 0;
+
+/* The kernel locks of the SMP kernel, as the owning core and a recursion
+count. */
+#if ( configNUM_CORES > 1 )
+	static volatile BaseType_t xLockOwners[ portNUM_LOCKS ] = { portLOCK_NOT_HELD, portLOCK_NOT_HELD };
+	static UBaseType_t uxLockCounts[ portNUM_LOCKS ];
+#endif /* configNUM_CORES */
+
+/* The handlers of the simulated interrupts. */
+static uint32_t ( *pvInterruptHandlers[ portMAX_INTERRUPTS ] )( void );
+
+/* The virtual timer, which reaches zero at ullTimerExpiry in host
+nanoseconds, and was stopped at ullTimerStopped if that is not zero.
+ulTimerExpirations counts the times it has reached zero that the
+tick interrupt has not serviced yet. */
+static pthread_mutex_t xTimerMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xTimerCondition;
+static BaseType_t xTimerEnabled = pdFALSE;
+static uint64_t ullTimerExpiry;
+static uint32_t ulTimerLoad;
+static uint64_t ullTimerStopped = 0;
+static volatile uint32_t ulTimerExpirations = 0;
+
+/* Used to stop the scheduler. */
+static pthread_t xTimerThread;
+static BaseType_t xTimerThreadRunning = pdFALSE;
+static sem_t xSchedulerEnd;
+
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+Thread_t *pxThread;
+pthread_attr_t xAttributes;
+UBaseType_t uxSavedInterruptStatus;
+int lResult;
+
+	/* The Thread_t is stored at the top of the stack, which is otherwise
+	unused as the task runs on the pthread's stack. */
+	pxThread = ( Thread_t * ) ( ( ( portPOINTER_SIZE_TYPE ) ( pxTopOfStack + 1 ) - sizeof( Thread_t ) ) & ~( ( portPOINTER_SIZE_TYPE ) 15 ) );
+	pxThread->xThreadID = 0;
+	pxThread->pxCode = pxCode;
+	pxThread->pvParameters = pvParameters;
+	pxThread->xCoreID = 0;
+	pxThread->xDying = pdFALSE;
+	lResult = sem_init( &( pxThread->xWakeUp ), 0, 0 );
+	configASSERT( lResult == 0 );
+
+	/* pthread_create() takes C library locks, so the calling task must not
+	be switched out while it runs. */
+	uxSavedInterruptStatus = uxPortSetInterruptMask();
+	{
+		pthread_attr_init( &xAttributes );
+		pthread_attr_setstacksize( &xAttributes, PTHREAD_STACK_MIN + ( configMINIMAL_STACK_SIZE * sizeof( StackType_t ) * 8 ) );
+		lResult = pthread_create( &( pxThread->xThread ), &xAttributes, prvThreadEntry, pxThread );
+		pthread_attr_destroy( &xAttributes );
+	}
+	vPortClearInterruptMask( uxSavedInterruptStatus );
+
+	configASSERT( lResult == 0 );
+	( void ) lResult;
+
+	return ( StackType_t * ) pxThread;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvThreadEntry( void *pvParameters )
+{
+Thread_t * const pxThread = ( Thread_t * ) pvParameters;
+sigset_t xSignals;
+
+	pxThisThread = pxThread;
+	uxInterruptsMasked = pdTRUE;
+	pxThread->xThreadID = ( pid_t ) syscall( SYS_gettid );
+
+	/* The thread may have been created from within the signal handler. */
+	sigemptyset( &xSignals );
+	sigaddset( &xSignals, portINTERRUPT_SIGNAL );
+	pthread_sigmask( SIG_UNBLOCK, &xSignals, NULL );
+
+	prvWaitToRun( pxThread );
+
+	/* Tasks start outside of a critical section with interrupts enabled. */
+	uxCriticalNesting = 0;
+	vPortClearInterruptMask( pdFALSE );
+
+	pxThread->pxCode( pxThread->pvParameters );
+
+	/* Task functions must not return. */
+	configASSERT( pdFALSE );
+	vTaskDelete( NULL );
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitToRun( Thread_t *pxThread )
+{
+	/* sem_wait() returns early if the thread is signalled, which is ignored
+	as interrupts are masked. */
+	while( sem_wait( &( pxThread->xWakeUp ) ) != 0 )
+	{
+		configASSERT( errno == EINTR );
+	}
+
+	if( pxThread->xDying != pdFALSE )
+	{
+		pthread_exit( NULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+struct sigaction xAction;
+sigset_t xSignals;
+pthread_condattr_t xConditionAttributes;
+Thread_t *pxThread;
+BaseType_t xCoreID;
+
+	sem_init( &xSchedulerEnd, 0, 0 );
+
+	pthread_condattr_init( &xConditionAttributes );
+	pthread_condattr_setclock( &xConditionAttributes, CLOCK_MONOTONIC );
+	pthread_cond_init( &xTimerCondition, &xConditionAttributes );
+	pthread_condattr_destroy( &xConditionAttributes );
+
+	xAction.sa_handler = prvInterruptSignalHandler;
+	xAction.sa_flags = 0;
+	sigfillset( &xAction.sa_mask );
+	sigaction( portINTERRUPT_SIGNAL, &xAction, NULL );
+
+	/* Only task threads service simulated interrupts. */
+	sigemptyset( &xSignals );
+	sigaddset( &xSignals, portINTERRUPT_SIGNAL );
+	pthread_sigmask( SIG_BLOCK, &xSignals, NULL );
+
+	/* The kernel has selected the first task of each core. */
+	for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUM_CORES; xCoreID++ )
+	{
+		pxThread = portTHREAD_FROM_TCB( portCURRENT_TCB( xCoreID ) );
+		pxThread->xCoreID = xCoreID;
+		pxCoreThreads[ xCoreID ] = pxThread;
+	}
+
+	xTimerThreadRunning = pdTRUE;
+	prvStartTimer( portTIMER_COUNTS_PER_TICK, portTIMER_COUNTS_PER_TICK );
+	pthread_create( &xTimerThread, NULL, prvTimerThread, NULL );
+
+	for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUM_CORES; xCoreID++ )
+	{
+		sem_post( &( pxCoreThreads[ xCoreID ]->xWakeUp ) );
+	}
+
+	/* Wait for vPortEndScheduler(). */
+	while( sem_wait( &xSchedulerEnd ) != 0 )
+	{
+	}
+
+	pthread_mutex_lock( &xTimerMutex );
+	xTimerThreadRunning = pdFALSE;
+	pthread_cond_signal( &xTimerCondition );
+	pthread_mutex_unlock( &xTimerMutex );
+	pthread_join( xTimerThread, NULL );
+
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+	/* Return from xPortStartScheduler() in the thread that called
+	vTaskStartScheduler().  The calling task, and the tasks running on the
+	other cores, are left where they are. */
+	uxInterruptsMasked = pdTRUE;
+	sem_post( &xSchedulerEnd );
+
+	for( ;; )
+	{
+		pause();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void *prvTimerThread( void *pvParameters )
+{
+struct timespec xExpiry;
+sigset_t xSignals;
+
+	( void ) pvParameters;
+
+	sigemptyset( &xSignals );
+	sigaddset( &xSignals, portINTERRUPT_SIGNAL );
+	pthread_sigmask( SIG_BLOCK, &xSignals, NULL );
+
+	pthread_mutex_lock( &xTimerMutex );
+
+	while( xTimerThreadRunning != pdFALSE )
+	{
+		prvUpdateTimer();
+
+		if( xTimerEnabled == pdFALSE )
+		{
+			pthread_cond_wait( &xTimerCondition, &xTimerMutex );
+		}
+		else
+		{
+			xExpiry.tv_sec = ( time_t ) ( ullTimerExpiry / 1000000000ULL );
+			xExpiry.tv_nsec = ( long ) ( ullTimerExpiry % 1000000000ULL );
+			( void ) pthread_cond_timedwait( &xTimerCondition, &xTimerMutex, &xExpiry );
+		}
+	}
+
+	pthread_mutex_unlock( &xTimerMutex );
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateTimer( void )
+{
+	if( xTimerEnabled != pdFALSE )
+	{
+		/* Reload from the expiry rather than from now, so the timer keeps time
+		when this thread runs late.  The host can hold up the thread on core 0
+		for longer than a tick period, so expirations are counted rather than
+		lost while the tick interrupt is pending, and the tick count keeps host
+		time. */
+		while( prvGetHostTime() >= ullTimerExpiry )
+		{
+			ullTimerExpiry += ( uint64_t ) ulTimerLoad * portTIMER_NS_PER_COUNT;
+			__atomic_fetch_add( &ulTimerExpirations, 1, __ATOMIC_SEQ_CST );
+			prvGenerateInterrupt( 0, portINTERRUPT_BIT( portINTERRUPT_TICK ) );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvStartTimer( uint32_t ulCounter, uint32_t ulLoad )
+{
+	pthread_mutex_lock( &xTimerMutex );
+	{
+		/* The host can run other threads between stopping and starting the
+		timer, for much longer than the time the Cortex-A9 private timer is
+		stopped for, so rather than losing that time the virtual timer is
+		started again as if it had not been stopped. */
+		if( ullTimerStopped == 0ULL )
+		{
+			ullTimerStopped = prvGetHostTime();
+		}
+
+		ullTimerExpiry = ullTimerStopped + ( ( uint64_t ) ulCounter * portTIMER_NS_PER_COUNT );
+		ullTimerStopped = 0ULL;
+		ulTimerLoad = ulLoad;
+		xTimerEnabled = pdTRUE;
+		pthread_cond_signal( &xTimerCondition );
+	}
+	pthread_mutex_unlock( &xTimerMutex );
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvGetHostTime( void )
+{
+struct timespec xNow;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+	return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static void prvGenerateInterrupt( BaseType_t xCoreID, uint32_t ulInterrupts )
+{
+Thread_t *pxThread;
+pid_t xThreadID;
+
+	__atomic_fetch_or( &( ulPendingInterrupts[ xCoreID ] ), ulInterrupts, __ATOMIC_SEQ_CST );
+
+	/* The thread read here may already have been switched out, or even
+	deleted.  Either way the signal is harmless: a thread only services the
+	interrupts of the core it is running on, and the thread that runs on the
+	core next checks the pending bits before it unmasks interrupts.  The
+	Thread_t is in the kernel heap, so reading it after the task is freed is
+	safe, and tgkill() only signals threads of this process. */
+	pxThread = __atomic_load_n( &( pxCoreThreads[ xCoreID ] ), __ATOMIC_SEQ_CST );
+
+	if( ( pxThread != NULL ) && ( pxThread != pxThisThread ) )
+	{
+		xThreadID = pxThread->xThreadID;
+
+		if( xThreadID != 0 )
+		{
+			( void ) syscall( SYS_tgkill, getpid(), xThreadID, portINTERRUPT_SIGNAL );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvInterruptSignalHandler( int lSignal )
+{
+const int lSavedErrno = errno;
+
+	( void ) lSignal;
+
+	if( ( pxThisThread != NULL ) && ( __atomic_load_n( &uxInterruptsMasked, __ATOMIC_SEQ_CST ) == pdFALSE ) )
+	{
+		uxInterruptsMasked = pdTRUE;
+		prvServiceInterrupts();
+	}
+
+	errno = lSavedErrno;
+}
+/*-----------------------------------------------------------*/
+
+static void prvServiceInterrupts( void )
+{
+uint32_t ulInterrupts;
+uint32_t ulInterruptNumber;
+uint32_t ulTicks;
+BaseType_t xSwitchRequired;
+
+	for( ;; )
+	{
+		/* The core can change when the thread is switched out, so it is read
+		again on every pass. */
+		ulInterrupts = __atomic_exchange_n( &( ulPendingInterrupts[ pxThisThread->xCoreID ] ), 0, __ATOMIC_SEQ_CST );
+
+		if( ulInterrupts == 0UL )
+		{
+			/* Interrupts raised while they were masked were not serviced by
+			the signal handler, so check again once they are unmasked. */
+			__atomic_store_n( &uxInterruptsMasked, pdFALSE, __ATOMIC_SEQ_CST );
+
+			if( __atomic_load_n( &( ulPendingInterrupts[ pxThisThread->xCoreID ] ), __ATOMIC_SEQ_CST ) == 0UL )
+			{
+				break;
+			}
+
+			uxInterruptsMasked = pdTRUE;
+			continue;
+		}
+
+		xSwitchRequired = ( ( ulInterrupts & portINTERRUPT_BIT( portINTERRUPT_YIELD ) ) != 0UL ) ? pdTRUE : pdFALSE;
+
+		if( ( ulInterrupts & portINTERRUPT_BIT( portINTERRUPT_TICK ) ) != 0UL )
+		{
+			xInISR = pdTRUE;
+
+			#if ( configNUM_CORES > 1 )
+			{
+				portGET_ISR_LOCK();
+			}
+			#endif /* configNUM_CORES */
+
+			/* One tick for each expiration of the virtual timer. */
+			for( ulTicks = __atomic_exchange_n( &ulTimerExpirations, 0, __ATOMIC_SEQ_CST ); ulTicks > 0UL; ulTicks-- )
+			{
+				if( xTaskIncrementTick() != pdFALSE )
+				{
+					xSwitchRequired = pdTRUE;
+				}
+			}
+
+			#if ( configNUM_CORES > 1 )
+			{
+				portRELEASE_ISR_LOCK();
+			}
+			#endif /* configNUM_CORES */
+
+			xInISR = pdFALSE;
+		}
+
+		/* The application's interrupts, lowest number first.  They take any
+		kernel locks they need through the FromISR functions. */
+		for( ulInterruptNumber = portINTERRUPT_TICK + 1UL; ulInterruptNumber < portMAX_INTERRUPTS; ulInterruptNumber++ )
+		{
+			if( ( ( ulInterrupts & portINTERRUPT_BIT( ulInterruptNumber ) ) != 0UL ) && ( pvInterruptHandlers[ ulInterruptNumber ] != NULL ) )
+			{
+				xInISR = pdTRUE;
+
+				if( pvInterruptHandlers[ ulInterruptNumber ]() != pdFALSE )
+				{
+					xSwitchRequired = pdTRUE;
+				}
+
+				xInISR = pdFALSE;
+			}
+		}
+
+		if( xSwitchRequired != pdFALSE )
+		{
+			prvSwitchThread();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchThread( void )
+{
+Thread_t * const pxOldThread = pxThisThread;
+const BaseType_t xCoreID = pxOldThread->xCoreID;
+Thread_t *pxNewThread;
+
+	vTaskSwitchContext();
+
+	/* Only this core changes its current TCB. */
+	pxNewThread = portTHREAD_FROM_TCB( portCURRENT_TCB( xCoreID ) );
+
+	if( pxNewThread != pxOldThread )
+	{
+		pxNewThread->xCoreID = xCoreID;
+		__atomic_store_n( &( pxCoreThreads[ xCoreID ] ), pxNewThread, __ATOMIC_SEQ_CST );
+		sem_post( &( pxNewThread->xWakeUp ) );
+
+		/* Another core may select this task, and post its semaphore, before
+		the thread reaches prvWaitToRun(). */
+		prvWaitToRun( pxOldThread );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	__atomic_fetch_or( &( ulPendingInterrupts[ pxThisThread->xCoreID ] ), portINTERRUPT_BIT( portINTERRUPT_YIELD ), __ATOMIC_SEQ_CST );
+
+	/* Within a critical section the yield is performed when interrupts are
+	unmasked. */
+	if( uxInterruptsMasked == pdFALSE )
+	{
+		uxInterruptsMasked = pdTRUE;
+		prvServiceInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldFromISR( void )
+{
+	/* Serviced after the current simulated interrupt returns. */
+	__atomic_fetch_or( &( ulPendingInterrupts[ pxThisThread->xCoreID ] ), portINTERRUPT_BIT( portINTERRUPT_YIELD ), __ATOMIC_SEQ_CST );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortSetInterruptMask( void )
+{
+const UBaseType_t uxWasMasked = uxInterruptsMasked;
+
+	__atomic_store_n( &uxInterruptsMasked, pdTRUE, __ATOMIC_SEQ_CST );
+
+	return uxWasMasked;
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t uxNewMaskValue )
+{
+	if( ( uxNewMaskValue == pdFALSE ) && ( uxInterruptsMasked != pdFALSE ) )
+	{
+		if( pxThisThread != NULL )
+		{
+			prvServiceInterrupts();
+		}
+		else
+		{
+			uxInterruptsMasked = pdFALSE;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	( void ) uxPortSetInterruptMask();
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	if( uxCriticalNesting > 0U )
+	{
+		uxCriticalNesting--;
+
+		if( uxCriticalNesting == 0U )
+		{
+			vPortClearInterruptMask( pdFALSE );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortGenerateSimulatedInterrupt( uint32_t ulInterruptNumber )
+{
+	configASSERT( ulInterruptNumber < portMAX_INTERRUPTS );
+
+	prvGenerateInterrupt( 0, portINTERRUPT_BIT( ulInterruptNumber ) );
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetInterruptHandler( uint32_t ulInterruptNumber, uint32_t ( *pvHandler )( void ) )
+{
+	configASSERT( ( ulInterruptNumber > portINTERRUPT_TICK ) && ( ulInterruptNumber < portMAX_INTERRUPTS ) );
+
+	pvInterruptHandlers[ ulInterruptNumber ] = pvHandler;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+	{
+	uint32_t ulCounter, ulReloadValue, ulCompleteTickPeriods, ulCompletedTimerDecrements;
+	uint32_t ulExpirations, ulLateTimerDecrements;
+	TickType_t xModifiableIdleTime;
+
+		/* This follows vPortSuppressTicksAndSleep() in the Cortex-A9 port.
+		Called by the idle task with the scheduler suspended. */
+		if( xExpectedIdleTime > portMAX_SUPPRESSED_TICKS )
+		{
+			xExpectedIdleTime = portMAX_SUPPRESSED_TICKS;
+		}
+
+		/* A pending interrupt ends prvWaitForInterrupt() but is not serviced
+		until interrupts are unmasked. */
+		( void ) uxPortSetInterruptMask();
+
+		ulCounter = prvStopTimer();
+
+		if( ( eTaskConfirmSleepModeStatus() == eAbortSleep ) ||
+			( ( ulPendingInterrupts[ 0 ] & portINTERRUPT_BIT( portINTERRUPT_TICK ) ) != 0UL ) )
+		{
+			prvStartTimer( ulCounter, portTIMER_COUNTS_PER_TICK );
+			vPortClearInterruptMask( pdFALSE );
+		}
+		else
+		{
+			/* Count the rest of this tick period, then xExpectedIdleTime - 1
+			more.  The timer reloads with the same value if it expires. */
+			ulReloadValue = ulCounter + ( portTIMER_COUNTS_PER_TICK * ( xExpectedIdleTime - 1UL ) );
+
+			if( ulReloadValue > configSTOPPED_TIMER_COMPENSATION )
+			{
+				ulReloadValue -= configSTOPPED_TIMER_COMPENSATION;
+			}
+
+			prvStartTimer( ulReloadValue, ulReloadValue );
+
+			xModifiableIdleTime = xExpectedIdleTime;
+			configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+
+			if( xModifiableIdleTime > 0 )
+			{
+				prvWaitForInterrupt();
+			}
+
+			configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+			ulCounter = prvStopTimer();
+
+			if( ( ulPendingInterrupts[ 0 ] & portINTERRUPT_BIT( portINTERRUPT_TICK ) ) != 0UL )
+			{
+				/* The timer expired and has reloaded, so the tick interrupt is
+				pending and will add the last tick when interrupts are unmasked.
+				The virtual timer's period is its load value, where the
+				Cortex-A9 private timer's is one more.
+
+				Unlike the Cortex-A9, this thread may run well after the timer
+				expired, even after it expired again.  The tick periods that
+				passed since the first expiration are added to the ticks the
+				interrupt will add, as vTaskStepTick() must not step past the
+				expected idle time. */
+				ulExpirations = __atomic_exchange_n( &ulTimerExpirations, 0, __ATOMIC_SEQ_CST );
+				ulLateTimerDecrements = ( ( ulExpirations - 1UL ) * ulReloadValue ) + ( ulReloadValue - ulCounter );
+				ulCounter = portTIMER_COUNTS_PER_TICK - ( ulLateTimerDecrements % portTIMER_COUNTS_PER_TICK );
+				__atomic_store_n( &ulTimerExpirations, 1UL + ( ulLateTimerDecrements / portTIMER_COUNTS_PER_TICK ), __ATOMIC_SEQ_CST );
+
+				ulCompleteTickPeriods = xExpectedIdleTime - 1UL;
+			}
+			else
+			{
+				/* Another interrupt ended the sleep. */
+				ulCompletedTimerDecrements = ( xExpectedIdleTime * portTIMER_COUNTS_PER_TICK ) - ulCounter;
+				ulCompleteTickPeriods = ulCompletedTimerDecrements / portTIMER_COUNTS_PER_TICK;
+				ulCounter = ( ( ulCompleteTickPeriods + 1UL ) * portTIMER_COUNTS_PER_TICK ) - ulCompletedTimerDecrements;
+			}
+
+			prvStartTimer( ulCounter, portTIMER_COUNTS_PER_TICK );
+
+			vTaskStepTick( ulCompleteTickPeriods );
+
+			/* Service the interrupt that ended the sleep. */
+			vPortClearInterruptMask( pdFALSE );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvWaitForInterrupt( void )
+	{
+	sigset_t xSignals;
+	sigset_t xWaitSignals;
+
+		/* The signal is blocked while the pending interrupts are checked, and
+		only unblocked while waiting, so that one raised in between is not
+		missed.  The signal handler does nothing as interrupts are masked. */
+		sigemptyset( &xSignals );
+		sigaddset( &xSignals, portINTERRUPT_SIGNAL );
+		pthread_sigmask( SIG_BLOCK, &xSignals, &xWaitSignals );
+		sigdelset( &xWaitSignals, portINTERRUPT_SIGNAL );
+
+		while( __atomic_load_n( &( ulPendingInterrupts[ pxThisThread->xCoreID ] ), __ATOMIC_SEQ_CST ) == 0UL )
+		{
+			( void ) sigsuspend( &xWaitSignals );
+		}
+
+		pthread_sigmask( SIG_UNBLOCK, &xSignals, NULL );
+	}
+	/*-----------------------------------------------------------*/
+
+	static uint32_t prvStopTimer( void )
+	{
+	uint32_t ulCounter = 0UL;
+
+		pthread_mutex_lock( &xTimerMutex );
+		{
+			if( xTimerEnabled != pdFALSE )
+			{
+				/* Expire the timer first if it has reached zero and the timer
+				thread has not run yet.  The counter is rounded to the nearest
+				count, so that stopping and starting the timer does not move
+				its expirations on average. */
+				prvUpdateTimer();
+				ullTimerStopped = prvGetHostTime();
+				ulCounter = ( ullTimerExpiry > ullTimerStopped ) ? ( uint32_t ) ( ( ullTimerExpiry - ullTimerStopped + ( portTIMER_NS_PER_COUNT / 2UL ) ) / portTIMER_NS_PER_COUNT ) : 0UL;
+				xTimerEnabled = pdFALSE;
+			}
+		}
+		pthread_mutex_unlock( &xTimerMutex );
+
+		return ulCounter;
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+void vPortCleanUpTCB( void *pvTCB )
+{
+Thread_t * const pxThread = portTHREAD_FROM_TCB( pvTCB );
+UBaseType_t uxSavedInterruptStatus;
+
+	/* The task is not running, so its thread is waiting in prvWaitToRun(),
+	or about to.  pthread_join() must not be interrupted by a context
+	switch. */
+	uxSavedInterruptStatus = uxPortSetInterruptMask();
+	{
+		pxThread->xDying = pdTRUE;
+		sem_post( &( pxThread->xWakeUp ) );
+		pthread_join( pxThread->xThread, NULL );
+		sem_destroy( &( pxThread->xWakeUp ) );
+	}
+	vPortClearInterruptMask( uxSavedInterruptStatus );
+}
+/*-----------------------------------------------------------*/
+
+#if ( configNUM_CORES > 1 )
+
+	BaseType_t xPortGetCoreID( void )
+	{
+		/* Only stable while interrupts are masked, as they are whenever the
+		kernel reads it. */
+		return ( pxThisThread != NULL ) ? pxThisThread->xCoreID : 0;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortYieldCore( BaseType_t xCoreID )
+	{
+		prvGenerateInterrupt( xCoreID, portINTERRUPT_BIT( portINTERRUPT_YIELD ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t xPortCheckIfInISR( void )
+	{
+		return xInISR;
+	}
+	/*-----------------------------------------------------------*/
+
+	UBaseType_t uxPortGetCriticalNesting( void )
+	{
+		return uxCriticalNesting;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortSetCriticalNesting( UBaseType_t uxNesting )
+	{
+		uxCriticalNesting = uxNesting;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortRecursiveLock( UBaseType_t uxLockNum, BaseType_t xAcquire )
+	{
+	const BaseType_t xCoreID = xPortGetCoreID();
+	BaseType_t xExpected;
+
+		/* Called with interrupts masked, so the core cannot change. */
+		configASSERT( uxInterruptsMasked != pdFALSE );
+
+		if( xAcquire != pdFALSE )
+		{
+			if( __atomic_load_n( &( xLockOwners[ uxLockNum ] ), __ATOMIC_ACQUIRE ) == xCoreID )
+			{
+				uxLockCounts[ uxLockNum ]++;
+			}
+			else
+			{
+				for( ;; )
+				{
+					xExpected = portLOCK_NOT_HELD;
+
+					if( __atomic_compare_exchange_n( &( xLockOwners[ uxLockNum ] ), &xExpected, xCoreID, pdFALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) != pdFALSE )
+					{
+						break;
+					}
+
+					/* The owner may be a host thread that is not scheduled. */
+					sched_yield();
+				}
+
+				uxLockCounts[ uxLockNum ] = 1;
+			}
+		}
+		else
+		{
+			configASSERT( xLockOwners[ uxLockNum ] == xCoreID );
+
+			uxLockCounts[ uxLockNum ]--;
+
+			if( uxLockCounts[ uxLockNum ] == 0U )
+			{
+				__atomic_store_n( &( xLockOwners[ uxLockNum ] ), portLOCK_NOT_HELD, __ATOMIC_RELEASE );
+			}
+		}
+	}
+
+#endif /* configNUM_CORES */
@@ -0,0 +1,215 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+#include <stddef.h>
+
+/*-----------------------------------------------------------
+ * Port specific definitions.
+ *
+ * The settings in this file configure FreeRTOS correctly for the given hardware
+ * and compiler.
+ *
+ * These settings should not be altered.
+ *-----------------------------------------------------------
+ */
+
+/* Linux simulator.  Each task runs in its own pthread and each simulated core
+is the one task thread allowed to run on it at any time, so up to configNUM_CORES
+tasks run in parallel.  Interrupts are simulated: the tick comes from a virtual
+timer, cross-core yields from portYIELD_CORE() and application interrupts from
+vPortGenerateSimulatedInterrupt(), and all are delivered to the thread running
+on the target core with a signal. */
+
+/* Type definitions. */
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		short
+#define portSTACK_TYPE	size_t
+#define portBASE_TYPE	long
+#define portPOINTER_SIZE_TYPE size_t
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef uint16_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffff
+#else
+	typedef uint32_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffffffffUL
+
+	/* 32-bit tick type on a 32/64-bit architecture, so reads of the tick
+	count do not need to be guarded with a critical section. */
+	#define portTICK_TYPE_IS_ATOMIC 1
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* Hardware specifics. */
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_PERIOD_MS			( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT			8
+#define portINLINE					__inline
+#define portNOP()					__asm volatile( "" ::: "memory" )
+
+/*-----------------------------------------------------------*/
+
+/* Task utilities. */
+extern void vPortYield( void );
+extern void vPortYieldFromISR( void );
+
+#define portYIELD()									vPortYield()
+#define portEND_SWITCHING_ISR( xSwitchRequired )	do { if( ( xSwitchRequired ) != pdFALSE ) { vPortYieldFromISR(); } } while( 0 )
+#define portYIELD_FROM_ISR( x )						portEND_SWITCHING_ISR( x )
+
+/* The thread of a deleted task is stopped and joined when its TCB is freed. */
+extern void vPortCleanUpTCB( void *pvTCB );
+#define portCLEAN_UP_TCB( pxTCB )	vPortCleanUpTCB( pxTCB )
+
+/* Tickless idle, see vPortSuppressTicksAndSleep() in port.c. */
+#if( configUSE_TICKLESS_IDLE == 1 )
+	extern void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif /* configUSE_TICKLESS_IDLE */
+
+/*-----------------------------------------------------------
+ * Simulated interrupts
+ *----------------------------------------------------------*/
+
+/* The interrupt numbers used by the port itself. */
+#define portINTERRUPT_YIELD			( 0UL )
+#define portINTERRUPT_TICK			( 1UL )
+
+/* Interrupt numbers are below this. */
+#define portMAX_INTERRUPTS			( 32UL )
+
+/*
+ * Raise a simulated interrupt.  It is taken on core 0, like the peripheral
+ * interrupts of the Cortex-A9 port, and can be raised from any thread,
+ * including host threads that are not tasks.
+ */
+extern void vPortGenerateSimulatedInterrupt( uint32_t ulInterruptNumber );
+
+/*
+ * Install the handler of a simulated interrupt.  The interrupt number must be
+ * above the numbers used by the port, defined above, and below
+ * portMAX_INTERRUPTS.  The handler runs as an interrupt, so may only call the
+ * FromISR API functions, and must return pdTRUE if a context switch is
+ * required.
+ */
+extern void vPortSetInterruptHandler( uint32_t ulInterruptNumber, uint32_t ( *pvHandler )( void ) );
+
+/*-----------------------------------------------------------
+ * Critical section control
+ *----------------------------------------------------------*/
+
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+extern UBaseType_t uxPortSetInterruptMask( void );
+extern void vPortClearInterruptMask( UBaseType_t uxNewMaskValue );
+
+#define portENTER_CRITICAL()					vPortEnterCritical()
+#define portEXIT_CRITICAL()						vPortExitCritical()
+#define portDISABLE_INTERRUPTS()				( void ) uxPortSetInterruptMask()
+#define portENABLE_INTERRUPTS()					vPortClearInterruptMask( 0 )
+#define portSET_INTERRUPT_MASK_FROM_ISR()		uxPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )	vPortClearInterruptMask( x )
+
+/*-----------------------------------------------------------
+ * Multi-core support
+ *----------------------------------------------------------*/
+
+#if ( configNUM_CORES > 1 )
+
+	extern BaseType_t xPortGetCoreID( void );
+	extern void vPortYieldCore( BaseType_t xCoreID );
+	extern BaseType_t xPortCheckIfInISR( void );
+	extern void vPortRecursiveLock( UBaseType_t uxLockNum, BaseType_t xAcquire );
+	extern UBaseType_t uxPortGetCriticalNesting( void );
+	extern void vPortSetCriticalNesting( UBaseType_t uxNesting );
+
+	#define portGET_CORE_ID()						xPortGetCoreID()
+	#define portYIELD_CORE( xCoreID )				vPortYieldCore( xCoreID )
+	#define portCHECK_IF_IN_ISR()					xPortCheckIfInISR()
+
+	#define portTASK_LOCK							( 0U )
+	#define portISR_LOCK							( 1U )
+	#define portGET_TASK_LOCK()						vPortRecursiveLock( portTASK_LOCK, pdTRUE )
+	#define portRELEASE_TASK_LOCK()					vPortRecursiveLock( portTASK_LOCK, pdFALSE )
+	#define portGET_ISR_LOCK()						vPortRecursiveLock( portISR_LOCK, pdTRUE )
+	#define portRELEASE_ISR_LOCK()					vPortRecursiveLock( portISR_LOCK, pdFALSE )
+
+	#define portGET_CRITICAL_NESTING_COUNT()		uxPortGetCriticalNesting()
+	#define portINCREMENT_CRITICAL_NESTING_COUNT()	vPortSetCriticalNesting( uxPortGetCriticalNesting() + 1U )
+	#define portDECREMENT_CRITICAL_NESTING_COUNT()	vPortSetCriticalNesting( uxPortGetCriticalNesting() - 1U )
+
+#endif /* configNUM_CORES */
+
+/*-----------------------------------------------------------*/
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters )	void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters )	void vFunction( void *pvParameters )
+
+/* The generic task selection is used, as it is required for more than one
+core. */
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#endif
+
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+
+	/* Check the configuration. */
+	#if( configMAX_PRIORITIES > 32 )
+		#error configUSE_PORT_OPTIMISED_TASK_SELECTION can only be set to 1 when configMAX_PRIORITIES is less than or equal to 32.  It is very rare that a system requires more than 10 to 15 difference priorities as tasks that share a priority will time slice.
+	#endif
+
+	/* Store/clear the ready priorities in a bit map. */
+	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+
+	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = ( 31UL - ( uint32_t ) __builtin_clz( uxReadyPriorities ) )
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+
+#ifdef __cplusplus
+	} /* extern C */
+#endif
+
+#endif /* PORTMACRO_H */
+
@@ -0,0 +1,796 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * A sample implementation of pvPortMalloc() and vPortFree() that takes the same
+ * bounded time however many blocks the heap is divided into, using the two
+ * level segregated fit (TLSF) algorithm.  Like heap_4.c it combines adjacent
+ * free blocks, but rather than walking one list of free blocks it keeps a list
+ * per size class, with bitmaps of the lists that are not empty, so finding a
+ * large enough block is a couple of bit scans.
+ *
+ * Block sizes are divided into power of two ranges, the first levels, and each
+ * range into 2^heapSECOND_LEVEL_BITS equal classes, the second levels.  A
+ * request takes the first block of its own class if that is large enough, and
+ * otherwise is rounded up to the start of the next class, so any block in the
+ * first non-empty class at or above it is large enough.  Freeing looks up the
+ * neighbouring blocks through the physical links in the block headers.
+ *
+ * Statistics are kept for each first level size class, and when configHEAP_TAGS
+ * is greater than 0, for each of the tags that allocations can be labelled
+ * with, see uxPortSetHeapTag().
+ *
+ * See heap_1.c, heap_2.c, heap_3.c, heap_4.c and heap_5.c for alternative
+ * implementations, and the memory management pages of http://www.FreeRTOS.org
+ * for more information.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+#if( ( configHEAP_TAGS > 0 ) && defined( configHEAP_TAG_THREAD_LOCAL_INDEX ) )
+	#if( configHEAP_TAG_THREAD_LOCAL_INDEX >= configNUM_THREAD_LOCAL_STORAGE_POINTERS )
+		#error configHEAP_TAG_THREAD_LOCAL_INDEX must be less than configNUM_THREAD_LOCAL_STORAGE_POINTERS
+	#endif
+	#if( INCLUDE_xTaskGetCurrentTaskHandle != 1 )
+		#error INCLUDE_xTaskGetCurrentTaskHandle must be set to 1 to keep heap tags in thread local storage
+	#endif
+#endif
+
+/* The low bits of a block size are always clear, so the lowest marks the
+blocks that belong to the application. */
+#if portBYTE_ALIGNMENT == 32
+	#define heapALIGNMENT_BITS	( 5 )
+#elif portBYTE_ALIGNMENT == 16
+	#define heapALIGNMENT_BITS	( 4 )
+#elif portBYTE_ALIGNMENT == 8
+	#define heapALIGNMENT_BITS	( 3 )
+#elif portBYTE_ALIGNMENT == 4
+	#define heapALIGNMENT_BITS	( 2 )
+#else
+	#error heap_6.c requires portBYTE_ALIGNMENT to be at least 4
+#endif
+
+#define heapBLOCK_ALLOCATED_BIT	( ( size_t ) 1 )
+
+/* Each first level size class is divided into this many second level classes. */
+#define heapSECOND_LEVEL_BITS	( 4 )
+#define heapSECOND_LEVEL_COUNT	( 1UL << heapSECOND_LEVEL_BITS )
+
+/* Blocks smaller than heapSMALL_BLOCK_SIZE are all in first level 0, with one
+aligned size in each second level class.  First level n, from 1, holds blocks
+of at least 2^(heapFIRST_LEVEL_SHIFT + n - 1) bytes and less than twice that. */
+#define heapFIRST_LEVEL_SHIFT	( heapSECOND_LEVEL_BITS + heapALIGNMENT_BITS )
+#define heapSMALL_BLOCK_SIZE	( ( size_t ) 1 << heapFIRST_LEVEL_SHIFT )
+
+/* Blocks are smaller than 2^heapFIRST_LEVEL_LIMIT bytes. */
+#define heapFIRST_LEVEL_LIMIT	( 30 )
+#define heapFIRST_LEVEL_COUNT	( heapFIRST_LEVEL_LIMIT - heapFIRST_LEVEL_SHIFT + 1 )
+
+/* Bit scans of a non-zero 32-bit value.  They can be defined to use an
+instruction the compiler has no builtin for. */
+#ifndef heapFIND_FIRST_SET
+	#define heapFIND_FIRST_SET( ulValue )	( ( UBaseType_t ) __builtin_ctz( ( uint32_t ) ( ulValue ) ) )
+#endif
+#ifndef heapFIND_LAST_SET
+	#define heapFIND_LAST_SET( ulValue )	( ( UBaseType_t ) ( 31 - __builtin_clz( ( uint32_t ) ( ulValue ) ) ) )
+#endif
+
+/* Allocate the memory for the heap. */
+#if( configAPPLICATION_ALLOCATED_HEAP == 1 )
+	/* The application writer has already defined the array used for the RTOS
+	heap - probably so it can be placed in a special segment or address. */
+	extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#else
+	static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#endif /* configAPPLICATION_ALLOCATED_HEAP */
+
+/* The header at the start of each block.  The free list links are only used
+while the block is free, and are overlaid by the application's data while it
+is allocated. */
+typedef struct A_BLOCK_LINK
+{
+	struct A_BLOCK_LINK *pxPreviousPhysicalBlock;	/*<< The block before this one in memory, or NULL for the first block. */
+	size_t xBlockSize;								/*<< The size of the block, including this header, with heapBLOCK_ALLOCATED_BIT set if it is allocated. */
+	#if( configHEAP_TAGS > 0 )
+		UBaseType_t uxTag;							/*<< The tag the block was allocated with. */
+	#endif
+	struct A_BLOCK_LINK *pxNextFreeBlock;			/*<< The next free block in the block's size class. */
+	struct A_BLOCK_LINK *pxPreviousFreeBlock;		/*<< The previous free block in the block's size class. */
+} BlockLink_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Called automatically to setup the required heap structures the first time
+ * pvPortMalloc() is called.
+ */
+static void prvHeapInit( void );
+
+/*
+ * The first and second level size classes of a block size.
+ */
+static void prvMapBlockSize( size_t xBlockSize, UBaseType_t *puxFirstLevel, UBaseType_t *puxSecondLevel );
+
+/*
+ * Return a free block of at least xBlockSize bytes, or NULL if there is none
+ * that can be found without searching a list.  The block is still in its free
+ * list.
+ */
+static BlockLink_t *prvFindFreeBlock( size_t xBlockSize );
+
+/*
+ * Add a block to, or remove it from, the free list of its size class.
+ */
+static void prvInsertFreeBlock( BlockLink_t *pxBlock );
+static void prvRemoveFreeBlock( BlockLink_t *pxBlock );
+
+/*
+ * The first level size class of a block size, which its statistics are kept
+ * under.
+ */
+static UBaseType_t prvGetSizeClass( size_t xBlockSize );
+
+#if( configHEAP_TAGS > 0 )
+
+	/*
+	 * The tag to label a block allocated by the calling task with.
+	 */
+	static UBaseType_t prvGetCurrentTag( void );
+
+#endif /* configHEAP_TAGS */
+
+/*-----------------------------------------------------------*/
+
+/* The size of the header placed at the beginning of each allocated block, up to
+the free list links, correctly byte aligned. */
+static const size_t xHeapStructSize = ( offsetof( BlockLink_t, pxNextFreeBlock ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+/* Free blocks must be able to hold the whole header. */
+static const size_t xMinimumBlockSize = ( sizeof( BlockLink_t ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+/* Marks the end of the heap.  It is always allocated, so is never combined
+with the block before it. */
+static BlockLink_t *pxEnd = NULL;
+
+/* The free lists of the size classes, and bitmaps of the ones that are not
+empty. */
+static BlockLink_t *pxFreeBlocks[ heapFIRST_LEVEL_COUNT ][ heapSECOND_LEVEL_COUNT ];
+static uint32_t ulFirstLevelBitmap = 0U;
+static uint32_t ulSecondLevelBitmaps[ heapFIRST_LEVEL_COUNT ];
+
+/* Keeps track of the number of free bytes remaining, but says nothing about
+fragmentation. */
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+
+/* The statistics of each first level size class. */
+static HeapClassStats_t xClassStats[ heapFIRST_LEVEL_COUNT ];
+
+#if( configHEAP_TAGS > 0 )
+
+	static HeapTagStats_t xTagStats[ configHEAP_TAGS ];
+
+	#ifndef configHEAP_TAG_THREAD_LOCAL_INDEX
+		static UBaseType_t uxSharedTag = 0U;
+	#endif
+
+#endif /* configHEAP_TAGS */
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+BlockLink_t *pxBlock, *pxNewBlockLink;
+size_t xBlockSize;
+UBaseType_t uxClass;
+void *pvReturn = NULL;
+
+	vTaskSuspendAll();
+	{
+		/* If this is the first call to malloc then the heap will require
+		initialisation to setup the free lists. */
+		if( pxEnd == NULL )
+		{
+			prvHeapInit();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* Refuse sizes that could not be in any size class, before adding the
+		header could overflow. */
+		if( ( xWantedSize > 0 ) && ( xWantedSize < ( ( size_t ) 1 << ( heapFIRST_LEVEL_LIMIT - 1 ) ) ) )
+		{
+			/* The wanted size is increased so it can contain the header in
+			addition to the requested amount of bytes, and rounded up so that
+			blocks are always aligned. */
+			xBlockSize = ( xWantedSize + xHeapStructSize + ( size_t ) portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+			if( xBlockSize < xMinimumBlockSize )
+			{
+				xBlockSize = xMinimumBlockSize;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxBlock = prvFindFreeBlock( xBlockSize );
+
+			if( pxBlock != NULL )
+			{
+				prvRemoveFreeBlock( pxBlock );
+
+				/* If the block is larger than required it can be split into
+				two, and the remainder returned to the free lists. */
+				if( ( pxBlock->xBlockSize - xBlockSize ) >= xMinimumBlockSize )
+				{
+					pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xBlockSize );
+					configASSERT( ( ( ( size_t ) pxNewBlockLink ) & portBYTE_ALIGNMENT_MASK ) == 0 );
+
+					pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xBlockSize;
+					pxNewBlockLink->pxPreviousPhysicalBlock = pxBlock;
+					( ( BlockLink_t * ) ( ( ( uint8_t * ) pxNewBlockLink ) + pxNewBlockLink->xBlockSize ) )->pxPreviousPhysicalBlock = pxNewBlockLink;
+					pxBlock->xBlockSize = xBlockSize;
+
+					prvInsertFreeBlock( pxNewBlockLink );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				xFreeBytesRemaining -= pxBlock->xBlockSize;
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				uxClass = prvGetSizeClass( pxBlock->xBlockSize );
+				xClassStats[ uxClass ].xAllocations++;
+				xClassStats[ uxClass ].xBlocksInUse++;
+				xClassStats[ uxClass ].xBytesInUse += pxBlock->xBlockSize;
+
+				#if( configHEAP_TAGS > 0 )
+				{
+					pxBlock->uxTag = prvGetCurrentTag();
+					xTagStats[ pxBlock->uxTag ].xBlocksInUse++;
+					xTagStats[ pxBlock->uxTag ].xBytesInUse += pxBlock->xBlockSize;
+
+					if( xTagStats[ pxBlock->uxTag ].xBytesInUse > xTagStats[ pxBlock->uxTag ].xMaximumBytesInUse )
+					{
+						xTagStats[ pxBlock->uxTag ].xMaximumBytesInUse = xTagStats[ pxBlock->uxTag ].xBytesInUse;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				#endif /* configHEAP_TAGS */
+
+				/* The block is being returned - it is allocated and owned by
+				the application. */
+				pxBlock->xBlockSize |= heapBLOCK_ALLOCATED_BIT;
+				pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize );
+			}
+			else
+			{
+				xClassStats[ prvGetSizeClass( xBlockSize ) ].xFailures++;
+			}
+		}
+		else if( xWantedSize > 0 )
+		{
+			xClassStats[ heapFIRST_LEVEL_COUNT - 1 ].xFailures++;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	( void ) xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif
+
+	configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+uint8_t *puc = ( uint8_t * ) pv;
+BlockLink_t *pxBlock, *pxNeighbour;
+UBaseType_t uxClass;
+
+	if( pv != NULL )
+	{
+		/* The memory being freed will have a header immediately before it. */
+		puc -= xHeapStructSize;
+
+		/* This casting is to keep the compiler from issuing warnings. */
+		pxBlock = ( void * ) puc;
+
+		/* Check the block is actually allocated. */
+		configASSERT( ( pxBlock->xBlockSize & heapBLOCK_ALLOCATED_BIT ) != 0 );
+
+		if( ( pxBlock->xBlockSize & heapBLOCK_ALLOCATED_BIT ) != 0 )
+		{
+			vTaskSuspendAll();
+			{
+				/* The block is being returned to the heap - it is no longer
+				allocated. */
+				pxBlock->xBlockSize &= ~heapBLOCK_ALLOCATED_BIT;
+				xFreeBytesRemaining += pxBlock->xBlockSize;
+				traceFREE( pv, pxBlock->xBlockSize );
+
+				uxClass = prvGetSizeClass( pxBlock->xBlockSize );
+				xClassStats[ uxClass ].xBlocksInUse--;
+				xClassStats[ uxClass ].xBytesInUse -= pxBlock->xBlockSize;
+
+				#if( configHEAP_TAGS > 0 )
+				{
+					xTagStats[ pxBlock->uxTag ].xBlocksInUse--;
+					xTagStats[ pxBlock->uxTag ].xBytesInUse -= pxBlock->xBlockSize;
+				}
+				#endif /* configHEAP_TAGS */
+
+				/* Combine the block with the block after it if that is free.
+				The end marker is never free. */
+				pxNeighbour = ( BlockLink_t * ) ( puc + pxBlock->xBlockSize );
+
+				if( ( pxNeighbour->xBlockSize & heapBLOCK_ALLOCATED_BIT ) == 0 )
+				{
+					prvRemoveFreeBlock( pxNeighbour );
+					pxBlock->xBlockSize += pxNeighbour->xBlockSize;
+					( ( BlockLink_t * ) ( puc + pxBlock->xBlockSize ) )->pxPreviousPhysicalBlock = pxBlock;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				/* And with the block before it if that is free. */
+				pxNeighbour = pxBlock->pxPreviousPhysicalBlock;
+
+				if( ( pxNeighbour != NULL ) && ( ( pxNeighbour->xBlockSize & heapBLOCK_ALLOCATED_BIT ) == 0 ) )
+				{
+					prvRemoveFreeBlock( pxNeighbour );
+					pxNeighbour->xBlockSize += pxBlock->xBlockSize;
+					( ( BlockLink_t * ) ( ( ( uint8_t * ) pxNeighbour ) + pxNeighbour->xBlockSize ) )->pxPreviousPhysicalBlock = pxNeighbour;
+					pxBlock = pxNeighbour;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				prvInsertFreeBlock( pxBlock );
+			}
+			( void ) xTaskResumeAll();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetLargestFreeBlockSize( void )
+{
+UBaseType_t uxFirstLevel, uxSecondLevel;
+size_t xBlockSize = 0U;
+
+	vTaskSuspendAll();
+	{
+		if( ulFirstLevelBitmap != 0U )
+		{
+			/* A request larger than the first block in the largest size class
+			that has a free block would be rounded up to an empty class, so
+			that block is the largest that can be allocated, if not the largest
+			that is free. */
+			uxFirstLevel = heapFIND_LAST_SET( ulFirstLevelBitmap );
+			uxSecondLevel = heapFIND_LAST_SET( ulSecondLevelBitmaps[ uxFirstLevel ] );
+			xBlockSize = pxFreeBlocks[ uxFirstLevel ][ uxSecondLevel ]->xBlockSize - xHeapStructSize;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	return xBlockSize;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortGetHeapClassCount( void )
+{
+	return ( UBaseType_t ) heapFIRST_LEVEL_COUNT;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapClassStats( UBaseType_t uxClass, HeapClassStats_t *pxStats )
+{
+	configASSERT( uxClass < ( UBaseType_t ) heapFIRST_LEVEL_COUNT );
+	configASSERT( pxStats );
+
+	vTaskSuspendAll();
+	{
+		*pxStats = xClassStats[ uxClass ];
+	}
+	( void ) xTaskResumeAll();
+
+	pxStats->xMaximumBlockSize = ( heapSMALL_BLOCK_SIZE << uxClass ) - 1U;
+}
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_TAGS > 0 )
+
+	UBaseType_t uxPortSetHeapTag( UBaseType_t uxTag )
+	{
+	UBaseType_t uxPreviousTag;
+
+		configASSERT( uxTag < ( UBaseType_t ) configHEAP_TAGS );
+
+		#ifdef configHEAP_TAG_THREAD_LOCAL_INDEX
+		{
+			uxPreviousTag = prvGetCurrentTag();
+			vTaskSetThreadLocalStoragePointer( NULL, configHEAP_TAG_THREAD_LOCAL_INDEX, ( void * ) uxTag );
+		}
+		#else
+		{
+			uxPreviousTag = uxSharedTag;
+			uxSharedTag = uxTag;
+		}
+		#endif
+
+		return uxPreviousTag;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortGetHeapTagStats( UBaseType_t uxTag, HeapTagStats_t *pxStats )
+	{
+		configASSERT( uxTag < ( UBaseType_t ) configHEAP_TAGS );
+		configASSERT( pxStats );
+
+		vTaskSuspendAll();
+		{
+			*pxStats = xTagStats[ uxTag ];
+		}
+		( void ) xTaskResumeAll();
+	}
+	/*-----------------------------------------------------------*/
+
+	static UBaseType_t prvGetCurrentTag( void )
+	{
+	UBaseType_t uxTag = 0U;
+
+		#ifdef configHEAP_TAG_THREAD_LOCAL_INDEX
+		{
+			/* Before the first task is created there is no thread local
+			storage, so allocations are untagged. */
+			if( xTaskGetCurrentTaskHandle() != NULL )
+			{
+				uxTag = ( UBaseType_t ) pvTaskGetThreadLocalStoragePointer( NULL, configHEAP_TAG_THREAD_LOCAL_INDEX );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#else
+		{
+			uxTag = uxSharedTag;
+		}
+		#endif
+
+		return uxTag;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_TAGS */
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+BlockLink_t *pxFirstFreeBlock;
+uint8_t *pucAlignedHeap;
+size_t uxAddress;
+size_t xTotalHeapSize = configTOTAL_HEAP_SIZE;
+
+	/* The whole heap must fit in one block. */
+	configASSERT( xTotalHeapSize < ( ( size_t ) 1 << heapFIRST_LEVEL_LIMIT ) );
+
+	/* Ensure the heap starts on a correctly aligned boundary. */
+	uxAddress = ( size_t ) ucHeap;
+
+	if( ( uxAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
+	{
+		uxAddress += ( portBYTE_ALIGNMENT - 1 );
+		uxAddress &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+		xTotalHeapSize -= uxAddress - ( size_t ) ucHeap;
+	}
+
+	pucAlignedHeap = ( uint8_t * ) uxAddress;
+
+	/* pxEnd is used to mark the end of the heap, and only needs the part of
+	the header that allocated blocks have. */
+	uxAddress = ( ( size_t ) pucAlignedHeap ) + xTotalHeapSize;
+	uxAddress -= xHeapStructSize;
+	uxAddress &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+	pxEnd = ( void * ) uxAddress;
+
+	/* To start with there is a single free block that is sized to take up the
+	entire heap space, minus the space taken by pxEnd. */
+	pxFirstFreeBlock = ( void * ) pucAlignedHeap;
+	pxFirstFreeBlock->xBlockSize = uxAddress - ( size_t ) pxFirstFreeBlock;
+	pxFirstFreeBlock->pxPreviousPhysicalBlock = NULL;
+
+	pxEnd->xBlockSize = heapBLOCK_ALLOCATED_BIT;
+	pxEnd->pxPreviousPhysicalBlock = pxFirstFreeBlock;
+
+	prvInsertFreeBlock( pxFirstFreeBlock );
+
+	/* Only one block exists - and it covers the entire usable heap space. */
+	xMinimumEverFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
+	xFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMapBlockSize( size_t xBlockSize, UBaseType_t *puxFirstLevel, UBaseType_t *puxSecondLevel )
+{
+UBaseType_t uxLastSet;
+
+	if( xBlockSize < heapSMALL_BLOCK_SIZE )
+	{
+		*puxFirstLevel = 0U;
+		*puxSecondLevel = ( UBaseType_t ) ( xBlockSize >> heapALIGNMENT_BITS );
+	}
+	else
+	{
+		/* The second level is the heapSECOND_LEVEL_BITS bits below the most
+		significant. */
+		uxLastSet = heapFIND_LAST_SET( xBlockSize );
+		*puxFirstLevel = uxLastSet - ( heapFIRST_LEVEL_SHIFT - 1U );
+		*puxSecondLevel = ( UBaseType_t ) ( xBlockSize >> ( uxLastSet - heapSECOND_LEVEL_BITS ) ) ^ heapSECOND_LEVEL_COUNT;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t *prvFindFreeBlock( size_t xBlockSize )
+{
+UBaseType_t uxFirstLevel, uxSecondLevel;
+uint32_t ulBitmap;
+BlockLink_t *pxBlock = NULL;
+
+	if( xBlockSize >= heapSMALL_BLOCK_SIZE )
+	{
+		/* The first block in the size's own class is used if it happens to be
+		large enough, rather than splitting a block from a larger class.  This
+		keeps the large blocks whole for longer, at the cost of one check. */
+		prvMapBlockSize( xBlockSize, &uxFirstLevel, &uxSecondLevel );
+
+		if( ( pxFreeBlocks[ uxFirstLevel ][ uxSecondLevel ] != NULL ) && ( pxFreeBlocks[ uxFirstLevel ][ uxSecondLevel ]->xBlockSize >= xBlockSize ) )
+		{
+			pxBlock = pxFreeBlocks[ uxFirstLevel ][ uxSecondLevel ];
+		}
+		else
+		{
+			/* Otherwise round the size up to the start of the next size
+			class, so that every block in the class that is found is large
+			enough. */
+			xBlockSize += ( ( size_t ) 1 << ( heapFIND_LAST_SET( xBlockSize ) - heapSECOND_LEVEL_BITS ) ) - 1U;
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	prvMapBlockSize( xBlockSize, &uxFirstLevel, &uxSecondLevel );
+
+	if( ( pxBlock == NULL ) && ( uxFirstLevel < ( UBaseType_t ) heapFIRST_LEVEL_COUNT ) )
+	{
+		/* A class at or above the second level in the same first level, or
+		otherwise the smallest class in a larger first level. */
+		ulBitmap = ulSecondLevelBitmaps[ uxFirstLevel ] & ( ~0UL << uxSecondLevel );
+
+		if( ulBitmap == 0U )
+		{
+			ulBitmap = ulFirstLevelBitmap & ( ~0UL << ( uxFirstLevel + 1U ) );
+
+			if( ulBitmap != 0U )
+			{
+				uxFirstLevel = heapFIND_FIRST_SET( ulBitmap );
+				ulBitmap = ulSecondLevelBitmaps[ uxFirstLevel ];
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( ulBitmap != 0U )
+		{
+			pxBlock = pxFreeBlocks[ uxFirstLevel ][ heapFIND_FIRST_SET( ulBitmap ) ];
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( BlockLink_t *pxBlock )
+{
+UBaseType_t uxFirstLevel, uxSecondLevel;
+
+	prvMapBlockSize( pxBlock->xBlockSize, &uxFirstLevel, &uxSecondLevel );
+
+	/* Free blocks are taken from the front of their class's list. */
+	pxBlock->pxPreviousFreeBlock = NULL;
+	pxBlock->pxNextFreeBlock = pxFreeBlocks[ uxFirstLevel ][ uxSecondLevel ];
+
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPreviousFreeBlock = pxBlock;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	pxFreeBlocks[ uxFirstLevel ][ uxSecondLevel ] = pxBlock;
+	ulFirstLevelBitmap |= 1UL << uxFirstLevel;
+	ulSecondLevelBitmaps[ uxFirstLevel ] |= 1UL << uxSecondLevel;
+
+	xClassStats[ uxFirstLevel ].xFreeBlocks++;
+	xClassStats[ uxFirstLevel ].xFreeBytes += pxBlock->xBlockSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( BlockLink_t *pxBlock )
+{
+UBaseType_t uxFirstLevel, uxSecondLevel;
+
+	prvMapBlockSize( pxBlock->xBlockSize, &uxFirstLevel, &uxSecondLevel );
+
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPreviousFreeBlock = pxBlock->pxPreviousFreeBlock;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( pxBlock->pxPreviousFreeBlock != NULL )
+	{
+		pxBlock->pxPreviousFreeBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+	}
+	else
+	{
+		/* The block was at the front of the list. */
+		pxFreeBlocks[ uxFirstLevel ][ uxSecondLevel ] = pxBlock->pxNextFreeBlock;
+
+		if( pxBlock->pxNextFreeBlock == NULL )
+		{
+			ulSecondLevelBitmaps[ uxFirstLevel ] &= ~( 1UL << uxSecondLevel );
+
+			if( ulSecondLevelBitmaps[ uxFirstLevel ] == 0U )
+			{
+				ulFirstLevelBitmap &= ~( 1UL << uxFirstLevel );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+	xClassStats[ uxFirstLevel ].xFreeBlocks--;
+	xClassStats[ uxFirstLevel ].xFreeBytes -= pxBlock->xBlockSize;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvGetSizeClass( size_t xBlockSize )
+{
+UBaseType_t uxFirstLevel, uxSecondLevel;
+
+	prvMapBlockSize( xBlockSize, &uxFirstLevel, &uxSecondLevel );
+	( void ) uxSecondLevel;
+
+	return uxFirstLevel;
+}
+/*-----------------------------------------------------------*/
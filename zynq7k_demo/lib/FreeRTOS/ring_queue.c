@@ -0,0 +1,520 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * A ring queue is an array of a power of two item slots, indexed by free
+ * running counts of the items written (the head) and read (the tail), so the
+ * slot of a count is the count masked by the length, and the ring queue is
+ * full when the counts differ by the length.
+ *
+ * With a single writer, the writer owns the head and the reader owns the tail.
+ * Each publishes its count with a release store once it has copied the item in
+ * or out, and keeps a copy of the other side's count from its last read, only
+ * reading the shared count again when the ring queue looks full or empty.  The
+ * head and the tail are kept in different cache lines, so in the common case
+ * each side only writes its own line.
+ *
+ * With multiple writers, each slot starts with a sequence number, which is the
+ * count of the next write that can use the slot.  A writer claims the head
+ * with a compare and swap if the sequence number of its slot matches it, then
+ * copies its item in and sets the sequence number to the count plus one to
+ * publish it.  The reader takes the item once the sequence number shows it is
+ * published, then hands the slot to the write one lap later.  A writer that is
+ * interrupted between claiming and publishing a slot only holds up the reader,
+ * never another writer.
+ *
+ * The reader blocks on its task notification.  Before blocking it sets
+ * xTaskWaitingToReceive and looks for an item again, and after publishing an
+ * item a writer checks xTaskWaitingToReceive.  A full memory barrier between
+ * the two accesses on each side means either the reader sees the item or the
+ * writer sees the reader, so a wake up cannot be lost, and a writer only calls
+ * into the kernel when the reader is waiting.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "ring_queue.h"
+
+#if( configUSE_TASK_NOTIFICATIONS != 1 )
+	#error configUSE_TASK_NOTIFICATIONS must be set to 1 to build ring_queue.c
+#endif
+
+/* Lint e961 and e750 are suppressed as a MISRA exception justified because the
+MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined for the
+header files above, but not in this file, in order to generate the correct
+privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE /*lint !e961 !e750. */
+
+/* The number of bytes used to hold the sequence number at the start of each
+slot of a multiple writer ring queue. */
+#define rqBYTES_TO_STORE_SEQUENCE	( sizeof( UBaseType_t ) )
+
+/*-----------------------------------------------------------*/
+
+/* Structure that hold state information on the ring queue. */
+typedef struct xRING_QUEUE /*lint !e9058 Style convention uses tag. */
+{
+	/* Set when the ring queue is created and read by both sides. */
+	uint8_t *pucStorage;				/* Points to the slots, which follow the structure. */
+	UBaseType_t uxMask;					/* The number of slots minus one. */
+	UBaseType_t uxItemSize;				/* The size of an item. */
+	UBaseType_t uxSlotSize;				/* The size of a slot, which is larger than an item if the slot holds a sequence number. */
+	BaseType_t xMultipleProducers;		/* pdTRUE if the slots hold sequence numbers. */
+	TaskHandle_t xTaskWaitingToReceive;	/* Holds the handle of the reader while it is waiting for an item, otherwise NULL.  Only written when the reader blocks. */
+	uint8_t ucWriterPadding[ configRING_QUEUE_CACHE_LINE_SIZE ];
+
+	/* Written by the writers. */
+	UBaseType_t uxHead;					/* The number of items written, or with multiple writers the number of slots claimed. */
+	UBaseType_t uxTailCopy;				/* With a single writer, the tail from the writer's last read of it. */
+	uint8_t ucReaderPadding[ configRING_QUEUE_CACHE_LINE_SIZE ];
+
+	/* Written by the reader. */
+	UBaseType_t uxTail;					/* The number of items read. */
+	UBaseType_t uxHeadCopy;				/* With a single writer, the head from the reader's last read of it. */
+	uint8_t ucEndPadding[ configRING_QUEUE_CACHE_LINE_SIZE ];
+} RingQueue_t;
+
+/*
+ * Copy an item into the ring queue if there is space, returning pdPASS if it
+ * was written and pdFAIL if the ring queue is full.
+ */
+static BaseType_t prvWriteSingleProducer( RingQueue_t * const pxRingQueue, const void *pvItemToQueue ) PRIVILEGED_FUNCTION;
+static BaseType_t prvWriteMultipleProducers( RingQueue_t * const pxRingQueue, const void *pvItemToQueue ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copy the oldest item out of the ring queue if there is one, returning pdPASS
+ * if it was read and pdFAIL if the ring queue is empty.
+ */
+static BaseType_t prvRead( RingQueue_t * const pxRingQueue, void *pvBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called after an item is written.  Returns the handle of the reader if it is
+ * waiting for an item and this writer is the one to wake it, otherwise NULL.
+ */
+static TaskHandle_t prvTakeTaskWaitingToReceive( RingQueue_t * const pxRingQueue ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	RingQueueHandle_t xRingQueueGenericCreate( UBaseType_t uxQueueLength, UBaseType_t uxItemSize, BaseType_t xMultipleProducers )
+	{
+	RingQueue_t *pxRingQueue;
+	UBaseType_t uxLength = ( UBaseType_t ) 1;
+	UBaseType_t uxSlotSize;
+	UBaseType_t uxSlot;
+
+		configASSERT( uxQueueLength > ( UBaseType_t ) 0 );
+		configASSERT( uxItemSize > ( UBaseType_t ) 0 );
+
+		/* Round the length up to a power of two so the slot of a free running
+		count is the count masked by the length, even after the count wraps.
+		With multiple writers the difference between a sequence number and a
+		count is compared as signed, so the length must be less than half the
+		range of a count. */
+		while( uxLength < uxQueueLength )
+		{
+			configASSERT( uxLength < ( ( ( UBaseType_t ) ~( UBaseType_t ) 0 ) >> 2 ) );
+			uxLength <<= 1;
+		}
+
+		if( xMultipleProducers != pdFALSE )
+		{
+			/* Keep the sequence numbers aligned. */
+			uxSlotSize = ( rqBYTES_TO_STORE_SEQUENCE + uxItemSize + ( rqBYTES_TO_STORE_SEQUENCE - 1 ) ) & ~( ( UBaseType_t ) rqBYTES_TO_STORE_SEQUENCE - 1 );
+		}
+		else
+		{
+			uxSlotSize = uxItemSize;
+		}
+
+		/* Check for multiplication overflow. */
+		configASSERT( ( uxSlotSize * uxLength ) / uxLength == uxSlotSize );
+
+		/* The structure and the slots are allocated in a single call to
+		pvPortMalloc(), with the slots following the structure. */
+		pxRingQueue = ( RingQueue_t * ) pvPortMalloc( sizeof( RingQueue_t ) + ( size_t ) ( uxSlotSize * uxLength ) ); /*lint !e9079 malloc() only returns void*. */
+
+		if( pxRingQueue != NULL )
+		{
+			( void ) memset( ( void * ) pxRingQueue, 0x00, sizeof( RingQueue_t ) ); /*lint !e9087 memset() requires void *. */
+			pxRingQueue->pucStorage = ( ( uint8_t * ) pxRingQueue ) + sizeof( RingQueue_t ); /*lint !e9016 Indexing past structure valid for uint8_t pointer. */
+			pxRingQueue->uxMask = uxLength - ( UBaseType_t ) 1;
+			pxRingQueue->uxItemSize = uxItemSize;
+			pxRingQueue->uxSlotSize = uxSlotSize;
+			pxRingQueue->xMultipleProducers = xMultipleProducers;
+
+			if( xMultipleProducers != pdFALSE )
+			{
+				/* Each slot is free for the first write that maps to it. */
+				for( uxSlot = ( UBaseType_t ) 0; uxSlot < uxLength; uxSlot++ )
+				{
+					*( ( UBaseType_t * ) &( pxRingQueue->pucStorage[ uxSlot * uxSlotSize ] ) ) = uxSlot; /*lint !e9087 !e826 Slots are aligned. */
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return ( RingQueueHandle_t ) pxRingQueue;
+	}
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+void vRingQueueDelete( RingQueueHandle_t xRingQueue )
+{
+RingQueue_t * const pxRingQueue = ( RingQueue_t * ) xRingQueue;
+
+	configASSERT( pxRingQueue );
+	vPortFree( ( void * ) pxRingQueue );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRingQueueSend( RingQueueHandle_t xRingQueue, const void *pvItemToQueue )
+{
+RingQueue_t * const pxRingQueue = ( RingQueue_t * ) xRingQueue;
+TaskHandle_t xTaskToNotify;
+BaseType_t xReturn;
+
+	configASSERT( pxRingQueue );
+	configASSERT( pvItemToQueue );
+
+	if( pxRingQueue->xMultipleProducers != pdFALSE )
+	{
+		xReturn = prvWriteMultipleProducers( pxRingQueue, pvItemToQueue );
+	}
+	else
+	{
+		xReturn = prvWriteSingleProducer( pxRingQueue, pvItemToQueue );
+	}
+
+	if( xReturn != pdFAIL )
+	{
+		xTaskToNotify = prvTakeTaskWaitingToReceive( pxRingQueue );
+
+		if( xTaskToNotify != NULL )
+		{
+			( void ) xTaskNotify( xTaskToNotify, ( uint32_t ) 0, eNoAction );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		xReturn = errQUEUE_FULL;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRingQueueSendFromISR( RingQueueHandle_t xRingQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken )
+{
+RingQueue_t * const pxRingQueue = ( RingQueue_t * ) xRingQueue;
+TaskHandle_t xTaskToNotify;
+BaseType_t xReturn;
+
+	configASSERT( pxRingQueue );
+	configASSERT( pvItemToQueue );
+
+	if( pxRingQueue->xMultipleProducers != pdFALSE )
+	{
+		xReturn = prvWriteMultipleProducers( pxRingQueue, pvItemToQueue );
+	}
+	else
+	{
+		xReturn = prvWriteSingleProducer( pxRingQueue, pvItemToQueue );
+	}
+
+	if( xReturn != pdFAIL )
+	{
+		xTaskToNotify = prvTakeTaskWaitingToReceive( pxRingQueue );
+
+		if( xTaskToNotify != NULL )
+		{
+			( void ) xTaskNotifyFromISR( xTaskToNotify, ( uint32_t ) 0, eNoAction, pxHigherPriorityTaskWoken );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		xReturn = errQUEUE_FULL;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRingQueueReceive( RingQueueHandle_t xRingQueue, void *pvBuffer, TickType_t xTicksToWait )
+{
+RingQueue_t * const pxRingQueue = ( RingQueue_t * ) xRingQueue;
+TimeOut_t xTimeOut;
+BaseType_t xReturn;
+
+	configASSERT( pxRingQueue );
+	configASSERT( pvBuffer );
+
+	xReturn = prvRead( pxRingQueue, pvBuffer );
+
+	if( ( xReturn == pdFAIL ) && ( xTicksToWait != ( TickType_t ) 0 ) )
+	{
+		vTaskSetTimeOutState( &xTimeOut );
+
+		do
+		{
+			/* A writer that saw this task waiting after it had already found
+			an item may have left a notification pending, so clear it before
+			waiting again. */
+			( void ) xTaskNotifyStateClear( NULL );
+
+			/* Should only be one reader. */
+			configASSERT( pxRingQueue->xTaskWaitingToReceive == NULL );
+			__atomic_store_n( &( pxRingQueue->xTaskWaitingToReceive ), xTaskGetCurrentTaskHandle(), __ATOMIC_RELAXED );
+
+			/* Pairs with the barrier in prvTakeTaskWaitingToReceive(). */
+			__atomic_thread_fence( __ATOMIC_SEQ_CST );
+
+			xReturn = prvRead( pxRingQueue, pvBuffer );
+
+			if( xReturn == pdFAIL )
+			{
+				( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+				__atomic_store_n( &( pxRingQueue->xTaskWaitingToReceive ), NULL, __ATOMIC_RELAXED );
+				xReturn = prvRead( pxRingQueue, pvBuffer );
+			}
+			else
+			{
+				__atomic_store_n( &( pxRingQueue->xTaskWaitingToReceive ), NULL, __ATOMIC_RELAXED );
+			}
+
+			/* A notification can arrive without an item, for example when a
+			multiple writer ring queue's oldest slot is still being written,
+			so wait again for any of the block time that is left. */
+		} while( ( xReturn == pdFAIL ) && ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE ) );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxRingQueueMessagesWaiting( RingQueueHandle_t xRingQueue )
+{
+RingQueue_t * const pxRingQueue = ( RingQueue_t * ) xRingQueue;
+UBaseType_t uxTail;
+
+	configASSERT( pxRingQueue );
+
+	/* Read the tail first, as the head never passes it going backwards. */
+	uxTail = __atomic_load_n( &( pxRingQueue->uxTail ), __ATOMIC_ACQUIRE );
+
+	return __atomic_load_n( &( pxRingQueue->uxHead ), __ATOMIC_ACQUIRE ) - uxTail;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWriteSingleProducer( RingQueue_t * const pxRingQueue, const void *pvItemToQueue )
+{
+UBaseType_t uxHead = pxRingQueue->uxHead;
+BaseType_t xReturn = pdFAIL;
+
+	if( ( uxHead - pxRingQueue->uxTailCopy ) > pxRingQueue->uxMask )
+	{
+		/* Looks full, so see how far the reader has got. */
+		pxRingQueue->uxTailCopy = __atomic_load_n( &( pxRingQueue->uxTail ), __ATOMIC_ACQUIRE );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( ( uxHead - pxRingQueue->uxTailCopy ) <= pxRingQueue->uxMask )
+	{
+		( void ) memcpy( ( void * ) &( pxRingQueue->pucStorage[ ( uxHead & pxRingQueue->uxMask ) * pxRingQueue->uxSlotSize ] ), pvItemToQueue, ( size_t ) pxRingQueue->uxItemSize ); /*lint !e9087 memcpy() requires void *. */
+
+		/* Publish the item. */
+		__atomic_store_n( &( pxRingQueue->uxHead ), uxHead + ( UBaseType_t ) 1, __ATOMIC_RELEASE );
+		xReturn = pdPASS;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWriteMultipleProducers( RingQueue_t * const pxRingQueue, const void *pvItemToQueue )
+{
+UBaseType_t uxHead;
+UBaseType_t *puxSequence;
+BaseType_t xDifference;
+BaseType_t xReturn = pdFAIL;
+
+	uxHead = __atomic_load_n( &( pxRingQueue->uxHead ), __ATOMIC_RELAXED );
+
+	for( ;; )
+	{
+		puxSequence = ( UBaseType_t * ) &( pxRingQueue->pucStorage[ ( uxHead & pxRingQueue->uxMask ) * pxRingQueue->uxSlotSize ] ); /*lint !e9087 !e826 Slots are aligned. */
+		xDifference = ( BaseType_t ) ( __atomic_load_n( puxSequence, __ATOMIC_ACQUIRE ) - uxHead );
+
+		if( xDifference == 0 )
+		{
+			/* The slot is free, so try to claim it.  On failure uxHead is
+			updated to the head another writer moved it to. */
+			if( __atomic_compare_exchange_n( &( pxRingQueue->uxHead ), &uxHead, uxHead + ( UBaseType_t ) 1, pdTRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) != 0 )
+			{
+				( void ) memcpy( ( void * ) &( puxSequence[ 1 ] ), pvItemToQueue, ( size_t ) pxRingQueue->uxItemSize ); /*lint !e9087 memcpy() requires void *. */
+
+				/* Publish the item. */
+				__atomic_store_n( puxSequence, uxHead + ( UBaseType_t ) 1, __ATOMIC_RELEASE );
+				xReturn = pdPASS;
+				break;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else if( xDifference < 0 )
+		{
+			/* The slot still holds the item written one lap earlier, so the
+			ring queue is full. */
+			break;
+		}
+		else
+		{
+			/* Another writer has claimed the slot. */
+			uxHead = __atomic_load_n( &( pxRingQueue->uxHead ), __ATOMIC_RELAXED );
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRead( RingQueue_t * const pxRingQueue, void *pvBuffer )
+{
+UBaseType_t uxTail = pxRingQueue->uxTail;
+UBaseType_t *puxSequence;
+BaseType_t xReturn = pdFAIL;
+
+	if( pxRingQueue->xMultipleProducers != pdFALSE )
+	{
+		puxSequence = ( UBaseType_t * ) &( pxRingQueue->pucStorage[ ( uxTail & pxRingQueue->uxMask ) * pxRingQueue->uxSlotSize ] ); /*lint !e9087 !e826 Slots are aligned. */
+
+		if( __atomic_load_n( puxSequence, __ATOMIC_ACQUIRE ) == ( uxTail + ( UBaseType_t ) 1 ) )
+		{
+			( void ) memcpy( pvBuffer, ( const void * ) &( puxSequence[ 1 ] ), ( size_t ) pxRingQueue->uxItemSize );
+
+			/* Hand the slot to the write one lap later. */
+			__atomic_store_n( puxSequence, uxTail + pxRingQueue->uxMask + ( UBaseType_t ) 1, __ATOMIC_RELEASE );
+			__atomic_store_n( &( pxRingQueue->uxTail ), uxTail + ( UBaseType_t ) 1, __ATOMIC_RELAXED );
+			xReturn = pdPASS;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		if( uxTail == pxRingQueue->uxHeadCopy )
+		{
+			/* Looks empty, so see how far the writer has got. */
+			pxRingQueue->uxHeadCopy = __atomic_load_n( &( pxRingQueue->uxHead ), __ATOMIC_ACQUIRE );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( uxTail != pxRingQueue->uxHeadCopy )
+		{
+			( void ) memcpy( pvBuffer, ( const void * ) &( pxRingQueue->pucStorage[ ( uxTail & pxRingQueue->uxMask ) * pxRingQueue->uxSlotSize ] ), ( size_t ) pxRingQueue->uxItemSize );
+
+			/* Hand the slot back to the writer. */
+			__atomic_store_n( &( pxRingQueue->uxTail ), uxTail + ( UBaseType_t ) 1, __ATOMIC_RELEASE );
+			xReturn = pdPASS;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static TaskHandle_t prvTakeTaskWaitingToReceive( RingQueue_t * const pxRingQueue )
+{
+TaskHandle_t xTaskToNotify = NULL;
+
+	/* Order the store that published the item before the load of
+	xTaskWaitingToReceive.  Pairs with the barrier in xRingQueueReceive(). */
+	__atomic_thread_fence( __ATOMIC_SEQ_CST );
+
+	if( __atomic_load_n( &( pxRingQueue->xTaskWaitingToReceive ), __ATOMIC_RELAXED ) != NULL )
+	{
+		/* With multiple writers, only the one that takes the handle wakes the
+		reader. */
+		xTaskToNotify = __atomic_exchange_n( &( pxRingQueue->xTaskWaitingToReceive ), NULL, __ATOMIC_RELAXED );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xTaskToNotify;
+}
+/*-----------------------------------------------------------*/
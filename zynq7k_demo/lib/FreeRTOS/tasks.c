@@ -147,6 +147,15 @@ configIDLE_TASK_NAME in FreeRTOSConfig.h. */
 
 	/*-----------------------------------------------------------*/
 
+	#if ( configNUM_CORES > 1 )
+
+	/* With more than one core the highest priority task may already be
+	running on another core, so selection is done by a function that skips
+	running tasks and tasks not allowed on the core. */
+	#define taskSELECT_HIGHEST_PRIORITY_TASK()	prvSelectHighestPriorityTask( portGET_CORE_ID() )
+
+	#else
+
 	#define taskSELECT_HIGHEST_PRIORITY_TASK()															\
 	{																									\
 	UBaseType_t uxTopPriority = uxTopReadyPriority;														\
@@ -164,6 +173,8 @@ configIDLE_TASK_NAME in FreeRTOSConfig.h. */
 		uxTopReadyPriority = uxTopPriority;																\
 	} /* taskSELECT_HIGHEST_PRIORITY_TASK */
 
+	#endif /* configNUM_CORES */
+
 	/*-----------------------------------------------------------*/
 
 	/* Define away taskRESET_READY_PRIORITY() and portRESET_READY_PRIORITY() as
@@ -245,7 +256,31 @@ count overflows. */
  * task should be used in place of the parameter.  This macro simply checks to
  * see if the parameter is NULL and returns a pointer to the appropriate TCB.
  */
-#define prvGetTCBFromHandle( pxHandle ) ( ( ( pxHandle ) == NULL ) ? ( TCB_t * ) pxCurrentTCB : ( TCB_t * ) ( pxHandle ) )
+#if ( configNUM_CORES > 1 )
+	/* A task can move to another core between reading its core ID and reading
+	pxCurrentTCBs[], so the current task is read with interrupts masked. */
+	#define prvGetTCBFromHandle( pxHandle ) ( ( ( pxHandle ) == NULL ) ? ( TCB_t * ) xTaskGetCurrentTaskHandle() : ( TCB_t * ) ( pxHandle ) )
+#else
+	#define prvGetTCBFromHandle( pxHandle ) ( ( ( pxHandle ) == NULL ) ? ( TCB_t * ) pxCurrentTCB : ( TCB_t * ) ( pxHandle ) )
+#endif
+
+/* Used by tasks to check whether they have suspended the scheduler. */
+#if ( configNUM_CORES > 1 )
+	#define taskSCHEDULER_SUSPENDED_BY_CALLER()	prvSchedulerSuspendedByCaller()
+#else
+	#define taskSCHEDULER_SUSPENDED_BY_CALLER()	( uxSchedulerSuspended != ( UBaseType_t ) pdFALSE )
+#endif
+
+/* The value of xTaskRunState for a task that is not running on any core. */
+#define taskTASK_NOT_RUNNING				( ( BaseType_t ) -1 )
+
+/* pdTRUE if the task referenced by pxTCB is in the Running state, on any
+core. */
+#if ( configNUM_CORES > 1 )
+	#define taskTASK_IS_RUNNING( pxTCB )	( ( pxTCB )->xTaskRunState != taskTASK_NOT_RUNNING )
+#else
+	#define taskTASK_IS_RUNNING( pxTCB )	( ( pxTCB ) == pxCurrentTCB )
+#endif
 
 /* The item value of the event list item is normally used to hold the priority
 of the task to which it belongs (coded to allow it to be held in reverse
@@ -340,6 +375,11 @@ typedef struct tskTaskControlBlock
 		int iTaskErrno;
 	#endif
 
+	#if ( configNUM_CORES > 1 )
+		volatile BaseType_t xTaskRunState;	/*< The core the task is running on, or taskTASK_NOT_RUNNING. */
+		UBaseType_t		uxCoreAffinityMask;	/*< Bit n is set if the task can run on core n. */
+	#endif
+
 } tskTCB;
 
 /* The old tskTCB name is maintained above then typedefed to the new TCB_t name
@@ -349,7 +389,20 @@ typedef tskTCB TCB_t;
 /*lint -save -e956 A manual analysis and inspection has been used to determine
 which static variables must be declared volatile. */
 
-PRIVILEGED_DATA TCB_t * volatile pxCurrentTCB = NULL;
+#if ( configNUM_CORES > 1 )
+
+	/* The task running on each core.  pxCurrentTCB is the task running on the
+	calling core, so is only meaningful where the caller cannot move to another
+	core - in a critical section, with the scheduler suspended, or in an
+	interrupt. */
+	PRIVILEGED_DATA TCB_t * volatile pxCurrentTCBs[ configNUM_CORES ] = { NULL };
+	#define pxCurrentTCB pxCurrentTCBs[ portGET_CORE_ID() ]
+
+#else
+
+	PRIVILEGED_DATA TCB_t * volatile pxCurrentTCB = NULL;
+
+#endif
 
 /* Lists for ready and blocked tasks. --------------------*/
 PRIVILEGED_DATA static List_t pxReadyTasksLists[ configMAX_PRIORITIES ];/*< Prioritised ready tasks. */
@@ -385,11 +438,21 @@ PRIVILEGED_DATA static volatile TickType_t xIdleTickCount 			= ( TickType_t ) co
 PRIVILEGED_DATA static volatile UBaseType_t uxTopReadyPriority 		= tskIDLE_PRIORITY;
 PRIVILEGED_DATA static volatile BaseType_t xSchedulerRunning 		= pdFALSE;
 PRIVILEGED_DATA static volatile UBaseType_t uxPendedTicks 			= ( UBaseType_t ) 0U;
-PRIVILEGED_DATA static volatile BaseType_t xYieldPending 			= pdFALSE;
+#if ( configNUM_CORES > 1 )
+	PRIVILEGED_DATA static volatile BaseType_t xYieldPendings[ configNUM_CORES ] = { pdFALSE };
+	#define xYieldPending xYieldPendings[ portGET_CORE_ID() ]
+#else
+	PRIVILEGED_DATA static volatile BaseType_t xYieldPending 			= pdFALSE;
+#endif
 PRIVILEGED_DATA static volatile BaseType_t xNumOfOverflows 			= ( BaseType_t ) 0;
 PRIVILEGED_DATA static UBaseType_t uxTaskNumber 					= ( UBaseType_t ) 0U;
 PRIVILEGED_DATA static volatile TickType_t xNextTaskUnblockTime		= ( TickType_t ) 0U; /* Initialised to portMAX_DELAY before the scheduler starts. */
-PRIVILEGED_DATA static TaskHandle_t xIdleTaskHandle					= NULL;			/*< Holds the handle of the idle task.  The idle task is created automatically when the scheduler is started. */
+#if ( configNUM_CORES > 1 )
+	PRIVILEGED_DATA static TaskHandle_t xIdleTaskHandles[ configNUM_CORES ] = { NULL };	/*< Holds the handles of the idle tasks, one per core.  The idle tasks are created automatically when the scheduler is started. */
+	#define xIdleTaskHandle xIdleTaskHandles[ 0 ]
+#else
+	PRIVILEGED_DATA static TaskHandle_t xIdleTaskHandle					= NULL;			/*< Holds the handle of the idle task.  The idle task is created automatically when the scheduler is started. */
+#endif
 
 /* Context switches are held pending while the scheduler is suspended.  Also,
 interrupts must not manipulate the xStateListItem of a TCB, or any of the
@@ -403,7 +466,12 @@ PRIVILEGED_DATA static volatile UBaseType_t uxSchedulerSuspended	= ( UBaseType_t
 
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
-	PRIVILEGED_DATA static uint32_t ulTaskSwitchedInTime = 0UL;	/*< Holds the value of a timer/counter the last time a task was switched in. */
+	#if ( configNUM_CORES > 1 )
+		PRIVILEGED_DATA static uint32_t ulTaskSwitchedInTimes[ configNUM_CORES ] = { 0UL };	/*< Holds the value of a timer/counter the last time a task was switched in on each core. */
+		#define ulTaskSwitchedInTime ulTaskSwitchedInTimes[ portGET_CORE_ID() ]
+	#else
+		PRIVILEGED_DATA static uint32_t ulTaskSwitchedInTime = 0UL;	/*< Holds the value of a timer/counter the last time a task was switched in. */
+	#endif
 	PRIVILEGED_DATA static uint32_t ulTotalRunTime = 0UL;		/*< Holds the total amount of execution time as defined by the run time counter clock. */
 
 #endif
@@ -574,6 +642,53 @@ static void prvInitialiseNewTask( 	TaskFunction_t pxTaskCode,
  */
 static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB ) PRIVILEGED_FUNCTION;
 
+#if ( configNUM_CORES > 1 )
+
+	/*
+	 * Makes the core xCoreID select a new task - immediately if it is another
+	 * core, or when the calling core next leaves its critical section.  Must
+	 * be called from a critical section.
+	 */
+	static void prvYieldCore( BaseType_t xCoreID ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Called when the task referenced by pxTCB has been made ready.  Finds
+	 * the core, of those the task may run on, that is running the lowest
+	 * priority task below the priority of pxTCB, and makes it select a new
+	 * task.  Returns pdTRUE if that is the calling core, so the caller should
+	 * yield.  Must be called from a critical section or with the scheduler
+	 * suspended.
+	 */
+	static BaseType_t prvYieldForTask( TCB_t *pxTCB ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Selects the task to run on core xCoreID - the highest priority ready
+	 * task that is not already running on another core and may run on
+	 * xCoreID.  Called with both kernel locks held.
+	 */
+	static void prvSelectHighestPriorityTask( BaseType_t xCoreID ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Returns pdTRUE if the scheduler is suspended by the calling task.  Another
+	 * core can suspend the scheduler at any time, so uxSchedulerSuspended is
+	 * read in a critical section, which cannot be entered while another core
+	 * has the scheduler suspended.
+	 */
+	static portINLINE BaseType_t prvSchedulerSuspendedByCaller( void ) PRIVILEGED_FUNCTION;
+
+#endif /* configNUM_CORES */
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+	/*
+	 * Returns the run time counter of the task referenced by pxTCB, plus the
+	 * time since it was switched in if it is running now.  Must be called from
+	 * a critical section.
+	 */
+	static uint32_t prvGetRunTimeCounter( const TCB_t * const pxTCB ) PRIVILEGED_FUNCTION;
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+
 /*
  * freertos_tasks_c_additions_init() should only be called if the user definable
  * macro FREERTOS_TASKS_C_ADDITIONS_INIT() is defined, as that is the only macro
@@ -740,12 +855,37 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB ) PRIVILEGED_FUNCTION;
 
 #if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
 
+	#if ( configNUM_CORES > 1 )
+
+	BaseType_t xTaskCreate(	TaskFunction_t pxTaskCode,
+							const char * const pcName,		/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+							const configSTACK_DEPTH_TYPE usStackDepth,
+							void * const pvParameters,
+							UBaseType_t uxPriority,
+							TaskHandle_t * const pxCreatedTask )
+	{
+		return xTaskCreateAffinitySet( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, tskNO_AFFINITY, pxCreatedTask );
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t xTaskCreateAffinitySet(	TaskFunction_t pxTaskCode,
+										const char * const pcName,		/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+										const configSTACK_DEPTH_TYPE usStackDepth,
+										void * const pvParameters,
+										UBaseType_t uxPriority,
+										UBaseType_t uxCoreAffinityMask,
+										TaskHandle_t * const pxCreatedTask )
+
+	#else /* configNUM_CORES */
+
 	BaseType_t xTaskCreate(	TaskFunction_t pxTaskCode,
 							const char * const pcName,		/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
 							const configSTACK_DEPTH_TYPE usStackDepth,
 							void * const pvParameters,
 							UBaseType_t uxPriority,
 							TaskHandle_t * const pxCreatedTask )
+
+	#endif /* configNUM_CORES */
 	{
 	TCB_t *pxNewTCB;
 	BaseType_t xReturn;
@@ -817,6 +957,14 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB ) PRIVILEGED_FUNCTION;
 			#endif /* configSUPPORT_STATIC_ALLOCATION */
 
 			prvInitialiseNewTask( pxTaskCode, pcName, ( uint32_t ) usStackDepth, pvParameters, uxPriority, pxCreatedTask, pxNewTCB, NULL );
+
+			#if ( configNUM_CORES > 1 )
+			{
+				/* Set before the task is readied so it never runs elsewhere. */
+				pxNewTCB->uxCoreAffinityMask = uxCoreAffinityMask;
+			}
+			#endif /* configNUM_CORES */
+
 			prvAddNewTaskToReadyList( pxNewTCB );
 			xReturn = pdPASS;
 		}
@@ -1008,6 +1156,13 @@ UBaseType_t x;
 	}
 	#endif
 
+	#if ( configNUM_CORES > 1 )
+	{
+		pxNewTCB->xTaskRunState = taskTASK_NOT_RUNNING;
+		pxNewTCB->uxCoreAffinityMask = tskNO_AFFINITY;
+	}
+	#endif
+
 	/* Initialize the TCB stack to look as if the task was already running,
 	but had been interrupted by the scheduler.  The return address is set
 	to the start of the task function. Once the stack has been initialised
@@ -1042,6 +1197,21 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 	taskENTER_CRITICAL();
 	{
 		uxCurrentNumberOfTasks++;
+
+		#if ( configNUM_CORES > 1 )
+		{
+			/* The task to run on each core is selected when the scheduler
+			starts, so pxCurrentTCBs[] is not set here. */
+			if( uxCurrentNumberOfTasks == ( UBaseType_t ) 1 )
+			{
+				prvInitialiseTaskLists();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#else /* configNUM_CORES */
 		if( pxCurrentTCB == NULL )
 		{
 			/* There are no other tasks, or all the other tasks are in
@@ -1081,6 +1251,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
+		#endif /* configNUM_CORES */
 
 		uxTaskNumber++;
 
@@ -1095,26 +1266,38 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		prvAddTaskToReadyList( pxNewTCB );
 
 		portSETUP_TCB( pxNewTCB );
+
+		#if ( configNUM_CORES > 1 )
+		{
+			/* The created task may preempt a lower priority task on any of
+			the cores it can run on. */
+			( void ) prvYieldForTask( pxNewTCB );
+		}
+		#endif /* configNUM_CORES */
 	}
 	taskEXIT_CRITICAL();
 
-	if( xSchedulerRunning != pdFALSE )
+	#if ( configNUM_CORES == 1 )
 	{
-		/* If the created task is of a higher priority than the current task
-		then it should run now. */
-		if( pxCurrentTCB->uxPriority < pxNewTCB->uxPriority )
+		if( xSchedulerRunning != pdFALSE )
 		{
-			taskYIELD_IF_USING_PREEMPTION();
+			/* If the created task is of a higher priority than the current task
+			then it should run now. */
+			if( pxCurrentTCB->uxPriority < pxNewTCB->uxPriority )
+			{
+				taskYIELD_IF_USING_PREEMPTION();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
 		}
 		else
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
 	}
-	else
-	{
-		mtCOVERAGE_TEST_MARKER();
-	}
+	#endif /* configNUM_CORES */
 }
 /*-----------------------------------------------------------*/
 
@@ -1156,7 +1339,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 			not return. */
 			uxTaskNumber++;
 
-			if( pxTCB == pxCurrentTCB )
+			if( taskTASK_IS_RUNNING( pxTCB ) != pdFALSE )
 			{
 				/* A task is deleting itself.  This cannot complete within the
 				task itself, as a context switch to another task is required.
@@ -1176,6 +1359,15 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				hence xYieldPending is used to latch that a context switch is
 				required. */
 				portPRE_TASK_DELETE_HOOK( pxTCB, &xYieldPending );
+
+				#if ( configNUM_CORES > 1 )
+				{
+					/* The task may be running on another core, which must
+					select a different task.  The idle task does not free the
+					TCB until the task has been switched out. */
+					prvYieldCore( pxTCB->xTaskRunState );
+				}
+				#endif /* configNUM_CORES */
 			}
 			else
 			{
@@ -1192,19 +1384,24 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		taskEXIT_CRITICAL();
 
 		/* Force a reschedule if it is the currently running task that has just
-		been deleted. */
-		if( xSchedulerRunning != pdFALSE )
+		been deleted.  With more than one core the yield was requested inside
+		the critical section. */
+		#if ( configNUM_CORES == 1 )
 		{
-			if( pxTCB == pxCurrentTCB )
-			{
-				configASSERT( uxSchedulerSuspended == 0 );
-				portYIELD_WITHIN_API();
-			}
-			else
+			if( xSchedulerRunning != pdFALSE )
 			{
-				mtCOVERAGE_TEST_MARKER();
+				if( pxTCB == pxCurrentTCB )
+				{
+					configASSERT( taskSCHEDULER_SUSPENDED_BY_CALLER() == pdFALSE );
+					portYIELD_WITHIN_API();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 			}
 		}
+		#endif /* configNUM_CORES */
 	}
 
 #endif /* INCLUDE_vTaskDelete */
@@ -1219,7 +1416,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 		configASSERT( pxPreviousWakeTime );
 		configASSERT( ( xTimeIncrement > 0U ) );
-		configASSERT( uxSchedulerSuspended == 0 );
+		configASSERT( taskSCHEDULER_SUSPENDED_BY_CALLER() == pdFALSE );
 
 		vTaskSuspendAll();
 		{
@@ -1303,7 +1500,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		/* A delay time of zero just forces a reschedule. */
 		if( xTicksToDelay > ( TickType_t ) 0U )
 		{
-			configASSERT( uxSchedulerSuspended == 0 );
+			configASSERT( taskSCHEDULER_SUSPENDED_BY_CALLER() == pdFALSE );
 			vTaskSuspendAll();
 			{
 				traceTASK_DELAY();
@@ -1349,9 +1546,10 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 		configASSERT( pxTCB );
 
-		if( pxTCB == pxCurrentTCB )
+		if( taskTASK_IS_RUNNING( pxTCB ) != pdFALSE )
 		{
-			/* The task calling this function is querying its own state. */
+			/* The task calling this function is querying its own state, or
+			the state of a task running on another core. */
 			eReturn = eRunning;
 		}
 		else
@@ -1457,14 +1655,14 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		http://www.freertos.org/RTOS-Cortex-M3-M4.html */
 		portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-		uxSavedInterruptState = portSET_INTERRUPT_MASK_FROM_ISR();
+		uxSavedInterruptState = taskENTER_CRITICAL_FROM_ISR();
 		{
 			/* If null is passed in here then it is the priority of the calling
 			task that is being queried. */
 			pxTCB = prvGetTCBFromHandle( xTask );
 			uxReturn = pxTCB->uxPriority;
 		}
-		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptState );
+		taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptState );
 
 		return uxReturn;
 	}
@@ -1512,6 +1710,22 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 			if( uxCurrentBasePriority != uxNewPriority )
 			{
+				#if ( configNUM_CORES > 1 )
+				{
+					/* Setting the priority of a running task down means there
+					may now be a ready task of higher priority that should
+					take its core.  A raised task that is not running is
+					checked once it is in its new ready list. */
+					if( ( uxNewPriority < uxCurrentBasePriority ) && ( taskTASK_IS_RUNNING( pxTCB ) != pdFALSE ) )
+					{
+						xYieldRequired = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				#else /* configNUM_CORES */
 				/* The priority change may have readied a task of higher
 				priority than the calling task. */
 				if( uxNewPriority > uxCurrentBasePriority )
@@ -1550,6 +1764,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 					require a yield as the running task must be above the
 					new priority of the task being modified. */
 				}
+				#endif /* configNUM_CORES */
 
 				/* Remember the ready list the task might be referenced from
 				before its uxPriority member is changed so the
@@ -1610,6 +1825,19 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 						mtCOVERAGE_TEST_MARKER();
 					}
 					prvAddTaskToReadyList( pxTCB );
+
+					#if ( configNUM_CORES > 1 )
+					{
+						if( ( uxNewPriority > uxCurrentBasePriority ) && ( taskTASK_IS_RUNNING( pxTCB ) == pdFALSE ) )
+						{
+							( void ) prvYieldForTask( pxTCB );
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					#endif /* configNUM_CORES */
 				}
 				else
 				{
@@ -1618,7 +1846,15 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 				if( xYieldRequired != pdFALSE )
 				{
-					taskYIELD_IF_USING_PREEMPTION();
+					#if ( configNUM_CORES > 1 )
+					{
+						prvYieldCore( pxTCB->xTaskRunState );
+					}
+					#else
+					{
+						taskYIELD_IF_USING_PREEMPTION();
+					}
+					#endif
 				}
 				else
 				{
@@ -1683,6 +1919,21 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				}
 			}
 			#endif
+
+			#if ( configNUM_CORES > 1 )
+			{
+				/* A task suspended while running, on this or another core,
+				must be switched out. */
+				if( taskTASK_IS_RUNNING( pxTCB ) != pdFALSE )
+				{
+					prvYieldCore( pxTCB->xTaskRunState );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			#endif /* configNUM_CORES */
 		}
 		taskEXIT_CRITICAL();
 
@@ -1701,12 +1952,13 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 			mtCOVERAGE_TEST_MARKER();
 		}
 
+		#if ( configNUM_CORES == 1 )
 		if( pxTCB == pxCurrentTCB )
 		{
 			if( xSchedulerRunning != pdFALSE )
 			{
 				/* The current task has just been suspended. */
-				configASSERT( uxSchedulerSuspended == 0 );
+				configASSERT( taskSCHEDULER_SUSPENDED_BY_CALLER() == pdFALSE );
 				portYIELD_WITHIN_API();
 			}
 			else
@@ -1732,6 +1984,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
+		#endif /* configNUM_CORES */
 	}
 
 #endif /* INCLUDE_vTaskSuspend */
@@ -1808,6 +2061,11 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 					prvAddTaskToReadyList( pxTCB );
 
 					/* A higher priority task may have just been resumed. */
+					#if ( configNUM_CORES > 1 )
+					{
+						( void ) prvYieldForTask( pxTCB );
+					}
+					#else
 					if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
 					{
 						/* This yield may not cause the task just resumed to run,
@@ -1819,6 +2077,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 					{
 						mtCOVERAGE_TEST_MARKER();
 					}
+					#endif /* configNUM_CORES */
 				}
 				else
 				{
@@ -1865,7 +2124,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		http://www.freertos.org/RTOS-Cortex-M3-M4.html */
 		portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 		{
 			if( prvTaskIsTaskSuspended( pxTCB ) != pdFALSE )
 			{
@@ -1876,6 +2135,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				{
 					/* Ready lists can be accessed so move the task from the
 					suspended list to the ready list directly. */
+					#if ( configNUM_CORES == 1 )
 					if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
 					{
 						xYieldRequired = pdTRUE;
@@ -1884,9 +2144,16 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 					{
 						mtCOVERAGE_TEST_MARKER();
 					}
+					#endif /* configNUM_CORES */
 
 					( void ) uxListRemove( &( pxTCB->xStateListItem ) );
 					prvAddTaskToReadyList( pxTCB );
+
+					#if ( configNUM_CORES > 1 )
+					{
+						xYieldRequired = prvYieldForTask( pxTCB );
+					}
+					#endif /* configNUM_CORES */
 				}
 				else
 				{
@@ -1901,7 +2168,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
-		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 
 		return xYieldRequired;
 	}
@@ -1952,6 +2219,50 @@ BaseType_t xReturn;
 	}
 	#endif /* configSUPPORT_STATIC_ALLOCATION */
 
+	#if ( configNUM_CORES > 1 )
+	{
+	BaseType_t xCoreID;
+	char cIdleName[ configMAX_TASK_NAME_LEN ];
+	UBaseType_t x;
+
+		#if ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+			#error configSUPPORT_DYNAMIC_ALLOCATION must be 1 when configNUM_CORES is greater than 1 as the idle tasks of the other cores are created dynamically.
+		#endif
+
+		/* Each core has its own idle task, which can only run on that core.
+		The idle task of core 0 was created above.  The others are named
+		after it with the core number appended. */
+		if( xReturn == pdPASS )
+		{
+			( ( TCB_t * ) xIdleTaskHandles[ 0 ] )->uxCoreAffinityMask = ( UBaseType_t ) 1;
+		}
+
+		for( x = ( UBaseType_t ) 0; x < ( UBaseType_t ) ( configMAX_TASK_NAME_LEN - 2 ); x++ )
+		{
+			cIdleName[ x ] = configIDLE_TASK_NAME[ x ];
+
+			if( cIdleName[ x ] == 0x00 )
+			{
+				break;
+			}
+		}
+
+		for( xCoreID = 1; ( xCoreID < ( BaseType_t ) configNUM_CORES ) && ( xReturn == pdPASS ); xCoreID++ )
+		{
+			cIdleName[ x ] = ( char ) ( '0' + xCoreID );
+			cIdleName[ x + 1 ] = '\0';
+
+			xReturn = xTaskCreateAffinitySet(	prvIdleTask,
+												cIdleName,
+												configMINIMAL_STACK_SIZE,
+												( void * ) NULL,
+												( tskIDLE_PRIORITY | portPRIVILEGE_BIT ),
+												( UBaseType_t ) 1 << xCoreID,
+												&( xIdleTaskHandles[ xCoreID ] ) ); /*lint !e961 MISRA exception, justified as it is not a redundant explicit cast to all supported compilers. */
+		}
+	}
+	#endif /* configNUM_CORES */
+
 	#if ( configUSE_TIMERS == 1 )
 	{
 		if( xReturn == pdPASS )
@@ -1991,6 +2302,18 @@ BaseType_t xReturn;
 		}
 		#endif /* configUSE_NEWLIB_REENTRANT */
 
+		#if ( configNUM_CORES > 1 )
+		{
+		BaseType_t xCoreID;
+
+			/* Choose the first task to run on each core. */
+			for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUM_CORES; xCoreID++ )
+			{
+				prvSelectHighestPriorityTask( xCoreID );
+			}
+		}
+		#endif /* configNUM_CORES */
+
 		xNextTaskUnblockTime = portMAX_DELAY;
 		xSchedulerRunning = pdTRUE;
 		xTickCount = ( TickType_t ) 0U;
@@ -2042,11 +2365,42 @@ void vTaskEndScheduler( void )
 
 void vTaskSuspendAll( void )
 {
-	/* A critical section is not required as the variable is of type
-	BaseType_t.  Please read Richard Barry's reply in the following link to a
-	post in the FreeRTOS support forum before reporting this as a bug! -
-	http://goo.gl/wu4acr */
-	++uxSchedulerSuspended;
+	#if ( configNUM_CORES > 1 )
+	{
+	UBaseType_t uxSavedInterruptStatus;
+
+		if( xSchedulerRunning != pdFALSE )
+		{
+			/* The task lock is held until xTaskResumeAll(), so no other core
+			can switch context or enter a critical section while the scheduler
+			is suspended.  Interrupts are masked while the lock is taken so
+			the calling task cannot be moved to another core part way
+			through. */
+			uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+			portGET_TASK_LOCK();
+
+			/* Interrupts on the other cores read uxSchedulerSuspended with
+			only the ISR lock held. */
+			portGET_ISR_LOCK();
+			++uxSchedulerSuspended;
+			portRELEASE_ISR_LOCK();
+
+			portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		}
+		else
+		{
+			++uxSchedulerSuspended;
+		}
+	}
+	#else /* configNUM_CORES */
+	{
+		/* A critical section is not required as the variable is of type
+		BaseType_t.  Please read Richard Barry's reply in the following link to a
+		post in the FreeRTOS support forum before reporting this as a bug! -
+		http://goo.gl/wu4acr */
+		++uxSchedulerSuspended;
+	}
+	#endif /* configNUM_CORES */
 }
 /*----------------------------------------------------------*/
 
@@ -2146,6 +2500,11 @@ BaseType_t xAlreadyYielded = pdFALSE;
 
 					/* If the moved task has a priority higher than the current
 					task then a yield must be performed. */
+					#if ( configNUM_CORES > 1 )
+					{
+						( void ) prvYieldForTask( pxTCB );
+					}
+					#else
 					if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
 					{
 						xYieldPending = pdTRUE;
@@ -2154,6 +2513,7 @@ BaseType_t xAlreadyYielded = pdFALSE;
 					{
 						mtCOVERAGE_TEST_MARKER();
 					}
+					#endif /* configNUM_CORES */
 				}
 
 				if( pxTCB != NULL )
@@ -2216,6 +2576,22 @@ BaseType_t xAlreadyYielded = pdFALSE;
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
+
+		#if ( configNUM_CORES > 1 )
+		{
+			/* Release the task lock taken by vTaskSuspendAll().  The critical
+			section still holds it, and any pending yield is performed when
+			the critical section is exited. */
+			if( xSchedulerRunning != pdFALSE )
+			{
+				portRELEASE_TASK_LOCK();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configNUM_CORES */
 	}
 	taskEXIT_CRITICAL();
 
@@ -2535,44 +2911,142 @@ TCB_t *pxTCB;
 #endif /* configUSE_TRACE_FACILITY */
 /*----------------------------------------------------------*/
 
-#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
 
-	TaskHandle_t xTaskGetIdleTaskHandle( void )
+	static uint32_t prvGetRunTimeCounter( const TCB_t * const pxTCB )
 	{
-		/* If xTaskGetIdleTaskHandle() is called before the scheduler has been
-		started, then xIdleTaskHandle will be NULL. */
-		configASSERT( ( xIdleTaskHandle != NULL ) );
-		return xIdleTaskHandle;
-	}
+	uint32_t ulRunTimeCounter = pxTCB->ulRunTimeCounter;
+	uint32_t ulSwitchedInTime;
+	uint32_t ulNow;
+	BaseType_t xRunning;
 
-#endif /* INCLUDE_xTaskGetIdleTaskHandle */
-/*----------------------------------------------------------*/
+		xRunning = taskTASK_IS_RUNNING( pxTCB );
 
-/* This conditional compilation should use inequality to 0, not equality to 1.
-This is to ensure vTaskStepTick() is available when user defined low power mode
-implementations require configUSE_TICKLESS_IDLE to be set to a value other than
-1. */
-#if ( configUSE_TICKLESS_IDLE != 0 )
+		#if ( configNUM_CORES > 1 )
+		{
+			ulSwitchedInTime = ( xRunning != pdFALSE ) ? ulTaskSwitchedInTimes[ pxTCB->xTaskRunState ] : 0UL;
+		}
+		#else
+		{
+			ulSwitchedInTime = ulTaskSwitchedInTime;
+		}
+		#endif
 
-	void vTaskStepTick( const TickType_t xTicksToJump )
-	{
-		/* Correct the tick count value after a period during which the tick
-		was suppressed.  Note this does *not* call the tick hook function for
-		each stepped tick. */
-		configASSERT( ( xTickCount + xTicksToJump ) <= xNextTaskUnblockTime );
-		xTickCount += xTicksToJump;
-		traceINCREASE_TICK_COUNT( xTicksToJump );
-	}
+		/* A task that has been running since the last context switch, such as
+		the idle task of a core with nothing else to do, has not had that time
+		added to its counter yet. */
+		if( ( xRunning != pdFALSE ) && ( xSchedulerRunning != pdFALSE ) )
+		{
+			#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+				portALT_GET_RUN_TIME_COUNTER_VALUE( ulNow );
+			#else
+				ulNow = portGET_RUN_TIME_COUNTER_VALUE();
+			#endif
 
-#endif /* configUSE_TICKLESS_IDLE */
-/*----------------------------------------------------------*/
+			/* As in vTaskSwitchContext(). */
+			if( ulNow > ulSwitchedInTime )
+			{
+				ulRunTimeCounter += ( ulNow - ulSwitchedInTime );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
 
-#if ( INCLUDE_xTaskAbortDelay == 1 )
+		return ulRunTimeCounter;
+	}
+	/*-----------------------------------------------------------*/
 
-	BaseType_t xTaskAbortDelay( TaskHandle_t xTask )
+	uint32_t ulTaskGetRunTimeCounter( const TaskHandle_t xTask )
 	{
-	TCB_t *pxTCB = ( TCB_t * ) xTask;
-	BaseType_t xReturn;
+	TCB_t *pxTCB;
+	uint32_t ulRunTimeCounter;
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+			ulRunTimeCounter = prvGetRunTimeCounter( pxTCB );
+		}
+		taskEXIT_CRITICAL();
+
+		return ulRunTimeCounter;
+	}
+	/*-----------------------------------------------------------*/
+
+	uint32_t ulTaskGetIdleRunTimeCounter( void )
+	{
+	uint32_t ulRunTimeCounter = 0UL;
+
+		taskENTER_CRITICAL();
+		{
+			#if ( configNUM_CORES > 1 )
+			{
+			BaseType_t xCoreID;
+
+				for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUM_CORES; xCoreID++ )
+				{
+					if( xIdleTaskHandles[ xCoreID ] != NULL )
+					{
+						ulRunTimeCounter += prvGetRunTimeCounter( ( TCB_t * ) xIdleTaskHandles[ xCoreID ] );
+					}
+				}
+			}
+			#else
+			{
+				if( xIdleTaskHandle != NULL )
+				{
+					ulRunTimeCounter = prvGetRunTimeCounter( ( TCB_t * ) xIdleTaskHandle );
+				}
+			}
+			#endif
+		}
+		taskEXIT_CRITICAL();
+
+		return ulRunTimeCounter;
+	}
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+/*----------------------------------------------------------*/
+
+#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+
+	TaskHandle_t xTaskGetIdleTaskHandle( void )
+	{
+		/* If xTaskGetIdleTaskHandle() is called before the scheduler has been
+		started, then xIdleTaskHandle will be NULL. */
+		configASSERT( ( xIdleTaskHandle != NULL ) );
+		return xIdleTaskHandle;
+	}
+
+#endif /* INCLUDE_xTaskGetIdleTaskHandle */
+/*----------------------------------------------------------*/
+
+/* This conditional compilation should use inequality to 0, not equality to 1.
+This is to ensure vTaskStepTick() is available when user defined low power mode
+implementations require configUSE_TICKLESS_IDLE to be set to a value other than
+1. */
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	void vTaskStepTick( const TickType_t xTicksToJump )
+	{
+		/* Correct the tick count value after a period during which the tick
+		was suppressed.  Note this does *not* call the tick hook function for
+		each stepped tick. */
+		configASSERT( ( xTickCount + xTicksToJump ) <= xNextTaskUnblockTime );
+		xTickCount += xTicksToJump;
+		traceINCREASE_TICK_COUNT( xTicksToJump );
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*----------------------------------------------------------*/
+
+#if ( INCLUDE_xTaskAbortDelay == 1 )
+
+	BaseType_t xTaskAbortDelay( TaskHandle_t xTask )
+	{
+	TCB_t *pxTCB = ( TCB_t * ) xTask;
+	BaseType_t xReturn;
 
 		configASSERT( pxTCB );
 
@@ -2612,7 +3086,13 @@ implementations require configUSE_TICKLESS_IDLE to be set to a value other than
 
 				/* A task being unblocked cannot cause an immediate context
 				switch if preemption is turned off. */
-				#if (  configUSE_PREEMPTION == 1 )
+				#if ( configNUM_CORES > 1 )
+				{
+					/* A yield of the calling core is pended until the
+					scheduler is unsuspended. */
+					( void ) prvYieldForTask( pxTCB );
+				}
+				#elif (  configUSE_PREEMPTION == 1 )
 				{
 					/* Preemption is on, but a context switch should only be
 					performed if the unblocked task has a priority that is
@@ -2734,7 +3214,20 @@ BaseType_t xSwitchRequired = pdFALSE;
 
 					/* A task being unblocked cannot cause an immediate
 					context switch if preemption is turned off. */
-					#if (  configUSE_PREEMPTION == 1 )
+					#if ( configNUM_CORES > 1 )
+					{
+						/* The unblocked task may preempt this or another
+						core. */
+						if( prvYieldForTask( pxTCB ) != pdFALSE )
+						{
+							xSwitchRequired = pdTRUE;
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					#elif (  configUSE_PREEMPTION == 1 )
 					{
 						/* Preemption is on, but a context switch should
 						only be performed if the unblocked task has a
@@ -2759,6 +3252,45 @@ BaseType_t xSwitchRequired = pdFALSE;
 		writer has not explicitly turned time slicing off. */
 		#if ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) )
 		{
+			#if ( configNUM_CORES > 1 )
+			{
+			BaseType_t xCoreID, xOtherCoreID;
+			UBaseType_t uxPriority, uxRunning;
+
+				/* A core shares its time with the ready tasks of its running
+				task's priority only if there are more of them than there are
+				cores running at that priority. */
+				for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUM_CORES; xCoreID++ )
+				{
+					uxPriority = pxCurrentTCBs[ xCoreID ]->uxPriority;
+					uxRunning = 0;
+
+					for( xOtherCoreID = 0; xOtherCoreID < ( BaseType_t ) configNUM_CORES; xOtherCoreID++ )
+					{
+						if( pxCurrentTCBs[ xOtherCoreID ]->uxPriority == uxPriority )
+						{
+							uxRunning++;
+						}
+					}
+
+					if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ uxPriority ] ) ) > uxRunning )
+					{
+						if( xCoreID == ( BaseType_t ) portGET_CORE_ID() )
+						{
+							xSwitchRequired = pdTRUE;
+						}
+						else
+						{
+							prvYieldCore( xCoreID );
+						}
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+			}
+			#else /* configNUM_CORES */
 			if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ) ) > ( UBaseType_t ) 1 )
 			{
 				xSwitchRequired = pdTRUE;
@@ -2767,6 +3299,7 @@ BaseType_t xSwitchRequired = pdFALSE;
 			{
 				mtCOVERAGE_TEST_MARKER();
 			}
+			#endif /* configNUM_CORES */
 		}
 		#endif /* ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) ) */
 
@@ -2825,7 +3358,7 @@ BaseType_t xSwitchRequired = pdFALSE;
 		getting set. */
 		if( xTask == NULL )
 		{
-			xTCB = ( TCB_t * ) pxCurrentTCB;
+			xTCB = prvGetTCBFromHandle( NULL );
 		}
 		else
 		{
@@ -2852,7 +3385,7 @@ BaseType_t xSwitchRequired = pdFALSE;
 		/* If xTask is NULL then we are setting our own task hook. */
 		if( xTask == NULL )
 		{
-			xTCB = ( TCB_t * ) pxCurrentTCB;
+			xTCB = prvGetTCBFromHandle( NULL );
 		}
 		else
 		{
@@ -2883,7 +3416,7 @@ BaseType_t xSwitchRequired = pdFALSE;
 		/* If xTask is NULL then we are calling our own task hook. */
 		if( xTask == NULL )
 		{
-			xTCB = ( TCB_t * ) pxCurrentTCB;
+			xTCB = prvGetTCBFromHandle( NULL );
 		}
 		else
 		{
@@ -2907,6 +3440,16 @@ BaseType_t xSwitchRequired = pdFALSE;
 
 void vTaskSwitchContext( void )
 {
+	#if ( configNUM_CORES > 1 )
+	{
+		/* Called with interrupts masked.  The task lock stops another core
+		selecting the task this core is about to run, and the ISR lock stops
+		interrupts on other cores changing the ready lists. */
+		portGET_TASK_LOCK();
+		portGET_ISR_LOCK();
+	}
+	#endif /* configNUM_CORES */
+
 	if( uxSchedulerSuspended != ( UBaseType_t ) pdFALSE )
 	{
 		/* The scheduler is currently suspended - do not allow a context
@@ -2975,6 +3518,13 @@ void vTaskSwitchContext( void )
 		}
 		#endif /* configUSE_NEWLIB_REENTRANT */
 	}
+
+	#if ( configNUM_CORES > 1 )
+	{
+		portRELEASE_ISR_LOCK();
+		portRELEASE_TASK_LOCK();
+	}
+	#endif /* configNUM_CORES */
 }
 /*-----------------------------------------------------------*/
 
@@ -3086,7 +3636,13 @@ BaseType_t xReturn;
 		vListInsertEnd( &( xPendingReadyList ), &( pxUnblockedTCB->xEventListItem ) );
 	}
 
+	/* With more than one core a task held in the pending ready list is placed
+	on a core when the scheduler is resumed. */
+	#if ( configNUM_CORES > 1 )
+	if( ( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE ) && ( prvYieldForTask( pxUnblockedTCB ) != pdFALSE ) )
+	#else
 	if( pxUnblockedTCB->uxPriority > pxCurrentTCB->uxPriority )
+	#endif
 	{
 		/* Return true if the task removed from the event list has a higher
 		priority than the calling task.  This allows the calling task to know if
@@ -3143,6 +3699,13 @@ TCB_t *pxUnblockedTCB;
 	( void ) uxListRemove( &( pxUnblockedTCB->xStateListItem ) );
 	prvAddTaskToReadyList( pxUnblockedTCB );
 
+	#if ( configNUM_CORES > 1 )
+	{
+		/* Pends a yield of this core, or interrupts another core that will
+		switch once the scheduler is resumed. */
+		( void ) prvYieldForTask( pxUnblockedTCB );
+	}
+	#else
 	if( pxUnblockedTCB->uxPriority > pxCurrentTCB->uxPriority )
 	{
 		/* The unblocked task has a priority above that of the calling task, so
@@ -3151,6 +3714,7 @@ TCB_t *pxUnblockedTCB;
 		occurs immediately that the scheduler is resumed (unsuspended). */
 		xYieldPending = pdTRUE;
 	}
+	#endif /* configNUM_CORES */
 }
 /*-----------------------------------------------------------*/
 
@@ -3331,8 +3895,14 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 			A critical region is not required here as we are just reading from
 			the list, and an occasional incorrect value will not matter.  If
 			the ready list at the idle priority contains more than one task
-			then a task other than the idle task is ready to execute. */
+			then a task other than the idle task is ready to execute.  With
+			more than one core the list also holds the idle task of each
+			core. */
+			#if ( configNUM_CORES > 1 )
+			if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( UBaseType_t ) configNUM_CORES )
+			#else
 			if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( UBaseType_t ) 1 )
+			#endif
 			{
 				taskYIELD();
 			}
@@ -3551,13 +4121,44 @@ static void prvCheckTasksWaitingTermination( void )
 		{
 			taskENTER_CRITICAL();
 			{
-				pxTCB = ( TCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( ( &xTasksWaitingTermination ) );
-				( void ) uxListRemove( &( pxTCB->xStateListItem ) );
-				--uxCurrentNumberOfTasks;
-				--uxDeletedTasksWaitingCleanUp;
+				#if ( configNUM_CORES > 1 )
+				{
+				const ListItem_t *pxItem;
+
+					/* A task deleted while running on another core cannot be
+					freed until that core has switched away from it. */
+					pxTCB = NULL;
+
+					for( pxItem = listGET_HEAD_ENTRY( &xTasksWaitingTermination ); pxItem != listGET_END_MARKER( &xTasksWaitingTermination ); pxItem = listGET_NEXT( pxItem ) )
+					{
+						if( ( ( TCB_t * ) listGET_LIST_ITEM_OWNER( pxItem ) )->xTaskRunState == taskTASK_NOT_RUNNING )
+						{
+							pxTCB = ( TCB_t * ) listGET_LIST_ITEM_OWNER( pxItem );
+							break;
+						}
+					}
+				}
+				#else
+				{
+					pxTCB = ( TCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( ( &xTasksWaitingTermination ) );
+				}
+				#endif /* configNUM_CORES */
+
+				if( pxTCB != NULL )
+				{
+					( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+					--uxCurrentNumberOfTasks;
+					--uxDeletedTasksWaitingCleanUp;
+				}
 			}
 			taskEXIT_CRITICAL();
 
+			if( pxTCB == NULL )
+			{
+				/* Try again when the idle task next runs. */
+				break;
+			}
+
 			prvDeleteTCB( pxTCB );
 		}
 	}
@@ -3605,7 +4206,7 @@ static void prvCheckTasksWaitingTermination( void )
 		state is just set to whatever is passed in. */
 		if( eState != eInvalid )
 		{
-			if( pxTCB == pxCurrentTCB )
+			if( taskTASK_IS_RUNNING( pxTCB ) != pdFALSE )
 			{
 				pxTaskStatus->eCurrentState = eRunning;
 			}
@@ -3822,21 +4423,37 @@ TCB_t *pxTCB;
 }
 /*-----------------------------------------------------------*/
 
-#if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) )
+#if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) || ( configNUM_CORES > 1 ) )
 
 	TaskHandle_t xTaskGetCurrentTaskHandle( void )
 	{
 	TaskHandle_t xReturn;
 
-		/* A critical section is not required as this is not called from
-		an interrupt and the current TCB will always be the same for any
-		individual execution thread. */
-		xReturn = pxCurrentTCB;
+		#if ( configNUM_CORES > 1 )
+		{
+		UBaseType_t uxSavedInterruptStatus;
+
+			/* Interrupts are masked so the calling task cannot be moved to
+			another core between reading the core ID and reading the TCB. */
+			uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+			{
+				xReturn = pxCurrentTCB;
+			}
+			portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		}
+		#else
+		{
+			/* A critical section is not required as this is not called from
+			an interrupt and the current TCB will always be the same for any
+			individual execution thread. */
+			xReturn = pxCurrentTCB;
+		}
+		#endif /* configNUM_CORES */
 
 		return xReturn;
 	}
 
-#endif /* ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) ) */
+#endif /* ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) || ( configNUM_CORES > 1 ) ) */
 /*-----------------------------------------------------------*/
 
 #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
@@ -3851,7 +4468,7 @@ TCB_t *pxTCB;
 		}
 		else
 		{
-			if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
+			if( taskSCHEDULER_SUSPENDED_BY_CALLER() == pdFALSE )
 			{
 				xReturn = taskSCHEDULER_RUNNING;
 			}
@@ -4111,6 +4728,21 @@ TCB_t *pxTCB;
 						}
 
 						prvAddTaskToReadyList( pxTCB );
+
+						#if ( configNUM_CORES > 1 )
+						{
+							/* The holder may be running on another core, where
+							a task of higher priority may now be ready. */
+							if( taskTASK_IS_RUNNING( pxTCB ) != pdFALSE )
+							{
+								prvYieldCore( pxTCB->xTaskRunState );
+							}
+							else
+							{
+								mtCOVERAGE_TEST_MARKER();
+							}
+						}
+						#endif /* configNUM_CORES */
 					}
 					else
 					{
@@ -4199,6 +4831,405 @@ TCB_t *pxTCB;
 #endif /* portCRITICAL_NESTING_IN_TCB */
 /*-----------------------------------------------------------*/
 
+#if ( configNUM_CORES > 1 )
+
+	void vTaskEnterCritical( void )
+	{
+		portDISABLE_INTERRUPTS();
+
+		if( xSchedulerRunning != pdFALSE )
+		{
+			/* The locks are only taken by the outermost critical section.
+			The task lock is taken first, as it is by vTaskSwitchContext(). */
+			if( portGET_CRITICAL_NESTING_COUNT() == 0U )
+			{
+				portGET_TASK_LOCK();
+				portGET_ISR_LOCK();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			portINCREMENT_CRITICAL_NESTING_COUNT();
+
+			/* This is not the interrupt safe version of the enter critical
+			function so	assert() if it is being called from an interrupt
+			context.  Only API functions that end in "FromISR" can be used in an
+			interrupt.  Only assert if the critical nesting count is 1 to
+			protect against recursive calls if the assert function also uses a
+			critical section. */
+			if( portGET_CRITICAL_NESTING_COUNT() == 1U )
+			{
+				configASSERT( portCHECK_IF_IN_ISR() == pdFALSE );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTaskExitCritical( void )
+	{
+	BaseType_t xYieldCurrentTask;
+
+		if( xSchedulerRunning != pdFALSE )
+		{
+			if( portGET_CRITICAL_NESTING_COUNT() > 0U )
+			{
+				portDECREMENT_CRITICAL_NESTING_COUNT();
+
+				if( portGET_CRITICAL_NESTING_COUNT() == 0U )
+				{
+					/* A yield requested inside the critical section, by this
+					or another core, is performed now.  The flag is read
+					before the locks are released. */
+					xYieldCurrentTask = ( ( xYieldPending != pdFALSE ) && ( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE ) ) ? pdTRUE : pdFALSE;
+
+					portRELEASE_ISR_LOCK();
+					portRELEASE_TASK_LOCK();
+					portENABLE_INTERRUPTS();
+
+					if( xYieldCurrentTask != pdFALSE )
+					{
+						portYIELD();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	UBaseType_t uxTaskEnterCriticalFromISR( void )
+	{
+	UBaseType_t uxSavedInterruptStatus;
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+
+		if( xSchedulerRunning != pdFALSE )
+		{
+			portGET_ISR_LOCK();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return uxSavedInterruptStatus;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTaskExitCriticalFromISR( UBaseType_t uxSavedInterruptStatus )
+	{
+		if( xSchedulerRunning != pdFALSE )
+		{
+			portRELEASE_ISR_LOCK();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTaskYieldWithinAPI( void )
+	{
+	UBaseType_t uxSavedInterruptStatus;
+	BaseType_t xInCritical;
+
+		/* Interrupts are masked so the nesting count and the pending flag
+		are those of the core the task is running on. */
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			xInCritical = ( portGET_CRITICAL_NESTING_COUNT() != 0U ) ? pdTRUE : pdFALSE;
+
+			if( xInCritical != pdFALSE )
+			{
+				/* The kernel locks are held, so the yield is performed when
+				the critical section is exited. */
+				xYieldPending = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		if( xInCritical == pdFALSE )
+		{
+			portYIELD();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvYieldCore( BaseType_t xCoreID )
+	{
+		if( xSchedulerRunning != pdFALSE )
+		{
+			xYieldPendings[ xCoreID ] = pdTRUE;
+
+			if( xCoreID != ( BaseType_t ) portGET_CORE_ID() )
+			{
+				portYIELD_CORE( xCoreID );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvYieldForTask( TCB_t *pxTCB )
+	{
+	const BaseType_t xThisCoreID = ( BaseType_t ) portGET_CORE_ID();
+	BaseType_t xCoreID, xLowestCoreID = -1;
+	UBaseType_t uxLowestPriority = pxTCB->uxPriority;
+	BaseType_t xReturn = pdFALSE;
+
+		if( ( xSchedulerRunning != pdFALSE ) && ( taskTASK_IS_RUNNING( pxTCB ) == pdFALSE ) )
+		{
+			/* Find the core running the lowest priority task below the
+			priority of pxTCB.  Cores that are already going to select a new
+			task are skipped, and the calling core is preferred if more than
+			one core runs at the lowest priority. */
+			for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUM_CORES; xCoreID++ )
+			{
+				if( ( ( pxTCB->uxCoreAffinityMask & ( ( UBaseType_t ) 1 << xCoreID ) ) != 0U ) && ( xYieldPendings[ xCoreID ] == pdFALSE ) )
+				{
+					if( pxCurrentTCBs[ xCoreID ]->uxPriority < uxLowestPriority )
+					{
+						uxLowestPriority = pxCurrentTCBs[ xCoreID ]->uxPriority;
+						xLowestCoreID = xCoreID;
+					}
+					else if( ( pxCurrentTCBs[ xCoreID ]->uxPriority == uxLowestPriority ) && ( xLowestCoreID != -1 ) && ( xCoreID == xThisCoreID ) )
+					{
+						xLowestCoreID = xCoreID;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+			}
+
+			if( xLowestCoreID == xThisCoreID )
+			{
+				xYieldPending = pdTRUE;
+				xReturn = pdTRUE;
+			}
+			else if( xLowestCoreID != -1 )
+			{
+				prvYieldCore( xLowestCoreID );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSelectHighestPriorityTask( BaseType_t xCoreID )
+	{
+	UBaseType_t uxCurrentPriority = uxTopReadyPriority;
+	BaseType_t xTaskScheduled = pdFALSE, xDecrementTopPriority = pdTRUE;
+	List_t *pxReadyList;
+	ListItem_t *pxIterator;
+	UBaseType_t uxCount;
+	TCB_t *pxTCB;
+
+		/* The task being switched out can now be selected by any core,
+		including this one. */
+		if( pxCurrentTCBs[ xCoreID ] != NULL )
+		{
+			pxCurrentTCBs[ xCoreID ]->xTaskRunState = taskTASK_NOT_RUNNING;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		while( xTaskScheduled == pdFALSE )
+		{
+			pxReadyList = &( pxReadyTasksLists[ uxCurrentPriority ] );
+
+			if( listLIST_IS_EMPTY( pxReadyList ) == pdFALSE )
+			{
+				/* Start after the task last selected from the list so tasks of
+				the same priority share the cores. */
+				pxIterator = pxReadyList->pxIndex;
+				uxCount = listCURRENT_LIST_LENGTH( pxReadyList );
+
+				while( uxCount > ( UBaseType_t ) 0 )
+				{
+					pxIterator = listGET_NEXT( pxIterator );
+
+					if( pxIterator != listGET_END_MARKER( pxReadyList ) )
+					{
+						uxCount--;
+						pxTCB = ( TCB_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+						if( ( pxTCB->xTaskRunState == taskTASK_NOT_RUNNING ) && ( ( pxTCB->uxCoreAffinityMask & ( ( UBaseType_t ) 1 << xCoreID ) ) != 0U ) )
+						{
+							pxReadyList->pxIndex = pxIterator;
+							pxTCB->xTaskRunState = xCoreID;
+							pxCurrentTCBs[ xCoreID ] = pxTCB;
+							xTaskScheduled = pdTRUE;
+							break;
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+
+				/* Every task at this priority may be running on other cores,
+				so uxTopReadyPriority is only lowered past empty lists. */
+				xDecrementTopPriority = pdFALSE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( xTaskScheduled == pdFALSE )
+			{
+				/* The idle task of each core can only run on that core, so a
+				task is always found. */
+				configASSERT( uxCurrentPriority > tskIDLE_PRIORITY );
+
+				if( xDecrementTopPriority != pdFALSE )
+				{
+					uxTopReadyPriority--;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				uxCurrentPriority--;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTaskCoreAffinitySet( const TaskHandle_t xTask, UBaseType_t uxCoreAffinityMask )
+	{
+	TCB_t *pxTCB;
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+			pxTCB->uxCoreAffinityMask = uxCoreAffinityMask;
+
+			if( taskTASK_IS_RUNNING( pxTCB ) != pdFALSE )
+			{
+				/* Move the task off a core it can no longer run on. */
+				if( ( uxCoreAffinityMask & ( ( UBaseType_t ) 1 << pxTCB->xTaskRunState ) ) == 0U )
+				{
+					prvYieldCore( pxTCB->xTaskRunState );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xStateListItem ) ) != pdFALSE )
+			{
+				/* A ready task may now preempt a core it could not run on
+				before. */
+				( void ) prvYieldForTask( pxTCB );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+	static portINLINE BaseType_t prvSchedulerSuspendedByCaller( void )
+	{
+	BaseType_t xReturn;
+
+		taskENTER_CRITICAL();
+		{
+			xReturn = ( uxSchedulerSuspended != ( UBaseType_t ) pdFALSE ) ? pdTRUE : pdFALSE;
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	UBaseType_t uxTaskCoreAffinityGet( const TaskHandle_t xTask )
+	{
+	TCB_t *pxTCB;
+	UBaseType_t uxCoreAffinityMask;
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+			uxCoreAffinityMask = pxTCB->uxCoreAffinityMask;
+		}
+		taskEXIT_CRITICAL();
+
+		return uxCoreAffinityMask;
+	}
+
+#endif /* configNUM_CORES */
+/*-----------------------------------------------------------*/
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
 
 	static char *prvWriteNameToBuffer( char *pcBuffer, const char *pcTaskName )
@@ -4711,6 +5742,12 @@ TickType_t uxReturn;
 				}
 				#endif
 
+				#if ( configNUM_CORES > 1 )
+				{
+					/* The notified task may preempt this or another core. */
+					( void ) prvYieldForTask( pxTCB );
+				}
+				#else
 				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
 				{
 					/* The notified task has a priority above the currently
@@ -4721,6 +5758,7 @@ TickType_t uxReturn;
 				{
 					mtCOVERAGE_TEST_MARKER();
 				}
+				#endif /* configNUM_CORES */
 			}
 			else
 			{
@@ -4766,7 +5804,7 @@ TickType_t uxReturn;
 
 		pxTCB = ( TCB_t * ) xTaskToNotify;
 
-		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 		{
 			if( pulPreviousNotificationValue != NULL )
 			{
@@ -4829,7 +5867,11 @@ TickType_t uxReturn;
 					vListInsertEnd( &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
 				}
 
+				#if ( configNUM_CORES > 1 )
+				if( ( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE ) && ( prvYieldForTask( pxTCB ) != pdFALSE ) )
+				#else
 				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				#endif
 				{
 					/* The notified task has a priority above the currently
 					executing task so a yield is required. */
@@ -4851,7 +5893,7 @@ TickType_t uxReturn;
 				}
 			}
 		}
-		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 
 		return xReturn;
 	}
@@ -4889,7 +5931,7 @@ TickType_t uxReturn;
 
 		pxTCB = ( TCB_t * ) xTaskToNotify;
 
-		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 		{
 			ucOriginalNotifyState = pxTCB->ucNotifyState;
 			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
@@ -4919,7 +5961,11 @@ TickType_t uxReturn;
 					vListInsertEnd( &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
 				}
 
+				#if ( configNUM_CORES > 1 )
+				if( ( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE ) && ( prvYieldForTask( pxTCB ) != pdFALSE ) )
+				#else
 				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				#endif
 				{
 					/* The notified task has a priority above the currently
 					executing task so a yield is required. */
@@ -4941,7 +5987,7 @@ TickType_t uxReturn;
 				}
 			}
 		}
-		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 	}
 
 #endif /* configUSE_TASK_NOTIFICATIONS */
@@ -58,6 +58,33 @@ configUSE_TIMERS is set to 1 in FreeRTOSConfig.h. */
 /* Misc definitions. */
 #define tmrNO_DELAY		( TickType_t ) 0U
 
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	/* The timer wheel has a level for each configTIMER_WHEEL_SLOT_BITS wide
+	digit of the tick count, and a slot for each value of the digit.  The top
+	level has fewer slots if the digits do not divide the tick count evenly. */
+	#if( configUSE_16_BIT_TICKS == 1 )
+		#define tmrTICK_BITS		16U
+	#else
+		#define tmrTICK_BITS		32U
+	#endif
+
+	#define tmrWHEEL_SLOTS			( 1U << configTIMER_WHEEL_SLOT_BITS )
+	#define tmrWHEEL_LEVELS			( ( tmrTICK_BITS + configTIMER_WHEEL_SLOT_BITS - 1U ) / configTIMER_WHEEL_SLOT_BITS )
+	#define tmrWHEEL_TOP_LEVEL		( tmrWHEEL_LEVELS - 1U )
+
+	/* The digit of xTime that selects its slot on uxLevel. */
+	#define tmrWHEEL_DIGIT( xTime, uxLevel )	( ( UBaseType_t ) ( ( xTime ) >> ( ( uxLevel ) * configTIMER_WHEEL_SLOT_BITS ) ) & ( tmrWHEEL_SLOTS - 1U ) )
+
+	/* xPendingCommand of a timer that has no command waiting. */
+	#define tmrNO_PENDING_COMMAND	( ( BaseType_t ) -1 )
+
+	/* The message that wakes the timer service task to process the commands
+	recorded on timers.  Negative, as it is not a timer command. */
+	#define tmrCOMMAND_PROCESS_PENDING	( ( BaseType_t ) -3 )
+
+#endif /* configUSE_TIMER_WHEEL */
+
 /* The name assigned to the timer service task.  This can be overridden by
 defining trmTIMER_SERVICE_TASK_NAME in FreeRTOSConfig.h. */
 #ifndef configTIMER_SERVICE_TASK_NAME
@@ -73,6 +100,12 @@ typedef struct tmrTimerControl
 	UBaseType_t				uxAutoReload;		/*<< Set to pdTRUE if the timer should be automatically restarted once expired.  Set to pdFALSE if the timer is, in effect, a one-shot timer. */
 	void 					*pvTimerID;			/*<< An ID to identify the timer.  This allows the timer to be identified when the same callback is used for multiple timers. */
 	TimerCallbackFunction_t	pxCallbackFunction;	/*<< The function that will be called when the timer expires. */
+	#if( configUSE_TIMER_WHEEL == 1 )
+		struct tmrTimerControl	*pxNextPending;	/*<< The next timer that has a command waiting to be processed. */
+		BaseType_t			xPendingCommand;	/*<< The last command sent to the timer and not processed yet, or tmrNO_PENDING_COMMAND. */
+		TickType_t			xPendingValue;		/*<< The value sent with xPendingCommand. */
+		TickType_t			xPendingPeriod;		/*<< A new period sent to the timer and not applied yet, or 0. */
+	#endif
 	#if( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t			uxTimerNumber;		/*<< An ID assigned by trace tools such as FreeRTOS+Trace */
 	#endif
@@ -125,13 +158,33 @@ typedef struct tmrTimerQueueMessage
 /*lint -save -e956 A manual analysis and inspection has been used to determine
 which static variables must be declared volatile. */
 
-/* The list in which active timers are stored.  Timers are referenced in expire
-time order, with the nearest expiry time at the front of the list.  Only the
-timer service task is allowed to access these lists. */
-PRIVILEGED_DATA static List_t xActiveTimerList1;
-PRIVILEGED_DATA static List_t xActiveTimerList2;
-PRIVILEGED_DATA static List_t *pxCurrentTimerList;
-PRIVILEGED_DATA static List_t *pxOverflowTimerList;
+#if( configUSE_TIMER_WHEEL == 0 )
+
+	/* The list in which active timers are stored.  Timers are referenced in
+	expire time order, with the nearest expiry time at the front of the list.
+	Only the timer service task is allowed to access these lists. */
+	PRIVILEGED_DATA static List_t xActiveTimerList1;
+	PRIVILEGED_DATA static List_t xActiveTimerList2;
+	PRIVILEGED_DATA static List_t *pxCurrentTimerList;
+	PRIVILEGED_DATA static List_t *pxOverflowTimerList;
+
+#else
+
+	/* The timer wheel in which active timers are stored.  Each slot lists the
+	timers in it in the order they were inserted, and ulTimerWheelBitmap has a
+	bit set for each slot that is not empty.  xTimerWheelTime is the tick count
+	the wheel has been advanced to.  Only the timer service task is allowed to
+	access these. */
+	PRIVILEGED_DATA static List_t xTimerWheel[ tmrWHEEL_LEVELS ][ tmrWHEEL_SLOTS ];
+	PRIVILEGED_DATA static uint32_t ulTimerWheelBitmap[ tmrWHEEL_LEVELS ];
+	PRIVILEGED_DATA static TickType_t xTimerWheelTime = ( TickType_t ) 0U;
+	PRIVILEGED_DATA static UBaseType_t uxTimersInWheel = ( UBaseType_t ) 0U;
+
+	/* The timers that have commands waiting to be processed, linked through
+	pxNextPending.  Only accessed from critical sections. */
+	PRIVILEGED_DATA static Timer_t *pxPendingTimers = NULL;
+
+#endif /* configUSE_TIMER_WHEEL */
 
 /* A queue that is used to send commands to the timer service task. */
 PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
@@ -170,29 +223,69 @@ static void prvTimerTask( void *pvParameters ) PRIVILEGED_FUNCTION;
  */
 static void prvProcessReceivedCommands( void ) PRIVILEGED_FUNCTION;
 
-/*
- * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
- * depending on if the expire time causes a timer counter overflow.
- */
-static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
-
-/*
- * An active timer has reached its expire time.  Reload the timer if it is an
- * auto reload timer, then call its callback.
- */
-static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
-
-/*
- * The tick count has overflowed.  Switch the timer lists after ensuring the
- * current timer list does not still reference some timers.
- */
-static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
-
-/*
- * Obtain the current tick count, setting *pxTimerListsWereSwitched to pdTRUE
- * if a tick count overflow occurred since prvSampleTimeNow() was last called.
- */
-static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched ) PRIVILEGED_FUNCTION;
+#if( configUSE_TIMER_WHEEL == 0 )
+
+	/*
+	 * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
+	 * depending on if the expire time causes a timer counter overflow.
+	 */
+	static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * An active timer has reached its expire time.  Reload the timer if it is an
+	 * auto reload timer, then call its callback.
+	 */
+	static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * The tick count has overflowed.  Switch the timer lists after ensuring the
+	 * current timer list does not still reference some timers.
+	 */
+	static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Obtain the current tick count, setting *pxTimerListsWereSwitched to pdTRUE
+	 * if a tick count overflow occurred since prvSampleTimeNow() was last called.
+	 */
+	static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched ) PRIVILEGED_FUNCTION;
+
+#else
+
+	/*
+	 * Insert the timer into the slot of the timer wheel for xNextExpiryTime,
+	 * which must be after xTimerWheelTime.
+	 */
+	static void prvInsertTimerInWheel( Timer_t * const pxTimer, const TickType_t xNextExpiryTime ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Remove the timer from the slot of the timer wheel that it is in.
+	 */
+	static void prvRemoveTimerFromWheel( Timer_t * const pxTimer ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * The first time from xTimerWheelTime at which a slot of the timer wheel
+	 * must be processed, either to expire the timers in a level 0 slot or to
+	 * move the timers in a higher slot down.  The wheel must not be empty.
+	 */
+	static TickType_t prvGetNextWheelEvent( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Advance the timer wheel to xTimeNow, processing the timers that expire on
+	 * the way.
+	 */
+	static void prvAdvanceWheel( const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Apply the commands that xTimerGenericCommand() recorded on timers.
+	 */
+	static void prvProcessPendingCommands( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * The index of the lowest bit set in ulBits, which must not be 0.
+	 */
+	static UBaseType_t prvLowestSetBit( uint32_t ulBits ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TIMER_WHEEL */
 
 /*
  * If the timer list contains any active timers then return the expire time of
@@ -373,6 +466,16 @@ static void prvInitialiseNewTimer(	const char * const pcTimerName,			/*lint !e97
 		pxNewTimer->pvTimerID = pvTimerID;
 		pxNewTimer->pxCallbackFunction = pxCallbackFunction;
 		vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
+
+		#if( configUSE_TIMER_WHEEL == 1 )
+		{
+			pxNewTimer->pxNextPending = NULL;
+			pxNewTimer->xPendingCommand = tmrNO_PENDING_COMMAND;
+			pxNewTimer->xPendingValue = ( TickType_t ) 0U;
+			pxNewTimer->xPendingPeriod = ( TickType_t ) 0U;
+		}
+		#endif /* configUSE_TIMER_WHEEL */
+
 		traceTIMER_CREATE( pxNewTimer );
 	}
 }
@@ -389,26 +492,107 @@ DaemonTaskMessage_t xMessage;
 	on a particular timer definition. */
 	if( xTimerQueue != NULL )
 	{
-		/* Send a command to the timer service task to start the xTimer timer. */
-		xMessage.xMessageID = xCommandID;
-		xMessage.u.xTimerParameters.xMessageValue = xOptionalValue;
-		xMessage.u.xTimerParameters.pxTimer = ( Timer_t * ) xTimer;
-
-		if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
+		#if( configUSE_TIMER_WHEEL == 0 )
 		{
-			if( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING )
+			/* Send a command to the timer service task to start the xTimer timer. */
+			xMessage.xMessageID = xCommandID;
+			xMessage.u.xTimerParameters.xMessageValue = xOptionalValue;
+			xMessage.u.xTimerParameters.pxTimer = ( Timer_t * ) xTimer;
+
+			if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
 			{
-				xReturn = xQueueSendToBack( xTimerQueue, &xMessage, xTicksToWait );
+				if( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING )
+				{
+					xReturn = xQueueSendToBack( xTimerQueue, &xMessage, xTicksToWait );
+				}
+				else
+				{
+					xReturn = xQueueSendToBack( xTimerQueue, &xMessage, tmrNO_DELAY );
+				}
 			}
 			else
 			{
-				xReturn = xQueueSendToBack( xTimerQueue, &xMessage, tmrNO_DELAY );
+				xReturn = xQueueSendToBackFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
 			}
 		}
-		else
+		#else
 		{
-			xReturn = xQueueSendToBackFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
+		Timer_t * const pxTimer = ( Timer_t * ) xTimer;
+		UBaseType_t uxSavedInterruptStatus = ( UBaseType_t ) 0U;
+		BaseType_t xWakeTimerTask = pdFALSE;
+
+			/* Record the command on the timer, replacing any that has not been
+			processed yet, as each command starts, stops or deletes the timer
+			whatever came before it.  The timer service task is only sent a
+			message when the first timer is added to the pending timers, so the
+			timer queue does not fill up however many commands are sent, and the
+			command never has to wait for space. */
+			( void ) xTicksToWait;
+
+			if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
+			{
+				taskENTER_CRITICAL();
+			}
+			else
+			{
+				uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+			}
+			{
+				if( pxTimer->xPendingCommand == tmrNO_PENDING_COMMAND )
+				{
+					xWakeTimerTask = ( pxPendingTimers == NULL ) ? pdTRUE : pdFALSE;
+					pxTimer->pxNextPending = pxPendingTimers;
+					pxPendingTimers = pxTimer;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				pxTimer->xPendingCommand = xCommandID;
+				pxTimer->xPendingValue = xOptionalValue;
+
+				if( ( xCommandID == tmrCOMMAND_CHANGE_PERIOD ) || ( xCommandID == tmrCOMMAND_CHANGE_PERIOD_FROM_ISR ) )
+				{
+					pxTimer->xPendingPeriod = xOptionalValue;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
+			{
+				taskEXIT_CRITICAL();
+			}
+			else
+			{
+				taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+			}
+
+			/* If the queue is full the timer service task has messages to
+			receive anyway, and processes the pending timers after them. */
+			if( xWakeTimerTask != pdFALSE )
+			{
+				xMessage.xMessageID = tmrCOMMAND_PROCESS_PENDING;
+
+				if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
+				{
+					( void ) xQueueSendToBack( xTimerQueue, &xMessage, tmrNO_DELAY );
+				}
+				else
+				{
+					( void ) xQueueSendToBackFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			xReturn = pdPASS;
 		}
+		#endif /* configUSE_TIMER_WHEEL */
 
 		traceTIMER_COMMAND_SEND( xTimer, xCommandID, xOptionalValue, xReturn );
 	}
@@ -459,6 +643,8 @@ Timer_t *pxTimer = ( Timer_t * ) xTimer;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 0 )
+
 static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow )
 {
 BaseType_t xResult;
@@ -497,6 +683,8 @@ Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTi
 	/* Call the timer callback. */
 	pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void prvTimerTask( void *pvParameters )
@@ -535,6 +723,8 @@ BaseType_t xListWasEmpty;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 0 )
+
 static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, BaseType_t xListWasEmpty )
 {
 TickType_t xTimeNow;
@@ -891,6 +1081,459 @@ BaseType_t xResult;
 }
 /*-----------------------------------------------------------*/
 
+#else /* configUSE_TIMER_WHEEL */
+
+/* The timer wheel replaces the sorted lists of active timers.  A timer is
+inserted into the slot for its expiry time on the lowest level on which the
+expiry time has the same higher digits as xTimerWheelTime, where each digit is
+configTIMER_WHEEL_SLOT_BITS wide.  When xTimerWheelTime reaches the start of a
+slot on a higher level the timers in it are moved down, so each timer is moved
+at most once per level, and inserting, removing and expiring a timer take a
+constant time however many timers are active.  The top level wraps, so the tick
+count overflowing needs no special handling. */
+
+static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, BaseType_t xListWasEmpty )
+{
+TickType_t xTimeNow;
+
+	vTaskSuspendAll();
+	{
+		xTimeNow = xTaskGetTickCount();
+
+		/* Times are compared as distances from xTimerWheelTime, so the tick
+		count overflowing between them does not matter. */
+		if( ( xListWasEmpty == pdFALSE ) && ( ( TickType_t ) ( xNextExpireTime - xTimerWheelTime ) <= ( TickType_t ) ( xTimeNow - xTimerWheelTime ) ) )
+		{
+			( void ) xTaskResumeAll();
+			prvAdvanceWheel( xTimeNow );
+		}
+		else
+		{
+			/* Block until the next slot is due or a message is received.  If
+			the wheel is empty there is nothing to wait for but a message. */
+			vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ), xListWasEmpty );
+
+			if( xTaskResumeAll() == pdFALSE )
+			{
+				/* Yield to wait for either a command to arrive, or the
+				block time to expire.  If a command arrived between the
+				critical section being exited and this yield then the yield
+				will not cause the task to block. */
+				portYIELD_WITHIN_API();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty )
+{
+TickType_t xNextExpireTime;
+
+	/* This is the next time a slot of the wheel must be processed, either to
+	expire the timers in it or to move them down a level. */
+	if( uxTimersInWheel != ( UBaseType_t ) 0U )
+	{
+		*pxListWasEmpty = pdFALSE;
+		xNextExpireTime = prvGetNextWheelEvent();
+	}
+	else
+	{
+		*pxListWasEmpty = pdTRUE;
+		xNextExpireTime = ( TickType_t ) 0U;
+	}
+
+	return xNextExpireTime;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertTimerInWheel( Timer_t * const pxTimer, const TickType_t xNextExpiryTime )
+{
+const TickType_t xDifferentBits = xNextExpiryTime ^ xTimerWheelTime;
+UBaseType_t uxLevel, uxSlot;
+
+	listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
+	listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+
+	if( xNextExpiryTime < xTimerWheelTime )
+	{
+		/* The expiry time is after the tick count overflows.  Only the top
+		level, which is searched from the slot after the current one round to
+		the current one, can tell it apart from a time that has passed. */
+		uxLevel = tmrWHEEL_TOP_LEVEL;
+	}
+	else
+	{
+		/* The level of the highest digit that differs. */
+		uxLevel = ( UBaseType_t ) 0U;
+
+		while( ( uxLevel < tmrWHEEL_TOP_LEVEL ) && ( ( xDifferentBits >> ( ( uxLevel + 1U ) * configTIMER_WHEEL_SLOT_BITS ) ) != ( TickType_t ) 0U ) )
+		{
+			uxLevel++;
+		}
+	}
+
+	uxSlot = tmrWHEEL_DIGIT( xNextExpiryTime, uxLevel );
+	vListInsertEnd( &( xTimerWheel[ uxLevel ][ uxSlot ] ), &( pxTimer->xTimerListItem ) );
+	ulTimerWheelBitmap[ uxLevel ] |= ( 1UL << uxSlot );
+	uxTimersInWheel++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveTimerFromWheel( Timer_t * const pxTimer )
+{
+const List_t * const pxSlot = ( const List_t * ) listLIST_ITEM_CONTAINER( &( pxTimer->xTimerListItem ) );
+const size_t xSlotIndex = ( size_t ) ( pxSlot - &( xTimerWheel[ 0 ][ 0 ] ) );
+
+	if( uxListRemove( &( pxTimer->xTimerListItem ) ) == ( UBaseType_t ) 0U )
+	{
+		ulTimerWheelBitmap[ xSlotIndex / tmrWHEEL_SLOTS ] &= ~( 1UL << ( xSlotIndex % tmrWHEEL_SLOTS ) );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	uxTimersInWheel--;
+}
+/*-----------------------------------------------------------*/
+
+static TickType_t prvGetNextWheelEvent( void )
+{
+UBaseType_t uxLevel, uxDigit, uxShift;
+uint32_t ulSlots = 0UL;
+TickType_t xEventTime;
+
+	/* Find the first slot that is not empty on the lowest level that has
+	one.  On level 0 the search starts at the current slot, which is due at
+	xTimerWheelTime.  On the levels above it starts after the current slot, as
+	the slots up to the current one have been moved down already, except on
+	the top level, which wraps round. */
+	for( uxLevel = ( UBaseType_t ) 0U; uxLevel < tmrWHEEL_LEVELS; uxLevel++ )
+	{
+		uxDigit = tmrWHEEL_DIGIT( xTimerWheelTime, uxLevel );
+
+		if( uxLevel == ( UBaseType_t ) 0U )
+		{
+			ulSlots = ulTimerWheelBitmap[ uxLevel ] & ~( ( 1UL << uxDigit ) - 1UL );
+		}
+		else
+		{
+			ulSlots = ulTimerWheelBitmap[ uxLevel ] & ~( ( 2UL << uxDigit ) - 1UL );
+
+			if( ( ulSlots == 0UL ) && ( uxLevel == tmrWHEEL_TOP_LEVEL ) )
+			{
+				ulSlots = ulTimerWheelBitmap[ uxLevel ];
+			}
+		}
+
+		if( ulSlots != 0UL )
+		{
+			break;
+		}
+	}
+
+	configASSERT( ulSlots != 0UL );
+
+	/* The slot is due at the time that has the higher digits of
+	xTimerWheelTime, the slot's digit on its level, and zeros below that. */
+	uxShift = uxLevel * configTIMER_WHEEL_SLOT_BITS;
+
+	if( uxLevel < tmrWHEEL_TOP_LEVEL )
+	{
+		xEventTime = xTimerWheelTime & ( TickType_t ) ~( ( ( TickType_t ) 1U << ( uxShift + configTIMER_WHEEL_SLOT_BITS ) ) - 1U );
+	}
+	else
+	{
+		xEventTime = ( TickType_t ) 0U;
+	}
+
+	xEventTime |= ( TickType_t ) ( ( TickType_t ) prvLowestSetBit( ulSlots ) << uxShift );
+
+	return xEventTime;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAdvanceWheel( const TickType_t xTimeNow )
+{
+TickType_t xEventTime;
+UBaseType_t uxLevel;
+List_t *pxSlot;
+Timer_t *pxTimer;
+
+	while( uxTimersInWheel != ( UBaseType_t ) 0U )
+	{
+		xEventTime = prvGetNextWheelEvent();
+
+		if( ( TickType_t ) ( xEventTime - xTimerWheelTime ) > ( TickType_t ) ( xTimeNow - xTimerWheelTime ) )
+		{
+			break;
+		}
+
+		xTimerWheelTime = xEventTime;
+
+		/* Move the timers in the slots that start at this time down to the
+		levels below.  None of them can be moved into a slot that is moved
+		later in this loop, as they differ from xTimerWheelTime in the digit
+		of the level they are moved to. */
+		for( uxLevel = tmrWHEEL_TOP_LEVEL; uxLevel > ( UBaseType_t ) 0U; uxLevel-- )
+		{
+			if( ( xEventTime & ( TickType_t ) ( ( ( TickType_t ) 1U << ( uxLevel * configTIMER_WHEEL_SLOT_BITS ) ) - 1U ) ) == ( TickType_t ) 0U )
+			{
+				pxSlot = &( xTimerWheel[ uxLevel ][ tmrWHEEL_DIGIT( xEventTime, uxLevel ) ] );
+
+				while( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+				{
+					pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+					prvRemoveTimerFromWheel( pxTimer );
+					prvInsertTimerInWheel( pxTimer, listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) ) );
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		/* Every timer in the level 0 slot expires at this time. */
+		pxSlot = &( xTimerWheel[ 0 ][ tmrWHEEL_DIGIT( xEventTime, 0U ) ] );
+
+		while( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+		{
+			pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+			prvRemoveTimerFromWheel( pxTimer );
+			traceTIMER_EXPIRED( pxTimer );
+
+			/* An auto reload timer is reloaded from the time it expired
+			rather than from now, so it does not drift. */
+			if( pxTimer->uxAutoReload == ( UBaseType_t ) pdTRUE )
+			{
+				prvInsertTimerInWheel( pxTimer, xEventTime + pxTimer->xTimerPeriodInTicks );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+		}
+	}
+
+	xTimerWheelTime = xTimeNow;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvLowestSetBit( uint32_t ulBits )
+{
+/* Multiplying the lowest set bit by this de Bruijn sequence leaves a
+different pattern in the top five bits for each bit. */
+static const uint8_t ucBitIndex[ 32 ] =
+{
+	0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+	31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+};
+
+	return ( UBaseType_t ) ucBitIndex[ ( ( uint32_t ) ( ( ulBits & ( 0UL - ulBits ) ) * 0x077CB531UL ) ) >> 27 ];
+}
+/*-----------------------------------------------------------*/
+
+static void	prvProcessReceivedCommands( void )
+{
+DaemonTaskMessage_t xMessage;
+
+	/* Timer commands are recorded on the timers, and only wake this task, so
+	the messages received are pended function calls or those wake ups. */
+	while( xQueueReceive( xTimerQueue, &xMessage, tmrNO_DELAY ) != pdFAIL ) /*lint !e603 xMessage does not have to be initialised as it is passed out, not in, and it is not used unless xQueueReceive() returns pdTRUE. */
+	{
+		#if ( INCLUDE_xTimerPendFunctionCall == 1 )
+		{
+			if( xMessage.xMessageID != tmrCOMMAND_PROCESS_PENDING )
+			{
+				const CallbackParameters_t * const pxCallback = &( xMessage.u.xCallbackParameters );
+
+				/* The timer uses the xCallbackParameters member to request a
+				callback be executed.  Check the callback is not NULL. */
+				configASSERT( pxCallback );
+
+				/* Call the function. */
+				pxCallback->pxCallbackFunction( pxCallback->pvParameter1, pxCallback->ulParameter2 );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* INCLUDE_xTimerPendFunctionCall */
+	}
+
+	prvProcessPendingCommands();
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessPendingCommands( void )
+{
+Timer_t *pxTimer, *pxNextTimer;
+BaseType_t xCommandID;
+TickType_t xCommandValue, xNewPeriod, xNextExpiryTime, xTimeNow;
+
+	for( ;; )
+	{
+		/* Take the timers that have commands pending.  A command sent from now
+		on adds its timer to a new batch, and wakes this task again. */
+		taskENTER_CRITICAL();
+		{
+			pxTimer = pxPendingTimers;
+			pxPendingTimers = NULL;
+		}
+		taskEXIT_CRITICAL();
+
+		if( pxTimer == NULL )
+		{
+			break;
+		}
+
+		/* Expire the timers that are due first, so the wheel is at a time no
+		later than any the commands are applied at. */
+		prvAdvanceWheel( xTaskGetTickCount() );
+
+		while( pxTimer != NULL )
+		{
+			/* A command sent after this is taken adds the timer to the next
+			batch. */
+			taskENTER_CRITICAL();
+			{
+				pxNextTimer = pxTimer->pxNextPending;
+				xCommandID = pxTimer->xPendingCommand;
+				xCommandValue = pxTimer->xPendingValue;
+				xNewPeriod = pxTimer->xPendingPeriod;
+				pxTimer->xPendingCommand = tmrNO_PENDING_COMMAND;
+				pxTimer->xPendingPeriod = ( TickType_t ) 0U;
+			}
+			taskEXIT_CRITICAL();
+
+			/* The time is sampled after the command is taken, so it cannot be
+			before the time the command was sent. */
+			xTimeNow = xTaskGetTickCount();
+
+			/* A change of period is kept when a later command replaced the
+			one that sent it. */
+			if( xNewPeriod != ( TickType_t ) 0U )
+			{
+				pxTimer->xTimerPeriodInTicks = xNewPeriod;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE ) /*lint !e961. The cast is only redundant when NULL is passed into the macro. */
+			{
+				/* The timer is in the wheel, remove it. */
+				prvRemoveTimerFromWheel( pxTimer );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			traceTIMER_COMMAND_RECEIVED( pxTimer, xCommandID, xCommandValue );
+
+			switch( xCommandID )
+			{
+				case tmrCOMMAND_START :
+				case tmrCOMMAND_START_FROM_ISR :
+				case tmrCOMMAND_RESET :
+				case tmrCOMMAND_RESET_FROM_ISR :
+				case tmrCOMMAND_START_DONT_TRACE :
+					/* Start or restart the timer a period after the command was
+					sent.  If that time has passed already then process the
+					expiry now, and each one an auto reload timer has missed
+					since. */
+					xNextExpiryTime = xCommandValue + pxTimer->xTimerPeriodInTicks;
+
+					while( ( ( TickType_t ) ( xTimeNow - xCommandValue ) ) >= pxTimer->xTimerPeriodInTicks ) /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+					{
+						traceTIMER_EXPIRED( pxTimer );
+						pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+
+						if( pxTimer->uxAutoReload == ( UBaseType_t ) pdFALSE )
+						{
+							break;
+						}
+
+						xCommandValue = xNextExpiryTime;
+						xNextExpiryTime += pxTimer->xTimerPeriodInTicks;
+					}
+
+					if( ( ( TickType_t ) ( xTimeNow - xCommandValue ) ) < pxTimer->xTimerPeriodInTicks ) /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+					{
+						prvInsertTimerInWheel( pxTimer, xNextExpiryTime );
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+					break;
+
+				case tmrCOMMAND_STOP :
+				case tmrCOMMAND_STOP_FROM_ISR :
+					/* The timer has already been removed from the wheel.
+					There is nothing to do here. */
+					break;
+
+				case tmrCOMMAND_CHANGE_PERIOD :
+				case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR :
+					configASSERT( ( xCommandValue > 0 ) );
+
+					/* As in the sorted lists, the new period is measured from
+					the time the command is processed. */
+					prvInsertTimerInWheel( pxTimer, xTimeNow + pxTimer->xTimerPeriodInTicks );
+					break;
+
+				case tmrCOMMAND_DELETE :
+					/* The timer has already been removed from the wheel, just
+					free up the memory if the memory was dynamically
+					allocated. */
+					#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
+					{
+						/* The timer can only have been allocated dynamically -
+						free it again. */
+						vPortFree( pxTimer );
+					}
+					#elif( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+					{
+						/* The timer could have been allocated statically or
+						dynamically, so check before attempting to free the
+						memory. */
+						if( pxTimer->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
+						{
+							vPortFree( pxTimer );
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+					break;
+
+				default	:
+					/* Don't expect to get here. */
+					break;
+			}
+
+			pxTimer = pxNextTimer;
+		}
+	}
+}
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
 static void prvCheckForValidListAndQueue( void )
 {
 	/* Check that the list from which active timers are referenced, and the
@@ -900,10 +1543,26 @@ static void prvCheckForValidListAndQueue( void )
 	{
 		if( xTimerQueue == NULL )
 		{
-			vListInitialise( &xActiveTimerList1 );
-			vListInitialise( &xActiveTimerList2 );
-			pxCurrentTimerList = &xActiveTimerList1;
-			pxOverflowTimerList = &xActiveTimerList2;
+			#if( configUSE_TIMER_WHEEL == 0 )
+			{
+				vListInitialise( &xActiveTimerList1 );
+				vListInitialise( &xActiveTimerList2 );
+				pxCurrentTimerList = &xActiveTimerList1;
+				pxOverflowTimerList = &xActiveTimerList2;
+			}
+			#else
+			{
+				UBaseType_t uxLevel, uxSlot;
+
+				for( uxLevel = ( UBaseType_t ) 0U; uxLevel < tmrWHEEL_LEVELS; uxLevel++ )
+				{
+					for( uxSlot = ( UBaseType_t ) 0U; uxSlot < tmrWHEEL_SLOTS; uxSlot++ )
+					{
+						vListInitialise( &( xTimerWheel[ uxLevel ][ uxSlot ] ) );
+					}
+				}
+			}
+			#endif /* configUSE_TIMER_WHEEL */
 
 			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
 			{
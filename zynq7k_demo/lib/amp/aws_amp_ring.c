@@ -0,0 +1,222 @@
+/*
+ * Amazon FreeRTOS AMP Ring V1.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_amp_ring.c
+ * @brief Single-producer, single-consumer ring in shared memory.
+ *
+ * The head and tail are free running counts of records written and read, so
+ * the ring is full when they differ by the slot count. Each side keeps the
+ * other side's index from its last read and only reads the shared copy again
+ * when the ring looks full, or empty, so that the common case does not touch
+ * the other side's cache line.
+ *
+ * The module does not depend on the kernel, so that it can run on a
+ * processor without one and be tested on a host (see tools/amp_ring_test).
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "aws_amp_ring.h"
+
+/* C runtime includes. */
+#include <string.h>
+
+/**
+ * @brief Identifies formatted memory, "AMPR".
+ */
+#define ampringMAGIC            ( 0x414D5052UL )
+
+/**
+ * @brief Size of the length that starts each slot.
+ */
+#define ampringLENGTH_SIZE      ( sizeof( uint32_t ) )
+
+/*-----------------------------------------------------------*/
+
+BaseType_t AMP_RingFormat( void * pvMemory,
+                           size_t xMemorySize,
+                           size_t xMaxRecordLength )
+{
+    AmpRingShared_t * pxShared = ( AmpRingShared_t * ) pvMemory;
+    size_t xSlotSize;
+    size_t xSlotCount = 1;
+    BaseType_t xResult = pdFAIL;
+
+    /* Keep every slot 32-bit aligned. */
+    xSlotSize = ( ampringLENGTH_SIZE + xMaxRecordLength + 3 ) & ~( ( size_t ) 3 );
+
+    if( xMemorySize > sizeof( AmpRingShared_t ) )
+    {
+        while( xSlotCount * 2 <= ( xMemorySize - sizeof( AmpRingShared_t ) ) / xSlotSize )
+        {
+            xSlotCount *= 2;
+        }
+    }
+
+    if( xSlotCount >= 2 )
+    {
+        /* Invalidate any earlier ring before changing its geometry. */
+        __atomic_store_n( &pxShared->ulMagic, 0, __ATOMIC_RELEASE );
+
+        pxShared->ulSlotSize = ( uint32_t ) xSlotSize;
+        pxShared->ulSlotCount = ( uint32_t ) xSlotCount;
+        pxShared->ulHead = 0;
+        pxShared->ulDropped = 0;
+        pxShared->ulTail = 0;
+
+        __atomic_store_n( &pxShared->ulMagic, ampringMAGIC, __ATOMIC_RELEASE );
+        xResult = pdPASS;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t AMP_RingAttach( AmpRing_t * pxRing,
+                           void * pvMemory,
+                           size_t xMemorySize )
+{
+    AmpRingShared_t * pxShared = ( AmpRingShared_t * ) pvMemory;
+    uint32_t ulSlotSize;
+    uint32_t ulSlotCount;
+    BaseType_t xResult = pdFAIL;
+
+    if( ( xMemorySize >= sizeof( AmpRingShared_t ) ) &&
+        ( ampringMAGIC == __atomic_load_n( &pxShared->ulMagic, __ATOMIC_ACQUIRE ) ) )
+    {
+        ulSlotSize = pxShared->ulSlotSize;
+        ulSlotCount = pxShared->ulSlotCount;
+
+        /* A power of two slot count of aligned slots that fits. */
+        if( ( ulSlotSize > ampringLENGTH_SIZE ) &&
+            ( 0 == ( ulSlotSize & 3 ) ) &&
+            ( ulSlotCount >= 2 ) &&
+            ( 0 == ( ulSlotCount & ( ulSlotCount - 1 ) ) ) &&
+            ( ( uint64_t ) ulSlotSize * ulSlotCount <= xMemorySize - sizeof( AmpRingShared_t ) ) )
+        {
+            pxRing->pxShared = pxShared;
+            pxRing->pucSlots = ( uint8_t * ) pvMemory + sizeof( AmpRingShared_t );
+            pxRing->ulSlotSize = ulSlotSize;
+            pxRing->ulMask = ulSlotCount - 1;
+
+            /* Either side can attach to a ring that is already in use. */
+            pxRing->ulHead = __atomic_load_n( &pxShared->ulHead, __ATOMIC_ACQUIRE );
+            pxRing->ulTail = __atomic_load_n( &pxShared->ulTail, __ATOMIC_ACQUIRE );
+            xResult = pdPASS;
+        }
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t AMP_RingWrite( AmpRing_t * pxRing,
+                          const void * pvData,
+                          size_t xLength )
+{
+    AmpRingShared_t * pxShared = pxRing->pxShared;
+    uint32_t ulHead = pxRing->ulHead;
+    uint8_t * pucSlot;
+    BaseType_t xResult = pdFAIL;
+
+    if( xLength <= pxRing->ulSlotSize - ampringLENGTH_SIZE )
+    {
+        if( ulHead - pxRing->ulTail > pxRing->ulMask )
+        {
+            pxRing->ulTail = __atomic_load_n( &pxShared->ulTail, __ATOMIC_ACQUIRE );
+        }
+
+        if( ulHead - pxRing->ulTail > pxRing->ulMask )
+        {
+            /* Full.  Only the producer writes the count. */
+            __atomic_store_n( &pxShared->ulDropped, pxShared->ulDropped + 1, __ATOMIC_RELAXED );
+        }
+        else
+        {
+            pucSlot = &pxRing->pucSlots[ ( ulHead & pxRing->ulMask ) * pxRing->ulSlotSize ];
+            *( uint32_t * ) pucSlot = ( uint32_t ) xLength;
+            memcpy( &pucSlot[ ampringLENGTH_SIZE ], pvData, xLength );
+
+            /* Publish the slot. */
+            pxRing->ulHead = ulHead + 1;
+            __atomic_store_n( &pxShared->ulHead, pxRing->ulHead, __ATOMIC_RELEASE );
+            xResult = pdPASS;
+        }
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t AMP_RingRead( AmpRing_t * pxRing,
+                         void * pvBuffer,
+                         size_t xBufferLength,
+                         size_t * pxLength )
+{
+    AmpRingShared_t * pxShared = pxRing->pxShared;
+    uint32_t ulTail = pxRing->ulTail;
+    const uint8_t * pucSlot;
+    size_t xLength;
+    BaseType_t xResult = pdFAIL;
+
+    if( ulTail == pxRing->ulHead )
+    {
+        pxRing->ulHead = __atomic_load_n( &pxShared->ulHead, __ATOMIC_ACQUIRE );
+    }
+
+    if( ulTail != pxRing->ulHead )
+    {
+        pucSlot = &pxRing->pucSlots[ ( ulTail & pxRing->ulMask ) * pxRing->ulSlotSize ];
+
+        /* Do not trust the length further than the slot. */
+        xLength = *( const uint32_t * ) pucSlot;
+
+        if( xLength > pxRing->ulSlotSize - ampringLENGTH_SIZE )
+        {
+            xLength = pxRing->ulSlotSize - ampringLENGTH_SIZE;
+        }
+
+        memcpy( pvBuffer, &pucSlot[ ampringLENGTH_SIZE ], ( xLength < xBufferLength ) ? xLength : xBufferLength );
+        *pxLength = xLength;
+
+        /* Hand the slot back to the producer. */
+        pxRing->ulTail = ulTail + 1;
+        __atomic_store_n( &pxShared->ulTail, pxRing->ulTail, __ATOMIC_RELEASE );
+        xResult = pdPASS;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t AMP_RingDropped( const AmpRing_t * pxRing )
+{
+    return __atomic_load_n( &pxRing->pxShared->ulDropped, __ATOMIC_RELAXED );
+}
@@ -28,10 +28,14 @@
 
 #ifdef __free_rtos__
     #include "FreeRTOS.h"
+    #include "arena.h"
     void *( *pxCBOR_malloc )( size_t ) = pvPortMalloc;
     void (* pxCBOR_free)( void * ) = vPortFree;
     void *(* pxCBOR_realloc)( void *,
                               size_t ) = CBOR_ReallocImpl;
+
+    /** The arena set by CBOR_SetArena(), or NULL for the FreeRTOS heap */
+    static ArenaHandle_t xCBORArena = NULL;
 #else
     void *(* pxCBOR_malloc)( size_t ) = malloc;
     void (* pxCBOR_free)( void * ) = free;
@@ -61,3 +65,39 @@ void * CBOR_ReallocImpl( void * pxOld_ptr,
 
     return pxNew_ptr;
 }
+
+#ifdef __free_rtos__
+    static void * prvArenaMalloc( size_t xSize )
+    {
+        return pvArenaMalloc( xCBORArena, xSize );
+    }
+
+    static void prvArenaFree( void * pxPtr )
+    {
+        vArenaFree( xCBORArena, pxPtr );
+    }
+
+    static void * prvArenaRealloc( void * pxOld_ptr,
+                                   size_t xNew_size )
+    {
+        return pvArenaRealloc( xCBORArena, pxOld_ptr, xNew_size );
+    }
+
+    void CBOR_SetArena( ArenaHandle_t xArena )
+    {
+        xCBORArena = xArena;
+
+        if( NULL != xArena )
+        {
+            pxCBOR_malloc = prvArenaMalloc;
+            pxCBOR_free = prvArenaFree;
+            pxCBOR_realloc = prvArenaRealloc;
+        }
+        else
+        {
+            pxCBOR_malloc = pvPortMalloc;
+            pxCBOR_free = vPortFree;
+            pxCBOR_realloc = CBOR_ReallocImpl;
+        }
+    }
+#endif /* ifdef __free_rtos__ */
@@ -55,4 +55,20 @@ extern void *(* pxCBOR_realloc)( void *,
  */
 void * CBOR_ReallocImpl( void * /*old_ptr*/, size_t /*new_size*/ );
 
+#ifdef __free_rtos__
+    #include "FreeRTOS.h"
+    #include "arena.h"
+
+/**
+ * @brief Allocates CBOR documents from an arena rather than the FreeRTOS
+ *     heap, so that they have a budget of their own.  The arena's realloc
+ *     knows the size of each block, so documents grow without the guess
+ *     CBOR_ReallocImpl makes.
+ * @param xArena The arena, or NULL to go back to the FreeRTOS heap
+ * @warning Call before any document is created, as blocks must be freed to
+ *     the allocator they came from.
+ */
+    void CBOR_SetArena( ArenaHandle_t xArena );
+#endif
+
 #endif /* end of include guard: AWS_CBOR_ALLOC_H */
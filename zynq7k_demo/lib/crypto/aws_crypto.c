@@ -27,7 +27,10 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "FreeRTOSIPConfig.h"
+#include "task.h"
+#include "semphr.h"
 #include "aws_crypto.h"
+#include "arena.h"
 
 /* mbedTLS includes. */
 #include "mbedtls/config.h"
@@ -36,10 +39,86 @@
 #include "mbedtls/sha1.h"
 #include "mbedtls/pk.h"
 #include "mbedtls/x509_crt.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
 
 /* C runtime includes. */
 #include <string.h>
 
+/**
+ * @brief Length of each of the two buffers used by
+ * CRYPTO_SignatureVerificationStream().
+ */
+#ifndef cryptoconfigSTREAM_CHUNK_LENGTH
+    #define cryptoconfigSTREAM_CHUNK_LENGTH       ( 4096 )
+#endif
+
+/**
+ * @brief Alignment of the chunk buffers. The default is the Cortex-A9 cache
+ * line, so that a DMA transfer into one buffer needs no cache maintenance
+ * beyond its own lines.
+ */
+#ifndef cryptoconfigSTREAM_BUFFER_ALIGNMENT
+    #define cryptoconfigSTREAM_BUFFER_ALIGNMENT    ( 32 )
+#endif
+
+/**
+ * @brief Number of tasks that keep random bytes buffered at once. A task
+ * that finds no free buffer takes over the least recently claimed one.
+ */
+#ifndef cryptoconfigRANDOM_TASK_BUFFERS
+    #define cryptoconfigRANDOM_TASK_BUFFERS       ( 4 )
+#endif
+
+/**
+ * @brief Random bytes generated at once for each task. Requests at least
+ * this long are served by the DRBG directly.
+ */
+#ifndef cryptoconfigRANDOM_BUFFER_LENGTH
+    #define cryptoconfigRANDOM_BUFFER_LENGTH      ( 64 )
+#endif
+
+/**
+ * @brief Size of the arena mbedTLS allocates from, so that TLS sessions have a
+ * budget of their own and cannot fragment the FreeRTOS heap. 0 leaves mbedTLS
+ * on the FreeRTOS heap.
+ */
+#ifndef cryptoconfigARENA_SIZE
+    #define cryptoconfigARENA_SIZE                ( 0 )
+#endif
+
+/**
+ * @brief Random bytes buffered for one task.
+ */
+typedef struct RandomTaskBuffer
+{
+    TaskHandle_t xOwner;
+    size_t xAvailable;
+    uint8_t ucBytes[ cryptoconfigRANDOM_BUFFER_LENGTH ];
+} RandomTaskBuffer_t;
+
+/**
+ * @brief The DRBG shared by all tasks. mbedtls_ctr_drbg_random() locks it.
+ */
+static mbedtls_ctr_drbg_context xRandomDrbg;
+static mbedtls_entropy_context xRandomEntropy;
+static volatile BaseType_t xRandomSeeded = pdFALSE;
+
+/**
+ * @brief Per-task output buffers, guarded by a critical section.
+ */
+static RandomTaskBuffer_t xRandomBuffers[ cryptoconfigRANDOM_TASK_BUFFERS ];
+static size_t xRandomNextBuffer = 0;
+
+#if ( cryptoconfigARENA_SIZE > 0 )
+
+/**
+ * @brief The mbedTLS arena and its storage.
+ */
+    static uint8_t ucCryptoArenaStorage[ cryptoconfigARENA_SIZE ];
+    static ArenaHandle_t xCryptoArena = NULL;
+#endif
+
 /**
  * @brief Internal signature verification context structure
  */
@@ -71,6 +150,26 @@ static void * prvCalloc( size_t xNmemb,
     return pvNew;
 }
 
+#if ( cryptoconfigARENA_SIZE > 0 )
+
+/**
+ * @brief Implements libc calloc semantics using the mbedTLS arena
+ */
+    static void * prvArenaCalloc( size_t xNmemb,
+                                  size_t xSize )
+    {
+        return pvArenaCalloc( xCryptoArena, xNmemb, xSize );
+    }
+
+/**
+ * @brief Implements libc free semantics using the mbedTLS arena
+ */
+    static void prvArenaFree( void * pv )
+    {
+        vArenaFree( xCryptoArena, pv );
+    }
+#endif /* if ( cryptoconfigARENA_SIZE > 0 ) */
+
 /**
  * @brief Verifies a cryptographic signature based on the signer
  * certificate, hash algorithm, and the data that was signed.
@@ -134,6 +233,117 @@ static BaseType_t prvVerifySignature( char * pcSignerCertificate,
     return xResult;
 }
 
+/**
+ * @brief Seeds the shared DRBG from the hardware entropy source on first use.
+ */
+static BaseType_t prvRandomInit( void )
+{
+    static SemaphoreHandle_t xInitMutex = NULL;
+    static const char cPersonalization[] = "aws_crypto_random";
+
+    if( pdFALSE == xRandomSeeded )
+    {
+        /* Several tasks may ask for random numbers for the first time
+         * simultaneously. The heap may not be used from a critical
+         * section. */
+        vTaskSuspendAll();
+        {
+            if( NULL == xInitMutex )
+            {
+                xInitMutex = xSemaphoreCreateMutex();
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        if( ( NULL != xInitMutex ) &&
+            ( pdTRUE == xSemaphoreTake( xInitMutex, portMAX_DELAY ) ) )
+        {
+            if( pdFALSE == xRandomSeeded )
+            {
+                CRYPTO_ConfigureHeap();
+
+                /* MBEDTLS_ENTROPY_HARDWARE_ALT adds mbedtls_hardware_poll() as a
+                 * source. */
+                mbedtls_entropy_init( &xRandomEntropy );
+                mbedtls_ctr_drbg_init( &xRandomDrbg );
+
+                if( 0 == mbedtls_ctr_drbg_seed( &xRandomDrbg,
+                                                mbedtls_entropy_func,
+                                                &xRandomEntropy,
+                                                ( const unsigned char * ) cPersonalization,
+                                                sizeof( cPersonalization ) ) )
+                {
+                    xRandomSeeded = pdTRUE;
+                }
+                else
+                {
+                    mbedtls_ctr_drbg_free( &xRandomDrbg );
+                    mbedtls_entropy_free( &xRandomEntropy );
+                }
+            }
+
+            ( void ) xSemaphoreGive( xInitMutex );
+        }
+    }
+
+    return xRandomSeeded;
+}
+
+/**
+ * @brief Returns the calling task's output buffer, taking one over if it has
+ * none. Called from within a critical section.
+ */
+static RandomTaskBuffer_t * prvRandomTaskBuffer( void )
+{
+    TaskHandle_t xTask = xTaskGetCurrentTaskHandle();
+    RandomTaskBuffer_t * pxBuffer = NULL;
+    size_t x;
+
+    for( x = 0; ( x < cryptoconfigRANDOM_TASK_BUFFERS ) && ( NULL == pxBuffer ); x++ )
+    {
+        if( xTask == xRandomBuffers[ x ].xOwner )
+        {
+            pxBuffer = &xRandomBuffers[ x ];
+        }
+    }
+
+    if( NULL == pxBuffer )
+    {
+        /* Bytes left by the previous owner were never handed out; drop them. */
+        pxBuffer = &xRandomBuffers[ xRandomNextBuffer ];
+        xRandomNextBuffer = ( xRandomNextBuffer + 1 ) % cryptoconfigRANDOM_TASK_BUFFERS;
+        memset( pxBuffer->ucBytes, 0, sizeof( pxBuffer->ucBytes ) );
+        pxBuffer->xAvailable = 0;
+        pxBuffer->xOwner = xTask;
+    }
+
+    return pxBuffer;
+}
+
+/**
+ * @brief Moves up to xLength bytes out of the calling task's buffer.
+ */
+static size_t prvRandomTakeBuffered( unsigned char * pucOutput,
+                                     size_t xLength )
+{
+    RandomTaskBuffer_t * pxBuffer;
+    size_t xTaken;
+
+    taskENTER_CRITICAL();
+
+    pxBuffer = prvRandomTaskBuffer();
+    xTaken = ( xLength < pxBuffer->xAvailable ) ? xLength : pxBuffer->xAvailable;
+    pxBuffer->xAvailable -= xTaken;
+
+    /* Each byte is handed out once. */
+    memcpy( pucOutput, &pxBuffer->ucBytes[ pxBuffer->xAvailable ], xTaken );
+    memset( &pxBuffer->ucBytes[ pxBuffer->xAvailable ], 0, xTaken );
+
+    taskEXIT_CRITICAL();
+
+    return xTaken;
+}
+
 /*
  * Interface routines
  */
@@ -143,10 +353,31 @@ static BaseType_t prvVerifySignature( char * pcSignerCertificate,
  */
 void CRYPTO_ConfigureHeap( void )
 {
-    /*
-     * Ensure that the FreeRTOS heap is used
-     */
-    mbedtls_platform_set_calloc_free( prvCalloc, vPortFree ); /*lint !e534 This function always return 0. */
+    #if ( cryptoconfigARENA_SIZE > 0 )
+        {
+            /*
+             * Use the mbedTLS arena, created by the first call
+             */
+            taskENTER_CRITICAL();
+
+            if( NULL == xCryptoArena )
+            {
+                xCryptoArena = xArenaCreateStatic( "mbedTLS", ucCryptoArenaStorage, sizeof( ucCryptoArenaStorage ) );
+            }
+
+            taskEXIT_CRITICAL();
+
+            configASSERT( NULL != xCryptoArena );
+            mbedtls_platform_set_calloc_free( prvArenaCalloc, prvArenaFree ); /*lint !e534 This function always return 0. */
+        }
+    #else /* if ( cryptoconfigARENA_SIZE > 0 ) */
+        {
+            /*
+             * Ensure that the FreeRTOS heap is used
+             */
+            mbedtls_platform_set_calloc_free( prvCalloc, vPortFree ); /*lint !e534 This function always return 0. */
+        }
+    #endif /* if ( cryptoconfigARENA_SIZE > 0 ) */
 }
 
 /**
@@ -280,3 +511,164 @@ BaseType_t CRYPTO_SignatureVerificationFinal( void * pvContext,
 	}
     return xResult;
 }
+
+/**
+ * @brief Hashes an object in chunks, reading the next chunk while the
+ * current one is hashed, then verifies its signature.
+ */
+BaseType_t CRYPTO_SignatureVerificationStream( const CryptoStreamReader_t * pxReader,
+                                               size_t xObjectLength,
+                                               BaseType_t xAsymmetricAlgorithm,
+                                               BaseType_t xHashAlgorithm,
+                                               char * pcSignerCertificate,
+                                               size_t xSignerCertificateLength,
+                                               uint8_t * pucSignature,
+                                               size_t xSignatureLength )
+{
+    BaseType_t xResult = pdFALSE;
+    void * pvContext = NULL;
+    uint8_t * pucAllocation = NULL;
+    uint8_t * pucBuffers[ 2 ];
+    BaseType_t xActive = 0;
+    size_t xOffset = 0;
+    size_t xRequested = 0;
+    int32_t lRead;
+
+    if( ( NULL != pxReader ) &&
+        ( NULL != pxReader->xStartRead ) &&
+        ( NULL != pxReader->lFinishRead ) )
+    {
+        pucAllocation = ( uint8_t * ) pvPortMalloc( ( 2 * cryptoconfigSTREAM_CHUNK_LENGTH ) +
+                                                    cryptoconfigSTREAM_BUFFER_ALIGNMENT - 1 ); /*lint !e9079 Allow casting void* to other types. */
+    }
+
+    if( NULL != pucAllocation )
+    {
+        pucBuffers[ 0 ] = ( uint8_t * ) ( ( ( uintptr_t ) pucAllocation + cryptoconfigSTREAM_BUFFER_ALIGNMENT - 1 ) &
+                                          ~( ( uintptr_t ) cryptoconfigSTREAM_BUFFER_ALIGNMENT - 1 ) );
+        pucBuffers[ 1 ] = pucBuffers[ 0 ] + cryptoconfigSTREAM_CHUNK_LENGTH;
+
+        xResult = CRYPTO_SignatureVerificationStart( &pvContext, xAsymmetricAlgorithm, xHashAlgorithm );
+    }
+
+    /*
+     * Start reading the first chunk
+     */
+    if( ( pdTRUE == xResult ) && ( xObjectLength > 0 ) )
+    {
+        xRequested = ( xObjectLength < cryptoconfigSTREAM_CHUNK_LENGTH ) ? xObjectLength : cryptoconfigSTREAM_CHUNK_LENGTH;
+        xResult = pxReader->xStartRead( pxReader->pvContext, pucBuffers[ 0 ], 0, xRequested );
+    }
+
+    while( ( pdTRUE == xResult ) && ( xOffset < xObjectLength ) )
+    {
+        lRead = pxReader->lFinishRead( pxReader->pvContext );
+
+        if( ( lRead <= 0 ) || ( ( size_t ) lRead > xRequested ) )
+        {
+            xResult = pdFALSE;
+        }
+        else
+        {
+            xOffset += ( size_t ) lRead;
+
+            /*
+             * Start reading the next chunk into the other buffer, then hash
+             * this one while it loads
+             */
+            if( xOffset < xObjectLength )
+            {
+                xRequested = xObjectLength - xOffset;
+
+                if( xRequested > cryptoconfigSTREAM_CHUNK_LENGTH )
+                {
+                    xRequested = cryptoconfigSTREAM_CHUNK_LENGTH;
+                }
+
+                xResult = pxReader->xStartRead( pxReader->pvContext, pucBuffers[ 1 - xActive ], xOffset, xRequested );
+            }
+
+            CRYPTO_SignatureVerificationUpdate( pvContext, pucBuffers[ xActive ], ( size_t ) lRead );
+            xActive = 1 - xActive;
+        }
+    }
+
+    /*
+     * Verify, or only free the context if the object could not be read
+     */
+    if( NULL != pvContext )
+    {
+        if( pdTRUE == xResult )
+        {
+            xResult = CRYPTO_SignatureVerificationFinal( pvContext,
+                                                         pcSignerCertificate,
+                                                         xSignerCertificateLength,
+                                                         pucSignature,
+                                                         xSignatureLength );
+        }
+        else
+        {
+            ( void ) CRYPTO_SignatureVerificationFinal( pvContext, NULL, 0, NULL, 0 );
+        }
+    }
+
+    vPortFree( pucAllocation );
+
+    return xResult;
+}
+
+/**
+ * @brief Fills a buffer from the shared DRBG, through a per-task buffer for
+ * short requests.
+ */
+int CRYPTO_Random( void * pvContext,
+                   unsigned char * pucOutput,
+                   size_t xLength )
+{
+    int lResult = 0;
+    size_t xTaken = 0;
+    uint8_t ucFresh[ cryptoconfigRANDOM_BUFFER_LENGTH ];
+    RandomTaskBuffer_t * pxBuffer;
+
+    ( void ) pvContext;
+
+    if( pdTRUE != prvRandomInit() )
+    {
+        lResult = MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+    }
+    else if( xLength >= cryptoconfigRANDOM_BUFFER_LENGTH )
+    {
+        lResult = mbedtls_ctr_drbg_random( &xRandomDrbg, pucOutput, xLength );
+    }
+    else
+    {
+        xTaken = prvRandomTakeBuffered( pucOutput, xLength );
+
+        if( xTaken < xLength )
+        {
+            lResult = mbedtls_ctr_drbg_random( &xRandomDrbg, ucFresh, sizeof( ucFresh ) );
+
+            if( 0 == lResult )
+            {
+                memcpy( &pucOutput[ xTaken ], ucFresh, xLength - xTaken );
+
+                /* Keep the rest for the next request of this task. */
+                taskENTER_CRITICAL();
+
+                pxBuffer = prvRandomTaskBuffer();
+
+                if( 0 == pxBuffer->xAvailable )
+                {
+                    pxBuffer->xAvailable = sizeof( ucFresh ) - ( xLength - xTaken );
+                    memcpy( pxBuffer->ucBytes, &ucFresh[ xLength - xTaken ], pxBuffer->xAvailable );
+                }
+
+                taskEXIT_CRITICAL();
+            }
+
+            memset( ucFresh, 0, sizeof( ucFresh ) );
+        }
+    }
+
+    return lResult;
+}
@@ -0,0 +1,371 @@
+/*
+ * Amazon FreeRTOS Crypto V1.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "aws_crypto_accel.h"
+
+/* mbedTLS includes. */
+#include "mbedtls/config.h"
+#include "mbedtls/ecdsa.h"
+
+/* C runtime includes. */
+#include <string.h>
+
+/**
+ * @brief Number of jobs that can wait for the worker task.
+ */
+#ifndef cryptoaccelconfigQUEUE_LENGTH
+    #define cryptoaccelconfigQUEUE_LENGTH       ( 8 )
+#endif
+
+/**
+ * @brief Maximum number of jobs handed to the provider at once.
+ */
+#ifndef cryptoaccelconfigMAX_BATCH_SIZE
+    #define cryptoaccelconfigMAX_BATCH_SIZE     ( 4 )
+#endif
+
+/**
+ * @brief Priority of the worker task. It should be higher than the priority
+ * of the tasks that wait for it.
+ */
+#ifndef cryptoaccelconfigTASK_PRIORITY
+    #define cryptoaccelconfigTASK_PRIORITY      ( configMAX_PRIORITIES - 2 )
+#endif
+
+/**
+ * @brief Stack size of the worker task, in words. The software provider
+ * needs room for the mbedTLS bignum code.
+ */
+#ifndef cryptoaccelconfigTASK_STACK_SIZE
+    #define cryptoaccelconfigTASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 8 )
+#endif
+
+/**
+ * @brief Length of a P-256 coordinate or scalar.
+ */
+#define cryptoaccelP256_BYTES                   32
+
+/**
+ * @brief The software verification, defined in aws_crypto_accel_sw.c.
+ */
+extern int CRYPTO_AccelSoftwareEcdsaVerify( mbedtls_ecp_group * pxGroup,
+                                            const unsigned char * pucHash,
+                                            size_t xHashLength,
+                                            const mbedtls_ecp_point * pxQ,
+                                            const mbedtls_mpi * pxR,
+                                            const mbedtls_mpi * pxS );
+
+/*
+ * Accelerator state
+ */
+static const CryptoAccelProvider_t * pxAccelProvider = NULL;
+static QueueHandle_t xAccelQueue = NULL;
+static TaskHandle_t xAccelTask = NULL;
+static CryptoAccelStats_t xAccelStats;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Hands a batch to the provider and signals the completion of the jobs.
+ */
+static void prvProcessBatch( CryptoAccelJob_t ** ppxJobs,
+                             size_t xJobCount )
+{
+    size_t x;
+    CryptoAccelJob_t * pxJob;
+    uint32_t ulFailures = 0;
+
+    pxAccelProvider->pxProcess( ppxJobs, xJobCount );
+
+    for( x = 0; x < xJobCount; x++ )
+    {
+        if( cryptoaccelSTATUS_OK != ppxJobs[ x ]->xStatus )
+        {
+            ulFailures++;
+        }
+    }
+
+    taskENTER_CRITICAL();
+    {
+        xAccelStats.ulJobs += ( uint32_t ) xJobCount;
+        xAccelStats.ulBatches++;
+        xAccelStats.ulFailures += ulFailures;
+
+        if( xJobCount > xAccelStats.ulLargestBatch )
+        {
+            xAccelStats.ulLargestBatch = ( uint32_t ) xJobCount;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    for( x = 0; x < xJobCount; x++ )
+    {
+        pxJob = ppxJobs[ x ];
+
+        if( NULL != pxJob->pvCompletion )
+        {
+            /* The job and the semaphore may go out of scope as soon as the
+             * semaphore is given, so neither is touched afterwards. */
+            ( void ) xSemaphoreGive( ( SemaphoreHandle_t ) pxJob->pvCompletion );
+        }
+        else if( NULL != pxJob->pxCallback )
+        {
+            pxJob->pxCallback( pxJob );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Collects the queued jobs into batches.
+ */
+static void prvAccelTask( void * pvParameters )
+{
+    CryptoAccelJob_t * pxBatch[ cryptoaccelconfigMAX_BATCH_SIZE ];
+    size_t xJobCount;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        /* Wait for the first job, then take whatever else has been queued
+         * in the meantime. */
+        if( pdPASS == xQueueReceive( xAccelQueue, &pxBatch[ 0 ], portMAX_DELAY ) )
+        {
+            xJobCount = 1;
+
+            while( ( xJobCount < cryptoaccelconfigMAX_BATCH_SIZE ) &&
+                   ( pdPASS == xQueueReceive( xAccelQueue, &pxBatch[ xJobCount ], 0 ) ) )
+            {
+                xJobCount++;
+            }
+
+            prvProcessBatch( pxBatch, xJobCount );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t CRYPTO_AccelInit( const CryptoAccelProvider_t * pxProvider )
+{
+    BaseType_t xResult = pdPASS;
+
+    if( ( NULL != pxAccelProvider ) || ( NULL == pxProvider ) )
+    {
+        xResult = pdFAIL;
+    }
+
+    if( ( pdPASS == xResult ) && ( NULL != pxProvider->pxInit ) )
+    {
+        xResult = pxProvider->pxInit();
+    }
+
+    if( pdPASS == xResult )
+    {
+        xAccelQueue = xQueueCreate( cryptoaccelconfigQUEUE_LENGTH, sizeof( CryptoAccelJob_t * ) );
+
+        if( NULL == xAccelQueue )
+        {
+            xResult = pdFAIL;
+        }
+    }
+
+    if( pdPASS == xResult )
+    {
+        memset( &xAccelStats, 0, sizeof( xAccelStats ) );
+        xResult = xTaskCreate( prvAccelTask,
+                               "CryptoAccel",
+                               cryptoaccelconfigTASK_STACK_SIZE,
+                               NULL,
+                               cryptoaccelconfigTASK_PRIORITY,
+                               &xAccelTask );
+
+        if( pdPASS != xResult )
+        {
+            vQueueDelete( xAccelQueue );
+            xAccelQueue = NULL;
+        }
+    }
+
+    if( pdPASS == xResult )
+    {
+        /* Published last: jobs are only accepted once the task runs. */
+        pxAccelProvider = pxProvider;
+        configPRINTF( ( "Crypto accelerator '%s' registered.\r\n", pxProvider->pcName ) );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t CRYPTO_AccelSupports( CryptoAccelOperation_t eOperation )
+{
+    BaseType_t xResult = pdFALSE;
+    const CryptoAccelProvider_t * pxProvider = pxAccelProvider;
+
+    if( ( NULL != pxProvider ) &&
+        ( eOperation < eCryptoAccelOperationCount ) &&
+        ( 0 != ( pxProvider->ulCapabilities & cryptoaccelCAPABILITY( eOperation ) ) ) )
+    {
+        xResult = pdTRUE;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t CRYPTO_AccelSubmit( CryptoAccelJob_t * pxJob )
+{
+    BaseType_t xResult = pdFAIL;
+
+    if( pdFALSE != CRYPTO_AccelSupports( pxJob->eOperation ) )
+    {
+        pxJob->xStatus = cryptoaccelSTATUS_PENDING;
+        pxJob->pvCompletion = NULL;
+        xResult = xQueueSend( xAccelQueue, &pxJob, 0 );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t CRYPTO_AccelRun( CryptoAccelJob_t * pxJob )
+{
+    StaticSemaphore_t xCompletionBuffer;
+    SemaphoreHandle_t xCompletion;
+
+    if( pdFALSE == CRYPTO_AccelSupports( pxJob->eOperation ) )
+    {
+        pxJob->xStatus = cryptoaccelSTATUS_UNSUPPORTED;
+    }
+    else if( xTaskGetCurrentTaskHandle() == xAccelTask )
+    {
+        /* Called from a completion callback: the worker can't wait for itself. */
+        pxJob->pvCompletion = NULL;
+        pxAccelProvider->pxProcess( &pxJob, 1 );
+    }
+    else
+    {
+        /* A semaphore of its own, rather than the task's notification, which
+         * the caller or the libraries it uses may be waiting on. */
+        xCompletion = xSemaphoreCreateBinaryStatic( &xCompletionBuffer );
+
+        pxJob->xStatus = cryptoaccelSTATUS_PENDING;
+        pxJob->pvCompletion = xCompletion;
+
+        ( void ) xQueueSend( xAccelQueue, &pxJob, portMAX_DELAY );
+        ( void ) xSemaphoreTake( xCompletion, portMAX_DELAY );
+
+        vSemaphoreDelete( xCompletion );
+    }
+
+    return pxJob->xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+void CRYPTO_AccelGetStats( CryptoAccelStats_t * pxStats )
+{
+    taskENTER_CRITICAL();
+    {
+        *pxStats = xAccelStats;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+
+#if defined( MBEDTLS_ECDSA_VERIFY_ALT )
+
+/**
+ * @brief Replaces the mbedTLS implementation, see MBEDTLS_ECDSA_VERIFY_ALT.
+ *
+ * P-256 signatures are verified by the accelerator when it supports them.
+ * Everything else is verified in software.
+ */
+    int mbedtls_ecdsa_verify( mbedtls_ecp_group * grp,
+                              const unsigned char * buf,
+                              size_t blen,
+                              const mbedtls_ecp_point * Q,
+                              const mbedtls_mpi * r,
+                              const mbedtls_mpi * s )
+    {
+        int lResult;
+        BaseType_t xStatus = cryptoaccelSTATUS_UNSUPPORTED;
+        CryptoAccelJob_t xJob;
+        uint8_t ucPoint[ 1 + 2 * cryptoaccelP256_BYTES ];
+        uint8_t ucSignature[ 2 * cryptoaccelP256_BYTES ];
+        size_t xPointLength = 0;
+
+        if( ( MBEDTLS_ECP_DP_SECP256R1 == grp->id ) &&
+            ( pdFALSE != CRYPTO_AccelSupports( eCryptoAccelEcdsaP256Verify ) ) &&
+            ( 0 == mbedtls_ecp_point_write_binary( grp,
+                                                   Q,
+                                                   MBEDTLS_ECP_PF_UNCOMPRESSED,
+                                                   &xPointLength,
+                                                   ucPoint,
+                                                   sizeof( ucPoint ) ) ) &&
+            ( sizeof( ucPoint ) == xPointLength ) &&
+            ( 0 == mbedtls_mpi_write_binary( r, ucSignature, cryptoaccelP256_BYTES ) ) &&
+            ( 0 == mbedtls_mpi_write_binary( s, &ucSignature[ cryptoaccelP256_BYTES ], cryptoaccelP256_BYTES ) ) )
+        {
+            memset( &xJob, 0, sizeof( xJob ) );
+            xJob.eOperation = eCryptoAccelEcdsaP256Verify;
+            xJob.pucKey = &ucPoint[ 1 ]; /* Skip the format byte. */
+            xJob.xKeyLength = 2 * cryptoaccelP256_BYTES;
+            xJob.pucInput = buf;
+            xJob.xInputLength = blen;
+            xJob.pucSignature = ucSignature;
+
+            xStatus = CRYPTO_AccelRun( &xJob );
+        }
+
+        if( cryptoaccelSTATUS_OK == xStatus )
+        {
+            lResult = 0;
+        }
+        else if( cryptoaccelSTATUS_FAILED == xStatus )
+        {
+            lResult = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        }
+        else
+        {
+            lResult = CRYPTO_AccelSoftwareEcdsaVerify( grp, buf, blen, Q, r, s );
+        }
+
+        return lResult;
+    }
+
+#endif /* if defined( MBEDTLS_ECDSA_VERIFY_ALT ) */
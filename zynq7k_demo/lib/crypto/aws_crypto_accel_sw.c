@@ -0,0 +1,349 @@
+/*
+ * Amazon FreeRTOS Crypto V1.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_crypto_accel_sw.c
+ * @brief Software reference provider for the crypto accelerator interface.
+ *
+ * It defines the expected results for hardware providers, and the baseline
+ * to compare their throughput with. It does not depend on the FreeRTOS
+ * kernel, so that it can be benchmarked on a host (see
+ * tools/crypto_accel_benchmark).
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "aws_crypto_accel.h"
+
+/* mbedTLS includes. The configuration is selected by the headers, so that
+ * the host build can use its own. */
+#include "mbedtls/sha256.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/ecp.h"
+
+/* C runtime includes. */
+#include <string.h>
+
+/**
+ * @brief Length of a P-256 coordinate, scalar or hash.
+ */
+#define cryptoaccelP256_BYTES    32
+
+/**
+ * @brief The P-256 group. The worker task is the only user, so the table of
+ * multiples of the generator that mbedTLS computes on first use is kept.
+ */
+static mbedtls_ecp_group xP256Group;
+static BaseType_t xP256GroupLoaded = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Verifies an ECDSA signature of a hash (SEC1 4.1.4).
+ *
+ * Same as mbedtls_ecdsa_verify(), which may be routed to the accelerator.
+ */
+int CRYPTO_AccelSoftwareEcdsaVerify( mbedtls_ecp_group * pxGroup,
+                                     const unsigned char * pucHash,
+                                     size_t xHashLength,
+                                     const mbedtls_ecp_point * pxQ,
+                                     const mbedtls_mpi * pxR,
+                                     const mbedtls_mpi * pxS )
+{
+    int lResult = 0;
+    size_t xGroupBytes = ( pxGroup->nbits + 7 ) / 8;
+    mbedtls_mpi xE, xSInv, xU1, xU2;
+    mbedtls_ecp_point xPoint;
+
+    mbedtls_ecp_point_init( &xPoint );
+    mbedtls_mpi_init( &xE );
+    mbedtls_mpi_init( &xSInv );
+    mbedtls_mpi_init( &xU1 );
+    mbedtls_mpi_init( &xU2 );
+
+    /* Fail cleanly on curves that can't be used for ECDSA. */
+    if( NULL == pxGroup->N.p )
+    {
+        lResult = MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+    }
+    /* r and s must be in the range 1..n-1. */
+    else if( ( mbedtls_mpi_cmp_int( pxR, 1 ) < 0 ) ||
+             ( mbedtls_mpi_cmp_mpi( pxR, &pxGroup->N ) >= 0 ) ||
+             ( mbedtls_mpi_cmp_int( pxS, 1 ) < 0 ) ||
+             ( mbedtls_mpi_cmp_mpi( pxS, &pxGroup->N ) >= 0 ) )
+    {
+        lResult = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+    }
+    else
+    {
+        lResult = mbedtls_ecp_check_pubkey( pxGroup, pxQ );
+    }
+
+    /* Derive e from the leftmost bits of the hash. */
+    if( 0 == lResult )
+    {
+        if( xHashLength > xGroupBytes )
+        {
+            xHashLength = xGroupBytes;
+        }
+
+        lResult = mbedtls_mpi_read_binary( &xE, pucHash, xHashLength );
+    }
+
+    if( ( 0 == lResult ) && ( ( xHashLength * 8 ) > pxGroup->nbits ) )
+    {
+        lResult = mbedtls_mpi_shift_r( &xE, xHashLength * 8 - pxGroup->nbits );
+    }
+
+    if( ( 0 == lResult ) && ( mbedtls_mpi_cmp_mpi( &xE, &pxGroup->N ) >= 0 ) )
+    {
+        lResult = mbedtls_mpi_sub_mpi( &xE, &xE, &pxGroup->N );
+    }
+
+    /* u1 = e / s mod n, u2 = r / s mod n. */
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_mpi_inv_mod( &xSInv, pxS, &pxGroup->N );
+    }
+
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_mpi_mul_mpi( &xU1, &xE, &xSInv );
+    }
+
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_mpi_mod_mpi( &xU1, &xU1, &pxGroup->N );
+    }
+
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_mpi_mul_mpi( &xU2, pxR, &xSInv );
+    }
+
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_mpi_mod_mpi( &xU2, &xU2, &pxGroup->N );
+    }
+
+    /* R = u1 G + u2 Q. No secret data is involved, so no blinding. */
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_ecp_muladd( pxGroup, &xPoint, &xU1, &pxGroup->G, &xU2, pxQ );
+    }
+
+    if( ( 0 == lResult ) && ( 0 != mbedtls_ecp_is_zero( &xPoint ) ) )
+    {
+        lResult = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+    }
+
+    /* The signature is valid if xR mod n equals r. */
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_mpi_mod_mpi( &xPoint.X, &xPoint.X, &pxGroup->N );
+    }
+
+    if( ( 0 == lResult ) && ( 0 != mbedtls_mpi_cmp_mpi( &xPoint.X, pxR ) ) )
+    {
+        lResult = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+    }
+
+    mbedtls_ecp_point_free( &xPoint );
+    mbedtls_mpi_free( &xE );
+    mbedtls_mpi_free( &xSInv );
+    mbedtls_mpi_free( &xU1 );
+    mbedtls_mpi_free( &xU2 );
+
+    return lResult;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSha256( CryptoAccelJob_t * pxJob )
+{
+    BaseType_t xStatus = cryptoaccelSTATUS_FAILED;
+
+    if( 0 == mbedtls_sha256_ret( pxJob->pucInput, pxJob->xInputLength, pxJob->pucOutput, 0 ) )
+    {
+        xStatus = cryptoaccelSTATUS_OK;
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvAesEcbEncrypt( CryptoAccelJob_t * pxJob )
+{
+    BaseType_t xStatus = cryptoaccelSTATUS_FAILED;
+    mbedtls_aes_context xAes;
+    size_t xOffset;
+
+    mbedtls_aes_init( &xAes );
+
+    if( ( 0 == ( pxJob->xInputLength % 16u ) ) &&
+        ( 0 == mbedtls_aes_setkey_enc( &xAes, pxJob->pucKey, ( unsigned int ) ( pxJob->xKeyLength * 8u ) ) ) )
+    {
+        xStatus = cryptoaccelSTATUS_OK;
+
+        for( xOffset = 0; xOffset < pxJob->xInputLength; xOffset += 16u )
+        {
+            if( 0 != mbedtls_aes_crypt_ecb( &xAes,
+                                            MBEDTLS_AES_ENCRYPT,
+                                            pxJob->pucInput + xOffset,
+                                            pxJob->pucOutput + xOffset ) )
+            {
+                xStatus = cryptoaccelSTATUS_FAILED;
+                break;
+            }
+        }
+    }
+
+    mbedtls_aes_free( &xAes );
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvEcdsaP256Verify( CryptoAccelJob_t * pxJob )
+{
+    BaseType_t xStatus = cryptoaccelSTATUS_FAILED;
+    uint8_t ucPoint[ 1 + 2 * cryptoaccelP256_BYTES ];
+    mbedtls_ecp_point xQ;
+    mbedtls_mpi xR, xS;
+    int lResult;
+
+    mbedtls_ecp_point_init( &xQ );
+    mbedtls_mpi_init( &xR );
+    mbedtls_mpi_init( &xS );
+
+    if( 2 * cryptoaccelP256_BYTES == pxJob->xKeyLength )
+    {
+        ucPoint[ 0 ] = 0x04; /* Uncompressed. */
+        memcpy( &ucPoint[ 1 ], pxJob->pucKey, 2 * cryptoaccelP256_BYTES );
+
+        lResult = mbedtls_ecp_point_read_binary( &xP256Group, &xQ, ucPoint, sizeof( ucPoint ) );
+
+        if( 0 == lResult )
+        {
+            lResult = mbedtls_mpi_read_binary( &xR, pxJob->pucSignature, cryptoaccelP256_BYTES );
+        }
+
+        if( 0 == lResult )
+        {
+            lResult = mbedtls_mpi_read_binary( &xS, pxJob->pucSignature + cryptoaccelP256_BYTES, cryptoaccelP256_BYTES );
+        }
+
+        if( 0 == lResult )
+        {
+            lResult = CRYPTO_AccelSoftwareEcdsaVerify( &xP256Group,
+                                                       pxJob->pucInput,
+                                                       pxJob->xInputLength,
+                                                       &xQ,
+                                                       &xR,
+                                                       &xS );
+        }
+
+        if( 0 == lResult )
+        {
+            xStatus = cryptoaccelSTATUS_OK;
+        }
+    }
+
+    mbedtls_ecp_point_free( &xQ );
+    mbedtls_mpi_free( &xR );
+    mbedtls_mpi_free( &xS );
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvInit( void )
+{
+    BaseType_t xResult = pdPASS;
+
+    if( pdFALSE == xP256GroupLoaded )
+    {
+        mbedtls_ecp_group_init( &xP256Group );
+
+        if( 0 == mbedtls_ecp_group_load( &xP256Group, MBEDTLS_ECP_DP_SECP256R1 ) )
+        {
+            xP256GroupLoaded = pdTRUE;
+        }
+        else
+        {
+            xResult = pdFAIL;
+        }
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvProcess( CryptoAccelJob_t * const * ppxJobs,
+                        size_t xJobCount )
+{
+    size_t x;
+    CryptoAccelJob_t * pxJob;
+
+    for( x = 0; x < xJobCount; x++ )
+    {
+        pxJob = ppxJobs[ x ];
+
+        switch( pxJob->eOperation )
+        {
+            case eCryptoAccelSha256:
+                pxJob->xStatus = prvSha256( pxJob );
+                break;
+
+            case eCryptoAccelAesEcbEncrypt:
+                pxJob->xStatus = prvAesEcbEncrypt( pxJob );
+                break;
+
+            case eCryptoAccelEcdsaP256Verify:
+                pxJob->xStatus = prvEcdsaP256Verify( pxJob );
+                break;
+
+            default:
+                pxJob->xStatus = cryptoaccelSTATUS_UNSUPPORTED;
+                break;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+const CryptoAccelProvider_t xCryptoAccelSoftwareProvider =
+{
+    "software",
+    cryptoaccelCAPABILITY( eCryptoAccelSha256 ) |
+    cryptoaccelCAPABILITY( eCryptoAccelAesEcbEncrypt ) |
+    cryptoaccelCAPABILITY( eCryptoAccelEcdsaP256Verify ),
+    prvInit,
+    prvProcess
+};
@@ -0,0 +1,889 @@
+/*
+ * Amazon FreeRTOS Crypto V1.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_crypto_p256.c
+ * @brief ECDSA P-256 signing.
+ *
+ * Field elements and scalars are eight 32-bit limbs, little-endian, kept in
+ * Montgomery form. Points are in projective coordinates and combined with
+ * the complete formulas of Renes, Costello and Batina (eprint 2015/1060,
+ * algorithms 4 to 6), so that no input needs special handling.
+ *
+ * k * G is computed with a comb: four teeth spaced 64 bits apart index a
+ * table of 15 affine points, and a second table, multiplied by 2^32,
+ * handles the upper half of each gap. That is 32 doublings and 64 mixed
+ * additions per signature, with table entries selected by scanning.
+ *
+ * The module does not depend on the kernel, so that it can be benchmarked
+ * on a host (see tools/crypto_accel_benchmark).
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "aws_crypto_p256.h"
+
+/* mbedTLS includes. */
+#include "mbedtls/platform_util.h"
+
+/* C runtime includes. */
+#include <string.h>
+
+#define p256LIMBS           8
+#define p256TABLE_ENTRIES   15
+
+/**
+ * @brief A modulus, with the constants of Montgomery multiplication.
+ */
+typedef struct P256Modulus
+{
+    uint32_t ulM[ p256LIMBS ];
+    uint32_t ulR[ p256LIMBS ];  /* 2^256 mod m, i.e. 1 in Montgomery form. */
+    uint32_t ulR2[ p256LIMBS ]; /* 2^512 mod m. */
+    uint32_t ulM0Inv;           /* -m^-1 mod 2^32. */
+} P256Modulus_t;
+
+/**
+ * @brief A point in projective coordinates, in Montgomery form.
+ */
+typedef struct P256Point
+{
+    uint32_t ulX[ p256LIMBS ];
+    uint32_t ulY[ p256LIMBS ];
+    uint32_t ulZ[ p256LIMBS ];
+} P256Point_t;
+
+/**
+ * @brief A point in affine coordinates, in Montgomery form.
+ */
+typedef struct P256AffinePoint
+{
+    uint32_t ulX[ p256LIMBS ];
+    uint32_t ulY[ p256LIMBS ];
+} P256AffinePoint_t;
+
+/*
+ * Curve parameters (FIPS 186-4 D.1.2.3), least significant limb first.
+ */
+static const uint32_t ulP256P[ p256LIMBS ] =
+{
+    0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000000, 0x00000001, 0xFFFFFFFF
+};
+static const uint32_t ulP256N[ p256LIMBS ] =
+{
+    0xFC632551, 0xF3B9CAC2, 0xA7179E84, 0xBCE6FAAD, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0xFFFFFFFF
+};
+static const uint32_t ulP256B[ p256LIMBS ] =
+{
+    0x27D2604B, 0x3BCE3C3E, 0xCC53B0F6, 0x651D06B0, 0x769886BC, 0xB3EBBD55, 0xAA3A93E7, 0x5AC635D8
+};
+static const uint32_t ulP256Gx[ p256LIMBS ] =
+{
+    0xD898C296, 0xF4A13945, 0x2DEB33A0, 0x77037D81, 0x63A440F2, 0xF8BCE6E5, 0xE12C4247, 0x6B17D1F2
+};
+static const uint32_t ulP256Gy[ p256LIMBS ] =
+{
+    0x37BF51F5, 0xCBB64068, 0x6B315ECE, 0x2BCE3357, 0x7C0F9E16, 0x8EE7EB4A, 0xFE1A7F9B, 0x4FE342E2
+};
+
+/*
+ * State set up by CRYPTO_P256Init().
+ */
+static P256Modulus_t xFieldModulus;
+static P256Modulus_t xOrderModulus;
+static uint32_t ulCurveB[ p256LIMBS ];
+static P256AffinePoint_t xCombTable[ 2 ][ p256TABLE_ENTRIES ];
+static BaseType_t xP256Initialized = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief All ones if ulA equals ulB, zero otherwise.
+ */
+static uint32_t prvMaskEqual( uint32_t ulA,
+                              uint32_t ulB )
+{
+    uint32_t ulDiff = ulA ^ ulB;
+
+    return ( ( ( ulDiff | ( 0u - ulDiff ) ) >> 31 ) - 1u );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief All ones if the value is zero, zero otherwise.
+ */
+static uint32_t prvMaskIsZero( const uint32_t * pulA )
+{
+    uint32_t ulOr = 0;
+    BaseType_t i;
+
+    for( i = 0; i < p256LIMBS; i++ )
+    {
+        ulOr |= pulA[ i ];
+    }
+
+    return prvMaskEqual( ulOr, 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pulR = ulMask ? pulA : pulR.
+ */
+static void prvSelect( uint32_t * pulR,
+                       const uint32_t * pulA,
+                       uint32_t ulMask )
+{
+    BaseType_t i;
+
+    for( i = 0; i < p256LIMBS; i++ )
+    {
+        pulR[ i ] = ( pulA[ i ] & ulMask ) | ( pulR[ i ] & ~ulMask );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pulR = pulT mod m, for ulHigh * 2^256 + pulT < 2m.
+ */
+static void prvReduceOnce( uint32_t * pulR,
+                           const uint32_t * pulT,
+                           uint32_t ulHigh,
+                           const P256Modulus_t * pxM )
+{
+    uint32_t ulDiff[ p256LIMBS ];
+    uint32_t ulBorrow = 0;
+    uint64_t ullD;
+    BaseType_t i;
+
+    for( i = 0; i < p256LIMBS; i++ )
+    {
+        ullD = ( uint64_t ) pulT[ i ] - pxM->ulM[ i ] - ulBorrow;
+        ulDiff[ i ] = ( uint32_t ) ullD;
+        ulBorrow = ( uint32_t ) ( ullD >> 32 ) & 1u;
+    }
+
+    /* Keep the difference unless it went negative. */
+    for( i = 0; i < p256LIMBS; i++ )
+    {
+        pulR[ i ] = pulT[ i ];
+    }
+
+    prvSelect( pulR, ulDiff, 0u - ( ulHigh | ( ulBorrow ^ 1u ) ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvAdd( uint32_t * pulR,
+                    const uint32_t * pulA,
+                    const uint32_t * pulB,
+                    const P256Modulus_t * pxM )
+{
+    uint32_t ulSum[ p256LIMBS ];
+    uint64_t ullC = 0;
+    BaseType_t i;
+
+    for( i = 0; i < p256LIMBS; i++ )
+    {
+        ullC += ( uint64_t ) pulA[ i ] + pulB[ i ];
+        ulSum[ i ] = ( uint32_t ) ullC;
+        ullC >>= 32;
+    }
+
+    prvReduceOnce( pulR, ulSum, ( uint32_t ) ullC, pxM );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSub( uint32_t * pulR,
+                    const uint32_t * pulA,
+                    const uint32_t * pulB,
+                    const P256Modulus_t * pxM )
+{
+    uint32_t ulDiff[ p256LIMBS ];
+    uint32_t ulBorrow = 0;
+    uint32_t ulMask;
+    uint64_t ullD;
+    uint64_t ullC = 0;
+    BaseType_t i;
+
+    for( i = 0; i < p256LIMBS; i++ )
+    {
+        ullD = ( uint64_t ) pulA[ i ] - pulB[ i ] - ulBorrow;
+        ulDiff[ i ] = ( uint32_t ) ullD;
+        ulBorrow = ( uint32_t ) ( ullD >> 32 ) & 1u;
+    }
+
+    /* Add m back if the difference went negative. */
+    ulMask = 0u - ulBorrow;
+
+    for( i = 0; i < p256LIMBS; i++ )
+    {
+        ullC += ( uint64_t ) ulDiff[ i ] + ( pxM->ulM[ i ] & ulMask );
+        pulR[ i ] = ( uint32_t ) ullC;
+        ullC >>= 32;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pulR = pulA * pulB / 2^256 mod m (coarsely integrated operand
+ * scanning).
+ */
+static void prvMul( uint32_t * pulR,
+                    const uint32_t * pulA,
+                    const uint32_t * pulB,
+                    const P256Modulus_t * pxM )
+{
+    uint32_t ulT[ p256LIMBS + 2 ] = { 0 };
+    uint32_t ulU;
+    uint64_t ullC;
+    BaseType_t i, j;
+
+    for( i = 0; i < p256LIMBS; i++ )
+    {
+        ullC = 0;
+
+        for( j = 0; j < p256LIMBS; j++ )
+        {
+            ullC += ( uint64_t ) ulT[ j ] + ( uint64_t ) pulA[ j ] * pulB[ i ];
+            ulT[ j ] = ( uint32_t ) ullC;
+            ullC >>= 32;
+        }
+
+        ullC += ulT[ p256LIMBS ];
+        ulT[ p256LIMBS ] = ( uint32_t ) ullC;
+        ulT[ p256LIMBS + 1 ] = ( uint32_t ) ( ullC >> 32 );
+
+        /* Add a multiple of m that clears the lowest limb, and shift. */
+        ulU = ulT[ 0 ] * pxM->ulM0Inv;
+        ullC = ( ( uint64_t ) ulT[ 0 ] + ( uint64_t ) ulU * pxM->ulM[ 0 ] ) >> 32;
+
+        for( j = 1; j < p256LIMBS; j++ )
+        {
+            ullC += ( uint64_t ) ulT[ j ] + ( uint64_t ) ulU * pxM->ulM[ j ];
+            ulT[ j - 1 ] = ( uint32_t ) ullC;
+            ullC >>= 32;
+        }
+
+        ullC += ulT[ p256LIMBS ];
+        ulT[ p256LIMBS - 1 ] = ( uint32_t ) ullC;
+        ulT[ p256LIMBS ] = ulT[ p256LIMBS + 1 ] + ( uint32_t ) ( ullC >> 32 );
+    }
+
+    prvReduceOnce( pulR, ulT, ulT[ p256LIMBS ], pxM );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pulR = pulA^-1, both in Montgomery form, as pulA^(m - 2).
+ *
+ * The exponent is public, so the sequence of operations does not depend on
+ * pulA.
+ */
+static void prvInvert( uint32_t * pulR,
+                       const uint32_t * pulA,
+                       const P256Modulus_t * pxM )
+{
+    uint32_t ulExponent[ p256LIMBS ];
+    uint32_t ulResult[ p256LIMBS ];
+    uint32_t ulBase[ p256LIMBS ];
+    uint64_t ullD;
+    uint32_t ulBorrow = 2;
+    BaseType_t i;
+
+    for( i = 0; i < p256LIMBS; i++ )
+    {
+        ullD = ( uint64_t ) pxM->ulM[ i ] - ulBorrow;
+        ulExponent[ i ] = ( uint32_t ) ullD;
+        ulBorrow = ( uint32_t ) ( ullD >> 32 ) & 1u;
+    }
+
+    memcpy( ulBase, pulA, sizeof( ulBase ) );
+    memcpy( ulResult, pxM->ulR, sizeof( ulResult ) );
+
+    for( i = 255; i >= 0; i-- )
+    {
+        prvMul( ulResult, ulResult, ulResult, pxM );
+
+        if( 0 != ( ( ulExponent[ i / 32 ] >> ( i % 32 ) ) & 1u ) )
+        {
+            prvMul( ulResult, ulResult, ulBase, pxM );
+        }
+    }
+
+    memcpy( pulR, ulResult, sizeof( ulResult ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvToMontgomery( uint32_t * pulR,
+                             const uint32_t * pulA,
+                             const P256Modulus_t * pxM )
+{
+    prvMul( pulR, pulA, pxM->ulR2, pxM );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFromMontgomery( uint32_t * pulR,
+                               const uint32_t * pulA,
+                               const P256Modulus_t * pxM )
+{
+    static const uint32_t ulOne[ p256LIMBS ] = { 1 };
+
+    prvMul( pulR, pulA, ulOne, pxM );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFromBytes( uint32_t * pulR,
+                          const uint8_t * pucBytes )
+{
+    BaseType_t i;
+
+    for( i = 0; i < p256LIMBS; i++ )
+    {
+        pulR[ i ] = ( ( uint32_t ) pucBytes[ 31 - 4 * i ] ) |
+                    ( ( uint32_t ) pucBytes[ 30 - 4 * i ] << 8 ) |
+                    ( ( uint32_t ) pucBytes[ 29 - 4 * i ] << 16 ) |
+                    ( ( uint32_t ) pucBytes[ 28 - 4 * i ] << 24 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvToBytes( uint8_t * pucBytes,
+                        const uint32_t * pulA )
+{
+    BaseType_t i;
+
+    for( i = 0; i < p256LIMBS; i++ )
+    {
+        pucBytes[ 31 - 4 * i ] = ( uint8_t ) pulA[ i ];
+        pucBytes[ 30 - 4 * i ] = ( uint8_t ) ( pulA[ i ] >> 8 );
+        pucBytes[ 29 - 4 * i ] = ( uint8_t ) ( pulA[ i ] >> 16 );
+        pucBytes[ 28 - 4 * i ] = ( uint8_t ) ( pulA[ i ] >> 24 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pdTRUE if 0 < pulA < m. It takes the same time for every value, as
+ * it checks the private key and the nonce. Only the result is branched on,
+ * and an out-of-range value is rejected, so it reveals nothing about the
+ * values that are used.
+ */
+static BaseType_t prvInRange( const uint32_t * pulA,
+                              const P256Modulus_t * pxM )
+{
+    uint32_t ulBorrow = 0;
+    uint64_t ullD;
+    BaseType_t i;
+
+    for( i = 0; i < p256LIMBS; i++ )
+    {
+        ullD = ( uint64_t ) pulA[ i ] - pxM->ulM[ i ] - ulBorrow;
+        ulBorrow = ( uint32_t ) ( ullD >> 32 ) & 1u;
+    }
+
+    return ( BaseType_t ) ( ulBorrow & ~prvMaskIsZero( pulA ) & 1u );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvModulusInit( P256Modulus_t * pxM,
+                            const uint32_t * pulM )
+{
+    uint32_t ulInv = 1;
+    uint64_t ullD;
+    uint32_t ulBorrow = 0;
+    BaseType_t i;
+
+    memcpy( pxM->ulM, pulM, sizeof( pxM->ulM ) );
+
+    /* Newton's iteration doubles the number of correct bits each time. */
+    for( i = 0; i < 5; i++ )
+    {
+        ulInv *= 2u - pulM[ 0 ] * ulInv;
+    }
+
+    pxM->ulM0Inv = 0u - ulInv;
+
+    /* 2^256 mod m is 2^256 - m, as m > 2^255. */
+    for( i = 0; i < p256LIMBS; i++ )
+    {
+        ullD = ( uint64_t ) 0 - pulM[ i ] - ulBorrow;
+        pxM->ulR[ i ] = ( uint32_t ) ullD;
+        ulBorrow = ( uint32_t ) ( ullD >> 32 ) & 1u;
+    }
+
+    /* Double it 256 more times for 2^512 mod m. */
+    memcpy( pxM->ulR2, pxM->ulR, sizeof( pxM->ulR2 ) );
+
+    for( i = 0; i < 256; i++ )
+    {
+        prvAdd( pxM->ulR2, pxM->ulR2, pxM->ulR2, pxM );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pxR = pxP + pxQ (algorithm 4, a = -3).
+ */
+static void prvPointAdd( P256Point_t * pxR,
+                         const P256Point_t * pxP,
+                         const P256Point_t * pxQ )
+{
+    const P256Modulus_t * pxM = &xFieldModulus;
+    uint32_t t0[ p256LIMBS ], t1[ p256LIMBS ], t2[ p256LIMBS ], t3[ p256LIMBS ], t4[ p256LIMBS ];
+    uint32_t X3[ p256LIMBS ], Y3[ p256LIMBS ], Z3[ p256LIMBS ];
+
+    prvMul( t0, pxP->ulX, pxQ->ulX, pxM );
+    prvMul( t1, pxP->ulY, pxQ->ulY, pxM );
+    prvMul( t2, pxP->ulZ, pxQ->ulZ, pxM );
+    prvAdd( t3, pxP->ulX, pxP->ulY, pxM );
+    prvAdd( t4, pxQ->ulX, pxQ->ulY, pxM );
+    prvMul( t3, t3, t4, pxM );
+    prvAdd( t4, t0, t1, pxM );
+    prvSub( t3, t3, t4, pxM );
+    prvAdd( t4, pxP->ulY, pxP->ulZ, pxM );
+    prvAdd( X3, pxQ->ulY, pxQ->ulZ, pxM );
+    prvMul( t4, t4, X3, pxM );
+    prvAdd( X3, t1, t2, pxM );
+    prvSub( t4, t4, X3, pxM );
+    prvAdd( X3, pxP->ulX, pxP->ulZ, pxM );
+    prvAdd( Y3, pxQ->ulX, pxQ->ulZ, pxM );
+    prvMul( X3, X3, Y3, pxM );
+    prvAdd( Y3, t0, t2, pxM );
+    prvSub( Y3, X3, Y3, pxM );
+    prvMul( Z3, ulCurveB, t2, pxM );
+    prvSub( X3, Y3, Z3, pxM );
+    prvAdd( Z3, X3, X3, pxM );
+    prvAdd( X3, X3, Z3, pxM );
+    prvSub( Z3, t1, X3, pxM );
+    prvAdd( X3, t1, X3, pxM );
+    prvMul( Y3, ulCurveB, Y3, pxM );
+    prvAdd( t1, t2, t2, pxM );
+    prvAdd( t2, t1, t2, pxM );
+    prvSub( Y3, Y3, t2, pxM );
+    prvSub( Y3, Y3, t0, pxM );
+    prvAdd( t1, Y3, Y3, pxM );
+    prvAdd( Y3, t1, Y3, pxM );
+    prvAdd( t1, t0, t0, pxM );
+    prvAdd( t0, t1, t0, pxM );
+    prvSub( t0, t0, t2, pxM );
+    prvMul( t1, t4, Y3, pxM );
+    prvMul( t2, t0, Y3, pxM );
+    prvMul( Y3, X3, Z3, pxM );
+    prvAdd( Y3, Y3, t2, pxM );
+    prvMul( X3, t3, X3, pxM );
+    prvSub( X3, X3, t1, pxM );
+    prvMul( Z3, t4, Z3, pxM );
+    prvMul( t1, t3, t0, pxM );
+    prvAdd( Z3, Z3, t1, pxM );
+
+    memcpy( pxR->ulX, X3, sizeof( X3 ) );
+    memcpy( pxR->ulY, Y3, sizeof( Y3 ) );
+    memcpy( pxR->ulZ, Z3, sizeof( Z3 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pxR = pxP + pxQ (algorithm 5, a = -3). pxQ can't be the point at
+ * infinity, which has no affine coordinates.
+ */
+static void prvPointAddMixed( P256Point_t * pxR,
+                              const P256Point_t * pxP,
+                              const P256AffinePoint_t * pxQ )
+{
+    const P256Modulus_t * pxM = &xFieldModulus;
+    uint32_t t0[ p256LIMBS ], t1[ p256LIMBS ], t2[ p256LIMBS ], t3[ p256LIMBS ], t4[ p256LIMBS ];
+    uint32_t X3[ p256LIMBS ], Y3[ p256LIMBS ], Z3[ p256LIMBS ];
+
+    prvMul( t0, pxP->ulX, pxQ->ulX, pxM );
+    prvMul( t1, pxP->ulY, pxQ->ulY, pxM );
+    prvAdd( t3, pxQ->ulX, pxQ->ulY, pxM );
+    prvAdd( t4, pxP->ulX, pxP->ulY, pxM );
+    prvMul( t3, t3, t4, pxM );
+    prvAdd( t4, t0, t1, pxM );
+    prvSub( t3, t3, t4, pxM );
+    prvMul( t4, pxQ->ulY, pxP->ulZ, pxM );
+    prvAdd( t4, t4, pxP->ulY, pxM );
+    prvMul( Y3, pxQ->ulX, pxP->ulZ, pxM );
+    prvAdd( Y3, Y3, pxP->ulX, pxM );
+    prvMul( Z3, ulCurveB, pxP->ulZ, pxM );
+    prvSub( X3, Y3, Z3, pxM );
+    prvAdd( Z3, X3, X3, pxM );
+    prvAdd( X3, X3, Z3, pxM );
+    prvSub( Z3, t1, X3, pxM );
+    prvAdd( X3, t1, X3, pxM );
+    prvMul( Y3, ulCurveB, Y3, pxM );
+    prvAdd( t1, pxP->ulZ, pxP->ulZ, pxM );
+    prvAdd( t2, t1, pxP->ulZ, pxM );
+    prvSub( Y3, Y3, t2, pxM );
+    prvSub( Y3, Y3, t0, pxM );
+    prvAdd( t1, Y3, Y3, pxM );
+    prvAdd( Y3, t1, Y3, pxM );
+    prvAdd( t1, t0, t0, pxM );
+    prvAdd( t0, t1, t0, pxM );
+    prvSub( t0, t0, t2, pxM );
+    prvMul( t1, t4, Y3, pxM );
+    prvMul( t2, t0, Y3, pxM );
+    prvMul( Y3, X3, Z3, pxM );
+    prvAdd( Y3, Y3, t2, pxM );
+    prvMul( X3, t3, X3, pxM );
+    prvSub( X3, X3, t1, pxM );
+    prvMul( Z3, t4, Z3, pxM );
+    prvMul( t1, t3, t0, pxM );
+    prvAdd( Z3, Z3, t1, pxM );
+
+    memcpy( pxR->ulX, X3, sizeof( X3 ) );
+    memcpy( pxR->ulY, Y3, sizeof( Y3 ) );
+    memcpy( pxR->ulZ, Z3, sizeof( Z3 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pxR = 2 * pxP (algorithm 6, a = -3).
+ */
+static void prvPointDouble( P256Point_t * pxR,
+                            const P256Point_t * pxP )
+{
+    const P256Modulus_t * pxM = &xFieldModulus;
+    uint32_t t0[ p256LIMBS ], t1[ p256LIMBS ], t2[ p256LIMBS ], t3[ p256LIMBS ];
+    uint32_t X3[ p256LIMBS ], Y3[ p256LIMBS ], Z3[ p256LIMBS ];
+
+    prvMul( t0, pxP->ulX, pxP->ulX, pxM );
+    prvMul( t1, pxP->ulY, pxP->ulY, pxM );
+    prvMul( t2, pxP->ulZ, pxP->ulZ, pxM );
+    prvMul( t3, pxP->ulX, pxP->ulY, pxM );
+    prvAdd( t3, t3, t3, pxM );
+    prvMul( Z3, pxP->ulX, pxP->ulZ, pxM );
+    prvAdd( Z3, Z3, Z3, pxM );
+    prvMul( Y3, ulCurveB, t2, pxM );
+    prvSub( Y3, Y3, Z3, pxM );
+    prvAdd( X3, Y3, Y3, pxM );
+    prvAdd( Y3, X3, Y3, pxM );
+    prvSub( X3, t1, Y3, pxM );
+    prvAdd( Y3, t1, Y3, pxM );
+    prvMul( Y3, X3, Y3, pxM );
+    prvMul( X3, X3, t3, pxM );
+    prvAdd( t3, t2, t2, pxM );
+    prvAdd( t2, t2, t3, pxM );
+    prvMul( Z3, ulCurveB, Z3, pxM );
+    prvSub( Z3, Z3, t2, pxM );
+    prvSub( Z3, Z3, t0, pxM );
+    prvAdd( t3, Z3, Z3, pxM );
+    prvAdd( Z3, Z3, t3, pxM );
+    prvAdd( t3, t0, t0, pxM );
+    prvAdd( t0, t3, t0, pxM );
+    prvSub( t0, t0, t2, pxM );
+    prvMul( t0, t0, Z3, pxM );
+    prvAdd( Y3, Y3, t0, pxM );
+    prvMul( t0, pxP->ulY, pxP->ulZ, pxM );
+    prvAdd( t0, t0, t0, pxM );
+    prvMul( Z3, t0, Z3, pxM );
+    prvSub( X3, X3, Z3, pxM );
+    prvMul( Z3, t0, t1, pxM );
+    prvAdd( Z3, Z3, Z3, pxM );
+    prvAdd( Z3, Z3, Z3, pxM );
+
+    memcpy( pxR->ulX, X3, sizeof( X3 ) );
+    memcpy( pxR->ulY, Y3, sizeof( Y3 ) );
+    memcpy( pxR->ulZ, Z3, sizeof( Z3 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPointToAffine( P256AffinePoint_t * pxR,
+                              const P256Point_t * pxP )
+{
+    uint32_t ulZInv[ p256LIMBS ];
+
+    prvInvert( ulZInv, pxP->ulZ, &xFieldModulus );
+    prvMul( pxR->ulX, pxP->ulX, ulZInv, &xFieldModulus );
+    prvMul( pxR->ulY, pxP->ulY, ulZInv, &xFieldModulus );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Four bits of the scalar, 64 bits apart, starting at bit uxBit.
+ */
+static uint32_t prvCombDigit( const uint32_t * pulK,
+                              UBaseType_t uxBit )
+{
+    uint32_t ulDigit = 0;
+    UBaseType_t uxTooth;
+
+    for( uxTooth = 0; uxTooth < 4; uxTooth++ )
+    {
+        ulDigit |= ( ( pulK[ ( uxBit + 64 * uxTooth ) / 32 ] >> ( uxBit % 32 ) ) & 1u ) << uxTooth;
+    }
+
+    return ulDigit;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pxR = pxR + pxTable[ ulDigit - 1 ], or pxR if ulDigit is zero,
+ * reading every entry of the table.
+ */
+static void prvCombAdd( P256Point_t * pxR,
+                        const P256AffinePoint_t * pxTable,
+                        uint32_t ulDigit )
+{
+    P256AffinePoint_t xEntry;
+    P256Point_t xSum;
+    uint32_t ulMask;
+    uint32_t ulIndex;
+
+    memset( &xEntry, 0, sizeof( xEntry ) );
+
+    for( ulIndex = 0; ulIndex < p256TABLE_ENTRIES; ulIndex++ )
+    {
+        ulMask = prvMaskEqual( ulIndex + 1u, ulDigit );
+        prvSelect( xEntry.ulX, pxTable[ ulIndex ].ulX, ulMask );
+        prvSelect( xEntry.ulY, pxTable[ ulIndex ].ulY, ulMask );
+    }
+
+    prvPointAddMixed( &xSum, pxR, &xEntry );
+
+    ulMask = ~prvMaskEqual( ulDigit, 0 );
+    prvSelect( pxR->ulX, xSum.ulX, ulMask );
+    prvSelect( pxR->ulY, xSum.ulY, ulMask );
+    prvSelect( pxR->ulZ, xSum.ulZ, ulMask );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pxR = k * G, for a scalar k in plain form.
+ */
+static void prvMulGenerator( P256AffinePoint_t * pxR,
+                             const uint32_t * pulK )
+{
+    P256Point_t xQ;
+    BaseType_t j;
+
+    /* The point at infinity, (0 : 1 : 0). */
+    memset( &xQ, 0, sizeof( xQ ) );
+    memcpy( xQ.ulY, xFieldModulus.ulR, sizeof( xQ.ulY ) );
+
+    for( j = 31; j >= 0; j-- )
+    {
+        prvPointDouble( &xQ, &xQ );
+        prvCombAdd( &xQ, xCombTable[ 0 ], prvCombDigit( pulK, ( UBaseType_t ) j ) );
+        prvCombAdd( &xQ, xCombTable[ 1 ], prvCombDigit( pulK, ( UBaseType_t ) j + 32 ) );
+    }
+
+    prvPointToAffine( pxR, &xQ );
+    mbedtls_platform_zeroize( &xQ, sizeof( xQ ) );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t CRYPTO_P256Init( void )
+{
+    P256Point_t xTeeth[ 4 ];
+    P256Point_t xSum;
+    UBaseType_t uxTooth, uxIndex, uxDouble;
+
+    if( pdFALSE == xP256Initialized )
+    {
+        prvModulusInit( &xFieldModulus, ulP256P );
+        prvModulusInit( &xOrderModulus, ulP256N );
+        prvToMontgomery( ulCurveB, ulP256B, &xFieldModulus );
+
+        /* 2^(64 i) * G for each tooth. */
+        prvToMontgomery( xTeeth[ 0 ].ulX, ulP256Gx, &xFieldModulus );
+        prvToMontgomery( xTeeth[ 0 ].ulY, ulP256Gy, &xFieldModulus );
+        memcpy( xTeeth[ 0 ].ulZ, xFieldModulus.ulR, sizeof( xTeeth[ 0 ].ulZ ) );
+
+        for( uxTooth = 1; uxTooth < 4; uxTooth++ )
+        {
+            xTeeth[ uxTooth ] = xTeeth[ uxTooth - 1 ];
+
+            for( uxDouble = 0; uxDouble < 64; uxDouble++ )
+            {
+                prvPointDouble( &xTeeth[ uxTooth ], &xTeeth[ uxTooth ] );
+            }
+        }
+
+        /* Entry i - 1 holds the sum of the teeth selected by the bits of i. */
+        for( uxIndex = 1; uxIndex <= p256TABLE_ENTRIES; uxIndex++ )
+        {
+            memset( &xSum, 0, sizeof( xSum ) );
+            memcpy( xSum.ulY, xFieldModulus.ulR, sizeof( xSum.ulY ) );
+
+            for( uxTooth = 0; uxTooth < 4; uxTooth++ )
+            {
+                if( 0 != ( uxIndex & ( 1u << uxTooth ) ) )
+                {
+                    prvPointAdd( &xSum, &xSum, &xTeeth[ uxTooth ] );
+                }
+            }
+
+            prvPointToAffine( &xCombTable[ 0 ][ uxIndex - 1 ], &xSum );
+
+            for( uxDouble = 0; uxDouble < 32; uxDouble++ )
+            {
+                prvPointDouble( &xSum, &xSum );
+            }
+
+            prvPointToAffine( &xCombTable[ 1 ][ uxIndex - 1 ], &xSum );
+        }
+
+        xP256Initialized = pdTRUE;
+    }
+
+    return pdPASS;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t CRYPTO_P256ImportKey( CryptoP256Key_t * pxKey,
+                                 const uint8_t * pucPrivateKey )
+{
+    BaseType_t xResult = pdFAIL;
+    uint32_t ulD[ p256LIMBS ];
+
+    prvFromBytes( ulD, pucPrivateKey );
+
+    if( ( pdFALSE != xP256Initialized ) && ( pdTRUE == prvInRange( ulD, &xOrderModulus ) ) )
+    {
+        prvToMontgomery( pxKey->ulD, ulD, &xOrderModulus );
+        xResult = pdPASS;
+    }
+
+    mbedtls_platform_zeroize( ulD, sizeof( ulD ) );
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+void CRYPTO_P256FreeKey( CryptoP256Key_t * pxKey )
+{
+    mbedtls_platform_zeroize( pxKey, sizeof( CryptoP256Key_t ) );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t CRYPTO_P256Sign( const CryptoP256Key_t * pxKey,
+                            const uint8_t * pucHash,
+                            size_t xHashLength,
+                            uint8_t * pucSignature,
+                            int ( * pxRng )( void *, unsigned char *, size_t ),
+                            void * pvRng )
+{
+    const P256Modulus_t * pxN = &xOrderModulus;
+    BaseType_t xResult = pdFAIL;
+    BaseType_t xAttempt;
+    uint8_t ucBuffer[ cryptoP256_BYTES ];
+    uint32_t ulE[ p256LIMBS ];
+    uint32_t ulK[ p256LIMBS ];
+    uint32_t ulR[ p256LIMBS ];
+    uint32_t ulS[ p256LIMBS ];
+    P256AffinePoint_t xKG;
+
+    if( pdFALSE == xP256Initialized )
+    {
+        return pdFAIL;
+    }
+
+    /* e is the leftmost 256 bits of the hash, reduced mod n. */
+    if( xHashLength > cryptoP256_BYTES )
+    {
+        xHashLength = cryptoP256_BYTES;
+    }
+
+    memset( ucBuffer, 0, sizeof( ucBuffer ) );
+    memcpy( &ucBuffer[ cryptoP256_BYTES - xHashLength ], pucHash, xHashLength );
+    prvFromBytes( ulE, ucBuffer );
+    prvReduceOnce( ulE, ulE, 0, pxN );
+    prvToMontgomery( ulE, ulE, pxN );
+
+    /* Like mbedTLS, give up after a few unlucky nonces. */
+    for( xAttempt = 0; ( xAttempt < 10 ) && ( pdFAIL == xResult ); xAttempt++ )
+    {
+        if( 0 != pxRng( pvRng, ucBuffer, sizeof( ucBuffer ) ) )
+        {
+            break;
+        }
+
+        prvFromBytes( ulK, ucBuffer );
+
+        if( pdTRUE != prvInRange( ulK, pxN ) )
+        {
+            continue;
+        }
+
+        /* r = x( k * G ) mod n. */
+        prvMulGenerator( &xKG, ulK );
+        prvFromMontgomery( ulR, xKG.ulX, &xFieldModulus );
+        prvReduceOnce( ulR, ulR, 0, pxN );
+
+        if( 0u != prvMaskIsZero( ulR ) )
+        {
+            continue;
+        }
+
+        /* s = ( e + r * d ) / k mod n. */
+        prvToMontgomery( ulS, ulR, pxN );
+        prvMul( ulS, ulS, pxKey->ulD, pxN );
+        prvAdd( ulS, ulS, ulE, pxN );
+        prvToMontgomery( ulK, ulK, pxN );
+        prvInvert( ulK, ulK, pxN );
+        prvMul( ulS, ulS, ulK, pxN );
+        prvFromMontgomery( ulS, ulS, pxN );
+
+        if( 0u != prvMaskIsZero( ulS ) )
+        {
+            continue;
+        }
+
+        prvToBytes( pucSignature, ulR );
+        prvToBytes( &pucSignature[ cryptoP256_BYTES ], ulS );
+        xResult = pdPASS;
+    }
+
+    mbedtls_platform_zeroize( ucBuffer, sizeof( ucBuffer ) );
+    mbedtls_platform_zeroize( ulK, sizeof( ulK ) );
+    mbedtls_platform_zeroize( ulS, sizeof( ulS ) );
+    mbedtls_platform_zeroize( &xKG, sizeof( xKG ) );
+
+    return xResult;
+}
@@ -24,15 +24,64 @@
  */
 #include <stdint.h>
 
+#include "FreeRTOS.h"
+#include "task.h"
+
 #include "aws_defender_cpu.h"
 
+#if ( configGENERATE_RUN_TIME_STATS != 1 )
+    #error Defender CPU load needs configGENERATE_RUN_TIME_STATS set to 1.
+#endif
+
+#ifndef configNUM_CORES
+    #define configNUM_CORES    1
+#endif
+
+/* -1 until the first refresh has a period to measure. */
+static int32_t lDefenderCpuLoadPercent = -1;
+
 int32_t CpuLoadGet( void )
 {
-    /* #error return CPU as a percentage * cores. */
-    return -1;
+    return lDefenderCpuLoadPercent;
 }
 
+/* The load is the time the idle tasks did not run, as a percentage of the
+ * time since the previous refresh, so 100 per busy core. */
 void CpuLoadRefresh( void )
 {
-    /* #error measure and store CPU percentage * cores. */
+    static uint32_t ulPrevTotalTime = 0;
+    static uint32_t ulPrevIdleTime = 0;
+    static BaseType_t xHavePrev = pdFALSE;
+    uint32_t ulTotalTime;
+    uint32_t ulIdleTime;
+    uint32_t ulDeltaTotal;
+    uint32_t ulDeltaIdle;
+
+    ulIdleTime = ulTaskGetIdleRunTimeCounter();
+
+    #ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+        portALT_GET_RUN_TIME_COUNTER_VALUE( ulTotalTime );
+    #else
+        ulTotalTime = portGET_RUN_TIME_COUNTER_VALUE();
+    #endif
+
+    /* Unsigned differences are correct across a counter wrap. */
+    ulDeltaTotal = ulTotalTime - ulPrevTotalTime;
+    ulDeltaIdle = ulIdleTime - ulPrevIdleTime;
+
+    if( ( pdTRUE == xHavePrev ) && ( ulDeltaTotal >= 100U ) )
+    {
+        ulDeltaIdle /= ( ulDeltaTotal / 100U );
+
+        if( ulDeltaIdle > ( configNUM_CORES * 100U ) )
+        {
+            ulDeltaIdle = configNUM_CORES * 100U;
+        }
+
+        lDefenderCpuLoadPercent = ( int32_t ) ( ( configNUM_CORES * 100U ) - ulDeltaIdle );
+    }
+
+    ulPrevTotalTime = ulTotalTime;
+    ulPrevIdleTime = ulIdleTime;
+    xHavePrev = pdTRUE;
 }
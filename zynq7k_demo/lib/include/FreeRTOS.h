@@ -58,6 +58,11 @@ extern "C" {
 /* Basic FreeRTOS definitions. */
 #include "projdefs.h"
 
+/* Must be defaulted before portable.h, as portmacro.h can depend on it. */
+#ifndef configNUM_CORES
+	#define configNUM_CORES 1
+#endif
+
 /* Definitions specific to the port being used. */
 #include "portable.h"
 
@@ -254,6 +259,27 @@ extern "C" {
 
 #endif /* configUSE_TIMERS */
 
+/* Set configUSE_TIMER_WHEEL to 1 to keep active software timers in a
+hierarchical timing wheel rather than in sorted lists, see timers.c. */
+#ifndef configUSE_TIMER_WHEEL
+	#define configUSE_TIMER_WHEEL 0
+#endif
+
+/* Each level of the timer wheel has 2^configTIMER_WHEEL_SLOT_BITS slots. */
+#ifndef configTIMER_WHEEL_SLOT_BITS
+	#define configTIMER_WHEEL_SLOT_BITS 5
+#endif
+
+#if( ( configTIMER_WHEEL_SLOT_BITS < 1 ) || ( configTIMER_WHEEL_SLOT_BITS > 5 ) )
+	#error configTIMER_WHEEL_SLOT_BITS must be between 1 and 5.
+#endif
+
+/* The writers' and the reader's indexes of a ring queue are kept this many
+bytes apart so that they are not in the same cache line, see ring_queue.c. */
+#ifndef configRING_QUEUE_CACHE_LINE_SIZE
+	#define configRING_QUEUE_CACHE_LINE_SIZE 32
+#endif
+
 #ifndef portSET_INTERRUPT_MASK_FROM_ISR
 	#define portSET_INTERRUPT_MASK_FROM_ISR() 0
 #endif
@@ -544,6 +570,26 @@ extern "C" {
 	#define traceTIMER_COMMAND_RECEIVED( pxTimer, xMessageID, xMessageValue )
 #endif
 
+#ifndef configUSE_HEAP_TRACE
+	#define configUSE_HEAP_TRACE 0
+#endif
+
+#if ( configUSE_HEAP_TRACE == 1 )
+	/* Record each allocation and free for heap_trace.c, with the address
+	pvPortMalloc() or vPortFree() was called from. */
+	#ifndef configHEAP_TRACE_CALLER
+		#define configHEAP_TRACE_CALLER() __builtin_return_address( 0 )
+	#endif
+
+	#ifndef traceMALLOC
+		#define traceMALLOC( pvAddress, uiSize ) vHeapTraceMalloc( ( pvAddress ), ( uiSize ), configHEAP_TRACE_CALLER() )
+	#endif
+
+	#ifndef traceFREE
+		#define traceFREE( pvAddress, uiSize ) vHeapTraceFree( ( pvAddress ), ( uiSize ), configHEAP_TRACE_CALLER() )
+	#endif
+#endif
+
 #ifndef traceMALLOC
     #define traceMALLOC( pvAddress, uiSize )
 #endif
@@ -718,6 +764,58 @@ extern "C" {
 	#define portPRIVILEGE_BIT ( ( UBaseType_t ) 0x00 )
 #endif
 
+#if ( configNUM_CORES > 1 )
+
+	/* A port that runs the scheduler on more than one core must say which core
+	is executing, interrupt another core so it selects a new task, and provide
+	two recursive spinlocks.  Tasks take the task lock and then the ISR lock,
+	interrupts take only the ISR lock.  The critical nesting count is per
+	core. */
+	#ifndef portGET_CORE_ID
+		#error portGET_CORE_ID() must be defined in portmacro.h when configNUM_CORES is greater than 1.
+	#endif
+
+	#ifndef portYIELD_CORE
+		#error portYIELD_CORE() must be defined in portmacro.h when configNUM_CORES is greater than 1.
+	#endif
+
+	#if !defined( portGET_TASK_LOCK ) || !defined( portRELEASE_TASK_LOCK ) || !defined( portGET_ISR_LOCK ) || !defined( portRELEASE_ISR_LOCK )
+		#error The task and ISR lock macros must be defined in portmacro.h when configNUM_CORES is greater than 1.
+	#endif
+
+	#if !defined( portGET_CRITICAL_NESTING_COUNT ) || !defined( portINCREMENT_CRITICAL_NESTING_COUNT ) || !defined( portDECREMENT_CRITICAL_NESTING_COUNT )
+		#error The critical nesting count macros must be defined in portmacro.h when configNUM_CORES is greater than 1.
+	#endif
+
+	#ifndef portCHECK_IF_IN_ISR
+		#error portCHECK_IF_IN_ISR() must be defined in portmacro.h when configNUM_CORES is greater than 1.
+	#endif
+
+	#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+		#error configUSE_PORT_OPTIMISED_TASK_SELECTION must be 0 when configNUM_CORES is greater than 1.
+	#endif
+
+	#if ( configUSE_PREEMPTION == 0 )
+		#error configUSE_PREEMPTION must be 1 when configNUM_CORES is greater than 1.
+	#endif
+
+	#if ( portCRITICAL_NESTING_IN_TCB == 1 )
+		#error portCRITICAL_NESTING_IN_TCB must be 0 when configNUM_CORES is greater than 1.
+	#endif
+
+	/* _impure_ptr and FreeRTOS_errno are single global variables, so cannot
+	follow the tasks running on more than one core. */
+	#if ( ( configUSE_NEWLIB_REENTRANT == 1 ) || ( configUSE_POSIX_ERRNO == 1 ) )
+		#error configUSE_NEWLIB_REENTRANT and configUSE_POSIX_ERRNO must be 0 when configNUM_CORES is greater than 1.
+	#endif
+
+	/* A task cannot be switched out while it holds the kernel locks, so a
+	yield requested inside a critical section is held pending until the
+	critical section is exited. */
+	#define portYIELD_WITHIN_API vTaskYieldWithinAPI
+
+#endif /* configNUM_CORES */
+
 #ifndef portYIELD_WITHIN_API
 	#define portYIELD_WITHIN_API portYIELD
 #endif
@@ -782,6 +880,12 @@ extern "C" {
 	#define configUSE_TRACE_FACILITY 0
 #endif
 
+/* Set to 1 when FreeRTOSConfig.h includes the Tracealyzer recorder's
+trcRecorder.h, so code outside the kernel can record user events. */
+#ifndef configUSE_TRACE_RECORDER
+	#define configUSE_TRACE_RECORDER 0
+#endif
+
 #ifndef mtCOVERAGE_TEST_MARKER
 	#define mtCOVERAGE_TEST_MARKER()
 #endif
@@ -802,6 +906,17 @@ extern "C" {
 	#define configAPPLICATION_ALLOCATED_HEAP 0
 #endif
 
+/* The number of allocation tags heap_6.c keeps statistics for, or 0 to not tag
+allocations. */
+#ifndef configHEAP_TAGS
+	#define configHEAP_TAGS 0
+#endif
+
+/* The number of records heap_trace.c holds until they are read. */
+#ifndef configHEAP_TRACE_LENGTH
+	#define configHEAP_TRACE_LENGTH 256
+#endif
+
 #ifndef configUSE_TASK_NOTIFICATIONS
 	#define configUSE_TASK_NOTIFICATIONS 1
 #endif
@@ -835,6 +950,9 @@ extern "C" {
 	#if( INCLUDE_vTaskSuspend != 1 )
 		#error INCLUDE_vTaskSuspend must be set to 1 if configUSE_TICKLESS_IDLE is not set to 0
 	#endif /* INCLUDE_vTaskSuspend */
+	#if( configNUM_CORES > 1 )
+		#error configUSE_TICKLESS_IDLE must be 0 when configNUM_CORES is greater than 1.
+	#endif /* configNUM_CORES */
 #endif /* configUSE_TICKLESS_IDLE */
 
 #if( ( configSUPPORT_STATIC_ALLOCATION == 0 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 0 ) )
@@ -1032,6 +1150,10 @@ typedef struct xSTATIC_TCB
 	#if ( configUSE_POSIX_ERRNO == 1 )
 		int             iDummy22;
 	#endif
+	#if ( configNUM_CORES > 1 )
+		BaseType_t		xDummy23;
+		UBaseType_t		uxDummy24;
+	#endif
 } StaticTask_t;
 
 /*
@@ -1128,6 +1250,11 @@ typedef struct xSTATIC_TIMER
 	TickType_t			xDummy3;
 	UBaseType_t			uxDummy4;
 	void 				*pvDummy5[ 2 ];
+	#if( configUSE_TIMER_WHEEL == 1 )
+		void			*pvDummy8;
+		BaseType_t		xDummy9;
+		TickType_t		xDummy10[ 2 ];
+	#endif
 	#if( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t		uxDummy6;
 	#endif
@@ -0,0 +1,317 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+
+/*
+ * An arena is a fixed region of memory reserved for one subsystem, such as
+ * mbedTLS or the TCP stack's stream buffers.  Allocations from an arena never
+ * take memory from the FreeRTOS heap or from another arena, so a burst in one
+ * subsystem cannot starve another, and a subsystem that exceeds its budget
+ * fails on its own.
+ *
+ * Blocks are rounded up to one of four size classes for each power of two, so
+ * no more than a quarter of a block is lost to rounding.  A block is taken
+ * from the free list of its class, or carved from the unused end of the arena,
+ * in a constant number of steps.  Freed blocks go back to the free list of
+ * their class and are not merged, so an arena suits a subsystem that allocates
+ * the same sizes again and again, such as one TLS connection after another.
+ * vArenaReset() frees every block at once, for example at the end of parsing
+ * a document.
+ *
+ * Arenas may be used from any number of tasks, but not from interrupts.
+ * Allocations and frees take a short critical section.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include arena.h"
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/**
+ * Type by which arenas are referenced.  For example, a call to xArenaCreate()
+ * returns an ArenaHandle_t variable that can then be used as a parameter to
+ * pvArenaMalloc(), vArenaFree(), etc.
+ */
+typedef void * ArenaHandle_t;
+
+/**
+ * Used with vArenaGetStats() and uxArenaGetSystemState() to report how an
+ * arena's memory is used.
+ */
+typedef struct xARENA_STATS
+{
+	const char *pcName;				/* The name given to the arena when it was created. */
+	size_t xBudget;					/* The bytes the arena can hand out, after its own bookkeeping. */
+	size_t xBytesInUse;				/* The bytes in blocks that are allocated, including their headers and rounding. */
+	size_t xMaximumBytesInUse;		/* The most bytes that have been in use at once since the arena was created. */
+	size_t xBytesCarved;			/* The bytes divided into blocks.  The rest of the budget has never been used. */
+	UBaseType_t uxBlocksInUse;		/* The number of blocks that are allocated. */
+	uint32_t ulAllocations;			/* The number of allocations that succeeded. */
+	uint32_t ulFailures;			/* The number of allocations that failed because the arena was full. */
+} ArenaStats_t;
+
+/**
+ * arena.h
+ *
+<pre>
+ArenaHandle_t xArenaCreate( const char *pcName, size_t xBudget );
+</pre>
+ *
+ * Creates an arena, reserving xBudget bytes for it from the FreeRTOS heap.
+ *
+ * configSUPPORT_DYNAMIC_ALLOCATION must be set to 1 or left undefined in
+ * FreeRTOSConfig.h for xArenaCreate() to be available.
+ *
+ * @param pcName A name for the arena, which is reported in its statistics.
+ * Only the pointer is kept.
+ *
+ * @param xBudget The number of bytes to reserve.  A few hundred of them hold
+ * the arena's own bookkeeping, and each block has a header of
+ * portBYTE_ALIGNMENT bytes.
+ *
+ * @return A handle to the created arena, or NULL if there was not enough heap
+ * memory to create it.
+ *
+ * \defgroup xArenaCreate xArenaCreate
+ * \ingroup ArenaManagement
+ */
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	ArenaHandle_t xArenaCreate( const char *pcName, size_t xBudget ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * arena.h
+ *
+<pre>
+ArenaHandle_t xArenaCreateStatic( const char *pcName, uint8_t *pucStorage, size_t xStorageSize );
+</pre>
+ *
+ * Creates an arena in memory provided by the application, such as a static
+ * array, so that its budget is set aside when the application is linked.  An
+ * arena can also be created in a block allocated from another arena, to give
+ * part of a subsystem's budget to one operation and free it all at once.
+ *
+ * @param pcName A name for the arena, which is reported in its statistics.
+ *
+ * @param pucStorage The memory the arena manages.  It need not be aligned.
+ *
+ * @param xStorageSize The size of pucStorage in bytes.
+ *
+ * @return A handle to the created arena, or NULL if xStorageSize is too small
+ * to hold the arena's bookkeeping and one block.
+ *
+ * Example use:
+<pre>
+static uint8_t ucParserStorage[ 8192 ];
+
+void vAFunction( void )
+{
+ArenaHandle_t xArena;
+void *pvBlock;
+
+    xArena = xArenaCreateStatic( "Parser", ucParserStorage, sizeof( ucParserStorage ) );
+
+    for( ;; )
+    {
+        // Allocate what parsing a document needs.
+        pvBlock = pvArenaMalloc( xArena, 100 );
+
+        ...
+
+        // Free it all once the document has been handled.
+        vArenaReset( xArena );
+    }
+}
+</pre>
+ * \defgroup xArenaCreateStatic xArenaCreateStatic
+ * \ingroup ArenaManagement
+ */
+ArenaHandle_t xArenaCreateStatic( const char *pcName, uint8_t *pucStorage, size_t xStorageSize ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+void vArenaDelete( ArenaHandle_t xArena );
+</pre>
+ *
+ * Deletes an arena, returning its memory to the FreeRTOS heap if it was
+ * created with xArenaCreate().  Any blocks still allocated from it must not be
+ * used again.
+ *
+ * @param xArena The handle of the arena to be deleted.
+ *
+ * \defgroup vArenaDelete vArenaDelete
+ * \ingroup ArenaManagement
+ */
+void vArenaDelete( ArenaHandle_t xArena ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+void *pvArenaMalloc( ArenaHandle_t xArena, size_t xWantedSize );
+</pre>
+ *
+ * Allocates a block from an arena, aligned to portBYTE_ALIGNMENT.  If the
+ * free list of the block's size class is empty and the arena has no unused
+ * memory left, a free block of a larger class is used.
+ *
+ * @param xArena The handle of the arena to allocate from.
+ *
+ * @param xWantedSize The number of bytes wanted.
+ *
+ * @return The block, or NULL if xWantedSize is 0 or the arena has no block
+ * large enough.
+ *
+ * \defgroup pvArenaMalloc pvArenaMalloc
+ * \ingroup ArenaManagement
+ */
+void *pvArenaMalloc( ArenaHandle_t xArena, size_t xWantedSize ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+void *pvArenaCalloc( ArenaHandle_t xArena, size_t xCount, size_t xSize );
+</pre>
+ *
+ * Allocates a block for xCount items of xSize bytes from an arena, with the C
+ * library's calloc() semantics: the block is set to zero, and NULL is
+ * returned if xCount times xSize overflows.
+ *
+ * \defgroup pvArenaCalloc pvArenaCalloc
+ * \ingroup ArenaManagement
+ */
+void *pvArenaCalloc( ArenaHandle_t xArena, size_t xCount, size_t xSize ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+void *pvArenaRealloc( ArenaHandle_t xArena, void *pv, size_t xWantedSize );
+</pre>
+ *
+ * Changes the size of a block allocated from an arena, with the C library's
+ * realloc() semantics.  The block is returned unmoved if its size class
+ * already holds xWantedSize bytes.  Otherwise a new block is allocated, the
+ * contents copied and the old block freed, and if the allocation fails NULL
+ * is returned and the old block is left as it was.
+ *
+ * \defgroup pvArenaRealloc pvArenaRealloc
+ * \ingroup ArenaManagement
+ */
+void *pvArenaRealloc( ArenaHandle_t xArena, void *pv, size_t xWantedSize ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+void vArenaFree( ArenaHandle_t xArena, void *pv );
+</pre>
+ *
+ * Returns a block to the arena it was allocated from.
+ *
+ * @param xArena The handle of the arena the block was allocated from.
+ *
+ * @param pv The block, or NULL, in which case nothing is done.
+ *
+ * \defgroup vArenaFree vArenaFree
+ * \ingroup ArenaManagement
+ */
+void vArenaFree( ArenaHandle_t xArena, void *pv ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+void vArenaReset( ArenaHandle_t xArena );
+</pre>
+ *
+ * Frees every block allocated from an arena at once, leaving its whole budget
+ * unused again.  None of the blocks may be used afterwards, so the arena
+ * should belong to one operation, such as parsing a document.
+ *
+ * @param xArena The handle of the arena to reset.
+ *
+ * \defgroup vArenaReset vArenaReset
+ * \ingroup ArenaManagement
+ */
+void vArenaReset( ArenaHandle_t xArena ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+void vArenaGetStats( ArenaHandle_t xArena, ArenaStats_t *pxStats );
+</pre>
+ *
+ * Reports how an arena's memory is used.
+ *
+ * @param xArena The handle of the arena to report on.
+ *
+ * @param pxStats The structure the statistics are written to.
+ *
+ * \defgroup vArenaGetStats vArenaGetStats
+ * \ingroup ArenaManagement
+ */
+void vArenaGetStats( ArenaHandle_t xArena, ArenaStats_t *pxStats ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+UBaseType_t uxArenaGetSystemState( ArenaStats_t * const pxArenaStatsArray, const UBaseType_t uxArraySize );
+</pre>
+ *
+ * Reports on every arena that exists, newest first, in the way
+ * uxTaskGetSystemState() reports on every task.
+ *
+ * @param pxArenaStatsArray The array the statistics are written to, one entry
+ * for each arena.
+ *
+ * @param uxArraySize The number of entries in pxArenaStatsArray.
+ *
+ * @return The number of entries written, which is 0 if there are more arenas
+ * than entries.
+ *
+ * \defgroup uxArenaGetSystemState uxArenaGetSystemState
+ * \ingroup ArenaManagement
+ */
+UBaseType_t uxArenaGetSystemState( ArenaStats_t * const pxArenaStatsArray, const UBaseType_t uxArraySize ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif	/* !defined( ARENA_H ) */
@@ -0,0 +1,160 @@
+/*
+ * Amazon FreeRTOS AMP Ring V1.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_amp_ring.h
+ * @brief A single-producer, single-consumer ring of records in memory shared
+ * by two processors that run separate software, such as the two cores of a
+ * Zynq-7000 in an AMP configuration.
+ *
+ * The ring takes no locks and makes no kernel calls. The producer is the only
+ * writer of the head index and the consumer the only writer of the tail
+ * index, and each index is published with release ordering after the slot it
+ * covers has been written or read. The indexes are on separate cache lines so
+ * the two sides do not write to the same line.
+ *
+ * One side formats the memory with AMP_RingFormat() before the other side
+ * can run, then each side attaches with AMP_RingAttach() and only writes, or
+ * only reads. The memory must be mapped with the same attributes on both
+ * sides, either coherent between them or non-cacheable.
+ */
+
+#ifndef __AWS_AMP_RING__H__
+#define __AWS_AMP_RING__H__
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief The cache line size the shared indexes are separated by.
+ *
+ * Both sides must be built with the same value.
+ */
+#ifndef ampringCACHE_LINE_SIZE
+    #define ampringCACHE_LINE_SIZE    32
+#endif
+
+/**
+ * @brief The header at the start of the shared memory, followed by the slots.
+ *
+ * Each slot holds a 32-bit record length followed by the record.
+ */
+typedef struct AmpRingShared
+{
+    /* Written by AMP_RingFormat() only. */
+    uint32_t ulMagic;
+    uint32_t ulSlotSize;
+    uint32_t ulSlotCount;
+    uint8_t ucPad0[ ampringCACHE_LINE_SIZE - 3 * sizeof( uint32_t ) ];
+
+    /* Written by the producer only. */
+    uint32_t ulHead;
+    uint32_t ulDropped;
+    uint8_t ucPad1[ ampringCACHE_LINE_SIZE - 2 * sizeof( uint32_t ) ];
+
+    /* Written by the consumer only. */
+    uint32_t ulTail;
+    uint8_t ucPad2[ ampringCACHE_LINE_SIZE - sizeof( uint32_t ) ];
+} AmpRingShared_t;
+
+/**
+ * @brief One side's handle to a ring, in that side's private memory.
+ *
+ * The geometry is copied out of the shared header when attaching, so that
+ * the other side cannot make this side access memory outside the ring.
+ */
+typedef struct AmpRing
+{
+    AmpRingShared_t * pxShared;
+    uint8_t * pucSlots;
+    uint32_t ulSlotSize;
+    uint32_t ulMask;
+    uint32_t ulHead; /* The indexes as this side last knew them.  Its */
+    uint32_t ulTail; /* own index is always current. */
+} AmpRing_t;
+
+/**
+ * @brief Formats shared memory as an empty ring.
+ *
+ * The slot count is the largest power of two that fits. Must complete before
+ * either side attaches.
+ *
+ * @param[in] pvMemory The shared memory, aligned to ampringCACHE_LINE_SIZE.
+ * @param[in] xMemorySize The size of the shared memory.
+ * @param[in] xMaxRecordLength The longest record that will be written.
+ *
+ * @return pdPASS, or pdFAIL if fewer than two slots fit.
+ */
+BaseType_t AMP_RingFormat( void * pvMemory,
+                           size_t xMemorySize,
+                           size_t xMaxRecordLength );
+
+/**
+ * @brief Attaches to a ring formatted by AMP_RingFormat().
+ *
+ * @param[out] pxRing The handle to initialise.
+ * @param[in] pvMemory The shared memory.
+ * @param[in] xMemorySize The size of the shared memory.
+ *
+ * @return pdPASS, or pdFAIL if the memory does not hold a ring that fits in
+ * xMemorySize, for example because it has not been formatted yet.
+ */
+BaseType_t AMP_RingAttach( AmpRing_t * pxRing,
+                           void * pvMemory,
+                           size_t xMemorySize );
+
+/**
+ * @brief Writes a record. Producer only.
+ *
+ * Never blocks. A record that does not fit because the ring is full is
+ * dropped and counted, see AMP_RingDropped().
+ *
+ * @return pdPASS, or pdFAIL if the ring is full or the record is longer
+ * than the maximum given to AMP_RingFormat().
+ */
+BaseType_t AMP_RingWrite( AmpRing_t * pxRing,
+                          const void * pvData,
+                          size_t xLength );
+
+/**
+ * @brief Reads the oldest record. Consumer only.
+ *
+ * @param[out] pvBuffer Receives the record, truncated to xBufferLength.
+ * @param[in] xBufferLength Size of pvBuffer.
+ * @param[out] pxLength Receives the length of the record.
+ *
+ * @return pdPASS, or pdFAIL if the ring is empty.
+ */
+BaseType_t AMP_RingRead( AmpRing_t * pxRing,
+                         void * pvBuffer,
+                         size_t xBufferLength,
+                         size_t * pxLength );
+
+/**
+ * @brief The number of records the producer has dropped because the ring
+ * was full.
+ */
+uint32_t AMP_RingDropped( const AmpRing_t * pxRing );
+
+#endif /* ifndef __AWS_AMP_RING__H__ */
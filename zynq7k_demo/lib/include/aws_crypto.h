@@ -43,6 +43,26 @@
  */
 void CRYPTO_ConfigureHeap( void );
 
+/**
+ * @brief Generates random bytes from a CTR_DRBG shared by all tasks.
+ *
+ * The DRBG is seeded from mbedtls_hardware_poll() on first use and reseeds
+ * itself periodically. Short requests are served from a buffer kept for the
+ * calling task, so most calls only copy bytes.
+ *
+ * The signature matches the mbedTLS f_rng callback, so this function can be
+ * passed to mbedTLS directly.
+ *
+ * @param[in] pvContext Not used.
+ * @param[out] pucOutput Buffer to fill.
+ * @param[in] xLength Length in bytes of the buffer.
+ *
+ * @return Zero on success, or an mbedTLS error code.
+ */
+int CRYPTO_Random( void * pvContext,
+                   unsigned char * pucOutput,
+                   size_t xLength );
+
 /**
  * @brief Library-independent cryptographic algorithm identifiers.
  */
@@ -94,4 +114,57 @@ BaseType_t CRYPTO_SignatureVerificationFinal( void * pvContext,
                                               uint8_t * pucSignature,
                                               size_t xSignatureLength );
 
+/**
+ * @brief Reads a signed object for CRYPTO_SignatureVerificationStream().
+ *
+ * The object is read in consecutive chunks. Each read is started with
+ * xStartRead and completed with lFinishRead, and only one read is outstanding
+ * at a time. The previous chunk is hashed while a read is outstanding, so a
+ * reader that starts a DMA transfer and waits for it in lFinishRead overlaps
+ * storage access with hashing. A reader without asynchronous I/O can do the
+ * whole read in xStartRead.
+ *
+ * xStartRead returns pdTRUE if the read was started. lFinishRead returns the
+ * number of bytes read, which may be less than requested, or a negative value
+ * on error.
+ */
+typedef struct CryptoStreamReader
+{
+    BaseType_t ( * xStartRead )( void * pvContext,
+                                 uint8_t * pucBuffer,
+                                 size_t xOffset,
+                                 size_t xLength );
+    int32_t ( * lFinishRead )( void * pvContext );
+    void * pvContext;
+} CryptoStreamReader_t;
+
+/**
+ * @brief Verifies the digital signature of an object that is too large to
+ * hold in RAM.
+ *
+ * Only two chunk buffers of cryptoconfigSTREAM_CHUNK_LENGTH bytes are
+ * allocated, whatever the length of the object.
+ *
+ * @param[in] pxReader Reads the object from storage.
+ * @param[in] xObjectLength Length in bytes of the object.
+ * @param[in] xAsymmetricAlgorithm Cryptographic public key cryptosystem.
+ * @param[in] xHashAlgorithm Cryptographic hash algorithm that was used for signing.
+ * @param[in] pcSignerCertificate Base64 and DER encoded X.509 certificate of the
+ * signer.
+ * @param[in] xSignerCertificateLength Length in bytes of the certificate.
+ * @param[in] pucSignature Digital signature result to verify.
+ * @param[in] xSignatureLength in bytes of digital signature result.
+ *
+ * @return pdTRUE if the signature is correct or pdFALSE if the signature is
+ * invalid or the object could not be read.
+ */
+BaseType_t CRYPTO_SignatureVerificationStream( const CryptoStreamReader_t * pxReader,
+                                               size_t xObjectLength,
+                                               BaseType_t xAsymmetricAlgorithm,
+                                               BaseType_t xHashAlgorithm,
+                                               char * pcSignerCertificate,
+                                               size_t xSignerCertificateLength,
+                                               uint8_t * pucSignature,
+                                               size_t xSignatureLength );
+
 #endif /* ifndef __AWS_CRYPTO__H__ */
@@ -0,0 +1,181 @@
+/*
+ * Amazon FreeRTOS Crypto V1.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_crypto_accel.h
+ * @brief Interface to crypto accelerators, e.g. cores in the programmable logic.
+ *
+ * Work is described by jobs. Jobs are queued to a worker task, which hands
+ * them to the registered provider in batches of up to
+ * cryptoaccelconfigMAX_BATCH_SIZE. A provider may start all jobs of a batch
+ * before waiting for the first result.
+ *
+ * mbedTLS uses the accelerator through MBEDTLS_ECDSA_VERIFY_ALT. Operations
+ * that the provider does not support, or any operation before
+ * CRYPTO_AccelInit() was called, run in software.
+ */
+
+#ifndef __AWS_CRYPTO_ACCEL__H__
+#define __AWS_CRYPTO_ACCEL__H__
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief Operations that can be offloaded.
+ */
+typedef enum
+{
+    /* pucInput[ xInputLength ] -> pucOutput[ 32 ]. */
+    eCryptoAccelSha256 = 0,
+
+    /* pucKey[ xKeyLength ] is the AES key. pucInput[ xInputLength ], a
+     * multiple of 16 bytes, is encrypted block by block into pucOutput. */
+    eCryptoAccelAesEcbEncrypt,
+
+    /* pucKey[ 64 ] is the public key X || Y, pucInput[ xInputLength ] the
+     * hash and pucSignature[ 64 ] the signature r || s, all big-endian. */
+    eCryptoAccelEcdsaP256Verify,
+
+    eCryptoAccelOperationCount
+} CryptoAccelOperation_t;
+
+/**
+ * @brief Capability bit of an operation in CryptoAccelProvider_t.
+ */
+#define cryptoaccelCAPABILITY( eOperation )    ( 1UL << ( uint32_t ) ( eOperation ) )
+
+/**
+ * @brief Job status values.
+ */
+#define cryptoaccelSTATUS_OK             ( 0 )
+#define cryptoaccelSTATUS_PENDING        ( 1 )
+#define cryptoaccelSTATUS_FAILED         ( -1 ) /* Error, or the signature is invalid. */
+#define cryptoaccelSTATUS_UNSUPPORTED    ( -2 ) /* The caller should fall back to software. */
+
+struct CryptoAccelJob;
+
+/**
+ * @brief Called by the worker task when an asynchronous job completed.
+ */
+typedef void ( * CryptoAccelCallback_t )( struct CryptoAccelJob * pxJob );
+
+/**
+ * @brief A unit of work. The buffers must stay valid until the job completed.
+ */
+typedef struct CryptoAccelJob
+{
+    CryptoAccelOperation_t eOperation;
+    const uint8_t * pucKey;
+    size_t xKeyLength;
+    const uint8_t * pucInput;
+    size_t xInputLength;
+    const uint8_t * pucSignature;
+    uint8_t * pucOutput;
+    volatile BaseType_t xStatus;
+
+    CryptoAccelCallback_t pxCallback;
+    void * pvCallbackContext;
+
+    /* Used internally. */
+    void * pvCompletion;
+} CryptoAccelJob_t;
+
+/**
+ * @brief An accelerator back-end.
+ *
+ * pxProcess() is only called from the worker task. It must set the status
+ * of every job in the batch before it returns, and may block while the
+ * hardware runs.
+ */
+typedef struct CryptoAccelProvider
+{
+    const char * pcName;
+    uint32_t ulCapabilities;
+    BaseType_t ( * pxInit )( void );
+    void ( * pxProcess )( CryptoAccelJob_t * const * ppxJobs,
+                          size_t xJobCount );
+} CryptoAccelProvider_t;
+
+/**
+ * @brief Counters for comparing providers.
+ */
+typedef struct CryptoAccelStats
+{
+    uint32_t ulJobs;
+    uint32_t ulBatches;
+    uint32_t ulLargestBatch;
+    uint32_t ulFailures;
+} CryptoAccelStats_t;
+
+/**
+ * @brief Reference provider that runs all operations in software on the PS.
+ */
+extern const CryptoAccelProvider_t xCryptoAccelSoftwareProvider;
+
+/**
+ * @brief Registers the provider and starts the worker task.
+ *
+ * @param[in] pxProvider The accelerator back-end.
+ *
+ * @return pdPASS on success, pdFAIL if the provider failed to initialize or
+ * if an accelerator was registered already.
+ */
+BaseType_t CRYPTO_AccelInit( const CryptoAccelProvider_t * pxProvider );
+
+/**
+ * @brief Checks whether an operation is offloaded.
+ *
+ * @return pdTRUE if a provider is registered that supports eOperation.
+ */
+BaseType_t CRYPTO_AccelSupports( CryptoAccelOperation_t eOperation );
+
+/**
+ * @brief Queues a job without waiting for it.
+ *
+ * pxJob->pxCallback is called from the worker task on completion.
+ *
+ * @return pdPASS if the job was queued, pdFAIL if the queue is full or the
+ * operation is not supported.
+ */
+BaseType_t CRYPTO_AccelSubmit( CryptoAccelJob_t * pxJob );
+
+/**
+ * @brief Runs a job and waits for its completion.
+ *
+ * The calling task waits on a semaphore of the job's own, so that its
+ * task notification is left to the application.
+ *
+ * @return The status of the job.
+ */
+BaseType_t CRYPTO_AccelRun( CryptoAccelJob_t * pxJob );
+
+/**
+ * @brief Gets the counters of the worker task.
+ *
+ * @param[out] pxStats Counters since CRYPTO_AccelInit().
+ */
+void CRYPTO_AccelGetStats( CryptoAccelStats_t * pxStats );
+
+#endif /* ifndef __AWS_CRYPTO_ACCEL__H__ */
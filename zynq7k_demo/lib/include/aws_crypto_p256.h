@@ -0,0 +1,99 @@
+/*
+ * Amazon FreeRTOS Crypto V1.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_crypto_p256.h
+ * @brief ECDSA signing on the NIST P-256 curve.
+ *
+ * Fixed-size field arithmetic and a comb over tables of multiples of the
+ * generator, computed once by CRYPTO_P256Init(). All operations on the key
+ * and the nonce run in constant time.
+ */
+
+#ifndef __AWS_CRYPTO_P256__H__
+#define __AWS_CRYPTO_P256__H__
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief Length of a P-256 private key, and of each half of a signature.
+ */
+#define cryptoP256_BYTES    32
+
+/**
+ * @brief A private key, prepared for signing.
+ */
+typedef struct CryptoP256Key
+{
+    uint32_t ulD[ 8 ];
+} CryptoP256Key_t;
+
+/**
+ * @brief Computes the generator tables.
+ *
+ * Must be called once, before any other function, and before other tasks
+ * can use the module.
+ *
+ * @return pdPASS.
+ */
+BaseType_t CRYPTO_P256Init( void );
+
+/**
+ * @brief Prepares a private key for signing.
+ *
+ * @param[out] pxKey The prepared key.
+ * @param[in] pucPrivateKey The big-endian private scalar.
+ *
+ * @return pdPASS, or pdFAIL if the scalar is out of range or
+ * CRYPTO_P256Init() has not been called.
+ */
+BaseType_t CRYPTO_P256ImportKey( CryptoP256Key_t * pxKey,
+                                 const uint8_t * pucPrivateKey );
+
+/**
+ * @brief Erases a prepared key.
+ */
+void CRYPTO_P256FreeKey( CryptoP256Key_t * pxKey );
+
+/**
+ * @brief Signs a hash.
+ *
+ * @param[in] pxKey The prepared key.
+ * @param[in] pucHash The hash. Only its leftmost 256 bits are used.
+ * @param[in] xHashLength Length of the hash.
+ * @param[out] pucSignature Receives r || s, big-endian, 2 * cryptoP256_BYTES.
+ * @param[in] pxRng Random number generator for the nonce, mbedTLS style.
+ * @param[in] pvRng Context of pxRng.
+ *
+ * @return pdPASS on success.
+ */
+BaseType_t CRYPTO_P256Sign( const CryptoP256Key_t * pxKey,
+                            const uint8_t * pucHash,
+                            size_t xHashLength,
+                            uint8_t * pucSignature,
+                            int ( * pxRng )( void *, unsigned char *, size_t ),
+                            void * pvRng );
+
+#endif /* ifndef __AWS_CRYPTO_P256__H__ */
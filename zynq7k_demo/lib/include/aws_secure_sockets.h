@@ -156,6 +156,7 @@ typedef void * Socket_t;
 #define SOCKETS_SO_REQUIRE_TLS                   ( 8 )  /**< Toggle client enforcement of TLS. */
 #define SOCKETS_SO_NONBLOCK                      ( 9 )  /**< Socket is nonblocking. */
 #define SOCKETS_SO_ALPN_PROTOCOLS                ( 10 ) /**< Application protocol list to be included in TLS ClientHello. */
+#define SOCKETS_SO_SEND_COALESCE_WINDOW          ( 11 ) /**< Hold small writes for up to this many ticks so that they share a TLS record. 0 disables. */
 #define SOCKETS_SO_WAKEUP_CALLBACK               ( 17 ) /**< Set the callback to be called whenever there is data available on the socket for reading. */
 
 /**@} */
@@ -189,6 +190,15 @@ typedef struct SocketsSockaddr
     uint32_t ulAddress;     /**< IP Address. Convention is to call this sin_addr. */
 } SocketsSockaddr_t;
 
+/**
+ * @brief A buffer to be sent by SOCKETS_SendV().
+ */
+typedef struct SocketsIovec
+{
+    const void * pvBuffer; /**< The data to be sent. */
+    size_t xLength;        /**< The length of the data to be sent. */
+} SocketsIovec_t;
+
 /**
  * @brief Well-known port numbers.
  */
@@ -256,6 +266,65 @@ int32_t SOCKETS_Connect( Socket_t xSocket,
                          SocketsSockaddr_t * pxAddress,
                          Socklen_t xAddressLength );
 
+/**
+ * @brief SOCKETS_ConnectStart() and SOCKETS_ConnectStep() results while the
+ * connection is being made.
+ *
+ * Wait for the transport socket to be readable or writable, for example
+ * with FreeRTOS_select(), then call SOCKETS_ConnectStep().
+ */
+#define SOCKETS_CONNECT_WANT_READ     ( 1 )
+#define SOCKETS_CONNECT_WANT_WRITE    ( 2 )
+
+/**
+ * @brief Starts connecting the socket without blocking the caller.
+ *
+ * An alternative to SOCKETS_Connect() that lets one task make several
+ * connections at once. The connection, and the TLS handshake if
+ * SOCKETS_SO_REQUIRE_TLS was set, are completed by SOCKETS_ConnectStep().
+ * The send and receive timeouts of the socket are set to 0.
+ *
+ * If this function, or SOCKETS_ConnectStep(), returns an error the socket is
+ * considered invalid.
+ *
+ * @param[in] xSocket The handle of the socket to be connected.
+ * @param[in] pxAddress A pointer to a SocketsSockaddr_t structure that contains the
+ * the address to connect the socket to.
+ * @param[in] xAddressLength Should be set to sizeof( @ref SocketsSockaddr_t ).
+ *
+ * @return
+ * * @ref SOCKETS_CONNECT_WANT_WRITE if the connection has been started.
+ * * If an error occurred, a negative value is returned. @ref SocketsErrors
+ */
+int32_t SOCKETS_ConnectStart( Socket_t xSocket,
+                              SocketsSockaddr_t * pxAddress,
+                              Socklen_t xAddressLength );
+
+/**
+ * @brief Continues a connection started by SOCKETS_ConnectStart().
+ *
+ * @param[in] xSocket The handle of the socket being connected.
+ *
+ * @return
+ * * @ref SOCKETS_ERROR_NONE once the connection is established.
+ * * @ref SOCKETS_CONNECT_WANT_READ or @ref SOCKETS_CONNECT_WANT_WRITE while it
+ *   is being made.
+ * * If an error occurred, a negative value is returned. @ref SocketsErrors
+ */
+int32_t SOCKETS_ConnectStep( Socket_t xSocket );
+
+/**
+ * @brief Returns the FreeRTOS+TCP socket that carries the connection.
+ *
+ * For use with FreeRTOS_FD_SET() and FreeRTOS_select() only; data must be
+ * sent and received through the secure socket.
+ *
+ * @param[in] xSocket The handle of the socket.
+ *
+ * @return The transport socket, or NULL if xSocket is not valid.
+ */
+void * SOCKETS_GetTransportSocket( Socket_t xSocket );
+
 /**
  * @brief Receive data from a TCP socket.
  *
@@ -300,6 +369,41 @@ int32_t SOCKETS_Send( Socket_t xSocket,
                       size_t xDataLength,
                       uint32_t ulFlags );
 
+/**
+ * @brief Transmit several buffers to the remote socket.
+ *
+ * The buffers are sent in order, as if by one call to SOCKETS_Send() on
+ * their concatenation. Small buffers are gathered so that they share a TLS
+ * record instead of each becoming a record and a TCP segment of its own.
+ *
+ * When @ref SOCKETS_SO_SEND_COALESCE_WINDOW is set, data that does not fill
+ * a record is held for up to the window, and is sent together with any data
+ * passed to SOCKETS_Send() or SOCKETS_SendV() in the meantime. Held data is
+ * only sent from calls made on the socket: by the first SOCKETS_Send(),
+ * SOCKETS_SendV() or SOCKETS_Recv() after the window has passed, and by
+ * SOCKETS_Shutdown() and SOCKETS_Close(). A task that sets the window must
+ * call one of these within the window of its last send, or held data waits
+ * until it does. If held data fails to go out after the call that accepted
+ * it has returned, the error is returned by the next SOCKETS_Send(),
+ * SOCKETS_SendV() or SOCKETS_Recv(), or by SOCKETS_Shutdown() or
+ * SOCKETS_Close(). These two return SOCKETS_SOCKET_ERROR if held data could
+ * not be sent in time.
+ *
+ * @param[in] xSocket The handle of the sending socket.
+ * @param[in] pxVectors The buffers to be sent.
+ * @param[in] xVectorCount The number of entries in pxVectors.
+ * @param[in] ulFlags Not currently used. Should be set to 0.
+ *
+ * @return
+ * * On success, the number of bytes actually sent, or held to be sent, is
+ *   returned.
+ * * If an error occurred, a negative value is returned. @ref SocketsErrors
+ */
+int32_t SOCKETS_SendV( Socket_t xSocket,
+                       const SocketsIovec_t * pxVectors,
+                       size_t xVectorCount,
+                       uint32_t ulFlags );
+
 /**
  * @brief Closes all or part of a full-duplex connection on the socket.
  *
@@ -373,6 +477,12 @@ int32_t SOCKETS_Close( Socket_t xSocket );
  *      - Non-blocking connect is not supported - socket option should be
  *        called after connect.
  *      - pvOptionValue is ignored for this option.
+ *    - @ref SOCKETS_SO_SEND_COALESCE_WINDOW
+ *      - Hold data that does not fill a record so that later writes can
+ *        share it. See SOCKETS_SendV().
+ *      - pvOptionValue (TickType_t) is the longest time, in ticks, that
+ *        data is held before it is sent.
+ *      - Setting pvOptionValue = 0 sends any held data and stops holding.
  *  - Security Sockets Options
  *    - @ref SOCKETS_SO_REQUIRE_TLS
  *      - Use TLS for all connect, send, and receive on this socket.
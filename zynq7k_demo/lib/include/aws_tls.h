@@ -84,6 +84,26 @@ typedef struct xTLS_PARAMS
     void * pvCallerContext;
 } TLSParams_t;
 
+/**
+ * @brief Defines the memory usage report of a TLS connection.
+ *
+ * @param[out] xContextBytes Size of the TLS context, which includes the
+ * mbedTLS connection and configuration structures.
+ * @param[out] xRecordBufferBytes Size of the record buffers currently held.
+ * @param[out] xRecordBufferPeakBytes Largest size of the record buffers held
+ * at once since the connection was started.
+ * @param[out] xMaxFragmentLength Largest record payload sent, and expected
+ * from the server if it agreed to the negotiated length. Zero before the
+ * handshake has completed.
+ */
+typedef struct xTLS_MEMORY_USAGE
+{
+    size_t xContextBytes;
+    size_t xRecordBufferBytes;
+    size_t xRecordBufferPeakBytes;
+    size_t xMaxFragmentLength;
+} TLSMemoryUsage_t;
+
 /**
  * @brief Initializes the TLS context.
  *
@@ -104,6 +124,42 @@ BaseType_t TLS_Init( void ** ppvContext,
  */
 BaseType_t TLS_Connect( void * pvContext );
 
+/**
+ * @brief TLS_ConnectStep() results while the handshake is still running.
+ *
+ * The handshake is waiting to receive from the server, or to send to it.
+ */
+#define TLS_HANDSHAKE_WANT_READ     ( 1 )
+#define TLS_HANDSHAKE_WANT_WRITE    ( 2 )
+
+/**
+ * @brief Prepares a handshake that is run by TLS_ConnectStep().
+ *
+ * An alternative to TLS_Connect() for callers that cannot block on the
+ * handshake. The network callbacks must not block; they return zero when
+ * the socket has nothing to receive or no room to send.
+ *
+ * @param pvContext Opaque context handle for TLS library.
+ *
+ * @return Zero on success. Error return codes have the high bit set.
+ */
+BaseType_t TLS_ConnectStart( void * pvContext );
+
+/**
+ * @brief Runs the handshake started by TLS_ConnectStart() as far as the
+ * network allows.
+ *
+ * Call again once the socket is readable, for TLS_HANDSHAKE_WANT_READ, or
+ * writable, for TLS_HANDSHAKE_WANT_WRITE.
+ *
+ * @param pvContext Opaque context handle for TLS library.
+ *
+ * @return Zero once the handshake has completed, TLS_HANDSHAKE_WANT_READ or
+ * TLS_HANDSHAKE_WANT_WRITE while it is running. Error return codes have the
+ * high bit set.
+ */
+BaseType_t TLS_ConnectStep( void * pvContext );
+
 /**
  * @brief Reads the requested number of bytes from the secure connection
  *
@@ -138,4 +194,24 @@ BaseType_t TLS_Send( void * pvContext,
  */
 void TLS_Cleanup( void * pvContext );
 
+/**
+ * @brief Reports the RAM used by a TLS connection.
+ *
+ * @param pvContext Opaque context handle for TLS library.
+ * @param pxUsage Receives the figures.
+ *
+ * @return pdPASS, or pdFAIL if a parameter is NULL.
+ */
+BaseType_t TLS_GetMemoryUsage( void * pvContext,
+                               TLSMemoryUsage_t * pxUsage );
+
+/**
+ * @brief Drops the parsed server and client certificates shared by TLS contexts.
+ *
+ * Certificates are parsed, and the device key is looked up, by the first
+ * connection only. Call this after replacing the credentials in PKCS#11
+ * storage so that the next connection uses the new ones.
+ */
+void TLS_FlushCredentialCache( void );
+
 #endif /* ifndef __AWS__TLS__H__ */
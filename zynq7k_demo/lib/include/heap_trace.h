@@ -0,0 +1,170 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * Heap tracing records every call to pvPortMalloc() and vPortFree() in a
+ * buffer, with the address it was called from, the size, the calling task and
+ * the tick count, for a reader to take out and send to a host.  It is enabled
+ * by setting configUSE_HEAP_TRACE to 1 in FreeRTOSConfig.h, which defines the
+ * traceMALLOC() and traceFREE() macros the heap implementations call, and
+ * costs nothing when disabled.
+ *
+ * The buffer holds configHEAP_TRACE_LENGTH records.  When it is full new
+ * records are dropped, and counted, rather than overwriting ones that have not
+ * been read, so a host can tell a complete trace from one with gaps.  One task
+ * at a time reads the buffer, either as records with uxHeapTraceRead() or as
+ * lines of text with xHeapTraceFormat().
+ *
+ * The heap is traced from inside pvPortMalloc() and vPortFree(), so the
+ * recorded caller is the function that called them.  Allocations through a
+ * wrapper, such as mbedTLS's calloc, are recorded against the wrapper.
+ */
+
+#ifndef HEAP_TRACE_H
+#define HEAP_TRACE_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include heap_trace.h"
+#endif
+
+#include "task.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/* The kinds of record. */
+#define heaptraceMALLOC				( 0UL )
+#define heaptraceFREE				( 1UL )
+#define heaptraceMALLOC_FAILED		( 2UL )
+
+/* The kind of record is held in the top bits of the size. */
+#define heaptraceEVENT_SHIFT		( 30UL )
+#define heaptraceSIZE_MASK			( ( 1UL << heaptraceEVENT_SHIFT ) - 1UL )
+
+/**
+ * One allocation or free.
+ *
+ * ulSizeAndEvent holds the kind of record, one of heaptraceMALLOC,
+ * heaptraceFREE and heaptraceMALLOC_FAILED, which heaptraceGET_EVENT()
+ * extracts, and the size, which heaptraceGET_SIZE() extracts.  An allocation's
+ * size is the size requested, and a free's the size of the block freed,
+ * including the heap's own header.
+ */
+typedef struct xHEAP_TRACE_RECORD
+{
+	void *pvAddress;			/*< The block allocated or freed, NULL if an allocation failed. */
+	void *pvCaller;				/*< The return address of the call to pvPortMalloc() or vPortFree(). */
+	TaskHandle_t xTask;			/*< The calling task, which is the first task created before the scheduler starts. */
+	TickType_t xTickCount;		/*< The tick count at the time of the call. */
+	uint32_t ulSizeAndEvent;
+} HeapTraceRecord_t;
+
+#define heaptraceGET_EVENT( pxRecord )	( ( pxRecord )->ulSizeAndEvent >> heaptraceEVENT_SHIFT )
+#define heaptraceGET_SIZE( pxRecord )	( ( pxRecord )->ulSizeAndEvent & heaptraceSIZE_MASK )
+
+/**
+ * heap_trace.h
+ *
+<pre>
+UBaseType_t uxHeapTraceRead( HeapTraceRecord_t *pxRecords, UBaseType_t uxMaxRecords, uint32_t *pulDropped );
+</pre>
+ *
+ * Takes the oldest records out of the heap trace buffer.
+ *
+ * @param pxRecords The array the records are copied into.
+ *
+ * @param uxMaxRecords The most records to take.
+ *
+ * @param pulDropped If not NULL, set to the number of records dropped because
+ * the buffer was full since the last time the buffer was read.  They are newer
+ * than the records that were in the buffer when they were dropped.
+ *
+ * @return The number of records copied into pxRecords.
+ *
+ * \defgroup uxHeapTraceRead uxHeapTraceRead
+ * \ingroup HeapTrace
+ */
+UBaseType_t uxHeapTraceRead( HeapTraceRecord_t *pxRecords, UBaseType_t uxMaxRecords, uint32_t *pulDropped ) PRIVILEGED_FUNCTION;
+
+/**
+ * heap_trace.h
+ *
+<pre>
+size_t xHeapTraceFormat( char *pcBuffer, size_t xBufferLength );
+</pre>
+ *
+ * Takes as many of the oldest records out of the heap trace buffer as fit in
+ * pcBuffer as lines of text, for a host tool to read back.  Each line starts
+ * with "HT " so the lines can be picked out of a log, and numbers are in
+ * hexadecimal:
+ *
+ *   HT m <tick> <task> <caller> <address> <size>    an allocation
+ *   HT f <tick> <task> <caller> <address> <size>    a free
+ *   HT x <tick> <task> <caller> 0 <size>            a failed allocation
+ *   HT lost <count>                                 records dropped here
+ *   HT task <task> <name>                           a task's name
+ *   HT heap <total> <free> <minimum free>           the heap's size
+ *   HT hz <tick rate>
+ *
+ * The tick rate and the task names are written the first time, whenever the
+ * number of tasks has changed, and every ten seconds, so that a capture
+ * started late can be read.  The heap's size is written with every call that
+ * returns records.  A count of dropped records is written once the records
+ * older than them have been.
+ *
+ * @param pcBuffer The buffer the text is written to.  It is terminated with a
+ * null character.
+ *
+ * @param xBufferLength The size of pcBuffer.  At least 80 bytes are needed for
+ * a line.
+ *
+ * @return The length of the text written, 0 if there were no records.
+ *
+ * Example use:
+<pre>
+void vDumpHeapTrace( void )
+{
+static char cBuffer[ 512 ];
+
+    // Write the trace to the console until it is empty.
+    while( xHeapTraceFormat( cBuffer, sizeof( cBuffer ) ) > 0 )
+    {
+        vConsoleWrite( cBuffer );
+    }
+}
+</pre>
+ * \defgroup xHeapTraceFormat xHeapTraceFormat
+ * \ingroup HeapTrace
+ */
+size_t xHeapTraceFormat( char *pcBuffer, size_t xBufferLength ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif	/* !defined( HEAP_TRACE_H ) */
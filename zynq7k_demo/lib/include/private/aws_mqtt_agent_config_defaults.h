@@ -141,6 +141,18 @@
     #define mqttconfigTCP_SEND_TIMEOUT_MS    ( 2000 )
 #endif
 
+/**
+ * @brief Time in milliseconds that small packets are held so that they share
+ * a TLS record. 0 sends each packet as soon as it is ready. When non-zero,
+ * the MQTT task wakes up once the window of its last send has passed, so that
+ * held packets are sent.
+ *
+ * @see SOCKETS_SO_SEND_COALESCE_WINDOW.
+ */
+#ifndef mqttconfigSEND_COALESCE_WINDOW_MS
+    #define mqttconfigSEND_COALESCE_WINDOW_MS    ( 0 )
+#endif
+
 /**
  * @brief Length of the buffer used to receive data.
  */
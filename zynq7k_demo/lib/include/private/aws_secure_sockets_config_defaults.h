@@ -61,4 +61,16 @@
     #define socketsconfigDEFAULT_RECV_TIMEOUT    ( 10000 )
 #endif
 
+/**
+ * @brief Length of the buffer that gathers small writes into one record.
+ *
+ * Used by SOCKETS_SendV(), and by SOCKETS_Send() on sockets with the
+ * SOCKETS_SO_SEND_COALESCE_WINDOW option set. Writes at least this long are
+ * sent as they are. Matching the TLS maximum fragment length makes each
+ * gathered write a full record.
+ */
+#ifndef socketsconfigSEND_COALESCE_BUFFER_LENGTH
+    #define socketsconfigSEND_COALESCE_BUFFER_LENGTH    ( 512 )
+#endif
+
 #endif /* AWS_INC_SECURE_SOCKETS_CONFIG_DEFAULTS_H_ */
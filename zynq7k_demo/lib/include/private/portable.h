@@ -132,6 +132,57 @@ void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/* Used by heap_6.c.  The statistics of the blocks in one size class: those
+larger than the previous class's xMaximumBlockSize and no larger than this
+class's.  Block sizes include the block header. */
+typedef struct HeapClassStats
+{
+	size_t xMaximumBlockSize;
+	size_t xAllocations;			/* Successful allocations from this class. */
+	size_t xFailures;				/* Allocations of this class's size that failed. */
+	size_t xBlocksInUse;
+	size_t xBytesInUse;
+	size_t xFreeBlocks;
+	size_t xFreeBytes;
+} HeapClassStats_t;
+
+/* Used by heap_6.c.  The statistics of the blocks allocated with one tag. */
+typedef struct HeapTagStats
+{
+	size_t xBlocksInUse;
+	size_t xBytesInUse;
+	size_t xMaximumBytesInUse;
+} HeapTagStats_t;
+
+/*
+ * Heap statistics provided by heap_6.c.  uxPortGetHeapClassCount() returns the
+ * number of size classes, and vPortGetHeapClassStats() the statistics of one
+ * of them.  xPortGetLargestFreeBlockSize() returns the largest allocation that
+ * can currently succeed.
+ */
+UBaseType_t uxPortGetHeapClassCount( void ) PRIVILEGED_FUNCTION;
+void vPortGetHeapClassStats( UBaseType_t uxClass, HeapClassStats_t *pxStats ) PRIVILEGED_FUNCTION;
+size_t xPortGetLargestFreeBlockSize( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Allocation tags provided by heap_6.c when configHEAP_TAGS is greater than 0.
+ * Blocks allocated by a task are tagged with the tag it last set with
+ * uxPortSetHeapTag(), which returns the task's previous tag so that it can be
+ * restored, letting a subsystem account for its allocations.  The tag is kept
+ * in the task's thread local storage pointer configHEAP_TAG_THREAD_LOCAL_INDEX
+ * if that is defined, otherwise a single tag is shared by all tasks.
+ * vPortGetHeapTagStats() returns the statistics of one tag.
+ */
+UBaseType_t uxPortSetHeapTag( UBaseType_t uxTag ) PRIVILEGED_FUNCTION;
+void vPortGetHeapTagStats( UBaseType_t uxTag, HeapTagStats_t *pxStats ) PRIVILEGED_FUNCTION;
+
+/*
+ * Record an allocation or a free, see heap_trace.h.  Called by the
+ * traceMALLOC() and traceFREE() macros when configUSE_HEAP_TRACE is 1.
+ */
+void vHeapTraceMalloc( void *pvAddress, size_t xSize, void *pvCaller ) PRIVILEGED_FUNCTION;
+void vHeapTraceFree( void *pvAddress, size_t xSize, void *pvCaller ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
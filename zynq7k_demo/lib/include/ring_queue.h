@@ -0,0 +1,262 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * Ring queues pass fixed size items, by copy, from interrupts or tasks to a
+ * single reading task.  They are a light weight alternative to queues for the
+ * common interrupt to task data path: writing never blocks, and neither
+ * writing nor reading enters a critical section or touches the kernel unless
+ * the reader is blocked waiting for an item.
+ *
+ * A single producer ring queue (created with xRingQueueCreate()) may only be
+ * written by one task or interrupt at a time, and a multiple producer ring
+ * queue (created with xRingQueueCreateMultipleProducers()) may be written by
+ * any number of tasks and interrupts, on any core.  Either may only be read by
+ * one task.  Writes to a single producer ring queue are wait free, and writes
+ * to a multiple producer ring queue are lock free.
+ *
+ * ***NOTE***:  Like stream buffers, ring queues use the reading task's
+ * notification to unblock it, so the reading task must not use its
+ * notification for anything else while it is blocked on a ring queue.
+ */
+
+#ifndef RING_QUEUE_H
+#define RING_QUEUE_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include ring_queue.h"
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/**
+ * Type by which ring queues are referenced.  For example, a call to
+ * xRingQueueCreate() returns a RingQueueHandle_t variable that can then be
+ * used as a parameter to xRingQueueSend(), xRingQueueReceive(), etc.
+ */
+typedef void * RingQueueHandle_t;
+
+/**
+ * ring_queue.h
+ *
+<pre>
+RingQueueHandle_t xRingQueueCreate( UBaseType_t uxQueueLength, UBaseType_t uxItemSize );
+</pre>
+ *
+ * Creates a ring queue that one task or interrupt writes and one task reads,
+ * using dynamically allocated memory.
+ *
+ * configSUPPORT_DYNAMIC_ALLOCATION must be set to 1 or left undefined in
+ * FreeRTOSConfig.h for xRingQueueCreate() to be available.
+ *
+ * @param uxQueueLength The maximum number of items the ring queue can hold.
+ * It is rounded up to a power of two.
+ *
+ * @param uxItemSize The size, in bytes, of each item.  Items are copied into
+ * the ring queue when they are sent and out of it when they are received.
+ *
+ * @return A handle to the created ring queue, or NULL if there was not
+ * enough heap memory to create it.
+ *
+ * Example use:
+<pre>
+void vAFunction( void )
+{
+RingQueueHandle_t xRingQueue;
+
+    // Create a ring queue that can hold 16 pointers.
+    xRingQueue = xRingQueueCreate( 16, sizeof( void * ) );
+
+    if( xRingQueue == NULL )
+    {
+        // There was not enough heap memory space available to create the
+        // ring queue.
+    }
+    else
+    {
+        // The ring queue was created successfully and can now be used.
+    }
+}
+</pre>
+ * \defgroup xRingQueueCreate xRingQueueCreate
+ * \ingroup RingQueueManagement
+ */
+#define xRingQueueCreate( uxQueueLength, uxItemSize ) xRingQueueGenericCreate( ( uxQueueLength ), ( uxItemSize ), pdFALSE )
+
+/**
+ * ring_queue.h
+ *
+<pre>
+RingQueueHandle_t xRingQueueCreateMultipleProducers( UBaseType_t uxQueueLength, UBaseType_t uxItemSize );
+</pre>
+ *
+ * Creates a ring queue that any number of tasks and interrupts write and one
+ * task reads, using dynamically allocated memory.  Each slot holds a sequence
+ * number as well as an item, so prefer xRingQueueCreate() where there is only
+ * one producer.
+ *
+ * @param uxQueueLength The maximum number of items the ring queue can hold.
+ * It is rounded up to a power of two.
+ *
+ * @param uxItemSize The size, in bytes, of each item.
+ *
+ * @return A handle to the created ring queue, or NULL if there was not
+ * enough heap memory to create it.
+ *
+ * \defgroup xRingQueueCreateMultipleProducers xRingQueueCreateMultipleProducers
+ * \ingroup RingQueueManagement
+ */
+#define xRingQueueCreateMultipleProducers( uxQueueLength, uxItemSize ) xRingQueueGenericCreate( ( uxQueueLength ), ( uxItemSize ), pdTRUE )
+
+/**
+ * ring_queue.h
+ *
+<pre>
+void vRingQueueDelete( RingQueueHandle_t xRingQueue );
+</pre>
+ *
+ * Deletes a ring queue that was created with xRingQueueCreate() or
+ * xRingQueueCreateMultipleProducers().  No task may be blocked on the ring
+ * queue, or write to it, while it is deleted.
+ *
+ * @param xRingQueue The handle of the ring queue to be deleted.
+ *
+ * \defgroup vRingQueueDelete vRingQueueDelete
+ * \ingroup RingQueueManagement
+ */
+void vRingQueueDelete( RingQueueHandle_t xRingQueue ) PRIVILEGED_FUNCTION;
+
+/**
+ * ring_queue.h
+ *
+<pre>
+BaseType_t xRingQueueSend( RingQueueHandle_t xRingQueue, const void *pvItemToQueue );
+</pre>
+ *
+ * Copies an item into a ring queue from a task.  It never blocks: if the ring
+ * queue is full the item is not sent.  See xRingQueueSendFromISR() for a
+ * version that can be called from an interrupt service routine.
+ *
+ * @param xRingQueue The handle of the ring queue to which the item is sent.
+ *
+ * @param pvItemToQueue A pointer to the item to send.  The number of bytes
+ * copied is the item size the ring queue was created with.
+ *
+ * @return pdPASS if the item was sent, or errQUEUE_FULL if the ring queue was
+ * full.
+ *
+ * \defgroup xRingQueueSend xRingQueueSend
+ * \ingroup RingQueueManagement
+ */
+BaseType_t xRingQueueSend( RingQueueHandle_t xRingQueue, const void *pvItemToQueue ) PRIVILEGED_FUNCTION;
+
+/**
+ * ring_queue.h
+ *
+<pre>
+BaseType_t xRingQueueSendFromISR( RingQueueHandle_t xRingQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * A version of xRingQueueSend() that can be called from an interrupt service
+ * routine.
+ *
+ * @param xRingQueue The handle of the ring queue to which the item is sent.
+ *
+ * @param pvItemToQueue A pointer to the item to send.
+ *
+ * @param pxHigherPriorityTaskWoken *pxHigherPriorityTaskWoken is set to
+ * pdTRUE if sending the item unblocked the reading task and it has a priority
+ * above that of the interrupted task, in which case a context switch should be
+ * requested before the interrupt is exited.  pxHigherPriorityTaskWoken can be
+ * NULL, in which case it is not used.
+ *
+ * @return pdPASS if the item was sent, or errQUEUE_FULL if the ring queue was
+ * full.
+ *
+ * \defgroup xRingQueueSendFromISR xRingQueueSendFromISR
+ * \ingroup RingQueueManagement
+ */
+BaseType_t xRingQueueSendFromISR( RingQueueHandle_t xRingQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * ring_queue.h
+ *
+<pre>
+BaseType_t xRingQueueReceive( RingQueueHandle_t xRingQueue, void *pvBuffer, TickType_t xTicksToWait );
+</pre>
+ *
+ * Copies the oldest item out of a ring queue, waiting for one to arrive if the
+ * ring queue is empty.  Only one task may read a ring queue.
+ *
+ * @param xRingQueue The handle of the ring queue from which the item is
+ * received.
+ *
+ * @param pvBuffer A pointer to the buffer into which the item is copied.
+ *
+ * @param xTicksToWait The maximum time the task should remain in the Blocked
+ * state to wait for an item if the ring queue is empty.  Setting xTicksToWait
+ * to portMAX_DELAY will cause the task to wait indefinitely, provided
+ * INCLUDE_vTaskSuspend is set to 1.
+ *
+ * @return pdPASS if an item was received, otherwise pdFAIL.
+ *
+ * \defgroup xRingQueueReceive xRingQueueReceive
+ * \ingroup RingQueueManagement
+ */
+BaseType_t xRingQueueReceive( RingQueueHandle_t xRingQueue, void *pvBuffer, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * ring_queue.h
+ *
+<pre>
+UBaseType_t uxRingQueueMessagesWaiting( RingQueueHandle_t xRingQueue );
+</pre>
+ *
+ * Returns the number of items in a ring queue.  In a multiple producer ring
+ * queue this includes items that are still being written.
+ *
+ * @param xRingQueue The handle of the ring queue being queried.
+ *
+ * @return The number of items in the ring queue.
+ *
+ * \defgroup uxRingQueueMessagesWaiting uxRingQueueMessagesWaiting
+ * \ingroup RingQueueManagement
+ */
+UBaseType_t uxRingQueueMessagesWaiting( RingQueueHandle_t xRingQueue ) PRIVILEGED_FUNCTION;
+
+/* Functions below here are not part of the public API. */
+RingQueueHandle_t xRingQueueGenericCreate( UBaseType_t uxQueueLength,
+										   UBaseType_t uxItemSize,
+										   BaseType_t xMultipleProducers ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif	/* !defined( RING_QUEUE_H ) */
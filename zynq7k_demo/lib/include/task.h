@@ -153,6 +153,16 @@ typedef enum
  */
 #define tskIDLE_PRIORITY			( ( UBaseType_t ) 0U )
 
+/**
+ * task. h
+ *
+ * Core affinity mask that allows a task to run on any core.  Bit n of an
+ * affinity mask is set if the task can run on core n.
+ *
+ * \ingroup TaskUtils
+ */
+#define tskNO_AFFINITY				( ( UBaseType_t ) -1 )
+
 /**
  * task. h
  *
@@ -175,8 +185,13 @@ typedef enum
  * \defgroup taskENTER_CRITICAL taskENTER_CRITICAL
  * \ingroup SchedulerControl
  */
-#define taskENTER_CRITICAL()		portENTER_CRITICAL()
-#define taskENTER_CRITICAL_FROM_ISR() portSET_INTERRUPT_MASK_FROM_ISR()
+#if ( configNUM_CORES > 1 )
+	#define taskENTER_CRITICAL()		vTaskEnterCritical()
+	#define taskENTER_CRITICAL_FROM_ISR() uxTaskEnterCriticalFromISR()
+#else
+	#define taskENTER_CRITICAL()		portENTER_CRITICAL()
+	#define taskENTER_CRITICAL_FROM_ISR() portSET_INTERRUPT_MASK_FROM_ISR()
+#endif
 
 /**
  * task. h
@@ -190,8 +205,13 @@ typedef enum
  * \defgroup taskEXIT_CRITICAL taskEXIT_CRITICAL
  * \ingroup SchedulerControl
  */
-#define taskEXIT_CRITICAL()			portEXIT_CRITICAL()
-#define taskEXIT_CRITICAL_FROM_ISR( x ) portCLEAR_INTERRUPT_MASK_FROM_ISR( x )
+#if ( configNUM_CORES > 1 )
+	#define taskEXIT_CRITICAL()			vTaskExitCritical()
+	#define taskEXIT_CRITICAL_FROM_ISR( x ) vTaskExitCriticalFromISR( x )
+#else
+	#define taskEXIT_CRITICAL()			portEXIT_CRITICAL()
+	#define taskEXIT_CRITICAL_FROM_ISR( x ) portCLEAR_INTERRUPT_MASK_FROM_ISR( x )
+#endif
 /**
  * task. h
  *
@@ -326,6 +346,46 @@ is used in assert() statements. */
 							TaskHandle_t * const pxCreatedTask ) PRIVILEGED_FUNCTION;
 #endif
 
+/**
+ * task. h
+ *<pre>
+ BaseType_t xTaskCreateAffinitySet(
+							  TaskFunction_t pvTaskCode,
+							  const char * const pcName,
+							  configSTACK_DEPTH_TYPE usStackDepth,
+							  void *pvParameters,
+							  UBaseType_t uxPriority,
+							  UBaseType_t uxCoreAffinityMask,
+							  TaskHandle_t *pvCreatedTask
+						  );</pre>
+ *
+ * Only available when configNUM_CORES is greater than 1.
+ *
+ * Create a new task, as xTaskCreate(), that can only run on the cores set in
+ * uxCoreAffinityMask.  The mask is set before the task is made ready, so the
+ * task never runs on another core.
+ *
+ * @param uxCoreAffinityMask Bit n is set if the task can run on core n.
+ * tskNO_AFFINITY lets the task run on any core.
+ *
+ * Example usage:
+   <pre>
+ // Keep the TCP/IP stack on core 0 and the signing work on core 1.
+ xTaskCreateAffinitySet( vSignTask, "Sign", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, ( 1 << 1 ), NULL );
+   </pre>
+ * \defgroup xTaskCreateAffinitySet xTaskCreateAffinitySet
+ * \ingroup Tasks
+ */
+#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configNUM_CORES > 1 ) )
+	BaseType_t xTaskCreateAffinitySet(	TaskFunction_t pxTaskCode,
+										const char * const pcName,	/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+										const configSTACK_DEPTH_TYPE usStackDepth,
+										void * const pvParameters,
+										UBaseType_t uxPriority,
+										UBaseType_t uxCoreAffinityMask,
+										TaskHandle_t * const pxCreatedTask ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * task. h
  *<pre>
@@ -1132,6 +1192,41 @@ void vTaskResume( TaskHandle_t xTaskToResume ) PRIVILEGED_FUNCTION;
  */
 BaseType_t xTaskResumeFromISR( TaskHandle_t xTaskToResume ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <pre>void vTaskCoreAffinitySet( TaskHandle_t xTask, UBaseType_t uxCoreAffinityMask );</pre>
+ *
+ * Only available when configNUM_CORES is greater than 1.
+ *
+ * Sets the cores a task can run on.  If the task is running on a core that is
+ * no longer in the mask then that core is made to select another task.
+ *
+ * @param xTask Handle to the task.  Passing NULL sets the affinity of the
+ * calling task.
+ *
+ * @param uxCoreAffinityMask Bit n is set if the task can run on core n.
+ * tskNO_AFFINITY lets the task run on any core.
+ *
+ * \defgroup vTaskCoreAffinitySet vTaskCoreAffinitySet
+ * \ingroup TaskCtrl
+ */
+void vTaskCoreAffinitySet( const TaskHandle_t xTask, UBaseType_t uxCoreAffinityMask ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <pre>UBaseType_t uxTaskCoreAffinityGet( TaskHandle_t xTask );</pre>
+ *
+ * Only available when configNUM_CORES is greater than 1.
+ *
+ * @param xTask Handle to the task.  Passing NULL queries the calling task.
+ *
+ * @return The mask of the cores the task can run on.
+ *
+ * \defgroup uxTaskCoreAffinityGet uxTaskCoreAffinityGet
+ * \ingroup TaskCtrl
+ */
+UBaseType_t uxTaskCoreAffinityGet( const TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
 /*-----------------------------------------------------------
  * SCHEDULER CONTROL
  *----------------------------------------------------------*/
@@ -1713,6 +1808,53 @@ void vTaskList( char * pcWriteBuffer ) PRIVILEGED_FUNCTION; /*lint !e971 Unquali
  */
 void vTaskGetRunTimeStats( char *pcWriteBuffer ) PRIVILEGED_FUNCTION; /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
 
+/**
+ * task. h
+ * <PRE>uint32_t ulTaskGetRunTimeCounter( const TaskHandle_t xTask );</PRE>
+ *
+ * configGENERATE_RUN_TIME_STATS must be defined as 1 for this function to be
+ * available.
+ *
+ * Returns the total time xTask has spent in the Running state, in units of
+ * the run time counter, including the time since it was last switched in if it
+ * is running now.  Unlike uxTaskGetSystemState() this does not walk the task
+ * lists, and only disables interrupts for a few instructions, so it can be
+ * called periodically by production code.  The value wraps with the run time
+ * counter, so the difference between two calls is only valid if they are less
+ * than one counter period apart.
+ *
+ * @param xTask The task to query, or NULL for the calling task.
+ *
+ * \defgroup ulTaskGetRunTimeCounter ulTaskGetRunTimeCounter
+ * \ingroup TaskUtils
+ */
+uint32_t ulTaskGetRunTimeCounter( const TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>uint32_t ulTaskGetIdleRunTimeCounter( void );</PRE>
+ *
+ * configGENERATE_RUN_TIME_STATS must be defined as 1 for this function to be
+ * available.
+ *
+ * As ulTaskGetRunTimeCounter(), for the idle task, summed over the idle tasks
+ * of all cores.  Sampling it together with portGET_RUN_TIME_COUNTER_VALUE()
+ * gives the idle time, and so the CPU load, over an interval:
+ * <pre>
+	ulIdle = ulTaskGetIdleRunTimeCounter();
+	ulTotal = portGET_RUN_TIME_COUNTER_VALUE();
+
+	// ... later ...
+
+	ulLoadPercent = ( configNUM_CORES * 100UL ) -
+		( ( ulTaskGetIdleRunTimeCounter() - ulIdle ) / ( ( portGET_RUN_TIME_COUNTER_VALUE() - ulTotal ) / 100UL ) );
+   </pre>
+ *
+ * \defgroup ulTaskGetIdleRunTimeCounter ulTaskGetIdleRunTimeCounter
+ * \ingroup TaskUtils
+ */
+uint32_t ulTaskGetIdleRunTimeCounter( void ) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <PRE>BaseType_t xTaskNotify( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction );</PRE>
@@ -2253,6 +2395,21 @@ void vTaskRemoveFromUnorderedEventList( ListItem_t * pxEventListItem, const Tick
  */
 void vTaskSwitchContext( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * THESE FUNCTIONS MUST NOT BE USED FROM APPLICATION CODE.  THEY ARE ONLY
+ * AVAILABLE WHEN configNUM_CORES IS GREATER THAN 1, AND IMPLEMENT THE CRITICAL
+ * SECTION AND YIELD MACROS.
+ *
+ * A critical section masks interrupts on the calling core and holds the task
+ * and ISR locks, so excludes the other cores too.  A yield requested while a
+ * critical section is held is performed when the critical section is exited.
+ */
+void vTaskEnterCritical( void ) PRIVILEGED_FUNCTION;
+void vTaskExitCritical( void ) PRIVILEGED_FUNCTION;
+UBaseType_t uxTaskEnterCriticalFromISR( void ) PRIVILEGED_FUNCTION;
+void vTaskExitCriticalFromISR( UBaseType_t uxSavedInterruptStatus ) PRIVILEGED_FUNCTION;
+void vTaskYieldWithinAPI( void ) PRIVILEGED_FUNCTION;
+
 /*
  * THESE FUNCTIONS MUST NOT BE USED FROM APPLICATION CODE.  THEY ARE USED BY
  * THE EVENT BITS MODULE.
@@ -218,6 +218,10 @@ typedef struct MQTTBrokerConnection
     UBaseType_t uxFlags;                                                /**< Various properties of the connection - secured etc. */
     BaseType_t xConnectionInUse;                                        /**< Tracks whether or not the connection is in use. It is accessed from application tasks (prvGetFreeConnection and prvReturnConnection) and hence should be accessed in critical section. */
     uint8_t ucRxBuffer[ mqttconfigRX_BUFFER_SIZE ];                     /**< Buffers incoming messages. */
+    #if ( mqttconfigSEND_COALESCE_WINDOW_MS != 0 )
+        BaseType_t xSendHeld;                                           /**< Whether the socket may still hold sent data in its coalescing window. */
+        TickType_t xLastSendTicks;                                      /**< Tick count of the last send, from which the coalescing window is timed. */
+    #endif
 } MQTTBrokerConnection_t;
 /*-----------------------------------------------------------*/
 
@@ -268,6 +272,28 @@ static TaskHandle_t xMQTTTaskHandle = NULL;
  * MQTT task.
  */
 static uint32_t ulQueueMessageIdentifier = 0;
+
+#if ( configUSE_TRACE_RECORDER == 1 )
+
+/**
+ * @brief The trace recorder's user event channel for the commands the MQTT
+ * task processes.
+ */
+    static traceString xMQTTTraceChannel = NULL;
+
+/**
+ * @brief The names the commands are recorded with, indexed by MQTTAction_t.
+ */
+    static const char * const pcMQTTActionNames[] =
+    {
+        "Service socket",
+        "Connect",
+        "Disconnect",
+        "Subscribe",
+        "Unsubscribe",
+        "Publish"
+    };
+#endif
 /*-----------------------------------------------------------*/
 
 /**
@@ -674,6 +700,15 @@ static uint32_t prvMQTTSendCallback( void * pvSendContext,
         }
     }
 
+    #if ( mqttconfigSEND_COALESCE_WINDOW_MS != 0 )
+        /* The socket may hold the data until the MQTT task next uses it. */
+        if( ulBytesSent > 0U )
+        {
+            pxConnection->xSendHeld = pdTRUE;
+            pxConnection->xLastSendTicks = xTaskGetTickCount();
+        }
+    #endif
+
     return ulBytesSent;
 }
 /*-----------------------------------------------------------*/
@@ -858,6 +893,10 @@ static BaseType_t prvSetupConnection( const MQTTEventData_t * const pxEventData
     MQTTBrokerConnection_t * pxConnection = &( xMQTTConnections[ pxEventData->uxBrokerNumber ] );
     char * ppcAlpns[] = { socketsAWS_IOT_ALPN_MQTT };
 
+    #if ( mqttconfigSEND_COALESCE_WINDOW_MS != 0 )
+        const TickType_t xCoalesceWindow = pdMS_TO_TICKS( mqttconfigSEND_COALESCE_WINDOW_MS );
+    #endif
+
     /* Should not get here if the socket used to communicate with the
      * broker is already connected. */
     configASSERT( pxConnection->xSocket == SOCKETS_INVALID_SOCKET );
@@ -968,6 +1007,15 @@ static BaseType_t prvSetupConnection( const MQTTEventData_t * const pxEventData
                                              SOCKETS_SO_NONBLOCK,
                                              NULL /* Unused. */,
                                              0 /* Unused. */ );
+
+                #if ( mqttconfigSEND_COALESCE_WINDOW_MS != 0 )
+                    /* Let acknowledgements and small publishes share a record. */
+                    ( void ) SOCKETS_SetSockOpt( pxConnection->xSocket,
+                                                 0, /* Level - Unused. */
+                                                 SOCKETS_SO_SEND_COALESCE_WINDOW,
+                                                 &xCoalesceWindow,
+                                                 sizeof( xCoalesceWindow ) );
+                #endif
             }
             else
             {
@@ -1268,6 +1316,11 @@ static TickType_t prvManageConnections( void )
     TickType_t xNextMQTTPeriodicInvokeTicks, xNextTimeoutTicks = portMAX_DELAY;
     uint64_t xTickCount = 0;
 
+    #if ( mqttconfigSEND_COALESCE_WINDOW_MS != 0 )
+        const TickType_t xCoalesceWindow = pdMS_TO_TICKS( mqttconfigSEND_COALESCE_WINDOW_MS );
+        TickType_t xHeldTicks;
+    #endif
+
     /* For each broker the MQTT task might be connected to. */
     for( uxBrokerNumber = 0; uxBrokerNumber < ( UBaseType_t ) mqttconfigMAX_BROKERS; uxBrokerNumber++ )
     {
@@ -1276,6 +1329,25 @@ static TickType_t prvManageConnections( void )
         /* Process only the connected clients. */
         if( pxConnection->xSocket != SOCKETS_INVALID_SOCKET )
         {
+            #if ( mqttconfigSEND_COALESCE_WINDOW_MS != 0 )
+                /* Held data is only sent when the socket is next used, so
+                 * wake up when the window of the last send has passed. Once
+                 * it has, SOCKETS_Recv below sends the held data. */
+                if( pxConnection->xSendHeld == pdTRUE )
+                {
+                    xHeldTicks = xTaskGetTickCount() - pxConnection->xLastSendTicks;
+
+                    if( xHeldTicks >= xCoalesceWindow )
+                    {
+                        pxConnection->xSendHeld = pdFALSE;
+                    }
+                    else
+                    {
+                        xNextTimeoutTicks = configMIN( xNextTimeoutTicks, xCoalesceWindow - xHeldTicks );
+                    }
+                }
+            #endif
+
             /* Read data from the socket. */
             lBytesReceived = SOCKETS_Recv( pxConnection->xSocket, pxConnection->ucRxBuffer, mqttconfigRX_BUFFER_SIZE, 0 );
 
@@ -1768,6 +1840,10 @@ static void prvMQTTTask( void * pvParameters )
              * task. */
             if( xTaskCheckForTimeOut( &( xMQTTCommand.xEventCreationTimestamp ), &( xMQTTCommand.xTicksToWait ) ) == pdTRUE )
             {
+                #if ( configUSE_TRACE_RECORDER == 1 )
+                    vTracePrintF( xMQTTTraceChannel, "Timed out %d", ( int ) xMQTTCommand.xEventType );
+                #endif
+
                 /* Note that in case of eMQTTServiceSocket event, the
                  * xMQTTCommand.xNotificationData.xTaskToNotify happens to
                  * be NULL and therefore prvNotifyRequestingTask returns
@@ -1780,6 +1856,13 @@ static void prvMQTTTask( void * pvParameters )
                  * has been updated in the previous call to xTaskCheckForTimeout
                  * to ensure that we block only for the duration specified by the
                  * user. */
+                #if ( configUSE_TRACE_RECORDER == 1 )
+                    if( ( UBaseType_t ) xMQTTCommand.xEventType < ( sizeof( pcMQTTActionNames ) / sizeof( pcMQTTActionNames[ 0 ] ) ) )
+                    {
+                        vTracePrint( xMQTTTraceChannel, pcMQTTActionNames[ xMQTTCommand.xEventType ] );
+                    }
+                #endif
+
                 switch( xMQTTCommand.xEventType )
                 {
                     case eMQTTConnectRequest:
@@ -1889,6 +1972,11 @@ BaseType_t MQTT_AGENT_Init( void )
         xCommandQueue = xQueueCreateStatic( mqttCOMMAND_QUEUE_LENGTH, sizeof( MQTTEventData_t ), ucQueueStorageArea, &xStaticQueue );
         configASSERT( xCommandQueue );
 
+        #if ( configUSE_TRACE_RECORDER == 1 )
+            vTraceSetQueueName( xCommandQueue, "MQTT commands" );
+            xMQTTTraceChannel = xTraceRegisterString( "MQTT" );
+        #endif
+
         xMQTTTaskHandle = xTaskCreateStatic( prvMQTTTask, "MQTT", mqttconfigMQTT_TASK_STACK_DEPTH, NULL, mqttconfigMQTT_TASK_PRIORITY, xStack, &xStaticTask );
         configASSERT( xMQTTTaskHandle );
     }
@@ -38,6 +38,7 @@
 #include "task.h"
 #include "semphr.h"
 #include "aws_crypto.h"
+#include "aws_crypto_p256.h"
 #include "aws_pkcs11.h"
 
 /* mbedTLS includes. */
@@ -48,6 +49,8 @@
 #include "mbedtls/entropy.h"
 #include "mbedtls/sha256.h"
 #include "mbedtls/base64.h"
+#include "mbedtls/asn1.h"
+#include "mbedtls/platform_util.h"
 #include "threading_alt.h"
 
 /* C runtime includes. */
@@ -70,12 +73,44 @@ typedef int ( * pfnMbedTlsSign )( void * ctx,
 /* The size of the buffer malloc'ed for the exported public key in C_GenerateKeyPair */
 #define pkcs11KEY_GEN_MAX_DER_SIZE    200
 
+/* The number of parsed keys kept resident for C_SignInit and C_VerifyInit. */
+#ifndef pkcs11configKEY_CACHE_ENTRIES
+    #define pkcs11configKEY_CACHE_ENTRIES    2
+#endif
+
+/**
+ * @brief Parsed key shared by the sessions that use the same object.
+ *
+ * The cache holds one reference and each session that initialized an
+ * operation with the key holds another. The key is freed when the last
+ * reference is released. The references are counted under the key cache
+ * mutex, and operations on xKey are serialized by the entry's own mutex, as
+ * mbedTLS caches values in the key, such as the comb table of the curve.
+ *
+ * P-256 private keys are also prepared for the dedicated signing code, which
+ * only reads the prepared key and needs no lock.
+ */
+typedef struct P11KeyCacheEntry
+{
+    CK_OBJECT_HANDLE xHandle;
+    CK_BBOOL xIsPrivate;
+    mbedtls_pk_context xKey;
+    SemaphoreHandle_t xKeyMutex;
+    CK_BBOOL xHasP256Key;
+    CryptoP256Key_t xP256Key;
+    UBaseType_t uxReferences;
+} P11KeyCacheEntry_t;
+
 /* PKCS#11 Object */
 typedef struct P11Struct_t
 {
     CK_BBOOL xIsInitialized;
     mbedtls_ctr_drbg_context xMbedDrbgCtx;
     mbedtls_entropy_context xMbedEntropyContext;
+    SemaphoreHandle_t xKeyCacheMutex;
+    P11KeyCacheEntry_t * pxKeyCache[ pkcs11configKEY_CACHE_ENTRIES ];
+    UBaseType_t uxKeyCacheNext;
+    UBaseType_t uxKeyCacheGeneration;
 } P11Struct_t, * P11Context_t;
 
 static P11Struct_t xP11Context;
@@ -93,8 +128,8 @@ typedef struct P11Session
     CK_BBOOL xFindObjectComplete;
     uint8_t * xFindObjectLabel;
     uint8_t xFindObjectLabelLength;
-    mbedtls_pk_context xVerifyKey;
-    mbedtls_pk_context xSignKey;
+    P11KeyCacheEntry_t * pxVerifyKey;
+    P11KeyCacheEntry_t * pxSignKey;
     mbedtls_sha256_context xSHA256Context;
 } P11Session_t, * P11SessionPtr_t;
 
@@ -254,6 +289,350 @@ P11SessionPtr_t prvSessionPointerFromHandle( CK_SESSION_HANDLE xSession )
     return ( P11SessionPtr_t ) xSession; /*lint !e923 Allow casting integer type to pointer for handle. */
 }
 
+/*-----------------------------------------------------------*/
+/*------------------ Parsed key cache -----------------------*/
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Take the key cache mutex.
+ *
+ * @return pdTRUE if the module is initialized and the cache may be accessed.
+ */
+static BaseType_t prvKeyCacheLock( void )
+{
+    BaseType_t xResult = pdFALSE;
+
+    if( NULL != xP11Context.xKeyCacheMutex )
+    {
+        xResult = xSemaphoreTake( xP11Context.xKeyCacheMutex, portMAX_DELAY );
+    }
+
+    return xResult;
+}
+
+/**
+ * @brief Release a reference to a parsed key. Must be called with the key
+ * cache mutex held.
+ */
+static void prvKeyCacheRelease( P11KeyCacheEntry_t * pxEntry )
+{
+    if( NULL != pxEntry )
+    {
+        pxEntry->uxReferences--;
+
+        if( 0 == pxEntry->uxReferences )
+        {
+            if( NULL != pxEntry->xKeyMutex )
+            {
+                vSemaphoreDelete( pxEntry->xKeyMutex );
+            }
+
+            CRYPTO_P256FreeKey( &pxEntry->xP256Key );
+            mbedtls_pk_free( &pxEntry->xKey );
+            vPortFree( pxEntry );
+        }
+    }
+}
+
+/**
+ * @brief Release the key referenced by a session, if any.
+ */
+static void prvKeyCacheDetach( P11KeyCacheEntry_t ** ppxEntry )
+{
+    if( ( NULL != *ppxEntry ) && ( pdTRUE == prvKeyCacheLock() ) )
+    {
+        prvKeyCacheRelease( *ppxEntry );
+        *ppxEntry = NULL;
+        ( void ) xSemaphoreGive( xP11Context.xKeyCacheMutex );
+    }
+}
+
+/**
+ * @brief Prepare a P-256 private key for CRYPTO_P256Sign().
+ */
+static void prvPrepareP256Key( P11KeyCacheEntry_t * pxEntry )
+{
+    uint8_t ucPrivateKey[ cryptoP256_BYTES ];
+    mbedtls_ecp_keypair * pxKeyPair;
+
+    if( MBEDTLS_PK_ECKEY == mbedtls_pk_get_type( &pxEntry->xKey ) )
+    {
+        pxKeyPair = mbedtls_pk_ec( pxEntry->xKey );
+
+        if( ( MBEDTLS_ECP_DP_SECP256R1 == pxKeyPair->grp.id ) &&
+            ( 0 == mbedtls_mpi_write_binary( &pxKeyPair->d, ucPrivateKey, sizeof( ucPrivateKey ) ) ) &&
+            ( pdPASS == CRYPTO_P256ImportKey( &pxEntry->xP256Key, ucPrivateKey ) ) )
+        {
+            pxEntry->xHasP256Key = CK_TRUE;
+        }
+
+        mbedtls_platform_zeroize( ucPrivateKey, sizeof( ucPrivateKey ) );
+    }
+}
+
+/**
+ * @brief Encode an ECDSA signature r || s as the DER sequence that
+ * mbedtls_pk_sign() produces.
+ *
+ * @return The length of the encoding, at most MBEDTLS_ECDSA_MAX_LEN.
+ */
+static size_t prvEcdsaSignatureToDer( const uint8_t * pucSignature,
+                                      uint8_t * pucDer )
+{
+    size_t xLength = 2;
+    size_t xSkip;
+    BaseType_t x;
+    const uint8_t * pucInteger;
+
+    for( x = 0; x < 2; x++ )
+    {
+        /* Minimal, positive INTEGER. */
+        pucInteger = &pucSignature[ x * cryptoP256_BYTES ];
+
+        xSkip = 0;
+
+        while( ( xSkip < cryptoP256_BYTES - 1 ) && ( 0 == pucInteger[ xSkip ] ) )
+        {
+            xSkip++;
+        }
+
+        pucDer[ xLength++ ] = MBEDTLS_ASN1_INTEGER;
+
+        if( 0 != ( pucInteger[ xSkip ] & 0x80 ) )
+        {
+            pucDer[ xLength++ ] = ( uint8_t ) ( cryptoP256_BYTES - xSkip + 1 );
+            pucDer[ xLength++ ] = 0;
+        }
+        else
+        {
+            pucDer[ xLength++ ] = ( uint8_t ) ( cryptoP256_BYTES - xSkip );
+        }
+
+        memcpy( &pucDer[ xLength ], &pucInteger[ xSkip ], cryptoP256_BYTES - xSkip );
+        xLength += cryptoP256_BYTES - xSkip;
+    }
+
+    pucDer[ 0 ] = MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE;
+    pucDer[ 1 ] = ( uint8_t ) ( xLength - 2 );
+
+    return xLength;
+}
+
+/**
+ * @brief Find the cached key of an object and take a reference to it. Must
+ * be called with the key cache mutex held.
+ *
+ * @param[out] pxFreeSlot A free entry of the cache, or -1 if there is none.
+ */
+static P11KeyCacheEntry_t * prvKeyCacheFind( CK_OBJECT_HANDLE xHandle,
+                                             BaseType_t * pxFreeSlot )
+{
+    P11KeyCacheEntry_t * pxEntry = NULL;
+    BaseType_t x;
+
+    *pxFreeSlot = -1;
+
+    for( x = 0; x < pkcs11configKEY_CACHE_ENTRIES; x++ )
+    {
+        if( NULL == xP11Context.pxKeyCache[ x ] )
+        {
+            *pxFreeSlot = x;
+        }
+        else if( xHandle == xP11Context.pxKeyCache[ x ]->xHandle )
+        {
+            pxEntry = xP11Context.pxKeyCache[ x ];
+            pxEntry->uxReferences++;
+            break;
+        }
+    }
+
+    return pxEntry;
+}
+
+/**
+ * @brief Read and parse the key of an object into a new entry, holding one
+ * reference. Called without the key cache mutex, so that the storage is not
+ * read while other sessions wait for the cache.
+ */
+static CK_RV prvKeyCacheLoad( CK_OBJECT_HANDLE xHandle,
+                              P11KeyCacheEntry_t ** ppxEntry )
+{
+    CK_RV xResult = CKR_OK;
+    P11KeyCacheEntry_t * pxEntry;
+    uint8_t * pucKeyData = NULL;
+    uint32_t ulKeyDataLength = 0;
+    int32_t lMbedTLSParseResult = ~0;
+
+    pxEntry = pvPortMalloc( sizeof( P11KeyCacheEntry_t ) );
+
+    if( NULL == pxEntry )
+    {
+        xResult = CKR_HOST_MEMORY;
+    }
+    else
+    {
+        memset( pxEntry, 0, sizeof( P11KeyCacheEntry_t ) );
+        mbedtls_pk_init( &pxEntry->xKey );
+        pxEntry->xHandle = xHandle;
+        pxEntry->uxReferences = 1;
+        pxEntry->xKeyMutex = xSemaphoreCreateMutex();
+
+        if( NULL == pxEntry->xKeyMutex )
+        {
+            xResult = CKR_HOST_MEMORY;
+        }
+    }
+
+    if( CKR_OK == xResult )
+    {
+        xResult = PKCS11_PAL_GetObjectValue( xHandle, &pucKeyData, &ulKeyDataLength, &pxEntry->xIsPrivate );
+    }
+
+    if( CKR_OK == xResult )
+    {
+        if( CK_TRUE == pxEntry->xIsPrivate )
+        {
+            lMbedTLSParseResult = mbedtls_pk_parse_key( &pxEntry->xKey, pucKeyData, ulKeyDataLength, NULL, 0 );
+        }
+        else
+        {
+            lMbedTLSParseResult = mbedtls_pk_parse_public_key( &pxEntry->xKey, pucKeyData, ulKeyDataLength );
+
+            if( 0 != lMbedTLSParseResult )
+            {
+                lMbedTLSParseResult = mbedtls_pk_parse_key( &pxEntry->xKey, pucKeyData, ulKeyDataLength, NULL, 0 );
+            }
+        }
+
+        PKCS11_PAL_GetObjectValueCleanup( pucKeyData, ulKeyDataLength );
+
+        if( 0 != lMbedTLSParseResult )
+        {
+            xResult = CKR_KEY_HANDLE_INVALID;
+        }
+    }
+
+    if( ( CKR_OK == xResult ) && ( CK_TRUE == pxEntry->xIsPrivate ) )
+    {
+        prvPrepareP256Key( pxEntry );
+    }
+
+    if( ( CKR_OK != xResult ) && ( NULL != pxEntry ) )
+    {
+        /* Not shared yet, so no lock is needed. */
+        prvKeyCacheRelease( pxEntry );
+        pxEntry = NULL;
+    }
+
+    *ppxEntry = pxEntry;
+
+    return xResult;
+}
+
+/**
+ * @brief Get a reference to the parsed key of an object.
+ *
+ * Storage is only read, and the key only parsed, the first time the object
+ * is used or after it has been replaced. The key cache mutex is only held to
+ * look the key up and to count references.
+ */
+static CK_RV prvKeyCacheAcquire( CK_OBJECT_HANDLE xHandle,
+                                 P11KeyCacheEntry_t ** ppxEntry )
+{
+    CK_RV xResult = CKR_OK;
+    P11KeyCacheEntry_t * pxEntry = NULL;
+    P11KeyCacheEntry_t * pxLoaded = NULL;
+    UBaseType_t uxGeneration = 0;
+    BaseType_t xSlot = -1;
+
+    if( pdTRUE != prvKeyCacheLock() )
+    {
+        xResult = CKR_CRYPTOKI_NOT_INITIALIZED;
+    }
+    else
+    {
+        pxEntry = prvKeyCacheFind( xHandle, &xSlot );
+        uxGeneration = xP11Context.uxKeyCacheGeneration;
+        ( void ) xSemaphoreGive( xP11Context.xKeyCacheMutex );
+    }
+
+    if( ( CKR_OK == xResult ) && ( NULL == pxEntry ) )
+    {
+        xResult = prvKeyCacheLoad( xHandle, &pxLoaded );
+    }
+
+    if( ( NULL != pxLoaded ) && ( pdTRUE != prvKeyCacheLock() ) )
+    {
+        /* Finalized while the key was being loaded. */
+        prvKeyCacheRelease( pxLoaded );
+        xResult = CKR_CRYPTOKI_NOT_INITIALIZED;
+    }
+    else if( NULL != pxLoaded )
+    {
+        /* Another session may have loaded the key in the meantime. */
+        pxEntry = prvKeyCacheFind( xHandle, &xSlot );
+
+        if( NULL != pxEntry )
+        {
+            prvKeyCacheRelease( pxLoaded );
+        }
+        else
+        {
+            pxEntry = pxLoaded;
+
+            /* A key read before its object was replaced or destroyed is only
+             * used by this session, not cached. */
+            if( uxGeneration == xP11Context.uxKeyCacheGeneration )
+            {
+                /* Use a free entry, or else evict the entries in turn. */
+                if( xSlot < 0 )
+                {
+                    xSlot = ( BaseType_t ) ( xP11Context.uxKeyCacheNext % pkcs11configKEY_CACHE_ENTRIES );
+                    xP11Context.uxKeyCacheNext++;
+                }
+
+                /* Sessions still using the evicted key keep it alive. */
+                prvKeyCacheRelease( xP11Context.pxKeyCache[ xSlot ] );
+                xP11Context.pxKeyCache[ xSlot ] = pxEntry;
+                pxEntry->uxReferences++;
+            }
+        }
+
+        ( void ) xSemaphoreGive( xP11Context.xKeyCacheMutex );
+    }
+
+    *ppxEntry = pxEntry;
+
+    return xResult;
+}
+
+/**
+ * @brief Drop the parsed key of an object that was replaced or destroyed, or
+ * of all objects if xHandle is 0.
+ */
+static void prvKeyCacheInvalidate( CK_OBJECT_HANDLE xHandle )
+{
+    BaseType_t x;
+
+    if( pdTRUE == prvKeyCacheLock() )
+    {
+        /* Keys being loaded meanwhile are not cached. */
+        xP11Context.uxKeyCacheGeneration++;
+
+        for( x = 0; x < pkcs11configKEY_CACHE_ENTRIES; x++ )
+        {
+            if( ( NULL != xP11Context.pxKeyCache[ x ] ) &&
+                ( ( 0 == xHandle ) || ( xHandle == xP11Context.pxKeyCache[ x ]->xHandle ) ) )
+            {
+                prvKeyCacheRelease( xP11Context.pxKeyCache[ x ] );
+                xP11Context.pxKeyCache[ x ] = NULL;
+            }
+        }
+
+        ( void ) xSemaphoreGive( xP11Context.xKeyCacheMutex );
+    }
+}
+
 
 /*
  * PKCS#11 module implementation.
@@ -357,6 +736,23 @@ CK_RV prvMbedTLS_Initialize( void )
                                    aws_mbedtls_mutex_lock,
                                    aws_mbedtls_mutex_unlock );
 
+        /* Tables for P-256 signing. */
+        ( void ) CRYPTO_P256Init();
+
+        /* The parsed key cache is shared by all sessions. */
+        if( NULL == xP11Context.xKeyCacheMutex )
+        {
+            xP11Context.xKeyCacheMutex = xSemaphoreCreateMutex();
+
+            if( NULL == xP11Context.xKeyCacheMutex )
+            {
+                xResult = CKR_HOST_MEMORY;
+            }
+        }
+    }
+
+    if( xResult == CKR_OK )
+    {
         /* Initialze the entropy source and DRBG for the PKCS#11 module */
         mbedtls_entropy_init( &xP11Context.xMbedEntropyContext );
         mbedtls_ctr_drbg_init( &xP11Context.xMbedDrbgCtx );
@@ -420,6 +816,10 @@ CK_DEFINE_FUNCTION( CK_RV, C_Finalize )( CK_VOID_PTR pvReserved )
             mbedtls_ctr_drbg_free( &xP11Context.xMbedDrbgCtx );
         }
 
+        /* Keys referenced by sessions that are still open are freed when
+         * those sessions close. */
+        prvKeyCacheInvalidate( 0 );
+
         xP11Context.xIsInitialized = CK_FALSE;
     }
 
@@ -579,16 +979,10 @@ CK_DEFINE_FUNCTION( CK_RV, C_CloseSession )( CK_SESSION_HANDLE xSession )
          * Tear down the session.
          */
 
-        if( NULL != pxSession->xSignKey.pk_ctx )
-        {
-            mbedtls_pk_free( &pxSession->xSignKey );
-        }
+        prvKeyCacheDetach( &pxSession->pxSignKey );
 
-        /* Free the public key context if it exists. */
-        if( NULL != pxSession->xVerifyKey.pk_ctx )
-        {
-            mbedtls_pk_free( &pxSession->xVerifyKey );
-        }
+        /* Release the public key context if it exists. */
+        prvKeyCacheDetach( &pxSession->pxVerifyKey );
 
         if( NULL != &pxSession->xSHA256Context )
         {
@@ -782,6 +1176,12 @@ CK_DEFINE_FUNCTION( CK_RV, C_CreateObject )( CK_SESSION_HANDLE xSession,
         }
     }
 
+    /* The object may have replaced a key that is parsed already. */
+    if( CKR_OK == xResult )
+    {
+        prvKeyCacheInvalidate( *pxObject );
+    }
+
     return xResult;
 }
 
@@ -793,7 +1193,12 @@ CK_DEFINE_FUNCTION( CK_RV, C_DestroyObject )( CK_SESSION_HANDLE xSession,
 {
     /* TODO: Delete objects from NVM. */
     ( void ) xSession;
-    ( void ) xObject;
+
+    if( 0 != xObject )
+    {
+        prvKeyCacheInvalidate( xObject );
+    }
+
     return CKR_OK;
 }
 
@@ -1200,12 +1605,10 @@ CK_DEFINE_FUNCTION( CK_RV, C_SignInit )( CK_SESSION_HANDLE xSession,
                                          CK_OBJECT_HANDLE xKey )
 {
     CK_RV xResult = CKR_OK;
-    CK_BBOOL xIsPrivate;
 
     /*lint !e9072 It's OK to have different parameter name. */
     P11SessionPtr_t pxSession = prvSessionPointerFromHandle( xSession );
-    uint8_t * keyData = NULL;
-    uint32_t ulKeyDataLength = 0;
+    P11KeyCacheEntry_t * pxKey = NULL;
 
     if( NULL == pxMechanism )
     {
@@ -1213,34 +1616,25 @@ CK_DEFINE_FUNCTION( CK_RV, C_SignInit )( CK_SESSION_HANDLE xSession,
     }
     else
     {
-        xResult = PKCS11_PAL_GetObjectValue( xKey, &keyData, &ulKeyDataLength, &xIsPrivate );
+        /* Release the key of an earlier operation. */
+        prvKeyCacheDetach( &pxSession->pxSignKey );
 
-        if( xIsPrivate != CK_TRUE )
-        {
-            xResult = CKR_KEY_TYPE_INCONSISTENT;
-        }
+        /* TODO: Check the mechanism.  Note: Currently, mechanism is being set to CKM_SHA256, rather than
+         * CKM_RSA_PKCS
+         * CKM_SHA256_RSA_PKCS
+         * CKM_ECDSA
+         * Calling function does not know whether key is RSA or ECDSA.
+         * xKeyType = mbedtls_pk_get_type( &pxKey->xKey );
+         */
+        xResult = prvKeyCacheAcquire( xKey, &pxKey );
 
-        if( xResult == CKR_OK )
+        if( ( xResult == CKR_OK ) && ( pxKey->xIsPrivate != CK_TRUE ) )
         {
-            mbedtls_pk_init( &pxSession->xSignKey );
-
-            if( 0 == mbedtls_pk_parse_key( &pxSession->xSignKey, keyData, ulKeyDataLength, NULL, 0 ) )
-            {
-                /* TODO: Check the mechanism.  Note: Currently, mechanism is being set to CKM_SHA256, rather than
-                 * CKM_RSA_PKCS
-                 * CKM_SHA256_RSA_PKCS
-                 * CKM_ECDSA
-                 * Calling function does not know whether key is RSA or ECDSA.
-                 * xKeyType = mbedtls_pk_get_type( &pxSession->xSignKey );
-                 */
-            }
-            else
-            {
-                xResult = CKR_KEY_HANDLE_INVALID;
-            }
+            xResult = CKR_KEY_TYPE_INCONSISTENT;
+            prvKeyCacheDetach( &pxKey );
         }
 
-        PKCS11_PAL_GetObjectValueCleanup( keyData, ulKeyDataLength );
+        pxSession->pxSignKey = pxKey;
     }
 
     return xResult;
@@ -1286,16 +1680,45 @@ CK_DEFINE_FUNCTION( CK_RV, C_Sign )( CK_SESSION_HANDLE xSession,
              * Sign the data.
              */
 
+            if( ( CKR_OK == xResult ) && ( NULL == pxSessionObj->pxSignKey ) )
+            {
+                xResult = CKR_OPERATION_NOT_INITIALIZED;
+            }
+
+            /* The session's reference keeps the shared key alive. */
             if( CKR_OK == xResult )
             {
-                BaseType_t x = mbedtls_pk_sign( &pxSessionObj->xSignKey,
-                                                MBEDTLS_MD_SHA256,
-                                                pucData,
-                                                ulDataLen,
-                                                pucSignature,
-                                                ( size_t * ) pulSignatureLen,
-                                                mbedtls_ctr_drbg_random,
-                                                &xP11Context.xMbedDrbgCtx );
+                BaseType_t x;
+                uint8_t ucP256Signature[ 2 * cryptoP256_BYTES ];
+
+                if( CK_TRUE == pxSessionObj->pxSignKey->xHasP256Key )
+                {
+                    x = ( pdPASS == CRYPTO_P256Sign( &pxSessionObj->pxSignKey->xP256Key,
+                                                     pucData,
+                                                     ulDataLen,
+                                                     ucP256Signature,
+                                                     mbedtls_ctr_drbg_random,
+                                                     &xP11Context.xMbedDrbgCtx ) ) ? 0 : -1;
+
+                    if( 0 == x )
+                    {
+                        *pulSignatureLen = ( CK_ULONG ) prvEcdsaSignatureToDer( ucP256Signature, pucSignature );
+                    }
+                }
+                else
+                {
+                    /* Other sessions may use the same key. */
+                    ( void ) xSemaphoreTake( pxSessionObj->pxSignKey->xKeyMutex, portMAX_DELAY );
+                    x = mbedtls_pk_sign( &pxSessionObj->pxSignKey->xKey,
+                                         MBEDTLS_MD_SHA256,
+                                         pucData,
+                                         ulDataLen,
+                                         pucSignature,
+                                         ( size_t * ) pulSignatureLen,
+                                         mbedtls_ctr_drbg_random,
+                                         &xP11Context.xMbedDrbgCtx );
+                    ( void ) xSemaphoreGive( pxSessionObj->pxSignKey->xKeyMutex );
+                }
 
                 if( x != CKR_OK )
                 {
@@ -1316,10 +1739,8 @@ CK_DEFINE_FUNCTION( CK_RV, C_VerifyInit )( CK_SESSION_HANDLE xSession,
                                            CK_OBJECT_HANDLE xKey )
 {
     CK_RV xResult = CKR_OK;
-    CK_BBOOL xIsPrivate = CK_TRUE;
     P11SessionPtr_t pxSession;
-    uint8_t * keyData = NULL;
-    uint32_t ulKeyDataLength = 0;
+    P11KeyCacheEntry_t * pxKey = NULL;
 
     /*lint !e9072 It's OK to have different parameter name. */
     ( void ) ( xSession );
@@ -1333,28 +1754,21 @@ CK_DEFINE_FUNCTION( CK_RV, C_VerifyInit )( CK_SESSION_HANDLE xSession,
 
     if( xResult == CKR_OK )
     {
-        xResult = PKCS11_PAL_GetObjectValue( xKey, &keyData, &ulKeyDataLength, &xIsPrivate );
+        /* Release the key of an earlier operation. */
+        prvKeyCacheDetach( &pxSession->pxVerifyKey );
+
+        xResult = prvKeyCacheAcquire( xKey, &pxKey );
     }
 
-    if( ( xResult == CKR_OK ) && ( xIsPrivate != CK_FALSE ) )
+    if( ( xResult == CKR_OK ) && ( pxKey->xIsPrivate != CK_FALSE ) )
     {
         xResult = CKR_KEY_TYPE_INCONSISTENT;
-        PKCS11_PAL_GetObjectValueCleanup( keyData, ulKeyDataLength );
+        prvKeyCacheDetach( &pxKey );
     }
 
     if( xResult == CKR_OK )
     {
-        mbedtls_pk_init( &pxSession->xVerifyKey );
-
-        if( 0 != mbedtls_pk_parse_public_key( &pxSession->xVerifyKey, keyData, ulKeyDataLength ) )
-        {
-            if( 0 != mbedtls_pk_parse_key( &pxSession->xVerifyKey, keyData, ulKeyDataLength, NULL, 0 ) )
-            {
-                xResult = CKR_KEY_HANDLE_INVALID;
-            }
-        }
-
-        PKCS11_PAL_GetObjectValueCleanup( keyData, ulKeyDataLength );
+        pxSession->pxVerifyKey = pxKey;
     }
 
     return xResult;
@@ -1386,9 +1800,12 @@ CK_DEFINE_FUNCTION( CK_RV, C_Verify )( CK_SESSION_HANDLE xSession,
         pxSessionObj = prvSessionPointerFromHandle( xSession ); /*lint !e9072 It's OK to have different parameter name. */
 
         /* Verify the signature. If a public key is present, use it. */
-        if( NULL != pxSessionObj->xVerifyKey.pk_ctx )
+        if( NULL != pxSessionObj->pxVerifyKey )
         {
-            if( 0 != mbedtls_pk_verify( &pxSessionObj->xVerifyKey,
+            /* Other sessions may use the same key. */
+            ( void ) xSemaphoreTake( pxSessionObj->pxVerifyKey->xKeyMutex, portMAX_DELAY );
+
+            if( 0 != mbedtls_pk_verify( &pxSessionObj->pxVerifyKey->xKey,
                                         MBEDTLS_MD_SHA256,
                                         pucData,
                                         ulDataLen,
@@ -1397,6 +1814,8 @@ CK_DEFINE_FUNCTION( CK_RV, C_Verify )( CK_SESSION_HANDLE xSession,
             {
                 xResult = CKR_SIGNATURE_INVALID;
             }
+
+            ( void ) xSemaphoreGive( pxSessionObj->pxVerifyKey->xKeyMutex );
         }
 
         /* TODO: Deleted else. */
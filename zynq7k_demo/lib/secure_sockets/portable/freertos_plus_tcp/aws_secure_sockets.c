@@ -29,12 +29,19 @@
 #include "list.h"
 #include "FreeRTOS_IP.h"
 #include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_TCP_IP.h"
 #include "aws_secure_sockets.h"
 #include "aws_tls.h"
 #include "task.h"
+#include "semphr.h"
 #include "aws_pkcs11.h"
 #include "aws_crypto.h"
 
+/* Progress of a connection started with SOCKETS_ConnectStart(). */
+#define securesocketsCONNECT_NONE           ( 0 )
+#define securesocketsCONNECT_TCP            ( 1 )
+#define securesocketsCONNECT_TLS            ( 2 )
+
 /* Internal context structure. */
 typedef struct SSOCKETContext
 {
@@ -49,6 +56,13 @@ typedef struct SSOCKETContext
     char ** ppcAlpnProtocols;
     uint32_t ulAlpnProtocolsCount;
     BaseType_t xConnectAttempted;
+    BaseType_t xConnectState;
+    uint8_t * pucCoalesceBuffer;
+    size_t xCoalesceLength;
+    TickType_t xCoalesceStart;
+    TickType_t xCoalesceWindow;
+    SemaphoreHandle_t xCoalesceMutex;
+    int32_t lCoalesceError;
 } SSOCKETContext_t, * SSOCKETContextPtr_t;
 
 /*
@@ -63,8 +77,18 @@ static BaseType_t prvNetworkSend( void * pvContext,
                                   size_t xDataLength )
 {
     SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) pvContext; /*lint !e9087 cast used for portability. */
+    BaseType_t xResult;
+
+    xResult = FreeRTOS_send( pxContext->xSocket, pucData, xDataLength, pxContext->xSendFlags );
+
+    /* A non-blocking handshake is resumed once the socket has room again. */
+    if( ( -pdFREERTOS_ERRNO_ENOSPC == xResult ) &&
+        ( securesocketsCONNECT_TLS == pxContext->xConnectState ) )
+    {
+        xResult = 0;
+    }
 
-    return FreeRTOS_send( pxContext->xSocket, pucData, xDataLength, pxContext->xSendFlags );
+    return xResult;
 }
 /*-----------------------------------------------------------*/
 
@@ -81,18 +105,311 @@ static BaseType_t prvNetworkRecv( void * pvContext,
 }
 /*-----------------------------------------------------------*/
 
+/*
+ * @brief Sends through the TLS pipe, if negotiated, or unencrypted.
+ */
+static int32_t prvSend( SSOCKETContextPtr_t pxContext,
+                        const void * pvBuffer,
+                        size_t xDataLength )
+{
+    int32_t lStatus;
+
+    if( pdTRUE == pxContext->xRequireTLS )
+    {
+        lStatus = TLS_Send( pxContext->pvTLSContext, pvBuffer, xDataLength );
+    }
+    else
+    {
+        lStatus = prvNetworkSend( pxContext, pvBuffer, xDataLength );
+    }
+
+    return lStatus;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Sends the data held in the coalescing buffer as one record.
+ *
+ * Data that could not be sent stays at the start of the buffer. The caller
+ * must hold xCoalesceMutex.
+ */
+static int32_t prvCoalesceFlush( SSOCKETContextPtr_t pxContext )
+{
+    int32_t lStatus = SOCKETS_ERROR_NONE;
+
+    if( 0U != pxContext->xCoalesceLength )
+    {
+        lStatus = prvSend( pxContext, pxContext->pucCoalesceBuffer, pxContext->xCoalesceLength );
+
+        if( lStatus > 0 )
+        {
+            pxContext->xCoalesceLength -= ( size_t ) lStatus;
+            memmove( pxContext->pucCoalesceBuffer,
+                     &pxContext->pucCoalesceBuffer[ lStatus ],
+                     pxContext->xCoalesceLength );
+        }
+
+        if( 0U == pxContext->xCoalesceLength )
+        {
+            lStatus = SOCKETS_ERROR_NONE;
+        }
+        else if( lStatus >= 0 )
+        {
+            /* Timed out with data still held. */
+            lStatus = SOCKETS_EWOULDBLOCK;
+        }
+        else
+        {
+            /* Send failed; return its error. */
+        }
+    }
+
+    return lStatus;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Sends the held data for a call that has no status to return it in.
+ *
+ * A failed send is kept, and reported by the next send or receive. The
+ * caller must hold xCoalesceMutex.
+ */
+static void prvCoalesceFlushDeferred( SSOCKETContextPtr_t pxContext )
+{
+    int32_t lStatus = prvCoalesceFlush( pxContext );
+
+    if( ( lStatus < 0 ) && ( SOCKETS_EWOULDBLOCK != lStatus ) &&
+        ( SOCKETS_ERROR_NONE == pxContext->lCoalesceError ) )
+    {
+        pxContext->lCoalesceError = lStatus;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Returns and clears the error of a deferred send of held data. The
+ * caller must hold xCoalesceMutex.
+ */
+static int32_t prvCoalesceTakeError( SSOCKETContextPtr_t pxContext )
+{
+    int32_t lStatus = pxContext->lCoalesceError;
+
+    pxContext->lCoalesceError = SOCKETS_ERROR_NONE;
+
+    return lStatus;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Returns pdTRUE if data has been held for the whole coalescing window.
+ * The caller must hold xCoalesceMutex.
+ */
+static BaseType_t prvCoalesceExpired( SSOCKETContextPtr_t pxContext )
+{
+    return ( ( 0U != pxContext->xCoalesceLength ) &&
+             ( ( xTaskGetTickCount() - pxContext->xCoalesceStart ) >= pxContext->xCoalesceWindow ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Sends the buffers, gathering those shorter than a record into the
+ * coalescing buffer. The caller must hold xCoalesceMutex.
+ *
+ * Returns the number of bytes sent or held, or, if there are none, the status
+ * of the send that stopped.
+ */
+static int32_t prvCoalesceVectors( SSOCKETContextPtr_t pxContext,
+                                   const SocketsIovec_t * pxVectors,
+                                   size_t xVectorCount )
+{
+    int32_t lStatus = SOCKETS_ERROR_NONE;
+    BaseType_t xContinue = pdTRUE;
+    size_t xAccepted = 0;
+    size_t xVector;
+    size_t xOffset;
+    size_t xLength;
+    const uint8_t * pucData;
+
+    for( xVector = 0; ( xVector < xVectorCount ) && ( pdTRUE == xContinue ); xVector++ )
+    {
+        pucData = ( const uint8_t * ) pxVectors[ xVector ].pvBuffer; /*lint !e9087 cast used for portability. */
+        xOffset = 0;
+
+        while( ( xOffset < pxVectors[ xVector ].xLength ) && ( pdTRUE == xContinue ) )
+        {
+            xLength = pxVectors[ xVector ].xLength - xOffset;
+
+            if( ( 0U == pxContext->xCoalesceLength ) &&
+                ( xLength >= socketsconfigSEND_COALESCE_BUFFER_LENGTH ) )
+            {
+                /* Nothing held and at least a record's worth: send it as it is. */
+                lStatus = prvSend( pxContext, &pucData[ xOffset ], xLength );
+
+                if( lStatus > 0 )
+                {
+                    xOffset += ( size_t ) lStatus;
+                    xAccepted += ( size_t ) lStatus;
+                }
+
+                xContinue = ( ( size_t ) lStatus == xLength ) ? pdTRUE : pdFALSE;
+            }
+            else
+            {
+                if( xLength > ( socketsconfigSEND_COALESCE_BUFFER_LENGTH - pxContext->xCoalesceLength ) )
+                {
+                    xLength = socketsconfigSEND_COALESCE_BUFFER_LENGTH - pxContext->xCoalesceLength;
+                }
+
+                if( 0U == pxContext->xCoalesceLength )
+                {
+                    pxContext->xCoalesceStart = xTaskGetTickCount();
+                }
+
+                memcpy( &pxContext->pucCoalesceBuffer[ pxContext->xCoalesceLength ], &pucData[ xOffset ], xLength );
+                pxContext->xCoalesceLength += xLength;
+                xOffset += xLength;
+                xAccepted += xLength;
+
+                /* A full buffer is a full record. */
+                if( socketsconfigSEND_COALESCE_BUFFER_LENGTH == pxContext->xCoalesceLength )
+                {
+                    lStatus = prvCoalesceFlush( pxContext );
+                    xContinue = ( SOCKETS_ERROR_NONE == lStatus ) ? pdTRUE : pdFALSE;
+                }
+            }
+        }
+    }
+
+    if( 0U != xAccepted )
+    {
+        lStatus = ( int32_t ) xAccepted;
+    }
+
+    return lStatus;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Sends the buffers through the coalescing buffer, then sends what is
+ * held unless the coalescing window is open.
+ */
+static int32_t prvSendCoalesced( SSOCKETContextPtr_t pxContext,
+                                 const SocketsIovec_t * pxVectors,
+                                 size_t xVectorCount )
+{
+    int32_t lStatus = SOCKETS_ERROR_NONE;
+
+    /* The buffer is created by the first SOCKETS_SendV(), unless the
+     * coalescing window was set before. */
+    if( NULL == pxContext->xCoalesceMutex )
+    {
+        if( NULL == ( pxContext->pucCoalesceBuffer = pvPortMalloc( socketsconfigSEND_COALESCE_BUFFER_LENGTH ) ) )
+        {
+            lStatus = SOCKETS_ENOMEM;
+        }
+        else if( NULL == ( pxContext->xCoalesceMutex = xSemaphoreCreateMutex() ) )
+        {
+            vPortFree( pxContext->pucCoalesceBuffer );
+            pxContext->pucCoalesceBuffer = NULL;
+            lStatus = SOCKETS_ENOMEM;
+        }
+    }
+
+    if( SOCKETS_ERROR_NONE == lStatus )
+    {
+        ( void ) xSemaphoreTake( pxContext->xCoalesceMutex, portMAX_DELAY );
+
+        /* Data that was reported sent but then failed to go out. */
+        lStatus = prvCoalesceTakeError( pxContext );
+
+        /* Data held past the window goes first. */
+        if( ( SOCKETS_ERROR_NONE == lStatus ) && ( pdTRUE == prvCoalesceExpired( pxContext ) ) )
+        {
+            lStatus = prvCoalesceFlush( pxContext );
+        }
+
+        if( SOCKETS_ERROR_NONE == lStatus )
+        {
+            lStatus = prvCoalesceVectors( pxContext, pxVectors, xVectorCount );
+        }
+
+        if( 0U == pxContext->xCoalesceWindow )
+        {
+            /* Data that cannot be sent now goes with the next call. */
+            prvCoalesceFlushDeferred( pxContext );
+        }
+
+        ( void ) xSemaphoreGive( pxContext->xCoalesceMutex );
+    }
+
+    return lStatus;
+}
+/*-----------------------------------------------------------*/
+
 /*
  * Interface routines.
  */
 
+/*
+ * @brief Creates the TLS context of a socket that requires TLS.
+ */
+static int32_t prvInitTLS( SSOCKETContextPtr_t pxContext )
+{
+    TLSParams_t xTLSParams = { 0 };
+
+    xTLSParams.ulSize = sizeof( xTLSParams );
+    xTLSParams.pcDestination = pxContext->pcDestination;
+    xTLSParams.pcServerCertificate = pxContext->pcServerCertificate;
+    xTLSParams.ulServerCertificateLength = pxContext->ulServerCertificateLength;
+    xTLSParams.ppcAlpnProtocols = ( const char ** ) pxContext->ppcAlpnProtocols;
+    xTLSParams.ulAlpnProtocolsCount = pxContext->ulAlpnProtocolsCount;
+    xTLSParams.pvCallerContext = pxContext;
+    xTLSParams.pxNetworkRecv = prvNetworkRecv;
+    xTLSParams.pxNetworkSend = prvNetworkSend;
+
+    return TLS_Init( &pxContext->pvTLSContext, &xTLSParams );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Converts the address passed to SOCKETS_Connect() for FreeRTOS+TCP.
+ */
+static void prvConvertAddress( const SocketsSockaddr_t * pxAddress,
+                               struct freertos_sockaddr * pxTempAddress )
+{
+    pxTempAddress->sin_addr = pxAddress->ulAddress;
+    pxTempAddress->sin_family = pxAddress->ucSocketDomain;
+    pxTempAddress->sin_len = ( uint8_t ) sizeof( *pxTempAddress );
+    pxTempAddress->sin_port = pxAddress->usPort;
+}
+/*-----------------------------------------------------------*/
+
 int32_t SOCKETS_Close( Socket_t xSocket )
 {
     SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
     uint32_t ulProtocol;
-    int32_t lReturn;
+    int32_t lReturn = SOCKETS_ERROR_NONE;
 
     if( ( xSocket != SOCKETS_INVALID_SOCKET ) && ( NULL != pxContext ) )
     {
+        /* Send held data and clean-up the coalescing buffer. The socket is
+         * closed anyway, but data that was reported sent and could not be
+         * sent is reported. */
+        if( NULL != pxContext->xCoalesceMutex )
+        {
+            ( void ) xSemaphoreTake( pxContext->xCoalesceMutex, portMAX_DELAY );
+            prvCoalesceFlushDeferred( pxContext );
+            lReturn = prvCoalesceTakeError( pxContext );
+
+            if( ( SOCKETS_ERROR_NONE == lReturn ) && ( 0U != pxContext->xCoalesceLength ) )
+            {
+                lReturn = SOCKETS_SOCKET_ERROR;
+            }
+
+            vSemaphoreDelete( pxContext->xCoalesceMutex );
+            vPortFree( pxContext->pucCoalesceBuffer );
+        }
+
         /* Clean-up destination string. */
         if( NULL != pxContext->pcDestination )
         {
@@ -132,7 +449,6 @@ int32_t SOCKETS_Close( Socket_t xSocket )
 
         /* Free the context. */
         vPortFree( pxContext );
-        lReturn = SOCKETS_ERROR_NONE;
     }
     else
     {
@@ -149,7 +465,6 @@ int32_t SOCKETS_Connect( Socket_t xSocket,
 {
     int32_t lStatus = SOCKETS_ERROR_NONE;
     SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
-    TLSParams_t xTLSParams = { 0 };
     struct freertos_sockaddr xTempAddress = { 0 };
 
     if( ( pxContext != SOCKETS_INVALID_SOCKET ) && ( pxAddress != NULL ) )
@@ -159,25 +474,13 @@ int32_t SOCKETS_Connect( Socket_t xSocket,
         pxContext->xConnectAttempted = pdTRUE;
 
         /* Connect the wrapped socket. */
-        xTempAddress.sin_addr = pxAddress->ulAddress;
-        xTempAddress.sin_family = pxAddress->ucSocketDomain;
-        xTempAddress.sin_len = ( uint8_t ) sizeof( xTempAddress );
-        xTempAddress.sin_port = pxAddress->usPort;
+        prvConvertAddress( pxAddress, &xTempAddress );
         lStatus = FreeRTOS_connect( pxContext->xSocket, &xTempAddress, xAddressLength );
 
         /* Negotiate TLS if requested. */
         if( ( SOCKETS_ERROR_NONE == lStatus ) && ( pdTRUE == pxContext->xRequireTLS ) )
         {
-            xTLSParams.ulSize = sizeof( xTLSParams );
-            xTLSParams.pcDestination = pxContext->pcDestination;
-            xTLSParams.pcServerCertificate = pxContext->pcServerCertificate;
-            xTLSParams.ulServerCertificateLength = pxContext->ulServerCertificateLength;
-            xTLSParams.ppcAlpnProtocols = ( const char ** ) pxContext->ppcAlpnProtocols;
-            xTLSParams.ulAlpnProtocolsCount = pxContext->ulAlpnProtocolsCount;
-            xTLSParams.pvCallerContext = pxContext;
-            xTLSParams.pxNetworkRecv = prvNetworkRecv;
-            xTLSParams.pxNetworkSend = prvNetworkSend;
-            lStatus = TLS_Init( &pxContext->pvTLSContext, &xTLSParams );
+            lStatus = prvInitTLS( pxContext );
 
             if( SOCKETS_ERROR_NONE == lStatus )
             {
@@ -199,6 +502,141 @@ int32_t SOCKETS_Connect( Socket_t xSocket,
 }
 /*-----------------------------------------------------------*/
 
+int32_t SOCKETS_ConnectStart( Socket_t xSocket,
+                              SocketsSockaddr_t * pxAddress,
+                              Socklen_t xAddressLength )
+{
+    int32_t lStatus = SOCKETS_ERROR_NONE;
+    SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
+    struct freertos_sockaddr xTempAddress = { 0 };
+    TickType_t xTimeout = 0;
+
+    if( ( pxContext != SOCKETS_INVALID_SOCKET ) && ( pxAddress != NULL ) )
+    {
+        /* As for SOCKETS_Connect(), the socket must be closed if this fails. */
+        pxContext->xConnectAttempted = pdTRUE;
+
+        /* Neither the connection nor the handshake may block the caller. */
+        ( void ) FreeRTOS_setsockopt( pxContext->xSocket, 0, FREERTOS_SO_RCVTIMEO, &xTimeout, sizeof( xTimeout ) );
+        ( void ) FreeRTOS_setsockopt( pxContext->xSocket, 0, FREERTOS_SO_SNDTIMEO, &xTimeout, sizeof( xTimeout ) );
+
+        prvConvertAddress( pxAddress, &xTempAddress );
+        lStatus = FreeRTOS_connect( pxContext->xSocket, &xTempAddress, xAddressLength );
+
+        if( -pdFREERTOS_ERRNO_EWOULDBLOCK == lStatus )
+        {
+            lStatus = SOCKETS_ERROR_NONE;
+        }
+
+        if( ( SOCKETS_ERROR_NONE == lStatus ) && ( pdTRUE == pxContext->xRequireTLS ) )
+        {
+            lStatus = prvInitTLS( pxContext );
+        }
+
+        if( SOCKETS_ERROR_NONE == lStatus )
+        {
+            pxContext->xConnectState = securesocketsCONNECT_TCP;
+            lStatus = SOCKETS_CONNECT_WANT_WRITE;
+        }
+    }
+    else
+    {
+        lStatus = SOCKETS_SOCKET_ERROR;
+    }
+
+    return lStatus;
+}
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_ConnectStep( Socket_t xSocket )
+{
+    int32_t lStatus = SOCKETS_ERROR_NONE;
+    SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
+    BaseType_t xState;
+
+    if( ( pxContext == SOCKETS_INVALID_SOCKET ) || ( pxContext == NULL ) ||
+        ( securesocketsCONNECT_NONE == pxContext->xConnectState ) )
+    {
+        lStatus = SOCKETS_EINVAL;
+    }
+    else if( securesocketsCONNECT_TCP == pxContext->xConnectState )
+    {
+        xState = FreeRTOS_connstatus( pxContext->xSocket );
+
+        if( pdTRUE == FreeRTOS_issocketconnected( pxContext->xSocket ) )
+        {
+            if( pdTRUE == pxContext->xRequireTLS )
+            {
+                if( 0 == TLS_ConnectStart( pxContext->pvTLSContext ) )
+                {
+                    pxContext->xConnectState = securesocketsCONNECT_TLS;
+                }
+                else
+                {
+                    pxContext->xConnectState = securesocketsCONNECT_NONE;
+                    lStatus = SOCKETS_TLS_HANDSHAKE_ERROR;
+                }
+            }
+            else
+            {
+                pxContext->xConnectState = securesocketsCONNECT_NONE;
+            }
+        }
+        else if( ( xState > ( BaseType_t ) eCLOSED ) && ( xState < ( BaseType_t ) eESTABLISHED ) )
+        {
+            /* Still waiting for the server. */
+            lStatus = SOCKETS_CONNECT_WANT_WRITE;
+        }
+        else
+        {
+            /* Refused or timed out. */
+            pxContext->xConnectState = securesocketsCONNECT_NONE;
+            lStatus = SOCKETS_ECLOSED;
+        }
+    }
+
+    if( ( SOCKETS_ERROR_NONE == lStatus ) &&
+        ( securesocketsCONNECT_TLS == pxContext->xConnectState ) )
+    {
+        lStatus = TLS_ConnectStep( pxContext->pvTLSContext );
+
+        if( TLS_HANDSHAKE_WANT_READ == lStatus )
+        {
+            lStatus = SOCKETS_CONNECT_WANT_READ;
+        }
+        else if( TLS_HANDSHAKE_WANT_WRITE == lStatus )
+        {
+            lStatus = SOCKETS_CONNECT_WANT_WRITE;
+        }
+        else
+        {
+            pxContext->xConnectState = securesocketsCONNECT_NONE;
+
+            if( lStatus < 0 )
+            {
+                lStatus = SOCKETS_TLS_HANDSHAKE_ERROR;
+            }
+        }
+    }
+
+    return lStatus;
+}
+/*-----------------------------------------------------------*/
+
+void * SOCKETS_GetTransportSocket( Socket_t xSocket )
+{
+    SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
+    void * pvSocket = NULL;
+
+    if( ( pxContext != SOCKETS_INVALID_SOCKET ) && ( pxContext != NULL ) )
+    {
+        pvSocket = pxContext->xSocket;
+    }
+
+    return pvSocket;
+}
+/*-----------------------------------------------------------*/
+
 uint32_t SOCKETS_GetHostByName( const char * pcHostName )
 {
     return FreeRTOS_gethostbyname( pcHostName );
@@ -218,7 +656,30 @@ int32_t SOCKETS_Recv( Socket_t xSocket,
     {
         pxContext->xRecvFlags = ( BaseType_t ) ulFlags;
 
-        if( pdTRUE == pxContext->xRequireTLS )
+        lStatus = SOCKETS_ERROR_NONE;
+
+        /* Data held for the whole window is sent before reading, as the
+         * peer may be waiting for it. If a send is in progress, that send
+         * deals with the held data. An earlier send of held data that failed
+         * is reported instead of reading. */
+        if( ( NULL != pxContext->xCoalesceMutex ) &&
+            ( pdTRUE == xSemaphoreTake( pxContext->xCoalesceMutex, 0 ) ) )
+        {
+            if( pdTRUE == prvCoalesceExpired( pxContext ) )
+            {
+                prvCoalesceFlushDeferred( pxContext );
+            }
+
+            lStatus = prvCoalesceTakeError( pxContext );
+
+            ( void ) xSemaphoreGive( pxContext->xCoalesceMutex );
+        }
+
+        if( SOCKETS_ERROR_NONE != lStatus )
+        {
+            /* Send error returned above. */
+        }
+        else if( pdTRUE == pxContext->xRequireTLS )
         {
             /* Receive through TLS pipe, if negotiated. */
             lStatus = TLS_Recv( pxContext->pvTLSContext, pvBuffer, xBufferLength );
@@ -245,13 +706,22 @@ int32_t SOCKETS_Send( Socket_t xSocket,
 {
     int32_t lStatus = SOCKETS_SOCKET_ERROR;
     SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
+    SocketsIovec_t xVector;
 
     if( ( xSocket != SOCKETS_INVALID_SOCKET ) &&
         ( pvBuffer != NULL ) )
     {
         pxContext->xSendFlags = ( BaseType_t ) ulFlags;
 
-        if( pdTRUE == pxContext->xRequireTLS )
+        if( NULL != pxContext->xCoalesceMutex )
+        {
+            /* Share a record with other small writes, and stay behind any
+             * data already held. */
+            xVector.pvBuffer = pvBuffer;
+            xVector.xLength = xDataLength;
+            lStatus = prvSendCoalesced( pxContext, &xVector, 1 );
+        }
+        else if( pdTRUE == pxContext->xRequireTLS )
         {
             /* Send through TLS pipe, if negotiated. */
             lStatus = TLS_Send( pxContext->pvTLSContext, pvBuffer, xDataLength );
@@ -271,6 +741,50 @@ int32_t SOCKETS_Send( Socket_t xSocket,
 }
 /*-----------------------------------------------------------*/
 
+int32_t SOCKETS_SendV( Socket_t xSocket,
+                       const SocketsIovec_t * pxVectors,
+                       size_t xVectorCount,
+                       uint32_t ulFlags )
+{
+    int32_t lStatus = SOCKETS_ERROR_NONE;
+    SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
+    size_t xVector;
+
+    if( ( xSocket != SOCKETS_INVALID_SOCKET ) &&
+        ( xSocket != NULL ) &&
+        ( pxVectors != NULL ) )
+    {
+        for( xVector = 0; xVector < xVectorCount; xVector++ )
+        {
+            if( ( NULL == pxVectors[ xVector ].pvBuffer ) && ( 0U != pxVectors[ xVector ].xLength ) )
+            {
+                lStatus = SOCKETS_EINVAL;
+            }
+        }
+
+        /* Held data must not be accepted for a socket that can never send
+         * it. */
+        if( ( SOCKETS_ERROR_NONE == lStatus ) &&
+            ( pdTRUE != FreeRTOS_issocketconnected( pxContext->xSocket ) ) )
+        {
+            lStatus = SOCKETS_ENOTCONN;
+        }
+
+        if( SOCKETS_ERROR_NONE == lStatus )
+        {
+            pxContext->xSendFlags = ( BaseType_t ) ulFlags;
+            lStatus = prvSendCoalesced( pxContext, pxVectors, xVectorCount );
+        }
+    }
+    else
+    {
+        lStatus = SOCKETS_EINVAL;
+    }
+
+    return lStatus;
+}
+/*-----------------------------------------------------------*/
+
 int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
                             int32_t lLevel,
                             int32_t lOptionName,
@@ -426,6 +940,41 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
 
                 break;
 
+            case SOCKETS_SO_SEND_COALESCE_WINDOW:
+                xTimeout = *( ( const TickType_t * ) pvOptionValue ); /*lint !e9087 pvOptionValue passed should be of TickType_t */
+
+                if( NULL == pxContext->xCoalesceMutex )
+                {
+                    if( NULL == ( pxContext->pucCoalesceBuffer =
+                                      ( uint8_t * ) pvPortMalloc( socketsconfigSEND_COALESCE_BUFFER_LENGTH ) ) )
+                    {
+                        lStatus = SOCKETS_ENOMEM;
+                    }
+                    else if( NULL == ( pxContext->xCoalesceMutex = xSemaphoreCreateMutex() ) )
+                    {
+                        vPortFree( pxContext->pucCoalesceBuffer );
+                        pxContext->pucCoalesceBuffer = NULL;
+                        lStatus = SOCKETS_ENOMEM;
+                    }
+                }
+
+                if( SOCKETS_ERROR_NONE == lStatus )
+                {
+                    ( void ) xSemaphoreTake( pxContext->xCoalesceMutex, portMAX_DELAY );
+                    pxContext->xCoalesceWindow = xTimeout;
+
+                    /* A zero window stops holding data, so send what is held. */
+                    if( 0U == xTimeout )
+                    {
+                        prvCoalesceFlushDeferred( pxContext );
+                        lStatus = prvCoalesceTakeError( pxContext );
+                    }
+
+                    ( void ) xSemaphoreGive( pxContext->xCoalesceMutex );
+                }
+
+                break;
+
             case SOCKETS_SO_RCVTIMEO:
             case SOCKETS_SO_SNDTIMEO:
                 /* Comply with Berkeley standard - a 0 timeout is wait forever. */
@@ -465,11 +1014,33 @@ int32_t SOCKETS_Shutdown( Socket_t xSocket,
                           uint32_t ulHow )
 {
     int32_t lReturn;
+    int32_t lFlushStatus = SOCKETS_ERROR_NONE;
     SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
 
     if( ( xSocket != SOCKETS_INVALID_SOCKET ) && ( xSocket != NULL ) )
     {
+        /* Held data is sent before the connection closes. */
+        if( NULL != pxContext->xCoalesceMutex )
+        {
+            ( void ) xSemaphoreTake( pxContext->xCoalesceMutex, portMAX_DELAY );
+            prvCoalesceFlushDeferred( pxContext );
+            lFlushStatus = prvCoalesceTakeError( pxContext );
+
+            if( ( SOCKETS_ERROR_NONE == lFlushStatus ) && ( 0U != pxContext->xCoalesceLength ) )
+            {
+                lFlushStatus = SOCKETS_SOCKET_ERROR;
+            }
+
+            ( void ) xSemaphoreGive( pxContext->xCoalesceMutex );
+        }
+
         lReturn = FreeRTOS_shutdown( pxContext->xSocket, ( BaseType_t ) ulHow );
+
+        /* Data that was reported sent and was not is the error to report. */
+        if( SOCKETS_ERROR_NONE != lFlushStatus )
+        {
+            lReturn = lFlushStatus;
+        }
     }
     else
     {
@@ -585,25 +1156,11 @@ static CK_RV prvSocketsGetCryptoSession( CK_SESSION_HANDLE * pxSession,
 
 uint32_t ulRand( void )
 {
-    CK_RV xResult = 0;
-    CK_SESSION_HANDLE xPkcs11Session = 0;
-    CK_FUNCTION_LIST_PTR pxPkcs11FunctionList = NULL;
     uint32_t ulRandomValue = 0;
 
-    xResult = prvSocketsGetCryptoSession( &xPkcs11Session,
-                                          &pxPkcs11FunctionList );
-
-    if( 0 == xResult )
-    {
-        /* Request a sequence of cryptographically random byte values using
-         * PKCS#11. */
-        xResult = pxPkcs11FunctionList->C_GenerateRandom( xPkcs11Session,
-                                                          ( CK_BYTE_PTR ) &ulRandomValue,
-                                                          sizeof( ulRandomValue ) );
-    }
-
-    /* Check if any of the API calls failed. */
-    if( 0 != xResult )
+    /* Request a sequence of cryptographically random byte values from the
+     * shared DRBG. */
+    if( 0 != CRYPTO_Random( NULL, ( unsigned char * ) &ulRandomValue, sizeof( ulRandomValue ) ) )
     {
         ulRandomValue = 0;
     }
@@ -639,9 +1196,7 @@ uint32_t ulApplicationGetNextSequenceNumber( uint32_t ulSourceAddress,
         if( 0 == ullKey )
         {
             /* One-time initialization, per boot, of the random seed. */
-            xResult = pxPkcs11FunctionList->C_GenerateRandom( xPkcs11Session,
-                                                              ( CK_BYTE_PTR ) &ullKey,
-                                                              sizeof( ullKey ) );
+            xResult = ( CK_RV ) CRYPTO_Random( NULL, ( unsigned char * ) &ullKey, sizeof( ullKey ) );
         }
     }
 
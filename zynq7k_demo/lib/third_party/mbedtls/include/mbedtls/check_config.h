@@ -562,6 +562,14 @@
 #error "Illegal protocol selection"
 #endif
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH) &&                      \
+    ( !defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH) ||                      \
+      defined(MBEDTLS_SSL_PROTO_DTLS) ||                                \
+      defined(MBEDTLS_SSL_RENEGOTIATION) ||                             \
+      defined(MBEDTLS_ZLIB_SUPPORT) )
+#error "MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH defined, but not all prerequisites"
+#endif
+
 #if defined(MBEDTLS_SSL_DTLS_HELLO_VERIFY) && !defined(MBEDTLS_SSL_PROTO_DTLS)
 #error "MBEDTLS_SSL_DTLS_HELLO_VERIFY  defined, but not all prerequisites"
 #endif
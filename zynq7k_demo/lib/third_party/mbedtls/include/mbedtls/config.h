@@ -350,7 +350,7 @@
 //#define MBEDTLS_AES_DECRYPT_ALT
 //#define MBEDTLS_ECDH_GEN_PUBLIC_ALT
 //#define MBEDTLS_ECDH_COMPUTE_SHARED_ALT
-//#define MBEDTLS_ECDSA_VERIFY_ALT
+#define MBEDTLS_ECDSA_VERIFY_ALT
 //#define MBEDTLS_ECDSA_SIGN_ALT
 //#define MBEDTLS_ECDSA_GENKEY_ALT
 
@@ -1270,6 +1270,31 @@
  */
 #define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
 
+/**
+ * \def MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+ *
+ * Size the record buffers of each SSL context for what the connection needs
+ * rather than always for MBEDTLS_SSL_IN_CONTENT_LEN and
+ * MBEDTLS_SSL_OUT_CONTENT_LEN.
+ *
+ * The input buffer starts out sized for the configured maximum fragment
+ * length and grows to full size only when a larger record arrives. The
+ * output buffer is full size during the handshake and sized for the maximum
+ * fragment length afterwards. Handshake messages that a server honouring a
+ * negotiated maximum fragment length splits across records are reassembled.
+ *
+ * Record buffers can be taken from a pool, see
+ * mbedtls_ssl_conf_buffer_alloc().
+ *
+ * Requires: MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+ *
+ * Not supported with MBEDTLS_SSL_PROTO_DTLS, MBEDTLS_SSL_RENEGOTIATION or
+ * MBEDTLS_ZLIB_SUPPORT.
+ *
+ * Comment this macro to allocate full-size record buffers.
+ */
+#define MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+
 /**
  * \def MBEDTLS_SSL_PROTO_SSL3
  *
@@ -1414,7 +1439,7 @@
  *
  * Comment this macro to disable support for SSL session tickets
  */
-//#define MBEDTLS_SSL_SESSION_TICKETS
+#define MBEDTLS_SSL_SESSION_TICKETS
 
 /**
  * \def MBEDTLS_SSL_EXPORT_KEYS
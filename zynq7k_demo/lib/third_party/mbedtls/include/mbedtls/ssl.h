@@ -847,6 +847,14 @@ struct mbedtls_ssl_config
     int (*f_set_cache)(void *, const mbedtls_ssl_session *);
     void *p_cache;                  /*!< context for cache callbacks        */
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    /** Callback to allocate a zeroed record buffer                         */
+    unsigned char *(*f_buf_alloc)(void *, size_t);
+    /** Callback to release a record buffer                                 */
+    void (*f_buf_free)(void *, unsigned char *, size_t);
+    void *p_buf;                    /*!< context for buffer callbacks       */
+#endif
+
 #if defined(MBEDTLS_SSL_SERVER_NAME_INDICATION)
     /** Callback for setting cert according to SNI extension                */
     int (*f_sni)(void *, mbedtls_ssl_context *, const unsigned char *, size_t);
@@ -1078,6 +1086,9 @@ struct mbedtls_ssl_context
      * Record layer (incoming data)
      */
     unsigned char *in_buf;      /*!< input buffer                     */
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    size_t in_buf_len;          /*!< length of input buffer           */
+#endif
     unsigned char *in_ctr;      /*!< 64-bit incoming message counter
                                      TLS: maintained by us
                                      DTLS: read from peer             */
@@ -1116,6 +1127,9 @@ struct mbedtls_ssl_context
      * Record layer (outgoing data)
      */
     unsigned char *out_buf;     /*!< output buffer                    */
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    size_t out_buf_len;         /*!< length of output buffer          */
+#endif
     unsigned char *out_ctr;     /*!< 64-bit outgoing message counter  */
     unsigned char *out_hdr;     /*!< start of record header           */
     unsigned char *out_len;     /*!< two-bytes message length field   */
@@ -2553,6 +2567,27 @@ void mbedtls_ssl_conf_cert_req_ca_list( mbedtls_ssl_config *conf,
 int mbedtls_ssl_conf_max_frag_len( mbedtls_ssl_config *conf, unsigned char mfl_code );
 #endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+/**
+ * \brief          Set the allocator of the record buffers
+ *                 (Default: mbedtls_calloc() and mbedtls_free())
+ *
+ * \note           The record buffers of a context are resized during its
+ *                 lifetime, see MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH.
+ *
+ * \param conf     SSL configuration
+ * \param f_alloc  Allocation callback: returns a zeroed buffer of the
+ *                 requested length, or NULL.
+ * \param f_free   Release callback: receives a buffer returned by f_alloc,
+ *                 already wiped, and the length it was allocated with.
+ * \param p_buf    Context for both callbacks
+ */
+void mbedtls_ssl_conf_buffer_alloc( mbedtls_ssl_config *conf,
+        unsigned char *(*f_alloc)(void *, size_t),
+        void (*f_free)(void *, unsigned char *, size_t),
+        void *p_buf );
+#endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+
 #if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
 /**
  * \brief          Activate negotiation of truncated HMAC
@@ -205,6 +205,12 @@
 #define MBEDTLS_SSL_OUT_BUFFER_LEN  \
     ( ( MBEDTLS_SSL_HEADER_LEN ) + ( MBEDTLS_SSL_OUT_PAYLOAD_LEN ) )
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+/* Length of a record buffer for records of up to content_len bytes */
+#define MBEDTLS_SSL_RECORD_BUFFER_LEN( content_len )  \
+    ( ( MBEDTLS_SSL_HEADER_LEN ) + ( MBEDTLS_SSL_PAYLOAD_OVERHEAD ) + ( content_len ) )
+#endif
+
 #ifdef MBEDTLS_ZLIB_SUPPORT
 /* Compression buffer holds both IN and OUT buffers, so should be size of the larger */
 #define MBEDTLS_SSL_COMPRESS_BUFFER_LEN (                               \
@@ -384,6 +390,15 @@ struct mbedtls_ssl_handshake_params
     unsigned int async_in_progress : 1; /*!< an asynchronous operation is in progress */
 #endif /* MBEDTLS_SSL_ASYNC_PRIVATE */
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    unsigned char *hs_reasm;            /*!< handshake message split
+                                             across records, being
+                                             reassembled              */
+    size_t hs_reasm_len;                /*!< bytes received so far    */
+    size_t hs_reasm_total;              /*!< total length, including
+                                             the handshake header     */
+#endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+
 #if defined(MBEDTLS_SSL_ASYNC_PRIVATE)
     /** Asynchronous operation context. This field is meant for use by the
      * asynchronous operation callbacks (mbedtls_ssl_config::f_async_sign_start,
@@ -2512,6 +2512,179 @@ static int ssl_resend_hello_request( mbedtls_ssl_context *ssl )
 #endif
 #endif /* MBEDTLS_SSL_SRV_C && MBEDTLS_SSL_RENEGOTIATION */
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+#define SSL_IN_BUF_LEN( ssl )   ( (ssl)->in_buf_len )
+#define SSL_OUT_BUF_LEN( ssl )  ( (ssl)->out_buf_len )
+
+/*
+ * Record buffer sizing
+ *
+ * The input buffer holds records of up to the configured maximum fragment
+ * length and grows to MBEDTLS_SSL_IN_BUFFER_LEN when a larger record arrives
+ * or a fragmented handshake message has been reassembled. The output buffer
+ * is full size while handshake messages, whose writers assume
+ * MBEDTLS_SSL_OUT_CONTENT_LEN, are written and holds records of up to the
+ * maximum fragment length once the handshake is over.
+ */
+static unsigned char *ssl_buffer_alloc( const mbedtls_ssl_config *conf,
+                                        size_t len )
+{
+    if( conf->f_buf_alloc != NULL )
+        return( conf->f_buf_alloc( conf->p_buf, len ) );
+
+    return( mbedtls_calloc( 1, len ) );
+}
+
+static void ssl_buffer_free( const mbedtls_ssl_config *conf,
+                             unsigned char *buf, size_t len )
+{
+    if( buf == NULL )
+        return;
+
+    mbedtls_platform_zeroize( buf, len );
+
+    if( conf->f_buf_free != NULL )
+        conf->f_buf_free( conf->p_buf, buf, len );
+    else
+        mbedtls_free( buf );
+}
+
+/* Length of the input buffer while no large record is held */
+static size_t ssl_in_buffer_idle_len( const mbedtls_ssl_context *ssl )
+{
+    size_t len = ssl_mfl_code_to_length( ssl->conf->mfl_code );
+
+    if( len > MBEDTLS_SSL_IN_CONTENT_LEN )
+        len = MBEDTLS_SSL_IN_CONTENT_LEN;
+
+    return( MBEDTLS_SSL_RECORD_BUFFER_LEN( len ) );
+}
+
+/* Length of the output buffer once the handshake is over */
+static size_t ssl_out_buffer_idle_len( const mbedtls_ssl_context *ssl )
+{
+    size_t len = mbedtls_ssl_get_max_frag_len( ssl );
+
+    if( len > MBEDTLS_SSL_OUT_CONTENT_LEN )
+        len = MBEDTLS_SSL_OUT_CONTENT_LEN;
+
+    return( MBEDTLS_SSL_RECORD_BUFFER_LEN( len ) );
+}
+
+/* Number of bytes at the start of the input buffer still in use */
+static size_t ssl_in_buffer_used( const mbedtls_ssl_context *ssl )
+{
+    const unsigned char *msg = ( ssl->in_offt != NULL ) ? ssl->in_offt
+                                                        : ssl->in_msg;
+    size_t used = (size_t)( ssl->in_hdr - ssl->in_buf ) + ssl->in_left;
+    size_t msg_end = (size_t)( msg - ssl->in_buf ) + ssl->in_msglen;
+
+    return( ( used > msg_end ) ? used : msg_end );
+}
+
+static void ssl_rebase_pointer( unsigned char **p,
+                                const unsigned char *old_buf,
+                                unsigned char *new_buf )
+{
+    if( *p != NULL )
+        *p = new_buf + ( *p - old_buf );
+}
+
+/*
+ * Move the input buffer to a new allocation of len bytes, keeping its
+ * contents and the record pointers into it. When shrinking, the caller
+ * makes sure that the contents fit.
+ */
+static int ssl_resize_in_buffer( mbedtls_ssl_context *ssl, size_t len )
+{
+    unsigned char *buf;
+
+    if( len == ssl->in_buf_len )
+        return( 0 );
+
+    if( ( buf = ssl_buffer_alloc( ssl->conf, len ) ) == NULL )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%u bytes) failed", (unsigned) len ) );
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+    }
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "input buffer: %u -> %u bytes",
+                                (unsigned) ssl->in_buf_len, (unsigned) len ) );
+
+    memcpy( buf, ssl->in_buf, ( len < ssl->in_buf_len ) ? len : ssl->in_buf_len );
+
+    ssl_rebase_pointer( &ssl->in_ctr, ssl->in_buf, buf );
+    ssl_rebase_pointer( &ssl->in_hdr, ssl->in_buf, buf );
+    ssl_rebase_pointer( &ssl->in_len, ssl->in_buf, buf );
+    ssl_rebase_pointer( &ssl->in_iv, ssl->in_buf, buf );
+    ssl_rebase_pointer( &ssl->in_msg, ssl->in_buf, buf );
+    ssl_rebase_pointer( &ssl->in_offt, ssl->in_buf, buf );
+
+    ssl_buffer_free( ssl->conf, ssl->in_buf, ssl->in_buf_len );
+    ssl->in_buf = buf;
+    ssl->in_buf_len = len;
+
+    return( 0 );
+}
+
+/*
+ * Same for the output buffer.
+ */
+static int ssl_resize_out_buffer( mbedtls_ssl_context *ssl, size_t len )
+{
+    unsigned char *buf;
+
+    if( len == ssl->out_buf_len )
+        return( 0 );
+
+    if( ( buf = ssl_buffer_alloc( ssl->conf, len ) ) == NULL )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%u bytes) failed", (unsigned) len ) );
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+    }
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "output buffer: %u -> %u bytes",
+                                (unsigned) ssl->out_buf_len, (unsigned) len ) );
+
+    memcpy( buf, ssl->out_buf, ( len < ssl->out_buf_len ) ? len : ssl->out_buf_len );
+
+    ssl_rebase_pointer( &ssl->out_ctr, ssl->out_buf, buf );
+    ssl_rebase_pointer( &ssl->out_hdr, ssl->out_buf, buf );
+    ssl_rebase_pointer( &ssl->out_len, ssl->out_buf, buf );
+    ssl_rebase_pointer( &ssl->out_iv, ssl->out_buf, buf );
+    ssl_rebase_pointer( &ssl->out_msg, ssl->out_buf, buf );
+
+    ssl_buffer_free( ssl->conf, ssl->out_buf, ssl->out_buf_len );
+    ssl->out_buf = buf;
+    ssl->out_buf_len = len;
+
+    return( 0 );
+}
+
+/*
+ * Return the record buffers to their idle lengths once the handshake is over
+ * and nothing larger is pending. Keeping a larger buffer is not an error.
+ */
+static void ssl_shrink_buffers( mbedtls_ssl_context *ssl )
+{
+    size_t len;
+
+    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        return;
+
+    len = ssl_in_buffer_idle_len( ssl );
+    if( ssl->in_buf_len > len && ssl_in_buffer_used( ssl ) <= len )
+        (void) ssl_resize_in_buffer( ssl, len );
+
+    len = ssl_out_buffer_idle_len( ssl );
+    if( ssl->out_buf_len > len && ssl->out_left == 0 )
+        (void) ssl_resize_out_buffer( ssl, len );
+}
+#else
+#define SSL_IN_BUF_LEN( ssl )   ( (size_t) MBEDTLS_SSL_IN_BUFFER_LEN )
+#define SSL_OUT_BUF_LEN( ssl )  ( (size_t) MBEDTLS_SSL_OUT_BUFFER_LEN )
+#endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+
 /*
  * Fill the input message buffer by appending data to it.
  * The amount of data already fetched is in ssl->in_left.
@@ -2541,7 +2714,17 @@ int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
     }
 
-    if( nb_want > MBEDTLS_SSL_IN_BUFFER_LEN - (size_t)( ssl->in_hdr - ssl->in_buf ) )
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    /* Make room for a record larger than the current input buffer */
+    if( nb_want > ssl->in_buf_len - (size_t)( ssl->in_hdr - ssl->in_buf ) &&
+        nb_want <= MBEDTLS_SSL_IN_BUFFER_LEN - (size_t)( ssl->in_hdr - ssl->in_buf ) )
+    {
+        if( ( ret = ssl_resize_in_buffer( ssl, MBEDTLS_SSL_IN_BUFFER_LEN ) ) != 0 )
+            return( ret );
+    }
+#endif
+
+    if( nb_want > SSL_IN_BUF_LEN( ssl ) - (size_t)( ssl->in_hdr - ssl->in_buf ) )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "requesting more data than fits" ) );
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
@@ -3607,8 +3790,116 @@ static uint32_t ssl_get_hs_total_len( mbedtls_ssl_context const *ssl )
               ssl->in_msg[3] );
 }
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+static void ssl_free_hs_reassembly( mbedtls_ssl_handshake_params *hs )
+{
+    mbedtls_free( hs->hs_reasm );
+    hs->hs_reasm = NULL;
+    hs->hs_reasm_len = 0;
+    hs->hs_reasm_total = 0;
+}
+
+/*
+ * Keep the first fragment of a TLS handshake message that continues in the
+ * next records. The current record is dropped.
+ */
+static int ssl_start_hs_reassembly( mbedtls_ssl_context *ssl )
+{
+    mbedtls_ssl_handshake_params * const hs = ssl->handshake;
+
+    if( hs == NULL ||
+        ssl->in_hslen > MBEDTLS_SSL_IN_BUFFER_LEN
+                        - (size_t)( ssl->in_msg - ssl->in_buf ) )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "cannot reassemble handshake message of %u bytes",
+                                    (unsigned) ssl->in_hslen ) );
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+    }
+
+    hs->hs_reasm = mbedtls_calloc( 1, ssl->in_hslen );
+    if( hs->hs_reasm == NULL )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%u bytes) failed", (unsigned) ssl->in_hslen ) );
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+    }
+
+    memcpy( hs->hs_reasm, ssl->in_msg, ssl->in_msglen );
+    hs->hs_reasm_len = ssl->in_msglen;
+    hs->hs_reasm_total = ssl->in_hslen;
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "reassembling handshake message: %u of %u bytes",
+                                (unsigned) hs->hs_reasm_len,
+                                (unsigned) hs->hs_reasm_total ) );
+
+    return( MBEDTLS_ERR_SSL_CONTINUE_PROCESSING );
+}
+
+/*
+ * Append the current record to the handshake message being reassembled.
+ * Once it is complete, the message replaces its last fragment at in_msg,
+ * followed by whatever else the record holds.
+ */
+static int ssl_continue_hs_reassembly( mbedtls_ssl_context *ssl )
+{
+    int ret;
+    mbedtls_ssl_handshake_params * const hs = ssl->handshake;
+    const size_t offset = (size_t)( ssl->in_msg - ssl->in_buf );
+    size_t n = hs->hs_reasm_total - hs->hs_reasm_len;
+    size_t rest;
+
+    if( n > ssl->in_msglen )
+        n = ssl->in_msglen;
+
+    memcpy( hs->hs_reasm + hs->hs_reasm_len, ssl->in_msg, n );
+    hs->hs_reasm_len += n;
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "reassembling handshake message: %u of %u bytes",
+                                (unsigned) hs->hs_reasm_len,
+                                (unsigned) hs->hs_reasm_total ) );
+
+    if( hs->hs_reasm_len < hs->hs_reasm_total )
+    {
+        /* Have ssl_consume_current_message() drop the whole record */
+        ssl->in_hslen = ssl->in_msglen;
+        return( MBEDTLS_ERR_SSL_CONTINUE_PROCESSING );
+    }
+
+    rest = ssl->in_msglen - n;
+
+    if( hs->hs_reasm_total + rest > MBEDTLS_SSL_IN_BUFFER_LEN - offset )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "reassembled handshake message does not fit" ) );
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+    }
+
+    if( hs->hs_reasm_total + rest > ssl->in_buf_len - offset &&
+        ( ret = ssl_resize_in_buffer( ssl, MBEDTLS_SSL_IN_BUFFER_LEN ) ) != 0 )
+    {
+        return( ret );
+    }
+
+    memmove( ssl->in_msg + hs->hs_reasm_total, ssl->in_msg + n, rest );
+    memcpy( ssl->in_msg, hs->hs_reasm, hs->hs_reasm_total );
+    ssl->in_msglen = hs->hs_reasm_total + rest;
+
+    ssl_free_hs_reassembly( hs );
+
+    return( 0 );
+}
+#endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+
 int mbedtls_ssl_prepare_handshake_record( mbedtls_ssl_context *ssl )
 {
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    if( ssl->handshake != NULL && ssl->handshake->hs_reasm != NULL )
+    {
+        int ret = ssl_continue_hs_reassembly( ssl );
+
+        if( ret != 0 )
+            return( ret );
+    }
+#endif
+
     if( ssl->in_msglen < mbedtls_ssl_hs_hdr_len( ssl ) )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "handshake message too short: %d",
@@ -3689,11 +3980,16 @@ int mbedtls_ssl_prepare_handshake_record( mbedtls_ssl_context *ssl )
     }
     else
 #endif /* MBEDTLS_SSL_PROTO_DTLS */
-    /* With TLS we don't handle fragmentation (for now) */
+    /* With TLS we don't handle fragmentation (for now), unless the record
+     * buffers are sized for a maximum fragment length */
     if( ssl->in_msglen < ssl->in_hslen )
     {
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+        return( ssl_start_hs_reassembly( ssl ) );
+#else
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "TLS handshake fragmentation not supported" ) );
         return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+#endif
     }
 
     return( 0 );
@@ -5107,6 +5403,16 @@ int mbedtls_ssl_handle_message_type( mbedtls_ssl_context *ssl )
 {
     int ret;
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    /* The fragments of a handshake message must be contiguous */
+    if( ssl->handshake != NULL && ssl->handshake->hs_reasm != NULL &&
+        ssl->in_msgtype != MBEDTLS_SSL_MSG_HANDSHAKE )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "record interleaved with handshake fragments" ) );
+        return( MBEDTLS_ERR_SSL_UNEXPECTED_MESSAGE );
+    }
+#endif
+
     /*
      * Handle particular types of records
      */
@@ -6825,18 +7131,28 @@ int mbedtls_ssl_setup( mbedtls_ssl_context *ssl,
     /* Set to NULL in case of an error condition */
     ssl->out_buf = NULL;
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    ssl->in_buf_len = ssl_in_buffer_idle_len( ssl );
+    ssl->in_buf = ssl_buffer_alloc( conf, ssl->in_buf_len );
+#else
     ssl->in_buf = mbedtls_calloc( 1, MBEDTLS_SSL_IN_BUFFER_LEN );
+#endif
     if( ssl->in_buf == NULL )
     {
-        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", MBEDTLS_SSL_IN_BUFFER_LEN) );
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", (int) SSL_IN_BUF_LEN( ssl ) ) );
         ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
         goto error;
     }
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    ssl->out_buf_len = MBEDTLS_SSL_OUT_BUFFER_LEN;
+    ssl->out_buf = ssl_buffer_alloc( conf, ssl->out_buf_len );
+#else
     ssl->out_buf = mbedtls_calloc( 1, MBEDTLS_SSL_OUT_BUFFER_LEN );
+#endif
     if( ssl->out_buf == NULL )
     {
-        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", MBEDTLS_SSL_OUT_BUFFER_LEN) );
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", (int) SSL_OUT_BUF_LEN( ssl ) ) );
         ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
         goto error;
     }
@@ -6849,8 +7165,16 @@ int mbedtls_ssl_setup( mbedtls_ssl_context *ssl,
     return( 0 );
 
 error:
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    ssl_buffer_free( conf, ssl->in_buf, ssl->in_buf_len );
+    ssl_buffer_free( conf, ssl->out_buf, ssl->out_buf_len );
+
+    ssl->in_buf_len = 0;
+    ssl->out_buf_len = 0;
+#else
     mbedtls_free( ssl->in_buf );
     mbedtls_free( ssl->out_buf );
+#endif
 
     ssl->conf = NULL;
 
@@ -6937,14 +7261,20 @@ static int ssl_session_reset_int( mbedtls_ssl_context *ssl, int partial )
     ssl->session_in = NULL;
     ssl->session_out = NULL;
 
-    memset( ssl->out_buf, 0, MBEDTLS_SSL_OUT_BUFFER_LEN );
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    /* The next handshake writes into a full-size output buffer */
+    if( ( ret = ssl_resize_out_buffer( ssl, MBEDTLS_SSL_OUT_BUFFER_LEN ) ) != 0 )
+        return( ret );
+#endif
+
+    memset( ssl->out_buf, 0, SSL_OUT_BUF_LEN( ssl ) );
 
 #if defined(MBEDTLS_SSL_DTLS_CLIENT_PORT_REUSE) && defined(MBEDTLS_SSL_SRV_C)
     if( partial == 0 )
 #endif /* MBEDTLS_SSL_DTLS_CLIENT_PORT_REUSE && MBEDTLS_SSL_SRV_C */
     {
         ssl->in_left = 0;
-        memset( ssl->in_buf, 0, MBEDTLS_SSL_IN_BUFFER_LEN );
+        memset( ssl->in_buf, 0, SSL_IN_BUF_LEN( ssl ) );
     }
 
 #if defined(MBEDTLS_SSL_HW_RECORD_ACCEL)
@@ -7599,6 +7929,18 @@ int mbedtls_ssl_conf_max_frag_len( mbedtls_ssl_config *conf, unsigned char mfl_c
 }
 #endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+void mbedtls_ssl_conf_buffer_alloc( mbedtls_ssl_config *conf,
+        unsigned char *(*f_alloc)(void *, size_t),
+        void (*f_free)(void *, unsigned char *, size_t),
+        void *p_buf )
+{
+    conf->f_buf_alloc = f_alloc;
+    conf->f_buf_free  = f_free;
+    conf->p_buf       = p_buf;
+}
+#endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+
 #if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
 void mbedtls_ssl_conf_truncated_hmac( mbedtls_ssl_config *conf, int truncate )
 {
@@ -8037,6 +8379,11 @@ int mbedtls_ssl_handshake( mbedtls_ssl_context *ssl )
             break;
     }
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    if( ret == 0 )
+        ssl_shrink_buffers( ssl );
+#endif
+
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= handshake" ) );
 
     return( ret );
@@ -8494,6 +8841,11 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
         /* all bytes consumed */
         ssl->in_offt = NULL;
         ssl->keep_current_message = 0;
+
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+        /* Give back the room taken by a large record */
+        ssl_shrink_buffers( ssl );
+#endif
     }
     else
     {
@@ -8840,6 +9192,10 @@ void mbedtls_ssl_handshake_free( mbedtls_ssl_context *ssl )
     ssl_buffering_free( ssl );
 #endif
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    ssl_free_hs_reassembly( handshake );
+#endif
+
     mbedtls_platform_zeroize( handshake,
                               sizeof( mbedtls_ssl_handshake_params ) );
 }
@@ -8874,6 +9230,13 @@ void mbedtls_ssl_free( mbedtls_ssl_context *ssl )
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> free" ) );
 
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    if( ssl->conf != NULL )
+    {
+        ssl_buffer_free( ssl->conf, ssl->out_buf, ssl->out_buf_len );
+        ssl_buffer_free( ssl->conf, ssl->in_buf, ssl->in_buf_len );
+    }
+#else
     if( ssl->out_buf != NULL )
     {
         mbedtls_platform_zeroize( ssl->out_buf, MBEDTLS_SSL_OUT_BUFFER_LEN );
@@ -8885,6 +9248,7 @@ void mbedtls_ssl_free( mbedtls_ssl_context *ssl )
         mbedtls_platform_zeroize( ssl->in_buf, MBEDTLS_SSL_IN_BUFFER_LEN );
         mbedtls_free( ssl->in_buf );
     }
+#endif
 
 #if defined(MBEDTLS_ZLIB_SUPPORT)
     if( ssl->compress_buf != NULL )
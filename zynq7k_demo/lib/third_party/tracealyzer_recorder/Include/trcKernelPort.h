@@ -17,6 +17,10 @@
  * interface. Any such modifications should be documented directly below
  * this comment block.  
  *
+ * Streaming mode: the receive macros test TRC_QUEUE_RECEIVE_NOT_PEEK rather
+ * than xJustPeeking, which FreeRTOS V10 no longer has. Define it as 1 in
+ * trcConfig.h for FreeRTOS V10.
+ *
  * Disclaimer
  * The RECORDER is being delivered to you AS IS and PERCEPIO makes no warranty
  * as to its use or performance. PERCEPIO does not and cannot warrant the 
@@ -1614,21 +1618,27 @@ BaseType_t MyWrapper(__a, __b, const BaseType_t xCopyPosition)
 			break; \
 	}
 
+/* FreeRTOS V10 peeks in xQueuePeek(), which has its own trace macros, so a
+receive is never a peek. */
+#ifndef TRC_QUEUE_RECEIVE_NOT_PEEK
+#define TRC_QUEUE_RECEIVE_NOT_PEEK (xJustPeeking == pdFALSE)
+#endif
+
 /* Called when a receive operation on a queue fails (timeout) */
 #undef traceQUEUE_RECEIVE_FAILED
 #define traceQUEUE_RECEIVE_FAILED( pxQueue ) \
 	switch (pxQueue->ucQueueType) \
 	{ \
 		case queueQUEUE_TYPE_BASE: \
-			prvTraceStoreEvent3(xJustPeeking == pdFALSE ? PSF_EVENT_QUEUE_RECEIVE_FAILED : PSF_EVENT_QUEUE_PEEK_FAILED, (uint32_t)pxQueue, xTicksToWait, pxQueue->uxMessagesWaiting); \
+			prvTraceStoreEvent3(TRC_QUEUE_RECEIVE_NOT_PEEK ? PSF_EVENT_QUEUE_RECEIVE_FAILED : PSF_EVENT_QUEUE_PEEK_FAILED, (uint32_t)pxQueue, xTicksToWait, pxQueue->uxMessagesWaiting); \
 			break; \
 		case queueQUEUE_TYPE_BINARY_SEMAPHORE: \
 		case queueQUEUE_TYPE_COUNTING_SEMAPHORE: \
-			prvTraceStoreEvent3(xJustPeeking == pdFALSE ? PSF_EVENT_SEMAPHORE_TAKE_FAILED : PSF_EVENT_SEMAPHORE_PEEK_FAILED, (uint32_t)pxQueue, xTicksToWait, pxQueue->uxMessagesWaiting); \
+			prvTraceStoreEvent3(TRC_QUEUE_RECEIVE_NOT_PEEK ? PSF_EVENT_SEMAPHORE_TAKE_FAILED : PSF_EVENT_SEMAPHORE_PEEK_FAILED, (uint32_t)pxQueue, xTicksToWait, pxQueue->uxMessagesWaiting); \
 			break; \
 		case queueQUEUE_TYPE_MUTEX: \
 		case queueQUEUE_TYPE_RECURSIVE_MUTEX: \
-			prvTraceStoreEvent2(xJustPeeking == pdFALSE ? PSF_EVENT_MUTEX_TAKE_FAILED : PSF_EVENT_MUTEX_PEEK_FAILED, (uint32_t)pxQueue, xTicksToWait); \
+			prvTraceStoreEvent2(TRC_QUEUE_RECEIVE_NOT_PEEK ? PSF_EVENT_MUTEX_TAKE_FAILED : PSF_EVENT_MUTEX_PEEK_FAILED, (uint32_t)pxQueue, xTicksToWait); \
 			break; \
 	}
 
@@ -1638,15 +1648,15 @@ BaseType_t MyWrapper(__a, __b, const BaseType_t xCopyPosition)
 	switch (pxQueue->ucQueueType) \
 	{ \
 		case queueQUEUE_TYPE_BASE: \
-			prvTraceStoreEvent3(xJustPeeking == pdFALSE ? PSF_EVENT_QUEUE_RECEIVE_BLOCK : PSF_EVENT_QUEUE_PEEK_BLOCK, (uint32_t)pxQueue, xTicksToWait, pxQueue->uxMessagesWaiting); \
+			prvTraceStoreEvent3(TRC_QUEUE_RECEIVE_NOT_PEEK ? PSF_EVENT_QUEUE_RECEIVE_BLOCK : PSF_EVENT_QUEUE_PEEK_BLOCK, (uint32_t)pxQueue, xTicksToWait, pxQueue->uxMessagesWaiting); \
 			break; \
 		case queueQUEUE_TYPE_BINARY_SEMAPHORE: \
 		case queueQUEUE_TYPE_COUNTING_SEMAPHORE: \
-			prvTraceStoreEvent3(xJustPeeking == pdFALSE ? PSF_EVENT_SEMAPHORE_TAKE_BLOCK : PSF_EVENT_SEMAPHORE_PEEK_BLOCK, (uint32_t)pxQueue, xTicksToWait, pxQueue->uxMessagesWaiting); \
+			prvTraceStoreEvent3(TRC_QUEUE_RECEIVE_NOT_PEEK ? PSF_EVENT_SEMAPHORE_TAKE_BLOCK : PSF_EVENT_SEMAPHORE_PEEK_BLOCK, (uint32_t)pxQueue, xTicksToWait, pxQueue->uxMessagesWaiting); \
 			break; \
 		case queueQUEUE_TYPE_MUTEX: \
 		case queueQUEUE_TYPE_RECURSIVE_MUTEX: \
-			prvTraceStoreEvent2(xJustPeeking == pdFALSE ? PSF_EVENT_MUTEX_TAKE_BLOCK : PSF_EVENT_MUTEX_PEEK_BLOCK, (uint32_t)pxQueue, xTicksToWait); \
+			prvTraceStoreEvent2(TRC_QUEUE_RECEIVE_NOT_PEEK ? PSF_EVENT_MUTEX_TAKE_BLOCK : PSF_EVENT_MUTEX_PEEK_BLOCK, (uint32_t)pxQueue, xTicksToWait); \
 			break; \
 	}
 		
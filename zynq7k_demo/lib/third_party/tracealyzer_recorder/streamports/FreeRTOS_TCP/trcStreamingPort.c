@@ -0,0 +1,213 @@
+/*******************************************************************************
+ * Trace Recorder Library for Tracealyzer v3.1.2
+ * Percepio AB, www.percepio.com
+ *
+ * trcStreamingPort.c
+ *
+ * Supporting functions for trace streaming, used by the "stream ports" 
+ * for reading and writing data to the interface.
+ * Existing ports can easily be modified to fit another setup, e.g., a 
+ * different TCP/IP stack, or to define your own stream port.
+ *
+  * Terms of Use
+ * This file is part of the trace recorder library (RECORDER), which is the 
+ * intellectual property of Percepio AB (PERCEPIO) and provided under a
+ * license as follows.
+ * The RECORDER may be used free of charge for the purpose of recording data
+ * intended for analysis in PERCEPIO products. It may not be used or modified
+ * for other purposes without explicit permission from PERCEPIO.
+ * You may distribute the RECORDER in its original source code form, assuming
+ * this text (terms of use, disclaimer, copyright notice) is unchanged. You are
+ * allowed to distribute the RECORDER with minor modifications intended for
+ * configuration or porting of the RECORDER, e.g., to allow using it on a 
+ * specific processor, processor family or with a specific communication
+ * interface. Any such modifications should be documented directly below
+ * this comment block.  
+ *
+ * Modified from the TCPIP (lwIP) stream port to use FreeRTOS+TCP sockets.
+ * The sockets are only created once the network is up, and a host that
+ * disconnects stops the recorder, so the next host to connect and start it
+ * receives the trace header and symbol table again.
+ *
+ * Disclaimer
+ * The RECORDER is being delivered to you AS IS and PERCEPIO makes no warranty
+ * as to its use or performance. PERCEPIO does not and cannot warrant the 
+ * performance or results you may obtain by using the RECORDER or documentation.
+ * PERCEPIO make no warranties, express or implied, as to noninfringement of
+ * third party rights, merchantability, or fitness for any particular purpose.
+ * In no event will PERCEPIO, its technology partners, or distributors be liable
+ * to you for any consequential, incidental or special damages, including any
+ * lost profits or lost savings, even if a representative of PERCEPIO has been
+ * advised of the possibility of such damages, or for any claim by any third
+ * party. Some jurisdictions do not allow the exclusion or limitation of
+ * incidental, consequential or special damages, or the exclusion of implied
+ * warranties or limitations on how long an implied warranty may last, so the
+ * above limitations may not apply to you.
+ *
+ * Tabs are used for indent in this file (1 tab = 4 spaces)
+ *
+ * Copyright Percepio AB, 2017.
+ * www.percepio.com
+ ******************************************************************************/
+
+#include "trcRecorder.h"
+
+#if (TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)  
+#if (TRC_USE_TRACEALYZER_RECORDER == 1)
+	
+/* TCP/IP includes */
+#include "task.h"
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+/* How long a send may wait for room in the socket's transmit buffer. The
+TzCtrl task sleeps rather than spins while the IP task drains it. */
+#define TRC_TCP_SEND_TIMEOUT pdMS_TO_TICKS(100)
+
+static Socket_t listenSocket = NULL, clientSocket = NULL;
+
+static void trcSocketClose(void)
+{
+	FreeRTOS_closesocket(clientSocket);
+	clientSocket = NULL;
+
+	/* Nothing can read the events recorded from now on, and the next host to
+	connect needs the header and symbol table, which are sent on start. */
+	vTraceStop();
+}
+
+int32_t trcSocketSend( void* data, int32_t size, int32_t* bytesWritten )
+{
+	BaseType_t result;
+
+	*bytesWritten = 0;
+
+	if (clientSocket == NULL)
+		return -1;
+
+	result = FreeRTOS_send(clientSocket, data, (size_t)size, 0);
+	if (result < 0)
+	{
+		/* -pdFREERTOS_ERRNO_ENOSPC is expected when the transmit buffer stayed
+		full for the whole timeout. */
+		if (result != -pdFREERTOS_ERRNO_ENOSPC)
+		{
+			trcSocketClose();
+			return -1;
+		}
+	}
+	else
+	{
+		*bytesWritten = (int32_t)result;
+	}
+
+	return 0;
+}
+
+int32_t trcSocketReceive( void* data, int32_t size, int32_t* bytesRead )
+{
+	BaseType_t result;
+
+	*bytesRead = 0;
+
+	if (clientSocket == NULL)
+		return -1;
+
+	/* Returns 0 when there is no data to receive. */
+	result = FreeRTOS_recv(clientSocket, data, (size_t)size, FREERTOS_MSG_DONTWAIT);
+	if (result < 0)
+	{
+		trcSocketClose();
+		return -1;
+	}
+
+	*bytesRead = (int32_t)result;
+
+	return 0;
+}
+
+int32_t trcSocketInitializeListener(void)
+{
+	struct freertos_sockaddr address;
+	static const TickType_t noTimeout = 0;
+	Socket_t sock;
+
+	if (listenSocket != NULL)
+		return 0;
+
+	/* The TzCtrl task starts polling before the IP task has brought the
+	network up. */
+	if (FreeRTOS_IsNetworkUp() == pdFALSE)
+		return -1;
+
+	sock = FreeRTOS_socket(FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP);
+	if (sock == FREERTOS_INVALID_SOCKET)
+		return -1;
+
+	/* Accept without blocking, the TzCtrl task polls. */
+	FreeRTOS_setsockopt(sock, 0, FREERTOS_SO_RCVTIMEO, &noTimeout, sizeof(noTimeout));
+
+	address.sin_port = FreeRTOS_htons(TRC_CFG_TCP_PORT);
+	address.sin_addr = 0;
+
+	if (FreeRTOS_bind(sock, &address, sizeof(address)) != 0 ||
+		FreeRTOS_listen(sock, 1) != 0)
+	{
+		FreeRTOS_closesocket(sock);
+		return -1;
+	}
+
+	listenSocket = sock;
+
+	return 0;
+}
+
+int32_t trcSocketAccept(void)
+{
+	struct freertos_sockaddr remote;
+	socklen_t remoteSize = sizeof(remote);
+	static const TickType_t noTimeout = 0;
+	static const TickType_t sendTimeout = TRC_TCP_SEND_TIMEOUT;
+	Socket_t sock;
+
+	if (listenSocket == NULL)
+		return -1;
+
+	if (clientSocket != NULL)
+		return 0;
+
+	sock = FreeRTOS_accept(listenSocket, &remote, &remoteSize);
+	if (sock == NULL)
+		return -1;	/* No host has connected yet */
+
+	if (sock == FREERTOS_INVALID_SOCKET)
+	{
+		FreeRTOS_closesocket(listenSocket);
+		listenSocket = NULL;
+		return -1;
+	}
+
+	FreeRTOS_setsockopt(sock, 0, FREERTOS_SO_RCVTIMEO, &noTimeout, sizeof(noTimeout));
+	FreeRTOS_setsockopt(sock, 0, FREERTOS_SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+	clientSocket = sock;
+
+	return 0;
+}
+/************** MODIFY THE ABOVE PART TO USE YOUR TPC/IP STACK ****************/
+
+int32_t trcTcpWrite(void* data, uint32_t size, int32_t *ptrBytesWritten)
+{
+    return trcSocketSend(data, size, ptrBytesWritten);
+}
+
+int32_t trcTcpRead(void* data, uint32_t size, int32_t *ptrBytesRead)
+{
+    trcSocketInitializeListener();
+        
+    trcSocketAccept();
+      
+    return trcSocketReceive(data, size, ptrBytesRead);
+}
+
+#endif /*(TRC_USE_TRACEALYZER_RECORDER == 1)*/
+#endif /*(TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING)*/
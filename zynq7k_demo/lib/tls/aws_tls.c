@@ -31,6 +31,7 @@
 #include "aws_pkcs11.h"
 #include "aws_pkcs11_config.h"
 #include "task.h"
+#include "semphr.h"
 #include "aws_clientcredential.h"
 #include "aws_default_root_certificates.h"
 
@@ -42,6 +43,7 @@
 #include "mbedtls/sha256.h"
 #include "mbedtls/pk.h"
 #include "mbedtls/pk_internal.h"
+#include "mbedtls/ssl_internal.h"
 #include "mbedtls/debug.h"
 #ifdef MBEDTLS_DEBUG_C
     #define tlsDEBUG_VERBOSE    4
@@ -52,6 +54,95 @@
 #include <time.h>
 #include <stdio.h>
 
+/**
+ * @brief Number of TLS sessions remembered for resumption.
+ *
+ * One session is kept per server name and client identity. Reconnecting to
+ * the same server offers the stored ticket or session ID, which lets the
+ * server skip the key exchange and the client skip the private key signature.
+ * Set to 0 to always perform a full handshake.
+ */
+#ifndef tlsconfigSESSION_CACHE_ENTRIES
+    #define tlsconfigSESSION_CACHE_ENTRIES    2
+#endif
+
+/**
+ * @brief Maximum age in seconds of a session offered for resumption.
+ *
+ * A shorter ticket lifetime hint sent by the server takes precedence.
+ */
+#ifndef tlsconfigSESSION_CACHE_LIFETIME_SECONDS
+    #define tlsconfigSESSION_CACHE_LIFETIME_SECONDS    86400UL
+#endif
+
+/**
+ * @brief Number of parsed server certificate chains kept for later connections.
+ *
+ * The default root certificates take one entry, each distinct custom server
+ * certificate passed in TLSParams_t takes another. Must be at least 1.
+ */
+#ifndef tlsconfigSERVER_CERTIFICATE_CACHE_ENTRIES
+    #define tlsconfigSERVER_CERTIFICATE_CACHE_ENTRIES    2
+#endif
+
+/**
+ * @brief Maximum fragment length negotiated with the server.
+ *
+ * One of the MBEDTLS_SSL_MAX_FRAG_LEN_* codes. Records sent are limited to
+ * this length, and so are records received if the server supports the
+ * extension. The record buffers of an established connection are sized for
+ * it. Set to MBEDTLS_SSL_MAX_FRAG_LEN_NONE to not negotiate.
+ */
+#ifndef tlsconfigMAX_FRAGMENT_LENGTH
+    #define tlsconfigMAX_FRAGMENT_LENGTH    MBEDTLS_SSL_MAX_FRAG_LEN_512
+#endif
+
+/**
+ * @brief Number of released full-size record buffers kept for reuse.
+ *
+ * Connections hold full-size record buffers during the handshake, and while
+ * a record longer than the fragment length is received. Pooled buffers are
+ * handed to the next connection instead of going back to the heap, at the
+ * cost of holding their memory while no connection needs them. Set to 0 to
+ * free them.
+ */
+#ifndef tlsconfigRECORD_BUFFER_POOL_ENTRIES
+    #define tlsconfigRECORD_BUFFER_POOL_ENTRIES    1
+#endif
+
+/**
+ * @brief Length of the digest that identifies a cached session.
+ */
+#define tlsSESSION_IDENTITY_LENGTH    32
+
+/**
+ * @brief Length of the digest that identifies a cached server certificate chain.
+ */
+#define tlsCERTIFICATE_DIGEST_LENGTH    32
+
+/**
+ * @brief Parsed certificate chain shared by TLS contexts.
+ *
+ * The cache holds one reference and each context that uses the chain holds
+ * another one. The chain is freed when the last reference is released.
+ *
+ * @param[in] xCertificates Parsed certificates.
+ * @param[in] ucDigest Digest of the PEM data of a server certificate chain.
+ * @param[in] xPrivateKey PKCS#11 handle of the key matching a client certificate.
+ * @param[in] xKeyAlgorithm Type of the key matching a client certificate.
+ * @param[in] xLastUsed Tick count at which the chain was last handed out.
+ * @param[in] uxReferences Number of references held.
+ */
+typedef struct TLSCertificateChain
+{
+    mbedtls_x509_crt xCertificates;
+    uint8_t ucDigest[ tlsCERTIFICATE_DIGEST_LENGTH ];
+    CK_OBJECT_HANDLE xPrivateKey;
+    mbedtls_pk_type_t xKeyAlgorithm;
+    TickType_t xLastUsed;
+    UBaseType_t uxReferences;
+} TLSCertificateChain_t;
+
 /**
  * @brief Internal context structure.
  *
@@ -62,10 +153,14 @@
  * @param[in] xNetworkSend Callback for sending data on an open TCP socket.
  * @param[in] pvCallerContext Opaque pointer provided by caller for above callbacks.
  * @param[out] xTLSCHandshakeSuccessful Indicates whether TLS handshake was successfully completed.
+ * @param[out] ucSessionIdentity Digest of the server name and credentials used to look up a cached session.
+ * @param[out] xSessionOffered Indicates whether a cached session was offered to the server.
  * @param[out] xMbedSslCtx Connection context for mbedTLS.
  * @param[out] xMbedSslConfig Configuration context for mbedTLS.
- * @param[out] xMbedX509CA Server certificate context for mbedTLS.
- * @param[out] xMbedX509Cli Client certificate context for mbedTLS.
+ * @param[out] pxServerCertificates Shared server certificate chain, held during the handshake.
+ * @param[out] pxClientCredential Shared client certificate chain, held during the handshake.
+ * @param[out] xRecordBufferBytes Size of the mbedTLS record buffers currently held.
+ * @param[out] xRecordBufferPeakBytes Largest size of the record buffers held at once.
  * @param[out] mbedPkAltCtx RSA crypto implementation context for mbedTLS.
  * @param[out] xP11FunctionList PKCS#11 function list structure.
  * @param[out] xP11Session PKCS#11 session context.
@@ -83,12 +178,17 @@ typedef struct TLSContext
     NetworkSend_t xNetworkSend;
     void * pvCallerContext;
     BaseType_t xTLSHandshakeSuccessful;
+    BaseType_t xHandshakeInProgress;
+    uint8_t ucSessionIdentity[ tlsSESSION_IDENTITY_LENGTH ];
+    BaseType_t xSessionOffered;
 
     /* mbedTLS. */
     mbedtls_ssl_context xMbedSslCtx;
     mbedtls_ssl_config xMbedSslConfig;
-    mbedtls_x509_crt xMbedX509CA;
-    mbedtls_x509_crt xMbedX509Cli;
+    TLSCertificateChain_t * pxServerCertificates;
+    TLSCertificateChain_t * pxClientCredential;
+    size_t xRecordBufferBytes;
+    size_t xRecordBufferPeakBytes;
     mbedtls_pk_context xMbedPkCtx;
     mbedtls_pk_info_t xMbedPkInfo;
 
@@ -98,6 +198,62 @@ typedef struct TLSContext
     CK_OBJECT_HANDLE xP11PrivateKey;
 } TLSContext_t;
 
+#if ( tlsconfigSESSION_CACHE_ENTRIES > 0 )
+
+    /**
+     * @brief Session cache entry.
+     *
+     * @param[in] ucIdentity Digest of the server name and credentials.
+     * @param[in] xTimeStored Tick count at which the full handshake completed.
+     * @param[in] xSession Negotiated session, including the ticket if any.
+     * @param[in] xInUse Indicates whether the entry holds a session.
+     */
+    typedef struct TLSSessionCacheEntry
+    {
+        uint8_t ucIdentity[ tlsSESSION_IDENTITY_LENGTH ];
+        TickType_t xTimeStored;
+        mbedtls_ssl_session xSession;
+        BaseType_t xInUse;
+    } TLSSessionCacheEntry_t;
+
+    /**
+     * @brief Sessions shared by all TLS contexts.
+     */
+    static TLSSessionCacheEntry_t xSessionCache[ tlsconfigSESSION_CACHE_ENTRIES ];
+#endif /* if ( tlsconfigSESSION_CACHE_ENTRIES > 0 ) */
+
+#if ( tlsconfigRECORD_BUFFER_POOL_ENTRIES > 0 ) && defined( MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH )
+
+    /**
+     * @brief Released full-size record buffers, wiped by mbedTLS.
+     */
+    static unsigned char * pucRecordBufferPool[ tlsconfigRECORD_BUFFER_POOL_ENTRIES ];
+    static size_t xRecordBufferPoolLengths[ tlsconfigRECORD_BUFFER_POOL_ENTRIES ];
+#endif
+
+/**
+ * @brief Server certificate chains shared by all TLS contexts.
+ */
+static TLSCertificateChain_t * pxServerCertificateCache[ tlsconfigSERVER_CERTIFICATE_CACHE_ENTRIES ];
+
+/**
+ * @brief Device certificate chain and key handle shared by all TLS contexts.
+ */
+static TLSCertificateChain_t * pxClientCredentialCache = NULL;
+
+/**
+ * @brief Mutex protecting the caches, created on first use.
+ */
+static SemaphoreHandle_t xCacheMutex = NULL;
+
+#if ( configUSE_TRACE_RECORDER == 1 )
+
+    /**
+     * @brief The trace recorder's user event channel for handshakes, registered
+     * on first use.
+     */
+    static traceString xTLSTraceChannel = NULL;
+#endif
 
 #define TLS_PRINT( X )    vLoggingPrintf X
 
@@ -144,8 +300,17 @@ static int prvNetworkSend( void * pvContext,
                            size_t xDataLength )
 {
     TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+    int lResult;
+
+    lResult = ( int ) pxCtx->xNetworkSend( pxCtx->pvCallerContext, pucData, xDataLength );
+
+    /* A non-blocking handshake resumes once the socket is writable. */
+    if( ( 0 == lResult ) && ( pdTRUE == pxCtx->xHandshakeInProgress ) )
+    {
+        lResult = MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
 
-    return ( int ) pxCtx->xNetworkSend( pxCtx->pvCallerContext, pucData, xDataLength );
+    return lResult;
 }
 
 /**
@@ -162,28 +327,383 @@ static int prvNetworkRecv( void * pvContext,
                            size_t xReceiveLength )
 {
     TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+    int lResult;
 
-    return ( int ) pxCtx->xNetworkRecv( pxCtx->pvCallerContext, pucReceiveBuffer, xReceiveLength );
+    lResult = ( int ) pxCtx->xNetworkRecv( pxCtx->pvCallerContext, pucReceiveBuffer, xReceiveLength );
+
+    /* A non-blocking handshake resumes once the socket is readable. Outside
+     * of it, mbedtls_ssl_read() reports no data as zero bytes read. */
+    if( ( 0 == lResult ) && ( pdTRUE == pxCtx->xHandshakeInProgress ) )
+    {
+        lResult = MBEDTLS_ERR_SSL_WANT_READ;
+    }
+
+    return lResult;
 }
 
+#ifdef MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+
+    /**
+     * @brief mbedTLS record buffer allocation callback.
+     *
+     * Full-size buffers are taken from the pool when one is available.
+     *
+     * @param[in] pvContext Caller context.
+     * @param[in] xLength Length of the buffer.
+     *
+     * @return A zeroed buffer, or NULL.
+     */
+    static unsigned char * prvRecordBufferAlloc( void * pvContext,
+                                                 size_t xLength )
+    {
+        TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+        unsigned char * pucBuffer = NULL;
+
+        #if ( tlsconfigRECORD_BUFFER_POOL_ENTRIES > 0 )
+            BaseType_t x;
+
+            taskENTER_CRITICAL();
+            {
+                for( x = 0; x < tlsconfigRECORD_BUFFER_POOL_ENTRIES; x++ )
+                {
+                    if( ( NULL != pucRecordBufferPool[ x ] ) &&
+                        ( xLength == xRecordBufferPoolLengths[ x ] ) )
+                    {
+                        pucBuffer = pucRecordBufferPool[ x ];
+                        pucRecordBufferPool[ x ] = NULL;
+                        break;
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
+        #endif /* if ( tlsconfigRECORD_BUFFER_POOL_ENTRIES > 0 ) */
+
+        if( NULL == pucBuffer )
+        {
+            pucBuffer = ( unsigned char * ) pvPortMalloc( xLength ); /*lint !e9079 Allow casting void* to other types. */
+
+            if( NULL != pucBuffer )
+            {
+                memset( pucBuffer, 0, xLength );
+            }
+        }
+
+        if( NULL != pucBuffer )
+        {
+            pxCtx->xRecordBufferBytes += xLength;
+
+            if( pxCtx->xRecordBufferBytes > pxCtx->xRecordBufferPeakBytes )
+            {
+                pxCtx->xRecordBufferPeakBytes = pxCtx->xRecordBufferBytes;
+            }
+        }
+
+        return pucBuffer;
+    }
+
+    /*-----------------------------------------------------------*/
+
+    /**
+     * @brief mbedTLS record buffer release callback.
+     *
+     * Full-size buffers go back to the pool while it has room.
+     *
+     * @param[in] pvContext Caller context.
+     * @param[in] pucBuffer Buffer returned by prvRecordBufferAlloc, already wiped.
+     * @param[in] xLength Length the buffer was allocated with.
+     */
+    static void prvRecordBufferFree( void * pvContext,
+                                     unsigned char * pucBuffer,
+                                     size_t xLength )
+    {
+        TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+        #if ( tlsconfigRECORD_BUFFER_POOL_ENTRIES > 0 )
+            BaseType_t x;
+        #endif
+
+        pxCtx->xRecordBufferBytes -= xLength;
+
+        #if ( tlsconfigRECORD_BUFFER_POOL_ENTRIES > 0 )
+            if( ( MBEDTLS_SSL_IN_BUFFER_LEN == xLength ) ||
+                ( MBEDTLS_SSL_OUT_BUFFER_LEN == xLength ) )
+            {
+                taskENTER_CRITICAL();
+                {
+                    for( x = 0; x < tlsconfigRECORD_BUFFER_POOL_ENTRIES; x++ )
+                    {
+                        if( NULL == pucRecordBufferPool[ x ] )
+                        {
+                            pucRecordBufferPool[ x ] = pucBuffer;
+                            xRecordBufferPoolLengths[ x ] = xLength;
+                            pucBuffer = NULL;
+                            break;
+                        }
+                    }
+                }
+                taskEXIT_CRITICAL();
+            }
+        #endif /* if ( tlsconfigRECORD_BUFFER_POOL_ENTRIES > 0 ) */
+
+        vPortFree( pucBuffer );
+    }
+
+#endif /* ifdef MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+
 /**
- * @brief Callback that wraps PKCS#11 for pseudo-random number generation.
+ * @brief Take the cache mutex, creating it on first use.
  *
- * @param[in] pvCtx Caller context.
- * @param[in] pucRandom Byte array to fill with random data.
- * @param[in] xRandomLength Length of byte array.
+ * @return pdTRUE if the caches may be accessed.
+ */
+static BaseType_t prvCacheLock( void )
+{
+    BaseType_t xResult = pdFALSE;
+
+    if( NULL == xCacheMutex )
+    {
+        /* Several tasks may connect for the first time simultaneously. */
+        vTaskSuspendAll();
+        {
+            if( NULL == xCacheMutex )
+            {
+                xCacheMutex = xSemaphoreCreateMutex();
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+
+    if( NULL != xCacheMutex )
+    {
+        xResult = xSemaphoreTake( xCacheMutex, portMAX_DELAY );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Allocate an empty certificate chain.
+ *
+ * @return The chain, holding one reference, or NULL if out of memory.
+ */
+static TLSCertificateChain_t * prvCertificateChainCreate( void )
+{
+    TLSCertificateChain_t * pxChain;
+
+    pxChain = ( TLSCertificateChain_t * ) pvPortMalloc( sizeof( TLSCertificateChain_t ) ); /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    if( NULL != pxChain )
+    {
+        memset( pxChain, 0, sizeof( TLSCertificateChain_t ) );
+        mbedtls_x509_crt_init( &pxChain->xCertificates );
+        pxChain->uxReferences = 1;
+    }
+
+    return pxChain;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Release a reference to a certificate chain. Must be called with the
+ * cache mutex held.
+ *
+ * @param[in] pxChain Certificate chain, may be NULL.
+ */
+static void prvCertificateChainRelease( TLSCertificateChain_t * pxChain )
+{
+    if( NULL != pxChain )
+    {
+        pxChain->uxReferences--;
+
+        if( 0 == pxChain->uxReferences )
+        {
+            mbedtls_x509_crt_free( &pxChain->xCertificates );
+            vPortFree( pxChain );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Release the certificate chains held by a context.
+ *
+ * @param[in] pxCtx Caller context.
+ */
+static void prvReleaseCredentials( TLSContext_t * pxCtx )
+{
+    if( ( ( NULL != pxCtx->pxServerCertificates ) ||
+          ( NULL != pxCtx->pxClientCredential ) ) &&
+        ( pdTRUE == prvCacheLock() ) )
+    {
+        prvCertificateChainRelease( pxCtx->pxServerCertificates );
+        prvCertificateChainRelease( pxCtx->pxClientCredential );
+        pxCtx->pxServerCertificates = NULL;
+        pxCtx->pxClientCredential = NULL;
+
+        ( void ) xSemaphoreGive( xCacheMutex );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Decode the root certificates: either the default or the override.
+ *
+ * @param[in] pxCtx Caller context.
+ * @param[out] pxCertificates Parsed certificate chain.
+ *
+ * @return Zero on success.
+ */
+static int prvParseServerCertificates( TLSContext_t * pxCtx,
+                                       mbedtls_x509_crt * pxCertificates )
+{
+    int xResult = 0;
+
+    if( NULL != pxCtx->pcServerCertificate )
+    {
+        xResult = mbedtls_x509_crt_parse( pxCertificates,
+                                          ( const unsigned char * ) pxCtx->pcServerCertificate,
+                                          pxCtx->ulServerCertificateLength );
+
+        if( 0 != xResult )
+        {
+            TLS_PRINT( ( "ERROR: Failed to parse custom server certificates %d \r\n", xResult ) );
+        }
+    }
+    else
+    {
+        xResult = mbedtls_x509_crt_parse( pxCertificates,
+                                          ( const unsigned char * ) tlsVERISIGN_ROOT_CERTIFICATE_PEM,
+                                          tlsVERISIGN_ROOT_CERTIFICATE_LENGTH );
+
+        if( 0 == xResult )
+        {
+            xResult = mbedtls_x509_crt_parse( pxCertificates,
+                                              ( const unsigned char * ) tlsATS1_ROOT_CERTIFICATE_PEM,
+                                              tlsATS1_ROOT_CERTIFICATE_LENGTH );
+            if ( 0 == xResult )
+            {
+                xResult = mbedtls_x509_crt_parse( pxCertificates,
+                                                  ( const unsigned char * ) tlsSTARFIELD_ROOT_CERTIFICATE_PEM,
+                                                  tlsSTARFIELD_ROOT_CERTIFICATE_LENGTH );
+            }
+        }
+
+        if( 0 != xResult )
+        {
+            /* Default root certificates should be in aws_default_root_certificate.h */
+            TLS_PRINT( ( "ERROR: Failed to parse default server certificates %d \r\n", xResult ) );
+        }
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get a reference to the parsed root certificates of a context.
+ *
+ * Custom root certificates are identified by their content, so callers may
+ * reuse their buffers. The default roots use an all-zero digest.
+ *
+ * @param[in] pxCtx Caller context.
  *
  * @return Zero on success.
  */
-static int prvGenerateRandomBytes( void * pvCtx,
-                                   unsigned char * pucRandom,
-                                   size_t xRandomLength )
+static int prvGetServerCertificates( TLSContext_t * pxCtx )
 {
-    TLSContext_t * pxCtx = ( TLSContext_t * ) pvCtx; /*lint !e9087 !e9079 Allow casting void* to other types. */
+    int xResult = 0;
+    uint8_t ucDigest[ tlsCERTIFICATE_DIGEST_LENGTH ] = { 0 };
+    TLSCertificateChain_t * pxChain = NULL;
+    BaseType_t x;
+    BaseType_t xSlot = 0;
+    TickType_t xNow = xTaskGetTickCount();
+
+    if( NULL != pxCtx->pcServerCertificate )
+    {
+        xResult = mbedtls_sha256_ret( ( const unsigned char * ) pxCtx->pcServerCertificate,
+                                      pxCtx->ulServerCertificateLength,
+                                      ucDigest,
+                                      0 );
+    }
+
+    if( ( 0 == xResult ) && ( pdTRUE != prvCacheLock() ) )
+    {
+        xResult = MBEDTLS_ERR_X509_ALLOC_FAILED;
+    }
+
+    if( 0 == xResult )
+    {
+        for( x = 0; x < tlsconfigSERVER_CERTIFICATE_CACHE_ENTRIES; x++ )
+        {
+            if( NULL == pxServerCertificateCache[ x ] )
+            {
+                xSlot = x;
+            }
+            else if( 0 == memcmp( pxServerCertificateCache[ x ]->ucDigest, ucDigest, sizeof( ucDigest ) ) )
+            {
+                pxChain = pxServerCertificateCache[ x ];
+                break;
+            }
+            else if( ( NULL != pxServerCertificateCache[ xSlot ] ) &&
+                     ( ( xNow - pxServerCertificateCache[ x ]->xLastUsed ) >
+                       ( xNow - pxServerCertificateCache[ xSlot ]->xLastUsed ) ) )
+            {
+                /* Replace the chain that was not used for the longest time. */
+                xSlot = x;
+            }
+            else
+            {
+                /* Keep the free or older entry. */
+            }
+        }
+
+        if( NULL == pxChain )
+        {
+            pxChain = prvCertificateChainCreate();
 
-    return ( int ) pxCtx->xP11FunctionList->C_GenerateRandom( pxCtx->xP11Session, pucRandom, xRandomLength );
+            if( NULL == pxChain )
+            {
+                xResult = MBEDTLS_ERR_X509_ALLOC_FAILED;
+            }
+            else
+            {
+                xResult = prvParseServerCertificates( pxCtx, &pxChain->xCertificates );
+            }
+
+            if( 0 == xResult )
+            {
+                /* Contexts still using the replaced chain keep it alive. */
+                prvCertificateChainRelease( pxServerCertificateCache[ xSlot ] );
+                memcpy( pxChain->ucDigest, ucDigest, sizeof( ucDigest ) );
+                pxServerCertificateCache[ xSlot ] = pxChain;
+            }
+            else
+            {
+                prvCertificateChainRelease( pxChain );
+                pxChain = NULL;
+            }
+        }
+
+        if( NULL != pxChain )
+        {
+            pxChain->uxReferences++;
+            pxChain->xLastUsed = xNow;
+            pxCtx->pxServerCertificates = pxChain;
+        }
+
+        ( void ) xSemaphoreGive( xCacheMutex );
+    }
+
+    return xResult;
 }
 
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Callback that enforces a worst-case expiration check on TLS server
  * certificates.
@@ -308,43 +828,31 @@ static int prvPrivateKeySigningCallback( void * pvContext,
 }
 
 /**
- * @brief Helper for setting up potentially hardware-based cryptographic context
- * for the client TLS certificate and private key.
+ * @brief Look up the device private key and certificate in PKCS#11 storage.
  *
- * @param Caller context.
+ * @param[in] pxCtx Caller context, with an open PKCS#11 session.
+ * @param[out] ppxCredential Parsed certificate chain and key handle, holding
+ * one reference.
  *
  * @return Zero on success.
  */
-static int prvInitializeClientCredential( TLSContext_t * pxCtx )
+static int prvLoadClientCredential( TLSContext_t * pxCtx,
+                                    TLSCertificateChain_t ** ppxCredential )
 {
     BaseType_t xResult = 0;
-    CK_SLOT_ID xSlotId = 0;
     CK_ULONG xCount = 1;
     CK_ATTRIBUTE xTemplate = { 0 };
     CK_OBJECT_HANDLE xCertObj = 0;
     CK_BYTE * pxCertificate = NULL;
-    mbedtls_pk_type_t xKeyAlgo = ( mbedtls_pk_type_t ) ~0;
     CK_KEY_TYPE xKeyType = ( CK_KEY_TYPE ) ~0;
+    TLSCertificateChain_t * pxCredential = NULL;
 
-    /* Initialize the mbed contexts. */
-    mbedtls_x509_crt_init( &pxCtx->xMbedX509Cli );
-
-    /* Get the default private key storage ID. */
-    if( CKR_OK == xResult )
-    {
-        xResult = ( BaseType_t ) pxCtx->xP11FunctionList->C_GetSlotList( CK_TRUE,
-                                                                         &xSlotId,
-                                                                         &xCount );
-    }
+    /* Allocate the shared chain. */
+    pxCredential = prvCertificateChainCreate();
 
-    /* Start a private session with the P#11 module. */
-    if( 0 == xResult )
+    if( NULL == pxCredential )
     {
-        xResult = ( BaseType_t ) pxCtx->xP11FunctionList->C_OpenSession( xSlotId,
-                                                                         CKF_SERIAL_SESSION,
-                                                                         NULL,
-                                                                         NULL,
-                                                                         &pxCtx->xP11Session );
+        xResult = ( BaseType_t ) CKR_HOST_MEMORY;
     }
 
     /* Get the handle of the device private key. */
@@ -361,7 +869,7 @@ static int prvInitializeClientCredential( TLSContext_t * pxCtx )
     if( 0 == xResult )
     {
         xResult = ( BaseType_t ) pxCtx->xP11FunctionList->C_FindObjects( pxCtx->xP11Session,
-                                                                         &pxCtx->xP11PrivateKey,
+                                                                         &pxCredential->xPrivateKey,
                                                                          1,
                                                                          &xCount );
     }
@@ -377,7 +885,7 @@ static int prvInitializeClientCredential( TLSContext_t * pxCtx )
         xTemplate.pValue = &xKeyType;
         xTemplate.ulValueLen = sizeof( CK_KEY_TYPE );
         xResult = pxCtx->xP11FunctionList->C_GetAttributeValue( pxCtx->xP11Session,
-                                                                pxCtx->xP11PrivateKey,
+                                                                pxCredential->xPrivateKey,
                                                                 &xTemplate,
                                                                 1 );
     }
@@ -387,11 +895,11 @@ static int prvInitializeClientCredential( TLSContext_t * pxCtx )
         switch( xKeyType )
         {
             case CKK_RSA:
-                xKeyAlgo = MBEDTLS_PK_RSA;
+                pxCredential->xKeyAlgorithm = MBEDTLS_PK_RSA;
                 break;
 
             case CKK_EC:
-                xKeyAlgo = MBEDTLS_PK_ECKEY;
+                pxCredential->xKeyAlgorithm = MBEDTLS_PK_ECKEY;
                 break;
 
             default:
@@ -400,15 +908,6 @@ static int prvInitializeClientCredential( TLSContext_t * pxCtx )
         }
     }
 
-    if( xResult == CKR_OK )
-    {
-        memcpy( &pxCtx->xMbedPkInfo, mbedtls_pk_info_from_type( xKeyAlgo ), sizeof( mbedtls_pk_info_t ) );
-
-        pxCtx->xMbedPkInfo.sign_func = prvPrivateKeySigningCallback;
-        pxCtx->xMbedPkCtx.pk_info = &pxCtx->xMbedPkInfo;
-        pxCtx->xMbedPkCtx.pk_ctx = pxCtx;
-    }
-
     if( 0 == xResult )
     {
         /* Enumerate the first client certificate. */
@@ -445,66 +944,394 @@ static int prvInitializeClientCredential( TLSContext_t * pxCtx )
                                                                                1 );
     }
 
-    if( 0 == xResult )
+    if( 0 == xResult )
+    {
+        /* Create a buffer for the certificate. */
+        pxCertificate = ( CK_BYTE_PTR ) pvPortMalloc( xTemplate.ulValueLen ); /*lint !e9079 Allow casting void* to other types. */
+
+        if( NULL == pxCertificate )
+        {
+            xResult = ( BaseType_t ) CKR_HOST_MEMORY;
+        }
+    }
+
+    if( 0 == xResult )
+    {
+        /* Export the certificate. */
+        xTemplate.pValue = pxCertificate;
+        xResult = ( BaseType_t ) pxCtx->xP11FunctionList->C_GetAttributeValue( pxCtx->xP11Session,
+                                                                               xCertObj,
+                                                                               &xTemplate,
+                                                                               1 );
+    }
+
+    /* Decode the client certificate. */
+    if( 0 == xResult )
+    {
+        xResult = mbedtls_x509_crt_parse( &pxCredential->xCertificates,
+                                          ( const unsigned char * ) pxCertificate,
+                                          xTemplate.ulValueLen );
+    }
+
+    /*
+     * Add a JITR device issuer certificate, if present.
+     */
+    if( ( 0 == xResult ) &&
+        ( NULL != clientcredentialJITR_DEVICE_CERTIFICATE_AUTHORITY_PEM ) )
+    {
+        /* Decode the JITR issuer. The device client certificate will get
+         * inserted as the first certificate in this chain below. */
+        xResult = mbedtls_x509_crt_parse(
+            &pxCredential->xCertificates,
+            ( const unsigned char * ) clientcredentialJITR_DEVICE_CERTIFICATE_AUTHORITY_PEM,
+            1 + strlen( clientcredentialJITR_DEVICE_CERTIFICATE_AUTHORITY_PEM ) );
+    }
+
+    if( NULL != pxCertificate )
+    {
+        vPortFree( pxCertificate );
+    }
+
+    if( 0 != xResult )
+    {
+        prvCertificateChainRelease( pxCredential );
+        pxCredential = NULL;
+    }
+
+    *ppxCredential = pxCredential;
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Helper for setting up potentially hardware-based cryptographic context
+ * for the client TLS certificate and private key.
+ *
+ * The certificate chain and the key handle are looked up once and shared by
+ * all later connections, until TLS_FlushCredentialCache() is called. Each
+ * context still opens its own PKCS#11 session for signing.
+ *
+ * @param Caller context.
+ *
+ * @return Zero on success.
+ */
+static int prvInitializeClientCredential( TLSContext_t * pxCtx )
+{
+    BaseType_t xResult = 0;
+    CK_SLOT_ID xSlotId = 0;
+    CK_ULONG xCount = 1;
+    TLSCertificateChain_t * pxCredential = NULL;
+
+    /* Get the default private key storage ID. */
+    if( CKR_OK == xResult )
+    {
+        xResult = ( BaseType_t ) pxCtx->xP11FunctionList->C_GetSlotList( CK_TRUE,
+                                                                         &xSlotId,
+                                                                         &xCount );
+    }
+
+    /* Start a private session with the P#11 module. */
+    if( 0 == xResult )
+    {
+        xResult = ( BaseType_t ) pxCtx->xP11FunctionList->C_OpenSession( xSlotId,
+                                                                         CKF_SERIAL_SESSION,
+                                                                         NULL,
+                                                                         NULL,
+                                                                         &pxCtx->xP11Session );
+    }
+
+    /* Use the credential found by an earlier connection, or find it now and
+     * keep it for the next ones. */
+    if( ( 0 == xResult ) && ( pdTRUE != prvCacheLock() ) )
+    {
+        xResult = ( BaseType_t ) CKR_HOST_MEMORY;
+    }
+
+    if( 0 == xResult )
+    {
+        pxCredential = pxClientCredentialCache;
+
+        if( NULL == pxCredential )
+        {
+            xResult = prvLoadClientCredential( pxCtx, &pxCredential );
+            pxClientCredentialCache = pxCredential;
+        }
+
+        if( NULL != pxCredential )
+        {
+            pxCredential->uxReferences++;
+            pxCtx->pxClientCredential = pxCredential;
+        }
+
+        ( void ) xSemaphoreGive( xCacheMutex );
+    }
+
+    if( 0 == xResult )
+    {
+        pxCtx->xP11PrivateKey = pxCredential->xPrivateKey;
+
+        memcpy( &pxCtx->xMbedPkInfo, mbedtls_pk_info_from_type( pxCredential->xKeyAlgorithm ), sizeof( mbedtls_pk_info_t ) );
+
+        pxCtx->xMbedPkInfo.sign_func = prvPrivateKeySigningCallback;
+        pxCtx->xMbedPkCtx.pk_info = &pxCtx->xMbedPkInfo;
+        pxCtx->xMbedPkCtx.pk_ctx = pxCtx;
+    }
+
+    /*
+     * Attach the client certificate and private key to the TLS configuration.
+     */
+    if( 0 == xResult )
+    {
+        xResult = mbedtls_ssl_conf_own_cert( &pxCtx->xMbedSslConfig,
+                                             &pxCredential->xCertificates,
+                                             &pxCtx->xMbedPkCtx );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( tlsconfigSESSION_CACHE_ENTRIES > 0 )
+
+    /**
+     * @brief Compute the key under which the session of a connection is cached.
+     *
+     * A session is only resumed for the same server name, client certificate and
+     * trusted server certificate, so re-provisioned credentials always lead to a
+     * full handshake.
+     *
+     * @param[in] pxCtx Caller context, with the client certificate parsed.
+     *
+     * @return Zero on success.
+     */
+    static int prvSessionIdentity( TLSContext_t * pxCtx )
+    {
+        int xResult = 0;
+        mbedtls_sha256_context xSha;
+
+        mbedtls_sha256_init( &xSha );
+
+        xResult = mbedtls_sha256_starts_ret( &xSha, 0 );
+
+        if( 0 == xResult )
+        {
+            xResult = mbedtls_sha256_update_ret( &xSha,
+                                                 ( const unsigned char * ) pxCtx->pcDestination,
+                                                 strlen( pxCtx->pcDestination ) + 1 );
+        }
+
+        if( 0 == xResult )
+        {
+            xResult = mbedtls_sha256_update_ret( &xSha,
+                                                 pxCtx->pxClientCredential->xCertificates.raw.p,
+                                                 pxCtx->pxClientCredential->xCertificates.raw.len );
+        }
+
+        if( ( 0 == xResult ) && ( NULL != pxCtx->pcServerCertificate ) )
+        {
+            xResult = mbedtls_sha256_update_ret( &xSha,
+                                                 ( const unsigned char * ) pxCtx->pcServerCertificate,
+                                                 pxCtx->ulServerCertificateLength );
+        }
+
+        if( 0 == xResult )
+        {
+            xResult = mbedtls_sha256_finish_ret( &xSha, pxCtx->ucSessionIdentity );
+        }
+
+        mbedtls_sha256_free( &xSha );
+
+        return xResult;
+    }
+
+    /*-----------------------------------------------------------*/
+
+    /**
+     * @brief Find the cache entry of a connection.
+     *
+     * @param[in] pxCtx Caller context.
+     *
+     * @return The entry, or NULL if the connection has no cached session.
+     */
+    static TLSSessionCacheEntry_t * prvSessionCacheFind( TLSContext_t * pxCtx )
     {
-        /* Create a buffer for the certificate. */
-        pxCertificate = ( CK_BYTE_PTR ) pvPortMalloc( xTemplate.ulValueLen ); /*lint !e9079 Allow casting void* to other types. */
+        TLSSessionCacheEntry_t * pxEntry = NULL;
+        BaseType_t x;
 
-        if( NULL == pxCertificate )
+        for( x = 0; x < tlsconfigSESSION_CACHE_ENTRIES; x++ )
         {
-            xResult = ( BaseType_t ) CKR_HOST_MEMORY;
+            if( ( pdFALSE != xSessionCache[ x ].xInUse ) &&
+                ( 0 == memcmp( xSessionCache[ x ].ucIdentity,
+                               pxCtx->ucSessionIdentity,
+                               tlsSESSION_IDENTITY_LENGTH ) ) )
+            {
+                pxEntry = &xSessionCache[ x ];
+                break;
+            }
         }
-    }
 
-    if( 0 == xResult )
-    {
-        /* Export the certificate. */
-        xTemplate.pValue = pxCertificate;
-        xResult = ( BaseType_t ) pxCtx->xP11FunctionList->C_GetAttributeValue( pxCtx->xP11Session,
-                                                                               xCertObj,
-                                                                               &xTemplate,
-                                                                               1 );
+        return pxEntry;
     }
 
-    /* Decode the client certificate. */
-    if( 0 == xResult )
+    /*-----------------------------------------------------------*/
+
+    /**
+     * @brief Release the session held by a cache entry.
+     *
+     * @param[in] pxEntry Cache entry.
+     */
+    static void prvSessionCacheFree( TLSSessionCacheEntry_t * pxEntry )
     {
-        xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509Cli,
-                                          ( const unsigned char * ) pxCertificate,
-                                          xTemplate.ulValueLen );
+        /* Also clears the master secret. */
+        mbedtls_ssl_session_free( &pxEntry->xSession );
+        pxEntry->xInUse = pdFALSE;
     }
 
-    /*
-     * Add a JITR device issuer certificate, if present.
+    /*-----------------------------------------------------------*/
+
+    /**
+     * @brief Offer the cached session, if any, in the next handshake.
+     *
+     * @param[in] pxCtx Caller context.
      */
-    if( ( 0 == xResult ) &&
-        ( NULL != clientcredentialJITR_DEVICE_CERTIFICATE_AUTHORITY_PEM ) )
+    static void prvSessionCacheLoad( TLSContext_t * pxCtx )
     {
-        /* Decode the JITR issuer. The device client certificate will get
-         * inserted as the first certificate in this chain below. */
-        xResult = mbedtls_x509_crt_parse(
-            &pxCtx->xMbedX509Cli,
-            ( const unsigned char * ) clientcredentialJITR_DEVICE_CERTIFICATE_AUTHORITY_PEM,
-            1 + strlen( clientcredentialJITR_DEVICE_CERTIFICATE_AUTHORITY_PEM ) );
+        TLSSessionCacheEntry_t * pxEntry;
+        uint32_t ulLifetime = tlsconfigSESSION_CACHE_LIFETIME_SECONDS;
+        uint32_t ulAge;
+
+        if( pdTRUE == prvCacheLock() )
+        {
+            pxEntry = prvSessionCacheFind( pxCtx );
+
+            if( NULL != pxEntry )
+            {
+                ulAge = ( uint32_t ) ( ( xTaskGetTickCount() - pxEntry->xTimeStored ) / configTICK_RATE_HZ );
+
+                #if defined( MBEDTLS_SSL_SESSION_TICKETS )
+                    if( ( NULL != pxEntry->xSession.ticket ) &&
+                        ( 0 != pxEntry->xSession.ticket_lifetime ) &&
+                        ( pxEntry->xSession.ticket_lifetime < ulLifetime ) )
+                    {
+                        ulLifetime = pxEntry->xSession.ticket_lifetime;
+                    }
+                #endif
+
+                if( ulAge >= ulLifetime )
+                {
+                    prvSessionCacheFree( pxEntry );
+                }
+                else if( 0 == mbedtls_ssl_set_session( &pxCtx->xMbedSslCtx, &pxEntry->xSession ) )
+                {
+                    pxCtx->xSessionOffered = pdTRUE;
+                }
+            }
+
+            ( void ) xSemaphoreGive( xCacheMutex );
+        }
     }
 
-    /*
-     * Attach the client certificate and private key to the TLS configuration.
+    /*-----------------------------------------------------------*/
+
+    /**
+     * @brief Remember the session of a completed handshake.
+     *
+     * @param[in] pxCtx Caller context.
      */
-    if( 0 == xResult )
+    static void prvSessionCacheStore( TLSContext_t * pxCtx )
     {
-        xResult = mbedtls_ssl_conf_own_cert( &pxCtx->xMbedSslConfig,
-                                             &pxCtx->xMbedX509Cli,
-                                             &pxCtx->xMbedPkCtx );
+        TLSSessionCacheEntry_t * pxEntry;
+        mbedtls_ssl_session xSession;
+        BaseType_t x;
+        BaseType_t xResumed = pdFALSE;
+        TickType_t xNow = xTaskGetTickCount();
+
+        mbedtls_ssl_session_init( &xSession );
+
+        if( ( 0 == mbedtls_ssl_get_session( &pxCtx->xMbedSslCtx, &xSession ) ) &&
+            ( pdTRUE == prvCacheLock() ) )
+        {
+            pxEntry = prvSessionCacheFind( pxCtx );
+
+            if( NULL != pxEntry )
+            {
+                /* An abbreviated handshake keeps the master secret. Keep the
+                 * time of the full handshake too, so that a session can't be
+                 * resumed forever; only the (possibly renewed) ticket changes. */
+                if( 0 == memcmp( pxEntry->xSession.master, xSession.master, sizeof( xSession.master ) ) )
+                {
+                    xResumed = pdTRUE;
+                    xNow = pxEntry->xTimeStored;
+                }
+            }
+            else
+            {
+                /* Use a free entry, or else replace the oldest session. */
+                pxEntry = &xSessionCache[ 0 ];
+
+                for( x = 0; x < tlsconfigSESSION_CACHE_ENTRIES; x++ )
+                {
+                    if( pdFALSE == xSessionCache[ x ].xInUse )
+                    {
+                        pxEntry = &xSessionCache[ x ];
+                        break;
+                    }
+
+                    if( ( xNow - xSessionCache[ x ].xTimeStored ) > ( xNow - pxEntry->xTimeStored ) )
+                    {
+                        pxEntry = &xSessionCache[ x ];
+                    }
+                }
+
+                memcpy( pxEntry->ucIdentity, pxCtx->ucSessionIdentity, tlsSESSION_IDENTITY_LENGTH );
+            }
+
+            if( pdFALSE != pxEntry->xInUse )
+            {
+                prvSessionCacheFree( pxEntry );
+            }
+
+            /* The entry takes over the buffers of the copy. */
+            memcpy( &pxEntry->xSession, &xSession, sizeof( xSession ) );
+            mbedtls_ssl_session_init( &xSession );
+            pxEntry->xTimeStored = xNow;
+            pxEntry->xInUse = pdTRUE;
+
+            ( void ) xSemaphoreGive( xCacheMutex );
+
+            TLS_PRINT( ( "TLS session %s \r\n", ( pdFALSE != xResumed ) ? "resumed" : "established" ) );
+        }
+
+        mbedtls_ssl_session_free( &xSession );
     }
 
-    if( NULL != pxCertificate )
+    /*-----------------------------------------------------------*/
+
+    /**
+     * @brief Forget the session of a connection, e.g. after it was refused.
+     *
+     * @param[in] pxCtx Caller context.
+     */
+    static void prvSessionCacheRemove( TLSContext_t * pxCtx )
     {
-        vPortFree( pxCertificate );
-    }
+        TLSSessionCacheEntry_t * pxEntry;
 
-    return xResult;
-}
+        if( pdTRUE == prvCacheLock() )
+        {
+            pxEntry = prvSessionCacheFind( pxCtx );
+
+            if( NULL != pxEntry )
+            {
+                prvSessionCacheFree( pxEntry );
+            }
+
+            ( void ) xSemaphoreGive( xCacheMutex );
+        }
+    }
+#endif /* if ( tlsconfigSESSION_CACHE_ENTRIES > 0 ) */
 
 /*
  * Interface routines.
@@ -580,56 +1407,38 @@ BaseType_t TLS_Init( void ** ppvContext,
 
 /*-----------------------------------------------------------*/
 
-BaseType_t TLS_Connect( void * pvContext )
+/**
+ * @brief Configures mbedTLS for a handshake with the server.
+ *
+ * @param[in] pxCtx Caller context.
+ *
+ * @return Zero on success.
+ */
+static BaseType_t prvHandshakeSetup( TLSContext_t * pxCtx )
 {
     BaseType_t xResult = 0;
-    TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
 
     /* Ensure that the FreeRTOS heap is used. */
     CRYPTO_ConfigureHeap();
 
-    /* Initialize mbedTLS structures. */
-    mbedtls_ssl_init( &pxCtx->xMbedSslCtx );
-    mbedtls_ssl_config_init( &pxCtx->xMbedSslConfig );
-    mbedtls_x509_crt_init( &pxCtx->xMbedX509CA );
-
-    /* Decode the root certificate: either the default or the override. */
-    if( NULL != pxCtx->pcServerCertificate )
-    {
-        xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509CA,
-                                          ( const unsigned char * ) pxCtx->pcServerCertificate,
-                                          pxCtx->ulServerCertificateLength );
-
-        if( 0 != xResult )
+    #if ( configUSE_TRACE_RECORDER == 1 )
+        if( NULL == xTLSTraceChannel )
         {
-            TLS_PRINT( ( "ERROR: Failed to parse custom server certificates %d \r\n", xResult ) );
+            xTLSTraceChannel = xTraceRegisterString( "TLS" );
         }
-    }
-    else
-    {
-        xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509CA,
-                                          ( const unsigned char * ) tlsVERISIGN_ROOT_CERTIFICATE_PEM,
-                                          tlsVERISIGN_ROOT_CERTIFICATE_LENGTH );
 
-        if( 0 == xResult )
-        {
-            xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509CA,
-                                              ( const unsigned char * ) tlsATS1_ROOT_CERTIFICATE_PEM,
-                                              tlsATS1_ROOT_CERTIFICATE_LENGTH );
-            if ( 0 == xResult )
-            {
-                xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509CA,
-                                                  ( const unsigned char * ) tlsSTARFIELD_ROOT_CERTIFICATE_PEM,
-                                                  tlsSTARFIELD_ROOT_CERTIFICATE_LENGTH );
-            }
-        }
+        vTracePrint( xTLSTraceChannel, "Handshake start" );
+    #endif
 
-        if( 0 != xResult )
-        {
-            /* Default root certificates should be in aws_default_root_certificate.h */
-            TLS_PRINT( ( "ERROR: Failed to parse default server certificates %d \r\n", xResult ) );
-        }
-    }
+    pxCtx->xSessionOffered = pdFALSE;
+    pxCtx->xRecordBufferPeakBytes = pxCtx->xRecordBufferBytes;
+
+    /* Initialize mbedTLS structures. */
+    mbedtls_ssl_init( &pxCtx->xMbedSslCtx );
+    mbedtls_ssl_config_init( &pxCtx->xMbedSslConfig );
+
+    /* Get the shared root certificates. */
+    xResult = prvGetServerCertificates( pxCtx );
 
     /* Start with protocol defaults. */
     if( 0 == xResult )
@@ -651,15 +1460,34 @@ BaseType_t TLS_Connect( void * pvContext )
         mbedtls_ssl_conf_authmode( &pxCtx->xMbedSslConfig, MBEDTLS_SSL_VERIFY_REQUIRED );
 
         /* Set the RNG callback. */
-        mbedtls_ssl_conf_rng( &pxCtx->xMbedSslConfig, &prvGenerateRandomBytes, pxCtx ); /*lint !e546 Nothing wrong here. */
+        mbedtls_ssl_conf_rng( &pxCtx->xMbedSslConfig, &CRYPTO_Random, NULL ); /*lint !e546 Nothing wrong here. */
 
         /* Set issuer certificate. */
-        mbedtls_ssl_conf_ca_chain( &pxCtx->xMbedSslConfig, &pxCtx->xMbedX509CA, NULL );
+        mbedtls_ssl_conf_ca_chain( &pxCtx->xMbedSslConfig, &pxCtx->pxServerCertificates->xCertificates, NULL );
 
         /* Configure the SSL context for the device credentials. */
         xResult = prvInitializeClientCredential( pxCtx );
     }
 
+    #ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+        if( 0 == xResult )
+        {
+            /* Limit the record size, which bounds the record buffers. */
+            xResult = mbedtls_ssl_conf_max_frag_len( &pxCtx->xMbedSslConfig, tlsconfigMAX_FRAGMENT_LENGTH );
+        }
+    #endif
+
+    #ifdef MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+        if( 0 == xResult )
+        {
+            /* Account record buffers to this connection and pool them. */
+            mbedtls_ssl_conf_buffer_alloc( &pxCtx->xMbedSslConfig,
+                                           prvRecordBufferAlloc,
+                                           prvRecordBufferFree,
+                                           pxCtx );
+        }
+    #endif
+
     if( ( 0 == xResult ) && ( NULL != pxCtx->ppcAlpnProtocols ) )
     {
         /* Include an application protocol list in the TLS ClientHello
@@ -687,6 +1515,19 @@ BaseType_t TLS_Connect( void * pvContext )
     if( ( 0 == xResult ) && ( NULL != pxCtx->pcDestination ) )
     {
         xResult = mbedtls_ssl_set_hostname( &pxCtx->xMbedSslCtx, pxCtx->pcDestination );
+
+        #if ( tlsconfigSESSION_CACHE_ENTRIES > 0 )
+            /* Try to resume the last session with this server. */
+            if( 0 == xResult )
+            {
+                xResult = prvSessionIdentity( pxCtx );
+            }
+
+            if( 0 == xResult )
+            {
+                prvSessionCacheLoad( pxCtx );
+            }
+        #endif
     }
 
     /* Set the socket callbacks. */
@@ -697,8 +1538,78 @@ BaseType_t TLS_Connect( void * pvContext )
                              prvNetworkSend,
                              prvNetworkRecv,
                              NULL );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Records the outcome of the handshake and releases what only the
+ * handshake needed.
+ *
+ * @param[in] pxCtx Caller context.
+ * @param[in] xResult Zero if the handshake succeeded.
+ */
+static void prvHandshakeFinish( TLSContext_t * pxCtx,
+                                BaseType_t xResult )
+{
+    pxCtx->xHandshakeInProgress = pdFALSE;
+
+    #if ( configUSE_TRACE_RECORDER == 1 )
+        if( 0 == xResult )
+        {
+            vTracePrintF( xTLSTraceChannel, "Handshake done, session offered %d", ( int ) pxCtx->xSessionOffered );
+        }
+        else
+        {
+            vTracePrintF( xTLSTraceChannel, "Handshake failed %d", ( int ) xResult );
+        }
+    #endif
+
+    /* Keep track of successful completion of the handshake. */
+    if( 0 == xResult )
+    {
+        pxCtx->xTLSHandshakeSuccessful = pdTRUE;
+
+        #ifdef MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+            TLS_PRINT( ( "TLS record buffers: %u bytes, %u at peak, fragment length %u.\r\n",
+                         ( unsigned ) pxCtx->xRecordBufferBytes,
+                         ( unsigned ) pxCtx->xRecordBufferPeakBytes,
+                         ( unsigned ) mbedtls_ssl_get_max_frag_len( &pxCtx->xMbedSslCtx ) ) );
+        #endif
+    }
+
+    #if ( tlsconfigSESSION_CACHE_ENTRIES > 0 )
+        if( ( 0 == xResult ) && ( NULL != pxCtx->pcDestination ) )
+        {
+            prvSessionCacheStore( pxCtx );
+        }
+        else if( pdFALSE != pxCtx->xSessionOffered )
+        {
+            /* Don't offer a session again that may have caused the failure. */
+            prvSessionCacheRemove( pxCtx );
+        }
+    #endif
+
+    /* The certificates are only needed for the handshake. The cache keeps
+     * them parsed for the next connection. */
+    prvReleaseCredentials( pxCtx );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_Connect( void * pvContext )
+{
+    BaseType_t xResult = 0;
+    TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
 
-        /* Negotiate. */
+    xResult = prvHandshakeSetup( pxCtx );
+
+    /* Negotiate. */
+    if( 0 == xResult )
+    {
         while( 0 != ( xResult = mbedtls_ssl_handshake( &pxCtx->xMbedSslCtx ) ) )
         {
             if( ( MBEDTLS_ERR_SSL_WANT_READ != xResult ) &&
@@ -714,15 +1625,67 @@ BaseType_t TLS_Connect( void * pvContext )
         }
     }
 
-    /* Keep track of successful completion of the handshake. */
+    prvHandshakeFinish( pxCtx, xResult );
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_ConnectStart( void * pvContext )
+{
+    BaseType_t xResult = 0;
+    TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    xResult = prvHandshakeSetup( pxCtx );
+
     if( 0 == xResult )
     {
-        pxCtx->xTLSHandshakeSuccessful = pdTRUE;
+        pxCtx->xHandshakeInProgress = pdTRUE;
+    }
+    else
+    {
+        prvHandshakeFinish( pxCtx, xResult );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_ConnectStep( void * pvContext )
+{
+    BaseType_t xResult = 0;
+    TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    if( ( NULL == pxCtx ) || ( pdFALSE == pxCtx->xHandshakeInProgress ) )
+    {
+        xResult = MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
     }
+    else
+    {
+        /* Runs until the handshake needs network I/O that is not ready. */
+        xResult = mbedtls_ssl_handshake( &pxCtx->xMbedSslCtx );
+
+        if( MBEDTLS_ERR_SSL_WANT_READ == xResult )
+        {
+            xResult = TLS_HANDSHAKE_WANT_READ;
+        }
+        else if( MBEDTLS_ERR_SSL_WANT_WRITE == xResult )
+        {
+            xResult = TLS_HANDSHAKE_WANT_WRITE;
+        }
+        else
+        {
+            if( 0 != xResult )
+            {
+                prvFreeContext( pxCtx );
+                TLS_PRINT( ( "ERROR: Handshake failed with error code %d \r\n", xResult ) );
+            }
 
-    /* Free up allocated memory. */
-    mbedtls_x509_crt_free( &pxCtx->xMbedX509CA );
-    mbedtls_x509_crt_free( &pxCtx->xMbedX509Cli );
+            prvHandshakeFinish( pxCtx, xResult );
+        }
+    }
 
     return xResult;
 }
@@ -841,8 +1804,75 @@ void TLS_Cleanup( void * pvContext )
         {
             prvFreeContext( pxCtx );
         }
+        else if( pdFALSE != pxCtx->xHandshakeInProgress )
+        {
+            /* Abandoned part way through TLS_ConnectStep(). */
+            prvFreeContext( pxCtx );
+            prvReleaseCredentials( pxCtx );
+        }
 
         /* Free memory. */
         vPortFree( pxCtx );
     }
 }
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_GetMemoryUsage( void * pvContext,
+                               TLSMemoryUsage_t * pxUsage )
+{
+    BaseType_t xResult = pdFAIL;
+    TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    if( ( NULL != pxCtx ) && ( NULL != pxUsage ) )
+    {
+        pxUsage->xContextBytes = sizeof( TLSContext_t );
+        pxUsage->xRecordBufferBytes = pxCtx->xRecordBufferBytes;
+        pxUsage->xRecordBufferPeakBytes = pxCtx->xRecordBufferPeakBytes;
+        pxUsage->xMaxFragmentLength = 0;
+
+        #ifndef MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+            /* The buffers are allocated at full size, outside of the callbacks. */
+            if( NULL != pxCtx->xMbedSslCtx.in_buf )
+            {
+                pxUsage->xRecordBufferBytes = MBEDTLS_SSL_IN_BUFFER_LEN + MBEDTLS_SSL_OUT_BUFFER_LEN;
+                pxUsage->xRecordBufferPeakBytes = pxUsage->xRecordBufferBytes;
+            }
+        #endif
+
+        if( pdTRUE == pxCtx->xTLSHandshakeSuccessful )
+        {
+            #ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+                pxUsage->xMaxFragmentLength = mbedtls_ssl_get_max_frag_len( &pxCtx->xMbedSslCtx );
+            #else
+                pxUsage->xMaxFragmentLength = MBEDTLS_SSL_OUT_CONTENT_LEN;
+            #endif
+        }
+
+        xResult = pdPASS;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+void TLS_FlushCredentialCache( void )
+{
+    BaseType_t x;
+
+    if( pdTRUE == prvCacheLock() )
+    {
+        /* Contexts in the middle of a handshake keep their reference. */
+        for( x = 0; x < tlsconfigSERVER_CERTIFICATE_CACHE_ENTRIES; x++ )
+        {
+            prvCertificateChainRelease( pxServerCertificateCache[ x ] );
+            pxServerCertificateCache[ x ] = NULL;
+        }
+
+        prvCertificateChainRelease( pxClientCredentialCache );
+        pxClientCredentialCache = NULL;
+
+        ( void ) xSemaphoreGive( xCacheMutex );
+    }
+}
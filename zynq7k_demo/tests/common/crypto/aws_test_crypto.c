@@ -31,11 +31,53 @@
 
 /* Crypto includes. */
 #include "aws_crypto.h"
+#include "aws_crypto_accel.h"
+
+/* C runtime includes. */
+#include <string.h>
 
 /* Unity framework includes. */
 #include "unity_fixture.h"
 #include "unity.h"
 
+/* Reads the signed data for CRYPTO_SignatureVerificationStream(). */
+typedef struct MemoryReader
+{
+    const uint8_t * pucData;
+    uint8_t * pucBuffer;
+    size_t xOffset;
+    size_t xLength;
+} MemoryReader_t;
+
+static BaseType_t prvMemoryStartRead( void * pvContext,
+                                      uint8_t * pucBuffer,
+                                      size_t xOffset,
+                                      size_t xLength )
+{
+    MemoryReader_t * pxReader = ( MemoryReader_t * ) pvContext;
+
+    pxReader->pucBuffer = pucBuffer;
+    pxReader->xOffset = xOffset;
+    pxReader->xLength = xLength;
+
+    return pdTRUE;
+}
+
+static int32_t prvMemoryFinishRead( void * pvContext )
+{
+    MemoryReader_t * pxReader = ( MemoryReader_t * ) pvContext;
+
+    /* Return short reads, as storage may. */
+    if( pxReader->xLength > 100 )
+    {
+        pxReader->xLength = 100;
+    }
+
+    memcpy( pxReader->pucBuffer, &pxReader->pucData[ pxReader->xOffset ], pxReader->xLength );
+
+    return ( int32_t ) pxReader->xLength;
+}
+
 TEST_GROUP( Full_CRYPTO );
 
 TEST_SETUP( Full_CRYPTO )
@@ -49,6 +91,11 @@ TEST_TEAR_DOWN( Full_CRYPTO )
 TEST_GROUP_RUNNER( Full_CRYPTO )
 {
     RUN_TEST_CASE( Full_CRYPTO, VerifySignatureTestVectors );
+    RUN_TEST_CASE( Full_CRYPTO, AcceleratorKnownAnswers );
+    RUN_TEST_CASE( Full_CRYPTO, RandomBytes );
+
+    /* Again, now that ECDSA verification is offloaded. */
+    RUN_TEST_CASE( Full_CRYPTO, VerifySignatureTestVectors );
 }
 
 TEST( Full_CRYPTO, VerifySignatureTestVectors )
@@ -142,6 +189,8 @@ TEST( Full_CRYPTO, VerifySignatureTestVectors )
 
 #define TEST_DATA_TO_SIGN_BYTES    1024
     uint8_t ucDataToSign[ TEST_DATA_TO_SIGN_BYTES ] = { 0 };
+    MemoryReader_t xMemoryReader = { ucDataToSign };
+    CryptoStreamReader_t xReader = { prvMemoryStartRead, prvMemoryFinishRead, &xMemoryReader };
 
     /** \brief Verify an RSA-SHA256 signature test vector.
      *  @{
@@ -258,6 +307,30 @@ TEST( Full_CRYPTO, VerifySignatureTestVectors )
         sizeof( ucECDSA_SHA256Signature ) );
     TEST_ASSERT_TRUE( xResult );
 
+    /* The same, reading the data in chunks. */
+    xResult = CRYPTO_SignatureVerificationStream(
+        &xReader,
+        sizeof( ucDataToSign ),
+        cryptoASYMMETRIC_ALGORITHM_ECDSA,
+        cryptoHASH_ALGORITHM_SHA256,
+        cSignerCertificateECDSA,
+        sizeof( cSignerCertificateECDSA ),
+        ucECDSA_SHA256Signature,
+        sizeof( ucECDSA_SHA256Signature ) );
+    TEST_ASSERT_TRUE( xResult );
+
+    /* Not all of the signed data. */
+    xResult = CRYPTO_SignatureVerificationStream(
+        &xReader,
+        sizeof( ucDataToSign ) - 1,
+        cryptoASYMMETRIC_ALGORITHM_ECDSA,
+        cryptoHASH_ALGORITHM_SHA256,
+        cSignerCertificateECDSA,
+        sizeof( cSignerCertificateECDSA ),
+        ucECDSA_SHA256Signature,
+        sizeof( ucECDSA_SHA256Signature ) );
+    TEST_ASSERT_FALSE( xResult );
+
     /* Flip the bits of first byte, this should fail the verification. */
     ucECDSA_SHA256Signature[ 0 ] = ~ucECDSA_SHA256Signature[ 0 ];
 
@@ -281,3 +354,85 @@ TEST( Full_CRYPTO, VerifySignatureTestVectors )
     TEST_ASSERT_FALSE( xResult );
     /** @}*/
 }
+
+TEST( Full_CRYPTO, AcceleratorKnownAnswers )
+{
+    static const uint8_t ucSha256Abc[] =
+    {
+        0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA, 0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+        0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C, 0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD
+    };
+    /* FIPS-197 appendix C.1. */
+    static const uint8_t ucAesKey[] =
+    {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+    };
+    static const uint8_t ucAesPlaintext[] =
+    {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF
+    };
+    static const uint8_t ucAesCiphertext[] =
+    {
+        0x69, 0xC4, 0xE0, 0xD8, 0x6A, 0x7B, 0x04, 0x30, 0xD8, 0xCD, 0xB7, 0x80, 0x70, 0xB4, 0xC5, 0x5A
+    };
+    uint8_t ucOutput[ 32 ];
+    CryptoAccelJob_t xJob;
+    CryptoAccelStats_t xStats;
+
+    /* The application may have registered a provider already. */
+    ( void ) CRYPTO_AccelInit( &xCryptoAccelSoftwareProvider );
+    TEST_ASSERT_TRUE( CRYPTO_AccelSupports( eCryptoAccelSha256 ) );
+    TEST_ASSERT_TRUE( CRYPTO_AccelSupports( eCryptoAccelAesEcbEncrypt ) );
+    TEST_ASSERT_TRUE( CRYPTO_AccelSupports( eCryptoAccelEcdsaP256Verify ) );
+
+    memset( &xJob, 0, sizeof( xJob ) );
+    xJob.eOperation = eCryptoAccelSha256;
+    xJob.pucInput = ( const uint8_t * ) "abc";
+    xJob.xInputLength = 3;
+    xJob.pucOutput = ucOutput;
+    TEST_ASSERT_EQUAL( cryptoaccelSTATUS_OK, CRYPTO_AccelRun( &xJob ) );
+    TEST_ASSERT_EQUAL_HEX8_ARRAY( ucSha256Abc, ucOutput, sizeof( ucSha256Abc ) );
+
+    memset( &xJob, 0, sizeof( xJob ) );
+    xJob.eOperation = eCryptoAccelAesEcbEncrypt;
+    xJob.pucKey = ucAesKey;
+    xJob.xKeyLength = sizeof( ucAesKey );
+    xJob.pucInput = ucAesPlaintext;
+    xJob.xInputLength = sizeof( ucAesPlaintext );
+    xJob.pucOutput = ucOutput;
+    TEST_ASSERT_EQUAL( cryptoaccelSTATUS_OK, CRYPTO_AccelRun( &xJob ) );
+    TEST_ASSERT_EQUAL_HEX8_ARRAY( ucAesCiphertext, ucOutput, sizeof( ucAesCiphertext ) );
+
+    /* Partial blocks are rejected. */
+    xJob.xInputLength = sizeof( ucAesPlaintext ) - 1;
+    TEST_ASSERT_EQUAL( cryptoaccelSTATUS_FAILED, CRYPTO_AccelRun( &xJob ) );
+
+    CRYPTO_AccelGetStats( &xStats );
+    TEST_ASSERT_GREATER_THAN( 2, xStats.ulJobs );
+    TEST_ASSERT_GREATER_THAN( 0, xStats.ulFailures );
+}
+
+TEST( Full_CRYPTO, RandomBytes )
+{
+    uint8_t ucFirst[ 16 ] = { 0 };
+    uint8_t ucSecond[ 16 ] = { 0 };
+    uint8_t ucZero[ 16 ] = { 0 };
+    uint8_t ucLarge[ 300 ];
+    size_t xLength;
+
+    /* Short requests come from the task's buffer; no bytes are repeated. */
+    TEST_ASSERT_EQUAL_INT( 0, CRYPTO_Random( NULL, ucFirst, sizeof( ucFirst ) ) );
+    TEST_ASSERT_EQUAL_INT( 0, CRYPTO_Random( NULL, ucSecond, sizeof( ucSecond ) ) );
+    TEST_ASSERT_TRUE( 0 != memcmp( ucFirst, ucZero, sizeof( ucFirst ) ) );
+    TEST_ASSERT_TRUE( 0 != memcmp( ucFirst, ucSecond, sizeof( ucFirst ) ) );
+
+    /* Lengths that straddle the end of the buffer, and longer than it. */
+    for( xLength = 1; xLength <= sizeof( ucLarge ); xLength += 7 )
+    {
+        TEST_ASSERT_EQUAL_INT( 0, CRYPTO_Random( NULL, ucLarge, xLength ) );
+    }
+
+    memset( ucLarge, 0, sizeof( ucLarge ) );
+    TEST_ASSERT_EQUAL_INT( 0, CRYPTO_Random( NULL, ucLarge, sizeof( ucLarge ) ) );
+    TEST_ASSERT_TRUE( 0 != memcmp( &ucLarge[ sizeof( ucLarge ) - sizeof( ucZero ) ], ucZero, sizeof( ucZero ) ) );
+}
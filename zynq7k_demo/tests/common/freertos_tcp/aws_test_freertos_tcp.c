@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdio.h>
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
@@ -63,11 +64,23 @@ TEST_GROUP_RUNNER( Full_FREERTOS_TCP )
     RUN_TEST_CASE( Full_FREERTOS_TCP, prvParseDnsResponse );
     RUN_TEST_CASE( Full_FREERTOS_TCP, ulDNSHandlePacket );
 
+    #if ( ipconfigUSE_DNS_CACHE == 1 )
+        /* DNS cache expiry and replacement. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, DNSCacheTTL );
+    #endif
+
     /* prvCheckOptions test. */
     RUN_TEST_CASE( Full_FREERTOS_TCP, prvCheckOptions );
 
     /* xProcessReceivedUDPPacket test. */
     RUN_TEST_CASE( Full_FREERTOS_TCP, UDPPacketLength );
+
+    #if ( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+        /* Congestion control tests, using a simulated link. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPCongestionNewReno );
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPCongestionCubic );
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPCongestionPacing );
+    #endif
 }
 
 TEST( Full_FREERTOS_TCP, prvParseDnsResponse )
@@ -359,4 +372,226 @@ TEST( Full_FREERTOS_TCP, UDPPacketLength )
     xNetworkBuffer.xDataLength = sizeof( ucBadUdpPacketB );
     xReturn = xProcessReceivedUDPPacket( &xNetworkBuffer, usPort );
     TEST_ASSERT_EQUAL_UINT32( pdFAIL, xReturn );
-}
\ No newline at end of file
+}
+
+#if ( ipconfigUSE_DNS_CACHE == 1 )
+    TEST( Full_FREERTOS_TCP, DNSCacheTTL )
+    {
+        char pcName[ 16 ];
+        uint32_t ulAddress;
+        BaseType_t x;
+
+        /* A name with a TTL can be found. */
+        ulAddress = 0x0a000001UL;
+        TEST_FreeRTOS_TCP_prvProcessDNSCache( "ttl.test", &ulAddress, 60UL, pdFALSE );
+        TEST_ASSERT_EQUAL_UINT32( 0x0a000001UL, FreeRTOS_dnslookup( "ttl.test" ) );
+
+        /* A TTL of zero has expired already. */
+        ulAddress = 0x0a000002UL;
+        TEST_FreeRTOS_TCP_prvProcessDNSCache( "ttl.test", &ulAddress, 0UL, pdFALSE );
+        TEST_ASSERT_EQUAL_UINT32( 0UL, FreeRTOS_dnslookup( "ttl.test" ) );
+
+        /* Fill the cache: the entry that expires first gets replaced. */
+        for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+        {
+            snprintf( pcName, sizeof( pcName ), "fill%d.test", ( int ) x );
+            ulAddress = 0x0a000100UL + ( uint32_t ) x;
+            TEST_FreeRTOS_TCP_prvProcessDNSCache( pcName, &ulAddress, ( x == 1 ) ? 30UL : ipconfigDNS_CACHE_MAX_TTL_SECONDS, pdFALSE );
+        }
+
+        ulAddress = 0x0a000003UL;
+        TEST_FreeRTOS_TCP_prvProcessDNSCache( "new.test", &ulAddress, ipconfigDNS_CACHE_MAX_TTL_SECONDS, pdFALSE );
+        TEST_ASSERT_EQUAL_UINT32( 0x0a000003UL, FreeRTOS_dnslookup( "new.test" ) );
+        TEST_ASSERT_EQUAL_UINT32( 0UL, FreeRTOS_dnslookup( "fill1.test" ) );
+    }
+#endif /* if ( ipconfigUSE_DNS_CACHE == 1 ) */
+
+#if ( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+
+/*
+ * @brief Parameters of the simulated link used by the congestion control tests.
+ */
+    #define tcptestSIM_MSS               ( 1460u )
+    #define tcptestSIM_SEGMENTS          ( 40u )
+    #define tcptestSIM_MAX_ROUNDS        ( 80 )
+    #define tcptestSIM_FIRST_SEQUENCE    ( 0x10000u )
+    #define tcptestSIM_LOSS_NONE         ( ~0u )
+
+/*
+ * @brief What was observed while transferring data over the simulated link.
+ */
+    typedef struct SimulationResult
+    {
+        uint32_t ulSlowStartWindows[ 2 ]; /* cwnd after the first two round trips. */
+        uint32_t ulWindowBeforeLoss;      /* cwnd just before the loss was detected. */
+        uint32_t ulWindowAfterLoss;       /* cwnd just after the loss was detected. */
+        uint32_t ulLargestBurst;          /* The largest number of segments sent back-to-back. */
+        uint32_t ulLargestWindow;         /* The largest cwnd seen. */
+        uint32_t ulDelivered;             /* The number of bytes ACK'd by the peer. */
+    } SimulationResult_t;
+
+/*
+ * @brief Send tcptestSIM_SEGMENTS full segments over a link with a round-trip
+ * time of xDelayMs, which drops segment ulLostSegment the first time it is sent.
+ * The peer ACKs every segment, and sends a SACK for data after a hole.
+ */
+    static void prvSimulateLink( BaseType_t xAlgorithm,
+                                 BaseType_t xPacing,
+                                 TickType_t xDelayMs,
+                                 uint32_t ulLostSegment,
+                                 SimulationResult_t * pxResult )
+    {
+        /* Static because a TCP window is too big for the stack of the test task. */
+        static TCPWindow_t xWindow;
+        uint8_t ucReceived[ tcptestSIM_SEGMENTS ];
+        uint32_t ulSent[ tcptestSIM_SEGMENTS ];
+        uint32_t ulSentCount, ulIndex, ulSegment, ulCumulative = 0u;
+        uint32_t ulWindowBefore, ulLength;
+        uint32_t ulTotal = tcptestSIM_SEGMENTS * tcptestSIM_MSS;
+        int32_t lPosition;
+        BaseType_t xRound, xDropped = pdFALSE, xLossDone = pdFALSE;
+
+        memset( pxResult, '\0', sizeof( *pxResult ) );
+        memset( ucReceived, '\0', sizeof( ucReceived ) );
+        memset( &xWindow, '\0', sizeof( xWindow ) );
+
+        vTCPWindowCreate( &xWindow, tcptestSIM_SEGMENTS * tcptestSIM_MSS, tcptestSIM_SEGMENTS * tcptestSIM_MSS,
+                          0u, tcptestSIM_FIRST_SEQUENCE, tcptestSIM_MSS );
+        TEST_ASSERT_EQUAL( pdPASS, xTCPWindowSetCongestionControl( &xWindow, xAlgorithm ) );
+        xWindow.xCongestion.ucPacing = ( uint8_t ) xPacing;
+
+        TEST_ASSERT_EQUAL_INT32( ( int32_t ) ulTotal, lTCPWindowTxAdd( &xWindow, ulTotal, 0, ( int32_t ) ulTotal + 1 ) );
+
+        for( xRound = 0; ( xRound < tcptestSIM_MAX_ROUNDS ) && ( ulCumulative < tcptestSIM_SEGMENTS ); xRound++ )
+        {
+            /* Send whatever the window allows. */
+            ulSentCount = 0u;
+
+            while( ( ulSentCount < tcptestSIM_SEGMENTS ) &&
+                   ( ( ulLength = ulTCPWindowTxGet( &xWindow, ulTotal, &lPosition ) ) != 0u ) )
+            {
+                TEST_ASSERT_EQUAL_UINT32( tcptestSIM_MSS, ulLength );
+                ulSent[ ulSentCount++ ] = ( uint32_t ) lPosition / tcptestSIM_MSS;
+            }
+
+            if( ulSentCount > pxResult->ulLargestBurst )
+            {
+                pxResult->ulLargestBurst = ulSentCount;
+            }
+
+            /* The segments travel to the peer and the ACK's travel back. */
+            vTaskDelay( pdMS_TO_TICKS( xDelayMs ) );
+
+            for( ulIndex = 0u; ulIndex < ulSentCount; ulIndex++ )
+            {
+                ulSegment = ulSent[ ulIndex ];
+
+                if( ( ulSegment == ulLostSegment ) && ( xDropped == pdFALSE ) )
+                {
+                    /* Dropped by the link, the retransmission will arrive. */
+                    xDropped = pdTRUE;
+                    continue;
+                }
+
+                ucReceived[ ulSegment ] = 1u;
+
+                while( ( ulCumulative < tcptestSIM_SEGMENTS ) && ( ucReceived[ ulCumulative ] != 0u ) )
+                {
+                    ulCumulative++;
+                }
+
+                ulWindowBefore = xWindow.xCongestion.ulCongestionWindow;
+
+                if( ulSegment < ulCumulative )
+                {
+                    ( void ) ulTCPWindowTxAck( &xWindow, tcptestSIM_FIRST_SEQUENCE + ulCumulative * tcptestSIM_MSS );
+                }
+                else
+                {
+                    /* Out of order: a duplicate ACK with a SACK option. */
+                    ( void ) ulTCPWindowTxSack( &xWindow,
+                                                tcptestSIM_FIRST_SEQUENCE + ulSegment * tcptestSIM_MSS,
+                                                tcptestSIM_FIRST_SEQUENCE + ( ulSegment + 1u ) * tcptestSIM_MSS );
+                }
+
+                if( ( xLossDone == pdFALSE ) && ( xWindow.xCongestion.ucInRecovery != pdFALSE_UNSIGNED ) )
+                {
+                    xLossDone = pdTRUE;
+                    pxResult->ulWindowBeforeLoss = ulWindowBefore;
+                    pxResult->ulWindowAfterLoss = xWindow.xCongestion.ulCongestionWindow;
+                }
+            }
+
+            if( xRound < 2 )
+            {
+                pxResult->ulSlowStartWindows[ xRound ] = xWindow.xCongestion.ulCongestionWindow;
+            }
+
+            if( xWindow.xCongestion.ulCongestionWindow > pxResult->ulLargestWindow )
+            {
+                pxResult->ulLargestWindow = xWindow.xCongestion.ulCongestionWindow;
+            }
+        }
+
+        pxResult->ulDelivered = xWindow.tx.ulCurrentSequenceNumber - tcptestSIM_FIRST_SEQUENCE;
+
+        vTCPWindowDestroy( &xWindow );
+    }
+/*-----------------------------------------------------------*/
+
+    TEST( Full_FREERTOS_TCP, TCPCongestionNewReno )
+    {
+        SimulationResult_t xResult;
+        TCPWindow_t xWindow;
+
+        /* Unknown algorithms are refused. */
+        memset( &xWindow, '\0', sizeof( xWindow ) );
+        TEST_ASSERT_EQUAL( pdFAIL, xTCPWindowSetCongestionControl( &xWindow, 99 ) );
+
+        prvSimulateLink( FREERTOS_TCP_CC_NEWRENO, pdFALSE, 20u, 10u, &xResult );
+
+        /* The initial window of 3 segments doubles every round trip. */
+        TEST_ASSERT_EQUAL_UINT32( 6u * tcptestSIM_MSS, xResult.ulSlowStartWindows[ 0 ] );
+        TEST_ASSERT_EQUAL_UINT32( 12u * tcptestSIM_MSS, xResult.ulSlowStartWindows[ 1 ] );
+
+        /* A loss halves the window. */
+        TEST_ASSERT_NOT_EQUAL( 0u, xResult.ulWindowAfterLoss );
+        TEST_ASSERT_UINT32_WITHIN( tcptestSIM_MSS, xResult.ulWindowBeforeLoss / 2u, xResult.ulWindowAfterLoss );
+
+        /* And everything arrives in the end. */
+        TEST_ASSERT_EQUAL_UINT32( tcptestSIM_SEGMENTS * tcptestSIM_MSS, xResult.ulDelivered );
+    }
+/*-----------------------------------------------------------*/
+
+    TEST( Full_FREERTOS_TCP, TCPCongestionCubic )
+    {
+        SimulationResult_t xResult;
+
+        prvSimulateLink( FREERTOS_TCP_CC_CUBIC, pdFALSE, 20u, 10u, &xResult );
+
+        /* Slow start is the same as NewReno. */
+        TEST_ASSERT_EQUAL_UINT32( 6u * tcptestSIM_MSS, xResult.ulSlowStartWindows[ 0 ] );
+        TEST_ASSERT_EQUAL_UINT32( 12u * tcptestSIM_MSS, xResult.ulSlowStartWindows[ 1 ] );
+
+        /* A loss reduces the window to 70%. */
+        TEST_ASSERT_NOT_EQUAL( 0u, xResult.ulWindowAfterLoss );
+        TEST_ASSERT_UINT32_WITHIN( tcptestSIM_MSS, ( xResult.ulWindowBeforeLoss * 7u ) / 10u, xResult.ulWindowAfterLoss );
+
+        TEST_ASSERT_EQUAL_UINT32( tcptestSIM_SEGMENTS * tcptestSIM_MSS, xResult.ulDelivered );
+    }
+/*-----------------------------------------------------------*/
+
+    TEST( Full_FREERTOS_TCP, TCPCongestionPacing )
+    {
+        SimulationResult_t xResult;
+
+        prvSimulateLink( FREERTOS_TCP_CC_NEWRENO, pdTRUE, 20u, tcptestSIM_LOSS_NONE, &xResult );
+
+        /* The window grows as usual, but segments are not sent in large bursts. */
+        TEST_ASSERT_GREATER_THAN_UINT32( 4u * tcptestSIM_MSS, xResult.ulLargestWindow );
+        TEST_ASSERT_LESS_THAN_UINT32( xResult.ulLargestWindow / tcptestSIM_MSS, xResult.ulLargestBurst );
+
+        TEST_ASSERT_EQUAL_UINT32( tcptestSIM_SEGMENTS * tcptestSIM_MSS, xResult.ulDelivered );
+    }
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
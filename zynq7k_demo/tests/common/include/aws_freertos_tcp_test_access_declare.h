@@ -30,6 +30,11 @@ uint32_t TEST_FreeRTOS_TCP_prvParseDNSReply( uint8_t * pucUDPPayloadBuffer,
                                              size_t xBufferLength,
                                              TickType_t xIdentifier );
 
+void TEST_FreeRTOS_TCP_prvProcessDNSCache( const char * pcName,
+                                           uint32_t * pulIP,
+                                           uint32_t ulTTL,
+                                           BaseType_t xLookUp );
+
 void TEST_FreeRTOS_TCP_prvCheckOptions( FreeRTOS_Socket_t * pxSocket,
                                         NetworkBufferDescriptor_t * pxNetworkBuffer );
 
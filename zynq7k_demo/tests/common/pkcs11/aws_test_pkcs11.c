@@ -1146,6 +1146,9 @@ TEST_GROUP_RUNNER( Full_PKCS11_CryptoOperation )
     RUN_TEST_CASE( Full_PKCS11_CryptoOperation, AFQP_SignVerifyRoundTripWithCorrectECPublicKey );
     RUN_TEST_CASE( Full_PKCS11_CryptoOperation, AFQP_SignVerifyRoundTripWithWrongECPublicKey );
 
+    /* Sign-verify after the key of a handle was replaced. */
+    RUN_TEST_CASE( Full_PKCS11_CryptoOperation, AFQP_SignVerifyRoundTripAfterKeyReplaced );
+
     /* Test signature verification with output from OpenSSL. Also attempts to
      * verify an invalid signature. */
     RUN_TEST_CASE( Full_PKCS11_CryptoOperation, AFQP_SignVerifyCryptoApiInteropRSA );
@@ -2384,6 +2387,26 @@ TEST( Full_PKCS11_CryptoOperation, AFQP_SignVerifyRoundTripWithWrongECPublicKey
 
 /*-----------------------------------------------------------*/
 
+TEST( Full_PKCS11_CryptoOperation, AFQP_SignVerifyRoundTripAfterKeyReplaced )
+{
+    /* Sign with the RSA key, so that it is parsed and kept by the module. */
+    prvReprovision( pcValidRSACertificate, pcValidRSAPrivateKey, CKK_RSA );
+
+    TEST_ASSERT_EQUAL_INT32( prvSignVerifyRoundTrip( CKM_SHA256_RSA_PKCS,
+                                                     pcValidRSAPublicKey ),
+                             0 );
+
+    /* Replace the private key and the public key under the same handles. The
+     * new keys must be used, not the ones parsed before. */
+    prvReprovision( pcValidECDSACertificate, pcValidECDSAPrivateKey, CKK_EC );
+
+    TEST_ASSERT_EQUAL_INT32( prvSignVerifyRoundTrip( CKM_ECDSA,
+                                                     pcValidECDSAPublicKey ),
+                             0 );
+}
+
+/*-----------------------------------------------------------*/
+
 TEST( Full_PKCS11_CryptoOperation, AFQP_SignVerifyCryptoApiInteropRSA )
 {
     CK_RV xResult = 0;
@@ -0,0 +1,268 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "ring_queue.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+#include "unity.h"
+
+#define ringtestLENGTH              16
+#define ringtestTIMEOUT_TICKS       20
+#define ringtestWRITERS             3
+#define ringtestWRITER_ITEMS        10000
+#define ringtestRECEIVE_TICKS       pdMS_TO_TICKS( 1000 )
+#define ringtestBENCHMARK_ITEMS     200000
+#define ringtestBENCHMARK_BATCH     8
+
+/* An item identifies its writer and counts that writer's items. */
+typedef struct RingTestItem
+{
+    uint32_t ulWriter;
+    uint32_t ulSequence;
+} RingTestItem_t;
+
+static RingQueueHandle_t xWriterRing = NULL;
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckFullAndEmpty( BaseType_t xMultipleProducers )
+{
+    RingQueueHandle_t xRing;
+    RingTestItem_t xItem = { 0, 0 };
+    uint32_t ulLap, ul;
+
+    /* The length is rounded up to a power of two. */
+    xRing = xRingQueueGenericCreate( ringtestLENGTH - 3, sizeof( RingTestItem_t ), xMultipleProducers );
+    TEST_ASSERT_NOT_NULL( xRing );
+
+    /* Enough laps to wrap the slots. */
+    for( ulLap = 0; ulLap < 3; ulLap++ )
+    {
+        TEST_ASSERT_EQUAL_UINT32( 0, uxRingQueueMessagesWaiting( xRing ) );
+        TEST_ASSERT_EQUAL( pdFAIL, xRingQueueReceive( xRing, &xItem, 0 ) );
+
+        for( ul = 0; ul < ringtestLENGTH; ul++ )
+        {
+            xItem.ulSequence = ulLap * ringtestLENGTH + ul;
+            TEST_ASSERT_EQUAL( pdPASS, xRingQueueSend( xRing, &xItem ) );
+        }
+
+        TEST_ASSERT_EQUAL( errQUEUE_FULL, xRingQueueSend( xRing, &xItem ) );
+        TEST_ASSERT_EQUAL_UINT32( ringtestLENGTH, uxRingQueueMessagesWaiting( xRing ) );
+
+        for( ul = 0; ul < ringtestLENGTH; ul++ )
+        {
+            TEST_ASSERT_EQUAL( pdPASS, xRingQueueReceive( xRing, &xItem, 0 ) );
+            TEST_ASSERT_EQUAL_UINT32( ulLap * ringtestLENGTH + ul, xItem.ulSequence );
+        }
+    }
+
+    vRingQueueDelete( xRing );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvWriterTask( void * pvParameters )
+{
+    RingTestItem_t xItem;
+
+    xItem.ulWriter = ( uint32_t ) ( uintptr_t ) pvParameters;
+
+    for( xItem.ulSequence = 0; xItem.ulSequence < ringtestWRITER_ITEMS; xItem.ulSequence++ )
+    {
+        while( xRingQueueSend( xWriterRing, &xItem ) != pdPASS )
+        {
+            taskYIELD();
+        }
+    }
+
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/* The time per item to send and receive batches of items, without blocking,
+ * in nanoseconds. */
+static uint32_t prvMeasure( QueueHandle_t xQueue,
+                            RingQueueHandle_t xRing )
+{
+    RingTestItem_t xItem = { 0, 0 };
+    TickType_t xStart;
+    uint32_t ul, ulBatch;
+
+    /* Start on a tick boundary. */
+    vTaskDelay( 1 );
+    xStart = xTaskGetTickCount();
+
+    for( ul = 0; ul < ringtestBENCHMARK_ITEMS; ul += ringtestBENCHMARK_BATCH )
+    {
+        for( ulBatch = 0; ulBatch < ringtestBENCHMARK_BATCH; ulBatch++ )
+        {
+            if( xRing != NULL )
+            {
+                ( void ) xRingQueueSend( xRing, &xItem );
+            }
+            else
+            {
+                ( void ) xQueueSend( xQueue, &xItem, 0 );
+            }
+        }
+
+        for( ulBatch = 0; ulBatch < ringtestBENCHMARK_BATCH; ulBatch++ )
+        {
+            if( xRing != NULL )
+            {
+                ( void ) xRingQueueReceive( xRing, &xItem, 0 );
+            }
+            else
+            {
+                ( void ) xQueueReceive( xQueue, &xItem, 0 );
+            }
+        }
+    }
+
+    return ( uint32_t ) ( ( ( uint64_t ) ( xTaskGetTickCount() - xStart ) * ( 1000000000ULL / configTICK_RATE_HZ ) ) / ringtestBENCHMARK_ITEMS );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_RING_QUEUE );
+
+TEST_SETUP( Full_RING_QUEUE )
+{
+}
+
+TEST_TEAR_DOWN( Full_RING_QUEUE )
+{
+}
+
+TEST_GROUP_RUNNER( Full_RING_QUEUE )
+{
+    RUN_TEST_CASE( Full_RING_QUEUE, SingleProducer_full_and_empty );
+    RUN_TEST_CASE( Full_RING_QUEUE, MultipleProducers_full_and_empty );
+    RUN_TEST_CASE( Full_RING_QUEUE, Receive_times_out );
+    RUN_TEST_CASE( Full_RING_QUEUE, MultipleProducers_tasks_in_order );
+    RUN_TEST_CASE( Full_RING_QUEUE, Faster_than_queue );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_RING_QUEUE, SingleProducer_full_and_empty )
+{
+    prvCheckFullAndEmpty( pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_RING_QUEUE, MultipleProducers_full_and_empty )
+{
+    prvCheckFullAndEmpty( pdTRUE );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_RING_QUEUE, Receive_times_out )
+{
+    RingQueueHandle_t xRing = xRingQueueCreate( ringtestLENGTH, sizeof( RingTestItem_t ) );
+    RingTestItem_t xItem;
+    TickType_t xStart;
+
+    TEST_ASSERT_NOT_NULL( xRing );
+
+    xStart = xTaskGetTickCount();
+    TEST_ASSERT_EQUAL( pdFAIL, xRingQueueReceive( xRing, &xItem, ringtestTIMEOUT_TICKS ) );
+    TEST_ASSERT_TRUE( ( xTaskGetTickCount() - xStart ) >= ringtestTIMEOUT_TICKS );
+
+    vRingQueueDelete( xRing );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_RING_QUEUE, MultipleProducers_tasks_in_order )
+{
+    uint32_t ulExpected[ ringtestWRITERS ] = { 0 };
+    uint32_t ulReceived = 0, ul;
+    RingTestItem_t xItem;
+
+    xWriterRing = xRingQueueCreateMultipleProducers( ringtestLENGTH, sizeof( RingTestItem_t ) );
+    TEST_ASSERT_NOT_NULL( xWriterRing );
+
+    /* The writers run below the reader, which blocks whenever it catches up. */
+    for( ul = 0; ul < ringtestWRITERS; ul++ )
+    {
+        TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvWriterTask, "RingWriter", configMINIMAL_STACK_SIZE, ( void * ) ( uintptr_t ) ul,
+                                                tskIDLE_PRIORITY, NULL ) );
+    }
+
+    while( ulReceived < ringtestWRITERS * ringtestWRITER_ITEMS )
+    {
+        TEST_ASSERT_EQUAL( pdPASS, xRingQueueReceive( xWriterRing, &xItem, ringtestRECEIVE_TICKS ) );
+        TEST_ASSERT_TRUE( xItem.ulWriter < ringtestWRITERS );
+        TEST_ASSERT_EQUAL_UINT32( ulExpected[ xItem.ulWriter ], xItem.ulSequence );
+        ulExpected[ xItem.ulWriter ]++;
+        ulReceived++;
+    }
+
+    /* Let the idle task free the writers. */
+    vTaskDelay( pdMS_TO_TICKS( 100 ) );
+    vRingQueueDelete( xWriterRing );
+    xWriterRing = NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_RING_QUEUE, Faster_than_queue )
+{
+    QueueHandle_t xQueue = xQueueCreate( ringtestLENGTH, sizeof( RingTestItem_t ) );
+    RingQueueHandle_t xSingle = xRingQueueCreate( ringtestLENGTH, sizeof( RingTestItem_t ) );
+    RingQueueHandle_t xMultiple = xRingQueueCreateMultipleProducers( ringtestLENGTH, sizeof( RingTestItem_t ) );
+    uint32_t ulQueue, ulSingle, ulMultiple;
+
+    TEST_ASSERT_NOT_NULL( xQueue );
+    TEST_ASSERT_NOT_NULL( xSingle );
+    TEST_ASSERT_NOT_NULL( xMultiple );
+
+    ulQueue = prvMeasure( xQueue, NULL );
+    ulSingle = prvMeasure( NULL, xSingle );
+    ulMultiple = prvMeasure( NULL, xMultiple );
+
+    configPRINTF( ( "ns per item sent and received: queue %u, single producer ring queue %u, multiple producer ring queue %u\r\n",
+                    ( unsigned ) ulQueue, ( unsigned ) ulSingle, ( unsigned ) ulMultiple ) );
+
+    vQueueDelete( xQueue );
+    vRingQueueDelete( xSingle );
+    vRingQueueDelete( xMultiple );
+
+    TEST_ASSERT_TRUE( ulSingle < ulQueue );
+    TEST_ASSERT_TRUE( ulMultiple < ulQueue );
+}
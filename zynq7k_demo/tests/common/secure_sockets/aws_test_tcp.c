@@ -37,6 +37,10 @@
 /* Secure Sockets includes. */
 #include "aws_secure_sockets.h"
 
+/* FreeRTOS+TCP includes, for FreeRTOS_select(). */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
 /* Test framework includes. */
 #include "unity_fixture.h"
 #include "aws_test_runner.h"
@@ -783,6 +787,8 @@ TEST_GROUP_RUNNER( Full_TCP )
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_Close );
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_Recv_ByteByByte );
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_SendRecv_VaryLength );
+    RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_SendV );
+    RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_ConnectStep );
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_Socket_InvalidTooManySockets );
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_Socket_InvalidInputParams );
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_Send_Invalid );
@@ -810,6 +816,8 @@ TEST_GROUP_RUNNER( Full_TCP )
         RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_Close );
         RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_Recv_ByteByByte );
         RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_SendRecv_VaryLength );
+        RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_SendV );
+        RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_ConnectStep );
         /* SECURE_SOCKETS_Socket_InvalidTooManySockets has not been implemented. */
         /*SECURE_SOCKETS_Socket_InvalidInputParams DNE.*/
         RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_Send_Invalid );
@@ -1641,6 +1649,199 @@ TEST( Full_TCP, AFQP_SECURE_SOCKETS_SendRecv_VaryLength )
     prvSOCKETS_SendRecv_VaryLength( eSecure );
 }
 
+/*-----------------------------------------------------------*/
+
+static void prvSOCKETS_SendV( Server_t xConn )
+{
+    BaseType_t xResult;
+    int32_t lSent;
+    size_t xIndex;
+    size_t xOffset;
+    uint8_t * pucTxBuffer = ( uint8_t * ) pcTxBuffer;
+    uint8_t * pucRxBuffer = ( uint8_t * ) pcRxBuffer;
+    const size_t xMessageLength = 1201;
+    size_t xVectorLengths[] = { 1, 2, 7, 600, 1, 590 };
+    SocketsIovec_t xVectors[ sizeof( xVectorLengths ) / sizeof( size_t ) ];
+    const TickType_t xCoalesceWindow = pdMS_TO_TICKS( 20 );
+
+    tcptestPRINTF( ( "Starting %s.\r\n", __FUNCTION__ ) );
+
+    xResult = prvConnectHelperWithRetry( &xSocket, xConn, xReceiveTimeOut, xSendTimeOut, &xSocketOpen );
+    TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Failed to connect" );
+
+    /* Invalid vectors are rejected. */
+    xVectors[ 0 ].pvBuffer = NULL;
+    xVectors[ 0 ].xLength = 1;
+    lSent = SOCKETS_SendV( xSocket, xVectors, 1, 0 );
+    TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_EINVAL, lSent, "NULL vector buffer was accepted" );
+    lSent = SOCKETS_SendV( xSocket, NULL, 1, 0 );
+    TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_EINVAL, lSent, "NULL vector array was accepted" );
+
+    /* The vectors arrive as one message. */
+    prvCreateTxData( ( char * ) pucTxBuffer, xMessageLength, 0 );
+    xOffset = 0;
+
+    for( xIndex = 0; xIndex < sizeof( xVectorLengths ) / sizeof( size_t ); xIndex++ )
+    {
+        xVectors[ xIndex ].pvBuffer = &pucTxBuffer[ xOffset ];
+        xVectors[ xIndex ].xLength = xVectorLengths[ xIndex ];
+        xOffset += xVectorLengths[ xIndex ];
+    }
+
+    TEST_ASSERT_EQUAL_MESSAGE( xMessageLength, xOffset, "Vectors do not cover the message" );
+
+    lSent = SOCKETS_SendV( xSocket, xVectors, sizeof( xVectorLengths ) / sizeof( size_t ), 0 );
+    TEST_ASSERT_EQUAL_INT32_MESSAGE( xMessageLength, lSent, "SOCKETS_SendV did not send the whole message" );
+
+    memset( pucRxBuffer, tcptestRX_BUFFER_FILLER, tcptestBUFFER_SIZE );
+    xResult = prvRecvHelper( xSocket, pucRxBuffer, xMessageLength );
+    TEST_ASSERT_EQUAL_INT32_MESSAGE( pdPASS, xResult, "Data was not received \r\n" );
+    xResult = prvCheckRxTxBuffers( pucTxBuffer, pucRxBuffer, xMessageLength );
+    TEST_ASSERT_EQUAL_INT32_MESSAGE( pdPASS, xResult, "Received data differs from sent data" );
+
+    /* Small writes held by the coalescing window arrive in order. */
+    xResult = SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_SEND_COALESCE_WINDOW, &xCoalesceWindow, sizeof( xCoalesceWindow ) );
+    TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Failed to set the coalescing window" );
+
+    prvCreateTxData( ( char * ) pucTxBuffer, xMessageLength, 1 );
+
+    for( xOffset = 0; xOffset < xMessageLength; xOffset += xIndex )
+    {
+        xIndex = ( xMessageLength - xOffset < 10 ) ? ( xMessageLength - xOffset ) : 10;
+        xResult = prvSendHelper( xSocket, &pucTxBuffer[ xOffset ], xIndex );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( pdPASS, xResult, "Data failed to send\r\n" );
+    }
+
+    /* Once the window has passed, SOCKETS_Recv() sends the held data. */
+    vTaskDelay( 4 * xCoalesceWindow );
+
+    memset( pucRxBuffer, tcptestRX_BUFFER_FILLER, tcptestBUFFER_SIZE );
+    xResult = prvRecvHelper( xSocket, pucRxBuffer, xMessageLength );
+    TEST_ASSERT_EQUAL_INT32_MESSAGE( pdPASS, xResult, "Data was not received \r\n" );
+    xResult = prvCheckRxTxBuffers( pucTxBuffer, pucRxBuffer, xMessageLength );
+    TEST_ASSERT_EQUAL_INT32_MESSAGE( pdPASS, xResult, "Received data differs from sent data" );
+
+    xResult = prvShutdownHelper( xSocket );
+    TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket failed to shutdown" );
+
+    xResult = prvCloseHelper( xSocket, &xSocketOpen );
+    TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket failed to close" );
+
+    /* Report Test Results. */
+    tcptestPRINTF( ( "%s passed\r\n", __FUNCTION__ ) );
+}
+
+TEST( Full_TCP, AFQP_SOCKETS_SendV )
+{
+    tcptestPRINTF( ( "Starting %s.\r\n", __FUNCTION__ ) );
+
+    prvSOCKETS_SendV( eNonsecure );
+}
+
+TEST( Full_TCP, AFQP_SECURE_SOCKETS_SendV )
+{
+    tcptestPRINTF( ( "Starting %s.\r\n", __FUNCTION__ ) );
+
+    prvSOCKETS_SendV( eSecure );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSOCKETS_ConnectStep( Server_t xConn )
+{
+    BaseType_t xResult;
+    int32_t lStatus;
+    SocketsSockaddr_t xEchoServerAddress;
+    SocketSet_t xSocketSet;
+    Socket_t xTransportSocket;
+    TickType_t xStartTime;
+    uint8_t * pucTxBuffer = ( uint8_t * ) pcTxBuffer;
+    uint8_t * pucRxBuffer = ( uint8_t * ) pcRxBuffer;
+    const size_t xMessageLength = 100;
+
+    tcptestPRINTF( ( "Starting %s.\r\n", __FUNCTION__ ) );
+
+    xSocketSet = FreeRTOS_CreateSocketSet();
+    TEST_ASSERT_NOT_NULL_MESSAGE( xSocketSet, "Failed to create a socket set" );
+
+    if( TEST_PROTECT() )
+    {
+        xSocket = prvTcpSocketHelper( &xSocketOpen );
+        TEST_ASSERT_NOT_EQUAL_MESSAGE( SOCKETS_INVALID_SOCKET, xSocket, "Socket creation failed" );
+
+        if( xConn == eSecure )
+        {
+            xResult = prvSecureConnectHelper( xSocket, &xEchoServerAddress );
+        }
+        else
+        {
+            xResult = prvNonSecureConnectHelper( xSocket, &xEchoServerAddress );
+        }
+
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Failed to set up the connection" );
+
+        xTransportSocket = ( Socket_t ) SOCKETS_GetTransportSocket( xSocket );
+        TEST_ASSERT_NOT_NULL_MESSAGE( xTransportSocket, "No transport socket" );
+
+        /* Wait for the socket to be ready for whatever the connection needs next. */
+        xStartTime = xTaskGetTickCount();
+        lStatus = SOCKETS_ConnectStart( xSocket, &xEchoServerAddress, sizeof( xEchoServerAddress ) );
+
+        while( ( lStatus > 0 ) && ( ( xTaskGetTickCount() - xStartTime ) < xSendTimeOut ) )
+        {
+            FreeRTOS_FD_CLR( xTransportSocket, xSocketSet, eSELECT_ALL );
+            FreeRTOS_FD_SET( xTransportSocket,
+                             xSocketSet,
+                             ( ( SOCKETS_CONNECT_WANT_READ == lStatus ) ? eSELECT_READ : eSELECT_WRITE ) | eSELECT_EXCEPT );
+            ( void ) FreeRTOS_select( xSocketSet, tcptestLOOP_DELAY );
+
+            lStatus = SOCKETS_ConnectStep( xSocket );
+        }
+
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, lStatus, "Failed to connect" );
+        FreeRTOS_FD_CLR( xTransportSocket, xSocketSet, eSELECT_ALL );
+
+        /* The connection carries data like one made by SOCKETS_Connect(). */
+        xResult = prvSetSockOptHelper( xSocket, xReceiveTimeOut, xSendTimeOut );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Failed to set timeouts" );
+
+        prvCreateTxData( ( char * ) pucTxBuffer, xMessageLength, 0 );
+        xResult = prvSendHelper( xSocket, pucTxBuffer, xMessageLength );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( pdPASS, xResult, "Data failed to send\r\n" );
+
+        memset( pucRxBuffer, tcptestRX_BUFFER_FILLER, tcptestBUFFER_SIZE );
+        xResult = prvRecvHelper( xSocket, pucRxBuffer, xMessageLength );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( pdPASS, xResult, "Data was not received \r\n" );
+        xResult = prvCheckRxTxBuffers( pucTxBuffer, pucRxBuffer, xMessageLength );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( pdPASS, xResult, "Received data differs from sent data" );
+
+        xResult = prvShutdownHelper( xSocket );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket failed to shutdown" );
+
+        xResult = prvCloseHelper( xSocket, &xSocketOpen );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket failed to close" );
+    }
+
+    FreeRTOS_DeleteSocketSet( xSocketSet );
+
+    /* Report Test Results. */
+    tcptestPRINTF( ( "%s passed\r\n", __FUNCTION__ ) );
+}
+
+TEST( Full_TCP, AFQP_SOCKETS_ConnectStep )
+{
+    tcptestPRINTF( ( "Starting %s.\r\n", __FUNCTION__ ) );
+
+    prvSOCKETS_ConnectStep( eNonsecure );
+}
+
+TEST( Full_TCP, AFQP_SECURE_SOCKETS_ConnectStep )
+{
+    tcptestPRINTF( ( "Starting %s.\r\n", __FUNCTION__ ) );
+
+    prvSOCKETS_ConnectStep( eSecure );
+}
+
 /*/ *-----------------------------------------------------------* / */
 
 static void prvSOCKETS_Socket_InvalidInputParams( Server_t xConn )
@@ -137,6 +137,10 @@ static void RunTests( void )
         RUN_TEST_GROUP( Full_DEFENDER );
     #endif
 
+    #if ( testrunnerFULL_RING_QUEUE_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_RING_QUEUE );
+    #endif
+
     #if ( testrunnerFULL_POSIX_ENABLED == 1 )
         RUN_TEST_GROUP( Full_POSIX_CLOCK );
         RUN_TEST_GROUP( Full_POSIX_MQUEUE );
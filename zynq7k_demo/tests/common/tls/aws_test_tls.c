@@ -82,6 +82,7 @@ TEST_GROUP_RUNNER( Full_TLS )
     RUN_TEST_CASE( Full_TLS, AFQP_TLS_ConnectMalformedCert );
     RUN_TEST_CASE( Full_TLS, AFQP_TLS_ConnectUntrustedCert );
     RUN_TEST_CASE( Full_TLS, AFQP_TLS_ConnectBYOCCredentials );
+    RUN_TEST_CASE( Full_TLS, AFQP_TLS_ConnectResumeSession );
 }
 
 /*-----------------------------------------------------------*/
@@ -275,3 +276,39 @@ TEST( Full_TLS, AFQP_TLS_ConnectBYOCCredentials )
                                 );
 }
 /*-----------------------------------------------------------*/
+
+TEST( Full_TLS, AFQP_TLS_ConnectResumeSession )
+{
+    const char * pcAWSIoTAddress = clientcredentialMQTT_BROKER_ENDPOINT;
+    uint16_t usAWSIoTPort = clientcredentialMQTT_BROKER_PORT;
+    SocketsSockaddr_t xMQTTServerAddress = { 0 };
+    Socket_t xSocket;
+    BaseType_t xResult;
+    BaseType_t xConnection;
+
+    xMQTTServerAddress.ulAddress = SOCKETS_GetHostByName( pcAWSIoTAddress );
+    xMQTTServerAddress.usPort = SOCKETS_htons( usAWSIoTPort );
+    xMQTTServerAddress.ucSocketDomain = SOCKETS_AF_INET;
+
+    /* The first connection stores the session, the second one offers it to
+     * the server. Both must succeed, whether or not the server resumes. */
+    for( xConnection = 0; xConnection < 2; xConnection++ )
+    {
+        xSocket = prvSecureSocketCreate();
+
+        if( TEST_PROTECT() )
+        {
+            xResult = SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_SERVER_NAME_INDICATION, pcAWSIoTAddress, 1u + strlen( pcAWSIoTAddress ) );
+            TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket set sock opt server name indication failed" );
+
+            xResult = SOCKETS_Connect( xSocket, &xMQTTServerAddress, sizeof( xMQTTServerAddress ) );
+            TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket connect failed" );
+
+            xResult = SOCKETS_Shutdown( xSocket, SOCKETS_SHUT_RDWR );
+            TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket disconnect failed" );
+        }
+
+        prvSecureSocketClose( xSocket );
+    }
+}
+/*-----------------------------------------------------------*/
@@ -235,6 +235,10 @@ extern uint32_t uxRand();
 /* USE_WIN: Let TCP use windowing mechanism. */
 #define ipconfigUSE_TCP_WIN                            ( 1 )
 
+/* Limit the outstanding TCP data with a congestion window.  The algorithm
+can be changed per socket with FREERTOS_SO_TCP_CONGESTION. */
+#define ipconfigUSE_TCP_CONGESTION_CONTROL             ( 1 )
+
 /* The MTU is the maximum number of bytes the payload of a network frame can
  * contain.  For normal Ethernet V2 frames the maximum MTU is 1500.  Setting a
  * lower value can save RAM, depending on the buffer management scheme used.  If
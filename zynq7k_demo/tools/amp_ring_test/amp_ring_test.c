@@ -0,0 +1,377 @@
+/*
+ * Amazon FreeRTOS AMP Ring V1.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file amp_ring_test.c
+ * @brief Tests the AMP ring on the host.
+ *
+ * The streaming checks run the producer in a child process and the consumer
+ * in the parent.  Each maps the same file separately, so the ring is used at
+ * two different addresses as it is by the two cores.
+ *
+ * Usage: amp_ring_test [records]
+ */
+
+#include "FreeRTOS.h"
+#include "aws_amp_ring.h"
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* Small enough for the streaming checks to fill the ring often. */
+#define testMEMORY_SIZE          4096
+#define testMAX_RECORD_LENGTH    60
+
+/* The consumer of the lossy check sleeps this long every
+ * testSLOW_CONSUMER_PERIOD records, so the producer finds the ring full. */
+#define testSLOW_CONSUMER_US        200
+#define testSLOW_CONSUMER_PERIOD    256
+
+typedef struct TestResult
+{
+    const char * pcName;
+    unsigned long ulCount;
+    int lFailures;
+} TestResult_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Length of a record, from 4 to testMAX_RECORD_LENGTH bytes.
+ */
+static size_t prvRecordLength( uint32_t ulSequence )
+{
+    return sizeof( uint32_t ) + ( ulSequence * 7 ) % ( testMAX_RECORD_LENGTH - sizeof( uint32_t ) + 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A record holds its sequence number followed by a pattern derived
+ * from it.
+ */
+static void prvFillRecord( uint8_t * pucRecord,
+                           uint32_t ulSequence )
+{
+    size_t x;
+
+    memcpy( pucRecord, &ulSequence, sizeof( ulSequence ) );
+
+    for( x = sizeof( ulSequence ); x < prvRecordLength( ulSequence ); x++ )
+    {
+        pucRecord[ x ] = ( uint8_t ) ( ulSequence * 31 + x );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Checks a record read from the ring, and returns its sequence
+ * number.
+ */
+static int prvCheckRecord( const uint8_t * pucRecord,
+                           size_t xLength,
+                           uint32_t * pulSequence )
+{
+    uint8_t ucExpected[ testMAX_RECORD_LENGTH ];
+
+    if( xLength < sizeof( uint32_t ) )
+    {
+        return 1;
+    }
+
+    memcpy( pulSequence, pucRecord, sizeof( uint32_t ) );
+    prvFillRecord( ucExpected, *pulSequence );
+
+    return ( ( xLength != prvRecordLength( *pulSequence ) ) ||
+             ( 0 != memcmp( pucRecord, ucExpected, xLength ) ) ) ? 1 : 0;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Single process checks of the edge cases.
+ */
+static int prvCheckEdges( void )
+{
+    static uint8_t ucMemory[ testMEMORY_SIZE ] __attribute__( ( aligned( ampringCACHE_LINE_SIZE ) ) );
+    uint8_t ucRecord[ testMAX_RECORD_LENGTH ];
+    uint8_t ucLarge[ testMAX_RECORD_LENGTH + 1 ] = { 0 };
+    AmpRing_t xRing;
+    AmpRingShared_t * pxShared = ( AmpRingShared_t * ) ucMemory;
+    size_t xLength;
+    uint32_t ulSequence;
+    uint32_t ul;
+    int lFailures = 0;
+
+    /* Unformatted, and too small. */
+    lFailures += ( pdFAIL != AMP_RingAttach( &xRing, ucMemory, sizeof( ucMemory ) ) );
+    lFailures += ( pdFAIL != AMP_RingFormat( ucMemory, sizeof( AmpRingShared_t ) + 64, testMAX_RECORD_LENGTH ) );
+    lFailures += ( pdPASS != AMP_RingFormat( ucMemory, sizeof( ucMemory ), testMAX_RECORD_LENGTH ) );
+    lFailures += ( pdFAIL != AMP_RingAttach( &xRing, ucMemory, sizeof( AmpRingShared_t ) + 64 ) );
+    lFailures += ( pdPASS != AMP_RingAttach( &xRing, ucMemory, sizeof( ucMemory ) ) );
+
+    /* Empty, too long, and fill to the slot count. */
+    lFailures += ( pdFAIL != AMP_RingRead( &xRing, ucRecord, sizeof( ucRecord ), &xLength ) );
+    lFailures += ( pdFAIL != AMP_RingWrite( &xRing, ucLarge, sizeof( ucLarge ) ) );
+
+    for( ul = 0; ul < pxShared->ulSlotCount; ul++ )
+    {
+        prvFillRecord( ucRecord, ul );
+        lFailures += ( pdPASS != AMP_RingWrite( &xRing, ucRecord, prvRecordLength( ul ) ) );
+    }
+
+    lFailures += ( pdFAIL != AMP_RingWrite( &xRing, ucRecord, sizeof( uint32_t ) ) );
+    lFailures += ( 1 != AMP_RingDropped( &xRing ) );
+
+    /* A short buffer receives the start of the record and its full length. */
+    lFailures += ( pdPASS != AMP_RingRead( &xRing, ucLarge, 2, &xLength ) );
+    lFailures += ( xLength != prvRecordLength( 0 ) ) || ( 0 != ucLarge[ 2 ] );
+
+    for( ul = 1; ul < pxShared->ulSlotCount; ul++ )
+    {
+        lFailures += ( pdPASS != AMP_RingRead( &xRing, ucRecord, sizeof( ucRecord ), &xLength ) );
+        lFailures += prvCheckRecord( ucRecord, xLength, &ulSequence ) || ( ulSequence != ul );
+    }
+
+    lFailures += ( pdFAIL != AMP_RingRead( &xRing, ucRecord, sizeof( ucRecord ), &xLength ) );
+
+    /* The free running indexes wrap. */
+    ( void ) AMP_RingFormat( ucMemory, sizeof( ucMemory ), testMAX_RECORD_LENGTH );
+    pxShared->ulHead = 0xFFFFFFF0UL;
+    pxShared->ulTail = 0xFFFFFFF0UL;
+    lFailures += ( pdPASS != AMP_RingAttach( &xRing, ucMemory, sizeof( ucMemory ) ) );
+
+    for( ul = 0; ul < 64; ul++ )
+    {
+        prvFillRecord( ucRecord, ul );
+        lFailures += ( pdPASS != AMP_RingWrite( &xRing, ucRecord, prvRecordLength( ul ) ) );
+        lFailures += ( pdPASS != AMP_RingRead( &xRing, ucRecord, sizeof( ucRecord ), &xLength ) );
+        lFailures += prvCheckRecord( ucRecord, xLength, &ulSequence ) || ( ulSequence != ul );
+    }
+
+    /* A corrupt geometry is refused. */
+    pxShared->ulSlotCount = 3;
+    lFailures += ( pdFAIL != AMP_RingAttach( &xRing, ucMemory, sizeof( ucMemory ) ) );
+
+    return lFailures;
+}
+
+/*-----------------------------------------------------------*/
+
+static void * prvMap( int lFile )
+{
+    void * pvMemory = mmap( NULL, testMEMORY_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, lFile, 0 );
+
+    if( MAP_FAILED == pvMemory )
+    {
+        perror( "mmap" );
+        exit( 2 );
+    }
+
+    return pvMemory;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Writes ulRecords records.  A lossless producer waits for space, a
+ * lossy one drops records as the sensor node does.
+ */
+static void prvProducer( int lFile,
+                         unsigned long ulRecords,
+                         BaseType_t xLossless )
+{
+    void * pvMemory = prvMap( lFile );
+    uint8_t ucRecord[ testMAX_RECORD_LENGTH ];
+    AmpRing_t xRing;
+    uint32_t ul;
+
+    if( pdPASS != AMP_RingAttach( &xRing, pvMemory, testMEMORY_SIZE ) )
+    {
+        _exit( 1 );
+    }
+
+    for( ul = 0; ul < ulRecords; ul++ )
+    {
+        prvFillRecord( ucRecord, ul );
+
+        while( pdPASS != AMP_RingWrite( &xRing, ucRecord, prvRecordLength( ul ) ) )
+        {
+            sched_yield();
+
+            if( pdFALSE == xLossless )
+            {
+                break;
+            }
+        }
+    }
+
+    _exit( 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Streams ulRecords records from a child process, and checks that
+ * they arrive intact and in order, and that none are lost without being
+ * counted.
+ */
+static int prvCheckStream( unsigned long ulRecords,
+                           BaseType_t xLossless,
+                           unsigned long * pulDropped )
+{
+    char cPath[] = "/tmp/amp_ring_testXXXXXX";
+    uint8_t ucRecord[ testMAX_RECORD_LENGTH ];
+    AmpRing_t xRing;
+    void * pvMemory;
+    unsigned long ulReceived = 0;
+    uint32_t ulSequence = 0;
+    uint32_t ulNext = 0;
+    size_t xLength;
+    int lFile;
+    int lStatus;
+    int lFailures = 0;
+    BaseType_t xProducerDone = pdFALSE;
+    pid_t xProducer;
+
+    lFile = mkstemp( cPath );
+
+    if( ( lFile < 0 ) || ( 0 != ftruncate( lFile, testMEMORY_SIZE ) ) )
+    {
+        perror( "mkstemp" );
+        exit( 2 );
+    }
+
+    ( void ) unlink( cPath );
+
+    /* The consumer formats the ring before the producer starts, as CPU0 does
+     * before it releases CPU1. */
+    pvMemory = prvMap( lFile );
+    ( void ) AMP_RingFormat( pvMemory, testMEMORY_SIZE, testMAX_RECORD_LENGTH );
+    lFailures += ( pdPASS != AMP_RingAttach( &xRing, pvMemory, testMEMORY_SIZE ) );
+
+    xProducer = fork();
+
+    if( 0 == xProducer )
+    {
+        prvProducer( lFile, ulRecords, xLossless );
+    }
+
+    /* Read until the producer has exited and the ring is empty. */
+    for( ; ; )
+    {
+        if( pdPASS == AMP_RingRead( &xRing, ucRecord, sizeof( ucRecord ), &xLength ) )
+        {
+            lFailures += prvCheckRecord( ucRecord, xLength, &ulSequence );
+
+            /* Lossy streams may skip records, but never reorder them. */
+            lFailures += ( ulSequence != ulNext ) && ( ( pdFALSE != xLossless ) || ( ulSequence < ulNext ) );
+            ulNext = ulSequence + 1;
+            ulReceived++;
+
+            if( ( pdFALSE == xLossless ) && ( 0 == ulReceived % testSLOW_CONSUMER_PERIOD ) )
+            {
+                usleep( testSLOW_CONSUMER_US );
+            }
+        }
+        else if( pdFALSE != xProducerDone )
+        {
+            break;
+        }
+        else if( xProducer == waitpid( xProducer, &lStatus, WNOHANG ) )
+        {
+            lFailures += ( !WIFEXITED( lStatus ) || ( 0 != WEXITSTATUS( lStatus ) ) );
+            xProducerDone = pdTRUE;
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+
+    *pulDropped = AMP_RingDropped( &xRing );
+
+    if( pdFALSE == xLossless )
+    {
+        lFailures += ( ulReceived + *pulDropped != ulRecords );
+    }
+    else
+    {
+        lFailures += ( ulReceived != ulRecords );
+    }
+
+    ( void ) munmap( pvMemory, testMEMORY_SIZE );
+    ( void ) close( lFile );
+
+    return lFailures;
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    unsigned long ulRecords = ( argc > 1 ) ? strtoul( argv[ 1 ], NULL, 10 ) : 1000000UL;
+    TestResult_t xResults[ 3 ];
+    unsigned long ulDropped;
+    int lFailures = 0;
+    int l;
+
+    if( 0 == ulRecords )
+    {
+        fprintf( stderr, "usage: %s [records]\n", argv[ 0 ] );
+        return 2;
+    }
+
+    printf( "%lu records, %d byte ring\n\n", ulRecords, testMEMORY_SIZE );
+
+    xResults[ 0 ].pcName = "edge cases";
+    xResults[ 0 ].ulCount = 0;
+    xResults[ 0 ].lFailures = prvCheckEdges();
+
+    xResults[ 1 ].pcName = "lossless stream";
+    xResults[ 1 ].lFailures = prvCheckStream( ulRecords, pdTRUE, &ulDropped );
+    xResults[ 1 ].ulCount = ulRecords;
+
+    /* The dropped count is the interesting number here. */
+    xResults[ 2 ].pcName = "lossy stream, dropped";
+    xResults[ 2 ].lFailures = prvCheckStream( ulRecords, pdFALSE, &ulDropped );
+    xResults[ 2 ].ulCount = ulDropped;
+
+    for( l = 0; l < 3; l++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ l ].pcName, xResults[ l ].ulCount,
+                ( 0 == xResults[ l ].lFailures ) ? "PASS" : "FAIL" );
+        lFailures += xResults[ l ].lFailures;
+    }
+
+    return ( 0 == lFailures ) ? 0 : 1;
+}
@@ -0,0 +1,660 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file arena_test.c
+ * @brief Test and benchmark of arenas on the Linux simulator port.
+ *
+ * Every size must map to the smallest class that holds it, wasting less than a
+ * quarter of the block. Blocks must be aligned, must not overlap, and must
+ * stay within the arena's budget, and an arena that runs out must fail on its
+ * own, leaving another arena and the FreeRTOS heap as they were. A freed block
+ * must be reused for its class, and a larger free block used once the arena
+ * has no memory left to carve. A reset must free everything. Realloc must keep
+ * the contents and calloc must zero the block and refuse an overflowing size.
+ * The statistics must agree with the blocks allocated. Four tasks then
+ * allocate and free random sizes from one arena at once, checking every
+ * block's contents, and the time of an allocation and free is compared with
+ * pvPortMalloc() and vPortFree() on heap_6.c. Built for two cores the tasks
+ * run in parallel.
+ *
+ * Usage: arena_test_<cores>
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "arena.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define arenaTEST_PRIORITY       ( tskIDLE_PRIORITY + 1 )
+
+#define arenaTEST_BUDGET         ( 64 * 1024 )
+
+/* The random workload run by each of the stress tasks. */
+#define arenaSTRESS_TASKS        4
+#define arenaSTRESS_OPERATIONS   200000
+#define arenaSTRESS_SLOTS        64
+#define arenaSTRESS_BUDGET       ( 256 * 1024 )
+
+/* The workload timed for the arena and for the heap. */
+#define arenaBENCHMARK_PAIRS     200000
+#define arenaBENCHMARK_RUNS      5
+
+typedef struct ArenaResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} ArenaResult_t;
+
+enum
+{
+    arenaCLASSES = 0,
+    arenaBLOCKS,
+    arenaISOLATION,
+    arenaREUSE,
+    arenaRESET,
+    arenaREALLOC,
+    arenaSTATISTICS,
+    arenaSTRESS,
+    arenaARENA_NS,
+    arenaHEAP_NS,
+    arenaNUM_RESULTS
+};
+
+static ArenaResult_t xResults[ arenaNUM_RESULTS ] =
+{
+    { "size classes",                0, 0 },
+    { "blocks within budget",        0, 0 },
+    { "arenas isolated",             0, 0 },
+    { "freed blocks reused",         0, 0 },
+    { "reset frees everything",      0, 0 },
+    { "realloc and calloc",          0, 0 },
+    { "statistics",                  0, 0 },
+    { "stress blocks checked",       0, 0 },
+    { "arena malloc and free ns",    0, 0 },
+    { "heap malloc and free ns",     0, 0 }
+};
+
+static uint8_t ucStorage[ arenaTEST_BUDGET ];
+static uint8_t ucOtherStorage[ arenaTEST_BUDGET ];
+static uint8_t ucStressStorage[ arenaSTRESS_BUDGET ];
+
+static ArenaHandle_t xStressArena;
+static volatile uint32_t ulStressTasksDone = 0;
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    /* Only async-signal-safe calls, as this can run in a simulated
+     * interrupt. */
+    lLength = snprintf( cMessage, sizeof( cMessage ), "ASSERT: %s:%lu\n", pcFile, ulLine );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvGetHostNanoseconds( void )
+{
+    struct timespec xNow;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( uint64_t ) xNow.tv_sec * 1000000000ULL + ( uint64_t ) xNow.tv_nsec;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheck( uint32_t ulResult,
+                      BaseType_t xPassed )
+{
+    xResults[ ulResult ].ulCount++;
+
+    if( xPassed == pdFALSE )
+    {
+        xResults[ ulResult ].ulFailures++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* The bytes a block of xSize takes from an arena, from the statistics. */
+static size_t prvBlockBytes( ArenaHandle_t xArena,
+                             size_t xSize )
+{
+    ArenaStats_t xBefore, xAfter;
+    void * pv;
+
+    vArenaGetStats( xArena, &xBefore );
+    pv = pvArenaMalloc( xArena, xSize );
+    vArenaGetStats( xArena, &xAfter );
+    vArenaFree( xArena, pv );
+
+    return ( pv != NULL ) ? xAfter.xBytesInUse - xBefore.xBytesInUse : 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckClasses( void )
+{
+    ArenaHandle_t xArena;
+    size_t xSize, xBytes, xLastBytes = 0;
+
+    /* Each size up to 16 KB, through the bytes the blocks take, resetting the
+     * arena so that each has the whole budget. */
+    xArena = xArenaCreateStatic( "Classes", ucStorage, sizeof( ucStorage ) );
+    configASSERT( xArena != NULL );
+
+    for( xSize = 1; xSize <= 16384; xSize++ )
+    {
+        vArenaReset( xArena );
+        xBytes = prvBlockBytes( xArena, xSize );
+
+        /* The block holds the header and the size, and is a whole number of
+         * alignment units. */
+        prvCheck( arenaCLASSES, ( xBytes >= xSize + portBYTE_ALIGNMENT ) && ( xBytes % portBYTE_ALIGNMENT == 0 ) );
+
+        /* Larger sizes never take smaller blocks, and a new class only starts
+         * where the last is full, so each size is in the smallest class. */
+        prvCheck( arenaCLASSES, ( xBytes == xLastBytes ) || ( xSize + portBYTE_ALIGNMENT > xLastBytes ) );
+        prvCheck( arenaCLASSES, xBytes >= xLastBytes );
+
+        /* Less than a quarter wasted above the linear classes. */
+        if( xBytes > 8 * portBYTE_ALIGNMENT )
+        {
+            prvCheck( arenaCLASSES, ( xBytes - xSize - portBYTE_ALIGNMENT ) * 4 < xBytes );
+        }
+
+        xLastBytes = xBytes;
+    }
+
+    vArenaDelete( xArena );
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvCompareAddresses( const void * pv1,
+                                const void * pv2 )
+{
+    uintptr_t ux1 = *( const uintptr_t * ) pv1, ux2 = *( const uintptr_t * ) pv2;
+
+    return ( ux1 > ux2 ) - ( ux1 < ux2 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckBlocks( void )
+{
+    static uintptr_t uxBlocks[ arenaTEST_BUDGET / 16 ][ 2 ];
+    ArenaHandle_t xArena, xOther;
+    ArenaStats_t xStats, xOtherStats;
+    uint32_t ul, ulBlocks = 0;
+    size_t xSize, xHeapFree;
+    uint8_t * pucBlock;
+    void * pv;
+
+    xHeapFree = xPortGetFreeHeapSize();
+
+    /* Unaligned storage. */
+    xArena = xArenaCreateStatic( "Blocks", &ucStorage[ 3 ], sizeof( ucStorage ) - 3 );
+    xOther = xArenaCreateStatic( "Other", ucOtherStorage, sizeof( ucOtherStorage ) );
+    configASSERT( ( xArena != NULL ) && ( xOther != NULL ) );
+
+    pv = pvArenaMalloc( xOther, 1000 );
+    prvCheck( arenaISOLATION, pv != NULL );
+
+    /* Fill the arena with blocks of many sizes. */
+    for( ul = 0; ; ul++ )
+    {
+        xSize = 1 + ( ul * 37 ) % 700;
+        pucBlock = pvArenaMalloc( xArena, xSize );
+
+        if( pucBlock == NULL )
+        {
+            break;
+        }
+
+        prvCheck( arenaBLOCKS, ( ( uintptr_t ) pucBlock & portBYTE_ALIGNMENT_MASK ) == 0 );
+        prvCheck( arenaBLOCKS, ( pucBlock > &ucStorage[ 3 ] ) && ( pucBlock + xSize <= &ucStorage[ sizeof( ucStorage ) ] ) );
+        memset( pucBlock, 0xa5, xSize );
+        uxBlocks[ ulBlocks ][ 0 ] = ( uintptr_t ) pucBlock;
+        uxBlocks[ ulBlocks ][ 1 ] = xSize;
+        ulBlocks++;
+    }
+
+    /* No block overlaps the next. */
+    qsort( uxBlocks, ulBlocks, sizeof( uxBlocks[ 0 ] ), prvCompareAddresses );
+
+    for( ul = 1; ul < ulBlocks; ul++ )
+    {
+        prvCheck( arenaBLOCKS, uxBlocks[ ul - 1 ][ 0 ] + uxBlocks[ ul - 1 ][ 1 ] < uxBlocks[ ul ][ 0 ] );
+    }
+
+    /* The arena is nearly all used, and failed on its own. */
+    vArenaGetStats( xArena, &xStats );
+    prvCheck( arenaBLOCKS, ( xStats.xBytesCarved <= xStats.xBudget ) && ( xStats.xBudget > sizeof( ucStorage ) - 1024 ) );
+    prvCheck( arenaBLOCKS, xStats.xBytesCarved + 1024 > xStats.xBudget );
+    prvCheck( arenaBLOCKS, ( xStats.ulFailures == 1 ) && ( xStats.ulAllocations == ulBlocks ) && ( xStats.uxBlocksInUse == ulBlocks ) );
+    prvCheck( arenaBLOCKS, pvArenaMalloc( xArena, 0 ) == NULL );
+    prvCheck( arenaBLOCKS, pvArenaMalloc( xArena, ( size_t ) -1 ) == NULL );
+
+    vArenaGetStats( xOther, &xOtherStats );
+    prvCheck( arenaISOLATION, ( xOtherStats.uxBlocksInUse == 1 ) && ( xOtherStats.ulFailures == 0 ) );
+    prvCheck( arenaISOLATION, pvArenaMalloc( xOther, 1000 ) != NULL );
+    prvCheck( arenaISOLATION, xPortGetFreeHeapSize() == xHeapFree );
+
+    /* The contents survived. */
+    for( ul = 0; ul < ulBlocks; ul++ )
+    {
+        pucBlock = ( uint8_t * ) uxBlocks[ ul ][ 0 ];
+        prvCheck( arenaBLOCKS, ( pucBlock[ 0 ] == 0xa5 ) && ( pucBlock[ uxBlocks[ ul ][ 1 ] - 1 ] == 0xa5 ) );
+    }
+
+    vArenaDelete( xArena );
+    vArenaDelete( xOther );
+
+    /* An arena on the heap takes its budget at once and returns it. */
+    xArena = xArenaCreate( "Heap", 10000 );
+    prvCheck( arenaISOLATION, ( xArena != NULL ) && ( xPortGetFreeHeapSize() < xHeapFree - 10000 ) );
+    prvCheck( arenaISOLATION, pvArenaMalloc( xArena, 100 ) != NULL );
+    vArenaDelete( xArena );
+    prvCheck( arenaISOLATION, xPortGetFreeHeapSize() == xHeapFree );
+
+    /* Too small for the bookkeeping. */
+    prvCheck( arenaISOLATION, xArenaCreateStatic( "Small", ucStorage, 64 ) == NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckReuse( void )
+{
+    ArenaHandle_t xArena;
+    ArenaStats_t xStats;
+    void * pv, * pvSecond, * pvLarge;
+    uint32_t ul, ulBlocks;
+
+    xArena = xArenaCreateStatic( "Reuse", ucStorage, sizeof( ucStorage ) );
+    configASSERT( xArena != NULL );
+
+    /* A freed block is the next one its class hands out. */
+    pv = pvArenaMalloc( xArena, 100 );
+    pvSecond = pvArenaMalloc( xArena, 100 );
+    vArenaFree( xArena, pv );
+    prvCheck( arenaREUSE, pvArenaMalloc( xArena, 97 ) == pv );
+    vArenaFree( xArena, pvSecond );
+    vArenaFree( xArena, pv );
+    vArenaGetStats( xArena, &xStats );
+    prvCheck( arenaREUSE, ( xStats.uxBlocksInUse == 0 ) && ( xStats.xBytesInUse == 0 ) );
+
+    /* Freed blocks do not need new memory. */
+    for( ul = 0; ul < 1000; ul++ )
+    {
+        pv = pvArenaMalloc( xArena, 100 );
+        vArenaFree( xArena, pv );
+    }
+
+    vArenaGetStats( xArena, &xStats );
+    prvCheck( arenaREUSE, xStats.xBytesCarved < 512 );
+
+    /* With the arena full of small blocks but for one large free block, a
+     * small allocation takes the large block. */
+    pvLarge = pvArenaMalloc( xArena, 4000 );
+
+    while( pvArenaMalloc( xArena, 24 ) != NULL )
+    {
+    }
+
+    vArenaFree( xArena, pvLarge );
+    pv = pvArenaMalloc( xArena, 24 );
+    prvCheck( arenaREUSE, pv == pvLarge );
+    vArenaFree( xArena, pv );
+    prvCheck( arenaREUSE, pvArenaMalloc( xArena, 3000 ) == pvLarge );
+
+    /* A reset frees everything at once. */
+    vArenaReset( xArena );
+    vArenaGetStats( xArena, &xStats );
+    prvCheck( arenaRESET, ( xStats.uxBlocksInUse == 0 ) && ( xStats.xBytesInUse == 0 ) && ( xStats.xBytesCarved == 0 ) );
+
+    /* The whole budget can be carved again, twice over. */
+    for( ul = 0; ul < 2; ul++ )
+    {
+        ulBlocks = 0;
+
+        while( pvArenaMalloc( xArena, 24 ) != NULL )
+        {
+            ulBlocks++;
+        }
+
+        prvCheck( arenaRESET, ulBlocks == xStats.xBudget / ( 24 + portBYTE_ALIGNMENT ) );
+        vArenaReset( xArena );
+    }
+
+    vArenaDelete( xArena );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckRealloc( void )
+{
+    ArenaHandle_t xArena;
+    ArenaStats_t xStats;
+    uint8_t * pucBlock, * pucMoved;
+    uint32_t ul;
+
+    xArena = xArenaCreateStatic( "Realloc", ucStorage, sizeof( ucStorage ) );
+    configASSERT( xArena != NULL );
+
+    pucBlock = pvArenaRealloc( xArena, NULL, 10 );
+    prvCheck( arenaREALLOC, pucBlock != NULL );
+
+    for( ul = 0; ul < 10; ul++ )
+    {
+        pucBlock[ ul ] = ( uint8_t ) ul;
+    }
+
+    /* Within the class the block stays where it is. */
+    prvCheck( arenaREALLOC, pvArenaRealloc( xArena, pucBlock, 12 ) == pucBlock );
+
+    /* Growing moves it with its contents. */
+    pucMoved = pvArenaRealloc( xArena, pucBlock, 1000 );
+    prvCheck( arenaREALLOC, ( pucMoved != NULL ) && ( pucMoved != pucBlock ) );
+
+    for( ul = 0; ul < 10; ul++ )
+    {
+        prvCheck( arenaREALLOC, pucMoved[ ul ] == ul );
+    }
+
+    /* A failed realloc leaves the block. */
+    prvCheck( arenaREALLOC, pvArenaRealloc( xArena, pucMoved, sizeof( ucStorage ) ) == NULL );
+    prvCheck( arenaREALLOC, pucMoved[ 9 ] == 9 );
+    prvCheck( arenaREALLOC, pvArenaRealloc( xArena, pucMoved, 0 ) == NULL );
+    vArenaGetStats( xArena, &xStats );
+    prvCheck( arenaREALLOC, xStats.uxBlocksInUse == 0 );
+
+    /* Calloc zeroes a reused block, and refuses sizes that overflow. */
+    pucBlock = pvArenaMalloc( xArena, 200 );
+    memset( pucBlock, 0xff, 200 );
+    vArenaFree( xArena, pucBlock );
+    pucMoved = pvArenaCalloc( xArena, 20, 10 );
+    prvCheck( arenaREALLOC, pucMoved == pucBlock );
+
+    for( ul = 0; ul < 200; ul++ )
+    {
+        prvCheck( arenaREALLOC, pucMoved[ ul ] == 0 );
+    }
+
+    prvCheck( arenaREALLOC, pvArenaCalloc( xArena, ( ( size_t ) -1 ) / 2, 4 ) == NULL );
+
+    vArenaDelete( xArena );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckStatistics( void )
+{
+    ArenaHandle_t xFirst, xSecond;
+    ArenaStats_t xStats[ 4 ];
+    void * pv[ 3 ];
+    size_t xBytes;
+
+    xFirst = xArenaCreateStatic( "First", ucStorage, sizeof( ucStorage ) );
+    xSecond = xArenaCreateStatic( "Second", ucOtherStorage, sizeof( ucOtherStorage ) );
+
+    xBytes = prvBlockBytes( xFirst, 100 ) + prvBlockBytes( xFirst, 5000 );
+    pv[ 0 ] = pvArenaMalloc( xFirst, 100 );
+    pv[ 1 ] = pvArenaMalloc( xFirst, 5000 );
+    pv[ 2 ] = pvArenaMalloc( xFirst, 100 );
+    vArenaFree( xFirst, pv[ 2 ] );
+
+    /* Newest first. */
+    prvCheck( arenaSTATISTICS, uxArenaGetSystemState( xStats, 1 ) == 0 );
+    prvCheck( arenaSTATISTICS, uxArenaGetSystemState( xStats, 4 ) == 2 );
+    prvCheck( arenaSTATISTICS, ( strcmp( xStats[ 0 ].pcName, "Second" ) == 0 ) && ( strcmp( xStats[ 1 ].pcName, "First" ) == 0 ) );
+    prvCheck( arenaSTATISTICS, ( xStats[ 1 ].uxBlocksInUse == 2 ) && ( xStats[ 1 ].xBytesInUse == xBytes ) );
+    prvCheck( arenaSTATISTICS, xStats[ 1 ].xMaximumBytesInUse == xBytes + prvBlockBytes( xFirst, 100 ) );
+    prvCheck( arenaSTATISTICS, ( xStats[ 1 ].ulAllocations == 5 ) && ( xStats[ 1 ].ulFailures == 0 ) );
+    prvCheck( arenaSTATISTICS, xStats[ 0 ].xBytesCarved == 0 );
+
+    vArenaDelete( xFirst );
+    prvCheck( arenaSTATISTICS, uxArenaGetSystemState( xStats, 4 ) == 1 );
+    vArenaDelete( xSecond );
+    prvCheck( arenaSTATISTICS, uxArenaGetSystemState( xStats, 4 ) == 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRandom( uint32_t * pulState )
+{
+    *pulState ^= *pulState << 13;
+    *pulState ^= *pulState >> 17;
+    *pulState ^= *pulState << 5;
+
+    return *pulState;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvStressTask( void * pvParameters )
+{
+    uint8_t * pucBlocks[ arenaSTRESS_SLOTS ] = { NULL };
+    uint32_t ulSizes[ arenaSTRESS_SLOTS ];
+    uint32_t ulState = 0x2545f491UL + ( uint32_t ) ( uintptr_t ) pvParameters;
+    uint8_t ucPattern = ( uint8_t ) ( 1 + ( uintptr_t ) pvParameters );
+    uint32_t ul, ulSlot, ulByte;
+
+    for( ul = 0; ul < arenaSTRESS_OPERATIONS; ul++ )
+    {
+        ulSlot = prvRandom( &ulState ) % arenaSTRESS_SLOTS;
+
+        if( pucBlocks[ ulSlot ] != NULL )
+        {
+            for( ulByte = 0; ulByte < ulSizes[ ulSlot ]; ulByte++ )
+            {
+                if( pucBlocks[ ulSlot ][ ulByte ] != ucPattern )
+                {
+                    xResults[ arenaSTRESS ].ulFailures++;
+                    break;
+                }
+            }
+
+            vArenaFree( xStressArena, pucBlocks[ ulSlot ] );
+            pucBlocks[ ulSlot ] = NULL;
+        }
+        else
+        {
+            ulSizes[ ulSlot ] = 1 + prvRandom( &ulState ) % ( ( prvRandom( &ulState ) % 8 == 0 ) ? 2048 : 128 );
+            pucBlocks[ ulSlot ] = pvArenaMalloc( xStressArena, ulSizes[ ulSlot ] );
+
+            if( pucBlocks[ ulSlot ] != NULL )
+            {
+                memset( pucBlocks[ ulSlot ], ucPattern, ulSizes[ ulSlot ] );
+            }
+        }
+    }
+
+    for( ulSlot = 0; ulSlot < arenaSTRESS_SLOTS; ulSlot++ )
+    {
+        vArenaFree( xStressArena, pucBlocks[ ulSlot ] );
+    }
+
+    __atomic_add_fetch( &ulStressTasksDone, 1, __ATOMIC_SEQ_CST );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckStress( void )
+{
+    ArenaStats_t xStats;
+    uint32_t ul;
+
+    xStressArena = xArenaCreateStatic( "Stress", ucStressStorage, sizeof( ucStressStorage ) );
+    configASSERT( xStressArena != NULL );
+
+    for( ul = 0; ul < arenaSTRESS_TASKS; ul++ )
+    {
+        configASSERT( xTaskCreate( prvStressTask, "Stress", configMINIMAL_STACK_SIZE * 2, ( void * ) ( uintptr_t ) ul, arenaTEST_PRIORITY, NULL ) == pdPASS );
+    }
+
+    while( __atomic_load_n( &ulStressTasksDone, __ATOMIC_SEQ_CST ) < arenaSTRESS_TASKS )
+    {
+        vTaskDelay( 10 );
+    }
+
+    /* Every block came back. */
+    vArenaGetStats( xStressArena, &xStats );
+    prvCheck( arenaSTRESS, ( xStats.uxBlocksInUse == 0 ) && ( xStats.xBytesInUse == 0 ) && ( xStats.ulFailures == 0 ) );
+    xResults[ arenaSTRESS ].ulCount = xStats.ulAllocations;
+
+    vArenaDelete( xStressArena );
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvCompareTimes( const void * pv1,
+                            const void * pv2 )
+{
+    uint32_t ul1 = *( const uint32_t * ) pv1, ul2 = *( const uint32_t * ) pv2;
+
+    return ( ul1 > ul2 ) - ( ul1 < ul2 );
+}
+
+/*-----------------------------------------------------------*/
+
+/* The median over several runs of the time to allocate and free a block,
+ * with sixteen blocks of mixed sizes kept allocated. */
+static uint32_t prvMeasure( ArenaHandle_t xArena )
+{
+    void * pvBlocks[ 16 ] = { NULL };
+    uint32_t ulTimes[ arenaBENCHMARK_RUNS ], ulRun, ul, ulState = 1;
+    uint64_t ullStart;
+    size_t xSize;
+
+    for( ulRun = 0; ulRun < arenaBENCHMARK_RUNS; ulRun++ )
+    {
+        ullStart = prvGetHostNanoseconds();
+
+        for( ul = 0; ul < arenaBENCHMARK_PAIRS; ul++ )
+        {
+            xSize = 16 + prvRandom( &ulState ) % 512;
+
+            if( xArena != NULL )
+            {
+                vArenaFree( xArena, pvBlocks[ ul % 16 ] );
+                pvBlocks[ ul % 16 ] = pvArenaMalloc( xArena, xSize );
+            }
+            else
+            {
+                vPortFree( pvBlocks[ ul % 16 ] );
+                pvBlocks[ ul % 16 ] = pvPortMalloc( xSize );
+            }
+        }
+
+        ulTimes[ ulRun ] = ( uint32_t ) ( ( prvGetHostNanoseconds() - ullStart ) / arenaBENCHMARK_PAIRS );
+    }
+
+    for( ul = 0; ul < 16; ul++ )
+    {
+        if( xArena != NULL )
+        {
+            vArenaFree( xArena, pvBlocks[ ul ] );
+        }
+        else
+        {
+            vPortFree( pvBlocks[ ul ] );
+        }
+    }
+
+    qsort( ulTimes, arenaBENCHMARK_RUNS, sizeof( uint32_t ), prvCompareTimes );
+
+    return ulTimes[ arenaBENCHMARK_RUNS / 2 ];
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvMeasureCost( void )
+{
+    ArenaHandle_t xArena;
+
+    xArena = xArenaCreateStatic( "Benchmark", ucStorage, sizeof( ucStorage ) );
+    configASSERT( xArena != NULL );
+
+    xResults[ arenaARENA_NS ].ulCount = prvMeasure( xArena );
+    xResults[ arenaHEAP_NS ].ulCount = prvMeasure( NULL );
+
+    vArenaDelete( xArena );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    prvCheckClasses();
+    prvCheckBlocks();
+    prvCheckReuse();
+    prvCheckRealloc();
+    prvCheckStatistics();
+    prvCheckStress();
+    prvMeasureCost();
+
+    vTaskEndScheduler();
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    uint32_t ul, ulFailures = 0;
+
+    printf( "arenas, %d core%s\n\n", configNUM_CORES, ( configNUM_CORES > 1 ) ? "s" : "" );
+
+    configASSERT( xTaskCreate( prvTestTask, "Test", configMINIMAL_STACK_SIZE * 4, NULL, arenaTEST_PRIORITY, NULL ) == pdPASS );
+
+    vTaskStartScheduler();
+
+    for( ul = 0; ul < arenaNUM_RESULTS; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}
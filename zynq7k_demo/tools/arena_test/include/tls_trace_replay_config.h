@@ -0,0 +1,65 @@
+/*
+ * mbedTLS configuration for the host build of tls_trace_replay: the TLS
+ * options of lib/third_party/mbedtls/include/mbedtls/config.h, without the
+ * hardware and threading hooks of the target, plus the server and the test
+ * certificates for the peer the client talks to.
+ */
+
+#ifndef TLS_TRACE_REPLAY_CONFIG_H
+#define TLS_TRACE_REPLAY_CONFIG_H
+
+/* 32-bit limbs, as on the target, so that numbers take the same memory */
+#define MBEDTLS_HAVE_INT32
+#define MBEDTLS_PLATFORM_MEMORY
+
+#define MBEDTLS_CIPHER_MODE_CBC
+#define MBEDTLS_REMOVE_ARC4_CIPHERSUITES
+#define MBEDTLS_ECP_DP_SECP256R1_ENABLED
+#define MBEDTLS_ECP_NIST_OPTIM
+#define MBEDTLS_KEY_EXCHANGE_ECDHE_RSA_ENABLED
+#define MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED
+#define MBEDTLS_PKCS1_V15
+#define MBEDTLS_SSL_ENCRYPT_THEN_MAC
+#define MBEDTLS_SSL_EXTENDED_MASTER_SECRET
+#define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+#define MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+#define MBEDTLS_SSL_PROTO_TLS1_2
+#define MBEDTLS_SSL_ALPN
+#define MBEDTLS_SSL_SESSION_TICKETS
+#define MBEDTLS_SSL_SERVER_NAME_INDICATION
+#define MBEDTLS_X509_CHECK_KEY_USAGE
+#define MBEDTLS_X509_CHECK_EXTENDED_KEY_USAGE
+
+#define MBEDTLS_AES_C
+#define MBEDTLS_ASN1_PARSE_C
+#define MBEDTLS_ASN1_WRITE_C
+#define MBEDTLS_BASE64_C
+#define MBEDTLS_BIGNUM_C
+#define MBEDTLS_CIPHER_C
+#define MBEDTLS_ECDH_C
+#define MBEDTLS_ECDSA_C
+#define MBEDTLS_ECP_C
+#define MBEDTLS_GCM_C
+#define MBEDTLS_MD_C
+#define MBEDTLS_OID_C
+#define MBEDTLS_PEM_PARSE_C
+#define MBEDTLS_PK_C
+#define MBEDTLS_PK_PARSE_C
+#define MBEDTLS_PLATFORM_C
+#define MBEDTLS_RSA_C
+#define MBEDTLS_SHA1_C
+#define MBEDTLS_SHA256_C
+#define MBEDTLS_SSL_CLI_C
+#define MBEDTLS_SSL_TLS_C
+#define MBEDTLS_X509_USE_C
+#define MBEDTLS_X509_CRT_PARSE_C
+
+#define MBEDTLS_SSL_MAX_CONTENT_LEN    8192
+
+/* Only for the peer */
+#define MBEDTLS_CERTS_C
+#define MBEDTLS_SSL_SRV_C
+
+#include "mbedtls/check_config.h"
+
+#endif /* TLS_TRACE_REPLAY_CONFIG_H */
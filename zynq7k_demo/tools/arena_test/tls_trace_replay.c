@@ -0,0 +1,903 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file tls_trace_replay.c
+ * @brief Replay of the allocations of TLS connections against the budget of
+ * the mbedTLS arena, on the Linux simulator port.
+ *
+ * The allocations the mbedTLS client makes for a connection are recorded
+ * first. The client is set up as aws_tls.c sets it up: the default root
+ * certificates, a device certificate and RSA key, a 512-byte maximum fragment
+ * length, ALPN and the server name, with record buffers that do not come from
+ * the arena. It connects to a server in the same process that presents an
+ * RSA certificate chain and asks for the device certificate, exchanges a few
+ * hundred bytes and closes. Only the client's allocations are recorded, in
+ * three traces: the credentials, which are parsed once and kept, with the
+ * values their RSA contexts cache during the handshake; one connection, from
+ * mbedtls_ssl_config_defaults() to mbedtls_ssl_free(); and the copy of the
+ * session kept for resumption.
+ *
+ * The traces are then replayed into an arena of cryptoconfigARENA_SIZE of
+ * the MicroZed demo: the credentials, a kept session for each session cache
+ * entry, and a connection for each MQTT broker the demo allows, over and over.
+ * The connections first run in lockstep, so that all their handshakes peak at
+ * once, and then staggered. No allocation may fail, and as freed blocks are
+ * not merged, the memory carved into blocks must stop growing once each
+ * connection has run once.
+ *
+ * The host has 64-bit pointers where the target has 32-bit ones, so the
+ * structures recorded are somewhat larger than on the target.
+ *
+ * Usage: tls_trace_replay
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "arena.h"
+
+#include "mbedtls/platform.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/x509_crt.h"
+
+/* certs.h relies on the configuration having been included. */
+#include "mbedtls/certs.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "aws_default_root_certificates.h"
+
+#define traceTEST_PRIORITY       ( tskIDLE_PRIORITY + 1 )
+
+/* cryptoconfigARENA_SIZE, tlsconfigSESSION_CACHE_ENTRIES and
+ * mqttconfigMAX_BROKERS of the MicroZed demo */
+#define traceARENA_SIZE          ( 192 * 1024 )
+#define traceSESSIONS            2U
+#define traceCONNECTIONS         4U
+
+/* Connections replayed by each of them, for each schedule */
+#define traceROUNDS              10U
+
+#define traceMAX_BLOCKS          4096U
+#define traceMAX_EVENTS          131072U
+#define tracePIPE_LENGTH         32768U
+#define traceMAX_HANDSHAKE_ROUNDS    100U
+
+/* Bytes the client sends and receives, about an MQTT CONNECT and CONNACK
+ * and a publish */
+#define traceCLIENT_BYTES        300U
+#define traceSERVER_BYTES        100U
+
+typedef struct TraceResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} TraceResult_t;
+
+enum
+{
+    traceRECORDED = 0,
+    traceKEPT,
+    traceLOCKSTEP,
+    traceSTAGGERED,
+    traceNO_GROWTH,
+    tracePEAK_BYTES,
+    traceCARVED_BYTES,
+    traceNUM_RESULTS
+};
+
+static TraceResult_t xResults[ traceNUM_RESULTS ] =
+{
+    { "connection trace events",      0, 0 },
+    { "kept blocks",                  0, 0 },
+    { "connections in lockstep",      0, 0 },
+    { "connections staggered",        0, 0 },
+    { "no growth after first round",  0, 0 },
+    { "peak bytes in use",            0, 0 },
+    { "bytes carved",                 0, 0 }
+};
+
+typedef enum TracePhase
+{
+    traceNONE = 0,
+    traceCREDENTIALS,
+    traceCONNECTION,
+    traceSESSION,
+    traceNUM_PHASES
+} TracePhase_t;
+
+/* An allocation of ulSize bytes for block ulBlock of a trace, or the release
+ * of the block when ulSize is 0. Numbers of released blocks are reused, so a
+ * trace has no more numbers than it has blocks at once. */
+typedef struct TraceEvent
+{
+    uint32_t ulBlock;
+    uint32_t ulSize;
+} TraceEvent_t;
+
+typedef struct Trace
+{
+    TraceEvent_t xEvents[ traceMAX_EVENTS ];
+    uint32_t ulEvents;
+    uint32_t ulBlocks;
+    uint8_t ucBlockInUse[ traceMAX_BLOCKS ];
+} Trace_t;
+
+/* A block allocated while recording */
+typedef struct TraceBlock
+{
+    void * pvBlock;
+    TracePhase_t xPhase;
+    uint32_t ulBlock;
+} TraceBlock_t;
+
+/* A connection being replayed */
+typedef struct TraceConnection
+{
+    uint32_t ulEvent;
+    uint32_t ulRounds;
+    uint32_t ulDelay;
+    void * pvBlocks[ traceMAX_BLOCKS ];
+} TraceConnection_t;
+
+typedef struct TracePipe
+{
+    unsigned char ucData[ tracePIPE_LENGTH ];
+    size_t xLength;
+} TracePipe_t;
+
+/* One end of the connection */
+typedef struct TraceLink
+{
+    TracePipe_t * pxIncoming;
+    TracePipe_t * pxOutgoing;
+} TraceLink_t;
+
+static TracePhase_t xPhase = traceNONE;
+static Trace_t xTraces[ traceNUM_PHASES ];
+static TraceBlock_t xRecordedBlocks[ traceMAX_BLOCKS ];
+
+static TracePipe_t xToServer, xToClient;
+static TraceLink_t xClientLink = { &xToClient, &xToServer };
+static TraceLink_t xServerLink = { &xToServer, &xToClient };
+
+static uint64_t ullRandomState = 0x9e3779b97f4a7c15ULL;
+
+static uint8_t ucArenaStorage[ traceARENA_SIZE ];
+static void * pvKeptBlocks[ 1U + traceSESSIONS ][ traceMAX_BLOCKS ];
+static TraceConnection_t xConnections[ traceCONNECTIONS ];
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    lLength = snprintf( cMessage, sizeof( cMessage ), "ASSERT: %s:%lu\n", pcFile, ulLine );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    configASSERT( pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheck( uint32_t ulResult,
+                      BaseType_t xPassed )
+{
+    xResults[ ulResult ].ulCount++;
+
+    if( xPassed == pdFALSE )
+    {
+        xResults[ ulResult ].ulFailures++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFatal( const char * pcWhat,
+                      int lError )
+{
+    fprintf( stderr, "%s: -0x%04x\n", pcWhat, ( unsigned int ) -lError );
+    fflush( stderr );
+    _exit( 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvAddEvent( Trace_t * pxTrace,
+                         uint32_t ulBlock,
+                         uint32_t ulSize )
+{
+    if( pxTrace->ulEvents == traceMAX_EVENTS )
+    {
+        prvFatal( "too many events", 0 );
+    }
+
+    pxTrace->xEvents[ pxTrace->ulEvents ].ulBlock = ulBlock;
+    pxTrace->xEvents[ pxTrace->ulEvents ].ulSize = ulSize;
+    pxTrace->ulEvents++;
+}
+
+/*-----------------------------------------------------------*/
+
+/* mbedTLS allocations, recorded in the current phase if there is one. A
+ * release is recorded in the phase of the allocation, unless recording has
+ * stopped, as it has when the kept blocks are freed at the end. */
+static void * prvRecordCalloc( size_t xCount,
+                               size_t xSize )
+{
+    Trace_t * pxTrace;
+    void * pvBlock;
+    uint32_t ul, ulBlock;
+
+    if( ( xCount == 0U ) || ( xSize == 0U ) )
+    {
+        /* As pvArenaCalloc() */
+        return NULL;
+    }
+
+    pvBlock = calloc( xCount, xSize );
+
+    if( ( pvBlock != NULL ) && ( xPhase != traceNONE ) )
+    {
+        pxTrace = &( xTraces[ xPhase ] );
+
+        for( ul = 0; ( ul < traceMAX_BLOCKS ) && ( xRecordedBlocks[ ul ].pvBlock != NULL ); ul++ )
+        {
+        }
+
+        for( ulBlock = 0; ( ulBlock < traceMAX_BLOCKS ) && ( pxTrace->ucBlockInUse[ ulBlock ] != 0U ); ulBlock++ )
+        {
+        }
+
+        if( ( ul == traceMAX_BLOCKS ) || ( ulBlock == traceMAX_BLOCKS ) )
+        {
+            prvFatal( "too many blocks", 0 );
+        }
+
+        pxTrace->ucBlockInUse[ ulBlock ] = 1U;
+
+        if( ulBlock >= pxTrace->ulBlocks )
+        {
+            pxTrace->ulBlocks = ulBlock + 1U;
+        }
+
+        xRecordedBlocks[ ul ].pvBlock = pvBlock;
+        xRecordedBlocks[ ul ].xPhase = xPhase;
+        xRecordedBlocks[ ul ].ulBlock = ulBlock;
+        prvAddEvent( pxTrace, ulBlock, ( uint32_t ) ( xCount * xSize ) );
+    }
+
+    return pvBlock;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvRecordFree( void * pvBlock )
+{
+    Trace_t * pxTrace;
+    uint32_t ul;
+
+    if( pvBlock == NULL )
+    {
+        return;
+    }
+
+    for( ul = 0; ul < traceMAX_BLOCKS; ul++ )
+    {
+        if( xRecordedBlocks[ ul ].pvBlock == pvBlock )
+        {
+            pxTrace = &( xTraces[ xRecordedBlocks[ ul ].xPhase ] );
+
+            if( xPhase != traceNONE )
+            {
+                pxTrace->ucBlockInUse[ xRecordedBlocks[ ul ].ulBlock ] = 0U;
+                prvAddEvent( pxTrace, xRecordedBlocks[ ul ].ulBlock, 0U );
+            }
+
+            xRecordedBlocks[ ul ].pvBlock = NULL;
+            break;
+        }
+    }
+
+    free( pvBlock );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Record buffers come from the FreeRTOS heap on the target. */
+static unsigned char * prvRecordBufferAlloc( void * pvContext,
+                                             size_t xLength )
+{
+    ( void ) pvContext;
+
+    return calloc( 1, xLength );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvRecordBufferFree( void * pvContext,
+                                 unsigned char * pucBuffer,
+                                 size_t xLength )
+{
+    ( void ) pvContext;
+    ( void ) xLength;
+
+    free( pucBuffer );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Deterministic random numbers, so that every run records the same traces. */
+static int prvRandom( void * pvContext,
+                      unsigned char * pucOutput,
+                      size_t xLength )
+{
+    size_t x;
+
+    ( void ) pvContext;
+
+    for( x = 0; x < xLength; x++ )
+    {
+        ullRandomState ^= ullRandomState << 13;
+        ullRandomState ^= ullRandomState >> 7;
+        ullRandomState ^= ullRandomState << 17;
+        pucOutput[ x ] = ( unsigned char ) ullRandomState;
+    }
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvLinkSend( void * pvContext,
+                        const unsigned char * pucBuffer,
+                        size_t xLength )
+{
+    TracePipe_t * pxPipe = ( ( TraceLink_t * ) pvContext )->pxOutgoing;
+
+    if( xLength > sizeof( pxPipe->ucData ) - pxPipe->xLength )
+    {
+        prvFatal( "pipe full", 0 );
+    }
+
+    memcpy( pxPipe->ucData + pxPipe->xLength, pucBuffer, xLength );
+    pxPipe->xLength += xLength;
+
+    return ( int ) xLength;
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvLinkRecv( void * pvContext,
+                        unsigned char * pucBuffer,
+                        size_t xLength )
+{
+    TracePipe_t * pxPipe = ( ( TraceLink_t * ) pvContext )->pxIncoming;
+
+    if( pxPipe->xLength == 0 )
+    {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+
+    if( xLength > pxPipe->xLength )
+    {
+        xLength = pxPipe->xLength;
+    }
+
+    memcpy( pucBuffer, pxPipe->ucData, xLength );
+    memmove( pxPipe->ucData, pxPipe->ucData + xLength, pxPipe->xLength - xLength );
+    pxPipe->xLength -= xLength;
+
+    return ( int ) xLength;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Only the client's calls are recorded. */
+static void prvHandshake( mbedtls_ssl_context * pxClient,
+                          mbedtls_ssl_context * pxServer )
+{
+    uint32_t ulRound;
+    int lResult;
+
+    for( ulRound = 0; ulRound < traceMAX_HANDSHAKE_ROUNDS; ulRound++ )
+    {
+        if( pxClient->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        {
+            xPhase = traceCONNECTION;
+            lResult = mbedtls_ssl_handshake( pxClient );
+            xPhase = traceNONE;
+
+            if( ( lResult != 0 ) && ( lResult != MBEDTLS_ERR_SSL_WANT_READ ) )
+            {
+                prvFatal( "client handshake", lResult );
+            }
+        }
+
+        if( pxServer->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        {
+            lResult = mbedtls_ssl_handshake( pxServer );
+
+            if( ( lResult != 0 ) && ( lResult != MBEDTLS_ERR_SSL_WANT_READ ) )
+            {
+                prvFatal( "server handshake", lResult );
+            }
+        }
+
+        if( ( pxClient->state == MBEDTLS_SSL_HANDSHAKE_OVER ) &&
+            ( pxServer->state == MBEDTLS_SSL_HANDSHAKE_OVER ) )
+        {
+            return;
+        }
+    }
+
+    prvFatal( "handshake did not complete", 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvParseCertificate( mbedtls_x509_crt * pxChain,
+                                 const char * pcPem,
+                                 size_t xLength )
+{
+    int lResult = mbedtls_x509_crt_parse( pxChain, ( const unsigned char * ) pcPem, xLength );
+
+    if( lResult != 0 )
+    {
+        prvFatal( "certificate", lResult );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Blocks the connection leaves allocated belong to the credentials: the
+ * RSA contexts of the keys keep the values they precompute and the blinding
+ * values, which the next connection reuses. Their allocations are moved to
+ * the credentials trace. */
+static void prvMoveKeptBlocks( void )
+{
+    Trace_t * pxConnection = &( xTraces[ traceCONNECTION ] );
+    Trace_t * pxCredentials = &( xTraces[ traceCREDENTIALS ] );
+    uint32_t ulEvent, ulEvents = 0, ulBlock;
+
+    for( ulEvent = 0; ulEvent < pxConnection->ulEvents; ulEvent++ )
+    {
+        ulBlock = pxConnection->xEvents[ ulEvent ].ulBlock;
+
+        if( pxConnection->ucBlockInUse[ ulBlock ] != 0U )
+        {
+            /* The last event of a block that is still in use is its
+             * allocation. */
+            for( ulEvents = ulEvent + 1U;
+                 ( ulEvents < pxConnection->ulEvents ) && ( pxConnection->xEvents[ ulEvents ].ulBlock != ulBlock );
+                 ulEvents++ )
+            {
+            }
+
+            if( ulEvents == pxConnection->ulEvents )
+            {
+                pxConnection->ucBlockInUse[ ulBlock ] = 0U;
+                pxConnection->xEvents[ ulEvent ].ulBlock = pxCredentials->ulBlocks;
+                pxCredentials->ucBlockInUse[ pxCredentials->ulBlocks ] = 1U;
+                pxCredentials->ulBlocks++;
+                prvAddEvent( pxCredentials, pxConnection->xEvents[ ulEvent ].ulBlock,
+                             pxConnection->xEvents[ ulEvent ].ulSize );
+                pxConnection->xEvents[ ulEvent ].ulSize = UINT32_MAX;
+            }
+        }
+    }
+
+    for( ulEvent = 0, ulEvents = 0; ulEvent < pxConnection->ulEvents; ulEvent++ )
+    {
+        if( pxConnection->xEvents[ ulEvent ].ulSize != UINT32_MAX )
+        {
+            pxConnection->xEvents[ ulEvents ] = pxConnection->xEvents[ ulEvent ];
+            ulEvents++;
+        }
+    }
+
+    pxConnection->ulEvents = ulEvents;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Run one TLS connection and record the client's allocations. */
+static void prvRecordTraces( void )
+{
+    static const char * pcAlpn[] = { "x-amzn-mqtt-ca", NULL };
+    mbedtls_x509_crt xRoots, xDevice, xServerChain;
+    mbedtls_pk_context xDeviceKey, xServerKey;
+    mbedtls_ssl_config xClientConfig, xServerConfig;
+    mbedtls_ssl_context xClient, xServer;
+    mbedtls_ssl_session xSession;
+    unsigned char ucData[ traceCLIENT_BYTES ];
+    int lResult;
+
+    ( void ) mbedtls_platform_set_calloc_free( prvRecordCalloc, prvRecordFree );
+
+    mbedtls_x509_crt_init( &xRoots );
+    mbedtls_x509_crt_init( &xDevice );
+    mbedtls_x509_crt_init( &xServerChain );
+    mbedtls_pk_init( &xDeviceKey );
+    mbedtls_pk_init( &xServerKey );
+    mbedtls_ssl_config_init( &xClientConfig );
+    mbedtls_ssl_config_init( &xServerConfig );
+    mbedtls_ssl_init( &xClient );
+    mbedtls_ssl_init( &xServer );
+    mbedtls_ssl_session_init( &xSession );
+
+    /* The credentials, as aws_tls.c and the PKCS #11 module parse them. The
+     * server's test CA is trusted as a fourth root. */
+    xPhase = traceCREDENTIALS;
+    prvParseCertificate( &xRoots, tlsVERISIGN_ROOT_CERTIFICATE_PEM, tlsVERISIGN_ROOT_CERTIFICATE_LENGTH );
+    prvParseCertificate( &xRoots, tlsATS1_ROOT_CERTIFICATE_PEM, tlsATS1_ROOT_CERTIFICATE_LENGTH );
+    prvParseCertificate( &xRoots, tlsSTARFIELD_ROOT_CERTIFICATE_PEM, tlsSTARFIELD_ROOT_CERTIFICATE_LENGTH );
+    prvParseCertificate( &xRoots, mbedtls_test_ca_crt_rsa, mbedtls_test_ca_crt_rsa_len );
+    prvParseCertificate( &xDevice, mbedtls_test_cli_crt_rsa, mbedtls_test_cli_crt_rsa_len );
+    lResult = mbedtls_pk_parse_key( &xDeviceKey, ( const unsigned char * ) mbedtls_test_cli_key_rsa,
+                                    mbedtls_test_cli_key_rsa_len, NULL, 0 );
+    xPhase = traceNONE;
+
+    if( lResult != 0 )
+    {
+        prvFatal( "device key", lResult );
+    }
+
+    /* The server, which is not recorded */
+    prvParseCertificate( &xServerChain, mbedtls_test_srv_crt_rsa, mbedtls_test_srv_crt_rsa_len );
+    prvParseCertificate( &xServerChain, mbedtls_test_ca_crt_rsa, mbedtls_test_ca_crt_rsa_len );
+    lResult = mbedtls_pk_parse_key( &xServerKey, ( const unsigned char * ) mbedtls_test_srv_key_rsa,
+                                    mbedtls_test_srv_key_rsa_len, NULL, 0 );
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_ssl_config_defaults( &xServerConfig, MBEDTLS_SSL_IS_SERVER,
+                                               MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT );
+    }
+
+    if( lResult == 0 )
+    {
+        mbedtls_ssl_conf_rng( &xServerConfig, prvRandom, NULL );
+        mbedtls_ssl_conf_authmode( &xServerConfig, MBEDTLS_SSL_VERIFY_OPTIONAL );
+        mbedtls_ssl_conf_ca_chain( &xServerConfig, xServerChain.next, NULL );
+        lResult = mbedtls_ssl_conf_own_cert( &xServerConfig, &xServerChain, &xServerKey );
+    }
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_ssl_conf_alpn_protocols( &xServerConfig, pcAlpn );
+    }
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_ssl_setup( &xServer, &xServerConfig );
+    }
+
+    if( lResult != 0 )
+    {
+        prvFatal( "server", lResult );
+    }
+
+    mbedtls_ssl_set_bio( &xServer, &xServerLink, prvLinkSend, prvLinkRecv, NULL );
+
+    /* The client, as TLS_Connect() sets it up */
+    xPhase = traceCONNECTION;
+    lResult = mbedtls_ssl_config_defaults( &xClientConfig, MBEDTLS_SSL_IS_CLIENT,
+                                           MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT );
+
+    if( lResult == 0 )
+    {
+        /* The chain is verified as with MBEDTLS_SSL_VERIFY_REQUIRED, but the
+         * SHA-1 signatures of the test certificates do not fail the
+         * handshake. */
+        mbedtls_ssl_conf_authmode( &xClientConfig, MBEDTLS_SSL_VERIFY_OPTIONAL );
+        mbedtls_ssl_conf_rng( &xClientConfig, prvRandom, NULL );
+        mbedtls_ssl_conf_ca_chain( &xClientConfig, &xRoots, NULL );
+        lResult = mbedtls_ssl_conf_own_cert( &xClientConfig, &xDevice, &xDeviceKey );
+    }
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_ssl_conf_max_frag_len( &xClientConfig, MBEDTLS_SSL_MAX_FRAG_LEN_512 );
+    }
+
+    if( lResult == 0 )
+    {
+        mbedtls_ssl_conf_buffer_alloc( &xClientConfig, prvRecordBufferAlloc, prvRecordBufferFree, NULL );
+        lResult = mbedtls_ssl_conf_alpn_protocols( &xClientConfig, pcAlpn );
+    }
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_ssl_setup( &xClient, &xClientConfig );
+    }
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_ssl_set_hostname( &xClient, "localhost" );
+    }
+
+    xPhase = traceNONE;
+
+    if( lResult != 0 )
+    {
+        prvFatal( "client", lResult );
+    }
+
+    mbedtls_ssl_set_bio( &xClient, &xClientLink, prvLinkSend, prvLinkRecv, NULL );
+
+    prvHandshake( &xClient, &xServer );
+
+    /* The session kept for resumption */
+    xPhase = traceSESSION;
+    lResult = mbedtls_ssl_get_session( &xClient, &xSession );
+    xPhase = traceNONE;
+
+    if( lResult != 0 )
+    {
+        prvFatal( "session", lResult );
+    }
+
+    /* Some application data each way */
+    ( void ) prvRandom( NULL, ucData, sizeof( ucData ) );
+    xPhase = traceCONNECTION;
+    lResult = mbedtls_ssl_write( &xClient, ucData, traceCLIENT_BYTES );
+    xPhase = traceNONE;
+
+    if( lResult == ( int ) traceCLIENT_BYTES )
+    {
+        lResult = mbedtls_ssl_read( &xServer, ucData, sizeof( ucData ) );
+    }
+
+    if( lResult > 0 )
+    {
+        lResult = mbedtls_ssl_write( &xServer, ucData, traceSERVER_BYTES );
+    }
+
+    if( lResult == ( int ) traceSERVER_BYTES )
+    {
+        xPhase = traceCONNECTION;
+        lResult = mbedtls_ssl_read( &xClient, ucData, sizeof( ucData ) );
+        xPhase = traceNONE;
+    }
+
+    if( lResult != ( int ) traceSERVER_BYTES )
+    {
+        prvFatal( "application data", lResult );
+    }
+
+    /* The connection is closed as TLS_Cleanup() closes it. */
+    xPhase = traceCONNECTION;
+    ( void ) mbedtls_ssl_close_notify( &xClient );
+    mbedtls_ssl_free( &xClient );
+    mbedtls_ssl_config_free( &xClientConfig );
+    xPhase = traceNONE;
+
+    prvMoveKeptBlocks();
+
+    /* The kept blocks are freed without being recorded. */
+    mbedtls_ssl_session_free( &xSession );
+    mbedtls_x509_crt_free( &xRoots );
+    mbedtls_x509_crt_free( &xDevice );
+    mbedtls_pk_free( &xDeviceKey );
+    mbedtls_ssl_free( &xServer );
+    mbedtls_ssl_config_free( &xServerConfig );
+    mbedtls_x509_crt_free( &xServerChain );
+    mbedtls_pk_free( &xServerKey );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Replay one event, as prvArenaCalloc() and prvArenaFree() of aws_crypto.c
+ * would. Returns pdFALSE if an allocation failed. */
+static BaseType_t prvReplayEvent( ArenaHandle_t xArena,
+                                  void ** ppvBlocks,
+                                  const TraceEvent_t * pxEvent )
+{
+    BaseType_t xReturn = pdTRUE;
+
+    if( pxEvent->ulSize == 0U )
+    {
+        vArenaFree( xArena, ppvBlocks[ pxEvent->ulBlock ] );
+        ppvBlocks[ pxEvent->ulBlock ] = NULL;
+    }
+    else
+    {
+        ppvBlocks[ pxEvent->ulBlock ] = pvArenaCalloc( xArena, 1, pxEvent->ulSize );
+
+        if( ppvBlocks[ pxEvent->ulBlock ] == NULL )
+        {
+            xReturn = pdFALSE;
+        }
+    }
+
+    return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Replay the connection trace traceROUNDS times for each connection, in
+ * turn one event at a time. A connection starts after a delay of ulDelay
+ * events, and a new one starts as soon as the last has been released. */
+static void prvReplayConnections( ArenaHandle_t xArena,
+                                  uint32_t ulStagger,
+                                  uint32_t ulResult )
+{
+    const Trace_t * pxTrace = &( xTraces[ traceCONNECTION ] );
+    TraceConnection_t * pxConnection;
+    ArenaStats_t xStats;
+    size_t xCarvedAfterFirstRound = 0;
+    uint32_t ul, ulTick, ulActive, ulFailures, ulFirstRoundsDone = 0;
+
+    memset( xConnections, 0x00, sizeof( xConnections ) );
+
+    for( ul = 0; ul < traceCONNECTIONS; ul++ )
+    {
+        xConnections[ ul ].ulDelay = ul * ulStagger;
+    }
+
+    for( ulTick = 0, ulActive = traceCONNECTIONS; ulActive > 0U; ulTick++ )
+    {
+        ulActive = 0;
+
+        for( ul = 0; ul < traceCONNECTIONS; ul++ )
+        {
+            pxConnection = &( xConnections[ ul ] );
+
+            if( pxConnection->ulRounds == traceROUNDS )
+            {
+                continue;
+            }
+
+            ulActive++;
+
+            if( ulTick < pxConnection->ulDelay )
+            {
+                continue;
+            }
+
+            ulFailures = xResults[ ulResult ].ulFailures;
+            prvCheck( ulResult, prvReplayEvent( xArena, pxConnection->pvBlocks,
+                                                &( pxTrace->xEvents[ pxConnection->ulEvent ] ) ) );
+
+            /* Only count the connections, and the failed allocations. */
+            xResults[ ulResult ].ulCount--;
+
+            if( xResults[ ulResult ].ulFailures != ulFailures )
+            {
+                fprintf( stderr, "connection %lu: allocation of %lu bytes failed\n", ( unsigned long ) ul,
+                         ( unsigned long ) pxTrace->xEvents[ pxConnection->ulEvent ].ulSize );
+            }
+
+            if( ++( pxConnection->ulEvent ) == pxTrace->ulEvents )
+            {
+                pxConnection->ulEvent = 0;
+                pxConnection->ulRounds++;
+                xResults[ ulResult ].ulCount++;
+
+                if( pxConnection->ulRounds == 1U )
+                {
+                    ulFirstRoundsDone++;
+
+                    if( ulFirstRoundsDone == traceCONNECTIONS )
+                    {
+                        vArenaGetStats( xArena, &xStats );
+                        xCarvedAfterFirstRound = xStats.xBytesCarved;
+                    }
+                }
+            }
+        }
+    }
+
+    vArenaGetStats( xArena, &xStats );
+    prvCheck( traceNO_GROWTH, ( xStats.xBytesCarved == xCarvedAfterFirstRound ) ? pdTRUE : pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void * pvParameters )
+{
+    const Trace_t * pxTrace;
+    ArenaHandle_t xArena;
+    ArenaStats_t xStats;
+    uint32_t ul, ulKept;
+
+    ( void ) pvParameters;
+
+    xArena = xArenaCreateStatic( "mbedTLS", ucArenaStorage, sizeof( ucArenaStorage ) );
+    configASSERT( xArena != NULL );
+
+    /* The credentials once, and a session for each cache entry */
+    for( ul = 0; ul < 1U + traceSESSIONS; ul++ )
+    {
+        pxTrace = &( xTraces[ ( ul == 0U ) ? traceCREDENTIALS : traceSESSION ] );
+
+        for( ulKept = 0; ulKept < pxTrace->ulEvents; ulKept++ )
+        {
+            prvCheck( traceKEPT, prvReplayEvent( xArena, pvKeptBlocks[ ul ], &( pxTrace->xEvents[ ulKept ] ) ) );
+        }
+    }
+
+    vArenaGetStats( xArena, &xStats );
+    xResults[ traceKEPT ].ulCount = ( uint32_t ) xStats.uxBlocksInUse;
+
+    /* All handshakes at once, then spread over the connection */
+    prvReplayConnections( xArena, 0U, traceLOCKSTEP );
+    prvReplayConnections( xArena, xTraces[ traceCONNECTION ].ulEvents / traceCONNECTIONS, traceSTAGGERED );
+
+    vArenaGetStats( xArena, &xStats );
+    xResults[ tracePEAK_BYTES ].ulCount = ( uint32_t ) xStats.xMaximumBytesInUse;
+    xResults[ traceCARVED_BYTES ].ulCount = ( uint32_t ) xStats.xBytesCarved;
+
+    if( xStats.ulFailures != 0U )
+    {
+        xResults[ tracePEAK_BYTES ].ulFailures++;
+    }
+
+    vArenaDelete( xArena );
+
+    vTaskEndScheduler();
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    uint32_t ul, ulFailures = 0;
+
+    prvRecordTraces();
+    xResults[ traceRECORDED ].ulCount = xTraces[ traceCONNECTION ].ulEvents;
+
+    printf( "TLS allocations replayed in a %d KB arena, %u connections\n\n", traceARENA_SIZE / 1024,
+            traceCONNECTIONS );
+
+    configASSERT( xTaskCreate( prvTestTask, "Test", configMINIMAL_STACK_SIZE * 4, NULL, traceTEST_PRIORITY, NULL ) == pdPASS );
+
+    vTaskStartScheduler();
+
+    for( ul = 0; ul < traceNUM_RESULTS; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}
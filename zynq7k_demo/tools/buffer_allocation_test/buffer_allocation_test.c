@@ -0,0 +1,475 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file buffer_allocation_test.c
+ * @brief Test of the network buffer allocation scheme of BufferAllocation_3.c
+ * on the Linux simulator port.
+ *
+ * A request must be served from the smallest size class that can hold it, or
+ * from a bigger class once that one has run out, and every release must give
+ * back both the storage and the descriptor. When the storage of a request runs
+ * out its descriptor must be returned too, and a request with a block time
+ * must wait it out. An interrupt may only take a buffer while more than three
+ * descriptors are free. Releasing a buffer twice must not change the number of
+ * free descriptors, nor hand out a descriptor twice. Two tasks release the
+ * same buffer at the same time, many times over, and only one of the releases
+ * may be counted. Built for two cores the releases run in parallel.
+ *
+ * Usage: buffer_allocation_test
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkBufferManagement.h"
+
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define bufferTEST_PRIORITY          ( tskIDLE_PRIORITY + 1 )
+
+#define bufferDESCRIPTORS            ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS
+
+/* Requests that fit the small, the medium and the large class. */
+#define bufferSMALL_REQUEST          60U
+#define bufferMEDIUM_REQUEST         300U
+#define bufferLARGE_REQUEST          1000U
+
+#define bufferBLOCK_TICKS            5U
+
+/* pxNetworkBufferGetFromISR() leaves this many descriptors for tasks. */
+#define bufferINTERRUPT_THRESHOLD    3U
+
+#define bufferRACE_ROUNDS            50000UL
+
+typedef struct BufferResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} BufferResult_t;
+
+enum
+{
+    bufferSIZE_CLASSES = 0,
+    bufferCLASS_OVERFLOW,
+    bufferEXHAUSTION,
+    bufferINTERRUPT_GET,
+    bufferDOUBLE_RELEASE,
+    bufferRACING_RELEASES,
+    bufferNUM_RESULTS
+};
+
+static BufferResult_t xResults[ bufferNUM_RESULTS ] =
+{
+    { "size classes",                 0, 0 },
+    { "class overflow",               0, 0 },
+    { "exhaustion",                   0, 0 },
+    { "interrupt threshold",          0, 0 },
+    { "double release",               0, 0 },
+    { "racing double releases",       0, 0 }
+};
+
+/* The buffer both tasks of the race release, and the last round each of them
+ * has reached. */
+static NetworkBufferDescriptor_t * volatile pxRaceBuffer = NULL;
+static volatile uint32_t ulRaceRound = 0;
+static volatile uint32_t ulRaceDone = 0;
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    lLength = snprintf( cMessage, sizeof( cMessage ), "ASSERT: %s:%lu\n", pcFile, ulLine );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    configASSERT( pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheck( uint32_t ulResult,
+                      BaseType_t xPassed )
+{
+    xResults[ ulResult ].ulCount++;
+
+    if( xPassed == pdFALSE )
+    {
+        xResults[ ulResult ].ulFailures++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvObtained( UBaseType_t uxPool )
+{
+    NetworkBufferPoolStats_t xStats;
+
+    configASSERT( xGetNetworkBufferPoolStats( uxPool, &xStats ) == pdPASS );
+
+    return xStats.ulObtained;
+}
+
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvFreeStorage( UBaseType_t uxPool )
+{
+    NetworkBufferPoolStats_t xStats;
+
+    configASSERT( xGetNetworkBufferPoolStats( uxPool, &xStats ) == pdPASS );
+
+    return xStats.uxFree;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Checks that all descriptors and all storage are free. */
+static void prvCheckAllFree( uint32_t ulResult )
+{
+    prvCheck( ulResult, ( uxGetNumberOfFreeNetworkBuffers() == bufferDESCRIPTORS ) ? pdTRUE : pdFALSE );
+    prvCheck( ulResult, ( ( prvFreeStorage( 0 ) == ipconfigBUFFER_ALLOC_SMALL_COUNT ) &&
+                          ( prvFreeStorage( 1 ) == ipconfigBUFFER_ALLOC_MEDIUM_COUNT ) &&
+                          ( prvFreeStorage( 2 ) == ipconfigBUFFER_ALLOC_LARGE_COUNT ) ) ? pdTRUE : pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Gets a buffer of xSize bytes, and checks that it came from class uxPool. */
+static NetworkBufferDescriptor_t * prvGetFromPool( size_t xSize,
+                                                   UBaseType_t uxPool,
+                                                   uint32_t ulResult )
+{
+    NetworkBufferDescriptor_t * pxBuffer;
+    uint32_t ulObtained = prvObtained( uxPool );
+
+    pxBuffer = pxGetNetworkBufferWithDescriptor( xSize, 0 );
+    prvCheck( ulResult, ( pxBuffer != NULL ) ? pdTRUE : pdFALSE );
+
+    if( pxBuffer != NULL )
+    {
+        prvCheck( ulResult, ( prvObtained( uxPool ) == ( ulObtained + 1U ) ) ? pdTRUE : pdFALSE );
+        prvCheck( ulResult, ( pxBuffer->xDataLength >= xSize ) ? pdTRUE : pdFALSE );
+
+        /* The storage points back to its descriptor. */
+        prvCheck( ulResult, ( *( ( NetworkBufferDescriptor_t ** ) ( pxBuffer->pucEthernetBuffer - ipBUFFER_PADDING ) ) == pxBuffer ) ? pdTRUE : pdFALSE );
+        memset( pxBuffer->pucEthernetBuffer, 0x5a, xSize );
+    }
+
+    return pxBuffer;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckSizeClasses( void )
+{
+    NetworkBufferDescriptor_t * pxSmall, * pxMedium, * pxLarge;
+
+    prvCheckAllFree( bufferSIZE_CLASSES );
+
+    pxSmall = prvGetFromPool( bufferSMALL_REQUEST, 0, bufferSIZE_CLASSES );
+    pxMedium = prvGetFromPool( bufferMEDIUM_REQUEST, 1, bufferSIZE_CLASSES );
+    pxLarge = prvGetFromPool( bufferLARGE_REQUEST, 2, bufferSIZE_CLASSES );
+    prvCheck( bufferSIZE_CLASSES, ( uxGetNumberOfFreeNetworkBuffers() == ( bufferDESCRIPTORS - 3U ) ) ? pdTRUE : pdFALSE );
+
+    /* Growing a small buffer moves it to a bigger class, with its data. */
+    pxSmall->pucEthernetBuffer[ 0 ] = 0xa5U;
+    pxSmall = pxResizeNetworkBufferWithDescriptor( pxSmall, bufferMEDIUM_REQUEST );
+    prvCheck( bufferSIZE_CLASSES, ( ( pxSmall != NULL ) && ( pxSmall->pucEthernetBuffer[ 0 ] == 0xa5U ) ) ? pdTRUE : pdFALSE );
+    prvCheck( bufferSIZE_CLASSES, ( prvFreeStorage( 0 ) == ipconfigBUFFER_ALLOC_SMALL_COUNT ) ? pdTRUE : pdFALSE );
+
+    vReleaseNetworkBufferAndDescriptor( pxSmall );
+    vReleaseNetworkBufferAndDescriptor( pxMedium );
+    vReleaseNetworkBufferAndDescriptor( pxLarge );
+
+    prvCheckAllFree( bufferSIZE_CLASSES );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckClassOverflow( void )
+{
+    NetworkBufferDescriptor_t * pxBuffers[ bufferDESCRIPTORS ];
+    UBaseType_t ux;
+
+    /* Once the small class has run out, small requests get medium storage,
+     * and then large storage. */
+    for( ux = 0; ux < ipconfigBUFFER_ALLOC_SMALL_COUNT; ux++ )
+    {
+        pxBuffers[ ux ] = prvGetFromPool( bufferSMALL_REQUEST, 0, bufferCLASS_OVERFLOW );
+    }
+
+    for( ux = 0; ux < ipconfigBUFFER_ALLOC_MEDIUM_COUNT; ux++ )
+    {
+        pxBuffers[ ipconfigBUFFER_ALLOC_SMALL_COUNT + ux ] = prvGetFromPool( bufferSMALL_REQUEST, 1, bufferCLASS_OVERFLOW );
+    }
+
+    pxBuffers[ ipconfigBUFFER_ALLOC_SMALL_COUNT + ipconfigBUFFER_ALLOC_MEDIUM_COUNT ] =
+        prvGetFromPool( bufferSMALL_REQUEST, 2, bufferCLASS_OVERFLOW );
+
+    for( ux = 0; ux <= ( ipconfigBUFFER_ALLOC_SMALL_COUNT + ipconfigBUFFER_ALLOC_MEDIUM_COUNT ); ux++ )
+    {
+        vReleaseNetworkBufferAndDescriptor( pxBuffers[ ux ] );
+    }
+
+    prvCheckAllFree( bufferCLASS_OVERFLOW );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckExhaustion( void )
+{
+    NetworkBufferDescriptor_t * pxBuffers[ bufferDESCRIPTORS ];
+    TickType_t xStart;
+    UBaseType_t ux;
+
+    /* Running out of large storage returns the descriptor. */
+    for( ux = 0; ux < ipconfigBUFFER_ALLOC_LARGE_COUNT; ux++ )
+    {
+        pxBuffers[ ux ] = prvGetFromPool( bufferLARGE_REQUEST, 2, bufferEXHAUSTION );
+    }
+
+    prvCheck( bufferEXHAUSTION, ( pxGetNetworkBufferWithDescriptor( bufferLARGE_REQUEST, 0 ) == NULL ) ? pdTRUE : pdFALSE );
+    prvCheck( bufferEXHAUSTION, ( uxGetNumberOfFreeNetworkBuffers() == ( bufferDESCRIPTORS - ipconfigBUFFER_ALLOC_LARGE_COUNT ) ) ? pdTRUE : pdFALSE );
+
+    /* Running out of descriptors, with storage left. */
+    for( ; ux < bufferDESCRIPTORS; ux++ )
+    {
+        pxBuffers[ ux ] = prvGetFromPool( bufferSMALL_REQUEST, 0, bufferEXHAUSTION );
+    }
+
+    prvCheck( bufferEXHAUSTION, ( pxGetNetworkBufferWithDescriptor( bufferSMALL_REQUEST, 0 ) == NULL ) ? pdTRUE : pdFALSE );
+
+    /* A request with a block time waits it out. */
+    xStart = xTaskGetTickCount();
+    prvCheck( bufferEXHAUSTION, ( pxGetNetworkBufferWithDescriptor( bufferSMALL_REQUEST, bufferBLOCK_TICKS ) == NULL ) ? pdTRUE : pdFALSE );
+    prvCheck( bufferEXHAUSTION, ( ( xTaskGetTickCount() - xStart ) >= bufferBLOCK_TICKS ) ? pdTRUE : pdFALSE );
+
+    for( ux = 0; ux < bufferDESCRIPTORS; ux++ )
+    {
+        vReleaseNetworkBufferAndDescriptor( pxBuffers[ ux ] );
+    }
+
+    prvCheckAllFree( bufferEXHAUSTION );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckInterruptGet( void )
+{
+    NetworkBufferDescriptor_t * pxBuffers[ bufferDESCRIPTORS ];
+    NetworkBufferDescriptor_t * pxInterruptBuffer;
+    UBaseType_t ux;
+
+    for( ux = 0; ux < ( bufferDESCRIPTORS - bufferINTERRUPT_THRESHOLD ); ux++ )
+    {
+        pxBuffers[ ux ] = prvGetFromPool( bufferSMALL_REQUEST, ( ux < ipconfigBUFFER_ALLOC_SMALL_COUNT ) ? 0 : 1, bufferINTERRUPT_GET );
+    }
+
+    /* The last descriptors are kept for tasks. */
+    prvCheck( bufferINTERRUPT_GET, ( pxNetworkBufferGetFromISR( bufferSMALL_REQUEST ) == NULL ) ? pdTRUE : pdFALSE );
+
+    vReleaseNetworkBufferAndDescriptor( pxBuffers[ 0 ] );
+    pxInterruptBuffer = pxNetworkBufferGetFromISR( bufferSMALL_REQUEST );
+    prvCheck( bufferINTERRUPT_GET, ( pxInterruptBuffer != NULL ) ? pdTRUE : pdFALSE );
+
+    if( pxInterruptBuffer != NULL )
+    {
+        prvCheck( bufferINTERRUPT_GET, ( vNetworkBufferReleaseFromISR( pxInterruptBuffer ) == pdFALSE ) ? pdTRUE : pdFALSE );
+    }
+
+    for( ux = 1; ux < ( bufferDESCRIPTORS - bufferINTERRUPT_THRESHOLD ); ux++ )
+    {
+        vReleaseNetworkBufferAndDescriptor( pxBuffers[ ux ] );
+    }
+
+    prvCheckAllFree( bufferINTERRUPT_GET );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckDoubleRelease( void )
+{
+    NetworkBufferDescriptor_t * pxBuffers[ bufferDESCRIPTORS ];
+    NetworkBufferDescriptor_t * pxBuffer;
+    UBaseType_t ux, uxOther;
+    BaseType_t xDistinct = pdTRUE;
+
+    pxBuffer = prvGetFromPool( bufferMEDIUM_REQUEST, 1, bufferDOUBLE_RELEASE );
+    vReleaseNetworkBufferAndDescriptor( pxBuffer );
+    prvCheckAllFree( bufferDOUBLE_RELEASE );
+
+    /* The second release is ignored. */
+    vReleaseNetworkBufferAndDescriptor( pxBuffer );
+    prvCheckAllFree( bufferDOUBLE_RELEASE );
+
+    /* Every descriptor is still handed out once. */
+    for( ux = 0; ux < bufferDESCRIPTORS; ux++ )
+    {
+        pxBuffers[ ux ] = pxGetNetworkBufferWithDescriptor( bufferSMALL_REQUEST, 0 );
+        prvCheck( bufferDOUBLE_RELEASE, ( pxBuffers[ ux ] != NULL ) ? pdTRUE : pdFALSE );
+
+        for( uxOther = 0; uxOther < ux; uxOther++ )
+        {
+            if( pxBuffers[ uxOther ] == pxBuffers[ ux ] )
+            {
+                xDistinct = pdFALSE;
+            }
+        }
+    }
+
+    prvCheck( bufferDOUBLE_RELEASE, xDistinct );
+    prvCheck( bufferDOUBLE_RELEASE, ( pxGetNetworkBufferWithDescriptor( bufferSMALL_REQUEST, 0 ) == NULL ) ? pdTRUE : pdFALSE );
+
+    for( ux = 0; ux < bufferDESCRIPTORS; ux++ )
+    {
+        if( pxBuffers[ ux ] != NULL )
+        {
+            vReleaseNetworkBufferAndDescriptor( pxBuffers[ ux ] );
+        }
+    }
+
+    prvCheckAllFree( bufferDOUBLE_RELEASE );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Waits until the variable reaches ulRound. On one core, gives the other
+ * task the chance to get there, and on two, lets a host with fewer CPUs run
+ * the other core. */
+static void prvWaitForRound( volatile uint32_t * pulVariable,
+                             uint32_t ulRound )
+{
+    while( __atomic_load_n( pulVariable, __ATOMIC_ACQUIRE ) != ulRound )
+    {
+        #if ( configNUM_CORES == 1 )
+            taskYIELD();
+        #else
+            ( void ) sched_yield();
+        #endif
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Releases the buffer of each round, at the same time as the test task. */
+static void prvRaceTask( void * pvParameters )
+{
+    uint32_t ulRound;
+
+    ( void ) pvParameters;
+
+    for( ulRound = 1; ulRound <= bufferRACE_ROUNDS; ulRound++ )
+    {
+        prvWaitForRound( &ulRaceRound, ulRound );
+        vReleaseNetworkBufferAndDescriptor( pxRaceBuffer );
+        __atomic_store_n( &ulRaceDone, ulRound, __ATOMIC_RELEASE );
+    }
+
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckRacingReleases( void )
+{
+    uint32_t ulRound;
+
+    configASSERT( xTaskCreate( prvRaceTask, "Race", configMINIMAL_STACK_SIZE, NULL, bufferTEST_PRIORITY, NULL ) == pdPASS );
+
+    for( ulRound = 1; ulRound <= bufferRACE_ROUNDS; ulRound++ )
+    {
+        pxRaceBuffer = pxGetNetworkBufferWithDescriptor( bufferSMALL_REQUEST, 0 );
+        configASSERT( pxRaceBuffer != NULL );
+
+        /* Both tasks release the buffer now. */
+        __atomic_store_n( &ulRaceRound, ulRound, __ATOMIC_RELEASE );
+        vReleaseNetworkBufferAndDescriptor( pxRaceBuffer );
+        prvWaitForRound( &ulRaceDone, ulRound );
+
+        prvCheck( bufferRACING_RELEASES, ( uxGetNumberOfFreeNetworkBuffers() == bufferDESCRIPTORS ) ? pdTRUE : pdFALSE );
+    }
+
+    /* Let the race task be deleted. */
+    vTaskDelay( 10 );
+
+    prvCheckAllFree( bufferRACING_RELEASES );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    configASSERT( xNetworkBuffersInitialise() == pdPASS );
+
+    prvCheckSizeClasses();
+    prvCheckClassOverflow();
+    prvCheckExhaustion();
+    prvCheckInterruptGet();
+    prvCheckDoubleRelease();
+    prvCheckRacingReleases();
+
+    vTaskEndScheduler();
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    uint32_t ul, ulFailures = 0;
+
+    printf( "network buffer allocation, %d core%s\n\n", configNUM_CORES, ( configNUM_CORES > 1 ) ? "s" : "" );
+
+    configASSERT( xTaskCreate( prvTestTask, "Test", configMINIMAL_STACK_SIZE * 4, NULL, bufferTEST_PRIORITY, NULL ) == pdPASS );
+
+    vTaskStartScheduler();
+
+    for( ul = 0; ul < bufferNUM_RESULTS; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}
@@ -0,0 +1,23 @@
+/*
+ * TCP/IP configuration for the network buffer allocation test.  The pools are
+ * small, so that the test can run each of them out.
+ */
+
+#ifndef FREERTOS_IP_CONFIG_H
+#define FREERTOS_IP_CONFIG_H
+
+#define ipconfigHAS_DEBUG_PRINTF                  0
+#define ipconfigHAS_PRINTF                        0
+
+#define ipconfigBYTE_ORDER                        pdFREERTOS_LITTLE_ENDIAN
+
+#define ipconfigNETWORK_MTU                       1500
+#define ipconfigUSE_TCP                           1
+
+#define ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS    8
+#define ipconfigEVENT_QUEUE_LENGTH                ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS + 5 )
+#define ipconfigBUFFER_ALLOC_SMALL_COUNT          4
+#define ipconfigBUFFER_ALLOC_MEDIUM_COUNT         2
+#define ipconfigBUFFER_ALLOC_LARGE_COUNT          6
+
+#endif /* FREERTOS_IP_CONFIG_H */
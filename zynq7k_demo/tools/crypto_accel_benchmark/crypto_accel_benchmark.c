@@ -0,0 +1,313 @@
+/*
+ * Amazon FreeRTOS Crypto V1.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file crypto_accel_benchmark.c
+ * @brief Checks a crypto accelerator provider against known answers and
+ * measures its throughput on the host.
+ *
+ * Usage: crypto_accel_benchmark [iterations] [batch size]
+ */
+
+#include "FreeRTOS.h"
+#include "aws_crypto_accel.h"
+
+#include "mbedtls/ecdsa.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define benchmarkMAX_BATCH_SIZE    64
+#define benchmarkAES_BLOCKS        64
+
+/**
+ * @brief The provider under test.
+ */
+static const CryptoAccelProvider_t * pxProvider = &xCryptoAccelSoftwareProvider;
+
+static uint8_t ucPublicKey[ 64 ];
+static uint8_t ucHash[ 32 ];
+static uint8_t ucSignature[ 64 ];
+static mbedtls_ecdsa_context xEcdsa;
+static mbedtls_mpi xR, xS;
+
+/*-----------------------------------------------------------*/
+
+static int prvRandom( void * pvContext,
+                      unsigned char * pucOutput,
+                      size_t xLength )
+{
+    FILE * pxFile = fopen( "/dev/urandom", "rb" );
+    size_t xRead = 0;
+
+    ( void ) pvContext;
+
+    if( NULL != pxFile )
+    {
+        xRead = fread( pucOutput, 1, xLength, pxFile );
+        fclose( pxFile );
+    }
+
+    return ( xRead == xLength ) ? 0 : -1;
+}
+
+/*-----------------------------------------------------------*/
+
+static double prvSeconds( void )
+{
+    struct timespec xNow;
+
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( double ) xNow.tv_sec + ( double ) xNow.tv_nsec / 1e9;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRunOne( CryptoAccelJob_t * pxJob )
+{
+    CryptoAccelJob_t * pxJobs[ 1 ] = { pxJob };
+
+    pxJob->xStatus = cryptoaccelSTATUS_PENDING;
+    pxProvider->pxProcess( pxJobs, 1 );
+
+    return pxJob->xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvCheck( const char * pcName,
+                     int lPassed )
+{
+    printf( "%-40s %s\n", pcName, lPassed ? "PASS" : "FAIL" );
+
+    return lPassed ? 0 : 1;
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvKnownAnswers( void )
+{
+    static const uint8_t ucSha256Abc[ 32 ] =
+    {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+    };
+    /* FIPS-197 appendix C.1. */
+    static const uint8_t ucAesKey[ 16 ] =
+    {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+    };
+    static const uint8_t ucAesPlain[ 16 ] =
+    {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+    };
+    static const uint8_t ucAesCipher[ 16 ] =
+    {
+        0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+    };
+    uint8_t ucOutput[ 32 ];
+    uint8_t ucBadHash[ 32 ];
+    CryptoAccelJob_t xJob;
+    int lFailures = 0;
+
+    memset( &xJob, 0, sizeof( xJob ) );
+    xJob.eOperation = eCryptoAccelSha256;
+    xJob.pucInput = ( const uint8_t * ) "abc";
+    xJob.xInputLength = 3;
+    xJob.pucOutput = ucOutput;
+    lFailures += prvCheck( "SHA-256 \"abc\"",
+                           ( cryptoaccelSTATUS_OK == prvRunOne( &xJob ) ) &&
+                           ( 0 == memcmp( ucOutput, ucSha256Abc, 32 ) ) );
+
+    memset( &xJob, 0, sizeof( xJob ) );
+    xJob.eOperation = eCryptoAccelAesEcbEncrypt;
+    xJob.pucKey = ucAesKey;
+    xJob.xKeyLength = sizeof( ucAesKey );
+    xJob.pucInput = ucAesPlain;
+    xJob.xInputLength = sizeof( ucAesPlain );
+    xJob.pucOutput = ucOutput;
+    lFailures += prvCheck( "AES-128 ECB FIPS-197",
+                           ( cryptoaccelSTATUS_OK == prvRunOne( &xJob ) ) &&
+                           ( 0 == memcmp( ucOutput, ucAesCipher, 16 ) ) );
+
+    memset( &xJob, 0, sizeof( xJob ) );
+    xJob.eOperation = eCryptoAccelEcdsaP256Verify;
+    xJob.pucKey = ucPublicKey;
+    xJob.xKeyLength = sizeof( ucPublicKey );
+    xJob.pucInput = ucHash;
+    xJob.xInputLength = sizeof( ucHash );
+    xJob.pucSignature = ucSignature;
+    lFailures += prvCheck( "ECDSA P-256 valid signature",
+                           cryptoaccelSTATUS_OK == prvRunOne( &xJob ) );
+
+    memcpy( ucBadHash, ucHash, sizeof( ucBadHash ) );
+    ucBadHash[ 0 ] ^= 0x01;
+    xJob.pucInput = ucBadHash;
+    lFailures += prvCheck( "ECDSA P-256 modified hash",
+                           ( cryptoaccelSTATUS_FAILED == prvRunOne( &xJob ) ) &&
+                           ( 0 != mbedtls_ecdsa_verify( &xEcdsa.grp, ucBadHash, sizeof( ucBadHash ), &xEcdsa.Q, &xR, &xS ) ) );
+
+    return lFailures;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char * pcName,
+                       unsigned long ulOperations,
+                       double xSeconds )
+{
+    printf( "%-40s %10.1f ops/s\n", pcName, ( double ) ulOperations / xSeconds );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvThroughput( CryptoAccelJob_t * pxTemplate,
+                           const char * pcName,
+                           unsigned long ulIterations,
+                           size_t xBatchSize )
+{
+    CryptoAccelJob_t xJobs[ benchmarkMAX_BATCH_SIZE ];
+    CryptoAccelJob_t * pxJobs[ benchmarkMAX_BATCH_SIZE ];
+    unsigned long ulDone = 0;
+    size_t x, xCount;
+    double xStart;
+
+    for( x = 0; x < xBatchSize; x++ )
+    {
+        xJobs[ x ] = *pxTemplate;
+        pxJobs[ x ] = &xJobs[ x ];
+    }
+
+    xStart = prvSeconds();
+
+    while( ulDone < ulIterations )
+    {
+        xCount = xBatchSize;
+
+        if( ( ulIterations - ulDone ) < xCount )
+        {
+            xCount = ulIterations - ulDone;
+        }
+
+        pxProvider->pxProcess( pxJobs, xCount );
+        ulDone += xCount;
+    }
+
+    prvReport( pcName, ulIterations, prvSeconds() - xStart );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    static uint8_t ucBlocks[ 16 * benchmarkAES_BLOCKS ];
+    static uint8_t ucOutput[ 16 * benchmarkAES_BLOCKS ];
+    uint8_t ucPoint[ 65 ];
+    size_t xPointLength = 0;
+    unsigned long ulIterations = ( argc > 1 ) ? strtoul( argv[ 1 ], NULL, 10 ) : 200UL;
+    size_t xBatchSize = ( argc > 2 ) ? strtoul( argv[ 2 ], NULL, 10 ) : 4;
+    CryptoAccelJob_t xJob;
+    unsigned long ul;
+    double xStart;
+    int lFailures;
+
+    if( ( 0 == ulIterations ) || ( 0 == xBatchSize ) || ( xBatchSize > benchmarkMAX_BATCH_SIZE ) )
+    {
+        fprintf( stderr, "usage: %s [iterations] [batch size <= %d]\n", argv[ 0 ], benchmarkMAX_BATCH_SIZE );
+        return 2;
+    }
+
+    if( pdPASS != pxProvider->pxInit() )
+    {
+        fprintf( stderr, "Provider '%s' failed to initialize.\n", pxProvider->pcName );
+        return 1;
+    }
+
+    /* A fresh key and signature for the ECDSA jobs. */
+    mbedtls_ecdsa_init( &xEcdsa );
+    mbedtls_mpi_init( &xR );
+    mbedtls_mpi_init( &xS );
+
+    if( ( 0 != mbedtls_ecdsa_genkey( &xEcdsa, MBEDTLS_ECP_DP_SECP256R1, prvRandom, NULL ) ) ||
+        ( 0 != prvRandom( NULL, ucHash, sizeof( ucHash ) ) ) ||
+        ( 0 != mbedtls_ecdsa_sign( &xEcdsa.grp, &xR, &xS, &xEcdsa.d, ucHash, sizeof( ucHash ), prvRandom, NULL ) ) ||
+        ( 0 != mbedtls_mpi_write_binary( &xR, ucSignature, 32 ) ) ||
+        ( 0 != mbedtls_mpi_write_binary( &xS, &ucSignature[ 32 ], 32 ) ) ||
+        ( 0 != mbedtls_ecp_point_write_binary( &xEcdsa.grp, &xEcdsa.Q, MBEDTLS_ECP_PF_UNCOMPRESSED,
+                                               &xPointLength, ucPoint, sizeof( ucPoint ) ) ) ||
+        ( sizeof( ucPoint ) != xPointLength ) )
+    {
+        fprintf( stderr, "Failed to create the test key.\n" );
+        return 1;
+    }
+
+    memcpy( ucPublicKey, &ucPoint[ 1 ], sizeof( ucPublicKey ) );
+
+    printf( "Provider '%s'\n\n", pxProvider->pcName );
+    lFailures = prvKnownAnswers();
+
+    printf( "\n%lu iterations, batches of %u\n\n", ulIterations, ( unsigned ) xBatchSize );
+
+    /* Baseline: mbedTLS called directly. */
+    xStart = prvSeconds();
+
+    for( ul = 0; ul < ulIterations; ul++ )
+    {
+        ( void ) mbedtls_ecdsa_verify( &xEcdsa.grp, ucHash, sizeof( ucHash ), &xEcdsa.Q, &xR, &xS );
+    }
+
+    prvReport( "mbedtls_ecdsa_verify (P-256)", ulIterations, prvSeconds() - xStart );
+
+    memset( &xJob, 0, sizeof( xJob ) );
+    xJob.eOperation = eCryptoAccelEcdsaP256Verify;
+    xJob.pucKey = ucPublicKey;
+    xJob.xKeyLength = sizeof( ucPublicKey );
+    xJob.pucInput = ucHash;
+    xJob.xInputLength = sizeof( ucHash );
+    xJob.pucSignature = ucSignature;
+    prvThroughput( &xJob, "ECDSA P-256 verify", ulIterations, xBatchSize );
+
+    memset( &xJob, 0, sizeof( xJob ) );
+    xJob.eOperation = eCryptoAccelSha256;
+    xJob.pucInput = ucBlocks;
+    xJob.xInputLength = sizeof( ucBlocks );
+    xJob.pucOutput = ucOutput;
+    prvThroughput( &xJob, "SHA-256 (1 KB)", ulIterations * 100UL, xBatchSize );
+
+    xJob.eOperation = eCryptoAccelAesEcbEncrypt;
+    xJob.pucKey = ucHash;
+    xJob.xKeyLength = 16;
+    prvThroughput( &xJob, "AES-128 ECB (1 KB)", ulIterations * 100UL, xBatchSize );
+
+    mbedtls_ecdsa_free( &xEcdsa );
+    mbedtls_mpi_free( &xR );
+    mbedtls_mpi_free( &xS );
+
+    return ( 0 == lFailures ) ? 0 : 1;
+}
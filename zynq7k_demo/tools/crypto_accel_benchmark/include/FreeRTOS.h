@@ -0,0 +1,20 @@
+/*
+ * Minimal stand-in for FreeRTOS.h, so that kernel independent library code
+ * can be built on the host.
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#define pdFALSE    ( ( BaseType_t ) 0 )
+#define pdTRUE     ( ( BaseType_t ) 1 )
+#define pdPASS     ( pdTRUE )
+#define pdFAIL     ( pdFALSE )
+
+#endif /* INC_FREERTOS_H */
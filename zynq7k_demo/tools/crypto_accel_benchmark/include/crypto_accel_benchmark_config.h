@@ -0,0 +1,28 @@
+/*
+ * mbedTLS configuration for the host build of the crypto benchmarks: only
+ * what the software provider and the reference signing path need.
+ */
+
+#ifndef CRYPTO_ACCEL_BENCHMARK_CONFIG_H
+#define CRYPTO_ACCEL_BENCHMARK_CONFIG_H
+
+#define MBEDTLS_HAVE_ASM
+#define MBEDTLS_ECP_DP_SECP256R1_ENABLED
+#define MBEDTLS_ECP_NIST_OPTIM
+
+#define MBEDTLS_AES_C
+#define MBEDTLS_ASN1_PARSE_C
+#define MBEDTLS_ASN1_WRITE_C
+#define MBEDTLS_BIGNUM_C
+#define MBEDTLS_ECDSA_C
+#define MBEDTLS_ECP_C
+#define MBEDTLS_MD_C
+#define MBEDTLS_OID_C
+#define MBEDTLS_PK_C
+#define MBEDTLS_PK_PARSE_C
+#define MBEDTLS_PK_WRITE_C
+#define MBEDTLS_SHA256_C
+
+#include "mbedtls/check_config.h"
+
+#endif /* CRYPTO_ACCEL_BENCHMARK_CONFIG_H */
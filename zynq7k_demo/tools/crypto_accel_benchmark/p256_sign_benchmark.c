@@ -0,0 +1,228 @@
+/*
+ * Amazon FreeRTOS Crypto V1.0.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file p256_sign_benchmark.c
+ * @brief Checks the P-256 signing engine against mbedTLS and compares the
+ * signing paths of C_Sign on the host.
+ *
+ * Usage: p256_sign_benchmark [iterations]
+ */
+
+#include "FreeRTOS.h"
+#include "aws_crypto_p256.h"
+
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/pk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define benchmarkKEY_DER_MAX    200
+
+/*-----------------------------------------------------------*/
+
+static int prvRandom( void * pvContext,
+                      unsigned char * pucOutput,
+                      size_t xLength )
+{
+    static FILE * pxFile = NULL;
+    size_t xRead = 0;
+
+    ( void ) pvContext;
+
+    if( NULL == pxFile )
+    {
+        pxFile = fopen( "/dev/urandom", "rb" );
+    }
+
+    if( NULL != pxFile )
+    {
+        xRead = fread( pucOutput, 1, xLength, pxFile );
+    }
+
+    return ( xRead == xLength ) ? 0 : -1;
+}
+
+/*-----------------------------------------------------------*/
+
+static double prvSeconds( void )
+{
+    struct timespec xNow;
+
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( double ) xNow.tv_sec + ( double ) xNow.tv_nsec / 1e9;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char * pcName,
+                       unsigned long ulOperations,
+                       double xSeconds,
+                       double xBaseline )
+{
+    double xRate = ( double ) ulOperations / xSeconds;
+
+    printf( "%-44s %9.1f signs/s", pcName, xRate );
+
+    if( xBaseline > 0.0 )
+    {
+        printf( "  x%.1f", xRate / xBaseline );
+    }
+
+    printf( "\n" );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Signs with the engine and verifies with mbedTLS.
+ */
+static int prvCheckSignatures( mbedtls_ecp_keypair * pxKeyPair,
+                               const CryptoP256Key_t * pxKey,
+                               unsigned long ulCount )
+{
+    uint8_t ucHash[ 48 ];
+    uint8_t ucSignature[ 2 * cryptoP256_BYTES ];
+    size_t xHashLength;
+    mbedtls_mpi xR, xS;
+    unsigned long ul;
+    int lFailures = 0;
+
+    mbedtls_mpi_init( &xR );
+    mbedtls_mpi_init( &xS );
+
+    for( ul = 0; ul < ulCount; ul++ )
+    {
+        /* SHA-1, SHA-256 and SHA-384 sizes. */
+        xHashLength = ( ul % 3 == 0 ) ? 20 : ( ( ul % 3 == 1 ) ? 32 : 48 );
+
+        if( ( 0 != prvRandom( NULL, ucHash, xHashLength ) ) ||
+            ( pdPASS != CRYPTO_P256Sign( pxKey, ucHash, xHashLength, ucSignature, prvRandom, NULL ) ) ||
+            ( 0 != mbedtls_mpi_read_binary( &xR, ucSignature, cryptoP256_BYTES ) ) ||
+            ( 0 != mbedtls_mpi_read_binary( &xS, &ucSignature[ cryptoP256_BYTES ], cryptoP256_BYTES ) ) ||
+            ( 0 != mbedtls_ecdsa_verify( &pxKeyPair->grp, ucHash, xHashLength, &pxKeyPair->Q, &xR, &xS ) ) )
+        {
+            lFailures++;
+        }
+    }
+
+    mbedtls_mpi_free( &xR );
+    mbedtls_mpi_free( &xS );
+
+    return lFailures;
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    unsigned long ulIterations = ( argc > 1 ) ? strtoul( argv[ 1 ], NULL, 10 ) : 100UL;
+    mbedtls_pk_context xPk, xParsed;
+    CryptoP256Key_t xKey;
+    uint8_t ucDer[ benchmarkKEY_DER_MAX ];
+    uint8_t ucPrivate[ cryptoP256_BYTES ];
+    uint8_t ucHash[ 32 ];
+    uint8_t ucSignature[ MBEDTLS_ECDSA_MAX_LEN ];
+    size_t xSignatureLength;
+    int lDerLength;
+    int lFailures = 0;
+    unsigned long ul;
+    double xStart, xBaseline;
+
+    if( 0 == ulIterations )
+    {
+        fprintf( stderr, "usage: %s [iterations]\n", argv[ 0 ] );
+        return 2;
+    }
+
+    xStart = prvSeconds();
+    ( void ) CRYPTO_P256Init();
+    printf( "CRYPTO_P256Init: %.2f ms\n\n", ( prvSeconds() - xStart ) * 1e3 );
+
+    /* A device key, stored as DER like the PKCS#11 PAL does. */
+    mbedtls_pk_init( &xPk );
+
+    if( ( 0 != mbedtls_pk_setup( &xPk, mbedtls_pk_info_from_type( MBEDTLS_PK_ECKEY ) ) ) ||
+        ( 0 != mbedtls_ecp_gen_key( MBEDTLS_ECP_DP_SECP256R1, mbedtls_pk_ec( xPk ), prvRandom, NULL ) ) ||
+        ( 0 >= ( lDerLength = mbedtls_pk_write_key_der( &xPk, ucDer, sizeof( ucDer ) ) ) ) ||
+        ( 0 != mbedtls_mpi_write_binary( &mbedtls_pk_ec( xPk )->d, ucPrivate, sizeof( ucPrivate ) ) ) ||
+        ( pdPASS != CRYPTO_P256ImportKey( &xKey, ucPrivate ) ) ||
+        ( 0 != prvRandom( NULL, ucHash, sizeof( ucHash ) ) ) )
+    {
+        fprintf( stderr, "Failed to create the test key.\n" );
+        return 1;
+    }
+
+    /* mbedtls_pk_write_key_der() writes at the end of the buffer. */
+    memmove( ucDer, &ucDer[ sizeof( ucDer ) - lDerLength ], lDerLength );
+
+    lFailures = prvCheckSignatures( mbedtls_pk_ec( xPk ), &xKey, 300 );
+    printf( "%-44s %s\n\n", "Signatures verified by mbedTLS", ( 0 == lFailures ) ? "PASS" : "FAIL" );
+
+    /* The key parsed for every signature, as C_Sign used to. */
+    xStart = prvSeconds();
+
+    for( ul = 0; ul < ulIterations; ul++ )
+    {
+        mbedtls_pk_init( &xParsed );
+        ( void ) mbedtls_pk_parse_key( &xParsed, ucDer, ( size_t ) lDerLength, NULL, 0 );
+        ( void ) mbedtls_pk_sign( &xParsed, MBEDTLS_MD_SHA256, ucHash, sizeof( ucHash ),
+                                  ucSignature, &xSignatureLength, prvRandom, NULL );
+        mbedtls_pk_free( &xParsed );
+    }
+
+    xBaseline = ( double ) ulIterations / ( prvSeconds() - xStart );
+    prvReport( "mbedtls_pk_sign, key parsed per signature", ulIterations, ( double ) ulIterations / xBaseline, 0.0 );
+
+    /* The key resident in the PKCS#11 key cache. */
+    xStart = prvSeconds();
+
+    for( ul = 0; ul < ulIterations; ul++ )
+    {
+        ( void ) mbedtls_pk_sign( &xPk, MBEDTLS_MD_SHA256, ucHash, sizeof( ucHash ),
+                                  ucSignature, &xSignatureLength, prvRandom, NULL );
+    }
+
+    prvReport( "mbedtls_pk_sign, resident key", ulIterations, prvSeconds() - xStart, xBaseline );
+
+    xStart = prvSeconds();
+
+    for( ul = 0; ul < ulIterations; ul++ )
+    {
+        ( void ) CRYPTO_P256Sign( &xKey, ucHash, sizeof( ucHash ), ucSignature, prvRandom, NULL );
+    }
+
+    prvReport( "CRYPTO_P256Sign", ulIterations, prvSeconds() - xStart, xBaseline );
+
+    CRYPTO_P256FreeKey( &xKey );
+    mbedtls_pk_free( &xPk );
+
+    return ( 0 == lFailures ) ? 0 : 1;
+}
@@ -0,0 +1,657 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file dns_resolver_test.c
+ * @brief Test of the asynchronous DNS resolver on the Linux simulator port.
+ *
+ * The IP-task runs against a network interface which hands every DNS query
+ * to the test, which plays the DNS server.  Two lookups of the same name
+ * must share one query, and both callbacks must get the reply.  A query that
+ * is not answered must be sent again with the same identifier, up to
+ * ipconfigDNS_REQUEST_ATTEMPTS times, after which the callback gets a zero
+ * address.  Tasks blocked in FreeRTOS_gethostbyname() must share a query and
+ * return the address from the reply, or zero when there is none.  When the
+ * request can not be stored, FreeRTOS_gethostbyname() must return at once
+ * instead of waiting for a reply that will never be handled.  A name passed
+ * to FreeRTOS_dnsprefetch() must be looked up right away, and again before
+ * its TTL ends, so that the cache always has an address for it.
+ *
+ * Usage: dns_resolver_test
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_ARP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_DNS.h"
+#include "NetworkBufferManagement.h"
+#include "NetworkInterface.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define dnstestPRIORITY            ( tskIDLE_PRIORITY + 1 )
+#define dnstestSTACK_SIZE          ( configMINIMAL_STACK_SIZE * 16 )
+
+#define dnstestDNS_PORT            53U
+#define dnstestMAX_QUERY           128U
+#define dnstestMAX_NAME            64U
+#define dnstestQUERY_QUEUE         16U
+
+/* A lookup must be sent and answered well within one retransmission period. */
+#define dnstestSHORT_WAIT_MS       30U
+
+/* The time after which FreeRTOS_gethostbyname() gives up. */
+#define dnstestBLOCKING_TIMEOUT_MS ( ipconfigDNS_REQUEST_ATTEMPTS * ipconfigDNS_REQUEST_RETRY_TIME_MS )
+
+/* The timeout of asynchronous lookups that are never answered. */
+#define dnstestCALLBACK_TIMEOUT_MS 1000U
+
+/* The TTL of prefetched names.  They are refreshed half-way. */
+#define dnstestPREFETCH_TTL        4U
+
+typedef struct DNSTestResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} DNSTestResult_t;
+
+enum
+{
+    dnstestCOALESCING = 0,
+    dnstestRETRANSMISSION,
+    dnstestBLOCKING,
+    dnstestALLOCATION_FAILURE,
+    dnstestPREFETCH,
+    dnstestNUM_RESULTS
+};
+
+static DNSTestResult_t xResults[ dnstestNUM_RESULTS ] =
+{
+    { "query coalescing",             0, 0 },
+    { "retransmission",               0, 0 },
+    { "blocking waiter",              0, 0 },
+    { "allocation failure",           0, 0 },
+    { "prefetch",                     0, 0 }
+};
+
+/* A query sent by the IP-task, as seen by the DNS server. */
+typedef struct DNSTestQuery
+{
+    TickType_t xTime;
+    uint16_t usIdentifier;
+    uint16_t usSourcePort;
+    size_t uxLength;
+    uint8_t ucPayload[ dnstestMAX_QUERY ];
+    char pcName[ dnstestMAX_NAME ];
+} DNSTestQuery_t;
+
+/* The result of an asynchronous lookup. */
+typedef struct DNSTestLookup
+{
+    volatile BaseType_t xCalled;
+    volatile uint32_t ulIPAddress;
+} DNSTestLookup_t;
+
+/* A task blocked in FreeRTOS_gethostbyname(). */
+typedef struct DNSTestWaiter
+{
+    const char * pcName;
+    uint32_t ulIPAddress;
+    TickType_t xElapsed;
+    SemaphoreHandle_t xDone;
+} DNSTestWaiter_t;
+
+static const uint8_t ucIPAddress[ ipIP_ADDRESS_LENGTH_BYTES ] = { 192, 168, 0, 2 };
+static const uint8_t ucNetMask[ ipIP_ADDRESS_LENGTH_BYTES ] = { 255, 255, 255, 0 };
+static const uint8_t ucServerAddress[ ipIP_ADDRESS_LENGTH_BYTES ] = { 192, 168, 0, 1 };
+static const uint8_t ucMACAddress[ ipMAC_ADDRESS_LENGTH_BYTES ] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+static const MACAddress_t xServerMACAddress = { { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 } };
+
+/* Static, because a callback that is not called in time may still be called
+ * later. */
+static DNSTestLookup_t xLookupFirst, xLookupSecond, xLookupCached, xLookupUnanswered;
+
+static QueueHandle_t xQueries;
+static SemaphoreHandle_t xNetworkUp;
+
+/* When set, pvPortMalloc() fails for xFailTask after it made
+ * uxFailAfter more allocations. */
+static TaskHandle_t xFailTask = NULL;
+static UBaseType_t uxFailAfter = 0;
+
+void * __real_pvPortMalloc( size_t xSize );
+void * __wrap_pvPortMalloc( size_t xSize );
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    lLength = snprintf( cMessage, sizeof( cMessage ), "ASSERT: %s:%lu\n", pcFile, ulLine );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    configASSERT( pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxRand( void )
+{
+    return ( UBaseType_t ) rand();
+}
+
+/*-----------------------------------------------------------*/
+
+void * __wrap_pvPortMalloc( size_t xSize )
+{
+    void * pvReturn = NULL;
+
+    if( ( xFailTask == NULL ) || ( xTaskGetCurrentTaskHandle() != xFailTask ) )
+    {
+        pvReturn = __real_pvPortMalloc( xSize );
+    }
+    else if( uxFailAfter != 0U )
+    {
+        uxFailAfter--;
+        pvReturn = __real_pvPortMalloc( xSize );
+    }
+    else
+    {
+        /* Fail this allocation only. */
+        xFailTask = NULL;
+    }
+
+    return pvReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationIPNetworkEventHook( eIPCallbackEvent_t eNetworkEvent )
+{
+    if( eNetworkEvent == eNetworkUp )
+    {
+        /* The DNS server is known, so that no query waits for ARP. */
+        vARPRefreshCacheEntry( &xServerMACAddress, FreeRTOS_inet_addr_quick( 192, 168, 0, 1 ) );
+        ( void ) xSemaphoreGive( xNetworkUp );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceInitialise( void )
+{
+    return pdPASS;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Reads the dotted name of the first question of a query. */
+static void prvReadName( DNSTestQuery_t * pxQuery )
+{
+    size_t uxIndex = sizeof( uint16_t ) * 6U, uxOut = 0U, uxLabel;
+
+    while( ( uxIndex < pxQuery->uxLength ) && ( pxQuery->ucPayload[ uxIndex ] != 0U ) )
+    {
+        uxLabel = pxQuery->ucPayload[ uxIndex++ ];
+
+        if( uxOut != 0U )
+        {
+            pxQuery->pcName[ uxOut++ ] = '.';
+        }
+
+        while( ( uxLabel-- != 0U ) && ( uxIndex < pxQuery->uxLength ) && ( uxOut < ( dnstestMAX_NAME - 2U ) ) )
+        {
+            pxQuery->pcName[ uxOut++ ] = ( char ) pxQuery->ucPayload[ uxIndex++ ];
+        }
+    }
+
+    pxQuery->pcName[ uxOut ] = '\0';
+}
+
+/*-----------------------------------------------------------*/
+
+/* Called by the IP-task: hands DNS queries to the test, and drops the
+ * rest. */
+BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                    BaseType_t xReleaseAfterSend )
+{
+    const UDPPacket_t * pxPacket = ( const UDPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer;
+    DNSTestQuery_t xQuery;
+
+    if( ( pxNetworkBuffer->xDataLength > sizeof( UDPPacket_t ) ) &&
+        ( pxPacket->xEthernetHeader.usFrameType == ipIPv4_FRAME_TYPE ) &&
+        ( pxPacket->xIPHeader.ucProtocol == ( uint8_t ) ipPROTOCOL_UDP ) &&
+        ( pxPacket->xUDPHeader.usDestinationPort == FreeRTOS_htons( dnstestDNS_PORT ) ) )
+    {
+        memset( &xQuery, 0, sizeof( xQuery ) );
+        xQuery.xTime = xTaskGetTickCount();
+        xQuery.usSourcePort = pxPacket->xUDPHeader.usSourcePort;
+        xQuery.uxLength = pxNetworkBuffer->xDataLength - sizeof( UDPPacket_t );
+
+        if( xQuery.uxLength > dnstestMAX_QUERY )
+        {
+            xQuery.uxLength = dnstestMAX_QUERY;
+        }
+
+        memcpy( xQuery.ucPayload, &( pxNetworkBuffer->pucEthernetBuffer[ sizeof( UDPPacket_t ) ] ), xQuery.uxLength );
+        xQuery.usIdentifier = ( uint16_t ) ( ( xQuery.ucPayload[ 0 ] << 8 ) | xQuery.ucPayload[ 1 ] );
+        prvReadName( &xQuery );
+
+        configASSERT( xQueueSend( xQueries, &xQuery, 0 ) == pdPASS );
+    }
+
+    if( xReleaseAfterSend != pdFALSE )
+    {
+        vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+    }
+
+    return pdPASS;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheck( uint32_t ulResult,
+                      BaseType_t xPassed )
+{
+    xResults[ ulResult ].ulCount++;
+
+    if( xPassed == pdFALSE )
+    {
+        xResults[ ulResult ].ulFailures++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Waits up to ulWaitMs for the next query. */
+static BaseType_t prvNextQuery( DNSTestQuery_t * pxQuery,
+                                uint32_t ulWaitMs )
+{
+    return xQueueReceive( xQueries, pxQuery, pdMS_TO_TICKS( ulWaitMs ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Drops the queries that are still queued, after ulWaitMs. */
+static void prvDrainQueries( uint32_t ulWaitMs )
+{
+    DNSTestQuery_t xQuery;
+
+    vTaskDelay( pdMS_TO_TICKS( ulWaitMs ) );
+
+    while( xQueueReceive( xQueries, &xQuery, 0 ) == pdPASS )
+    {
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Sends the server's answer to pxQuery: one A record for ulIPAddress. */
+static void prvReply( const DNSTestQuery_t * pxQuery,
+                      uint32_t ulIPAddress,
+                      uint32_t ulTTL )
+{
+    NetworkBufferDescriptor_t * pxBuffer;
+    UDPPacket_t * pxPacket;
+    IPStackEvent_t xRxEvent;
+    uint8_t * pucPayload;
+    size_t uxPayload, uxLength;
+
+    /* The header and question of the query, followed by the answer. */
+    uxPayload = pxQuery->uxLength + 16U;
+    uxLength = sizeof( UDPPacket_t ) + uxPayload;
+
+    pxBuffer = pxGetNetworkBufferWithDescriptor( uxLength, pdMS_TO_TICKS( 100U ) );
+    configASSERT( pxBuffer != NULL );
+    pxBuffer->xDataLength = uxLength;
+
+    pxPacket = ( UDPPacket_t * ) pxBuffer->pucEthernetBuffer;
+    memset( pxPacket, 0, sizeof( *pxPacket ) );
+    memcpy( pxPacket->xEthernetHeader.xDestinationAddress.ucBytes, ucMACAddress, ipMAC_ADDRESS_LENGTH_BYTES );
+    memcpy( pxPacket->xEthernetHeader.xSourceAddress.ucBytes, xServerMACAddress.ucBytes, ipMAC_ADDRESS_LENGTH_BYTES );
+    pxPacket->xEthernetHeader.usFrameType = ipIPv4_FRAME_TYPE;
+
+    pxPacket->xIPHeader.ucVersionHeaderLength = 0x45U;
+    pxPacket->xIPHeader.usLength = FreeRTOS_htons( ( uint16_t ) ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_UDP_HEADER + uxPayload ) );
+    pxPacket->xIPHeader.ucTimeToLive = 64U;
+    pxPacket->xIPHeader.ucProtocol = ( uint8_t ) ipPROTOCOL_UDP;
+    pxPacket->xIPHeader.ulSourceIPAddress = FreeRTOS_inet_addr_quick( 192, 168, 0, 1 );
+    pxPacket->xIPHeader.ulDestinationIPAddress = FreeRTOS_inet_addr_quick( 192, 168, 0, 2 );
+
+    pxPacket->xUDPHeader.usSourcePort = FreeRTOS_htons( dnstestDNS_PORT );
+    pxPacket->xUDPHeader.usDestinationPort = pxQuery->usSourcePort;
+    pxPacket->xUDPHeader.usLength = FreeRTOS_htons( ( uint16_t ) ( ipSIZE_OF_UDP_HEADER + uxPayload ) );
+
+    pucPayload = &( pxBuffer->pucEthernetBuffer[ sizeof( UDPPacket_t ) ] );
+    memcpy( pucPayload, pxQuery->ucPayload, pxQuery->uxLength );
+
+    /* A response without errors, with one answer. */
+    pucPayload[ 2 ] = 0x81U;
+    pucPayload[ 3 ] = 0x80U;
+    pucPayload[ 6 ] = 0x00U;
+    pucPayload[ 7 ] = 0x01U;
+
+    /* A pointer to the name in the question, type A, class IN, the TTL and
+     * the address. */
+    pucPayload += pxQuery->uxLength;
+    pucPayload[ 0 ] = 0xc0U;
+    pucPayload[ 1 ] = 0x0cU;
+    pucPayload[ 2 ] = 0x00U;
+    pucPayload[ 3 ] = 0x01U;
+    pucPayload[ 4 ] = 0x00U;
+    pucPayload[ 5 ] = 0x01U;
+    pucPayload[ 6 ] = ( uint8_t ) ( ulTTL >> 24 );
+    pucPayload[ 7 ] = ( uint8_t ) ( ulTTL >> 16 );
+    pucPayload[ 8 ] = ( uint8_t ) ( ulTTL >> 8 );
+    pucPayload[ 9 ] = ( uint8_t ) ulTTL;
+    pucPayload[ 10 ] = 0x00U;
+    pucPayload[ 11 ] = 0x04U;
+    memcpy( &( pucPayload[ 12 ] ), &ulIPAddress, sizeof( ulIPAddress ) );
+
+    xRxEvent.eEventType = eNetworkRxEvent;
+    xRxEvent.pvData = ( void * ) pxBuffer;
+    configASSERT( xSendEventStructToIPTask( &xRxEvent, pdMS_TO_TICKS( 100U ) ) == pdPASS );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvLookupCallback( const char * pcName,
+                               void * pvSearchID,
+                               uint32_t ulIPAddress )
+{
+    DNSTestLookup_t * pxLookup = ( DNSTestLookup_t * ) pvSearchID;
+
+    ( void ) pcName;
+    pxLookup->ulIPAddress = ulIPAddress;
+    pxLookup->xCalled = pdTRUE;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvWaiterTask( void * pvParameters )
+{
+    DNSTestWaiter_t * pxWaiter = ( DNSTestWaiter_t * ) pvParameters;
+    TickType_t xStart = xTaskGetTickCount();
+
+    pxWaiter->ulIPAddress = FreeRTOS_gethostbyname( pxWaiter->pcName );
+    pxWaiter->xElapsed = xTaskGetTickCount() - xStart;
+    ( void ) xSemaphoreGive( pxWaiter->xDone );
+
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvStartWaiter( DNSTestWaiter_t * pxWaiter,
+                            const char * pcName )
+{
+    memset( pxWaiter, 0, sizeof( *pxWaiter ) );
+    pxWaiter->pcName = pcName;
+    pxWaiter->xDone = xSemaphoreCreateBinary();
+    configASSERT( pxWaiter->xDone != NULL );
+    configASSERT( xTaskCreate( prvWaiterTask, "Waiter", dnstestSTACK_SIZE, pxWaiter, dnstestPRIORITY, NULL ) == pdPASS );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Waits for a waiter task to return, and frees its semaphore. */
+static BaseType_t prvWaiterDone( DNSTestWaiter_t * pxWaiter,
+                                 uint32_t ulWaitMs )
+{
+    BaseType_t xReturn = xSemaphoreTake( pxWaiter->xDone, pdMS_TO_TICKS( ulWaitMs ) );
+
+    if( xReturn != pdFALSE )
+    {
+        vSemaphoreDelete( pxWaiter->xDone );
+    }
+
+    return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Two asynchronous lookups of the same name share one query. */
+static void prvCheckCoalescing( void )
+{
+    const uint32_t ulAddress = FreeRTOS_inet_addr_quick( 10, 0, 0, 1 );
+    DNSTestQuery_t xQuery, xOther;
+
+    prvCheck( dnstestCOALESCING, ( FreeRTOS_gethostbyname_a( "one.example.com", prvLookupCallback, &xLookupFirst, dnstestCALLBACK_TIMEOUT_MS ) == 0U ) ? pdTRUE : pdFALSE );
+    prvCheck( dnstestCOALESCING, ( FreeRTOS_gethostbyname_a( "one.example.com", prvLookupCallback, &xLookupSecond, dnstestCALLBACK_TIMEOUT_MS ) == 0U ) ? pdTRUE : pdFALSE );
+
+    prvCheck( dnstestCOALESCING, prvNextQuery( &xQuery, dnstestSHORT_WAIT_MS ) );
+    prvCheck( dnstestCOALESCING, ( strcmp( xQuery.pcName, "one.example.com" ) == 0 ) ? pdTRUE : pdFALSE );
+    prvCheck( dnstestCOALESCING, ( prvNextQuery( &xOther, dnstestSHORT_WAIT_MS ) == pdFALSE ) ? pdTRUE : pdFALSE );
+
+    prvReply( &xQuery, ulAddress, 60U );
+    vTaskDelay( pdMS_TO_TICKS( dnstestSHORT_WAIT_MS ) );
+
+    prvCheck( dnstestCOALESCING, ( ( xLookupFirst.xCalled != pdFALSE ) && ( xLookupFirst.ulIPAddress == ulAddress ) ) ? pdTRUE : pdFALSE );
+    prvCheck( dnstestCOALESCING, ( ( xLookupSecond.xCalled != pdFALSE ) && ( xLookupSecond.ulIPAddress == ulAddress ) ) ? pdTRUE : pdFALSE );
+
+    /* The reply went to the cache, which answers at once. */
+    prvCheck( dnstestCOALESCING, ( FreeRTOS_gethostbyname_a( "one.example.com", prvLookupCallback, &xLookupCached, dnstestCALLBACK_TIMEOUT_MS ) == ulAddress ) ? pdTRUE : pdFALSE );
+    prvCheck( dnstestCOALESCING, ( ( xLookupCached.xCalled != pdFALSE ) && ( xLookupCached.ulIPAddress == ulAddress ) ) ? pdTRUE : pdFALSE );
+    prvCheck( dnstestCOALESCING, ( prvNextQuery( &xOther, dnstestSHORT_WAIT_MS ) == pdFALSE ) ? pdTRUE : pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+/* A query that is not answered is sent again with the same identifier, and
+ * the callback gets a zero address when the lookup times out. */
+static void prvCheckRetransmission( void )
+{
+    DNSTestQuery_t xFirst, xQuery;
+    TickType_t xPrevious;
+    UBaseType_t uxAttempts = 1U;
+
+    ( void ) FreeRTOS_gethostbyname_a( "two.example.com", prvLookupCallback, &xLookupUnanswered, dnstestCALLBACK_TIMEOUT_MS );
+
+    prvCheck( dnstestRETRANSMISSION, prvNextQuery( &xFirst, dnstestSHORT_WAIT_MS ) );
+    xPrevious = xFirst.xTime;
+
+    while( prvNextQuery( &xQuery, 2U * ipconfigDNS_REQUEST_RETRY_TIME_MS ) != pdFALSE )
+    {
+        uxAttempts++;
+        prvCheck( dnstestRETRANSMISSION, ( xQuery.usIdentifier == xFirst.usIdentifier ) ? pdTRUE : pdFALSE );
+        prvCheck( dnstestRETRANSMISSION, ( strcmp( xQuery.pcName, "two.example.com" ) == 0 ) ? pdTRUE : pdFALSE );
+
+        /* Not sent again before the retransmission time. */
+        prvCheck( dnstestRETRANSMISSION, ( ( xQuery.xTime - xPrevious ) >= pdMS_TO_TICKS( ipconfigDNS_REQUEST_RETRY_TIME_MS ) ) ? pdTRUE : pdFALSE );
+        xPrevious = xQuery.xTime;
+    }
+
+    prvCheck( dnstestRETRANSMISSION, ( uxAttempts == ipconfigDNS_REQUEST_ATTEMPTS ) ? pdTRUE : pdFALSE );
+
+    /* The callback is called once the lookup times out, and not before. */
+    prvCheck( dnstestRETRANSMISSION, ( xLookupUnanswered.xCalled == pdFALSE ) ? pdTRUE : pdFALSE );
+    vTaskDelay( pdMS_TO_TICKS( dnstestCALLBACK_TIMEOUT_MS ) );
+    prvCheck( dnstestRETRANSMISSION, ( ( xLookupUnanswered.xCalled != pdFALSE ) && ( xLookupUnanswered.ulIPAddress == 0U ) ) ? pdTRUE : pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Blocked tasks share a query, and give up after the last attempt. */
+static void prvCheckBlockingWaiter( void )
+{
+    const uint32_t ulAddress = FreeRTOS_inet_addr_quick( 10, 0, 0, 3 );
+    DNSTestWaiter_t xFirst, xSecond, xUnanswered;
+    DNSTestQuery_t xQuery, xOther;
+
+    prvStartWaiter( &xFirst, "three.example.com" );
+    prvStartWaiter( &xSecond, "three.example.com" );
+
+    prvCheck( dnstestBLOCKING, prvNextQuery( &xQuery, dnstestSHORT_WAIT_MS ) );
+    prvCheck( dnstestBLOCKING, ( prvNextQuery( &xOther, dnstestSHORT_WAIT_MS ) == pdFALSE ) ? pdTRUE : pdFALSE );
+
+    prvReply( &xQuery, ulAddress, 60U );
+
+    prvCheck( dnstestBLOCKING, prvWaiterDone( &xFirst, dnstestSHORT_WAIT_MS ) );
+    prvCheck( dnstestBLOCKING, prvWaiterDone( &xSecond, dnstestSHORT_WAIT_MS ) );
+    prvCheck( dnstestBLOCKING, ( xFirst.ulIPAddress == ulAddress ) ? pdTRUE : pdFALSE );
+    prvCheck( dnstestBLOCKING, ( xSecond.ulIPAddress == ulAddress ) ? pdTRUE : pdFALSE );
+
+    /* No reply: the waiter returns zero after all attempts were made. */
+    prvStartWaiter( &xUnanswered, "four.example.com" );
+    prvCheck( dnstestBLOCKING, prvWaiterDone( &xUnanswered, 2U * dnstestBLOCKING_TIMEOUT_MS + ipconfigDNS_REQUEST_RETRY_TIME_MS ) );
+    prvCheck( dnstestBLOCKING, ( xUnanswered.ulIPAddress == 0U ) ? pdTRUE : pdFALSE );
+    prvCheck( dnstestBLOCKING, ( xUnanswered.xElapsed >= pdMS_TO_TICKS( dnstestBLOCKING_TIMEOUT_MS ) ) ? pdTRUE : pdFALSE );
+
+    prvDrainQueries( 0U );
+}
+
+/*-----------------------------------------------------------*/
+
+/* A blocking lookup whose request can not be stored returns at once, without
+ * sending a query. */
+static void prvCheckAllocationFailure( void )
+{
+    DNSTestWaiter_t xWaiter;
+    DNSTestQuery_t xQuery;
+    TaskHandle_t xTask;
+
+    memset( &xWaiter, 0, sizeof( xWaiter ) );
+    xWaiter.pcName = "five.example.com";
+    xWaiter.xDone = xSemaphoreCreateBinary();
+    configASSERT( xWaiter.xDone != NULL );
+
+    /* The waiter's first allocation is its semaphore, the second one is the
+     * request. */
+    vTaskSuspendAll();
+    {
+        configASSERT( xTaskCreate( prvWaiterTask, "Waiter", dnstestSTACK_SIZE, &xWaiter, dnstestPRIORITY, &xTask ) == pdPASS );
+        uxFailAfter = 1U;
+        xFailTask = xTask;
+    }
+    ( void ) xTaskResumeAll();
+
+    prvCheck( dnstestALLOCATION_FAILURE, prvWaiterDone( &xWaiter, ipconfigDNS_REQUEST_RETRY_TIME_MS ) );
+    prvCheck( dnstestALLOCATION_FAILURE, ( xFailTask == NULL ) ? pdTRUE : pdFALSE );
+    prvCheck( dnstestALLOCATION_FAILURE, ( xWaiter.ulIPAddress == 0U ) ? pdTRUE : pdFALSE );
+    prvCheck( dnstestALLOCATION_FAILURE, ( xWaiter.xElapsed < pdMS_TO_TICKS( ipconfigDNS_REQUEST_RETRY_TIME_MS ) ) ? pdTRUE : pdFALSE );
+    prvCheck( dnstestALLOCATION_FAILURE, ( prvNextQuery( &xQuery, dnstestSHORT_WAIT_MS ) == pdFALSE ) ? pdTRUE : pdFALSE );
+
+    xFailTask = NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+/* A prefetched name is looked up right away, and again before its TTL
+ * ends. */
+static void prvCheckPrefetch( void )
+{
+    const uint32_t ulFirstAddress = FreeRTOS_inet_addr_quick( 10, 0, 0, 6 );
+    const uint32_t ulSecondAddress = FreeRTOS_inet_addr_quick( 10, 0, 0, 7 );
+    DNSTestQuery_t xQuery;
+    TickType_t xAnswered;
+
+    prvCheck( dnstestPREFETCH, FreeRTOS_dnsprefetch( "six.example.com" ) );
+
+    /* The DNS timer looks at the prefetched names once per second. */
+    prvCheck( dnstestPREFETCH, prvNextQuery( &xQuery, 1500U ) );
+    prvCheck( dnstestPREFETCH, ( strcmp( xQuery.pcName, "six.example.com" ) == 0 ) ? pdTRUE : pdFALSE );
+    prvReply( &xQuery, ulFirstAddress, dnstestPREFETCH_TTL );
+    xAnswered = xTaskGetTickCount();
+    vTaskDelay( pdMS_TO_TICKS( dnstestSHORT_WAIT_MS ) );
+    prvCheck( dnstestPREFETCH, ( FreeRTOS_dnslookup( "six.example.com" ) == ulFirstAddress ) ? pdTRUE : pdFALSE );
+
+    /* Looked up again half-way through the TTL, while the first address
+     * is still valid. */
+    prvCheck( dnstestPREFETCH, prvNextQuery( &xQuery, dnstestPREFETCH_TTL * 1000U ) );
+    prvCheck( dnstestPREFETCH, ( strcmp( xQuery.pcName, "six.example.com" ) == 0 ) ? pdTRUE : pdFALSE );
+    prvCheck( dnstestPREFETCH, ( ( xQuery.xTime - xAnswered ) < pdMS_TO_TICKS( ( dnstestPREFETCH_TTL - 1U ) * 1000U ) ) ? pdTRUE : pdFALSE );
+    prvCheck( dnstestPREFETCH, ( FreeRTOS_dnslookup( "six.example.com" ) == ulFirstAddress ) ? pdTRUE : pdFALSE );
+
+    prvReply( &xQuery, ulSecondAddress, dnstestPREFETCH_TTL );
+    vTaskDelay( pdMS_TO_TICKS( dnstestSHORT_WAIT_MS ) );
+    prvCheck( dnstestPREFETCH, ( FreeRTOS_dnslookup( "six.example.com" ) == ulSecondAddress ) ? pdTRUE : pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    configASSERT( xSemaphoreTake( xNetworkUp, pdMS_TO_TICKS( 5000U ) ) != pdFALSE );
+    prvDrainQueries( dnstestSHORT_WAIT_MS );
+
+    prvCheckCoalescing();
+    prvCheckRetransmission();
+    prvCheckBlockingWaiter();
+    prvCheckAllocationFailure();
+    prvCheckPrefetch();
+
+    vTaskEndScheduler();
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    uint32_t ul, ulFailures = 0;
+
+    printf( "DNS resolver, %u attempts, %u ms apart\n\n",
+            ( unsigned ) ipconfigDNS_REQUEST_ATTEMPTS, ( unsigned ) ipconfigDNS_REQUEST_RETRY_TIME_MS );
+
+    xQueries = xQueueCreate( dnstestQUERY_QUEUE, sizeof( DNSTestQuery_t ) );
+    xNetworkUp = xSemaphoreCreateBinary();
+    configASSERT( ( xQueries != NULL ) && ( xNetworkUp != NULL ) );
+
+    configASSERT( FreeRTOS_IPInit( ucIPAddress, ucNetMask, ucServerAddress, ucServerAddress, ucMACAddress ) == pdPASS );
+    configASSERT( xTaskCreate( prvTestTask, "Test", dnstestSTACK_SIZE, NULL, dnstestPRIORITY, NULL ) == pdPASS );
+
+    vTaskStartScheduler();
+
+    for( ul = 0; ul < dnstestNUM_RESULTS; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}
@@ -0,0 +1,45 @@
+/*
+ * TCP/IP configuration for the DNS resolver test.  Requests are sent again
+ * after 100 ms, so that the test does not have to wait long for the
+ * retransmissions, and the cache is small enough to be filled.
+ */
+
+#ifndef FREERTOS_IP_CONFIG_H
+#define FREERTOS_IP_CONFIG_H
+
+#define ipconfigHAS_DEBUG_PRINTF                  0
+#define ipconfigHAS_PRINTF                        0
+
+#define ipconfigBYTE_ORDER                        pdFREERTOS_LITTLE_ENDIAN
+
+/* The test's replies carry no checksums. */
+#define ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM    0
+#define ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM    1
+#define ipconfigZERO_COPY_TX_DRIVER               0
+#define ipconfigZERO_COPY_RX_DRIVER               0
+
+#define ipconfigUSE_DHCP                          0
+#define ipconfigUSE_LLMNR                         0
+#define ipconfigUSE_NBNS                          0
+#define ipconfigUSE_NETWORK_EVENT_HOOK            1
+
+#define ipconfigUSE_DNS                           1
+#define ipconfigUSE_DNS_CACHE                     1
+#define ipconfigDNS_CACHE_ENTRIES                 4
+#define ipconfigDNS_USE_CALLBACKS                 1
+#define ipconfigDNS_REQUEST_ATTEMPTS              3
+#define ipconfigDNS_REQUEST_RETRY_TIME_MS         100
+#define ipconfigINCLUDE_FULL_INET_ADDR            1
+
+#define ipconfigIP_TASK_PRIORITY                  ( configMAX_PRIORITIES - 2 )
+#define ipconfigIP_TASK_STACK_SIZE_WORDS          ( configMINIMAL_STACK_SIZE * 5 )
+#define ipconfigRAND32()                          uxRand()
+UBaseType_t uxRand( void );
+
+#define ipconfigNETWORK_MTU                       1500
+#define ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS    16
+#define ipconfigEVENT_QUEUE_LENGTH                ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS + 5 )
+
+#define ipconfigUSE_TCP                           0
+
+#endif /* FREERTOS_IP_CONFIG_H */
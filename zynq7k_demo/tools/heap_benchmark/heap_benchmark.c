@@ -0,0 +1,753 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file heap_benchmark.c
+ * @brief Allocator benchmark on the Linux simulator port, replaying the same
+ * allocations and frees on heap_4.c and heap_6.c.
+ *
+ * The workload is either a trace or, without one, a built in mix of short,
+ * medium and long lived blocks of 8 bytes to 4 KB, with one in twenty a TLS
+ * record sized 16 KB buffer. A trace has one operation per line, and lines
+ * starting with # are ignored:
+ *
+ *   m <id> <size>    allocate size bytes as block id
+ *   f <id>           free block id
+ *
+ * Ids are any 64-bit number, such as an address, and frees of blocks the trace
+ * did not allocate are skipped. The time each pvPortMalloc() and vPortFree()
+ * takes is reported as the median, 99.99th percentile and maximum. Every few
+ * thousand operations the largest allocation that succeeds is found by
+ * probing, and fragmentation reported as the share of the free bytes it
+ * leaves unusable. Every block's contents and alignment are checked when it is
+ * freed, and once everything is freed the heap must be as it was before the
+ * replay. For heap_6.c the largest free block, size class and tag statistics
+ * must agree with what was allocated.
+ *
+ * Usage: heap_benchmark_<heap> [trace]
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define heapbenchPRIORITY               ( tskIDLE_PRIORITY + 1 )
+
+/* The built in workload. */
+#define heapbenchALLOCATIONS            200000
+#define heapbenchSEED                   0x2545f491UL
+
+/* The most blocks a workload can have allocated at once. */
+#define heapbenchMAX_LIVE               65536
+#define heapbenchHASH_BUCKETS           65536
+
+/* The number of operations between fragmentation samples. */
+#define heapbenchSAMPLE_INTERVAL        2000
+
+#define heapbenchFREE                   0xffffffffUL
+
+typedef struct HeapResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} HeapResult_t;
+
+enum
+{
+    heapALLOCATIONS = 0,
+    heapMALLOC_MEDIAN,
+    heapMALLOC_TAIL,
+    heapMALLOC_MAX,
+    heapFREE_MEDIAN,
+    heapFREE_TAIL,
+    heapFREE_MAX,
+    heapFRAGMENTATION_MEAN,
+    heapFRAGMENTATION_WORST,
+    heapLOWEST_FREE,
+    heapFAILED,
+    heapPAYLOADS,
+    heapRESTORED,
+    /* heap_6.c only. */
+    heapLARGEST,
+    heapSTATISTICS,
+    heapNUM_RESULTS
+};
+
+static HeapResult_t xResults[ heapNUM_RESULTS ] =
+{
+    { "allocations replayed",         0, 0 },
+    { "malloc median ns",             0, 0 },
+    { "malloc 99.99% ns",             0, 0 },
+    { "malloc max ns",                0, 0 },
+    { "free median ns",               0, 0 },
+    { "free 99.99% ns",               0, 0 },
+    { "free max ns",                  0, 0 },
+    { "mean fragmentation 1/1000",    0, 0 },
+    { "worst fragmentation 1/1000",   0, 0 },
+    { "lowest free bytes",            0, 0 },
+    { "failed allocations",           0, 0 },
+    { "payload and alignment checks", 0, 0 },
+    { "free bytes when empty",        0, 0 },
+    { "largest free block reports",   0, 0 },
+    { "class and tag statistics",     0, 0 }
+};
+
+/* An allocation of ulSize bytes into a slot, or a free of the slot when
+ * ulSize is heapbenchFREE. */
+typedef struct HeapOperation
+{
+    uint32_t ulSlot;
+    uint32_t ulSize;
+} HeapOperation_t;
+
+static HeapOperation_t * pxOperations = NULL;
+static uint32_t ulOperations = 0;
+static uint32_t ulOperationsSize = 0;
+static uint32_t ulAllocations = 0;
+
+/* The slots not holding a block. */
+static uint32_t ulFreeSlots[ heapbenchMAX_LIVE ];
+static uint32_t ulFreeSlotCount = 0;
+
+/* The blocks the replay has allocated. */
+static void * pvBlocks[ heapbenchMAX_LIVE ];
+static uint32_t ulBlockSizes[ heapbenchMAX_LIVE ];
+static uint8_t ucBlockPatterns[ heapbenchMAX_LIVE ];
+
+/* The time each operation took. */
+static uint32_t * pulMallocTimes = NULL;
+static uint32_t * pulFreeTimes = NULL;
+static uint32_t ulMallocTimes = 0;
+static uint32_t ulFreeTimes = 0;
+
+static uint32_t ulFragmentationSamples = 0;
+static uint64_t ullFragmentationTotal = 0;
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    /* Only async-signal-safe calls, as this can run in a simulated
+     * interrupt. */
+    lLength = snprintf( cMessage, sizeof( cMessage ), "ASSERT: %s:%lu\n", pcFile, ulLine );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvGetHostNanoseconds( void )
+{
+    struct timespec xNow;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( uint64_t ) xNow.tv_sec * 1000000000ULL + ( uint64_t ) xNow.tv_nsec;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFail( uint32_t ulResult )
+{
+    xResults[ ulResult ].ulFailures++;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvAddOperation( uint32_t ulSlot,
+                             uint32_t ulSize )
+{
+    if( ulOperations == ulOperationsSize )
+    {
+        ulOperationsSize = ( ulOperationsSize == 0 ) ? 65536 : ulOperationsSize * 2;
+        pxOperations = realloc( pxOperations, ulOperationsSize * sizeof( HeapOperation_t ) );
+        configASSERT( pxOperations != NULL );
+    }
+
+    pxOperations[ ulOperations ].ulSlot = ulSlot;
+    pxOperations[ ulOperations ].ulSize = ulSize;
+    ulOperations++;
+
+    if( ulSize != heapbenchFREE )
+    {
+        ulAllocations++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvTakeSlot( void )
+{
+    if( ulFreeSlotCount == 0 )
+    {
+        fprintf( stderr, "more than %d blocks allocated at once\n", heapbenchMAX_LIVE );
+        exit( 2 );
+    }
+
+    return ulFreeSlots[ --ulFreeSlotCount ];
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvGiveSlot( uint32_t ulSlot )
+{
+    ulFreeSlots[ ulFreeSlotCount++ ] = ulSlot;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRandom( void )
+{
+    static uint32_t ulState = heapbenchSEED;
+
+    ulState ^= ulState << 13;
+    ulState ^= ulState >> 17;
+    ulState ^= ulState << 5;
+
+    return ulState;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvGenerateWorkload( void )
+{
+    /* The slots to free, in a binary heap ordered by when. */
+    static struct
+    {
+        uint32_t ulWhen;
+        uint32_t ulSlot;
+    } xDeaths[ heapbenchMAX_LIVE ], xDeath;
+    uint32_t ulDeaths = 0, ulAllocation, ulSize, ulLifetime, ulChance, ul, ulChild;
+
+    for( ulAllocation = 0; ulAllocation < heapbenchALLOCATIONS; ulAllocation++ )
+    {
+        while( ( ulDeaths > 0 ) && ( xDeaths[ 0 ].ulWhen <= ulAllocation ) )
+        {
+            prvAddOperation( xDeaths[ 0 ].ulSlot, heapbenchFREE );
+            prvGiveSlot( xDeaths[ 0 ].ulSlot );
+
+            xDeath = xDeaths[ --ulDeaths ];
+
+            for( ul = 0; ( ulChild = ul * 2 + 1 ) < ulDeaths; ul = ulChild )
+            {
+                if( ( ulChild + 1 < ulDeaths ) && ( xDeaths[ ulChild + 1 ].ulWhen < xDeaths[ ulChild ].ulWhen ) )
+                {
+                    ulChild++;
+                }
+
+                if( xDeaths[ ulChild ].ulWhen >= xDeath.ulWhen )
+                {
+                    break;
+                }
+
+                xDeaths[ ul ] = xDeaths[ ulChild ];
+            }
+
+            xDeaths[ ul ] = xDeath;
+        }
+
+        /* Sizes spread evenly over each power of two from 8 bytes to 4 KB,
+         * and now and then a TLS record buffer. */
+        if( prvRandom() % 20 == 0 )
+        {
+            ulSize = 16384 + prvRandom() % 1024;
+        }
+        else
+        {
+            ul = 3 + prvRandom() % 9;
+            ulSize = ( 1UL << ul ) + prvRandom() % ( 1UL << ul );
+        }
+
+        /* Mostly blocks freed soon after, some kept a while and a few kept
+         * for a large part of the run. */
+        ulChance = prvRandom() % 100;
+
+        if( ulChance < 90 )
+        {
+            ulLifetime = 1 + prvRandom() % 16;
+        }
+        else if( ulChance < 99 )
+        {
+            ulLifetime = 16 + prvRandom() % 1008;
+        }
+        else
+        {
+            ulLifetime = 1024 + prvRandom() % 19000;
+        }
+
+        xDeath.ulSlot = prvTakeSlot();
+        xDeath.ulWhen = ulAllocation + ulLifetime;
+        prvAddOperation( xDeath.ulSlot, ulSize );
+
+        for( ul = ulDeaths++; ( ul > 0 ) && ( xDeaths[ ( ul - 1 ) / 2 ].ulWhen > xDeath.ulWhen ); ul = ( ul - 1 ) / 2 )
+        {
+            xDeaths[ ul ] = xDeaths[ ( ul - 1 ) / 2 ];
+        }
+
+        xDeaths[ ul ] = xDeath;
+    }
+
+    /* The replay frees the blocks that are left. */
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvLoadTrace( const char * pcFileName )
+{
+    /* The ids of the live blocks, chained from a hash of the id. */
+    static int32_t lBuckets[ heapbenchHASH_BUCKETS ];
+    static int32_t lNext[ heapbenchMAX_LIVE ];
+    static uint64_t ullIds[ heapbenchMAX_LIVE ];
+    FILE * pxFile;
+    char cLine[ 256 ];
+    char * pc, * pcEnd;
+    char cType;
+    uint64_t ullId;
+    uint32_t ulSize, ulLine = 0, ulUnmatched = 0, ulBucket, ulSlot;
+    int32_t * plLink;
+
+    pxFile = fopen( pcFileName, "r" );
+
+    if( pxFile == NULL )
+    {
+        perror( pcFileName );
+        exit( 2 );
+    }
+
+    memset( lBuckets, 0xff, sizeof( lBuckets ) );
+
+    while( fgets( cLine, sizeof( cLine ), pxFile ) != NULL )
+    {
+        ulLine++;
+
+        for( pc = cLine; ( *pc == ' ' ) || ( *pc == '\t' ); pc++ )
+        {
+        }
+
+        if( ( *pc == '#' ) || ( *pc == '\n' ) || ( *pc == '\r' ) || ( *pc == '\0' ) )
+        {
+            continue;
+        }
+
+        cType = *pc++;
+        ullId = strtoull( pc, &pcEnd, 0 );
+        ulSize = 0;
+
+        if( ( pcEnd != pc ) && ( cType == 'm' ) )
+        {
+            pc = pcEnd;
+            ulSize = ( uint32_t ) strtoul( pc, &pcEnd, 0 );
+        }
+
+        if( ( pcEnd == pc ) || ( ( cType != 'm' ) && ( cType != 'f' ) ) )
+        {
+            fprintf( stderr, "%s:%lu: not an operation\n", pcFileName, ( unsigned long ) ulLine );
+            exit( 2 );
+        }
+
+        ulBucket = ( uint32_t ) ( ( ullId * 0x9e3779b97f4a7c15ULL ) >> 48 ) % heapbenchHASH_BUCKETS;
+
+        for( plLink = &lBuckets[ ulBucket ]; ( *plLink >= 0 ) && ( ullIds[ *plLink ] != ullId ); plLink = &lNext[ *plLink ] )
+        {
+        }
+
+        if( cType == 'm' )
+        {
+            if( *plLink >= 0 )
+            {
+                fprintf( stderr, "%s:%lu: block allocated twice\n", pcFileName, ( unsigned long ) ulLine );
+                exit( 2 );
+            }
+
+            ulSlot = prvTakeSlot();
+            ullIds[ ulSlot ] = ullId;
+            lNext[ ulSlot ] = lBuckets[ ulBucket ];
+            lBuckets[ ulBucket ] = ( int32_t ) ulSlot;
+            prvAddOperation( ulSlot, ulSize );
+        }
+        else if( *plLink >= 0 )
+        {
+            ulSlot = ( uint32_t ) *plLink;
+            *plLink = lNext[ ulSlot ];
+            prvGiveSlot( ulSlot );
+            prvAddOperation( ulSlot, heapbenchFREE );
+        }
+        else
+        {
+            ulUnmatched++;
+        }
+    }
+
+    fclose( pxFile );
+
+    if( ulUnmatched > 0 )
+    {
+        printf( "skipped %lu frees of blocks allocated before the trace\n", ( unsigned long ) ulUnmatched );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFreeBlock( uint32_t ulSlot,
+                          BaseType_t xTimed )
+{
+    uint8_t * pucBlock = pvBlocks[ ulSlot ];
+    uint32_t ul;
+    uint64_t ullStart;
+
+    xResults[ heapPAYLOADS ].ulCount++;
+
+    for( ul = 0; ul < ulBlockSizes[ ulSlot ]; ul++ )
+    {
+        if( pucBlock[ ul ] != ucBlockPatterns[ ulSlot ] )
+        {
+            prvFail( heapPAYLOADS );
+            break;
+        }
+    }
+
+    ullStart = prvGetHostNanoseconds();
+    vPortFree( pucBlock );
+
+    if( xTimed != pdFALSE )
+    {
+        pulFreeTimes[ ulFreeTimes++ ] = ( uint32_t ) ( prvGetHostNanoseconds() - ullStart );
+    }
+
+    pvBlocks[ ulSlot ] = NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+/* The largest number of bytes pvPortMalloc() can allocate now. */
+static size_t prvProbeLargestAllocation( void )
+{
+    size_t xLow = 0, xHigh = xPortGetFreeHeapSize(), xMiddle;
+    void * pv;
+
+    while( xLow < xHigh )
+    {
+        xMiddle = xLow + ( xHigh - xLow + 1 ) / 2;
+        pv = pvPortMalloc( xMiddle );
+
+        if( pv != NULL )
+        {
+            vPortFree( pv );
+            xLow = xMiddle;
+        }
+        else
+        {
+            xHigh = xMiddle - 1;
+        }
+    }
+
+    return xLow;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSampleFragmentation( void )
+{
+    size_t xFree = xPortGetFreeHeapSize(), xLargest;
+    uint32_t ulFragmentation;
+
+    xLargest = prvProbeLargestAllocation();
+
+    #if ( heapbenchHEAP == 6 )
+        {
+            xResults[ heapLARGEST ].ulCount++;
+
+            if( xLargest != xPortGetLargestFreeBlockSize() )
+            {
+                prvFail( heapLARGEST );
+            }
+        }
+    #endif
+
+    ulFragmentation = ( xFree == 0 ) ? 0 : ( uint32_t ) ( 1000 - ( uint64_t ) xLargest * 1000 / xFree );
+    ulFragmentationSamples++;
+    ullFragmentationTotal += ulFragmentation;
+
+    if( ulFragmentation > xResults[ heapFRAGMENTATION_WORST ].ulCount )
+    {
+        xResults[ heapFRAGMENTATION_WORST ].ulCount = ulFragmentation;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( heapbenchHEAP == 6 )
+
+/* Check the statistics against the live blocks, which were allocated with
+ * the tag of their slot, on top of the blocks there were before the replay. */
+    static void prvCheckStatistics( const HeapTagStats_t * pxTagsBefore )
+    {
+        HeapClassStats_t xClass;
+        HeapTagStats_t xTag;
+        size_t xInUse = 0, xFree = 0, xTaggedInUse = 0, xLive[ configHEAP_TAGS ] = { 0 };
+        UBaseType_t ux;
+        uint32_t ul;
+
+        for( ul = 0; ul < heapbenchMAX_LIVE; ul++ )
+        {
+            if( pvBlocks[ ul ] != NULL )
+            {
+                xLive[ ul % configHEAP_TAGS ]++;
+            }
+        }
+
+        printf( "class  max block   in use   free  allocations\n" );
+
+        for( ux = 0; ux < uxPortGetHeapClassCount(); ux++ )
+        {
+            vPortGetHeapClassStats( ux, &xClass );
+            xInUse += xClass.xBytesInUse;
+            xFree += xClass.xFreeBytes;
+
+            if( ( xClass.xBlocksInUse != 0 ) || ( xClass.xFreeBlocks != 0 ) )
+            {
+                printf( "%5lu %10lu %8lu %6lu %12lu\n", ( unsigned long ) ux, ( unsigned long ) xClass.xMaximumBlockSize,
+                        ( unsigned long ) xClass.xBlocksInUse, ( unsigned long ) xClass.xFreeBlocks,
+                        ( unsigned long ) xClass.xAllocations );
+            }
+        }
+
+        printf( "\n" );
+
+        for( ux = 0; ux < configHEAP_TAGS; ux++ )
+        {
+            vPortGetHeapTagStats( ux, &xTag );
+            xTaggedInUse += xTag.xBytesInUse;
+            xResults[ heapSTATISTICS ].ulCount++;
+
+            if( ( xTag.xBlocksInUse != pxTagsBefore[ ux ].xBlocksInUse + xLive[ ux ] ) ||
+                ( xTag.xMaximumBytesInUse < xTag.xBytesInUse ) )
+            {
+                prvFail( heapSTATISTICS );
+            }
+        }
+
+        xResults[ heapSTATISTICS ].ulCount++;
+
+        if( ( xFree != xPortGetFreeHeapSize() ) || ( xInUse != xTaggedInUse ) )
+        {
+            prvFail( heapSTATISTICS );
+        }
+    }
+
+#endif /* heapbenchHEAP */
+
+/*-----------------------------------------------------------*/
+
+static int prvCompareTimes( const void * pv1,
+                            const void * pv2 )
+{
+    uint32_t ul1 = *( const uint32_t * ) pv1, ul2 = *( const uint32_t * ) pv2;
+
+    return ( ul1 > ul2 ) - ( ul1 < ul2 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReportTimes( uint32_t * pulTimes,
+                            uint32_t ulCount,
+                            uint32_t ulMedianResult )
+{
+    if( ulCount > 0 )
+    {
+        qsort( pulTimes, ulCount, sizeof( uint32_t ), prvCompareTimes );
+        xResults[ ulMedianResult ].ulCount = pulTimes[ ulCount / 2 ];
+        xResults[ ulMedianResult + 1 ].ulCount = pulTimes[ ( uint32_t ) ( ( ( uint64_t ) ulCount * 9999 + 9999 ) / 10000 ) - 1 ];
+        xResults[ ulMedianResult + 2 ].ulCount = pulTimes[ ulCount - 1 ];
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReplayTask( void * pvParameters )
+{
+    HeapOperation_t * pxOperation;
+    uint32_t ul, ulSlot;
+    size_t xFreeBefore, xLargestBefore, xFree;
+    uint64_t ullStart;
+    void * pv;
+
+    #if ( heapbenchHEAP == 6 )
+        HeapTagStats_t xTagsBefore[ configHEAP_TAGS ];
+
+        for( ul = 0; ul < configHEAP_TAGS; ul++ )
+        {
+            vPortGetHeapTagStats( ul, &xTagsBefore[ ul ] );
+        }
+    #endif
+
+    ( void ) pvParameters;
+
+    xFreeBefore = xPortGetFreeHeapSize();
+    xLargestBefore = prvProbeLargestAllocation();
+    xResults[ heapLOWEST_FREE ].ulCount = ( uint32_t ) xFreeBefore;
+
+    for( ul = 0; ul < ulOperations; ul++ )
+    {
+        pxOperation = &pxOperations[ ul ];
+        ulSlot = pxOperation->ulSlot;
+
+        if( pxOperation->ulSize != heapbenchFREE )
+        {
+            #if ( heapbenchHEAP == 6 )
+                ( void ) uxPortSetHeapTag( ulSlot % configHEAP_TAGS );
+            #endif
+
+            ullStart = prvGetHostNanoseconds();
+            pv = pvPortMalloc( pxOperation->ulSize );
+            pulMallocTimes[ ulMallocTimes++ ] = ( uint32_t ) ( prvGetHostNanoseconds() - ullStart );
+
+            xResults[ heapALLOCATIONS ].ulCount++;
+
+            if( pv != NULL )
+            {
+                xResults[ heapPAYLOADS ].ulCount++;
+
+                if( ( ( uintptr_t ) pv & portBYTE_ALIGNMENT_MASK ) != 0 )
+                {
+                    prvFail( heapPAYLOADS );
+                }
+
+                ucBlockPatterns[ ulSlot ] = ( uint8_t ) ( ul * 7 + 1 );
+                memset( pv, ucBlockPatterns[ ulSlot ], pxOperation->ulSize );
+                ulBlockSizes[ ulSlot ] = pxOperation->ulSize;
+                pvBlocks[ ulSlot ] = pv;
+
+                xFree = xPortGetFreeHeapSize();
+
+                if( xFree < xResults[ heapLOWEST_FREE ].ulCount )
+                {
+                    xResults[ heapLOWEST_FREE ].ulCount = ( uint32_t ) xFree;
+                }
+            }
+            else if( pxOperation->ulSize != 0 )
+            {
+                xResults[ heapFAILED ].ulCount++;
+            }
+        }
+        else if( pvBlocks[ ulSlot ] != NULL )
+        {
+            prvFreeBlock( ulSlot, pdTRUE );
+        }
+
+        if( ( ul + 1 ) % heapbenchSAMPLE_INTERVAL == 0 )
+        {
+            prvSampleFragmentation();
+        }
+    }
+
+    #if ( heapbenchHEAP == 6 )
+        prvCheckStatistics( xTagsBefore );
+    #endif
+
+    for( ul = 0; ul < heapbenchMAX_LIVE; ul++ )
+    {
+        if( pvBlocks[ ul ] != NULL )
+        {
+            prvFreeBlock( ul, pdFALSE );
+        }
+    }
+
+    /* With everything freed the heap must be one block again. */
+    xResults[ heapRESTORED ].ulCount = ( uint32_t ) xPortGetFreeHeapSize();
+
+    if( ( xPortGetFreeHeapSize() != xFreeBefore ) || ( prvProbeLargestAllocation() != xLargestBefore ) )
+    {
+        prvFail( heapRESTORED );
+    }
+
+    if( ulFragmentationSamples > 0 )
+    {
+        xResults[ heapFRAGMENTATION_MEAN ].ulCount = ( uint32_t ) ( ullFragmentationTotal / ulFragmentationSamples );
+    }
+
+    prvReportTimes( pulMallocTimes, ulMallocTimes, heapMALLOC_MEDIAN );
+    prvReportTimes( pulFreeTimes, ulFreeTimes, heapFREE_MEDIAN );
+
+    vTaskEndScheduler();
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char * argv[] )
+{
+    uint32_t ul, ulFailures = 0, ulResults = heapLARGEST;
+
+    for( ul = 0; ul < heapbenchMAX_LIVE; ul++ )
+    {
+        prvGiveSlot( heapbenchMAX_LIVE - 1 - ul );
+    }
+
+    if( argc > 1 )
+    {
+        prvLoadTrace( argv[ 1 ] );
+    }
+    else
+    {
+        prvGenerateWorkload();
+    }
+
+    pulMallocTimes = malloc( ulAllocations * sizeof( uint32_t ) + 1 );
+    pulFreeTimes = malloc( ( ulOperations - ulAllocations ) * sizeof( uint32_t ) + 1 );
+    configASSERT( ( pulMallocTimes != NULL ) && ( pulFreeTimes != NULL ) );
+
+    printf( "heap_%d, %s\n\n", heapbenchHEAP, ( argc > 1 ) ? argv[ 1 ] : "built in workload" );
+
+    configASSERT( xTaskCreate( prvReplayTask, "Replay", configMINIMAL_STACK_SIZE * 4, NULL, heapbenchPRIORITY, NULL ) == pdPASS );
+
+    vTaskStartScheduler();
+
+    #if ( heapbenchHEAP == 6 )
+        ulResults = heapNUM_RESULTS;
+    #endif
+
+    for( ul = 0; ul < ulResults; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}
@@ -0,0 +1,57 @@
+/*
+ * Kernel configuration for the heap benchmark, built on the host against the
+ * Linux simulator port.  The heap implementation is chosen by the Makefile.
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#define configNUM_CORES                            1
+
+#define configUSE_PREEMPTION                       1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION    0
+#define configUSE_TICKLESS_IDLE                    0
+#define configUSE_TIME_SLICING                     1
+#define configMAX_PRIORITIES                       ( 5 )
+#define configTICK_RATE_HZ                         ( 1000 )
+#define configMINIMAL_STACK_SIZE                   ( ( unsigned short ) 256 )
+#define configTOTAL_HEAP_SIZE                      ( ( size_t ) ( 1024 * 1024 ) )
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS    1
+#define configMAX_TASK_NAME_LEN                    ( 15 )
+#define configUSE_TRACE_FACILITY                   0
+#define configUSE_16_BIT_TICKS                     0
+#define configIDLE_SHOULD_YIELD                    1
+#define configUSE_MUTEXES                          0
+#define configUSE_RECURSIVE_MUTEXES                0
+#define configUSE_COUNTING_SEMAPHORES              0
+#define configUSE_QUEUE_SETS                       0
+#define configQUEUE_REGISTRY_SIZE                  0
+#define configUSE_TASK_NOTIFICATIONS               1
+#define configUSE_CO_ROUTINES                      0
+#define configUSE_TIMERS                           0
+#define configSUPPORT_DYNAMIC_ALLOCATION           1
+#define configSUPPORT_STATIC_ALLOCATION            0
+
+#define configUSE_IDLE_HOOK                        0
+#define configUSE_TICK_HOOK                        0
+#define configUSE_MALLOC_FAILED_HOOK               0
+#define configCHECK_FOR_STACK_OVERFLOW             0
+#define configGENERATE_RUN_TIME_STATS              0
+
+/* heap_6.c keeps statistics for four tags, held by each task in its thread
+ * local storage. */
+#define configHEAP_TAGS                            4
+#define configHEAP_TAG_THREAD_LOCAL_INDEX          0
+
+#define INCLUDE_vTaskDelete                        1
+#define INCLUDE_vTaskSuspend                       1
+#define INCLUDE_vTaskDelayUntil                    1
+#define INCLUDE_vTaskDelay                         1
+#define INCLUDE_xTaskGetSchedulerState             1
+#define INCLUDE_xTaskGetCurrentTaskHandle          1
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine );
+#define configASSERT( x )    if( ( x ) == 0 ) vAssertCalled( __FILE__, __LINE__ )
+
+#endif /* FREERTOS_CONFIG_H */
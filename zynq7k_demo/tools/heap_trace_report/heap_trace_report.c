@@ -0,0 +1,709 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file heap_trace_report.c
+ * @brief Reads a heap trace written by xHeapTraceFormat(), from a UART capture
+ * or saved MQTT messages, and reports the allocations still live at the end of
+ * it.
+ *
+ * Lines without "HT " in them are skipped, so a whole log can be read. The
+ * report gives the totals, the live allocations grouped by the address they
+ * were allocated from, largest first, with the age of the oldest, the call
+ * sites of failed allocations, and a map of the heap showing where the live
+ * blocks are. With -e, call sites are named by addr2line (or $ADDR2LINE) from
+ * the image that was running. With -r, the allocations and frees are written
+ * out as a trace for tools/heap_benchmark to replay.
+ *
+ * Blocks allocated before the trace started, or whose records were lost, are
+ * not known, so look free on the map.
+ *
+ * Usage: heap_trace_report [-e image] [-r replay] [-n sites] [-w columns]
+ *        [trace ...]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define reportHASH_BUCKETS    65536
+#define reportMAP_ROWS        16
+
+typedef struct Block
+{
+    uint64_t ullAddress;
+    uint64_t ullSize;
+    uint64_t ullCaller;
+    uint64_t ullTask;
+    uint32_t ulTick;
+    struct Block * pxNext;
+} Block_t;
+
+typedef struct CallSite
+{
+    uint64_t ullCaller;
+    uint64_t ullBlocks;
+    uint64_t ullBytes;
+    uint64_t ullFailures;
+    uint32_t ulOldestTick;
+    uint64_t ullOldestTask;
+} CallSite_t;
+
+typedef struct Task
+{
+    uint64_t ullHandle;
+    char cName[ 32 ];
+} Task_t;
+
+/* The live blocks, chained from a hash of their address. */
+static Block_t * pxBuckets[ reportHASH_BUCKETS ];
+static uint64_t ullLiveBlocks = 0;
+static uint64_t ullLiveBytes = 0;
+
+static Task_t * pxTasks = NULL;
+static size_t xTasks = 0;
+
+/* The call sites of failed allocations. */
+static CallSite_t * pxFailures = NULL;
+static size_t xFailureSites = 0;
+
+static uint64_t ullAllocations = 0, ullFrees = 0, ullFailed = 0, ullLost = 0, ullUnmatched = 0, ullRecords = 0;
+static uint64_t ullLowestAddress = UINT64_MAX;
+static uint32_t ulLatestTick = 0, ulHz = 0;
+static unsigned long ulHeapTotal = 0, ulFirstFree = 0, ulLastFree = 0, ulMinimumFree = 0;
+static int iHaveHeap = 0;
+
+static FILE * pxReplay = NULL;
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvHash( uint64_t ullAddress )
+{
+    return ( uint32_t ) ( ( ullAddress * 0x9e3779b97f4a7c15ULL ) >> 48 ) % reportHASH_BUCKETS;
+}
+
+/*-----------------------------------------------------------*/
+
+static Block_t ** prvFindBlock( uint64_t ullAddress )
+{
+    Block_t ** ppxLink;
+
+    for( ppxLink = &pxBuckets[ prvHash( ullAddress ) ]; ( *ppxLink != NULL ) && ( ( *ppxLink )->ullAddress != ullAddress ); ppxLink = &( *ppxLink )->pxNext )
+    {
+    }
+
+    return ppxLink;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvRemoveBlock( Block_t ** ppxLink )
+{
+    Block_t * pxBlock = *ppxLink;
+
+    *ppxLink = pxBlock->pxNext;
+    ullLiveBlocks--;
+    ullLiveBytes -= pxBlock->ullSize;
+
+    if( pxReplay != NULL )
+    {
+        fprintf( pxReplay, "f 0x%llx\n", ( unsigned long long ) pxBlock->ullAddress );
+    }
+
+    free( pxBlock );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvAllocated( uint32_t ulTick,
+                          uint64_t ullTask,
+                          uint64_t ullCaller,
+                          uint64_t ullAddress,
+                          uint64_t ullSize )
+{
+    Block_t ** ppxLink = prvFindBlock( ullAddress );
+    Block_t * pxBlock;
+
+    /* The block's free was lost. */
+    if( *ppxLink != NULL )
+    {
+        prvRemoveBlock( ppxLink );
+        ppxLink = prvFindBlock( ullAddress );
+    }
+
+    pxBlock = malloc( sizeof( Block_t ) );
+
+    if( pxBlock == NULL )
+    {
+        perror( "heap_trace_report" );
+        exit( 2 );
+    }
+
+    pxBlock->ullAddress = ullAddress;
+    pxBlock->ullSize = ullSize;
+    pxBlock->ullCaller = ullCaller;
+    pxBlock->ullTask = ullTask;
+    pxBlock->ulTick = ulTick;
+    pxBlock->pxNext = NULL;
+    *ppxLink = pxBlock;
+
+    ullLiveBlocks++;
+    ullLiveBytes += ullSize;
+
+    if( ullAddress < ullLowestAddress )
+    {
+        ullLowestAddress = ullAddress;
+    }
+
+    if( pxReplay != NULL )
+    {
+        fprintf( pxReplay, "m 0x%llx %llu\n", ( unsigned long long ) ullAddress, ( unsigned long long ) ullSize );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFailed( uint64_t ullCaller )
+{
+    size_t x;
+
+    for( x = 0; ( x < xFailureSites ) && ( pxFailures[ x ].ullCaller != ullCaller ); x++ )
+    {
+    }
+
+    if( x == xFailureSites )
+    {
+        pxFailures = realloc( pxFailures, ( xFailureSites + 1 ) * sizeof( CallSite_t ) );
+
+        if( pxFailures == NULL )
+        {
+            perror( "heap_trace_report" );
+            exit( 2 );
+        }
+
+        memset( &pxFailures[ x ], 0, sizeof( CallSite_t ) );
+        pxFailures[ x ].ullCaller = ullCaller;
+        xFailureSites++;
+    }
+
+    pxFailures[ x ].ullFailures++;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvNameTask( uint64_t ullHandle,
+                         const char * pcName )
+{
+    size_t x;
+
+    for( x = 0; ( x < xTasks ) && ( pxTasks[ x ].ullHandle != ullHandle ); x++ )
+    {
+    }
+
+    if( x == xTasks )
+    {
+        pxTasks = realloc( pxTasks, ( xTasks + 1 ) * sizeof( Task_t ) );
+
+        if( pxTasks == NULL )
+        {
+            perror( "heap_trace_report" );
+            exit( 2 );
+        }
+
+        pxTasks[ x ].ullHandle = ullHandle;
+        xTasks++;
+    }
+
+    /* A handle is reused by a task created after another is deleted. */
+    snprintf( pxTasks[ x ].cName, sizeof( pxTasks[ x ].cName ), "%s", pcName );
+}
+
+/*-----------------------------------------------------------*/
+
+static const char * prvTaskName( uint64_t ullHandle )
+{
+    size_t x;
+
+    for( x = 0; x < xTasks; x++ )
+    {
+        if( pxTasks[ x ].ullHandle == ullHandle )
+        {
+            return pxTasks[ x ].cName;
+        }
+    }
+
+    return "?";
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReadTrace( FILE * pxFile )
+{
+    char cLine[ 512 ];
+    char * pc, * pcName;
+    char cEvent;
+    unsigned long ulTick, ulSize, ulFree, ulMinimum;
+    unsigned long long ullTask, ullCaller, ullAddress, ullCount;
+    Block_t ** ppxLink;
+
+    while( fgets( cLine, sizeof( cLine ), pxFile ) != NULL )
+    {
+        pc = strstr( cLine, "HT " );
+
+        if( pc == NULL )
+        {
+            continue;
+        }
+
+        pc += 3;
+        cLine[ strcspn( cLine, "\r\n" ) ] = '\0';
+
+        /* The record lines are the ones whose first word is one letter. */
+        if( ( pc[ 0 ] != '\0' ) && ( pc[ 1 ] == ' ' ) &&
+            ( sscanf( pc, "%c %lx %llx %llx %llx %lx", &cEvent, &ulTick, &ullTask, &ullCaller, &ullAddress, &ulSize ) == 6 ) )
+        {
+            ullRecords++;
+            ulLatestTick = ( uint32_t ) ulTick;
+
+            if( cEvent == 'm' )
+            {
+                ullAllocations++;
+                prvAllocated( ( uint32_t ) ulTick, ullTask, ullCaller, ullAddress, ulSize );
+            }
+            else if( cEvent == 'f' )
+            {
+                ullFrees++;
+                ppxLink = prvFindBlock( ullAddress );
+
+                if( *ppxLink != NULL )
+                {
+                    prvRemoveBlock( ppxLink );
+                }
+                else
+                {
+                    ullUnmatched++;
+                }
+            }
+            else if( cEvent == 'x' )
+            {
+                ullFailed++;
+                prvFailed( ullCaller );
+            }
+        }
+        else if( sscanf( pc, "lost %llx", &ullCount ) == 1 )
+        {
+            ullLost += ullCount;
+        }
+        else if( sscanf( pc, "task %llx", &ullTask ) == 1 )
+        {
+            pcName = strchr( pc + 5, ' ' );
+            prvNameTask( ullTask, ( pcName != NULL ) ? pcName + 1 : "" );
+        }
+        else if( sscanf( pc, "heap %lx %lx %lx", &ulSize, &ulFree, &ulMinimum ) == 3 )
+        {
+            if( iHaveHeap == 0 )
+            {
+                ulFirstFree = ulFree;
+                iHaveHeap = 1;
+            }
+
+            ulHeapTotal = ulSize;
+            ulLastFree = ulFree;
+            ulMinimumFree = ulMinimum;
+        }
+        else if( sscanf( pc, "hz %lx", &ulSize ) == 1 )
+        {
+            ulHz = ( uint32_t ) ulSize;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvCompareSites( const void * pv1,
+                            const void * pv2 )
+{
+    const CallSite_t * px1 = pv1, * px2 = pv2;
+
+    if( px1->ullBytes != px2->ullBytes )
+    {
+        return ( px1->ullBytes < px2->ullBytes ) ? 1 : -1;
+    }
+
+    return ( px1->ullCaller > px2->ullCaller ) - ( px1->ullCaller < px2->ullCaller );
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvCompareBlocks( const void * pv1,
+                             const void * pv2 )
+{
+    const Block_t * px1 = *( Block_t * const * ) pv1, * px2 = *( Block_t * const * ) pv2;
+
+    return ( px1->ullAddress > px2->ullAddress ) - ( px1->ullAddress < px2->ullAddress );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Name a call site with addr2line, or leave the name empty. */
+static void prvNameCaller( const char * pcImage,
+                           uint64_t ullCaller,
+                           char * pcName,
+                           size_t xNameLength )
+{
+    char cCommand[ 512 ], cFunction[ 256 ], cLocation[ 256 ];
+    const char * pcAddr2line = getenv( "ADDR2LINE" );
+    FILE * pxPipe;
+
+    pcName[ 0 ] = '\0';
+
+    if( pcImage == NULL )
+    {
+        return;
+    }
+
+    /* The return address is after the call, so look up the byte before it,
+     * which is in the call's line. */
+    snprintf( cCommand, sizeof( cCommand ), "%s -f -s -e '%s' 0x%llx", ( pcAddr2line != NULL ) ? pcAddr2line : "addr2line",
+              pcImage, ( unsigned long long ) ( ullCaller - 1 ) );
+    pxPipe = popen( cCommand, "r" );
+
+    if( pxPipe == NULL )
+    {
+        return;
+    }
+
+    if( ( fgets( cFunction, sizeof( cFunction ), pxPipe ) != NULL ) && ( fgets( cLocation, sizeof( cLocation ), pxPipe ) != NULL ) )
+    {
+        cFunction[ strcspn( cFunction, "\r\n" ) ] = '\0';
+        cLocation[ strcspn( cLocation, "\r\n" ) ] = '\0';
+        snprintf( pcName, xNameLength, "%s %s", cFunction, cLocation );
+    }
+
+    ( void ) pclose( pxPipe );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReportCallSites( const char * pcImage,
+                                size_t xMaxSites )
+{
+    CallSite_t * pxSites;
+    size_t xSites = 0, x, ulBucket;
+    Block_t * pxBlock;
+    char cName[ 512 ];
+
+    pxSites = calloc( ullLiveBlocks + 1, sizeof( CallSite_t ) );
+
+    if( pxSites == NULL )
+    {
+        perror( "heap_trace_report" );
+        exit( 2 );
+    }
+
+    for( ulBucket = 0; ulBucket < reportHASH_BUCKETS; ulBucket++ )
+    {
+        for( pxBlock = pxBuckets[ ulBucket ]; pxBlock != NULL; pxBlock = pxBlock->pxNext )
+        {
+            for( x = 0; ( x < xSites ) && ( pxSites[ x ].ullCaller != pxBlock->ullCaller ); x++ )
+            {
+            }
+
+            if( x == xSites )
+            {
+                pxSites[ x ].ullCaller = pxBlock->ullCaller;
+                pxSites[ x ].ulOldestTick = pxBlock->ulTick;
+                pxSites[ x ].ullOldestTask = pxBlock->ullTask;
+                xSites++;
+            }
+
+            pxSites[ x ].ullBlocks++;
+            pxSites[ x ].ullBytes += pxBlock->ullSize;
+
+            /* Ticks are compared relative to the latest, so they can wrap. */
+            if( ( uint32_t ) ( ulLatestTick - pxBlock->ulTick ) > ( uint32_t ) ( ulLatestTick - pxSites[ x ].ulOldestTick ) )
+            {
+                pxSites[ x ].ulOldestTick = pxBlock->ulTick;
+                pxSites[ x ].ullOldestTask = pxBlock->ullTask;
+            }
+        }
+    }
+
+    qsort( pxSites, xSites, sizeof( CallSite_t ), prvCompareSites );
+
+    printf( "live allocations by call site\n" );
+    printf( "    blocks        bytes   oldest s  caller              task             function\n" );
+
+    for( x = 0; ( x < xSites ) && ( x < xMaxSites ); x++ )
+    {
+        prvNameCaller( pcImage, pxSites[ x ].ullCaller, cName, sizeof( cName ) );
+        printf( "%10llu %12llu %10.1f  0x%-16llx  %-15s  %s\n",
+                ( unsigned long long ) pxSites[ x ].ullBlocks,
+                ( unsigned long long ) pxSites[ x ].ullBytes,
+                ( ulHz != 0 ) ? ( double ) ( uint32_t ) ( ulLatestTick - pxSites[ x ].ulOldestTick ) / ulHz : 0.0,
+                ( unsigned long long ) pxSites[ x ].ullCaller,
+                prvTaskName( pxSites[ x ].ullOldestTask ),
+                cName );
+    }
+
+    if( xSites > xMaxSites )
+    {
+        printf( "  and %lu more call sites\n", ( unsigned long ) ( xSites - xMaxSites ) );
+    }
+
+    printf( "\n" );
+
+    if( xFailureSites > 0 )
+    {
+        printf( "failed allocations by call site\n" );
+
+        for( x = 0; x < xFailureSites; x++ )
+        {
+            prvNameCaller( pcImage, pxFailures[ x ].ullCaller, cName, sizeof( cName ) );
+            printf( "%10llu  0x%-16llx  %s\n", ( unsigned long long ) pxFailures[ x ].ullFailures,
+                    ( unsigned long long ) pxFailures[ x ].ullCaller, cName );
+        }
+
+        printf( "\n" );
+    }
+
+    free( pxSites );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Draw the heap from the lowest block traced, one character for each part of
+ * it: '#' all in live blocks, '+' partly, and '.' not at all. */
+static void prvReportMap( size_t xColumns )
+{
+    Block_t ** ppxBlocks, * pxBlock;
+    size_t xBlocks = 0, xCells = xColumns * reportMAP_ROWS, xCell, ulBucket, x;
+    uint64_t ullEnd, ullCellSize, ullStart, ullFrom, ullTo = 0, ullGap, ullLargestGap = 0, ullCovered;
+    uint64_t * pullUsed;
+
+    if( ullLiveBlocks == 0 )
+    {
+        return;
+    }
+
+    ppxBlocks = malloc( ullLiveBlocks * sizeof( Block_t * ) );
+    pullUsed = calloc( xCells, sizeof( uint64_t ) );
+
+    if( ( ppxBlocks == NULL ) || ( pullUsed == NULL ) )
+    {
+        perror( "heap_trace_report" );
+        exit( 2 );
+    }
+
+    for( ulBucket = 0; ulBucket < reportHASH_BUCKETS; ulBucket++ )
+    {
+        for( pxBlock = pxBuckets[ ulBucket ]; pxBlock != NULL; pxBlock = pxBlock->pxNext )
+        {
+            ppxBlocks[ xBlocks++ ] = pxBlock;
+        }
+    }
+
+    qsort( ppxBlocks, xBlocks, sizeof( Block_t * ), prvCompareBlocks );
+
+    /* The first block allocated is at the start of the heap, less its
+     * header. */
+    ullStart = ullLowestAddress;
+    ullEnd = ppxBlocks[ xBlocks - 1 ]->ullAddress + ppxBlocks[ xBlocks - 1 ]->ullSize;
+
+    if( ( ulHeapTotal != 0 ) && ( ullStart + ulHeapTotal > ullEnd ) )
+    {
+        ullEnd = ullStart + ulHeapTotal;
+    }
+
+    ullCellSize = ( ullEnd - ullStart + xCells - 1 ) / xCells;
+
+    for( x = 0; x < xBlocks; x++ )
+    {
+        pxBlock = ppxBlocks[ x ];
+        ullFrom = pxBlock->ullAddress;
+        ullTo = pxBlock->ullAddress + pxBlock->ullSize;
+
+        /* The free space between this block and the last, less headers. */
+        ullGap = ( x == 0 ) ? ullFrom - ullStart : ullFrom - ( ppxBlocks[ x - 1 ]->ullAddress + ppxBlocks[ x - 1 ]->ullSize );
+
+        if( ( ullGap > ullLargestGap ) && ( ullFrom >= ullStart ) )
+        {
+            ullLargestGap = ullGap;
+        }
+
+        while( ullFrom < ullTo )
+        {
+            xCell = ( size_t ) ( ( ullFrom - ullStart ) / ullCellSize );
+            ullCovered = ullStart + ( xCell + 1 ) * ullCellSize;
+
+            if( ullCovered > ullTo )
+            {
+                ullCovered = ullTo;
+            }
+
+            pullUsed[ xCell ] += ullCovered - ullFrom;
+            ullFrom = ullCovered;
+        }
+    }
+
+    if( ullEnd - ullTo > ullLargestGap )
+    {
+        ullLargestGap = ullEnd - ullTo;
+    }
+
+    printf( "heap map from 0x%llx, %llu bytes a character, '#' in use, '+' partly, '.' free\n",
+            ( unsigned long long ) ullStart, ( unsigned long long ) ullCellSize );
+
+    for( xCell = 0; xCell < xCells; xCell++ )
+    {
+        putchar( ( pullUsed[ xCell ] == 0 ) ? '.' : ( pullUsed[ xCell ] >= ullCellSize ) ? '#' : '+' );
+
+        if( ( xCell + 1 ) % xColumns == 0 )
+        {
+            putchar( '\n' );
+        }
+    }
+
+    printf( "largest gap between live blocks  %llu bytes\n\n", ( unsigned long long ) ullLargestGap );
+
+    free( ppxBlocks );
+    free( pullUsed );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReportTotals( void )
+{
+    printf( "records                %12llu\n", ( unsigned long long ) ullRecords );
+    printf( "allocations            %12llu\n", ( unsigned long long ) ullAllocations );
+    printf( "frees                  %12llu\n", ( unsigned long long ) ullFrees );
+    printf( "failed allocations     %12llu\n", ( unsigned long long ) ullFailed );
+    printf( "records lost           %12llu\n", ( unsigned long long ) ullLost );
+    printf( "frees of unknown blocks%12llu\n", ( unsigned long long ) ullUnmatched );
+    printf( "live blocks            %12llu\n", ( unsigned long long ) ullLiveBlocks );
+    printf( "live bytes             %12llu\n", ( unsigned long long ) ullLiveBytes );
+
+    if( ulHz != 0 )
+    {
+        printf( "trace ends at          %12.1f s\n", ( double ) ulLatestTick / ulHz );
+    }
+
+    if( iHaveHeap != 0 )
+    {
+        printf( "heap size              %12lu\n", ulHeapTotal );
+        printf( "free at first, last    %12lu %lu\n", ulFirstFree, ulLastFree );
+        printf( "minimum ever free      %12lu\n", ulMinimumFree );
+    }
+
+    if( ( ullLost != 0 ) || ( ullUnmatched != 0 ) )
+    {
+        printf( "records are missing, so some live blocks may have been freed, and some\n"
+                "blocks not listed may be live\n" );
+    }
+
+    printf( "\n" );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char * argv[] )
+{
+    const char * pcImage = NULL;
+    size_t xMaxSites = 20, xColumns = 64;
+    FILE * pxFile;
+    int iOption;
+
+    while( ( iOption = getopt( argc, argv, "e:r:n:w:" ) ) != -1 )
+    {
+        switch( iOption )
+        {
+            case 'e':
+                pcImage = optarg;
+                break;
+
+            case 'r':
+                pxReplay = fopen( optarg, "w" );
+
+                if( pxReplay == NULL )
+                {
+                    perror( optarg );
+                    return 2;
+                }
+
+                fprintf( pxReplay, "# replay of a heap trace, for heap_benchmark\n" );
+                break;
+
+            case 'n':
+                xMaxSites = strtoul( optarg, NULL, 0 );
+                break;
+
+            case 'w':
+                xColumns = strtoul( optarg, NULL, 0 );
+                break;
+
+            default:
+                fprintf( stderr, "usage: heap_trace_report [-e image] [-r replay] [-n sites] [-w columns] [trace ...]\n" );
+                return 2;
+        }
+    }
+
+    if( xColumns == 0 )
+    {
+        xColumns = 64;
+    }
+
+    if( optind == argc )
+    {
+        prvReadTrace( stdin );
+    }
+
+    for( ; optind < argc; optind++ )
+    {
+        pxFile = fopen( argv[ optind ], "r" );
+
+        if( pxFile == NULL )
+        {
+            perror( argv[ optind ] );
+            return 2;
+        }
+
+        prvReadTrace( pxFile );
+        fclose( pxFile );
+    }
+
+    if( pxReplay != NULL )
+    {
+        fclose( pxReplay );
+    }
+
+    prvReportTotals();
+    prvReportCallSites( pcImage, xMaxSites );
+    prvReportMap( xColumns );
+
+    return 0;
+}
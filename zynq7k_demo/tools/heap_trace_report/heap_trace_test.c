@@ -0,0 +1,474 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file heap_trace_test.c
+ * @brief Test of heap_trace.c on the Linux simulator port, with heap_4.c.
+ *
+ * Checks that each pvPortMalloc() and vPortFree() is recorded with its block,
+ * size, caller, task and tick count, that a failed allocation is recorded,
+ * that records which do not fit are counted, and the lines
+ * xHeapTraceFormat() writes. Then two functions leak blocks, prvLeakA() ten
+ * in this task and prvLeakB() five of twenty in a task named Leak, and the
+ * whole trace is written to the file named, for heap_trace_report to find
+ * them in.
+ *
+ * Usage: heap_trace_test [dump]
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "heap_trace.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define tracetestPRIORITY      ( tskIDLE_PRIORITY + 1 )
+
+/* How far into a function its calls can be. */
+#define tracetestMAX_FUNCTION_SIZE    512
+
+typedef struct TraceResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} TraceResult_t;
+
+enum
+{
+    traceRECORDS = 0,
+    traceFAILED,
+    traceDROPPED,
+    traceFORMAT,
+    traceDUMP,
+    traceNUM_RESULTS
+};
+
+static TraceResult_t xResults[ traceNUM_RESULTS ] =
+{
+    { "records match the calls",      0, 0 },
+    { "failed allocations recorded",  0, 0 },
+    { "records dropped when full",    0, 0 },
+    { "formatted lines",              0, 0 },
+    { "dump lines written",           0, 0 }
+};
+
+static const char * pcDumpName = NULL;
+
+/* Blocks kept until the test ends, so they are still live in the dump. */
+static void * pvLeaked[ 32 ];
+static uint32_t ulLeaked = 0;
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    /* Only async-signal-safe calls, as this can run in a simulated
+     * interrupt. */
+    lLength = snprintf( cMessage, sizeof( cMessage ), "ASSERT: %s:%lu\n", pcFile, ulLine );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheck( uint32_t ulResult,
+                      BaseType_t xPassed )
+{
+    xResults[ ulResult ].ulCount++;
+
+    if( xPassed == pdFALSE )
+    {
+        xResults[ ulResult ].ulFailures++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCalledFrom( const HeapTraceRecord_t * pxRecord,
+                                 void ( * pxFunction )( void ) )
+{
+    uintptr_t uxCaller = ( uintptr_t ) pxRecord->pvCaller, uxFunction = ( uintptr_t ) pxFunction;
+
+    return ( ( uxCaller > uxFunction ) && ( uxCaller < uxFunction + tracetestMAX_FUNCTION_SIZE ) ) ? pdTRUE : pdFALSE;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvDrain( void )
+{
+    HeapTraceRecord_t xRecord;
+    uint32_t ulDropped;
+
+    while( uxHeapTraceRead( &xRecord, 1, &ulDropped ) > 0 )
+    {
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void * pvAllocated;
+
+static void __attribute__( ( noinline ) ) prvAllocate( void )
+{
+    pvAllocated = pvPortMalloc( 100 );
+}
+
+static void __attribute__( ( noinline ) ) prvFree( void )
+{
+    vPortFree( pvAllocated );
+}
+
+static void __attribute__( ( noinline ) ) prvAllocateTooMuch( void )
+{
+    pvAllocated = pvPortMalloc( configTOTAL_HEAP_SIZE * 2 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void __attribute__( ( noinline ) ) prvLeakA( void )
+{
+    uint32_t ul;
+
+    for( ul = 0; ul < 10; ul++ )
+    {
+        pvLeaked[ ulLeaked++ ] = pvPortMalloc( 100 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void __attribute__( ( noinline ) ) prvLeakB( void )
+{
+    void * pvBlocks[ 20 ];
+    uint32_t ul;
+
+    for( ul = 0; ul < 20; ul++ )
+    {
+        pvBlocks[ ul ] = pvPortMalloc( 48 );
+    }
+
+    for( ul = 0; ul < 20; ul++ )
+    {
+        if( ul % 4 == 3 )
+        {
+            pvLeaked[ ulLeaked++ ] = pvBlocks[ ul ];
+        }
+        else
+        {
+            vPortFree( pvBlocks[ ul ] );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvLeakTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    prvLeakB();
+
+    /* Suspended rather than deleted, so that its name is in the dump. */
+    vTaskSuspend( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckRecords( void )
+{
+    HeapTraceRecord_t xRecords[ 4 ];
+    TickType_t xStart;
+    void * pvBlock;
+    uint32_t ulDropped;
+
+    prvDrain();
+    xStart = xTaskGetTickCount();
+
+    prvAllocate();
+    pvBlock = pvAllocated;
+    vTaskDelay( 2 );
+    prvFree();
+
+    prvCheck( traceRECORDS, ( uxHeapTraceRead( xRecords, 4, &ulDropped ) == 2 ) && ( ulDropped == 0 ) );
+
+    /* The sizes are of the heap's blocks, so include the header. */
+    prvCheck( traceRECORDS, heaptraceGET_EVENT( &xRecords[ 0 ] ) == heaptraceMALLOC );
+    prvCheck( traceRECORDS, xRecords[ 0 ].pvAddress == pvBlock );
+    prvCheck( traceRECORDS, heaptraceGET_SIZE( &xRecords[ 0 ] ) >= 100 );
+    prvCheck( traceRECORDS, prvCalledFrom( &xRecords[ 0 ], prvAllocate ) );
+    prvCheck( traceRECORDS, xRecords[ 0 ].xTask == xTaskGetCurrentTaskHandle() );
+    prvCheck( traceRECORDS, xRecords[ 0 ].xTickCount == xStart );
+
+    prvCheck( traceRECORDS, heaptraceGET_EVENT( &xRecords[ 1 ] ) == heaptraceFREE );
+    prvCheck( traceRECORDS, xRecords[ 1 ].pvAddress == pvBlock );
+    prvCheck( traceRECORDS, heaptraceGET_SIZE( &xRecords[ 1 ] ) == heaptraceGET_SIZE( &xRecords[ 0 ] ) );
+    prvCheck( traceRECORDS, prvCalledFrom( &xRecords[ 1 ], prvFree ) );
+    prvCheck( traceRECORDS, xRecords[ 1 ].xTask == xTaskGetCurrentTaskHandle() );
+    prvCheck( traceRECORDS, xRecords[ 1 ].xTickCount >= xStart + 2 );
+
+    prvAllocateTooMuch();
+    prvCheck( traceFAILED, pvAllocated == NULL );
+    prvCheck( traceFAILED, uxHeapTraceRead( xRecords, 4, NULL ) == 1 );
+    prvCheck( traceFAILED, heaptraceGET_EVENT( &xRecords[ 0 ] ) == heaptraceMALLOC_FAILED );
+    prvCheck( traceFAILED, xRecords[ 0 ].pvAddress == NULL );
+    prvCheck( traceFAILED, heaptraceGET_SIZE( &xRecords[ 0 ] ) >= configTOTAL_HEAP_SIZE * 2 );
+    prvCheck( traceFAILED, prvCalledFrom( &xRecords[ 0 ], prvAllocateTooMuch ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckDropped( void )
+{
+    HeapTraceRecord_t xRecord, xFirst;
+    uint32_t ul, ulDropped, ulRead = 0;
+    void * pvFirst = NULL;
+
+    prvDrain();
+
+    /* Ten more records than fit, which are the newest. */
+    for( ul = 0; ul < ( configHEAP_TRACE_LENGTH + 10 ) / 2; ul++ )
+    {
+        prvAllocate();
+        prvFree();
+
+        if( ul == 0 )
+        {
+            pvFirst = pvAllocated;
+        }
+    }
+
+    prvCheck( traceDROPPED, uxHeapTraceRead( &xFirst, 1, &ulDropped ) == 1 );
+    prvCheck( traceDROPPED, ( xFirst.pvAddress == pvFirst ) && ( heaptraceGET_EVENT( &xFirst ) == heaptraceMALLOC ) );
+    ulRead++;
+
+    while( uxHeapTraceRead( &xRecord, 1, &ul ) > 0 )
+    {
+        ulRead++;
+        ulDropped += ul;
+    }
+
+    ulDropped += ul;
+    prvCheck( traceDROPPED, ulRead == configHEAP_TRACE_LENGTH );
+    prvCheck( traceDROPPED, ulDropped == 10 );
+
+    /* Once read, the dropped count starts again. */
+    prvCheck( traceDROPPED, ( uxHeapTraceRead( &xRecord, 1, &ulDropped ) == 0 ) && ( ulDropped == 0 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckFormat( void )
+{
+    static char cBuffer[ 4096 ];
+    char * pcLine;
+    char cExpected[ 80 ];
+    size_t xLength;
+    uint32_t ul, ulRecords = 0, ulLost = 0, ulTasks = 0, ulHeap = 0, ulHz = 0, ulLines = 0;
+    unsigned long ulCount, ulTask, ulAddress;
+
+    prvDrain();
+    prvAllocate();
+    prvFree();
+
+    xLength = xHeapTraceFormat( cBuffer, sizeof( cBuffer ) );
+    prvCheck( traceFORMAT, ( xLength == strlen( cBuffer ) ) && ( xLength > 0 ) );
+
+    /* The first call starts with the tick rate and the heap. */
+    prvCheck( traceFORMAT, strncmp( cBuffer, "HT hz 3e8\r\nHT heap ", 19 ) == 0 );
+
+    snprintf( cExpected, sizeof( cExpected ), "HT task %lx Test\r\n", ( unsigned long ) ( uintptr_t ) xTaskGetCurrentTaskHandle() );
+    prvCheck( traceFORMAT, strstr( cBuffer, cExpected ) != NULL );
+    prvCheck( traceFORMAT, strstr( cBuffer, "HT task " ) < strstr( cBuffer, "HT m " ) );
+
+    pcLine = strstr( cBuffer, "HT m " );
+    prvCheck( traceFORMAT, ( pcLine != NULL ) &&
+              ( sscanf( pcLine, "HT m %*x %lx %*x %lx %lx", &ulTask, &ulAddress, &ulCount ) == 3 ) &&
+              ( ulTask == ( unsigned long ) ( uintptr_t ) xTaskGetCurrentTaskHandle() ) &&
+              ( ulAddress == ( unsigned long ) ( uintptr_t ) pvAllocated ) && ( ulCount >= 100 ) &&
+              ( strstr( pcLine, "\r\nHT f " ) != NULL ) );
+
+    /* Nothing more, and nothing at all when there is nothing to write. */
+    prvCheck( traceFORMAT, xHeapTraceFormat( cBuffer, sizeof( cBuffer ) ) == 0 );
+
+    /* With a buffer of the least size, and records dropped, each line is
+     * written whole and the count of dropped records comes last. */
+    for( ul = 0; ul < configHEAP_TRACE_LENGTH; ul++ )
+    {
+        prvAllocate();
+        prvFree();
+    }
+
+    while( ( xLength = xHeapTraceFormat( cBuffer, 80 ) ) > 0 )
+    {
+        prvCheck( traceFORMAT, ( xLength < 80 ) && ( xLength == strlen( cBuffer ) ) );
+
+        for( pcLine = cBuffer; *pcLine != '\0'; pcLine = strstr( pcLine, "\r\n" ) + 2 )
+        {
+            ulLines++;
+            prvCheck( traceFORMAT, strstr( pcLine, "\r\n" ) != NULL );
+
+            if( strncmp( pcLine, "HT lost ", 8 ) == 0 )
+            {
+                prvCheck( traceFORMAT, ( sscanf( pcLine, "HT lost %lx", &ulCount ) == 1 ) && ( ulCount == configHEAP_TRACE_LENGTH ) );
+                ulLost++;
+            }
+            else if( ( strncmp( pcLine, "HT m ", 5 ) == 0 ) || ( strncmp( pcLine, "HT f ", 5 ) == 0 ) )
+            {
+                prvCheck( traceFORMAT, ulLost == 0 );
+                ulRecords++;
+            }
+            else if( strncmp( pcLine, "HT task ", 8 ) == 0 )
+            {
+                ulTasks++;
+            }
+            else if( strncmp( pcLine, "HT heap ", 8 ) == 0 )
+            {
+                ulHeap++;
+            }
+            else if( strncmp( pcLine, "HT hz ", 6 ) == 0 )
+            {
+                ulHz++;
+            }
+            else
+            {
+                prvCheck( traceFORMAT, pdFALSE );
+            }
+        }
+    }
+
+    /* The tasks have not changed, so are not named again. */
+    prvCheck( traceFORMAT, ( ulRecords == configHEAP_TRACE_LENGTH ) && ( ulLost == 1 ) );
+    prvCheck( traceFORMAT, ( ulTasks == 0 ) && ( ulHz == 0 ) && ( ulHeap > 0 ) );
+    prvCheck( traceFORMAT, ulLines > configHEAP_TRACE_LENGTH );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvWriteDump( void )
+{
+    static char cBuffer[ 512 ];
+    FILE * pxFile;
+    size_t xLength;
+    uint32_t ul;
+    TaskHandle_t xLeakTask;
+
+    prvDrain();
+
+    pxFile = fopen( pcDumpName, "w" );
+
+    if( pxFile == NULL )
+    {
+        perror( pcDumpName );
+        prvCheck( traceDUMP, pdFALSE );
+        return;
+    }
+
+    /* Write as it goes, as the target's logging task does, so that no
+     * records are dropped. */
+    prvLeakA();
+
+    while( ( xLength = xHeapTraceFormat( cBuffer, sizeof( cBuffer ) ) ) > 0 )
+    {
+        prvCheck( traceDUMP, fwrite( cBuffer, 1, xLength, pxFile ) == xLength );
+    }
+
+    /* A task created now is named, as the number of tasks has changed. */
+    configASSERT( xTaskCreate( prvLeakTask, "Leak", configMINIMAL_STACK_SIZE, NULL, tracetestPRIORITY + 1, &xLeakTask ) == pdPASS );
+
+    for( ul = 0; ul < 5; ul++ )
+    {
+        prvAllocate();
+        prvFree();
+    }
+
+    while( ( xLength = xHeapTraceFormat( cBuffer, sizeof( cBuffer ) ) ) > 0 )
+    {
+        prvCheck( traceDUMP, fwrite( cBuffer, 1, xLength, pxFile ) == xLength );
+    }
+
+    prvCheck( traceDUMP, fclose( pxFile ) == 0 );
+    vTaskDelete( xLeakTask );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void * pvParameters )
+{
+    uint32_t ul;
+
+    ( void ) pvParameters;
+
+    prvCheckRecords();
+    prvCheckDropped();
+    prvCheckFormat();
+
+    if( pcDumpName != NULL )
+    {
+        prvWriteDump();
+    }
+
+    for( ul = 0; ul < ulLeaked; ul++ )
+    {
+        vPortFree( pvLeaked[ ul ] );
+    }
+
+    vTaskEndScheduler();
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char * argv[] )
+{
+    uint32_t ul, ulFailures = 0;
+
+    if( argc > 1 )
+    {
+        pcDumpName = argv[ 1 ];
+    }
+
+    configASSERT( xTaskCreate( prvTestTask, "Test", configMINIMAL_STACK_SIZE * 4, NULL, tracetestPRIORITY, NULL ) == pdPASS );
+
+    vTaskStartScheduler();
+
+    for( ul = 0; ul < traceNUM_RESULTS; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}
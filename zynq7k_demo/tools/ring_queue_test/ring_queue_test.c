@@ -0,0 +1,665 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file ring_queue_test.c
+ * @brief Test and benchmark of ring queues against queues on the Linux
+ * simulator port.
+ *
+ * A ring queue must refuse items when full and hand them over in order, and
+ * a receive must wait out its block time when no item arrives. Items sent from
+ * a simulated interrupt to a single producer ring queue, and from four tasks
+ * and an interrupt to a multiple producer ring queue, must all arrive once and
+ * in each producer's order, with the reader blocking whenever it catches up.
+ * The time per item to send and receive without blocking is measured for a
+ * queue and for both kinds of ring queue, and the ring queues must be faster,
+ * and the round trip time between two tasks that block is reported for a
+ * queue and a ring queue. Built for two cores the writers and the reader run
+ * in parallel.
+ *
+ * Usage: ring_queue_test
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "ring_queue.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ringREADER_PRIORITY      ( tskIDLE_PRIORITY + 2 )
+#define ringWRITER_PRIORITY      ( tskIDLE_PRIORITY + 1 )
+
+#define ringINTERRUPT            ( portINTERRUPT_TICK + 1UL )
+
+#define ringLENGTH               16
+
+#define ringTIMEOUT_TICKS        20
+#define ringTIMEOUTS             10
+
+#define ringINTERRUPT_ITEMS      5000
+
+#define ringWRITERS              4
+#define ringWRITER_ITEMS         20000
+
+/* The block time of a reader that expects an item, long enough to cover the
+ * host holding up the tasks now and then. */
+#define ringRECEIVE_TICKS        pdMS_TO_TICKS( 2000 )
+
+#define ringBENCHMARK_ITEMS      200000
+#define ringBENCHMARK_BATCH      8
+#define ringBENCHMARK_RUNS       5
+#define ringROUND_TRIPS          5000
+
+typedef struct RingResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} RingResult_t;
+
+enum
+{
+    ringFULL_AND_EMPTY = 0,
+    ringTIMEOUTS_EARLY,
+    ringINTERRUPT_LOST,
+    ringINTERRUPT_FULL,
+    ringWRITERS_LOST,
+    ringQUEUE_COST,
+    ringSINGLE_COST,
+    ringMULTIPLE_COST,
+    ringQUEUE_ROUND_TRIP,
+    ringRING_ROUND_TRIP,
+    ringNUM_RESULTS
+};
+
+static RingResult_t xResults[ ringNUM_RESULTS ] =
+{
+    { "full and empty checks",        0, 0 },
+    { "receives timed out early",     0, 0 },
+    { "interrupt items received",     0, 0 },
+    { "interrupt sends refused",      0, 0 },
+    { "task and interrupt items",     0, 0 },
+    { "queue ns per item",            0, 0 },
+    { "single producer ns per item",  0, 0 },
+    { "multi producer ns per item",   0, 0 },
+    { "queue round trip ns",          0, 0 },
+    { "ring queue round trip ns",     0, 0 }
+};
+
+/* An item identifies its writer, the interrupt being writer ringWRITERS, and
+ * counts that writer's items. */
+typedef struct RingItem
+{
+    uint32_t ulWriter;
+    uint32_t ulSequence;
+} RingItem_t;
+
+/* The ring queue the interrupt writes, the items it is to write, and the
+ * number it has written. */
+static RingQueueHandle_t xInterruptRing = NULL;
+static volatile uint32_t ulInterruptItems = 0;
+static volatile uint32_t ulInterruptSent = 0;
+static volatile BaseType_t xInterruptsRunning = pdFALSE;
+
+/* The ring queue and queue of the round trip benchmark's echo task. */
+static RingQueueHandle_t xEchoRings[ 2 ];
+static QueueHandle_t xEchoQueues[ 2 ];
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    /* Only async-signal-safe calls, as this can run in a simulated
+     * interrupt. */
+    lLength = snprintf( cMessage, sizeof( cMessage ), "ASSERT: %s:%lu\n", pcFile, ulLine );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    configASSERT( pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvGetHostNanoseconds( void )
+{
+    struct timespec xNow;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( uint64_t ) xNow.tv_sec * 1000000000ULL + ( uint64_t ) xNow.tv_nsec;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFail( uint32_t ulResult )
+{
+    xResults[ ulResult ].ulFailures++;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheck( BaseType_t xPassed )
+{
+    xResults[ ringFULL_AND_EMPTY ].ulCount++;
+
+    if( xPassed == pdFALSE )
+    {
+        prvFail( ringFULL_AND_EMPTY );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvInterruptHandler( void )
+{
+    BaseType_t xWoken = pdFALSE;
+    RingItem_t xItem;
+
+    if( ( xInterruptRing != NULL ) && ( ulInterruptSent < ulInterruptItems ) )
+    {
+        xItem.ulWriter = ringWRITERS;
+        xItem.ulSequence = ulInterruptSent;
+
+        if( xRingQueueSendFromISR( xInterruptRing, &xItem, &xWoken ) == pdPASS )
+        {
+            ulInterruptSent++;
+        }
+        else
+        {
+            xResults[ ringINTERRUPT_FULL ].ulCount++;
+        }
+    }
+
+    return ( uint32_t ) xWoken;
+}
+
+/*-----------------------------------------------------------*/
+
+static void * prvInterruptThread( void * pvParameters )
+{
+    sigset_t xSignals;
+    struct timespec xDelay;
+
+    ( void ) pvParameters;
+
+    /* The simulated interrupts are for the task threads. */
+    sigfillset( &xSignals );
+    pthread_sigmask( SIG_BLOCK, &xSignals, NULL );
+
+    for( ; ; )
+    {
+        xDelay.tv_sec = 0;
+        xDelay.tv_nsec = 10000L;
+        ( void ) nanosleep( &xDelay, NULL );
+
+        if( xInterruptsRunning != pdFALSE )
+        {
+            vPortGenerateSimulatedInterrupt( ringINTERRUPT );
+        }
+    }
+
+    return NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckFullAndEmpty( BaseType_t xMultipleProducers )
+{
+    RingQueueHandle_t xRing = xRingQueueGenericCreate( ringLENGTH - 3, sizeof( RingItem_t ), xMultipleProducers );
+    RingItem_t xItem;
+    uint32_t ulLap, ul;
+
+    configASSERT( xRing != NULL );
+
+    /* Enough laps to wrap the slots, each filling the ring queue, which has
+     * the length rounded up to a power of two, and emptying it. */
+    for( ulLap = 0; ulLap < 3; ulLap++ )
+    {
+        prvCheck( ( uxRingQueueMessagesWaiting( xRing ) == 0U ) ? pdTRUE : pdFALSE );
+        prvCheck( ( xRingQueueReceive( xRing, &xItem, 0 ) == pdFAIL ) ? pdTRUE : pdFALSE );
+
+        for( ul = 0; ul < ringLENGTH; ul++ )
+        {
+            xItem.ulWriter = 0;
+            xItem.ulSequence = ulLap * ringLENGTH + ul;
+            prvCheck( ( xRingQueueSend( xRing, &xItem ) == pdPASS ) ? pdTRUE : pdFALSE );
+        }
+
+        prvCheck( ( xRingQueueSend( xRing, &xItem ) == errQUEUE_FULL ) ? pdTRUE : pdFALSE );
+        prvCheck( ( uxRingQueueMessagesWaiting( xRing ) == ringLENGTH ) ? pdTRUE : pdFALSE );
+
+        for( ul = 0; ul < ringLENGTH; ul++ )
+        {
+            prvCheck( ( ( xRingQueueReceive( xRing, &xItem, 0 ) == pdPASS ) &&
+                        ( xItem.ulSequence == ulLap * ringLENGTH + ul ) ) ? pdTRUE : pdFALSE );
+        }
+    }
+
+    vRingQueueDelete( xRing );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckTimeouts( void )
+{
+    RingQueueHandle_t xRing = xRingQueueCreate( ringLENGTH, sizeof( RingItem_t ) );
+    RingItem_t xItem;
+    TickType_t xStart;
+    uint32_t ul;
+
+    configASSERT( xRing != NULL );
+
+    for( ul = 0; ul < ringTIMEOUTS; ul++ )
+    {
+        xStart = xTaskGetTickCount();
+
+        if( xRingQueueReceive( xRing, &xItem, ringTIMEOUT_TICKS ) != pdFAIL )
+        {
+            prvCheck( pdFALSE );
+        }
+        else if( ( xTaskGetTickCount() - xStart ) < ringTIMEOUT_TICKS )
+        {
+            xResults[ ringTIMEOUTS_EARLY ].ulCount++;
+            prvFail( ringTIMEOUTS_EARLY );
+        }
+    }
+
+    vRingQueueDelete( xRing );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckInterruptToTask( void )
+{
+    RingItem_t xItem;
+    uint32_t ulExpected = 0;
+
+    xInterruptRing = xRingQueueCreate( ringLENGTH, sizeof( RingItem_t ) );
+    configASSERT( xInterruptRing != NULL );
+    ulInterruptSent = 0;
+    ulInterruptItems = ringINTERRUPT_ITEMS;
+    xInterruptsRunning = pdTRUE;
+
+    while( ulExpected < ringINTERRUPT_ITEMS )
+    {
+        if( xRingQueueReceive( xInterruptRing, &xItem, ringRECEIVE_TICKS ) == pdFAIL )
+        {
+            break;
+        }
+
+        if( ( xItem.ulWriter == ringWRITERS ) && ( xItem.ulSequence == ulExpected ) )
+        {
+            ulExpected++;
+        }
+        else
+        {
+            break;
+        }
+
+        /* Let the ring queue fill now and then. */
+        if( ( ulExpected % 1000U ) == 0U )
+        {
+            vTaskDelay( 1 );
+        }
+    }
+
+    xInterruptsRunning = pdFALSE;
+    xResults[ ringINTERRUPT_LOST ].ulCount = ulExpected;
+
+    if( ulExpected != ringINTERRUPT_ITEMS )
+    {
+        prvFail( ringINTERRUPT_LOST );
+    }
+
+    /* No interrupt can be using the ring queue once it is stopped and a
+     * tick has passed. */
+    vTaskDelay( 1 );
+    vRingQueueDelete( xInterruptRing );
+    xInterruptRing = NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvWriterTask( void * pvParameters )
+{
+    RingQueueHandle_t xRing = xInterruptRing;
+    RingItem_t xItem;
+
+    xItem.ulWriter = ( uint32_t ) ( uintptr_t ) pvParameters;
+
+    for( xItem.ulSequence = 0; xItem.ulSequence < ringWRITER_ITEMS; xItem.ulSequence++ )
+    {
+        while( xRingQueueSend( xRing, &xItem ) != pdPASS )
+        {
+            taskYIELD();
+        }
+    }
+
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckTasksToTask( void )
+{
+    uint32_t ulExpected[ ringWRITERS + 1 ] = { 0 };
+    uint32_t ulReceived = 0, ul;
+    RingItem_t xItem;
+
+    xInterruptRing = xRingQueueCreateMultipleProducers( ringLENGTH, sizeof( RingItem_t ) );
+    configASSERT( xInterruptRing != NULL );
+    ulInterruptSent = 0;
+    ulInterruptItems = ringINTERRUPT_ITEMS;
+
+    for( ul = 0; ul < ringWRITERS; ul++ )
+    {
+        configASSERT( xTaskCreate( prvWriterTask, "Writer", configMINIMAL_STACK_SIZE, ( void * ) ( uintptr_t ) ul, ringWRITER_PRIORITY, NULL ) == pdPASS );
+    }
+
+    xInterruptsRunning = pdTRUE;
+
+    while( ulReceived < ringWRITERS * ringWRITER_ITEMS + ringINTERRUPT_ITEMS )
+    {
+        if( xRingQueueReceive( xInterruptRing, &xItem, ringRECEIVE_TICKS ) == pdFAIL )
+        {
+            break;
+        }
+
+        if( ( xItem.ulWriter <= ringWRITERS ) && ( xItem.ulSequence == ulExpected[ xItem.ulWriter ] ) )
+        {
+            ulExpected[ xItem.ulWriter ]++;
+            ulReceived++;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    xInterruptsRunning = pdFALSE;
+    xResults[ ringWRITERS_LOST ].ulCount = ulReceived;
+
+    if( ulReceived != ringWRITERS * ringWRITER_ITEMS + ringINTERRUPT_ITEMS )
+    {
+        prvFail( ringWRITERS_LOST );
+    }
+
+    /* Let the writers, which have sent all their items, be deleted. */
+    vTaskDelay( 10 );
+    vRingQueueDelete( xInterruptRing );
+    xInterruptRing = NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvMedian( uint32_t * pulValues,
+                           uint32_t ulCount )
+{
+    uint32_t ul, ulNext, ulValue;
+
+    for( ul = 1; ul < ulCount; ul++ )
+    {
+        ulValue = pulValues[ ul ];
+
+        for( ulNext = ul; ( ulNext > 0U ) && ( pulValues[ ulNext - 1U ] > ulValue ); ulNext-- )
+        {
+            pulValues[ ulNext ] = pulValues[ ulNext - 1U ];
+        }
+
+        pulValues[ ulNext ] = ulValue;
+    }
+
+    return pulValues[ ulCount / 2U ];
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvMeasureQueue( void )
+{
+    QueueHandle_t xQueue = xQueueCreate( ringLENGTH, sizeof( RingItem_t ) );
+    RingItem_t xItem = { 0, 0 };
+    uint32_t ulTimes[ ringBENCHMARK_RUNS ];
+    uint32_t ulRun, ul, ulBatch;
+    uint64_t ullStart;
+
+    configASSERT( xQueue != NULL );
+
+    for( ulRun = 0; ulRun < ringBENCHMARK_RUNS; ulRun++ )
+    {
+        ullStart = prvGetHostNanoseconds();
+
+        for( ul = 0; ul < ringBENCHMARK_ITEMS; ul += ringBENCHMARK_BATCH )
+        {
+            for( ulBatch = 0; ulBatch < ringBENCHMARK_BATCH; ulBatch++ )
+            {
+                ( void ) xQueueSend( xQueue, &xItem, 0 );
+            }
+
+            for( ulBatch = 0; ulBatch < ringBENCHMARK_BATCH; ulBatch++ )
+            {
+                ( void ) xQueueReceive( xQueue, &xItem, 0 );
+            }
+        }
+
+        ulTimes[ ulRun ] = ( uint32_t ) ( ( prvGetHostNanoseconds() - ullStart ) / ringBENCHMARK_ITEMS );
+    }
+
+    vQueueDelete( xQueue );
+
+    return prvMedian( ulTimes, ringBENCHMARK_RUNS );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvMeasureRingQueue( BaseType_t xMultipleProducers )
+{
+    RingQueueHandle_t xRing = xRingQueueGenericCreate( ringLENGTH, sizeof( RingItem_t ), xMultipleProducers );
+    RingItem_t xItem = { 0, 0 };
+    uint32_t ulTimes[ ringBENCHMARK_RUNS ];
+    uint32_t ulRun, ul, ulBatch;
+    uint64_t ullStart;
+
+    configASSERT( xRing != NULL );
+
+    for( ulRun = 0; ulRun < ringBENCHMARK_RUNS; ulRun++ )
+    {
+        ullStart = prvGetHostNanoseconds();
+
+        for( ul = 0; ul < ringBENCHMARK_ITEMS; ul += ringBENCHMARK_BATCH )
+        {
+            for( ulBatch = 0; ulBatch < ringBENCHMARK_BATCH; ulBatch++ )
+            {
+                ( void ) xRingQueueSend( xRing, &xItem );
+            }
+
+            for( ulBatch = 0; ulBatch < ringBENCHMARK_BATCH; ulBatch++ )
+            {
+                ( void ) xRingQueueReceive( xRing, &xItem, 0 );
+            }
+        }
+
+        ulTimes[ ulRun ] = ( uint32_t ) ( ( prvGetHostNanoseconds() - ullStart ) / ringBENCHMARK_ITEMS );
+    }
+
+    vRingQueueDelete( xRing );
+
+    return prvMedian( ulTimes, ringBENCHMARK_RUNS );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvMeasureCost( void )
+{
+    xResults[ ringQUEUE_COST ].ulCount = prvMeasureQueue();
+    xResults[ ringSINGLE_COST ].ulCount = prvMeasureRingQueue( pdFALSE );
+    xResults[ ringMULTIPLE_COST ].ulCount = prvMeasureRingQueue( pdTRUE );
+
+    if( xResults[ ringSINGLE_COST ].ulCount >= xResults[ ringQUEUE_COST ].ulCount )
+    {
+        prvFail( ringSINGLE_COST );
+    }
+
+    if( xResults[ ringMULTIPLE_COST ].ulCount >= xResults[ ringQUEUE_COST ].ulCount )
+    {
+        prvFail( ringMULTIPLE_COST );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvEchoTask( void * pvParameters )
+{
+    RingItem_t xItem;
+
+    /* Echo items back until the one that ends the benchmark. */
+    if( pvParameters != NULL )
+    {
+        do
+        {
+            configASSERT( xRingQueueReceive( xEchoRings[ 0 ], &xItem, portMAX_DELAY ) == pdPASS );
+            configASSERT( xRingQueueSend( xEchoRings[ 1 ], &xItem ) == pdPASS );
+        } while( xItem.ulSequence != ringROUND_TRIPS );
+    }
+    else
+    {
+        do
+        {
+            configASSERT( xQueueReceive( xEchoQueues[ 0 ], &xItem, portMAX_DELAY ) == pdPASS );
+            configASSERT( xQueueSend( xEchoQueues[ 1 ], &xItem, 0 ) == pdPASS );
+        } while( xItem.ulSequence != ringROUND_TRIPS );
+    }
+
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvMeasureRoundTrips( BaseType_t xUseRingQueues )
+{
+    RingItem_t xItem = { 0, 0 };
+    uint64_t ullStart;
+    uint32_t ul;
+
+    for( ul = 0; ul < 2; ul++ )
+    {
+        xEchoRings[ ul ] = xRingQueueCreate( 1, sizeof( RingItem_t ) );
+        xEchoQueues[ ul ] = xQueueCreate( 1, sizeof( RingItem_t ) );
+        configASSERT( ( xEchoRings[ ul ] != NULL ) && ( xEchoQueues[ ul ] != NULL ) );
+    }
+
+    /* The echo task runs above this task, so on one core each item is passed
+     * with a context switch each way. */
+    configASSERT( xTaskCreate( prvEchoTask, "Echo", configMINIMAL_STACK_SIZE, ( xUseRingQueues != pdFALSE ) ? ( void * ) xEchoRings : NULL,
+                               ringREADER_PRIORITY + 1, NULL ) == pdPASS );
+    ullStart = prvGetHostNanoseconds();
+
+    for( xItem.ulSequence = 1; xItem.ulSequence <= ringROUND_TRIPS; xItem.ulSequence++ )
+    {
+        if( xUseRingQueues != pdFALSE )
+        {
+            configASSERT( xRingQueueSend( xEchoRings[ 0 ], &xItem ) == pdPASS );
+            configASSERT( xRingQueueReceive( xEchoRings[ 1 ], &xItem, ringRECEIVE_TICKS ) == pdPASS );
+        }
+        else
+        {
+            configASSERT( xQueueSend( xEchoQueues[ 0 ], &xItem, 0 ) == pdPASS );
+            configASSERT( xQueueReceive( xEchoQueues[ 1 ], &xItem, ringRECEIVE_TICKS ) == pdPASS );
+        }
+    }
+
+    xResults[ ( xUseRingQueues != pdFALSE ) ? ringRING_ROUND_TRIP : ringQUEUE_ROUND_TRIP ].ulCount =
+        ( uint32_t ) ( ( prvGetHostNanoseconds() - ullStart ) / ringROUND_TRIPS );
+
+    /* Let the echo task be deleted. */
+    vTaskDelay( 10 );
+
+    for( ul = 0; ul < 2; ul++ )
+    {
+        vRingQueueDelete( xEchoRings[ ul ] );
+        vQueueDelete( xEchoQueues[ ul ] );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    prvCheckFullAndEmpty( pdFALSE );
+    prvCheckFullAndEmpty( pdTRUE );
+    prvCheckTimeouts();
+    prvCheckInterruptToTask();
+    prvCheckTasksToTask();
+    prvMeasureCost();
+    prvMeasureRoundTrips( pdFALSE );
+    prvMeasureRoundTrips( pdTRUE );
+
+    vTaskEndScheduler();
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    pthread_t xInterruptThread;
+    uint32_t ul, ulFailures = 0;
+
+    printf( "ring queues, %d core%s\n\n", configNUM_CORES, ( configNUM_CORES > 1 ) ? "s" : "" );
+
+    vPortSetInterruptHandler( ringINTERRUPT, prvInterruptHandler );
+    configASSERT( pthread_create( &xInterruptThread, NULL, prvInterruptThread, NULL ) == 0 );
+    configASSERT( xTaskCreate( prvTestTask, "Test", configMINIMAL_STACK_SIZE * 4, NULL, ringREADER_PRIORITY, NULL ) == pdPASS );
+
+    vTaskStartScheduler();
+
+    for( ul = 0; ul < ringNUM_RESULTS; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    /* The interrupt thread ends with the process. */
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}
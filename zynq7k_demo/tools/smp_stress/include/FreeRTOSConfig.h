@@ -0,0 +1,86 @@
+/*
+ * Kernel configuration for the SMP stress test, built on the host against the
+ * Linux simulator port.  The number of cores is set on the command line.
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#ifndef configNUM_CORES
+    #define configNUM_CORES    2
+#endif
+
+#define configUSE_PREEMPTION                       1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION    0
+#define configUSE_TICKLESS_IDLE                    0
+#define configUSE_TIME_SLICING                     1
+#define configMAX_PRIORITIES                       ( 7 )
+#define configTICK_RATE_HZ                         ( 1000 )
+#define configMINIMAL_STACK_SIZE                   ( ( unsigned short ) 256 )
+#define configTOTAL_HEAP_SIZE                      ( ( size_t ) ( 8 * 1024 * 1024 ) )
+#define configMAX_TASK_NAME_LEN                    ( 15 )
+#define configUSE_TRACE_FACILITY                   1
+#define configUSE_16_BIT_TICKS                     0
+#define configIDLE_SHOULD_YIELD                    1
+#define configUSE_MUTEXES                          1
+#define configUSE_RECURSIVE_MUTEXES                1
+#define configUSE_COUNTING_SEMAPHORES              1
+#define configUSE_QUEUE_SETS                       0
+#define configQUEUE_REGISTRY_SIZE                  0
+#define configUSE_TASK_NOTIFICATIONS               1
+#define configUSE_CO_ROUTINES                      0
+#define configUSE_NEWLIB_REENTRANT                 0
+#define configUSE_POSIX_ERRNO                      0
+#define configSUPPORT_DYNAMIC_ALLOCATION           1
+#define configSUPPORT_STATIC_ALLOCATION            0
+
+#define configUSE_IDLE_HOOK                        1
+#define configUSE_TICK_HOOK                        1
+#define configUSE_MALLOC_FAILED_HOOK               1
+#define configCHECK_FOR_STACK_OVERFLOW             0
+
+#define configUSE_TIMERS                           1
+#define configTIMER_TASK_PRIORITY                  ( configMAX_PRIORITIES - 1 )
+#define configTIMER_QUEUE_LENGTH                   10
+#define configTIMER_TASK_STACK_DEPTH               configMINIMAL_STACK_SIZE
+
+#define configUSE_EVENT_GROUPS                     1
+
+/* Run time stats in microseconds of host time, see smp_stress.c. */
+#define configGENERATE_RUN_TIME_STATS              1
+unsigned long ulGetRunTimeCounterValue( void );
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()           ulGetRunTimeCounterValue()
+
+#define INCLUDE_vTaskPrioritySet                   1
+#define INCLUDE_uxTaskPriorityGet                  1
+#define INCLUDE_vTaskDelete                        1
+#define INCLUDE_vTaskSuspend                       1
+#define INCLUDE_vTaskDelayUntil                    1
+#define INCLUDE_vTaskDelay                         1
+#define INCLUDE_xTaskGetSchedulerState             1
+#define INCLUDE_xTaskGetCurrentTaskHandle          1
+#define INCLUDE_eTaskGetState                      1
+#define INCLUDE_xTaskAbortDelay                    1
+#define INCLUDE_xTaskResumeFromISR                 1
+#define INCLUDE_xTimerPendFunctionCall             0
+#define INCLUDE_xEventGroupSetBitsFromISR          0
+#define INCLUDE_uxTaskGetStackHighWaterMark        0
+
+/* Give up the host CPU at points where the kernel holds its locks, so the
+ * threads of the other simulated cores run into them even on a single CPU
+ * host. */
+#include <sched.h>
+#define traceTASK_SWITCHED_OUT()                      sched_yield()
+#define traceMOVED_TASK_TO_READY_STATE( pxTCB )       sched_yield()
+#define traceTASK_INCREMENT_TICK( xTickCount )        sched_yield()
+#define traceTASK_PRIORITY_SET( pxTask, uxPriority )  sched_yield()
+#define traceTASK_SUSPEND( pxTask )                   sched_yield()
+#define traceQUEUE_SEND( pxQueue )                    sched_yield()
+#define traceQUEUE_RECEIVE( pxQueue )                 sched_yield()
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine );
+#define configASSERT( x )    if( ( x ) == 0 ) vAssertCalled( __FILE__, __LINE__ )
+
+#endif /* FREERTOS_CONFIG_H */
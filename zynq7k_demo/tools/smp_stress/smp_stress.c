@@ -0,0 +1,793 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file smp_stress.c
+ * @brief Stress test of the kernel's scheduling and locking, run on the Linux
+ * simulator port with one thread per simulated core.
+ *
+ * Each check runs a fixed amount of work in several tasks and counts
+ * invariant violations.  Tasks must not call printf() while the scheduler is
+ * running, so results are printed once it has ended.
+ *
+ * Usage: smp_stress [iterations]
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "event_groups.h"
+#include "timers.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define stressCRITICAL_TASKS       4
+#define stressMUTEX_TASKS          3
+#define stressSYNC_TASKS           3
+#define stressQUEUE_LENGTH         8
+
+/* Bits set in xDoneEvents by the tasks of each check when they finish. */
+#define stressCRITICAL_DONE        ( ( 1UL << stressCRITICAL_TASKS ) - 1UL )
+#define stressMUTEX_SHIFT          stressCRITICAL_TASKS
+#define stressMUTEX_DONE           ( ( ( 1UL << stressMUTEX_TASKS ) - 1UL ) << stressMUTEX_SHIFT )
+#define stressQUEUE_DONE           ( 1UL << 7 )
+#define stressCHURN_DONE           ( 1UL << 8 )
+#define stressSYNC_DONE            ( 1UL << 9 )
+#define stressPRIORITY_DONE        ( 1UL << 10 )
+#define stressALL_DONE                                                             \
+    ( stressCRITICAL_DONE | stressMUTEX_DONE | stressQUEUE_DONE | stressCHURN_DONE \
+      | stressSYNC_DONE | stressPRIORITY_DONE )
+
+#define stressTIMEOUT              pdMS_TO_TICKS( 600000 )
+
+/* Run time counter microseconds the run time check spins and idles for. */
+#define stressRUN_TIME_SPIN        20000UL
+#define stressRUN_TIME_IDLE_MS     100
+
+typedef struct StressResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} StressResult_t;
+
+enum
+{
+    stressCRITICAL = 0,
+    stressMUTEX,
+    stressQUEUE,
+    stressAFFINITY,
+    stressCORES,
+    stressFROM_ISR,
+    stressCHURN,
+    stressSYNC,
+    stressPRIORITY,
+    stressTIMER,
+    stressHEAP,
+    stressRUN_TIME,
+    stressNUM_RESULTS
+};
+
+static StressResult_t xResults[ stressNUM_RESULTS ] =
+{
+    { "critical section counter", 0, 0 },
+    { "mutex exclusion",          0, 0 },
+    { "queue ordering",           0, 0 },
+    { "core affinity",            0, 0 },
+    { "tasks run on every core",  0, 0 },
+    { "give from tick interrupt", 0, 0 },
+    { "create, delete, suspend",  0, 0 },
+    { "event group sync",         0, 0 },
+    { "priority changes",         0, 0 },
+    { "software timer",           0, 0 },
+    { "heap returned",            0, 0 },
+    { "run time, idle percent",   0, 0 }
+};
+
+static uint32_t ulIterations = 20000UL;
+
+static EventGroupHandle_t xDoneEvents;
+static EventGroupHandle_t xSyncEvents;
+static SemaphoreHandle_t xMutex;
+static SemaphoreHandle_t xTickSemaphore;
+static QueueHandle_t xQueue;
+static TimerHandle_t xTimer;
+
+static volatile uint32_t ulSharedCounter = 0;
+static volatile uint32_t ulMutexOwners = 0;
+static volatile uint32_t ulCoresSeen = 0;
+static volatile BaseType_t xStopping = pdFALSE;
+static volatile uint32_t ulTickGives = 0;
+static TaskHandle_t volatile xNotifyTask = NULL;
+static volatile uint32_t ulSyncRounds[ stressSYNC_TASKS ];
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    /* Only async-signal-safe calls, as this can run in a simulated
+     * interrupt. */
+    lLength = snprintf( cMessage, sizeof( cMessage ), "ASSERT: %s:%lu\n", pcFile, ulLine );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+unsigned long ulGetRunTimeCounterValue( void )
+{
+    struct timespec xNow;
+
+    /* Async-signal-safe, as it is read during context switches. */
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( unsigned long ) ( uint32_t ) ( ( uint64_t ) xNow.tv_sec * 1000000ULL + ( uint64_t ) xNow.tv_nsec / 1000ULL );
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    configASSERT( pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+    /* Give the host CPU to the threads of the other simulated cores. */
+    sched_yield();
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationTickHook( void )
+{
+    TaskHandle_t xTask;
+    BaseType_t xWoken = pdFALSE;
+
+    /* Exercise the FromISR paths on core 0 while the other cores run
+     * tasks. */
+    if( ( xTaskGetTickCountFromISR() & 1U ) == 0U )
+    {
+        ulTickGives++;
+        ( void ) xSemaphoreGiveFromISR( xTickSemaphore, &xWoken );
+    }
+
+    /* The task clears the handle before it deletes itself, and cannot be
+     * deleted while an interrupt is in the kernel. */
+    xTask = xNotifyTask;
+
+    if( xTask != NULL )
+    {
+        vTaskNotifyGiveFromISR( xTask, &xWoken );
+    }
+
+    portYIELD_FROM_ISR( xWoken );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFail( uint32_t ulResult )
+{
+    __atomic_fetch_add( &( xResults[ ulResult ].ulFailures ), 1, __ATOMIC_RELAXED );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCount( uint32_t ulResult )
+{
+    __atomic_fetch_add( &( xResults[ ulResult ].ulCount ), 1, __ATOMIC_RELAXED );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSpin( uint32_t ulLoops )
+{
+    volatile uint32_t ul;
+
+    for( ul = 0; ul < ulLoops; ul++ )
+    {
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Returns the core the calling task is running on.
+ */
+static BaseType_t prvCoreID( void )
+{
+    BaseType_t xCoreID = 0;
+
+    #if ( configNUM_CORES > 1 )
+        taskENTER_CRITICAL();
+        {
+            xCoreID = portGET_CORE_ID();
+        }
+        taskEXIT_CRITICAL();
+    #endif
+
+    __atomic_fetch_or( &ulCoresSeen, 1UL << xCoreID, __ATOMIC_RELAXED );
+
+    return xCoreID;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCreateTask( TaskFunction_t pxCode,
+                                 const char * pcName,
+                                 void * pvParameters,
+                                 UBaseType_t uxPriority,
+                                 UBaseType_t uxCoreAffinityMask,
+                                 TaskHandle_t * pxHandle )
+{
+    #if ( configNUM_CORES > 1 )
+        return xTaskCreateAffinitySet( pxCode, pcName, configMINIMAL_STACK_SIZE, pvParameters,
+                                       uxPriority, uxCoreAffinityMask, pxHandle );
+    #else
+        ( void ) uxCoreAffinityMask;
+
+        return xTaskCreate( pxCode, pcName, configMINIMAL_STACK_SIZE, pvParameters, uxPriority, pxHandle );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Increments a shared counter non-atomically inside critical sections.
+ */
+static void prvCriticalTask( void * pvParameters )
+{
+    const uint32_t ulIndex = ( uint32_t ) ( uintptr_t ) pvParameters;
+    uint32_t ul, ulValue;
+
+    for( ul = 0; ul < ulIterations; ul++ )
+    {
+        taskENTER_CRITICAL();
+        {
+            /* Giving up the host CPU lets the other simulated cores run
+             * inside the read-modify-write even on a single CPU host. */
+            ulValue = ulSharedCounter;
+            sched_yield();
+            ulSharedCounter = ulValue + 1U;
+        }
+        taskEXIT_CRITICAL();
+
+        ( void ) prvCoreID();
+
+        if( ( ul % 1000U ) == ulIndex )
+        {
+            vTaskDelay( 1 );
+        }
+    }
+
+    xEventGroupSetBits( xDoneEvents, 1UL << ulIndex );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Takes a mutex at different priorities, so that priority inheritance
+ * is exercised, and checks that no other task holds it.
+ */
+static void prvMutexTask( void * pvParameters )
+{
+    const uint32_t ulIndex = ( uint32_t ) ( uintptr_t ) pvParameters;
+    uint32_t ul;
+
+    for( ul = 0; ul < ulIterations / 4U; ul++ )
+    {
+        if( xSemaphoreTake( xMutex, stressTIMEOUT ) != pdTRUE )
+        {
+            prvFail( stressMUTEX );
+            continue;
+        }
+
+        if( __atomic_fetch_add( &ulMutexOwners, 1, __ATOMIC_SEQ_CST ) != 0U )
+        {
+            prvFail( stressMUTEX );
+        }
+
+        sched_yield();
+        __atomic_fetch_sub( &ulMutexOwners, 1, __ATOMIC_SEQ_CST );
+        prvCount( stressMUTEX );
+        xSemaphoreGive( xMutex );
+
+        if( ( ul % 64U ) == 0U )
+        {
+            vTaskDelay( 1 );
+        }
+    }
+
+    xEventGroupSetBits( xDoneEvents, 1UL << ( stressMUTEX_SHIFT + ulIndex ) );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvProducerTask( void * pvParameters )
+{
+    uint32_t ul;
+
+    ( void ) pvParameters;
+
+    for( ul = 0; ul < ulIterations; ul++ )
+    {
+        if( prvCoreID() != 0 )
+        {
+            prvFail( stressAFFINITY );
+        }
+
+        if( xQueueSend( xQueue, &ul, stressTIMEOUT ) != pdPASS )
+        {
+            prvFail( stressQUEUE );
+        }
+    }
+
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvConsumerTask( void * pvParameters )
+{
+    uint32_t ul, ulReceived;
+
+    ( void ) pvParameters;
+
+    for( ul = 0; ul < ulIterations; ul++ )
+    {
+        if( xQueueReceive( xQueue, &ulReceived, stressTIMEOUT ) != pdPASS )
+        {
+            prvFail( stressQUEUE );
+            break;
+        }
+
+        if( ulReceived != ul )
+        {
+            prvFail( stressQUEUE );
+        }
+
+        if( prvCoreID() != ( BaseType_t ) configNUM_CORES - 1 )
+        {
+            prvFail( stressAFFINITY );
+        }
+
+        prvCount( stressQUEUE );
+    }
+
+    xEventGroupSetBits( xDoneEvents, stressQUEUE_DONE );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Takes the semaphore given by the tick hook, and the notifications it
+ * sends.
+ */
+static void prvFromISRTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    xNotifyTask = xTaskGetCurrentTaskHandle();
+
+    while( xStopping == pdFALSE )
+    {
+        if( xSemaphoreTake( xTickSemaphore, pdMS_TO_TICKS( 100 ) ) == pdTRUE )
+        {
+            prvCount( stressFROM_ISR );
+        }
+
+        ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+    }
+
+    xNotifyTask = NULL;
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvShortLivedTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    prvSpin( 1000 );
+    prvCount( stressCHURN );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvBusyTask( void * pvParameters )
+{
+    volatile uint32_t * pulProgress = ( volatile uint32_t * ) pvParameters;
+
+    for( ; ; )
+    {
+        ( *pulProgress )++;
+        ( void ) prvCoreID();
+        prvSpin( 100 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Creates tasks that delete themselves, and deletes, suspends and
+ * resumes tasks that may be running on another core.
+ */
+static void prvChurnTask( void * pvParameters )
+{
+    volatile uint32_t ulProgress = 0;
+    uint32_t ul, ulLast, ulWait;
+    TaskHandle_t xBusy;
+
+    ( void ) pvParameters;
+
+    for( ul = 0; ul < ulIterations / 20U; ul++ )
+    {
+        if( prvCreateTask( prvShortLivedTask, "Short", NULL, 1 + ( ul % 3U ), tskNO_AFFINITY, NULL ) != pdPASS )
+        {
+            prvFail( stressCHURN );
+        }
+
+        if( prvCreateTask( prvBusyTask, "Busy", ( void * ) &ulProgress, 1 + ( ul % 2U ), tskNO_AFFINITY, &xBusy ) != pdPASS )
+        {
+            prvFail( stressCHURN );
+            continue;
+        }
+
+        vTaskDelay( 1 );
+
+        vTaskSuspend( xBusy );
+
+        /* A task running on another core stops when that core services the
+         * yield request, after vTaskSuspend() has returned. */
+        for( ulWait = 0; ( eTaskGetState( xBusy ) != eSuspended ) && ( ulWait < 1000U ); ulWait++ )
+        {
+            vTaskDelay( 1 );
+        }
+
+        if( eTaskGetState( xBusy ) != eSuspended )
+        {
+            prvFail( stressCHURN );
+        }
+
+        /* Once stopped, a suspended task makes no progress. */
+        ulLast = ulProgress;
+        vTaskDelay( 1 );
+
+        if( ulProgress != ulLast )
+        {
+            prvFail( stressCHURN );
+        }
+
+        vTaskResume( xBusy );
+
+        if( ( ul % 2U ) == 0U )
+        {
+            taskYIELD();
+        }
+
+        vTaskDelete( xBusy );
+    }
+
+    xEventGroupSetBits( xDoneEvents, stressCHURN_DONE );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSyncTask( void * pvParameters )
+{
+    const uint32_t ulIndex = ( uint32_t ) ( uintptr_t ) pvParameters;
+    const EventBits_t xAllBits = ( 1UL << stressSYNC_TASKS ) - 1UL;
+    uint32_t ul, ulOther;
+
+    for( ul = 0; ul < ulIterations / 20U; ul++ )
+    {
+        if( xEventGroupSync( xSyncEvents, 1UL << ulIndex, xAllBits, stressTIMEOUT ) != xAllBits )
+        {
+            prvFail( stressSYNC );
+        }
+
+        ulSyncRounds[ ulIndex ] = ul + 1U;
+
+        /* No task can be more than a round ahead of another. */
+        for( ulOther = 0; ulOther < stressSYNC_TASKS; ulOther++ )
+        {
+            if( ( ulSyncRounds[ ulOther ] < ul ) || ( ulSyncRounds[ ulOther ] > ul + 1U ) )
+            {
+                prvFail( stressSYNC );
+            }
+        }
+
+        prvCount( stressSYNC );
+    }
+
+    if( ulIndex == 0U )
+    {
+        xEventGroupSetBits( xDoneEvents, stressSYNC_DONE );
+    }
+
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Raises and lowers the priority of a task that may be running, and
+ * moves it between cores.
+ */
+static void prvPriorityTask( void * pvParameters )
+{
+    volatile uint32_t ulProgress = 0;
+    TaskHandle_t xBusy;
+    UBaseType_t uxPriority;
+    uint32_t ul;
+
+    ( void ) pvParameters;
+
+    if( prvCreateTask( prvBusyTask, "Prio", ( void * ) &ulProgress, 1, tskNO_AFFINITY, &xBusy ) != pdPASS )
+    {
+        prvFail( stressPRIORITY );
+        xEventGroupSetBits( xDoneEvents, stressPRIORITY_DONE );
+        vTaskDelete( NULL );
+    }
+
+    for( ul = 0; ul < ulIterations / 10U; ul++ )
+    {
+        uxPriority = 1 + ( ul % ( configMAX_PRIORITIES - 3 ) );
+        vTaskPrioritySet( xBusy, uxPriority );
+
+        if( uxTaskPriorityGet( xBusy ) != uxPriority )
+        {
+            prvFail( stressPRIORITY );
+        }
+
+        #if ( configNUM_CORES > 1 )
+            vTaskCoreAffinitySet( xBusy, ( ( ul % 3U ) == 0U ) ? tskNO_AFFINITY : ( 1UL << ( ul % configNUM_CORES ) ) );
+        #endif
+
+        prvCount( stressPRIORITY );
+
+        if( ( ul % 4U ) == 0U )
+        {
+            vTaskDelay( 1 );
+        }
+    }
+
+    vTaskDelete( xBusy );
+
+    if( ulProgress == 0U )
+    {
+        prvFail( stressPRIORITY );
+    }
+
+    xEventGroupSetBits( xDoneEvents, stressPRIORITY_DONE );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTimerCallback( TimerHandle_t xExpiredTimer )
+{
+    ( void ) xExpiredTimer;
+
+    prvCount( stressTIMER );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Checks the run time counters of a task that is running and of the
+ * idle tasks, once the other checks have finished and the cores are idle.
+ *
+ * Neither task is switched out during its measurement, so this checks the
+ * time since the last switch is included.
+ */
+static void prvCheckRunTime( void )
+{
+    uint32_t ulStart, ulSpinStart, ulSelf, ulIdle, ulElapsed;
+
+    /* Each counter is read inside the period it is compared with, and the
+     * spin is inside the reads of the task's counter. */
+    ulStart = portGET_RUN_TIME_COUNTER_VALUE();
+    ulSelf = ulTaskGetRunTimeCounter( NULL );
+    ulSpinStart = portGET_RUN_TIME_COUNTER_VALUE();
+
+    while( ( uint32_t ) ( portGET_RUN_TIME_COUNTER_VALUE() - ulSpinStart ) < stressRUN_TIME_SPIN )
+    {
+    }
+
+    ulSelf = ulTaskGetRunTimeCounter( NULL ) - ulSelf;
+    ulElapsed = portGET_RUN_TIME_COUNTER_VALUE() - ulStart;
+
+    if( ( ulSelf < stressRUN_TIME_SPIN ) || ( ulSelf > ulElapsed ) )
+    {
+        prvFail( stressRUN_TIME );
+    }
+
+    /* The idle tasks of all cores run while this task is delayed. */
+    ulStart = portGET_RUN_TIME_COUNTER_VALUE();
+    ulIdle = ulTaskGetIdleRunTimeCounter();
+    vTaskDelay( pdMS_TO_TICKS( stressRUN_TIME_IDLE_MS ) );
+    ulIdle = ulTaskGetIdleRunTimeCounter() - ulIdle;
+    ulElapsed = portGET_RUN_TIME_COUNTER_VALUE() - ulStart;
+
+    xResults[ stressRUN_TIME ].ulCount = ( uint32_t ) ( ( uint64_t ) ulIdle * 100U / ( ( uint64_t ) ulElapsed * configNUM_CORES ) );
+
+    if( ( xResults[ stressRUN_TIME ].ulCount < 50U ) || ( xResults[ stressRUN_TIME ].ulCount > 100U ) )
+    {
+        prvFail( stressRUN_TIME );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Starts the checks, waits for them to finish and ends the scheduler.
+ */
+static void prvMonitorTask( void * pvParameters )
+{
+    const UBaseType_t uxBaseTasks = uxTaskGetNumberOfTasks();
+    const size_t xBaseHeap = xPortGetFreeHeapSize();
+    uint32_t ul;
+    TickType_t xStart;
+    EventBits_t xDone;
+
+    ( void ) pvParameters;
+
+    for( ul = 0; ul < stressCRITICAL_TASKS; ul++ )
+    {
+        configASSERT( prvCreateTask( prvCriticalTask, "Crit", ( void * ) ( uintptr_t ) ul, 1 + ( ul % 2U ), tskNO_AFFINITY, NULL ) == pdPASS );
+    }
+
+    for( ul = 0; ul < stressMUTEX_TASKS; ul++ )
+    {
+        configASSERT( prvCreateTask( prvMutexTask, "Mutex", ( void * ) ( uintptr_t ) ul, 1 + ul, tskNO_AFFINITY, NULL ) == pdPASS );
+    }
+
+    for( ul = 0; ul < stressSYNC_TASKS; ul++ )
+    {
+        configASSERT( prvCreateTask( prvSyncTask, "Sync", ( void * ) ( uintptr_t ) ul, 2, tskNO_AFFINITY, NULL ) == pdPASS );
+    }
+
+    configASSERT( prvCreateTask( prvProducerTask, "Prod", NULL, 2, 1UL << 0, NULL ) == pdPASS );
+    configASSERT( prvCreateTask( prvConsumerTask, "Cons", NULL, 2, 1UL << ( configNUM_CORES - 1 ), NULL ) == pdPASS );
+    configASSERT( prvCreateTask( prvFromISRTask, "ISR", NULL, 3, tskNO_AFFINITY, NULL ) == pdPASS );
+    configASSERT( prvCreateTask( prvChurnTask, "Churn", NULL, 3, tskNO_AFFINITY, NULL ) == pdPASS );
+    configASSERT( prvCreateTask( prvPriorityTask, "PrioSet", NULL, configMAX_PRIORITIES - 2, tskNO_AFFINITY, NULL ) == pdPASS );
+
+    xTimerStart( xTimer, stressTIMEOUT );
+
+    xDone = xEventGroupWaitBits( xDoneEvents, stressALL_DONE, pdFALSE, pdTRUE, stressTIMEOUT );
+    configASSERT( xDone == stressALL_DONE );
+
+    xStopping = pdTRUE;
+    xTimerStop( xTimer, stressTIMEOUT );
+
+    if( ulSharedCounter != stressCRITICAL_TASKS * ulIterations )
+    {
+        prvFail( stressCRITICAL );
+    }
+
+    xResults[ stressCRITICAL ].ulCount = ulSharedCounter;
+    xResults[ stressCORES ].ulCount = __builtin_popcount( ulCoresSeen );
+
+    if( ulCoresSeen != ( 1UL << configNUM_CORES ) - 1UL )
+    {
+        prvFail( stressCORES );
+    }
+
+    if( ( xResults[ stressFROM_ISR ].ulCount == 0U ) || ( xResults[ stressFROM_ISR ].ulCount > ulTickGives ) )
+    {
+        prvFail( stressFROM_ISR );
+    }
+
+    if( xResults[ stressTIMER ].ulCount == 0U )
+    {
+        prvFail( stressTIMER );
+    }
+
+    /* Every task created by the checks has deleted itself, so once the idle
+     * tasks have freed them the heap is back where it started. */
+    xStart = xTaskGetTickCount();
+
+    while( ( ( uxTaskGetNumberOfTasks() != uxBaseTasks ) || ( xPortGetFreeHeapSize() != xBaseHeap ) ) &&
+           ( ( xTaskGetTickCount() - xStart ) < pdMS_TO_TICKS( 5000 ) ) )
+    {
+        vTaskDelay( pdMS_TO_TICKS( 10 ) );
+    }
+
+    xResults[ stressHEAP ].ulCount = ( uint32_t ) xPortGetFreeHeapSize();
+
+    if( xPortGetFreeHeapSize() != xBaseHeap )
+    {
+        prvFail( stressHEAP );
+    }
+
+    prvCheckRunTime();
+
+    vTaskEndScheduler();
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    uint32_t ul, ulFailures = 0;
+
+    if( argc > 1 )
+    {
+        ulIterations = ( uint32_t ) strtoul( argv[ 1 ], NULL, 10 );
+    }
+
+    if( ulIterations < 100U )
+    {
+        fprintf( stderr, "usage: %s [iterations >= 100]\n", argv[ 0 ] );
+        return 2;
+    }
+
+    printf( "%d core(s), %lu iterations\n\n", configNUM_CORES, ( unsigned long ) ulIterations );
+
+    xDoneEvents = xEventGroupCreate();
+    xSyncEvents = xEventGroupCreate();
+    xMutex = xSemaphoreCreateMutex();
+    xTickSemaphore = xSemaphoreCreateBinary();
+    xQueue = xQueueCreate( stressQUEUE_LENGTH, sizeof( uint32_t ) );
+    xTimer = xTimerCreate( "Timer", pdMS_TO_TICKS( 5 ), pdTRUE, NULL, prvTimerCallback );
+
+    configASSERT( ( xDoneEvents != NULL ) && ( xSyncEvents != NULL ) && ( xMutex != NULL ) &&
+                  ( xTickSemaphore != NULL ) && ( xQueue != NULL ) && ( xTimer != NULL ) );
+    configASSERT( xTaskCreate( prvMonitorTask, "Monitor", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 2, NULL ) == pdPASS );
+
+    vTaskStartScheduler();
+
+    for( ul = 0; ul < stressNUM_RESULTS; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    /* The tasks still running on the other cores end with the process. */
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}
@@ -0,0 +1,44 @@
+/*
+ * TCP/IP configuration for the TCP large send and congestion control tests.
+ * The stack splits large packets itself and calculates all checksums, so that
+ * the test can check the frames it hands to the network interface.
+ */
+
+#ifndef FREERTOS_IP_CONFIG_H
+#define FREERTOS_IP_CONFIG_H
+
+#define ipconfigHAS_DEBUG_PRINTF                  0
+#define ipconfigHAS_PRINTF                        0
+
+#define ipconfigBYTE_ORDER                        pdFREERTOS_LITTLE_ENDIAN
+
+#define ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM    0
+#define ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM    0
+#define ipconfigZERO_COPY_TX_DRIVER               0
+#define ipconfigZERO_COPY_RX_DRIVER               0
+
+#define ipconfigUSE_DHCP                          0
+#define ipconfigUSE_DNS                           0
+#define ipconfigUSE_LLMNR                         0
+#define ipconfigUSE_NBNS                          0
+#define ipconfigUSE_NETWORK_EVENT_HOOK            0
+
+#define ipconfigIP_TASK_PRIORITY                  ( configMAX_PRIORITIES - 2 )
+#define ipconfigIP_TASK_STACK_SIZE_WORDS          ( configMINIMAL_STACK_SIZE * 5 )
+#define ipconfigRAND32()                          uxRand()
+UBaseType_t uxRand( void );
+
+#define ipconfigNETWORK_MTU                       1500
+#define ipconfigTCP_MSS                           1460
+#define ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS    16
+#define ipconfigEVENT_QUEUE_LENGTH                ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS + 5 )
+
+#define ipconfigUSE_TCP                           1
+#define ipconfigUSE_TCP_WIN                       1
+#define ipconfigUSE_TCP_LARGE_SEND                1
+#define ipconfigDRIVER_INCLUDED_LARGE_SEND        0
+#define ipconfigUSE_TCP_CONGESTION_CONTROL        1
+
+#define ipconfigALLOW_SOCKET_SEND_WITHOUT_BIND    1
+
+#endif /* FREERTOS_IP_CONFIG_H */
@@ -0,0 +1,486 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file tcp_congestion_test.c
+ * @brief Test of TCP congestion control over a simulated link, on the Linux
+ * simulator port.
+ *
+ * A TCP window sends a block of data over a link which delays every segment
+ * and every ACK, and which drops segments.  The peer ACKs every segment it
+ * receives, with a SACK for data after a hole.  NewReno and CUBIC must grow
+ * the congestion window in slow start, reduce it when a loss is detected by
+ * duplicate ACKs, restart from one segment after a retransmission timeout and
+ * deliver all the data over a link that keeps dropping segments.  A paced
+ * window must not send its whole congestion window in one burst.
+ *
+ * Usage: tcp_congestion_test
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_TCP_WIN.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define tcptestPRIORITY          ( tskIDLE_PRIORITY + 1 )
+
+#define tcptestMSS               1460U
+#define tcptestMAX_SEGMENTS      160U
+#define tcptestFIRST_SEQUENCE    0x10000UL
+
+/* The transmission window, which also limits the congestion window. */
+#define tcptestTX_WINDOW         ( 40U * tcptestMSS )
+
+/* The one-way delay of the link in ms, and the time a transfer may take. */
+#define tcptestDELAY_MS          10U
+#define tcptestDEADLINE_MS       20000U
+
+/* The share of segments the lossy link drops, in per mille. */
+#define tcptestLOSS_PER_MILLE    30U
+
+/* The number of segments and ACKs that can be on the link at the same time. */
+#define tcptestLINK_SLOTS        256U
+
+#define tcptestLOSS_NONE         ( ~0U )
+
+typedef struct TCPTestResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} TCPTestResult_t;
+
+enum
+{
+    tcptestNEWRENO_SLOW_START = 0,
+    tcptestNEWRENO_LOSS,
+    tcptestNEWRENO_LOSSY_LINK,
+    tcptestCUBIC_SLOW_START,
+    tcptestCUBIC_LOSS,
+    tcptestCUBIC_LOSSY_LINK,
+    tcptestTIMEOUT,
+    tcptestPACING,
+    tcptestNUM_RESULTS
+};
+
+static TCPTestResult_t xResults[ tcptestNUM_RESULTS ] =
+{
+    { "NewReno slow start",           0, 0 },
+    { "NewReno loss",                 0, 0 },
+    { "NewReno lossy link",           0, 0 },
+    { "CUBIC slow start",             0, 0 },
+    { "CUBIC loss",                   0, 0 },
+    { "CUBIC lossy link",             0, 0 },
+    { "retransmission timeout",       0, 0 },
+    { "pacing",                       0, 0 }
+};
+
+/* How a transfer over the link is set up. */
+typedef struct TCPTestLink
+{
+    BaseType_t xAlgorithm;      /* One of the FREERTOS_TCP_CC_xxx values. */
+    BaseType_t xPacing;         /* Non-zero to pace the window. */
+    uint32_t ulSegments;        /* The number of full segments to send. */
+    uint32_t ulLostSegment;     /* A segment dropped the first time it is sent, or tcptestLOSS_NONE. */
+    uint32_t ulLossPerMille;    /* The share of all transmissions which is dropped. */
+} TCPTestLink_t;
+
+/* What was observed during a transfer. */
+typedef struct TCPTestObserved
+{
+    uint32_t ulSlowStartWindows[ 2 ]; /* cwnd once 3 and 9 segments were ACK'd. */
+    uint32_t ulWindowBeforeLoss;      /* cwnd just before duplicate ACKs revealed a loss. */
+    uint32_t ulWindowAfterLoss;       /* cwnd just after that. */
+    uint32_t ulWindowAfterTimeout;    /* cwnd after the first retransmission timeout, 0 if none. */
+    uint32_t ulLargestBurst;          /* The most segments sent in one tick. */
+    uint32_t ulLargestWindow;         /* The largest cwnd seen. */
+    uint32_t ulDropped;               /* The number of segments dropped by the link. */
+    uint32_t ulDelivered;             /* The number of bytes ACK'd by the peer. */
+} TCPTestObserved_t;
+
+/* A segment on its way to the peer. */
+typedef struct TCPTestSegment
+{
+    TickType_t xArrival;
+    uint32_t ulSegment;
+} TCPTestSegment_t;
+
+/* An ACK on its way back, with an optional SACK block. */
+typedef struct TCPTestAck
+{
+    TickType_t xArrival;
+    uint32_t ulAck;
+    uint32_t ulSackFirst;
+    uint32_t ulSackLast;
+} TCPTestAck_t;
+
+/* Static because they are too big for the stack of the test task. */
+static TCPWindow_t xWindow;
+static TCPTestSegment_t xSegments[ tcptestLINK_SLOTS ];
+static TCPTestAck_t xAcks[ tcptestLINK_SLOTS ];
+static uint8_t ucReceived[ tcptestMAX_SEGMENTS ];
+
+/* State of the link's loss generator. */
+static uint32_t ulLossSeed;
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    lLength = snprintf( cMessage, sizeof( cMessage ), "ASSERT: %s:%lu\n", pcFile, ulLine );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    configASSERT( pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxRand( void )
+{
+    return ( UBaseType_t ) rand();
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheck( uint32_t ulResult,
+                      BaseType_t xPassed )
+{
+    xResults[ ulResult ].ulCount++;
+
+    if( xPassed == pdFALSE )
+    {
+        xResults[ ulResult ].ulFailures++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Returns pdTRUE if the link drops the next transmission.  The generator is
+ * reseeded for every transfer, so that each run drops the same share. */
+static BaseType_t prvLinkDrops( uint32_t ulLossPerMille )
+{
+    ulLossSeed = ( ulLossSeed * 1103515245UL ) + 12345UL;
+
+    return ( ( ( ulLossSeed >> 16 ) % 1000U ) < ulLossPerMille ) ? pdTRUE : pdFALSE;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Sends pxLink->ulSegments full segments from xWindow over the link, until
+ * the peer ACK'd them all or tcptestDEADLINE_MS passed. */
+static void prvTransfer( const TCPTestLink_t * pxLink,
+                         TCPTestObserved_t * pxObserved )
+{
+    uint32_t ulTotal = pxLink->ulSegments * tcptestMSS;
+    uint32_t ulSegmentHead = 0, ulSegmentTail = 0, ulAckHead = 0, ulAckTail = 0;
+    uint32_t ulCumulative = 0, ulAcked, ulBurst, ulLength, ulSegment, ulWindowBefore;
+    BaseType_t xDropped = pdFALSE, xLossSeen = pdFALSE;
+    TickType_t xNow, xStart;
+    int32_t lPosition;
+
+    configASSERT( pxLink->ulSegments <= tcptestMAX_SEGMENTS );
+
+    memset( pxObserved, 0, sizeof( *pxObserved ) );
+    memset( ucReceived, 0, sizeof( ucReceived ) );
+    memset( &xWindow, 0, sizeof( xWindow ) );
+    ulLossSeed = 1U;
+
+    vTCPWindowCreate( &xWindow, tcptestTX_WINDOW, tcptestTX_WINDOW, 0U, tcptestFIRST_SEQUENCE, tcptestMSS );
+    configASSERT( xTCPWindowSetCongestionControl( &xWindow, pxLink->xAlgorithm ) == pdPASS );
+    xWindow.xCongestion.ucPacing = ( uint8_t ) pxLink->xPacing;
+
+    /* The whole block fits in the stream, so that a position tells which
+     * segment is sent. */
+    configASSERT( lTCPWindowTxAdd( &xWindow, ulTotal, 0, ( int32_t ) ulTotal + 1 ) == ( int32_t ) ulTotal );
+
+    xStart = xTaskGetTickCount();
+
+    do
+    {
+        xNow = xTaskGetTickCount();
+
+        /* Send whatever the window allows, retransmissions first. */
+        ulBurst = 0;
+
+        while( ( ulLength = ulTCPWindowTxGet( &xWindow, tcptestTX_WINDOW, &lPosition ) ) != 0U )
+        {
+            configASSERT( ulLength == tcptestMSS );
+            ulSegment = ( uint32_t ) lPosition / tcptestMSS;
+            ulBurst++;
+
+            if( ( ulSegment == pxLink->ulLostSegment ) && ( xDropped == pdFALSE ) )
+            {
+                xDropped = pdTRUE;
+                pxObserved->ulDropped++;
+            }
+            else if( prvLinkDrops( pxLink->ulLossPerMille ) != pdFALSE )
+            {
+                pxObserved->ulDropped++;
+            }
+            else
+            {
+                configASSERT( ( ulSegmentHead - ulSegmentTail ) < tcptestLINK_SLOTS );
+                xSegments[ ulSegmentHead % tcptestLINK_SLOTS ].xArrival = xNow + pdMS_TO_TICKS( tcptestDELAY_MS );
+                xSegments[ ulSegmentHead % tcptestLINK_SLOTS ].ulSegment = ulSegment;
+                ulSegmentHead++;
+            }
+        }
+
+        if( ulBurst > pxObserved->ulLargestBurst )
+        {
+            pxObserved->ulLargestBurst = ulBurst;
+        }
+
+        /* The peer ACKs every segment that arrived. */
+        while( ( ulSegmentTail != ulSegmentHead ) &&
+               ( ( TickType_t ) ( xNow - xSegments[ ulSegmentTail % tcptestLINK_SLOTS ].xArrival ) < ( TickType_t ) 0x80000000UL ) )
+        {
+            ulSegment = xSegments[ ulSegmentTail % tcptestLINK_SLOTS ].ulSegment;
+            ulSegmentTail++;
+            ucReceived[ ulSegment ] = 1U;
+
+            while( ( ulCumulative < pxLink->ulSegments ) && ( ucReceived[ ulCumulative ] != 0U ) )
+            {
+                ulCumulative++;
+            }
+
+            configASSERT( ( ulAckHead - ulAckTail ) < tcptestLINK_SLOTS );
+            xAcks[ ulAckHead % tcptestLINK_SLOTS ].xArrival = xNow + pdMS_TO_TICKS( tcptestDELAY_MS );
+            xAcks[ ulAckHead % tcptestLINK_SLOTS ].ulAck = tcptestFIRST_SEQUENCE + ( ulCumulative * tcptestMSS );
+
+            if( ulSegment > ulCumulative )
+            {
+                /* Out of order: a duplicate ACK with a SACK option. */
+                xAcks[ ulAckHead % tcptestLINK_SLOTS ].ulSackFirst = tcptestFIRST_SEQUENCE + ( ulSegment * tcptestMSS );
+                xAcks[ ulAckHead % tcptestLINK_SLOTS ].ulSackLast = tcptestFIRST_SEQUENCE + ( ( ulSegment + 1U ) * tcptestMSS );
+            }
+            else
+            {
+                xAcks[ ulAckHead % tcptestLINK_SLOTS ].ulSackFirst = 0U;
+                xAcks[ ulAckHead % tcptestLINK_SLOTS ].ulSackLast = 0U;
+            }
+
+            ulAckHead++;
+        }
+
+        /* The ACKs that came back. */
+        while( ( ulAckTail != ulAckHead ) &&
+               ( ( TickType_t ) ( xNow - xAcks[ ulAckTail % tcptestLINK_SLOTS ].xArrival ) < ( TickType_t ) 0x80000000UL ) )
+        {
+            const TCPTestAck_t * pxAck = &( xAcks[ ulAckTail % tcptestLINK_SLOTS ] );
+
+            ulWindowBefore = xWindow.xCongestion.ulCongestionWindow;
+
+            ( void ) ulTCPWindowTxAck( &xWindow, pxAck->ulAck );
+
+            if( pxAck->ulSackLast != 0U )
+            {
+                ( void ) ulTCPWindowTxSack( &xWindow, pxAck->ulSackFirst, pxAck->ulSackLast );
+            }
+
+            ulAckTail++;
+
+            if( ( xLossSeen == pdFALSE ) && ( xWindow.xCongestion.ucInRecovery != pdFALSE_UNSIGNED ) )
+            {
+                xLossSeen = pdTRUE;
+                pxObserved->ulWindowBeforeLoss = ulWindowBefore;
+                pxObserved->ulWindowAfterLoss = xWindow.xCongestion.ulCongestionWindow;
+            }
+
+            ulAcked = ( xWindow.tx.ulCurrentSequenceNumber - tcptestFIRST_SEQUENCE ) / tcptestMSS;
+
+            if( ( ulAcked == 3U ) && ( pxObserved->ulSlowStartWindows[ 0 ] == 0U ) )
+            {
+                pxObserved->ulSlowStartWindows[ 0 ] = xWindow.xCongestion.ulCongestionWindow;
+            }
+            else if( ( ulAcked == 9U ) && ( pxObserved->ulSlowStartWindows[ 1 ] == 0U ) )
+            {
+                pxObserved->ulSlowStartWindows[ 1 ] = xWindow.xCongestion.ulCongestionWindow;
+            }
+        }
+
+        if( xWindow.xCongestion.ulCongestionWindow > pxObserved->ulLargestWindow )
+        {
+            pxObserved->ulLargestWindow = xWindow.xCongestion.ulCongestionWindow;
+        }
+
+        /* A retransmission timeout restarts from a window of one segment,
+         * which the next ACK may already grow. */
+        if( ( pxObserved->ulWindowAfterTimeout == 0U ) && ( xWindow.xCongestion.ulCongestionWindow == tcptestMSS ) )
+        {
+            pxObserved->ulWindowAfterTimeout = xWindow.xCongestion.ulCongestionWindow;
+        }
+
+        pxObserved->ulDelivered = xWindow.tx.ulCurrentSequenceNumber - tcptestFIRST_SEQUENCE;
+
+        if( pxObserved->ulDelivered < ulTotal )
+        {
+            vTaskDelay( 1 );
+        }
+    } while( ( pxObserved->ulDelivered < ulTotal ) && ( ( xTaskGetTickCount() - xStart ) < pdMS_TO_TICKS( tcptestDEADLINE_MS ) ) );
+
+    vTCPWindowDestroy( &xWindow );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Slow start and a single loss, found by duplicate ACKs.  After the loss the
+ * window is cut to ulReduction tenths. */
+static void prvCheckSingleLoss( BaseType_t xAlgorithm,
+                                uint32_t ulSlowStartResult,
+                                uint32_t ulLossResult,
+                                uint32_t ulReduction )
+{
+    const TCPTestLink_t xLink = { xAlgorithm, pdFALSE, 40U, 10U, 0U };
+    TCPTestObserved_t xObserved;
+
+    prvTransfer( &xLink, &xObserved );
+
+    /* The initial window of 3 segments doubles every round trip. */
+    prvCheck( ulSlowStartResult, ( xObserved.ulSlowStartWindows[ 0 ] == ( 6U * tcptestMSS ) ) ? pdTRUE : pdFALSE );
+    prvCheck( ulSlowStartResult, ( xObserved.ulSlowStartWindows[ 1 ] == ( 12U * tcptestMSS ) ) ? pdTRUE : pdFALSE );
+
+    prvCheck( ulLossResult, ( xObserved.ulWindowAfterLoss != 0U ) ? pdTRUE : pdFALSE );
+    prvCheck( ulLossResult, ( ( xObserved.ulWindowAfterLoss + tcptestMSS ) >= ( ( xObserved.ulWindowBeforeLoss * ulReduction ) / 10U ) ) ? pdTRUE : pdFALSE );
+    prvCheck( ulLossResult, ( xObserved.ulWindowAfterLoss <= ( ( ( xObserved.ulWindowBeforeLoss * ulReduction ) / 10U ) + tcptestMSS ) ) ? pdTRUE : pdFALSE );
+
+    /* Duplicate ACKs repair the loss, without a timeout. */
+    prvCheck( ulLossResult, ( xObserved.ulWindowAfterTimeout == 0U ) ? pdTRUE : pdFALSE );
+    prvCheck( ulLossResult, ( xObserved.ulDelivered == ( xLink.ulSegments * tcptestMSS ) ) ? pdTRUE : pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+/* A link that keeps dropping segments, retransmissions included. */
+static void prvCheckLossyLink( BaseType_t xAlgorithm,
+                               uint32_t ulResult )
+{
+    const TCPTestLink_t xLink = { xAlgorithm, pdFALSE, tcptestMAX_SEGMENTS, tcptestLOSS_NONE, tcptestLOSS_PER_MILLE };
+    TCPTestObserved_t xObserved;
+
+    prvTransfer( &xLink, &xObserved );
+
+    prvCheck( ulResult, ( xObserved.ulDropped != 0U ) ? pdTRUE : pdFALSE );
+    prvCheck( ulResult, ( xObserved.ulWindowAfterLoss != 0U ) ? pdTRUE : pdFALSE );
+    prvCheck( ulResult, ( xObserved.ulLargestWindow <= tcptestTX_WINDOW ) ? pdTRUE : pdFALSE );
+    prvCheck( ulResult, ( xObserved.ulDelivered == ( xLink.ulSegments * tcptestMSS ) ) ? pdTRUE : pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+/* The last segment is lost.  No later segment causes duplicate ACKs, so only
+ * its retransmission timer can find the loss. */
+static void prvCheckTimeout( void )
+{
+    const TCPTestLink_t xLink = { FREERTOS_TCP_CC_NEWRENO, pdFALSE, 20U, 19U, 0U };
+    TCPTestObserved_t xObserved;
+
+    prvTransfer( &xLink, &xObserved );
+
+    prvCheck( tcptestTIMEOUT, ( xObserved.ulWindowAfterTimeout == tcptestMSS ) ? pdTRUE : pdFALSE );
+    prvCheck( tcptestTIMEOUT, ( xObserved.ulWindowAfterLoss == 0U ) ? pdTRUE : pdFALSE );
+    prvCheck( tcptestTIMEOUT, ( xObserved.ulDelivered == ( xLink.ulSegments * tcptestMSS ) ) ? pdTRUE : pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+/* A paced window grows as usual, but does not send it all at once. */
+static void prvCheckPacing( void )
+{
+    const TCPTestLink_t xLink = { FREERTOS_TCP_CC_NEWRENO, pdTRUE, 60U, tcptestLOSS_NONE, 0U };
+    TCPTestObserved_t xObserved;
+
+    prvTransfer( &xLink, &xObserved );
+
+    prvCheck( tcptestPACING, ( xObserved.ulLargestWindow > ( 4U * tcptestMSS ) ) ? pdTRUE : pdFALSE );
+    prvCheck( tcptestPACING, ( xObserved.ulLargestBurst < ( xObserved.ulLargestWindow / tcptestMSS ) ) ? pdTRUE : pdFALSE );
+    prvCheck( tcptestPACING, ( xObserved.ulDelivered == ( xLink.ulSegments * tcptestMSS ) ) ? pdTRUE : pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void * pvParameters )
+{
+    TCPWindow_t xUnused;
+
+    ( void ) pvParameters;
+
+    /* Unknown algorithms are refused. */
+    memset( &xUnused, 0, sizeof( xUnused ) );
+    prvCheck( tcptestNEWRENO_SLOW_START, ( xTCPWindowSetCongestionControl( &xUnused, 99 ) == pdFAIL ) ? pdTRUE : pdFALSE );
+
+    prvCheckSingleLoss( FREERTOS_TCP_CC_NEWRENO, tcptestNEWRENO_SLOW_START, tcptestNEWRENO_LOSS, 5U );
+    prvCheckSingleLoss( FREERTOS_TCP_CC_CUBIC, tcptestCUBIC_SLOW_START, tcptestCUBIC_LOSS, 7U );
+    prvCheckLossyLink( FREERTOS_TCP_CC_NEWRENO, tcptestNEWRENO_LOSSY_LINK );
+    prvCheckLossyLink( FREERTOS_TCP_CC_CUBIC, tcptestCUBIC_LOSSY_LINK );
+    prvCheckTimeout();
+    prvCheckPacing();
+
+    vTCPSegmentCleanup();
+
+    vTaskEndScheduler();
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    uint32_t ul, ulFailures = 0;
+
+    printf( "TCP congestion control, %u ms each way, %u per mille loss\n\n",
+            ( unsigned ) tcptestDELAY_MS, ( unsigned ) tcptestLOSS_PER_MILLE );
+
+    configASSERT( xTaskCreate( prvTestTask, "Test", configMINIMAL_STACK_SIZE * 16, NULL, tcptestPRIORITY, NULL ) == pdPASS );
+
+    vTaskStartScheduler();
+
+    for( ul = 0; ul < tcptestNUM_RESULTS; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}
@@ -0,0 +1,464 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file tcp_large_send_test.c
+ * @brief Test of the TCP large send split on the Linux simulator port.
+ *
+ * A large packet, carrying several segments of data behind TCP options, is
+ * cut by uxTCPLargeSendGetSegment(). Every frame must carry the headers and
+ * options, one segment of data at the right offset, the sequence number of
+ * that data, its own IP identification and valid IP and TCP checksums. PSH
+ * and FIN may only be set on the last frame. The same packet is then sent
+ * through prvTCPReturnPacket(), which must hand the same frames to the
+ * network interface and release every buffer. A packet sent from a socket's
+ * own packet field must go out as a single frame, whatever was left on the
+ * stack before.
+ *
+ * Usage: tcp_large_send_test
+ */
+
+/* Built into the test, so that prvTCPReturnPacket() can be called. */
+#include "FreeRTOS_TCP_IP.c"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define tcptestPRIORITY           ( tskIDLE_PRIORITY + 1 )
+
+/* The headers of a test packet: Ethernet, IP, and TCP with 12 bytes of
+ * options. */
+#define tcptestTCP_HEADER         ( ipSIZE_OF_TCP_HEADER + 12U )
+#define tcptestHEADERS            ( ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + tcptestTCP_HEADER )
+
+/* Three full segments and a short one, and a sequence number that wraps in
+ * the second. */
+#define tcptestMSS                1448U
+#define tcptestDATA_LENGTH        ( ( 3U * tcptestMSS ) + 700U )
+#define tcptestFRAMES             4U
+#define tcptestSEQUENCE           0xfffffa00UL
+#define tcptestIDENTIFICATION     0xfffeU
+
+#define tcptestMAX_FRAMES         8U
+
+/* The result of a valid checksum, see ipCORRECT_CRC. */
+#define tcptestCORRECT_CRC        0xffffU
+
+typedef struct TCPTestResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} TCPTestResult_t;
+
+enum
+{
+    tcptestBOUNDARIES = 0,
+    tcptestSEQUENCE_NUMBERS,
+    tcptestCHECKSUMS,
+    tcptestFLAGS,
+    tcptestSPLIT_FRAMES,
+    tcptestBUFFERS_RETURNED,
+    tcptestSINGLE_FRAME,
+    tcptestNUM_RESULTS
+};
+
+static TCPTestResult_t xResults[ tcptestNUM_RESULTS ] =
+{
+    { "segment boundaries",           0, 0 },
+    { "sequence numbers",             0, 0 },
+    { "checksums",                    0, 0 },
+    { "PSH and FIN",                  0, 0 },
+    { "split frames",                 0, 0 },
+    { "buffers returned",             0, 0 },
+    { "socket packet single frame",   0, 0 }
+};
+
+/* The frames handed to the network interface. */
+static uint8_t ucFrames[ tcptestMAX_FRAMES ][ ipTOTAL_ETHERNET_FRAME_SIZE ];
+static size_t uxFrameLengths[ tcptestMAX_FRAMES ];
+static UBaseType_t uxFrameCount = 0;
+
+/* A socket to send from, set up as far as prvTCPReturnPacket() needs. */
+static FreeRTOS_Socket_t xSocket;
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    lLength = snprintf( cMessage, sizeof( cMessage ), "ASSERT: %s:%lu\n", pcFile, ulLine );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    configASSERT( pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxRand( void )
+{
+    return ( UBaseType_t ) rand();
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t ulApplicationGetNextSequenceNumber( uint32_t ulSourceAddress,
+                                             uint16_t usSourcePort,
+                                             uint32_t ulDestinationAddress,
+                                             uint16_t usDestinationPort )
+{
+    ( void ) ulSourceAddress;
+    ( void ) usSourcePort;
+    ( void ) ulDestinationAddress;
+    ( void ) usDestinationPort;
+
+    return ( uint32_t ) rand();
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceInitialise( void )
+{
+    return pdPASS;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                    BaseType_t xReleaseAfterSend )
+{
+    if( ( uxFrameCount < tcptestMAX_FRAMES ) && ( pxNetworkBuffer->xDataLength <= ipTOTAL_ETHERNET_FRAME_SIZE ) )
+    {
+        memcpy( ucFrames[ uxFrameCount ], pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength );
+        uxFrameLengths[ uxFrameCount ] = pxNetworkBuffer->xDataLength;
+    }
+
+    uxFrameCount++;
+
+    if( xReleaseAfterSend != pdFALSE )
+    {
+        vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+    }
+
+    return pdPASS;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheck( uint32_t ulResult,
+                      BaseType_t xPassed )
+{
+    xResults[ ulResult ].ulCount++;
+
+    if( xPassed == pdFALSE )
+    {
+        xResults[ ulResult ].ulFailures++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static uint8_t prvDataByte( size_t uxOffset )
+{
+    return ( uint8_t ) ( ( uxOffset * 7U ) + ( uxOffset >> 8 ) + 3U );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Writes a TCP packet with uxDataLength bytes of data to pucBuffer. */
+static void prvBuildPacket( uint8_t * pucBuffer,
+                            size_t uxDataLength,
+                            uint8_t ucFlags )
+{
+    TCPPacket_t * pxPacket = ( TCPPacket_t * ) pucBuffer;
+    size_t uxOffset;
+
+    memset( pucBuffer, 0, tcptestHEADERS );
+    memset( pxPacket->xEthernetHeader.xDestinationAddress.ucBytes, 0x02, ipMAC_ADDRESS_LENGTH_BYTES );
+    memset( pxPacket->xEthernetHeader.xSourceAddress.ucBytes, 0x04, ipMAC_ADDRESS_LENGTH_BYTES );
+    pxPacket->xEthernetHeader.usFrameType = ipIPv4_FRAME_TYPE;
+
+    pxPacket->xIPHeader.ucVersionHeaderLength = 0x45U;
+    pxPacket->xIPHeader.usLength = FreeRTOS_htons( ( uint16_t ) ( ipSIZE_OF_IPv4_HEADER + tcptestTCP_HEADER + uxDataLength ) );
+    pxPacket->xIPHeader.usIdentification = FreeRTOS_htons( tcptestIDENTIFICATION );
+    pxPacket->xIPHeader.ucTimeToLive = ipconfigTCP_TIME_TO_LIVE;
+    pxPacket->xIPHeader.ucProtocol = ( uint8_t ) ipPROTOCOL_TCP;
+    pxPacket->xIPHeader.ulSourceIPAddress = FreeRTOS_inet_addr_quick( 192, 168, 0, 2 );
+    pxPacket->xIPHeader.ulDestinationIPAddress = FreeRTOS_inet_addr_quick( 192, 168, 0, 1 );
+
+    pxPacket->xTCPHeader.usSourcePort = FreeRTOS_htons( 8883U );
+    pxPacket->xTCPHeader.usDestinationPort = FreeRTOS_htons( 49152U );
+    pxPacket->xTCPHeader.ulSequenceNumber = FreeRTOS_htonl( tcptestSEQUENCE );
+    pxPacket->xTCPHeader.ulAckNr = FreeRTOS_htonl( 0x12345678UL );
+    pxPacket->xTCPHeader.ucTCPOffset = ( uint8_t ) ( ( tcptestTCP_HEADER / 4U ) << 4 );
+    pxPacket->xTCPHeader.ucTCPFlags = ucFlags;
+    pxPacket->xTCPHeader.usWindow = FreeRTOS_htons( 0x2000U );
+
+    /* Two NOPs and a timestamp, which every frame must repeat. */
+    pucBuffer[ ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER ] = 1U;
+    pucBuffer[ ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + 1U ] = 1U;
+    pucBuffer[ ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + 2U ] = 8U;
+    pucBuffer[ ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + 3U ] = 10U;
+
+    for( uxOffset = 4U; uxOffset < 12U; uxOffset++ )
+    {
+        pucBuffer[ ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + uxOffset ] = ( uint8_t ) ( 0xa0U + uxOffset );
+    }
+
+    for( uxOffset = 0; uxOffset < uxDataLength; uxOffset++ )
+    {
+        pucBuffer[ tcptestHEADERS + uxOffset ] = prvDataByte( uxOffset );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Checks frame uxIndex of a packet with tcptestDATA_LENGTH bytes of data,
+ * whose first frame has ulSequence and usIdentification. The IP and TCP
+ * header fields the split does not touch must match pucFirst's. */
+static void prvCheckFrame( const uint8_t * pucFrame,
+                           size_t uxLength,
+                           UBaseType_t uxIndex,
+                           const uint8_t * pucFirst,
+                           uint32_t ulSequence,
+                           uint16_t usIdentification,
+                           uint8_t ucFlags )
+{
+    const TCPPacket_t * pxFrame = ( const TCPPacket_t * ) pucFrame;
+    const TCPPacket_t * pxFirst = ( const TCPPacket_t * ) pucFirst;
+    size_t uxOffset = ( size_t ) uxIndex * tcptestMSS;
+    size_t uxDataLength, ux;
+    BaseType_t xDataMatches = pdTRUE;
+    uint8_t ucExpectedFlags = ucFlags;
+
+    uxDataLength = ( ( tcptestDATA_LENGTH - uxOffset ) < tcptestMSS ) ? ( tcptestDATA_LENGTH - uxOffset ) : tcptestMSS;
+
+    prvCheck( tcptestBOUNDARIES, ( uxLength == ( tcptestHEADERS + uxDataLength ) ) ? pdTRUE : pdFALSE );
+    prvCheck( tcptestBOUNDARIES, ( FreeRTOS_ntohs( pxFrame->xIPHeader.usLength ) ==
+                                   ( ipSIZE_OF_IPv4_HEADER + tcptestTCP_HEADER + uxDataLength ) ) ? pdTRUE : pdFALSE );
+
+    /* The headers and options are repeated, but for the fields that differ
+     * from frame to frame. */
+    prvCheck( tcptestBOUNDARIES, ( memcmp( pucFrame, pucFirst, ipSIZE_OF_ETH_HEADER ) == 0 ) ? pdTRUE : pdFALSE );
+    prvCheck( tcptestBOUNDARIES, ( ( pxFrame->xIPHeader.ulSourceIPAddress == pxFirst->xIPHeader.ulSourceIPAddress ) &&
+                                   ( pxFrame->xIPHeader.ulDestinationIPAddress == pxFirst->xIPHeader.ulDestinationIPAddress ) &&
+                                   ( pxFrame->xTCPHeader.usSourcePort == pxFirst->xTCPHeader.usSourcePort ) &&
+                                   ( pxFrame->xTCPHeader.usDestinationPort == pxFirst->xTCPHeader.usDestinationPort ) &&
+                                   ( pxFrame->xTCPHeader.ulAckNr == pxFirst->xTCPHeader.ulAckNr ) &&
+                                   ( pxFrame->xTCPHeader.ucTCPOffset == pxFirst->xTCPHeader.ucTCPOffset ) ) ? pdTRUE : pdFALSE );
+    prvCheck( tcptestBOUNDARIES, ( memcmp( &pucFrame[ ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER ],
+                                           &pucFirst[ ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER ],
+                                           tcptestTCP_HEADER - ipSIZE_OF_TCP_HEADER ) == 0 ) ? pdTRUE : pdFALSE );
+
+    for( ux = 0; ( ux < uxDataLength ) && ( ( tcptestHEADERS + ux ) < uxLength ); ux++ )
+    {
+        if( pucFrame[ tcptestHEADERS + ux ] != prvDataByte( uxOffset + ux ) )
+        {
+            xDataMatches = pdFALSE;
+        }
+    }
+
+    prvCheck( tcptestBOUNDARIES, xDataMatches );
+
+    prvCheck( tcptestSEQUENCE_NUMBERS, ( FreeRTOS_ntohl( pxFrame->xTCPHeader.ulSequenceNumber ) ==
+                                         ( uint32_t ) ( ulSequence + ( uint32_t ) uxOffset ) ) ? pdTRUE : pdFALSE );
+    prvCheck( tcptestSEQUENCE_NUMBERS, ( FreeRTOS_ntohs( pxFrame->xIPHeader.usIdentification ) ==
+                                         ( uint16_t ) ( usIdentification + uxIndex ) ) ? pdTRUE : pdFALSE );
+
+    prvCheck( tcptestCHECKSUMS, ( usGenerateChecksum( 0UL, &( pucFrame[ ipSIZE_OF_ETH_HEADER ] ), ipSIZE_OF_IPv4_HEADER ) ==
+                                  tcptestCORRECT_CRC ) ? pdTRUE : pdFALSE );
+    prvCheck( tcptestCHECKSUMS, ( usGenerateProtocolChecksum( pucFrame, uxLength, pdFALSE ) == tcptestCORRECT_CRC ) ? pdTRUE : pdFALSE );
+
+    if( ( uxIndex + 1U ) < tcptestFRAMES )
+    {
+        ucExpectedFlags &= ( uint8_t ) ~( ipTCP_FLAG_PSH | ipTCP_FLAG_FIN );
+    }
+
+    prvCheck( tcptestFLAGS, ( pxFrame->xTCPHeader.ucTCPFlags == ucExpectedFlags ) ? pdTRUE : pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Cuts a large packet with uxTCPLargeSendGetSegment() and checks the frames. */
+static void prvCheckGetSegment( void )
+{
+    NetworkBufferDescriptor_t * pxLarge;
+    const uint8_t ucFlags = ( uint8_t ) ( ipTCP_FLAG_ACK | ipTCP_FLAG_PSH | ipTCP_FLAG_FIN );
+    uint8_t ucFrame[ ipTOTAL_ETHERNET_FRAME_SIZE ];
+    UBaseType_t uxIndex;
+    size_t uxLength;
+
+    pxLarge = pxGetNetworkBufferWithDescriptor( tcptestHEADERS + tcptestDATA_LENGTH, 0 );
+    configASSERT( pxLarge != NULL );
+
+    prvBuildPacket( pxLarge->pucEthernetBuffer, tcptestDATA_LENGTH, ucFlags );
+    pxLarge->xDataLength = tcptestHEADERS + tcptestDATA_LENGTH;
+    pxLarge->usLargeSendMSS = ( uint16_t ) tcptestMSS;
+
+    for( uxIndex = 0; uxIndex < tcptestFRAMES; uxIndex++ )
+    {
+        memset( ucFrame, 0xa5, sizeof( ucFrame ) );
+        uxLength = uxTCPLargeSendGetSegment( pxLarge, uxIndex, ucFrame );
+        prvCheckFrame( ucFrame, uxLength, uxIndex, pxLarge->pucEthernetBuffer, tcptestSEQUENCE, tcptestIDENTIFICATION, ucFlags );
+
+        /* Nothing is written past the frame. */
+        prvCheck( tcptestBOUNDARIES, ( ucFrame[ uxLength ] == 0xa5U ) ? pdTRUE : pdFALSE );
+    }
+
+    /* There is no frame after the last. */
+    prvCheck( tcptestBOUNDARIES, ( uxTCPLargeSendGetSegment( pxLarge, tcptestFRAMES, ucFrame ) == 0U ) ? pdTRUE : pdFALSE );
+
+    vReleaseNetworkBufferAndDescriptor( pxLarge );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Sends a large packet through prvTCPReturnPacket(), which splits it. */
+static void prvCheckSplit( void )
+{
+    NetworkBufferDescriptor_t * pxLarge;
+    const uint8_t ucFlags = ( uint8_t ) ( ipTCP_FLAG_ACK | ipTCP_FLAG_PSH );
+    UBaseType_t uxFreeBuffers, uxIndex;
+
+    uxFreeBuffers = uxGetNumberOfFreeNetworkBuffers();
+
+    pxLarge = pxGetNetworkBufferWithDescriptor( tcptestHEADERS + tcptestDATA_LENGTH, 0 );
+    configASSERT( pxLarge != NULL );
+
+    prvBuildPacket( pxLarge->pucEthernetBuffer, tcptestDATA_LENGTH, ucFlags );
+    pxLarge->usLargeSendMSS = ( uint16_t ) tcptestMSS;
+
+    uxFrameCount = 0;
+    prvTCPReturnPacket( &xSocket, pxLarge, ( uint32_t ) ( ipSIZE_OF_IPv4_HEADER + tcptestTCP_HEADER + tcptestDATA_LENGTH ), pdTRUE );
+
+    prvCheck( tcptestSPLIT_FRAMES, ( uxFrameCount == tcptestFRAMES ) ? pdTRUE : pdFALSE );
+
+    for( uxIndex = 0; ( uxIndex < uxFrameCount ) && ( uxIndex < tcptestMAX_FRAMES ); uxIndex++ )
+    {
+        prvCheckFrame( ucFrames[ uxIndex ], uxFrameLengths[ uxIndex ], uxIndex, ucFrames[ 0 ],
+                       xSocket.u.xTCP.xTCPWindow.ulOurSequenceNumber,
+                       FreeRTOS_ntohs( ( ( const TCPPacket_t * ) ucFrames[ 0 ] )->xIPHeader.usIdentification ),
+                       ucFlags );
+    }
+
+    /* The large buffer and all the frames' buffers are back. */
+    prvCheck( tcptestBUFFERS_RETURNED, ( uxGetNumberOfFreeNetworkBuffers() == uxFreeBuffers ) ? pdTRUE : pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Leaves a pattern on the stack below the caller's frame. */
+static void __attribute__( ( noinline ) ) prvSpoilStack( void )
+{
+    volatile uint8_t ucJunk[ 2048 ];
+    size_t ux;
+
+    for( ux = 0; ux < sizeof( ucJunk ); ux++ )
+    {
+        ucJunk[ ux ] = 0xa5U;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Sends a packet from the socket's own packet field, which goes out through
+ * a descriptor on prvTCPReturnPacket()'s stack. */
+static void prvCheckSocketPacket( void )
+{
+    const uint8_t ucFlags = ( uint8_t ) ipTCP_FLAG_ACK;
+    UBaseType_t uxFreeBuffers;
+
+    uxFreeBuffers = uxGetNumberOfFreeNetworkBuffers();
+
+    prvBuildPacket( xSocket.u.xTCP.xPacket.u.ucLastPacket, 0U, ucFlags );
+
+    uxFrameCount = 0;
+    prvSpoilStack();
+    prvTCPReturnPacket( &xSocket, NULL, ( uint32_t ) ( ipSIZE_OF_IPv4_HEADER + tcptestTCP_HEADER ), pdFALSE );
+
+    prvCheck( tcptestSINGLE_FRAME, ( uxFrameCount == 1U ) ? pdTRUE : pdFALSE );
+    prvCheck( tcptestSINGLE_FRAME, ( uxFrameLengths[ 0 ] == tcptestHEADERS ) ? pdTRUE : pdFALSE );
+    prvCheck( tcptestCHECKSUMS, ( usGenerateProtocolChecksum( ucFrames[ 0 ], uxFrameLengths[ 0 ], pdFALSE ) == tcptestCORRECT_CRC ) ? pdTRUE : pdFALSE );
+    prvCheck( tcptestBUFFERS_RETURNED, ( uxGetNumberOfFreeNetworkBuffers() == uxFreeBuffers ) ? pdTRUE : pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    configASSERT( xNetworkBuffersInitialise() == pdPASS );
+
+    /* A connected socket with an open receive window. */
+    xSocket.ucProtocol = ( uint8_t ) FREERTOS_IPPROTO_TCP;
+    xSocket.u.xTCP.uxRxStreamSize = 8U * tcptestMSS;
+    xSocket.u.xTCP.ulRxCurWinSize = 8U * tcptestMSS;
+    xSocket.u.xTCP.xTCPWindow.xSize.ulRxWindowLength = 8U * tcptestMSS;
+    xSocket.u.xTCP.usCurMSS = ( uint16_t ) tcptestMSS;
+    xSocket.u.xTCP.xTCPWindow.ulOurSequenceNumber = tcptestSEQUENCE + 0x100UL;
+    xSocket.u.xTCP.xTCPWindow.rx.ulCurrentSequenceNumber = 0x12345678UL;
+
+    prvCheckGetSegment();
+    prvCheckSplit();
+    prvCheckSocketPacket();
+
+    vTaskEndScheduler();
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    uint32_t ul, ulFailures = 0;
+
+    printf( "TCP large send, %u byte segments\n\n", ( unsigned ) tcptestMSS );
+
+    configASSERT( xTaskCreate( prvTestTask, "Test", configMINIMAL_STACK_SIZE * 16, NULL, tcptestPRIORITY, NULL ) == pdPASS );
+
+    vTaskStartScheduler();
+
+    for( ul = 0; ul < tcptestNUM_RESULTS; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}
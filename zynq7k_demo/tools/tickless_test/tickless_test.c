@@ -0,0 +1,424 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file tickless_test.c
+ * @brief Test of tickless idle on the Linux simulator port, whose virtual
+ * timer is reprogrammed in the same way as the Cortex-A9 private timer.
+ *
+ * The tick count is compared with the host's monotonic clock: while the tick
+ * is suppressed it must still keep time, tasks must wake when their delay
+ * expires and not before, and an interrupt that ends a sleep early must not
+ * lose or add ticks.  Built with configUSE_TICKLESS_IDLE 0 the same checks
+ * run with the periodic tick, as a reference.
+ *
+ * Usage: tickless_test
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/* The simulated interrupt raised by the host thread. */
+#define ticklessINTERRUPT               ( portINTERRUPT_TICK + 1UL )
+
+#define ticklessDELAYS                  200
+#define ticklessMAX_DELAY               20
+#define ticklessIDLE_TICKS              1000
+#define ticklessPERIOD                  5
+#define ticklessPERIODS                 200
+#define ticklessINTERRUPT_MS            3000
+
+/* How far the tick count may be from the host clock, in ticks. */
+#define ticklessMAX_DRIFT               2
+
+/* Timer interrupts allowed in ticklessIDLE_TICKS with the tick suppressed,
+ * and needed with the periodic tick. */
+#define ticklessMAX_SUPPRESSED_TICKS    20
+#define ticklessMIN_PERIODIC_TICKS      ( ticklessIDLE_TICKS * 9 / 10 )
+
+/* Ticks sampled to find when the host clock is read closest to a tick. */
+#define ticklessALIGN_SAMPLES           20
+
+/* Host microseconds a task may wake before its tick, for the time it takes to
+ * read the clock. */
+#define ticklessEARLY_US                100
+
+#define ticklessUS_PER_TICK             ( 1000000UL / configTICK_RATE_HZ )
+
+typedef struct TicklessResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} TicklessResult_t;
+
+enum
+{
+    ticklessDRIFT = 0,
+    ticklessSUPPRESSED,
+    ticklessSLEEPS,
+    ticklessLATENCY,
+    ticklessMAX_LATENCY,
+    ticklessEARLY,
+    ticklessEARLY_WAKES,
+    ticklessEARLY_DRIFT,
+    ticklessNUM_RESULTS
+};
+
+static TicklessResult_t xResults[ ticklessNUM_RESULTS ] =
+{
+    { "drift over delays, ticks",  0, 0 },
+    { "timer ticks while idle",    0, 0 },
+    { "sleeps",                    0, 0 },
+    { "median wake latency, us",   0, 0 },
+    { "maximum wake latency, us",  0, 0 },
+    { "wakes before their tick",   0, 0 },
+    { "interrupts during sleeps",  0, 0 },
+    { "drift after interrupts",    0, 0 }
+};
+
+volatile uint32_t ulTickIncrements = 0;
+volatile uint32_t ulSleeps = 0;
+
+static TaskHandle_t xTestTask = NULL;
+static volatile BaseType_t xInterruptsRunning = pdFALSE;
+static volatile uint32_t ulInterruptsTaken = 0;
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    /* Only async-signal-safe calls, as this can run in a simulated
+     * interrupt. */
+    lLength = snprintf( cMessage, sizeof( cMessage ), "ASSERT: %s:%lu\n", pcFile, ulLine );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    configASSERT( pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFail( uint32_t ulResult )
+{
+    xResults[ ulResult ].ulFailures++;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvGetHostMicroseconds( void )
+{
+    struct timespec xNow;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( uint64_t ) xNow.tv_sec * 1000000ULL + ( uint64_t ) xNow.tv_nsec / 1000ULL;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Find the host time of a tick.  The host clock is read just after each of a
+ * few ticks, and the read made the least time after its tick is used, as the
+ * host can run the task late. */
+static void prvAlignToTick( TickType_t * pxTick,
+                            uint64_t * pullHostTime )
+{
+    TickType_t xTick;
+    uint64_t ullTime;
+    uint32_t ul;
+
+    vTaskDelay( 1 );
+    *pullHostTime = prvGetHostMicroseconds();
+    *pxTick = xTaskGetTickCount();
+
+    for( ul = 1; ul < ticklessALIGN_SAMPLES; ul++ )
+    {
+        vTaskDelay( 1 );
+        ullTime = prvGetHostMicroseconds();
+        xTick = xTaskGetTickCount();
+
+        if( ullTime - ( uint64_t ) ( xTick - *pxTick ) * ticklessUS_PER_TICK < *pullHostTime )
+        {
+            *pullHostTime = ullTime - ( uint64_t ) ( xTick - *pxTick ) * ticklessUS_PER_TICK;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* The difference between the ticks counted and the host time passed since
+ * prvAlignToTick(), in ticks. */
+static int32_t prvGetDrift( TickType_t xStartTick,
+                            uint64_t ullStartTime )
+{
+    uint64_t ullElapsed = prvGetHostMicroseconds() - ullStartTime;
+    TickType_t xTicks = xTaskGetTickCount() - xStartTick;
+
+    return ( int32_t ) xTicks - ( int32_t ) ( ullElapsed / ticklessUS_PER_TICK );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckDrift( uint32_t ulResult,
+                           TickType_t xStartTick,
+                           uint64_t ullStartTime )
+{
+    int32_t lDrift = prvGetDrift( xStartTick, ullStartTime );
+
+    xResults[ ulResult ].ulCount = ( uint32_t ) abs( lDrift );
+
+    if( abs( lDrift ) > ticklessMAX_DRIFT )
+    {
+        prvFail( ulResult );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckDelays( void )
+{
+    TickType_t xStartTick;
+    uint64_t ullStartTime;
+    uint32_t ul;
+
+    /* Delays of every length, each suppressing a different number of ticks
+     * and ending at a different point in the timer's period. */
+    prvAlignToTick( &xStartTick, &ullStartTime );
+
+    for( ul = 0; ul < ticklessDELAYS; ul++ )
+    {
+        vTaskDelay( 1 + ( TickType_t ) ( rand() % ticklessMAX_DELAY ) );
+    }
+
+    prvCheckDrift( ticklessDRIFT, xStartTick, ullStartTime );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckSuppressed( void )
+{
+    uint32_t ulIncrements, ulSleepCount;
+
+    vTaskDelay( 1 );
+    ulIncrements = ulTickIncrements;
+    ulSleepCount = ulSleeps;
+
+    vTaskDelay( ticklessIDLE_TICKS );
+
+    ulIncrements = ulTickIncrements - ulIncrements;
+    xResults[ ticklessSUPPRESSED ].ulCount = ulIncrements;
+    xResults[ ticklessSLEEPS ].ulCount = ulSleeps - ulSleepCount;
+
+    #if ( configUSE_TICKLESS_IDLE == 1 )
+        {
+            if( ( ulIncrements > ticklessMAX_SUPPRESSED_TICKS ) || ( xResults[ ticklessSLEEPS ].ulCount == 0U ) )
+            {
+                prvFail( ticklessSUPPRESSED );
+            }
+        }
+    #else
+        {
+            if( ulIncrements < ticklessMIN_PERIODIC_TICKS )
+            {
+                prvFail( ticklessSUPPRESSED );
+            }
+        }
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvCompareLatencies( const void * pvA,
+                                const void * pvB )
+{
+    uint32_t ulA = *( const uint32_t * ) pvA, ulB = *( const uint32_t * ) pvB;
+
+    return ( ulA > ulB ) - ( ulA < ulB );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckLatency( void )
+{
+    static uint32_t ulLatencies[ ticklessPERIODS ];
+    TickType_t xStartTick, xLastWakeTime;
+    uint64_t ullStartTime, ullDue, ullNow;
+    uint32_t ul;
+
+    prvAlignToTick( &xStartTick, &ullStartTime );
+    xLastWakeTime = xStartTick;
+
+    for( ul = 0; ul < ticklessPERIODS; ul++ )
+    {
+        vTaskDelayUntil( &xLastWakeTime, ticklessPERIOD );
+        ullNow = prvGetHostMicroseconds();
+        ullDue = ullStartTime + ( uint64_t ) ( xLastWakeTime - xStartTick ) * ticklessUS_PER_TICK;
+
+        if( ullNow + ticklessEARLY_US < ullDue )
+        {
+            xResults[ ticklessEARLY ].ulCount++;
+            prvFail( ticklessEARLY );
+        }
+
+        ulLatencies[ ul ] = ( ullNow > ullDue ) ? ( uint32_t ) ( ullNow - ullDue ) : 0U;
+    }
+
+    /* The host can hold up the task for several ticks now and then, which
+     * shows in the maximum but must not fail the check. */
+    qsort( ulLatencies, ticklessPERIODS, sizeof( ulLatencies[ 0 ] ), prvCompareLatencies );
+    xResults[ ticklessLATENCY ].ulCount = ulLatencies[ ticklessPERIODS / 2 ];
+    xResults[ ticklessMAX_LATENCY ].ulCount = ulLatencies[ ticklessPERIODS - 1 ];
+
+    if( xResults[ ticklessLATENCY ].ulCount >= ticklessUS_PER_TICK )
+    {
+        prvFail( ticklessLATENCY );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvInterruptHandler( void )
+{
+    BaseType_t xWoken = pdFALSE;
+
+    ulInterruptsTaken++;
+    vTaskNotifyGiveFromISR( xTestTask, &xWoken );
+
+    return ( uint32_t ) xWoken;
+}
+
+/*-----------------------------------------------------------*/
+
+static void * prvInterruptThread( void * pvParameters )
+{
+    sigset_t xSignals;
+    struct timespec xDelay;
+
+    ( void ) pvParameters;
+
+    /* The simulated interrupts are for the task threads. */
+    sigfillset( &xSignals );
+    pthread_sigmask( SIG_BLOCK, &xSignals, NULL );
+
+    for( ; ; )
+    {
+        xDelay.tv_sec = 0;
+        xDelay.tv_nsec = ( 1 + rand() % 15 ) * 1000000L;
+        ( void ) nanosleep( &xDelay, NULL );
+
+        if( xInterruptsRunning != pdFALSE )
+        {
+            vPortGenerateSimulatedInterrupt( ticklessINTERRUPT );
+        }
+    }
+
+    return NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckEarlyWakes( void )
+{
+    TickType_t xStartTick;
+    uint64_t ullStartTime;
+
+    /* Sleeps longer than the intervals between the interrupts, so most end
+     * early, part way through a tick period. */
+    prvAlignToTick( &xStartTick, &ullStartTime );
+    xInterruptsRunning = pdTRUE;
+
+    while( ( prvGetHostMicroseconds() - ullStartTime ) < ticklessINTERRUPT_MS * 1000ULL )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, 1 + ( TickType_t ) ( rand() % ticklessMAX_DELAY ) );
+    }
+
+    xInterruptsRunning = pdFALSE;
+    xResults[ ticklessEARLY_WAKES ].ulCount = ulInterruptsTaken;
+
+    if( ulInterruptsTaken == 0U )
+    {
+        prvFail( ticklessEARLY_WAKES );
+    }
+
+    prvCheckDrift( ticklessEARLY_DRIFT, xStartTick, ullStartTime );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    prvCheckDelays();
+    prvCheckSuppressed();
+    prvCheckLatency();
+    prvCheckEarlyWakes();
+
+    vTaskEndScheduler();
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    pthread_t xInterruptThread;
+    uint32_t ul, ulFailures = 0;
+
+    printf( "tickless idle %s\n\n", ( configUSE_TICKLESS_IDLE == 1 ) ? "on" : "off" );
+
+    srand( 1 );
+    vPortSetInterruptHandler( ticklessINTERRUPT, prvInterruptHandler );
+    configASSERT( pthread_create( &xInterruptThread, NULL, prvInterruptThread, NULL ) == 0 );
+    configASSERT( xTaskCreate( prvTestTask, "Test", configMINIMAL_STACK_SIZE, NULL, 1, &xTestTask ) == pdPASS );
+
+    vTaskStartScheduler();
+
+    for( ul = 0; ul < ticklessNUM_RESULTS; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    /* The interrupt thread ends with the process. */
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}
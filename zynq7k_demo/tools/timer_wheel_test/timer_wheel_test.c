@@ -0,0 +1,568 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file timer_wheel_test.c
+ * @brief Test of the software timer timing wheel on the Linux simulator port.
+ *
+ * Thousands of timers with random periods must each fire once, never before
+ * their period, and close to it, while the tick count overflows. Random
+ * starts, resets, stops and period changes must never make a stopped timer
+ * fire or a running one fire early, and auto reload timers must keep their
+ * period. A task above the timer service task must be able to start more
+ * timers than the timer queue holds. The timer service task's time to reset
+ * timers with ten thousand of them active is reported. Built with
+ * configUSE_TIMER_WHEEL 0 the same checks run on the sorted timer lists, as a
+ * reference, where starts beyond the queue length are refused.
+ *
+ * Usage: timer_wheel_test
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define wheelTEST_PRIORITY        ( configTIMER_TASK_PRIORITY - 1 )
+#define wheelBURST_PRIORITY       ( configTIMER_TASK_PRIORITY + 1 )
+
+#define wheelBURST_TIMERS         50
+#define wheelBURST_PERIOD         10
+
+#define wheelONE_SHOTS            2000
+#define wheelMAX_ONE_SHOT         5000
+
+#define wheelAUTO_RELOADS         50
+#define wheelAUTO_RELOAD_TICKS    2000
+
+#define wheelRANDOM_TIMERS        200
+#define wheelRANDOM_OPERATIONS    20000
+#define wheelMIN_RANDOM_PERIOD    60
+#define wheelMAX_RANDOM_PERIOD    2000
+
+#define wheelCOST_TIMERS          10000
+#define wheelCOST_RESETS          1000
+#define wheelCOST_PERIOD          100000
+
+/* The most timers any check uses. */
+#define wheelMAX_TIMERS           wheelCOST_TIMERS
+
+/* A timer is only commanded when it is not due for this many ticks, longer
+ * than the host holds up the tasks now and then, so the timer service task
+ * cannot be expiring it on its old schedule while the command is sent. */
+#define wheelCOMMAND_MARGIN       50
+
+/* Ticks to wait after the last timer is due, for it to be processed. */
+#define wheelSETTLE_TICKS         100
+
+typedef struct WheelResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} WheelResult_t;
+
+enum
+{
+    wheelREFUSED = 0,
+    wheelBURST_FIRED,
+    wheelONE_SHOT_FIRED,
+    wheelEARLY,
+    wheelLATENESS,
+    wheelMAX_LATENESS,
+    wheelAUTO_RELOAD,
+    wheelRANDOM,
+    wheelSTOPPED_FIRED,
+    wheelCOST,
+    wheelNUM_RESULTS
+};
+
+static WheelResult_t xResults[ wheelNUM_RESULTS ] =
+{
+    { "starts refused, queue full",   0, 0 },
+    { "timers not fired once",        0, 0 },
+    { "one-shots not fired once",     0, 0 },
+    { "fires before period",          0, 0 },
+    { "median lateness, ticks",       0, 0 },
+    { "maximum lateness, ticks",      0, 0 },
+    { "auto reloads off count",       0, 0 },
+    { "random operations",            0, 0 },
+    { "stopped timers fired",         0, 0 },
+    { "timer task us, 1000 resets",   0, 0 }
+};
+
+/* The test's view of each timer, updated by the test task with the scheduler
+ * suspended, and by the callbacks in the timer service task. */
+typedef struct TestTimer
+{
+    TimerHandle_t xTimer;
+    TickType_t xStartTick;
+    TickType_t xPeriod;
+    TickType_t xLateness;
+    BaseType_t xAutoReload;
+    BaseType_t xRunning;
+    uint32_t ulFires;
+} TestTimer_t;
+
+static TestTimer_t xTimers[ wheelMAX_TIMERS ];
+static uint32_t ulLatenesses[ wheelONE_SHOTS ];
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    /* Only async-signal-safe calls, as this can run in a simulated
+     * interrupt. */
+    lLength = snprintf( cMessage, sizeof( cMessage ), "ASSERT: %s:%lu\n", pcFile, ulLine );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+    configASSERT( pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+unsigned long ulGetRunTimeCounterValue( void )
+{
+    struct timespec xNow;
+
+    /* Async-signal-safe, as it is read during context switches. */
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( unsigned long ) ( uint32_t ) ( ( uint64_t ) xNow.tv_sec * 1000000ULL + ( uint64_t ) xNow.tv_nsec / 1000ULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFail( uint32_t ulResult )
+{
+    xResults[ ulResult ].ulFailures++;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTimerCallback( TimerHandle_t xTimer )
+{
+    TestTimer_t * pxTest = &( xTimers[ ( uintptr_t ) pvTimerGetTimerID( xTimer ) ] );
+    TickType_t xElapsed = xTaskGetTickCount() - pxTest->xStartTick;
+
+    if( pxTest->xRunning == pdFALSE )
+    {
+        xResults[ wheelSTOPPED_FIRED ].ulCount++;
+        prvFail( wheelSTOPPED_FIRED );
+        return;
+    }
+
+    pxTest->ulFires++;
+
+    /* Fire n of an auto reload timer is due n periods after its start. */
+    if( xElapsed < pxTest->xPeriod * pxTest->ulFires )
+    {
+        xResults[ wheelEARLY ].ulCount++;
+        prvFail( wheelEARLY );
+    }
+    else
+    {
+        pxTest->xLateness = xElapsed - pxTest->xPeriod * pxTest->ulFires;
+    }
+
+    if( pxTest->xAutoReload == pdFALSE )
+    {
+        pxTest->xRunning = pdFALSE;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCreateTimers( uint32_t ulCount,
+                             TickType_t xPeriod,
+                             BaseType_t xAutoReload )
+{
+    uint32_t ul;
+
+    for( ul = 0; ul < ulCount; ul++ )
+    {
+        xTimers[ ul ].xTimer = xTimerCreate( "Test", xPeriod, ( UBaseType_t ) xAutoReload, ( void * ) ( uintptr_t ) ul, prvTimerCallback );
+        configASSERT( xTimers[ ul ].xTimer != NULL );
+        xTimers[ ul ].xPeriod = xPeriod;
+        xTimers[ ul ].xAutoReload = xAutoReload;
+        xTimers[ ul ].xRunning = pdFALSE;
+        xTimers[ ul ].ulFires = 0;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvDeleteTimers( uint32_t ulCount )
+{
+    uint32_t ul;
+
+    for( ul = 0; ul < ulCount; ul++ )
+    {
+        configASSERT( xTimerDelete( xTimers[ ul ].xTimer, portMAX_DELAY ) == pdPASS );
+    }
+
+    vTaskDelay( 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Start, reset or change the period of a timer, with the scheduler suspended
+ * so the command carries the tick the test records.  xPeriod must be the
+ * timer's period, or its new period.  The timer must not be due, or it could
+ * still fire on its old schedule. */
+static BaseType_t prvStartTimer( uint32_t ulTimer,
+                                 BaseType_t xCommandID,
+                                 TickType_t xPeriod,
+                                 TickType_t xTicksToWait )
+{
+    TestTimer_t * pxTest = &( xTimers[ ulTimer ] );
+    BaseType_t xReturn;
+
+    vTaskSuspendAll();
+    {
+        pxTest->xStartTick = xTaskGetTickCount();
+        pxTest->xPeriod = xPeriod;
+        pxTest->ulFires = 0;
+        pxTest->xRunning = pdTRUE;
+
+        xReturn = xTimerGenericCommand( pxTest->xTimer, xCommandID,
+                                        ( xCommandID == tmrCOMMAND_CHANGE_PERIOD ) ? xPeriod : pxTest->xStartTick,
+                                        NULL, xTicksToWait );
+
+        if( xReturn != pdPASS )
+        {
+            pxTest->xRunning = pdFALSE;
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+/* The timer service task runs above the test task, so has processed the stop
+ * when xTimerStop() returns, and the timer must not fire after that. */
+static void prvStopTimer( uint32_t ulTimer )
+{
+    configASSERT( xTimerStop( xTimers[ ulTimer ].xTimer, portMAX_DELAY ) == pdPASS );
+    xTimers[ ulTimer ].xRunning = pdFALSE;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvBurstTask( void * pvParameters )
+{
+    uint32_t ul;
+
+    ( void ) pvParameters;
+
+    /* The timer service task cannot run until this task blocks, so with the
+     * sorted lists only as many commands as the queue holds are accepted. */
+    for( ul = 0; ul < wheelBURST_TIMERS; ul++ )
+    {
+        if( prvStartTimer( ul, tmrCOMMAND_START, wheelBURST_PERIOD, 0 ) != pdPASS )
+        {
+            xResults[ wheelREFUSED ].ulCount++;
+        }
+    }
+
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckBurst( void )
+{
+    uint32_t ul;
+
+    prvCreateTimers( wheelBURST_TIMERS, wheelBURST_PERIOD, pdFALSE );
+    configASSERT( xTaskCreate( prvBurstTask, "Burst", configMINIMAL_STACK_SIZE, NULL, wheelBURST_PRIORITY, NULL ) == pdPASS );
+    vTaskDelay( wheelBURST_PERIOD + wheelSETTLE_TICKS );
+
+    #if ( configUSE_TIMER_WHEEL == 1 )
+        {
+            if( xResults[ wheelREFUSED ].ulCount != 0U )
+            {
+                prvFail( wheelREFUSED );
+            }
+        }
+    #endif
+
+    /* Every start that was accepted fires once. */
+    for( ul = 0; ul < wheelBURST_TIMERS; ul++ )
+    {
+        if( ( xTimers[ ul ].xRunning != pdFALSE ) || ( xTimers[ ul ].ulFires > 1U ) )
+        {
+            xResults[ wheelBURST_FIRED ].ulCount++;
+            prvFail( wheelBURST_FIRED );
+        }
+    }
+
+    prvDeleteTimers( wheelBURST_TIMERS );
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvCompareLatenesses( const void * pvA,
+                                 const void * pvB )
+{
+    uint32_t ulA = *( const uint32_t * ) pvA, ulB = *( const uint32_t * ) pvB;
+
+    return ( ulA > ulB ) - ( ulA < ulB );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckOneShots( void )
+{
+    uint32_t ul;
+
+    /* Started a little before the tick count overflows, so that many expire
+     * after it. */
+    prvCreateTimers( wheelONE_SHOTS, wheelMAX_ONE_SHOT, pdFALSE );
+
+    for( ul = 0; ul < wheelONE_SHOTS; ul++ )
+    {
+        configASSERT( prvStartTimer( ul, tmrCOMMAND_CHANGE_PERIOD, 1 + ( TickType_t ) ( rand() % wheelMAX_ONE_SHOT ), portMAX_DELAY ) == pdPASS );
+    }
+
+    vTaskDelay( wheelMAX_ONE_SHOT + wheelSETTLE_TICKS );
+
+    for( ul = 0; ul < wheelONE_SHOTS; ul++ )
+    {
+        if( xTimers[ ul ].ulFires != 1U )
+        {
+            xResults[ wheelONE_SHOT_FIRED ].ulCount++;
+            prvFail( wheelONE_SHOT_FIRED );
+        }
+
+        ulLatenesses[ ul ] = ( uint32_t ) xTimers[ ul ].xLateness;
+    }
+
+    /* The host can hold up the timer service task for several ticks now and
+     * then, which shows in the maximum but must not fail the check. */
+    qsort( ulLatenesses, wheelONE_SHOTS, sizeof( ulLatenesses[ 0 ] ), prvCompareLatenesses );
+    xResults[ wheelLATENESS ].ulCount = ulLatenesses[ wheelONE_SHOTS / 2 ];
+    xResults[ wheelMAX_LATENESS ].ulCount = ulLatenesses[ wheelONE_SHOTS - 1 ];
+
+    if( xResults[ wheelLATENESS ].ulCount > 1U )
+    {
+        prvFail( wheelLATENESS );
+    }
+
+    prvDeleteTimers( wheelONE_SHOTS );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckAutoReloads( void )
+{
+    TickType_t xExpected;
+    uint32_t ul;
+
+    prvCreateTimers( wheelAUTO_RELOADS, 1, pdTRUE );
+
+    for( ul = 0; ul < wheelAUTO_RELOADS; ul++ )
+    {
+        configASSERT( prvStartTimer( ul, tmrCOMMAND_CHANGE_PERIOD, 1 + ul, portMAX_DELAY ) == pdPASS );
+    }
+
+    vTaskDelay( wheelAUTO_RELOAD_TICKS );
+
+    for( ul = 0; ul < wheelAUTO_RELOADS; ul++ )
+    {
+        prvStopTimer( ul );
+        xExpected = ( xTaskGetTickCount() - xTimers[ ul ].xStartTick ) / xTimers[ ul ].xPeriod;
+
+        if( ( xTimers[ ul ].ulFires + 1U < xExpected ) || ( xTimers[ ul ].ulFires > xExpected + 1U ) )
+        {
+            xResults[ wheelAUTO_RELOAD ].ulCount++;
+            prvFail( wheelAUTO_RELOAD );
+        }
+    }
+
+    prvDeleteTimers( wheelAUTO_RELOADS );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheckRandomOperations( void )
+{
+    TestTimer_t * pxTest;
+    TickType_t xPeriod;
+    int32_t lDue;
+    uint32_t ul, ulTimer;
+
+    /* Half one-shot, half auto reload. */
+    prvCreateTimers( wheelRANDOM_TIMERS, wheelMIN_RANDOM_PERIOD, pdFALSE );
+
+    for( ul = 0; ul < wheelRANDOM_TIMERS; ul += 2 )
+    {
+        configASSERT( xTimerDelete( xTimers[ ul ].xTimer, portMAX_DELAY ) == pdPASS );
+        xTimers[ ul ].xTimer = xTimerCreate( "Test", wheelMIN_RANDOM_PERIOD, pdTRUE, ( void * ) ( uintptr_t ) ul, prvTimerCallback );
+        configASSERT( xTimers[ ul ].xTimer != NULL );
+        xTimers[ ul ].xAutoReload = pdTRUE;
+    }
+
+    for( ul = 0; ul < wheelRANDOM_OPERATIONS; ul++ )
+    {
+        ulTimer = ( uint32_t ) rand() % wheelRANDOM_TIMERS;
+        pxTest = &( xTimers[ ulTimer ] );
+
+        /* Only command a timer that is stopped or not due soon. */
+        lDue = ( int32_t ) ( pxTest->xStartTick + pxTest->xPeriod * ( pxTest->ulFires + 1U ) - xTaskGetTickCount() );
+
+        if( ( pxTest->xRunning != pdFALSE ) && ( lDue < wheelCOMMAND_MARGIN ) )
+        {
+            continue;
+        }
+
+        xResults[ wheelRANDOM ].ulCount++;
+        xPeriod = wheelMIN_RANDOM_PERIOD + ( TickType_t ) ( rand() % ( wheelMAX_RANDOM_PERIOD - wheelMIN_RANDOM_PERIOD ) );
+
+        switch( rand() % 4 )
+        {
+            case 0:
+                configASSERT( prvStartTimer( ulTimer, tmrCOMMAND_START, pxTest->xPeriod, portMAX_DELAY ) == pdPASS );
+                break;
+
+            case 1:
+                configASSERT( prvStartTimer( ulTimer, tmrCOMMAND_RESET, pxTest->xPeriod, portMAX_DELAY ) == pdPASS );
+                break;
+
+            case 2:
+                configASSERT( prvStartTimer( ulTimer, tmrCOMMAND_CHANGE_PERIOD, xPeriod, portMAX_DELAY ) == pdPASS );
+                break;
+
+            default:
+                prvStopTimer( ulTimer );
+                break;
+        }
+
+        if( ( ul % 10U ) == 0U )
+        {
+            vTaskDelay( 1 );
+        }
+    }
+
+    for( ul = 0; ul < wheelRANDOM_TIMERS; ul++ )
+    {
+        prvStopTimer( ul );
+    }
+
+    vTaskDelay( wheelMAX_RANDOM_PERIOD + wheelSETTLE_TICKS );
+    prvDeleteTimers( wheelRANDOM_TIMERS );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvMeasureCost( void )
+{
+    TaskHandle_t xTimerTask = xTimerGetTimerDaemonTaskHandle();
+    uint32_t ul, ulTimer, ulStart;
+
+    /* Timers that never expire during the measurement, so the timer service
+     * task only processes the resets. */
+    prvCreateTimers( wheelCOST_TIMERS, wheelCOST_PERIOD, pdFALSE );
+
+    for( ul = 0; ul < wheelCOST_TIMERS; ul++ )
+    {
+        configASSERT( prvStartTimer( ul, tmrCOMMAND_CHANGE_PERIOD, wheelCOST_PERIOD + ( TickType_t ) ( rand() % wheelCOST_PERIOD ), portMAX_DELAY ) == pdPASS );
+    }
+
+    vTaskDelay( 1 );
+    ulStart = ulTaskGetRunTimeCounter( xTimerTask );
+
+    for( ul = 0; ul < wheelCOST_RESETS; ul++ )
+    {
+        ulTimer = ( uint32_t ) rand() % wheelCOST_TIMERS;
+        configASSERT( prvStartTimer( ulTimer, tmrCOMMAND_RESET, xTimers[ ulTimer ].xPeriod, portMAX_DELAY ) == pdPASS );
+    }
+
+    vTaskDelay( 1 );
+    xResults[ wheelCOST ].ulCount = ulTaskGetRunTimeCounter( xTimerTask ) - ulStart;
+
+    for( ul = 0; ul < wheelCOST_TIMERS; ul++ )
+    {
+        prvStopTimer( ul );
+    }
+
+    prvDeleteTimers( wheelCOST_TIMERS );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    prvCheckBurst();
+    prvCheckOneShots();
+    prvCheckAutoReloads();
+    prvCheckRandomOperations();
+    prvMeasureCost();
+
+    vTaskEndScheduler();
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    uint32_t ul, ulFailures = 0;
+
+    printf( "timer wheel %s\n\n", ( configUSE_TIMER_WHEEL == 1 ) ? "on" : "off" );
+
+    srand( 1 );
+    configASSERT( xTaskCreate( prvTestTask, "Test", configMINIMAL_STACK_SIZE * 4, NULL, wheelTEST_PRIORITY, NULL ) == pdPASS );
+
+    vTaskStartScheduler();
+
+    for( ul = 0; ul < wheelNUM_RESULTS; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}
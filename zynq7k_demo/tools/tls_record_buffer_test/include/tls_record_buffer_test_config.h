@@ -0,0 +1,45 @@
+/*
+ * mbedTLS configuration for the host build of the TLS record buffer test: a
+ * TLS 1.2 client and server with RSA key exchange, and the variable length
+ * record buffers of the target configuration.
+ */
+
+#ifndef TLS_RECORD_BUFFER_TEST_CONFIG_H
+#define TLS_RECORD_BUFFER_TEST_CONFIG_H
+
+#define MBEDTLS_HAVE_ASM
+
+#define MBEDTLS_CIPHER_MODE_CBC
+#define MBEDTLS_PKCS1_V15
+#define MBEDTLS_KEY_EXCHANGE_RSA_ENABLED
+#define MBEDTLS_SSL_PROTO_TLS1_2
+#define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+#define MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+
+#define MBEDTLS_AES_C
+#define MBEDTLS_ASN1_PARSE_C
+#define MBEDTLS_BASE64_C
+#define MBEDTLS_BIGNUM_C
+#define MBEDTLS_CERTS_C
+#define MBEDTLS_CIPHER_C
+#define MBEDTLS_GCM_C
+#define MBEDTLS_MD_C
+#define MBEDTLS_OID_C
+#define MBEDTLS_PEM_PARSE_C
+#define MBEDTLS_PK_C
+#define MBEDTLS_PK_PARSE_C
+#define MBEDTLS_RSA_C
+#define MBEDTLS_SHA1_C
+#define MBEDTLS_SHA256_C
+#define MBEDTLS_SSL_CLI_C
+#define MBEDTLS_SSL_SRV_C
+#define MBEDTLS_SSL_TLS_C
+#define MBEDTLS_X509_USE_C
+#define MBEDTLS_X509_CRT_PARSE_C
+
+/* As in the target configuration */
+#define MBEDTLS_SSL_MAX_CONTENT_LEN    8192
+
+#include "mbedtls/check_config.h"
+
+#endif /* TLS_RECORD_BUFFER_TEST_CONFIG_H */
@@ -0,0 +1,760 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file tls_record_buffer_test.c
+ * @brief Test of the variable length record buffers of the vendored mbedTLS,
+ * MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH, with a client and a server in memory.
+ *
+ * The client asks for a 512-byte maximum fragment length. When the server
+ * honours it, the records of its handshake flight are split the way such a
+ * server splits them, each handshake message into fragments of its own, and
+ * the client must reassemble the messages and complete the handshake. The
+ * Certificate message does not fit the input buffer, so the buffer must grow
+ * for it and shrink again once the handshake is over. When the server
+ * withholds the extension, its Certificate record and a large application
+ * data record are each larger than the input buffer; the buffer must grow for
+ * them and shrink once they have been read. Every record buffer must be
+ * released when the contexts are freed.
+ *
+ * Usage: tls_record_buffer_test
+ */
+
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_internal.h"
+#include "mbedtls/x509_crt.h"
+
+/* certs.h relies on the configuration having been included. */
+#include "mbedtls/certs.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define tlsMAX_FRAGMENT_CODE       MBEDTLS_SSL_MAX_FRAG_LEN_512
+#define tlsMAX_FRAGMENT_LENGTH     512U
+
+/* Input buffer of the client while no large record is held */
+#define tlsIDLE_BUFFER_LENGTH      MBEDTLS_SSL_RECORD_BUFFER_LEN( tlsMAX_FRAGMENT_LENGTH )
+
+/* Application data sent in each direction, more than one fragment */
+#define tlsDATA_LENGTH             3000U
+
+/* Bytes read at a time */
+#define tlsREAD_CHUNK              100U
+
+#define tlsPIPE_LENGTH             32768U
+#define tlsMAX_HANDSHAKE_ROUNDS    100U
+
+#define tlsRECORD_HEADER_LENGTH    5U
+#define tlsHS_HEADER_LENGTH        4U
+
+typedef struct TLSResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} TLSResult_t;
+
+enum
+{
+    tlsFRAGMENTED_HANDSHAKE = 0,
+    tlsREASSEMBLY_GROWTH,
+    tlsFRAGMENT_LENGTH_RECORDS,
+    tlsLARGE_HANDSHAKE_RECORD,
+    tlsLARGE_APPLICATION_RECORD,
+    tlsBUFFER_RELEASE,
+    tlsNUM_RESULTS
+};
+
+static TLSResult_t xResults[ tlsNUM_RESULTS ] =
+{
+    { "fragmented handshake",         0, 0 },
+    { "reassembly growth",            0, 0 },
+    { "fragment length records",      0, 0 },
+    { "large handshake record",       0, 0 },
+    { "large application record",     0, 0 },
+    { "record buffer release",        0, 0 }
+};
+
+/* One direction of the connection */
+typedef struct TLSPipe
+{
+    unsigned char ucData[ tlsPIPE_LENGTH ];
+    size_t xLength;
+} TLSPipe_t;
+
+/* Record buffers handed out through mbedtls_ssl_conf_buffer_alloc() */
+typedef struct TLSBufferUsage
+{
+    size_t xCurrent;
+    uint32_t ulAllocations;
+    uint32_t ulReleases;
+} TLSBufferUsage_t;
+
+/* One end of the connection. Its records pass through prvLinkSend(), which
+ * splits the handshake messages of the first flight into fragments of
+ * xFragmentLength bytes when that is not zero. */
+typedef struct TLSLink
+{
+    TLSPipe_t * pxIncoming;
+    TLSPipe_t * pxOutgoing;
+    size_t xFragmentLength;
+    unsigned char ucPending[ tlsPIPE_LENGTH ];
+    size_t xPending;
+    int xCipherChanged;
+    uint32_t ulCertificateFragments;
+} TLSLink_t;
+
+/* Input buffer lengths of the client seen by prvReadAll() */
+typedef struct TLSReadTrace
+{
+    size_t xSmallest;
+    size_t xLargest;
+    size_t xLast;
+} TLSReadTrace_t;
+
+static TLSPipe_t xToServer, xToClient;
+static TLSLink_t xClientLink, xServerLink;
+static TLSBufferUsage_t xClientBuffers, xServerBuffers;
+
+static mbedtls_x509_crt xServerChain;
+static mbedtls_pk_context xServerKey;
+
+static uint64_t ullRandomState = 0x9e3779b97f4a7c15ULL;
+
+/*-----------------------------------------------------------*/
+
+static void prvCheck( uint32_t ulResult,
+                      int xPassed )
+{
+    xResults[ ulResult ].ulCount++;
+
+    if( xPassed == 0 )
+    {
+        xResults[ ulResult ].ulFailures++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFatal( const char * pcWhat,
+                      int lError )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    lLength = snprintf( cMessage, sizeof( cMessage ), "FATAL: %s: -0x%04x\n", pcWhat, ( unsigned int ) -lError );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+/* Deterministic random numbers, so that every run sees the same records. */
+static int prvRandom( void * pvContext,
+                      unsigned char * pucOutput,
+                      size_t xLength )
+{
+    size_t x;
+
+    ( void ) pvContext;
+
+    for( x = 0; x < xLength; x++ )
+    {
+        ullRandomState ^= ullRandomState << 13;
+        ullRandomState ^= ullRandomState >> 7;
+        ullRandomState ^= ullRandomState << 17;
+        pucOutput[ x ] = ( unsigned char ) ullRandomState;
+    }
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static unsigned char * prvBufferAlloc( void * pvContext,
+                                       size_t xLength )
+{
+    TLSBufferUsage_t * pxUsage = ( TLSBufferUsage_t * ) pvContext;
+    unsigned char * pucBuffer = calloc( 1, xLength );
+
+    if( pucBuffer != NULL )
+    {
+        pxUsage->ulAllocations++;
+        pxUsage->xCurrent += xLength;
+    }
+
+    return pucBuffer;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvBufferFree( void * pvContext,
+                           unsigned char * pucBuffer,
+                           size_t xLength )
+{
+    TLSBufferUsage_t * pxUsage = ( TLSBufferUsage_t * ) pvContext;
+
+    pxUsage->ulReleases++;
+    pxUsage->xCurrent -= xLength;
+    free( pucBuffer );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPipeWrite( TLSPipe_t * pxPipe,
+                          const unsigned char * pucData,
+                          size_t xLength )
+{
+    if( xLength > sizeof( pxPipe->ucData ) - pxPipe->xLength )
+    {
+        prvFatal( "pipe full", 0 );
+    }
+
+    memcpy( pxPipe->ucData + pxPipe->xLength, pucData, xLength );
+    pxPipe->xLength += xLength;
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvLinkRecv( void * pvContext,
+                        unsigned char * pucBuffer,
+                        size_t xLength )
+{
+    TLSPipe_t * pxPipe = ( ( TLSLink_t * ) pvContext )->pxIncoming;
+
+    if( pxPipe->xLength == 0 )
+    {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+
+    if( xLength > pxPipe->xLength )
+    {
+        xLength = pxPipe->xLength;
+    }
+
+    memcpy( pucBuffer, pxPipe->ucData, xLength );
+    memmove( pxPipe->ucData, pxPipe->ucData + xLength, pxPipe->xLength - xLength );
+    pxPipe->xLength -= xLength;
+
+    return ( int ) xLength;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Send the handshake messages of one record as records of their own, each
+ * split into fragments of at most xFragmentLength bytes. */
+static void prvSplitHandshakeRecord( TLSLink_t * pxLink,
+                                     const unsigned char * pucRecord,
+                                     size_t xRecordLength )
+{
+    const unsigned char * pucMessage = pucRecord + tlsRECORD_HEADER_LENGTH;
+    const unsigned char * pucEnd = pucRecord + xRecordLength;
+    unsigned char ucHeader[ tlsRECORD_HEADER_LENGTH ];
+    size_t xMessageLength, xOffset, xFragment;
+
+    memcpy( ucHeader, pucRecord, 3 );
+
+    while( pucMessage + tlsHS_HEADER_LENGTH <= pucEnd )
+    {
+        xMessageLength = tlsHS_HEADER_LENGTH + ( ( ( size_t ) pucMessage[ 1 ] << 16 ) |
+                                                 ( ( size_t ) pucMessage[ 2 ] << 8 ) |
+                                                 pucMessage[ 3 ] );
+
+        if( xMessageLength > ( size_t ) ( pucEnd - pucMessage ) )
+        {
+            prvFatal( "handshake message split by the server", 0 );
+        }
+
+        for( xOffset = 0; xOffset < xMessageLength; xOffset += xFragment )
+        {
+            xFragment = xMessageLength - xOffset;
+
+            if( xFragment > pxLink->xFragmentLength )
+            {
+                xFragment = pxLink->xFragmentLength;
+            }
+
+            ucHeader[ 3 ] = ( unsigned char ) ( xFragment >> 8 );
+            ucHeader[ 4 ] = ( unsigned char ) xFragment;
+            prvPipeWrite( pxLink->pxOutgoing, ucHeader, sizeof( ucHeader ) );
+            prvPipeWrite( pxLink->pxOutgoing, pucMessage + xOffset, xFragment );
+
+            if( pucMessage[ 0 ] == MBEDTLS_SSL_HS_CERTIFICATE )
+            {
+                pxLink->ulCertificateFragments++;
+            }
+        }
+
+        pucMessage += xMessageLength;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvLinkSend( void * pvContext,
+                        const unsigned char * pucBuffer,
+                        size_t xLength )
+{
+    TLSLink_t * pxLink = ( TLSLink_t * ) pvContext;
+    size_t xRecordLength;
+
+    if( xLength > sizeof( pxLink->ucPending ) - pxLink->xPending )
+    {
+        prvFatal( "records too long", 0 );
+    }
+
+    memcpy( pxLink->ucPending + pxLink->xPending, pucBuffer, xLength );
+    pxLink->xPending += xLength;
+
+    /* Forward every complete record. The handshake records before the
+     * ChangeCipherSpec are plaintext and may be split. */
+    while( pxLink->xPending >= tlsRECORD_HEADER_LENGTH )
+    {
+        xRecordLength = tlsRECORD_HEADER_LENGTH + ( ( ( size_t ) pxLink->ucPending[ 3 ] << 8 ) |
+                                                    pxLink->ucPending[ 4 ] );
+
+        if( xRecordLength > pxLink->xPending )
+        {
+            break;
+        }
+
+        if( pxLink->ucPending[ 0 ] == MBEDTLS_SSL_MSG_CHANGE_CIPHER_SPEC )
+        {
+            pxLink->xCipherChanged = 1;
+        }
+
+        if( ( pxLink->xFragmentLength != 0 ) &&
+            ( pxLink->xCipherChanged == 0 ) &&
+            ( pxLink->ucPending[ 0 ] == MBEDTLS_SSL_MSG_HANDSHAKE ) )
+        {
+            prvSplitHandshakeRecord( pxLink, pxLink->ucPending, xRecordLength );
+        }
+        else
+        {
+            prvPipeWrite( pxLink->pxOutgoing, pxLink->ucPending, xRecordLength );
+        }
+
+        memmove( pxLink->ucPending, pxLink->ucPending + xRecordLength, pxLink->xPending - xRecordLength );
+        pxLink->xPending -= xRecordLength;
+    }
+
+    return ( int ) xLength;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSetupConnection( mbedtls_ssl_config * pxClientConfig,
+                                mbedtls_ssl_context * pxClient,
+                                mbedtls_ssl_config * pxServerConfig,
+                                mbedtls_ssl_context * pxServer,
+                                size_t xFragmentLength )
+{
+    int lResult;
+
+    memset( &xToServer, 0, sizeof( xToServer ) );
+    memset( &xToClient, 0, sizeof( xToClient ) );
+    memset( &xClientLink, 0, sizeof( xClientLink ) );
+    memset( &xServerLink, 0, sizeof( xServerLink ) );
+    memset( &xClientBuffers, 0, sizeof( xClientBuffers ) );
+    memset( &xServerBuffers, 0, sizeof( xServerBuffers ) );
+    xClientLink.pxIncoming = &xToClient;
+    xClientLink.pxOutgoing = &xToServer;
+    xServerLink.pxIncoming = &xToServer;
+    xServerLink.pxOutgoing = &xToClient;
+    xServerLink.xFragmentLength = xFragmentLength;
+
+    mbedtls_ssl_config_init( pxClientConfig );
+    mbedtls_ssl_config_init( pxServerConfig );
+    mbedtls_ssl_init( pxClient );
+    mbedtls_ssl_init( pxServer );
+
+    lResult = mbedtls_ssl_config_defaults( pxClientConfig, MBEDTLS_SSL_IS_CLIENT,
+                                           MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT );
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_ssl_config_defaults( pxServerConfig, MBEDTLS_SSL_IS_SERVER,
+                                               MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT );
+    }
+
+    if( lResult != 0 )
+    {
+        prvFatal( "mbedtls_ssl_config_defaults", lResult );
+    }
+
+    mbedtls_ssl_conf_authmode( pxClientConfig, MBEDTLS_SSL_VERIFY_NONE );
+    mbedtls_ssl_conf_rng( pxClientConfig, prvRandom, NULL );
+    mbedtls_ssl_conf_buffer_alloc( pxClientConfig, prvBufferAlloc, prvBufferFree, &xClientBuffers );
+    ( void ) mbedtls_ssl_conf_max_frag_len( pxClientConfig, tlsMAX_FRAGMENT_CODE );
+
+    mbedtls_ssl_conf_rng( pxServerConfig, prvRandom, NULL );
+    mbedtls_ssl_conf_buffer_alloc( pxServerConfig, prvBufferAlloc, prvBufferFree, &xServerBuffers );
+    lResult = mbedtls_ssl_conf_own_cert( pxServerConfig, &xServerChain, &xServerKey );
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_ssl_setup( pxClient, pxClientConfig );
+    }
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_ssl_setup( pxServer, pxServerConfig );
+    }
+
+    if( lResult != 0 )
+    {
+        prvFatal( "mbedtls_ssl_setup", lResult );
+    }
+
+    mbedtls_ssl_set_bio( pxClient, &xClientLink, prvLinkSend, prvLinkRecv, NULL );
+    mbedtls_ssl_set_bio( pxServer, &xServerLink, prvLinkSend, prvLinkRecv, NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvFreeConnection( mbedtls_ssl_config * pxClientConfig,
+                               mbedtls_ssl_context * pxClient,
+                               mbedtls_ssl_config * pxServerConfig,
+                               mbedtls_ssl_context * pxServer )
+{
+    mbedtls_ssl_free( pxClient );
+    mbedtls_ssl_free( pxServer );
+    mbedtls_ssl_config_free( pxClientConfig );
+    mbedtls_ssl_config_free( pxServerConfig );
+
+    prvCheck( tlsBUFFER_RELEASE,
+              ( xClientBuffers.xCurrent == 0U ) &&
+              ( xClientBuffers.ulAllocations == xClientBuffers.ulReleases ) &&
+              ( xServerBuffers.xCurrent == 0U ) &&
+              ( xServerBuffers.ulAllocations == xServerBuffers.ulReleases ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Run both ends until the handshake is over. Returns 1 on success and the
+ * largest input buffer the client had between its handshake calls. */
+static int prvHandshake( mbedtls_ssl_context * pxClient,
+                         mbedtls_ssl_context * pxServer,
+                         int xWithholdFragmentLength,
+                         size_t * pxClientInputPeak )
+{
+    uint32_t ulRound;
+    int lResult;
+
+    *pxClientInputPeak = pxClient->in_buf_len;
+
+    for( ulRound = 0; ulRound < tlsMAX_HANDSHAKE_ROUNDS; ulRound++ )
+    {
+        if( pxClient->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        {
+            lResult = mbedtls_ssl_handshake( pxClient );
+
+            if( pxClient->in_buf_len > *pxClientInputPeak )
+            {
+                *pxClientInputPeak = pxClient->in_buf_len;
+            }
+
+            if( ( lResult != 0 ) && ( lResult != MBEDTLS_ERR_SSL_WANT_READ ) )
+            {
+                fprintf( stderr, "client handshake: -0x%04x\n", ( unsigned int ) -lResult );
+                return 0;
+            }
+        }
+
+        while( pxServer->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        {
+            /* A server that does not know the extension leaves it out of its
+             * ServerHello, and then sends records of any length. */
+            if( ( xWithholdFragmentLength != 0 ) && ( pxServer->state == MBEDTLS_SSL_SERVER_HELLO ) )
+            {
+                pxServer->session_negotiate->mfl_code = MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+            }
+
+            lResult = mbedtls_ssl_handshake_step( pxServer );
+
+            if( lResult == MBEDTLS_ERR_SSL_WANT_READ )
+            {
+                break;
+            }
+
+            if( lResult != 0 )
+            {
+                fprintf( stderr, "server handshake: -0x%04x\n", ( unsigned int ) -lResult );
+                return 0;
+            }
+        }
+
+        if( ( pxClient->state == MBEDTLS_SSL_HANDSHAKE_OVER ) &&
+            ( pxServer->state == MBEDTLS_SSL_HANDSHAKE_OVER ) )
+        {
+            return 1;
+        }
+    }
+
+    fprintf( stderr, "handshake did not complete\n" );
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvWriteAll( mbedtls_ssl_context * pxContext,
+                        const unsigned char * pucData,
+                        size_t xLength )
+{
+    size_t xSent = 0;
+    int lResult;
+
+    while( xSent < xLength )
+    {
+        lResult = mbedtls_ssl_write( pxContext, pucData + xSent, xLength - xSent );
+
+        if( lResult <= 0 )
+        {
+            fprintf( stderr, "write: -0x%04x\n", ( unsigned int ) -lResult );
+            return 0;
+        }
+
+        xSent += ( size_t ) lResult;
+    }
+
+    return 1;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Read xLength bytes, tlsREAD_CHUNK at a time. When pxTrace is not NULL it
+ * receives the smallest and largest input buffer after the reads that left
+ * data unread, and the input buffer after the last read. */
+static size_t prvReadAll( mbedtls_ssl_context * pxContext,
+                          unsigned char * pucData,
+                          size_t xLength,
+                          TLSReadTrace_t * pxTrace )
+{
+    size_t xReceived = 0, xChunk;
+    int lResult;
+
+    if( pxTrace != NULL )
+    {
+        pxTrace->xSmallest = SIZE_MAX;
+        pxTrace->xLargest = 0;
+    }
+
+    while( xReceived < xLength )
+    {
+        xChunk = ( xLength - xReceived < tlsREAD_CHUNK ) ? xLength - xReceived : tlsREAD_CHUNK;
+        lResult = mbedtls_ssl_read( pxContext, pucData + xReceived, xChunk );
+
+        if( lResult <= 0 )
+        {
+            fprintf( stderr, "read: -0x%04x\n", ( unsigned int ) -lResult );
+            break;
+        }
+
+        xReceived += ( size_t ) lResult;
+
+        if( pxTrace != NULL )
+        {
+            pxTrace->xLast = pxContext->in_buf_len;
+
+            if( xReceived < xLength )
+            {
+                if( pxContext->in_buf_len < pxTrace->xSmallest )
+                {
+                    pxTrace->xSmallest = pxContext->in_buf_len;
+                }
+
+                if( pxContext->in_buf_len > pxTrace->xLargest )
+                {
+                    pxTrace->xLargest = pxContext->in_buf_len;
+                }
+            }
+        }
+    }
+
+    return xReceived;
+}
+
+/*-----------------------------------------------------------*/
+
+/* The server honours the maximum fragment length and its first flight is
+ * split into fragments of xFragmentLength bytes. */
+static void prvTestFragmentedHandshake( size_t xFragmentLength )
+{
+    mbedtls_ssl_config xClientConfig, xServerConfig;
+    mbedtls_ssl_context xClient, xServer;
+    const mbedtls_x509_crt * pxPeer;
+    static unsigned char ucSent[ tlsDATA_LENGTH ], ucReceived[ tlsDATA_LENGTH ];
+    TLSReadTrace_t xTrace;
+    size_t xPeak;
+    int xPassed;
+
+    prvSetupConnection( &xClientConfig, &xClient, &xServerConfig, &xServer, xFragmentLength );
+    xPassed = prvHandshake( &xClient, &xServer, 0, &xPeak );
+
+    /* Every byte of the reassembled messages went into the Finished hash, so
+     * a completed handshake means that they were put together correctly. */
+    pxPeer = mbedtls_ssl_get_peer_cert( &xClient );
+    prvCheck( tlsFRAGMENTED_HANDSHAKE,
+              ( xPassed != 0 ) &&
+              ( xServerLink.ulCertificateFragments > 1U ) &&
+              ( pxPeer != NULL ) &&
+              ( pxPeer->raw.len == xServerChain.raw.len ) &&
+              ( memcmp( pxPeer->raw.p, xServerChain.raw.p, xServerChain.raw.len ) == 0 ) &&
+              ( mbedtls_ssl_get_max_frag_len( &xClient ) == tlsMAX_FRAGMENT_LENGTH ) );
+
+    /* The Certificate message does not fit the idle input buffer. */
+    prvCheck( tlsREASSEMBLY_GROWTH,
+              ( xPassed != 0 ) &&
+              ( xPeak == MBEDTLS_SSL_IN_BUFFER_LEN ) &&
+              ( xClient.in_buf_len == tlsIDLE_BUFFER_LENGTH ) &&
+              ( xClient.out_buf_len == tlsIDLE_BUFFER_LENGTH ) );
+
+    if( xPassed != 0 )
+    {
+        /* Records of up to the fragment length fit the idle buffers. */
+        ( void ) prvRandom( NULL, ucSent, sizeof( ucSent ) );
+        xPassed = prvWriteAll( &xServer, ucSent, sizeof( ucSent ) ) &&
+                  ( prvReadAll( &xClient, ucReceived, sizeof( ucReceived ), &xTrace ) == sizeof( ucReceived ) ) &&
+                  ( memcmp( ucSent, ucReceived, sizeof( ucSent ) ) == 0 ) &&
+                  ( xTrace.xLargest == tlsIDLE_BUFFER_LENGTH ) &&
+                  ( xTrace.xLast == tlsIDLE_BUFFER_LENGTH );
+
+        ( void ) prvRandom( NULL, ucSent, sizeof( ucSent ) );
+        xPassed = xPassed &&
+                  prvWriteAll( &xClient, ucSent, sizeof( ucSent ) ) &&
+                  ( prvReadAll( &xServer, ucReceived, sizeof( ucReceived ), NULL ) == sizeof( ucReceived ) ) &&
+                  ( memcmp( ucSent, ucReceived, sizeof( ucSent ) ) == 0 ) &&
+                  ( xClient.out_buf_len == tlsIDLE_BUFFER_LENGTH );
+    }
+
+    prvCheck( tlsFRAGMENT_LENGTH_RECORDS, xPassed );
+
+    prvFreeConnection( &xClientConfig, &xClient, &xServerConfig, &xServer );
+}
+
+/*-----------------------------------------------------------*/
+
+/* The server withholds the maximum fragment length and sends records larger
+ * than the idle input buffer of the client. */
+static void prvTestLargeRecords( void )
+{
+    mbedtls_ssl_config xClientConfig, xServerConfig;
+    mbedtls_ssl_context xClient, xServer;
+    static unsigned char ucSent[ tlsDATA_LENGTH ], ucReceived[ tlsDATA_LENGTH ];
+    TLSReadTrace_t xTrace;
+    size_t xPeak, xRecordLength;
+    int xPassed;
+
+    prvSetupConnection( &xClientConfig, &xClient, &xServerConfig, &xServer, 0 );
+    xPassed = prvHandshake( &xClient, &xServer, 1, &xPeak );
+
+    prvCheck( tlsLARGE_HANDSHAKE_RECORD,
+              ( xPassed != 0 ) &&
+              ( xClient.session->mfl_code == MBEDTLS_SSL_MAX_FRAG_LEN_NONE ) &&
+              ( xPeak == MBEDTLS_SSL_IN_BUFFER_LEN ) &&
+              ( xClient.in_buf_len == tlsIDLE_BUFFER_LENGTH ) &&
+              ( xClient.out_buf_len == tlsIDLE_BUFFER_LENGTH ) );
+
+    if( xPassed != 0 )
+    {
+        ( void ) prvRandom( NULL, ucSent, sizeof( ucSent ) );
+        xPassed = prvWriteAll( &xServer, ucSent, sizeof( ucSent ) );
+
+        /* All of it went into one record. */
+        xRecordLength = ( ( size_t ) xToClient.ucData[ 3 ] << 8 ) | xToClient.ucData[ 4 ];
+        xPassed = xPassed &&
+                  ( xToClient.xLength == tlsRECORD_HEADER_LENGTH + xRecordLength ) &&
+                  ( xRecordLength > tlsDATA_LENGTH );
+
+        /* The buffer stays grown while part of the record is unread, and
+         * shrinks once the last byte has been read. */
+        xPassed = xPassed &&
+                  ( prvReadAll( &xClient, ucReceived, sizeof( ucReceived ), &xTrace ) == sizeof( ucReceived ) ) &&
+                  ( memcmp( ucSent, ucReceived, sizeof( ucSent ) ) == 0 ) &&
+                  ( xTrace.xSmallest == MBEDTLS_SSL_IN_BUFFER_LEN ) &&
+                  ( xTrace.xLast == tlsIDLE_BUFFER_LENGTH );
+    }
+
+    prvCheck( tlsLARGE_APPLICATION_RECORD, xPassed );
+
+    prvFreeConnection( &xClientConfig, &xClient, &xServerConfig, &xServer );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    static const size_t xFragmentLengths[] = { tlsMAX_FRAGMENT_LENGTH, 128U, 16U };
+    uint32_t ul, ulFailures = 0;
+    int lResult;
+
+    mbedtls_x509_crt_init( &xServerChain );
+    mbedtls_pk_init( &xServerKey );
+
+    /* The server sends its certificate and the CA certificate. */
+    lResult = mbedtls_x509_crt_parse( &xServerChain, ( const unsigned char * ) mbedtls_test_srv_crt_rsa,
+                                      mbedtls_test_srv_crt_rsa_len );
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_x509_crt_parse( &xServerChain, ( const unsigned char * ) mbedtls_test_ca_crt_rsa,
+                                          mbedtls_test_ca_crt_rsa_len );
+    }
+
+    if( lResult == 0 )
+    {
+        lResult = mbedtls_pk_parse_key( &xServerKey, ( const unsigned char * ) mbedtls_test_srv_key_rsa,
+                                        mbedtls_test_srv_key_rsa_len, NULL, 0 );
+    }
+
+    if( lResult != 0 )
+    {
+        prvFatal( "test credentials", lResult );
+    }
+
+    for( ul = 0; ul < sizeof( xFragmentLengths ) / sizeof( xFragmentLengths[ 0 ] ); ul++ )
+    {
+        prvTestFragmentedHandshake( xFragmentLengths[ ul ] );
+    }
+
+    prvTestLargeRecords();
+
+    mbedtls_x509_crt_free( &xServerChain );
+    mbedtls_pk_free( &xServerKey );
+
+    for( ul = 0; ul < tlsNUM_RESULTS; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}
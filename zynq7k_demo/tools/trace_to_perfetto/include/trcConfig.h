@@ -0,0 +1,37 @@
+/*
+ * Recorder configuration for the trace converter test.  The settings follow
+ * demos/xilinx/microzed/common/config_files/trcConfig.h, with the timestamps
+ * taken from the host's monotonic clock.
+ */
+
+#ifndef TRC_CONFIG_H
+#define TRC_CONFIG_H
+
+#include "trcPortDefines.h"
+
+/* Microseconds since the test started, which wrap like a 32 bit timer. */
+uint32_t ulTraceTestTimestamp( void );
+
+#define TRC_CFG_HARDWARE_PORT TRC_HARDWARE_PORT_APPLICATION_DEFINED
+
+#define TRC_HWTC_TYPE TRC_FREE_RUNNING_32BIT_INCR
+#define TRC_HWTC_COUNT ulTraceTestTimestamp()
+#define TRC_HWTC_PERIOD 0
+#define TRC_HWTC_DIVISOR 1
+#define TRC_HWTC_FREQ_HZ 1000000
+#define TRC_IRQ_PRIORITY_ORDER 0
+#define TRC_PORT_SPECIFIC_INIT()
+
+#define TRACE_ALLOC_CRITICAL_SECTION() UBaseType_t __irq_status;
+#define TRACE_ENTER_CRITICAL_SECTION() {__irq_status = portSET_INTERRUPT_MASK_FROM_ISR();}
+#define TRACE_EXIT_CRITICAL_SECTION() {portCLEAR_INTERRUPT_MASK_FROM_ISR(__irq_status);}
+
+#define TRC_CFG_RECORDER_MODE TRC_RECORDER_MODE_STREAMING
+#define TRC_CFG_RECORDER_BUFFER_ALLOCATION TRC_RECORDER_BUFFER_ALLOCATION_STATIC
+#define TRC_CFG_FREERTOS_VERSION TRC_FREERTOS_VERSION_9_X
+#define TRC_QUEUE_RECEIVE_NOT_PEEK 1
+#define TRC_CFG_MAX_ISR_NESTING 8
+
+#include "trcStreamingConfig.h"
+
+#endif /* TRC_CONFIG_H */
@@ -0,0 +1,19 @@
+/*
+ * Streaming configuration for the trace converter test, as
+ * demos/xilinx/microzed/common/config_files/trcStreamingConfig.h.
+ */
+
+#ifndef TRC_STREAMING_CONFIG_H
+#define TRC_STREAMING_CONFIG_H
+
+#define TRC_CFG_SYMBOL_TABLE_SLOTS 64
+#define TRC_CFG_SYMBOL_MAX_LENGTH 25
+#define TRC_CFG_OBJECT_DATA_SLOTS 64
+#define TRC_CFG_CTRL_TASK_STACK_SIZE (configMINIMAL_STACK_SIZE * 4)
+#define TRC_CFG_CTRL_TASK_PRIORITY (configMAX_PRIORITIES - 3)
+#define TRC_CFG_CTRL_TASK_DELAY ((10 * configTICK_RATE_HZ) / 1000)
+#define TRC_CFG_PAGED_EVENT_BUFFER_PAGE_COUNT 16
+#define TRC_CFG_PAGED_EVENT_BUFFER_PAGE_SIZE 2920
+#define TRC_CFG_ISR_TAILCHAINING_THRESHOLD 0
+
+#endif /* TRC_STREAMING_CONFIG_H */
@@ -0,0 +1,27 @@
+/*
+ * Stream port for the trace converter test.  Events are copied into a buffer
+ * as they are stored, in the order the FreeRTOS+TCP port would send them, and
+ * the test writes the buffer to a file once the trace has stopped.  The start
+ * command a host sends is read from the test, see trace_to_perfetto_test.c.
+ */
+
+#ifndef TRC_STREAMING_PORT_H
+#define TRC_STREAMING_PORT_H
+
+void vTraceTestWrite( const void * pvData, uint32_t ulSize );
+int32_t lTraceTestRead( void * pvData, uint32_t ulSize, int32_t * plBytesRead );
+
+#define TRC_STREAM_PORT_ALLOCATE_FIELDS()
+#define TRC_STREAM_PORT_MALLOC()
+#define TRC_STREAM_PORT_INIT()
+
+#define TRC_STREAM_PORT_ALLOCATE_EVENT(_type, _ptrData, _size) _type _tmpArray[_size / sizeof(_type)]; _type* _ptrData = _tmpArray;
+#define TRC_STREAM_PORT_ALLOCATE_DYNAMIC_EVENT(_type, _ptrData, _size) _type _tmpArray[sizeof(largestEventType) / sizeof(_type)]; _type* _ptrData = _tmpArray;
+#define TRC_STREAM_PORT_COMMIT_EVENT(_ptrData, _size) vTraceTestWrite(_ptrData, _size);
+#define TRC_STREAM_PORT_READ_DATA(_ptrData, _size, _ptrBytesRead) lTraceTestRead(_ptrData, _size, _ptrBytesRead);
+#define TRC_STREAM_PORT_PERIODIC_SEND_DATA(_ptrBytesSent)
+
+#define TRC_STREAM_PORT_ON_TRACE_BEGIN()
+#define TRC_STREAM_PORT_ON_TRACE_END()
+
+#endif /* TRC_STREAMING_PORT_H */
@@ -0,0 +1,1067 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file trace_to_perfetto.c
+ * @brief Converts a trace streamed by the Tracealyzer recorder to the Chrome
+ * trace event JSON that Perfetto (ui.perfetto.dev) and chrome://tracing open,
+ * and can capture the trace from the FreeRTOS+TCP stream port first.
+ *
+ * The trace is the recorder's streaming format (PSF): a header, the symbol
+ * table naming tasks, queues, interrupts and user event channels, the task
+ * priorities, then the events. Each task and each interrupt is a thread, with
+ * a slice for each time it ran, taken from the task switches and the interrupt
+ * entries and exits. Queue, semaphore and mutex operations, and user events
+ * from vTracePrint() and vTracePrintF(), are instants on the thread that made
+ * them. Other events are counted but not shown.
+ *
+ * With -c, the trace is first captured: the start command is sent to the
+ * target's TzCtrl task on port 12000 unless another is given, and what is
+ * received in the next -t seconds (10 by default) is written to the trace
+ * file, which is then converted. The JSON is written to -o, or to standard
+ * output.
+ *
+ * Gaps in the events' sequence numbers, from events dropped on the target
+ * because the trace buffer was full, are counted and reported.
+ *
+ * Usage: trace_to_perfetto [-c host[:port]] [-t seconds] [-o json] trace
+ */
+
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define convertDEFAULT_PORT         "12000"
+#define convertMAX_ISR_NESTING      16
+#define convertMAX_NAME             64
+
+/* The trace's format, from trcStreamingRecorder.c and trcKernelPort.h. */
+#define psfIDENTIFIER               0x50534600UL
+#define psfHEADER_SIZE              20
+#define psfEVENT_SIZE               8
+#define psfHANDLE_NO_TASK           2
+
+#define psfEVENT_TRACE_START        0x01
+#define psfEVENT_TS_CONFIG          0x02
+#define psfEVENT_OBJ_NAME           0x03
+#define psfEVENT_DEFINE_ISR         0x07
+#define psfEVENT_TASK_CREATE        0x10
+#define psfEVENT_ISR_BEGIN          0x33
+#define psfEVENT_ISR_RESUME         0x34
+#define psfEVENT_TS_RESUME          0x36
+#define psfEVENT_TASK_ACTIVATE      0x37
+#define psfEVENT_USER_EVENT         0x90
+#define psfEVENT_USER_EVENT_LAST    0x9F
+
+#define psfTIMER_32BIT_INCR         1
+#define psfTIMER_32BIT_DECR         2
+
+/* The command that starts or stops the recorder, see prvIsValidCommand(). */
+#define psfCMD_SET_ACTIVE           1
+#define psfCMD_SIZE                 8
+
+typedef enum
+{
+    objectOTHER = 0,
+    objectTASK,
+    objectISR
+} ObjectKind_t;
+
+typedef struct Object
+{
+    uint32_t ulAddress;
+    uint32_t ulPriority;
+    ObjectKind_t eKind;
+    int iShown;
+    char cName[ convertMAX_NAME ];
+} Object_t;
+
+typedef struct Event
+{
+    uint16_t usCode;
+    uint16_t usCount;
+    uint32_t ulTimestamp;
+    uint32_t ulParams;
+    const uint8_t * pucParams;
+} Event_t;
+
+/* The queue, semaphore and mutex operations shown, whose first parameter is
+ * the object operated on. */
+typedef struct Operation
+{
+    uint16_t usCode;
+    const char * pcName;
+} Operation_t;
+
+static const Operation_t xOperations[] =
+{
+    { 0x50, "Queue send"                     },
+    { 0x51, "Semaphore give"                 },
+    { 0x52, "Mutex give"                     },
+    { 0x53, "Queue send failed"              },
+    { 0x54, "Semaphore give failed"          },
+    { 0x55, "Mutex give failed"              },
+    { 0x56, "Queue send blocked"             },
+    { 0x57, "Semaphore give blocked"         },
+    { 0x58, "Mutex give blocked"             },
+    { 0x59, "Queue send from ISR"            },
+    { 0x5A, "Semaphore give from ISR"        },
+    { 0x5C, "Queue send from ISR failed"     },
+    { 0x5D, "Semaphore give from ISR failed" },
+    { 0x60, "Queue receive"                  },
+    { 0x61, "Semaphore take"                 },
+    { 0x62, "Mutex take"                     },
+    { 0x63, "Queue receive failed"           },
+    { 0x64, "Semaphore take failed"          },
+    { 0x65, "Mutex take failed"              },
+    { 0x66, "Queue receive blocked"          },
+    { 0x67, "Semaphore take blocked"         },
+    { 0x68, "Mutex take blocked"             },
+    { 0x69, "Queue receive from ISR"         },
+    { 0x6A, "Semaphore take from ISR"        },
+    { 0x6C, "Queue receive from ISR failed"  },
+    { 0x6D, "Semaphore take from ISR failed" },
+    { 0x70, "Queue peek"                     },
+    { 0x73, "Queue peek failed"              },
+    { 0x76, "Queue peek blocked"             },
+    { 0xC0, "Queue send front"               },
+    { 0xC1, "Queue send front failed"        },
+    { 0xC2, "Queue send front blocked"       },
+    { 0xC3, "Queue send front from ISR"      },
+    { 0xC4, "Queue send front from ISR failed" },
+    { 0xC5, "Mutex give recursive"           },
+    { 0xC6, "Mutex give recursive failed"    },
+    { 0xC7, "Mutex take recursive"           },
+    { 0xC8, "Mutex take recursive failed"    }
+};
+
+static Object_t * pxObjects = NULL;
+static size_t xObjects = 0;
+
+/* What is running: the task switched to last, and the interrupts entered
+ * since, innermost last. */
+static uint32_t ulCurrentTask = 0;
+static uint32_t ulISRStack[ convertMAX_ISR_NESTING ];
+static int iISRDepth = 0;
+static uint64_t ullSliceStart = 0;
+static int iSliceOpen = 0;
+
+/* Timestamps, extended to 64 bits and counted from the first event. */
+static uint32_t ulFrequency = 0, ulTimerType = psfTIMER_32BIT_INCR;
+static uint64_t ullTimeHigh = 0, ullLastTime = 0;
+static uint32_t ulFirstTimestamp = 0, ulLastTimestamp = 0;
+static int iHaveTimestamp = 0;
+
+static uint64_t ullEvents = 0, ullLost = 0, ullSlices = 0, ullInstants = 0, ullNotShown = 0;
+
+static FILE * pxOut = NULL;
+static int iFirstRecord = 1;
+
+/*-----------------------------------------------------------*/
+
+static uint16_t prvRead16( const uint8_t * pucData )
+{
+    return ( uint16_t ) ( pucData[ 0 ] | ( pucData[ 1 ] << 8 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRead32( const uint8_t * pucData )
+{
+    return ( uint32_t ) pucData[ 0 ] | ( ( uint32_t ) pucData[ 1 ] << 8 ) |
+           ( ( uint32_t ) pucData[ 2 ] << 16 ) | ( ( uint32_t ) pucData[ 3 ] << 24 );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvParam( const Event_t * pxEvent,
+                          uint32_t ulIndex )
+{
+    return ( ulIndex < pxEvent->ulParams ) ? prvRead32( &pxEvent->pucParams[ ulIndex * 4 ] ) : 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static Object_t * prvFindObject( uint32_t ulAddress )
+{
+    size_t x;
+
+    for( x = 0; x < xObjects; x++ )
+    {
+        if( pxObjects[ x ].ulAddress == ulAddress )
+        {
+            return &pxObjects[ x ];
+        }
+    }
+
+    pxObjects = realloc( pxObjects, ( xObjects + 1 ) * sizeof( Object_t ) );
+
+    if( pxObjects == NULL )
+    {
+        fprintf( stderr, "out of memory\n" );
+        exit( 2 );
+    }
+
+    memset( &pxObjects[ xObjects ], 0, sizeof( Object_t ) );
+    pxObjects[ xObjects ].ulAddress = ulAddress;
+
+    return &pxObjects[ xObjects++ ];
+}
+
+/*-----------------------------------------------------------*/
+
+/* Names an object from a string that need not be terminated. */
+static void prvNameObject( uint32_t ulAddress,
+                           const uint8_t * pucName,
+                           size_t xMaxLength )
+{
+    Object_t * pxObject = prvFindObject( ulAddress );
+    size_t xLength;
+
+    for( xLength = 0; ( xLength < xMaxLength ) && ( xLength < convertMAX_NAME - 1 ) && ( pucName[ xLength ] != 0 ); xLength++ )
+    {
+    }
+
+    memcpy( pxObject->cName, pucName, xLength );
+    pxObject->cName[ xLength ] = '\0';
+}
+
+/*-----------------------------------------------------------*/
+
+static const char * prvObjectName( uint32_t ulAddress,
+                                   char * pcBuffer,
+                                   size_t xLength )
+{
+    Object_t * pxObject = prvFindObject( ulAddress );
+
+    if( pxObject->cName[ 0 ] != '\0' )
+    {
+        return pxObject->cName;
+    }
+
+    if( ulAddress == psfHANDLE_NO_TASK )
+    {
+        return "(startup)";
+    }
+
+    snprintf( pcBuffer, xLength, "0x%08lx", ( unsigned long ) ulAddress );
+
+    return pcBuffer;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Takes the next whole event from the trace, returning 0 at its end. */
+static int prvNextEvent( const uint8_t * pucTrace,
+                         size_t xSize,
+                         size_t * pxOffset,
+                         Event_t * pxEvent )
+{
+    uint16_t usID;
+
+    if( *pxOffset + psfEVENT_SIZE > xSize )
+    {
+        return 0;
+    }
+
+    usID = prvRead16( &pucTrace[ *pxOffset ] );
+    pxEvent->usCode = usID & 0x0FFFU;
+    pxEvent->ulParams = ( uint32_t ) ( usID >> 12 );
+    pxEvent->usCount = prvRead16( &pucTrace[ *pxOffset + 2 ] );
+    pxEvent->ulTimestamp = prvRead32( &pucTrace[ *pxOffset + 4 ] );
+    pxEvent->pucParams = &pucTrace[ *pxOffset + psfEVENT_SIZE ];
+
+    if( *pxOffset + psfEVENT_SIZE + ( pxEvent->ulParams * 4 ) > xSize )
+    {
+        return 0;
+    }
+
+    *pxOffset += psfEVENT_SIZE + ( pxEvent->ulParams * 4 );
+
+    return 1;
+}
+
+/*-----------------------------------------------------------*/
+
+/* The time of an event in timer counts from the first, allowing for the
+ * timer wrapping between events. */
+static uint64_t prvEventTime( uint32_t ulTimestamp )
+{
+    if( ulTimerType == psfTIMER_32BIT_DECR )
+    {
+        ulTimestamp = ~ulTimestamp;
+    }
+
+    if( iHaveTimestamp == 0 )
+    {
+        ullTimeHigh = 0;
+        ulFirstTimestamp = ulTimestamp;
+        ulLastTimestamp = ulTimestamp;
+        iHaveTimestamp = 1;
+    }
+    else if( ulTimestamp < ulLastTimestamp )
+    {
+        ullTimeHigh += 1ULL << 32;
+    }
+
+    ulLastTimestamp = ulTimestamp;
+    ullLastTime = ullTimeHigh + ulTimestamp - ulFirstTimestamp;
+
+    return ullLastTime;
+}
+
+/*-----------------------------------------------------------*/
+
+static double prvMicroseconds( uint64_t ullTime )
+{
+    return ( ( double ) ullTime * 1000000.0 ) / ( double ) ulFrequency;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvWriteString( const char * pcString )
+{
+    fputc( '"', pxOut );
+
+    for( ; *pcString != '\0'; pcString++ )
+    {
+        if( ( *pcString == '"' ) || ( *pcString == '\\' ) )
+        {
+            fprintf( pxOut, "\\%c", *pcString );
+        }
+        else if( ( unsigned char ) *pcString < 0x20 )
+        {
+            fprintf( pxOut, "\\u%04x", ( unsigned int ) ( unsigned char ) *pcString );
+        }
+        else
+        {
+            fputc( *pcString, pxOut );
+        }
+    }
+
+    fputc( '"', pxOut );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvBeginRecord( void )
+{
+    fprintf( pxOut, iFirstRecord ? "\n" : ",\n" );
+    iFirstRecord = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+/* The process a thread is in: tasks are 1, interrupts 2. */
+static int prvProcess( uint32_t ulAddress )
+{
+    return ( prvFindObject( ulAddress )->eKind == objectISR ) ? 2 : 1;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRunning( void )
+{
+    return ( iISRDepth > 0 ) ? ulISRStack[ iISRDepth - 1 ] : ulCurrentTask;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvEndSlice( uint64_t ullTime )
+{
+    uint32_t ulRunning = prvRunning();
+    char cBuffer[ 16 ];
+
+    if( ( iSliceOpen != 0 ) && ( ulRunning != 0 ) )
+    {
+        prvBeginRecord();
+        fprintf( pxOut, "{\"ph\":\"X\",\"pid\":%d,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f,\"name\":",
+                 prvProcess( ulRunning ), ( unsigned long ) ulRunning,
+                 prvMicroseconds( ullSliceStart ), prvMicroseconds( ullTime - ullSliceStart ) );
+        prvWriteString( prvObjectName( ulRunning, cBuffer, sizeof( cBuffer ) ) );
+        fprintf( pxOut, "}" );
+        prvFindObject( ulRunning )->iShown = 1;
+        ullSlices++;
+    }
+
+    iSliceOpen = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvBeginSlice( uint64_t ullTime )
+{
+    ullSliceStart = ullTime;
+    iSliceOpen = 1;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvWriteInstant( uint64_t ullTime,
+                             const char * pcName,
+                             const char * pcObject )
+{
+    uint32_t ulRunning = prvRunning();
+
+    if( ulRunning == 0 )
+    {
+        ulRunning = psfHANDLE_NO_TASK;
+    }
+
+    prvBeginRecord();
+    fprintf( pxOut, "{\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%lu,\"ts\":%.3f,\"name\":",
+             prvProcess( ulRunning ), ( unsigned long ) ulRunning, prvMicroseconds( ullTime ) );
+    prvWriteString( pcName );
+
+    if( pcObject != NULL )
+    {
+        fprintf( pxOut, ",\"args\":{\"object\":" );
+        prvWriteString( pcObject );
+        fprintf( pxOut, "}" );
+    }
+
+    fprintf( pxOut, "}" );
+    prvFindObject( ulRunning )->iShown = 1;
+    ullInstants++;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Formats a user event as vTracePrintF() describes: %d, %u, %x and %X with a
+ * width and zero padding, and %s naming a symbol. */
+static void prvFormatUserEvent( const Event_t * pxEvent,
+                                char * pcText,
+                                size_t xLength )
+{
+    uint32_t ulWords = pxEvent->usCode - psfEVENT_USER_EVENT;
+    uint32_t ulArgs = 0, ulArg, ulChannel = 0;
+    const char * pcFormat, * pcEnd;
+    char cString[ 61 ], cSpec[ 16 ], cName[ 16 ];
+    size_t xString, xUsed = 0, xSpec;
+    int iWritten;
+
+    if( ulWords > pxEvent->ulParams )
+    {
+        ulWords = pxEvent->ulParams;
+    }
+
+    /* The string follows the arguments, and may not be terminated if it
+     * filled the event. */
+    xString = ( pxEvent->ulParams - ulWords ) * 4;
+    memcpy( cString, &pxEvent->pucParams[ ulWords * 4 ], xString );
+    cString[ xString ] = '\0';
+
+    for( pcFormat = cString; *pcFormat != '\0'; pcFormat++ )
+    {
+        if( *pcFormat == '%' )
+        {
+            if( pcFormat[ 1 ] != '%' )
+            {
+                ulArgs++;
+            }
+
+            if( pcFormat[ 1 ] != '\0' )
+            {
+                pcFormat++;
+            }
+        }
+    }
+
+    /* A channel is the first word, if there is one more than the format
+     * uses. */
+    ulArg = 0;
+
+    if( ulWords == ulArgs + 1 )
+    {
+        ulChannel = prvParam( pxEvent, 0 );
+        ulArg = 1;
+    }
+
+    pcText[ 0 ] = '\0';
+
+    if( ulChannel != 0 )
+    {
+        xUsed = ( size_t ) snprintf( pcText, xLength, "[%s] ", prvObjectName( ulChannel, cName, sizeof( cName ) ) );
+    }
+
+    for( pcFormat = cString; ( *pcFormat != '\0' ) && ( xUsed < xLength - 1 ); pcFormat++ )
+    {
+        if( ( *pcFormat != '%' ) || ( pcFormat[ 1 ] == '\0' ) )
+        {
+            pcText[ xUsed++ ] = *pcFormat;
+            continue;
+        }
+
+        if( pcFormat[ 1 ] == '%' )
+        {
+            pcText[ xUsed++ ] = '%';
+            pcFormat++;
+            continue;
+        }
+
+        /* The flags and width, then the conversion. */
+        for( pcEnd = pcFormat + 1; ( *pcEnd >= '0' ) && ( *pcEnd <= '9' ); pcEnd++ )
+        {
+        }
+
+        xSpec = ( size_t ) ( pcEnd - pcFormat );
+
+        if( ( xSpec > sizeof( cSpec ) - 3 ) || ( *pcEnd == '\0' ) )
+        {
+            break;
+        }
+
+        memcpy( cSpec, pcFormat, xSpec );
+
+        switch( *pcEnd )
+        {
+            case 'd':
+                memcpy( &cSpec[ xSpec ], "ld", 3 );
+                iWritten = snprintf( &pcText[ xUsed ], xLength - xUsed, cSpec, ( long ) ( int32_t ) prvParam( pxEvent, ulArg ) );
+                break;
+
+            case 'u':
+            case 'x':
+            case 'X':
+                cSpec[ xSpec ] = 'l';
+                cSpec[ xSpec + 1 ] = *pcEnd;
+                cSpec[ xSpec + 2 ] = '\0';
+                iWritten = snprintf( &pcText[ xUsed ], xLength - xUsed, cSpec, ( unsigned long ) prvParam( pxEvent, ulArg ) );
+                break;
+
+            case 's':
+                iWritten = snprintf( &pcText[ xUsed ], xLength - xUsed, "%s", prvObjectName( prvParam( pxEvent, ulArg ), cName, sizeof( cName ) ) );
+                break;
+
+            default:
+                iWritten = snprintf( &pcText[ xUsed ], xLength - xUsed, "%%%c", *pcEnd );
+                break;
+        }
+
+        ulArg++;
+        pcFormat = pcEnd;
+
+        if( iWritten > 0 )
+        {
+            xUsed += ( size_t ) iWritten;
+        }
+
+        if( xUsed >= xLength )
+        {
+            xUsed = xLength - 1;
+        }
+    }
+
+    pcText[ xUsed ] = '\0';
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvConvertEvent( const Event_t * pxEvent,
+                             uint64_t ullTime )
+{
+    Object_t * pxObject;
+    char cText[ 160 ], cName[ 16 ];
+    size_t x;
+
+    switch( pxEvent->usCode )
+    {
+        case psfEVENT_TRACE_START:
+            ulCurrentTask = prvParam( pxEvent, 1 );
+            iISRDepth = 0;
+            prvBeginSlice( ullTime );
+            return;
+
+        case psfEVENT_TS_CONFIG:
+            return;
+
+        case psfEVENT_OBJ_NAME:
+
+            if( pxEvent->ulParams > 1 )
+            {
+                prvNameObject( prvParam( pxEvent, 0 ), &pxEvent->pucParams[ 4 ], ( pxEvent->ulParams - 1 ) * 4 );
+            }
+
+            return;
+
+        case psfEVENT_DEFINE_ISR:
+
+            if( pxEvent->ulParams > 2 )
+            {
+                prvNameObject( prvParam( pxEvent, 0 ), &pxEvent->pucParams[ 8 ], ( pxEvent->ulParams - 2 ) * 4 );
+                pxObject = prvFindObject( prvParam( pxEvent, 0 ) );
+                pxObject->eKind = objectISR;
+                pxObject->ulPriority = prvParam( pxEvent, 1 );
+            }
+
+            return;
+
+        case psfEVENT_TASK_CREATE:
+            pxObject = prvFindObject( prvParam( pxEvent, 0 ) );
+            pxObject->eKind = objectTASK;
+            pxObject->ulPriority = prvParam( pxEvent, 1 );
+            return;
+
+        case psfEVENT_TASK_ACTIVATE:
+
+            /* An interrupt that switched task ends here. */
+            prvEndSlice( ullTime );
+            iISRDepth = 0;
+            ulCurrentTask = prvParam( pxEvent, 0 );
+            prvFindObject( ulCurrentTask )->eKind = objectTASK;
+            prvBeginSlice( ullTime );
+            return;
+
+        case psfEVENT_ISR_BEGIN:
+            prvEndSlice( ullTime );
+
+            if( iISRDepth < convertMAX_ISR_NESTING )
+            {
+                ulISRStack[ iISRDepth++ ] = prvParam( pxEvent, 0 );
+                prvFindObject( prvParam( pxEvent, 0 ) )->eKind = objectISR;
+            }
+
+            prvBeginSlice( ullTime );
+            return;
+
+        case psfEVENT_ISR_RESUME:
+            prvEndSlice( ullTime );
+
+            if( iISRDepth > 1 )
+            {
+                iISRDepth--;
+                ulISRStack[ iISRDepth - 1 ] = prvParam( pxEvent, 0 );
+            }
+
+            prvBeginSlice( ullTime );
+            return;
+
+        case psfEVENT_TS_RESUME:
+            prvEndSlice( ullTime );
+            iISRDepth = 0;
+            ulCurrentTask = prvParam( pxEvent, 0 );
+            prvBeginSlice( ullTime );
+            return;
+
+        default:
+            break;
+    }
+
+    if( ( pxEvent->usCode >= psfEVENT_USER_EVENT ) && ( pxEvent->usCode <= psfEVENT_USER_EVENT_LAST ) )
+    {
+        prvFormatUserEvent( pxEvent, cText, sizeof( cText ) );
+        prvWriteInstant( ullTime, cText, NULL );
+        return;
+    }
+
+    for( x = 0; x < sizeof( xOperations ) / sizeof( xOperations[ 0 ] ); x++ )
+    {
+        if( xOperations[ x ].usCode == pxEvent->usCode )
+        {
+            prvWriteInstant( ullTime, xOperations[ x ].pcName, prvObjectName( prvParam( pxEvent, 0 ), cName, sizeof( cName ) ) );
+            return;
+        }
+    }
+
+    ullNotShown++;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Names the threads, tasks by priority, highest first, after the
+ * interrupts. */
+static void prvWriteThreadNames( void )
+{
+    char cBuffer[ 16 ];
+    size_t x;
+
+    for( x = 0; x < xObjects; x++ )
+    {
+        if( pxObjects[ x ].iShown == 0 )
+        {
+            continue;
+        }
+
+        prvBeginRecord();
+        fprintf( pxOut, "{\"ph\":\"M\",\"pid\":%d,\"tid\":%lu,\"name\":\"thread_name\",\"args\":{\"name\":",
+                 prvProcess( pxObjects[ x ].ulAddress ), ( unsigned long ) pxObjects[ x ].ulAddress );
+        prvWriteString( prvObjectName( pxObjects[ x ].ulAddress, cBuffer, sizeof( cBuffer ) ) );
+        fprintf( pxOut, "}}" );
+
+        prvBeginRecord();
+        fprintf( pxOut, "{\"ph\":\"M\",\"pid\":%d,\"tid\":%lu,\"name\":\"thread_sort_index\",\"args\":{\"sort_index\":%ld}}",
+                 prvProcess( pxObjects[ x ].ulAddress ), ( unsigned long ) pxObjects[ x ].ulAddress,
+                 -( long ) pxObjects[ x ].ulPriority );
+    }
+
+    prvBeginRecord();
+    fprintf( pxOut, "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"Tasks\"}}" );
+    prvBeginRecord();
+    fprintf( pxOut, "{\"ph\":\"M\",\"pid\":2,\"name\":\"process_name\",\"args\":{\"name\":\"Interrupts\"}}" );
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvConvert( const uint8_t * pucTrace,
+                       size_t xSize )
+{
+    size_t xOffset, xSymbolSize, xSymbols, xObjectSize, xObjectData, x;
+    uint16_t usExpected = 0;
+    Event_t xEvent;
+    int iFirstEvent = 1;
+
+    if( ( xSize < psfHEADER_SIZE ) || ( prvRead32( pucTrace ) != psfIDENTIFIER ) )
+    {
+        fprintf( stderr, "not a trace from the recorder in streaming mode, or not little endian\n" );
+        return 2;
+    }
+
+    xSymbolSize = prvRead16( &pucTrace[ 12 ] );
+    xSymbols = prvRead16( &pucTrace[ 14 ] );
+    xObjectSize = prvRead16( &pucTrace[ 16 ] );
+    xObjectData = prvRead16( &pucTrace[ 18 ] );
+    xOffset = psfHEADER_SIZE;
+
+    if( ( xSymbolSize < 8 ) || ( xObjectSize < 8 ) ||
+        ( xOffset + ( xSymbolSize * xSymbols ) + ( xObjectSize * xObjectData ) > xSize ) )
+    {
+        fprintf( stderr, "the trace's symbol table is cut short\n" );
+        return 2;
+    }
+
+    /* The names of the objects named before the trace started. */
+    for( x = 0; x < xSymbols; x++, xOffset += xSymbolSize )
+    {
+        if( prvRead32( &pucTrace[ xOffset ] ) != 0 )
+        {
+            prvNameObject( prvRead32( &pucTrace[ xOffset ] ), &pucTrace[ xOffset + 4 ], xSymbolSize - 4 );
+        }
+    }
+
+    /* The priorities of the tasks and interrupts. */
+    for( x = 0; x < xObjectData; x++, xOffset += xObjectSize )
+    {
+        if( prvRead32( &pucTrace[ xOffset ] ) != 0 )
+        {
+            prvFindObject( prvRead32( &pucTrace[ xOffset ] ) )->ulPriority = prvRead32( &pucTrace[ xOffset + 4 ] );
+        }
+    }
+
+    /* The timer's frequency is given after the first events, so look for it
+     * first. */
+    for( x = xOffset; prvNextEvent( pucTrace, xSize, &x, &xEvent ) != 0; )
+    {
+        if( xEvent.usCode == psfEVENT_TS_CONFIG )
+        {
+            ulFrequency = prvParam( &xEvent, 0 );
+            ulTimerType = prvParam( &xEvent, 2 );
+            break;
+        }
+    }
+
+    if( ulFrequency == 0 )
+    {
+        fprintf( stderr, "the trace has no timestamp configuration, so times are in timer counts\n" );
+        ulFrequency = 1000000;
+    }
+
+    if( ( ulTimerType != psfTIMER_32BIT_INCR ) && ( ulTimerType != psfTIMER_32BIT_DECR ) )
+    {
+        fprintf( stderr, "timestamps from timer type %lu are read as a free running 32 bit counter\n", ( unsigned long ) ulTimerType );
+        ulTimerType = psfTIMER_32BIT_INCR;
+    }
+
+    fprintf( pxOut, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" );
+
+    while( prvNextEvent( pucTrace, xSize, &xOffset, &xEvent ) != 0 )
+    {
+        if( ( iFirstEvent == 0 ) && ( xEvent.usCount != usExpected ) )
+        {
+            ullLost += ( uint16_t ) ( xEvent.usCount - usExpected );
+        }
+
+        iFirstEvent = 0;
+        usExpected = ( uint16_t ) ( xEvent.usCount + 1 );
+        ullEvents++;
+        prvConvertEvent( &xEvent, prvEventTime( xEvent.ulTimestamp ) );
+    }
+
+    prvEndSlice( ullLastTime );
+    prvWriteThreadNames();
+    fprintf( pxOut, "\n]}\n" );
+
+    fprintf( stderr, "events %llu, lost %llu, slices %llu, instants %llu, not shown %llu, %.6f s\n",
+             ( unsigned long long ) ullEvents, ( unsigned long long ) ullLost, ( unsigned long long ) ullSlices,
+             ( unsigned long long ) ullInstants, ( unsigned long long ) ullNotShown,
+             prvMicroseconds( ullLastTime ) / 1000000.0 );
+
+    if( xOffset != xSize )
+    {
+        fprintf( stderr, "the last event is cut short\n" );
+    }
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvMakeCommand( uint8_t * pucCommand,
+                            uint8_t ucStart )
+{
+    uint16_t usChecksum;
+
+    memset( pucCommand, 0, psfCMD_SIZE );
+    pucCommand[ 0 ] = psfCMD_SET_ACTIVE;
+    pucCommand[ 1 ] = ucStart;
+    usChecksum = ( uint16_t ) ( 0xFFFFU - ( pucCommand[ 0 ] + pucCommand[ 1 ] ) );
+    pucCommand[ 6 ] = ( uint8_t ) ( usChecksum & 0xFFU );
+    pucCommand[ 7 ] = ( uint8_t ) ( usChecksum >> 8 );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Starts the recorder on the target, saves what it sends for a time, then
+ * stops it. */
+static int prvCapture( const char * pcTarget,
+                       unsigned long ulSeconds,
+                       const char * pcTraceName )
+{
+    char cHost[ 256 ];
+    const char * pcPort = convertDEFAULT_PORT;
+    char * pcColon;
+    struct addrinfo xHints, * pxAddresses, * pxAddress;
+    struct pollfd xPoll;
+    uint8_t ucBuffer[ 4096 ];
+    time_t xEnd;
+    ssize_t xReceived;
+    size_t xTotal = 0;
+    FILE * pxTrace;
+    int iSocket = -1, iResult;
+
+    snprintf( cHost, sizeof( cHost ), "%s", pcTarget );
+    pcColon = strrchr( cHost, ':' );
+
+    if( pcColon != NULL )
+    {
+        *pcColon = '\0';
+        pcPort = pcColon + 1;
+    }
+
+    memset( &xHints, 0, sizeof( xHints ) );
+    xHints.ai_family = AF_UNSPEC;
+    xHints.ai_socktype = SOCK_STREAM;
+    iResult = getaddrinfo( cHost, pcPort, &xHints, &pxAddresses );
+
+    if( iResult != 0 )
+    {
+        fprintf( stderr, "%s: %s\n", pcTarget, gai_strerror( iResult ) );
+        return 2;
+    }
+
+    for( pxAddress = pxAddresses; pxAddress != NULL; pxAddress = pxAddress->ai_next )
+    {
+        iSocket = socket( pxAddress->ai_family, pxAddress->ai_socktype, pxAddress->ai_protocol );
+
+        if( ( iSocket >= 0 ) && ( connect( iSocket, pxAddress->ai_addr, pxAddress->ai_addrlen ) == 0 ) )
+        {
+            break;
+        }
+
+        if( iSocket >= 0 )
+        {
+            close( iSocket );
+            iSocket = -1;
+        }
+    }
+
+    freeaddrinfo( pxAddresses );
+
+    if( iSocket < 0 )
+    {
+        perror( pcTarget );
+        return 2;
+    }
+
+    pxTrace = fopen( pcTraceName, "wb" );
+
+    if( pxTrace == NULL )
+    {
+        perror( pcTraceName );
+        close( iSocket );
+        return 2;
+    }
+
+    prvMakeCommand( ucBuffer, 1 );
+
+    if( send( iSocket, ucBuffer, psfCMD_SIZE, 0 ) != psfCMD_SIZE )
+    {
+        perror( "send" );
+        fclose( pxTrace );
+        close( iSocket );
+        return 2;
+    }
+
+    xEnd = time( NULL ) + ( time_t ) ulSeconds;
+    xPoll.fd = iSocket;
+    xPoll.events = POLLIN;
+
+    while( time( NULL ) < xEnd )
+    {
+        iResult = poll( &xPoll, 1, 100 );
+
+        if( ( iResult < 0 ) && ( errno != EINTR ) )
+        {
+            perror( "poll" );
+            break;
+        }
+
+        if( iResult <= 0 )
+        {
+            continue;
+        }
+
+        xReceived = recv( iSocket, ucBuffer, sizeof( ucBuffer ), 0 );
+
+        if( xReceived <= 0 )
+        {
+            fprintf( stderr, "the target closed the connection\n" );
+            break;
+        }
+
+        fwrite( ucBuffer, 1, ( size_t ) xReceived, pxTrace );
+        xTotal += ( size_t ) xReceived;
+    }
+
+    /* Stopping the recorder before closing lets it finish the event it is
+     * sending. */
+    prvMakeCommand( ucBuffer, 0 );
+    ( void ) send( iSocket, ucBuffer, psfCMD_SIZE, 0 );
+    close( iSocket );
+    fclose( pxTrace );
+
+    fprintf( stderr, "captured %lu bytes to %s\n", ( unsigned long ) xTotal, pcTraceName );
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char * argv[] )
+{
+    const char * pcTarget = NULL, * pcOutName = NULL;
+    unsigned long ulSeconds = 10;
+    uint8_t * pucTrace;
+    long lSize;
+    FILE * pxFile;
+    int iOption, iResult;
+
+    while( ( iOption = getopt( argc, argv, "c:t:o:" ) ) != -1 )
+    {
+        switch( iOption )
+        {
+            case 'c':
+                pcTarget = optarg;
+                break;
+
+            case 't':
+                ulSeconds = strtoul( optarg, NULL, 0 );
+                break;
+
+            case 'o':
+                pcOutName = optarg;
+                break;
+
+            default:
+                optind = argc + 1;
+                break;
+        }
+    }
+
+    if( optind != argc - 1 )
+    {
+        fprintf( stderr, "usage: trace_to_perfetto [-c host[:port]] [-t seconds] [-o json] trace\n" );
+        return 2;
+    }
+
+    if( ( pcTarget != NULL ) && ( prvCapture( pcTarget, ulSeconds, argv[ optind ] ) != 0 ) )
+    {
+        return 2;
+    }
+
+    pxFile = fopen( argv[ optind ], "rb" );
+
+    if( pxFile == NULL )
+    {
+        perror( argv[ optind ] );
+        return 2;
+    }
+
+    fseek( pxFile, 0, SEEK_END );
+    lSize = ftell( pxFile );
+    rewind( pxFile );
+    pucTrace = malloc( ( lSize > 0 ) ? ( size_t ) lSize : 1 );
+
+    if( ( pucTrace == NULL ) || ( lSize < 0 ) || ( fread( pucTrace, 1, ( size_t ) lSize, pxFile ) != ( size_t ) lSize ) )
+    {
+        fprintf( stderr, "%s: cannot read the trace\n", argv[ optind ] );
+        return 2;
+    }
+
+    fclose( pxFile );
+
+    pxOut = stdout;
+
+    if( pcOutName != NULL )
+    {
+        pxOut = fopen( pcOutName, "w" );
+
+        if( pxOut == NULL )
+        {
+            perror( pcOutName );
+            return 2;
+        }
+    }
+
+    iResult = prvConvert( pucTrace, ( size_t ) lSize );
+
+    if( ( pxOut != stdout ) && ( fclose( pxOut ) != 0 ) )
+    {
+        perror( pcOutName );
+        iResult = 2;
+    }
+
+    free( pucTrace );
+    free( pxObjects );
+
+    return iResult;
+}
@@ -0,0 +1,353 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file trace_to_perfetto_test.c
+ * @brief Records a trace of the kernel on the Linux simulator port with the
+ * Tracealyzer recorder in streaming mode, for trace_to_perfetto to convert.
+ *
+ * The recorder is enabled as the MicroZed demo enables it, and started by the
+ * command a host sends. A Producer task sends to a queue that a Consumer task
+ * receives from, holding a mutex while it does, a simulated interrupt named
+ * Timer sends to a second queue, and both tasks record user events on a
+ * channel named App. The trace is checked to start with the header and to
+ * have no events dropped, then written to the file named.
+ *
+ * Usage: trace_to_perfetto_test [trace]
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define tracetestPRIORITY           ( tskIDLE_PRIORITY + 1 )
+#define tracetestITEMS              200
+#define tracetestTIMER_INTERRUPT    5
+#define tracetestBUFFER_SIZE        ( 1024 * 1024 )
+
+typedef struct TraceResult
+{
+    const char * pcName;
+    uint32_t ulFailures;
+    uint32_t ulCount;
+} TraceResult_t;
+
+enum
+{
+    traceSTARTED = 0,
+    traceHEADER,
+    traceRECEIVED,
+    traceNOT_DROPPED,
+    traceWRITTEN,
+    traceNUM_RESULTS
+};
+
+static TraceResult_t xResults[ traceNUM_RESULTS ] =
+{
+    { "started by the host command", 0, 0 },
+    { "trace starts with a header",  0, 0 },
+    { "items received",              0, 0 },
+    { "no events dropped",           0, 0 },
+    { "trace written",               0, 0 }
+};
+
+static const char * pcTraceName = NULL;
+
+/* The trace, as the stream port would send it. */
+static uint8_t ucTrace[ tracetestBUFFER_SIZE ];
+static size_t xTraceLength = 0;
+static uint32_t ulTraceOverflows = 0;
+
+/* Whether the start command has been read. */
+static BaseType_t xCommandSent = pdFALSE;
+
+static struct timespec xStartTime;
+
+static QueueHandle_t xItemQueue = NULL, xTimerQueue = NULL;
+static SemaphoreHandle_t xMutex = NULL;
+static traceHandle xTimerISR = NULL;
+static traceString xAppChannel = NULL;
+static volatile uint32_t ulReceived = 0;
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    char cMessage[ 128 ];
+    int lLength;
+
+    /* Only async-signal-safe calls, as this can run in a simulated
+     * interrupt. */
+    lLength = snprintf( cMessage, sizeof( cMessage ), "ASSERT: %s:%lu\n", pcFile, ulLine );
+    ( void ) write( STDERR_FILENO, cMessage, ( size_t ) lLength );
+    abort();
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t ulTraceTestTimestamp( void )
+{
+    struct timespec xNow;
+
+    /* clock_gettime() is async-signal-safe, so can be called from the
+     * simulated interrupts. */
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( uint32_t ) ( ( ( uint64_t ) ( xNow.tv_sec - xStartTime.tv_sec ) * 1000000ULL ) +
+                          ( uint64_t ) ( xNow.tv_nsec / 1000 ) - ( uint64_t ) ( xStartTime.tv_nsec / 1000 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Called by the recorder with its critical section entered. */
+void vTraceTestWrite( const void * pvData,
+                      uint32_t ulSize )
+{
+    if( xTraceLength + ulSize <= sizeof( ucTrace ) )
+    {
+        memcpy( &ucTrace[ xTraceLength ], pvData, ulSize );
+        xTraceLength += ulSize;
+    }
+    else
+    {
+        ulTraceOverflows++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Gives the TzCtrl task the start command a host sends once it connects, as
+ * trace_to_perfetto -c does. */
+int32_t lTraceTestRead( void * pvData,
+                        uint32_t ulSize,
+                        int32_t * plBytesRead )
+{
+    TracealyzerCommandType xCommand;
+    uint16_t usChecksum;
+
+    *plBytesRead = 0;
+
+    if( ( xCommandSent == pdFALSE ) && ( ulSize == sizeof( xCommand ) ) )
+    {
+        memset( &xCommand, 0, sizeof( xCommand ) );
+        xCommand.cmdCode = CMD_SET_ACTIVE;
+        xCommand.param1 = 1;
+        usChecksum = ( uint16_t ) ( 0xFFFFU - ( xCommand.cmdCode + xCommand.param1 ) );
+        xCommand.checksumLSB = ( unsigned char ) ( usChecksum & 0xFFU );
+        xCommand.checksumMSB = ( unsigned char ) ( usChecksum >> 8 );
+
+        memcpy( pvData, &xCommand, sizeof( xCommand ) );
+        *plBytesRead = ( int32_t ) sizeof( xCommand );
+        xCommandSent = pdTRUE;
+    }
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCheck( uint32_t ulResult,
+                      BaseType_t xPassed )
+{
+    xResults[ ulResult ].ulCount++;
+
+    if( xPassed == pdFALSE )
+    {
+        xResults[ ulResult ].ulFailures++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvTimerInterrupt( void )
+{
+    BaseType_t xWoken = pdFALSE;
+    uint32_t ulTick = ( uint32_t ) xTaskGetTickCountFromISR();
+
+    vTraceStoreISRBegin( xTimerISR );
+    ( void ) xQueueSendFromISR( xTimerQueue, &ulTick, &xWoken );
+    vTraceStoreISREnd( ( int ) xWoken );
+
+    return ( uint32_t ) xWoken;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvProducerTask( void * pvParameters )
+{
+    uint32_t ul;
+
+    ( void ) pvParameters;
+
+    for( ul = 0; ul < tracetestITEMS; ul++ )
+    {
+        configASSERT( xQueueSend( xItemQueue, &ul, portMAX_DELAY ) == pdPASS );
+
+        if( ( ul % 20 ) == 0 )
+        {
+            vTracePrintF( xAppChannel, "Produced %d", ( int ) ul );
+            vPortGenerateSimulatedInterrupt( tracetestTIMER_INTERRUPT );
+        }
+
+        if( ( ul % 4 ) == 0 )
+        {
+            vTaskDelay( 1 );
+        }
+    }
+
+    vTaskSuspend( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvConsumerTask( void * pvParameters )
+{
+    uint32_t ulItem, ulTick;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        configASSERT( xQueueReceive( xItemQueue, &ulItem, portMAX_DELAY ) == pdPASS );
+
+        configASSERT( xSemaphoreTake( xMutex, portMAX_DELAY ) == pdPASS );
+        ulReceived++;
+        configASSERT( xSemaphoreGive( xMutex ) == pdPASS );
+
+        while( xQueueReceive( xTimerQueue, &ulTick, 0 ) == pdPASS )
+        {
+            vTracePrintF( xAppChannel, "Timer at tick %u", ( unsigned ) ulTick );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void * pvParameters )
+{
+    extern uint32_t RecorderEnabled;
+    TaskHandle_t xProducer, xConsumer;
+    FILE * pxFile;
+    uint32_t ul;
+
+    ( void ) pvParameters;
+
+    /* The TzCtrl task reads the start command within its first few polls. */
+    for( ul = 0; ( ul < 100 ) && ( RecorderEnabled == 0 ); ul++ )
+    {
+        vTaskDelay( pdMS_TO_TICKS( 10 ) );
+    }
+
+    prvCheck( traceSTARTED, RecorderEnabled != 0 );
+
+    xAppChannel = xTraceRegisterString( "App" );
+    vTracePrint( xAppChannel, "Test started" );
+
+    configASSERT( xTaskCreate( prvConsumerTask, "Consumer", configMINIMAL_STACK_SIZE, NULL, tracetestPRIORITY + 2, &xConsumer ) == pdPASS );
+    configASSERT( xTaskCreate( prvProducerTask, "Producer", configMINIMAL_STACK_SIZE, NULL, tracetestPRIORITY + 1, &xProducer ) == pdPASS );
+
+    for( ul = 0; ( ul < 500 ) && ( ulReceived < tracetestITEMS ); ul++ )
+    {
+        vTaskDelay( pdMS_TO_TICKS( 10 ) );
+    }
+
+    prvCheck( traceRECEIVED, ulReceived == tracetestITEMS );
+
+    vTracePrint( xAppChannel, "Test done" );
+    vTraceStop();
+    vTaskDelete( xProducer );
+    vTaskDelete( xConsumer );
+
+    prvCheck( traceHEADER, ( xTraceLength >= 4 ) && ( ucTrace[ 0 ] == 0x00 ) && ( ucTrace[ 1 ] == 0x46 ) &&
+              ( ucTrace[ 2 ] == 0x53 ) && ( ucTrace[ 3 ] == 0x50 ) );
+    prvCheck( traceNOT_DROPPED, ( ulTraceOverflows == 0 ) && ( xTraceGetLastError()[ 0 ] == '\0' ) );
+
+    if( pcTraceName != NULL )
+    {
+        pxFile = fopen( pcTraceName, "wb" );
+        prvCheck( traceWRITTEN, ( pxFile != NULL ) && ( fwrite( ucTrace, 1, xTraceLength, pxFile ) == xTraceLength ) );
+
+        if( pxFile != NULL )
+        {
+            prvCheck( traceWRITTEN, fclose( pxFile ) == 0 );
+        }
+    }
+
+    vTaskEndScheduler();
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char * argv[] )
+{
+    uint32_t ul, ulFailures = 0;
+
+    if( argc > 1 )
+    {
+        pcTraceName = argv[ 1 ];
+    }
+
+    clock_gettime( CLOCK_MONOTONIC, &xStartTime );
+
+    /* As main() in the MicroZed demo: the recorder waits for a host. */
+    vTraceEnable( TRC_INIT );
+
+    xItemQueue = xQueueCreate( 8, sizeof( uint32_t ) );
+    xTimerQueue = xQueueCreate( 8, sizeof( uint32_t ) );
+    xMutex = xSemaphoreCreateMutex();
+    configASSERT( ( xItemQueue != NULL ) && ( xTimerQueue != NULL ) && ( xMutex != NULL ) );
+    vTraceSetQueueName( xItemQueue, "Items" );
+    vTraceSetQueueName( xTimerQueue, "Timer ticks" );
+    vTraceSetMutexName( xMutex, "Item lock" );
+
+    /* Named as FreeRTOS_tick_config.c names the demo's interrupts. */
+    xTimerISR = xTraceSetISRProperties( "Timer", 1 );
+    vTraceStoreKernelObjectName( ( void * ) xTimerISR, "Timer" );
+    vPortSetInterruptHandler( tracetestTIMER_INTERRUPT, prvTimerInterrupt );
+
+    configASSERT( xTaskCreate( prvTestTask, "Test", configMINIMAL_STACK_SIZE * 4, NULL, tracetestPRIORITY, NULL ) == pdPASS );
+
+    vTaskStartScheduler();
+
+    for( ul = 0; ul < traceNUM_RESULTS; ul++ )
+    {
+        printf( "%-28s %10lu  %s\n", xResults[ ul ].pcName, ( unsigned long ) xResults[ ul ].ulCount,
+                ( xResults[ ul ].ulFailures == 0U ) ? "PASS" : "FAIL" );
+        ulFailures += xResults[ ul ].ulFailures;
+    }
+
+    fflush( stdout );
+    _exit( ( ulFailures == 0U ) ? 0 : 1 );
+}